@@ -15,8 +15,10 @@
 #include <dhcp4/json_config_parser.h>
 #include <dhcpsrv/cfgmgr.h>
 #include <dhcpsrv/cfg_db_access.h>
+#include <dhcpsrv/host_mgr.h>
 #include <hooks/hooks_manager.h>
 #include <stats/stats_mgr.h>
+#include <util/threads/multi_threading_mgr.h>
 #include <cfgrpt/config_report.h>
 #include <signal.h>
 
@@ -25,6 +27,7 @@ using namespace isc::dhcp;
 using namespace isc::hooks;
 using namespace isc::config;
 using namespace isc::stats;
+using namespace isc::util::thread;
 using namespace std;
 
 namespace {
@@ -180,6 +183,9 @@ ControlledDhcpv4Srv::commandShutdownHandler(const string&, ConstElementPtr) {
 
 ConstElementPtr
 ControlledDhcpv4Srv::commandLibReloadHandler(const string&, ConstElementPtr) {
+    // Stop the packet processing threads, which also releases the
+    // CalloutHandles they hold, while the libraries are reloaded.
+    MultiThreadingCriticalSection cs;
 
     /// @todo delete any stored CalloutHandles referring to the old libraries
     /// Get list of currently loaded libraries and reload them.
@@ -393,6 +399,17 @@ ControlledDhcpv4Srv::commandBuildReportHandler(const string&,
     return (answer);
 }
 
+ConstElementPtr
+ControlledDhcpv4Srv::commandHostCacheFlushHandler(const string&,
+                                                  ConstElementPtr) {
+    if (!HostMgr::instance().flushCache()) {
+        return (isc::config::createAnswer(CONTROL_RESULT_ERROR,
+                                          "Host cache is not enabled."));
+    }
+    return (isc::config::createAnswer(CONTROL_RESULT_SUCCESS,
+                                      "Host cache flushed."));
+}
+
 ConstElementPtr
 ControlledDhcpv4Srv::commandLeasesReclaimHandler(const string&,
                                                  ConstElementPtr args) {
@@ -461,6 +478,9 @@ ControlledDhcpv4Srv::processCommand(const string& command,
         } else if (command == "build-report") {
             return (srv->commandBuildReportHandler(command, args));
 
+        } else if (command == "host-cache-flush") {
+            return (srv->commandHostCacheFlushHandler(command, args));
+
         } else if (command == "leases-reclaim") {
             return (srv->commandLeasesReclaimHandler(command, args));
 
@@ -494,6 +514,10 @@ ControlledDhcpv4Srv::processConfig(isc::data::ConstElementPtr config) {
         return (isc::config::createAnswer(1, err.str()));
     }
 
+    // The configuration is shared by the packet processing threads so they
+    // are stopped until the new configuration is fully applied.
+    MultiThreadingCriticalSection cs;
+
     ConstElementPtr answer = configureDhcp4Server(*srv, config);
 
     // Check that configuration was successful. If not, do not reopen sockets
@@ -619,6 +643,9 @@ ControlledDhcpv4Srv::ControlledDhcpv4Srv(uint16_t port /*= DHCP4_SERVER_PORT*/)
     CommandMgr::instance().registerCommand("config-write",
         boost::bind(&ControlledDhcpv4Srv::commandConfigWriteHandler, this, _1, _2));
 
+    CommandMgr::instance().registerCommand("host-cache-flush",
+        boost::bind(&ControlledDhcpv4Srv::commandHostCacheFlushHandler, this, _1, _2));
+
     CommandMgr::instance().registerCommand("libreload",
         boost::bind(&ControlledDhcpv4Srv::commandLibReloadHandler, this, _1, _2));
 
@@ -650,6 +677,12 @@ ControlledDhcpv4Srv::ControlledDhcpv4Srv(uint16_t port /*= DHCP4_SERVER_PORT*/)
     CommandMgr::instance().registerCommand("statistic-remove-all",
         boost::bind(&StatsMgr::statisticRemoveAllHandler, _1, _2));
 
+    CommandMgr::instance().registerCommand("statistic-sample-age-set",
+        boost::bind(&StatsMgr::statisticSampleAgeSetHandler, _1, _2));
+
+    CommandMgr::instance().registerCommand("statistic-sample-count-set",
+        boost::bind(&StatsMgr::statisticSampleCountSetHandler, _1, _2));
+
 }
 
 void ControlledDhcpv4Srv::shutdown() {
@@ -659,6 +692,9 @@ void ControlledDhcpv4Srv::shutdown() {
 
 ControlledDhcpv4Srv::~ControlledDhcpv4Srv() {
     try {
+        // Wait for the packets being processed and stop the threads.
+        MultiThreadingMgr::instance().apply(false, 0);
+
         cleanup();
 
         timer_mgr_->unregisterTimers();
@@ -672,6 +708,7 @@ ControlledDhcpv4Srv::~ControlledDhcpv4Srv() {
         CommandMgr::instance().deregisterCommand("config-reload");
         CommandMgr::instance().deregisterCommand("config-test");
         CommandMgr::instance().deregisterCommand("config-write");
+        CommandMgr::instance().deregisterCommand("host-cache-flush");
         CommandMgr::instance().deregisterCommand("leases-reclaim");
         CommandMgr::instance().deregisterCommand("libreload");
         CommandMgr::instance().deregisterCommand("config-set");
@@ -680,6 +717,8 @@ ControlledDhcpv4Srv::~ControlledDhcpv4Srv() {
         CommandMgr::instance().deregisterCommand("statistic-get-all");
         CommandMgr::instance().deregisterCommand("statistic-remove");
         CommandMgr::instance().deregisterCommand("statistic-remove-all");
+        CommandMgr::instance().deregisterCommand("statistic-sample-age-set");
+        CommandMgr::instance().deregisterCommand("statistic-sample-count-set");
         CommandMgr::instance().deregisterCommand("statistic-reset");
         CommandMgr::instance().deregisterCommand("statistic-reset-all");
         CommandMgr::instance().deregisterCommand("version-get");
@@ -28,6 +28,7 @@
 #include <dhcpsrv/cfg_host_operations.h>
 #include <dhcpsrv/cfg_iface.h>
 #include <dhcpsrv/cfg_subnets4.h>
+#include <dhcpsrv/client_handler.h>
 #include <dhcpsrv/lease_mgr.h>
 #include <dhcpsrv/lease_mgr_factory.h>
 #include <dhcpsrv/ncr_generator.h>
@@ -43,6 +44,7 @@
 #include <hooks/hooks_manager.h>
 #include <stats/stats_mgr.h>
 #include <util/strutil.h>
+#include <util/threads/multi_threading_mgr.h>
 #include <stats/stats_mgr.h>
 #include <log/logger.h>
 #include <cryptolink/cryptolink.h>
@@ -74,6 +76,7 @@ using namespace isc::dhcp_ddns;
 using namespace isc::hooks;
 using namespace isc::log;
 using namespace isc::stats;
+using namespace isc::util::thread;
 using namespace std;
 
 /// Structure that holds registered hook indexes
@@ -106,6 +109,57 @@ struct Dhcp4Hooks {
 // module is called.
 Dhcp4Hooks Hooks;
 
+/// Structure that holds the counters of the statistics updated for each
+/// packet. The counters are updated without the lookup of the statistics
+/// by name.
+struct Dhcp4Counters {
+    StatsCounterPtr pkt4_received_;          ///< "pkt4-received"
+    StatsCounterPtr pkt4_receive_drop_;      ///< "pkt4-receive-drop"
+    StatsCounterPtr pkt4_discover_received_; ///< "pkt4-discover-received"
+    StatsCounterPtr pkt4_offer_received_;    ///< "pkt4-offer-received"
+    StatsCounterPtr pkt4_request_received_;  ///< "pkt4-request-received"
+    StatsCounterPtr pkt4_ack_received_;      ///< "pkt4-ack-received"
+    StatsCounterPtr pkt4_nak_received_;      ///< "pkt4-nak-received"
+    StatsCounterPtr pkt4_release_received_;  ///< "pkt4-release-received"
+    StatsCounterPtr pkt4_decline_received_;  ///< "pkt4-decline-received"
+    StatsCounterPtr pkt4_inform_received_;   ///< "pkt4-inform-received"
+    StatsCounterPtr pkt4_unknown_received_;  ///< "pkt4-unknown-received"
+    StatsCounterPtr pkt4_sent_;              ///< "pkt4-sent"
+    StatsCounterPtr pkt4_offer_sent_;        ///< "pkt4-offer-sent"
+    StatsCounterPtr pkt4_ack_sent_;          ///< "pkt4-ack-sent"
+    StatsCounterPtr pkt4_nak_sent_;          ///< "pkt4-nak-sent"
+    StatsCounterPtr pkt4_parked_;            ///< "pkt4-parked"
+    StatsCounterPtr pkt4_unparked_;          ///< "pkt4-unparked"
+    StatsCounterPtr pkt4_park_drop_;         ///< "pkt4-park-drop"
+
+    /// Constructor that obtains the counters from the statistics manager
+    Dhcp4Counters() {
+        StatsMgr& mgr = StatsMgr::instance();
+        pkt4_received_          = mgr.getCounter("pkt4-received");
+        pkt4_receive_drop_      = mgr.getCounter("pkt4-receive-drop");
+        pkt4_discover_received_ = mgr.getCounter("pkt4-discover-received");
+        pkt4_offer_received_    = mgr.getCounter("pkt4-offer-received");
+        pkt4_request_received_  = mgr.getCounter("pkt4-request-received");
+        pkt4_ack_received_      = mgr.getCounter("pkt4-ack-received");
+        pkt4_nak_received_      = mgr.getCounter("pkt4-nak-received");
+        pkt4_release_received_  = mgr.getCounter("pkt4-release-received");
+        pkt4_decline_received_  = mgr.getCounter("pkt4-decline-received");
+        pkt4_inform_received_   = mgr.getCounter("pkt4-inform-received");
+        pkt4_unknown_received_  = mgr.getCounter("pkt4-unknown-received");
+        pkt4_sent_              = mgr.getCounter("pkt4-sent");
+        pkt4_offer_sent_        = mgr.getCounter("pkt4-offer-sent");
+        pkt4_ack_sent_          = mgr.getCounter("pkt4-ack-sent");
+        pkt4_nak_sent_          = mgr.getCounter("pkt4-nak-sent");
+        pkt4_parked_            = mgr.getCounter("pkt4-parked");
+        pkt4_unparked_          = mgr.getCounter("pkt4-unparked");
+        pkt4_park_drop_         = mgr.getCounter("pkt4-park-drop");
+    }
+};
+
+// Declare a Counters object. Like the Hooks object, it is instantiated when
+// the module is loaded.
+Dhcp4Counters Counters;
+
 namespace isc {
 namespace dhcp {
 
@@ -413,7 +467,8 @@ const std::string Dhcpv4Srv::VENDOR_CLASS_PREFIX("VENDOR_CLASS_");
 Dhcpv4Srv::Dhcpv4Srv(uint16_t port, const bool use_bcast,
                      const bool direct_response_desired)
     : io_service_(new IOService()), shutdown_(true), alloc_engine_(), port_(port),
-      use_bcast_(use_bcast) {
+      use_bcast_(use_bcast), parked_packet_limit_(0),
+      send_queueing_(false), pending_leases_timeout_(0) {
 
     LOG_DEBUG(dhcp4_logger, DBG_DHCP4_START, DHCP4_OPEN_SOCKET).arg(port);
     try {
@@ -697,13 +752,72 @@ Dhcpv4Srv::selectSubnet4o6(const Pkt4Ptr& query) const {
 }
 
 Pkt4Ptr
-Dhcpv4Srv::receivePacket(int timeout) {
-    return (IfaceMgr::instance().receive4(timeout));
+Dhcpv4Srv::receivePacket(int timeout, int timeout_usec) {
+    return (IfaceMgr::instance().receive4(timeout, timeout_usec));
 }
 
-void
+bool
 Dhcpv4Srv::sendPacket(const Pkt4Ptr& packet) {
+    // In the multi-threading mode the responses are sent by the threads
+    // which have processed the queries.
+    if (MultiThreadingMgr::instance().getMode()) {
+        IfaceMgr::instance().send(packet);
+        return (true);
+    }
+    // The response is also queued when the lease updates it carries are
+    // not stored yet.
+    if (send_queueing_ || (LeaseMgrFactory::haveInstance() &&
+                           LeaseMgrFactory::instance().hasPending())) {
+        IfaceMgr::instance().queueSend(packet);
+        return (false);
+    }
     IfaceMgr::instance().send(packet);
+    return (true);
+}
+
+void
+Dhcpv4Srv::flushPendingLeases() {
+    try {
+        if (LeaseMgrFactory::haveInstance()) {
+            LeaseMgrFactory::instance().flushPending();
+        }
+    } catch (const std::exception& e) {
+        LOG_ERROR(dhcp4_logger, DHCP4_FLUSH_PENDING_LEASES_FAIL)
+            .arg(e.what());
+    }
+}
+
+void
+Dhcpv4Srv::flushResponses() {
+    pending_leases_timeout_ = 0;
+    try {
+        if (LeaseMgrFactory::haveInstance()) {
+            pending_leases_timeout_ = LeaseMgrFactory::instance().flushDuePending();
+        }
+    } catch (const std::exception& e) {
+        LOG_ERROR(dhcp4_logger, DHCP4_FLUSH_PENDING_LEASES_FAIL)
+            .arg(e.what());
+    }
+
+    if (pending_leases_timeout_ == 0) {
+        flushSendQueue();
+    }
+}
+
+void
+Dhcpv4Srv::flushSendQueue() {
+    std::vector<Pkt4Ptr> sent;
+    try {
+        IfaceMgr::instance().flushSendQueue4(sent);
+    } catch (const std::exception& e) {
+        LOG_ERROR(packet4_logger, DHCP4_PACKET_SEND_QUEUE_FAIL)
+            .arg(e.what());
+    }
+
+    // Update statistics accordingly for the packets actually sent.
+    BOOST_FOREACH(const Pkt4Ptr& rsp, sent) {
+        processStatsSent(rsp);
+    }
 }
 
 bool
@@ -723,6 +837,24 @@ Dhcpv4Srv::run() {
             // std::exception.
             LOG_ERROR(packet4_logger, DHCP4_PACKET_PROCESS_EXCEPTION);
         }
+
+        // Store the lease updates made by the timers, e.g. the
+        // reclamation of the expired leases, and send the responses
+        // held until the lease updates are due. It is also done when
+        // an exception has interrupted the processing of a batch, so
+        // the responses already queued are not held. In the
+        // multi-threading mode they are stored with the updates of
+        // the threads.
+        if (!MultiThreadingMgr::instance().getMode() &&
+            !IfaceMgr::instance().hasReceivedPackets4()) {
+            flushResponses();
+        }
+    }
+
+    // Send the responses still held when the server is shut down.
+    if (!MultiThreadingMgr::instance().getMode()) {
+        flushPendingLeases();
+        flushSendQueue();
     }
 
     return (true);
@@ -730,16 +862,22 @@ Dhcpv4Srv::run() {
 
 void
 Dhcpv4Srv::run_one() {
-    // client's message and server's response
+    // client's message
     Pkt4Ptr query;
-    Pkt4Ptr rsp;
 
     try {
         // Set select() timeout to 1s. This value should not be modified
         // because it is important that the select() returns control
         // frequently so as the IOService can be polled for ready handlers.
         uint32_t timeout = 1;
-        query = receivePacket(timeout);
+        uint32_t timeout_usec = 0;
+        // The queued responses are sent when the lease updates they carry
+        // are due, so the reception doesn't wait longer than that.
+        if ((pending_leases_timeout_ > 0) && (pending_leases_timeout_ < 1000)) {
+            timeout = 0;
+            timeout_usec = pending_leases_timeout_ * 1000;
+        }
+        query = receivePacket(timeout, timeout_usec);
 
         // Log if packet has arrived. We can't log the detailed information
         // about the DHCP message because it hasn't been unpacked/parsed
@@ -801,12 +939,127 @@ Dhcpv4Srv::run_one() {
         return;
     }
 
+    // In the multi-threading mode the packet is processed by one of the
+    // threads of the pool and this thread returns to the reception.
+    MultiThreadingMgr& mt_mgr = MultiThreadingMgr::instance();
+    if (mt_mgr.getMode()) {
+        if (!mt_mgr.getThreadPool().add(boost::bind(&Dhcpv4Srv::processPacketAndSendResponseNoThrow,
+                                                    this, query))) {
+            LOG_DEBUG(packet4_logger, DBG_DHCP4_BASIC, DHCP4_PACKET_QUEUE_FULL)
+                .arg(query->getRemoteAddr().toText())
+                .arg(query->getLocalAddr().toText())
+                .arg(query->getIface());
+            Counters.pkt4_receive_drop_->add();
+        }
+        return;
+    }
+
+    processPacketAndSendResponse(query);
+
+    // Send the responses together when all packets received at once
+    // have been processed.
+    if (!IfaceMgr::instance().hasReceivedPackets4()) {
+        // The responses are held until the leases they carry are stored.
+        flushResponses();
+    }
+}
+
+void
+Dhcpv4Srv::processPacketAndSendResponseNoThrow(Pkt4Ptr& query) {
+    try {
+        processPacketAndSendResponse(query);
+    } catch (const std::exception& e) {
+        LOG_ERROR(packet4_logger, DHCP4_PACKET_PROCESS_STD_EXCEPTION)
+            .arg(e.what());
+    } catch (...) {
+        LOG_ERROR(packet4_logger, DHCP4_PACKET_PROCESS_EXCEPTION);
+    }
+}
+
+void
+Dhcpv4Srv::unparkPacket(Pkt4Ptr& query, CalloutHandlePtr& callout_handle) {
+    LOG_DEBUG(hooks_logger, DBG_DHCP4_HOOKS, DHCP4_HOOK_PACKET_RCVD_UNPARK)
+        .arg(query->getLabel());
+    Counters.pkt4_unparked_->add();
+
+    // In the multi-threading mode the processing is resumed by one of the
+    // threads of the pool and the thread which has unparked the packet
+    // returns to the hooks library.
+    MultiThreadingMgr& mt_mgr = MultiThreadingMgr::instance();
+    if (mt_mgr.getMode()) {
+        if (!mt_mgr.getThreadPool().add(boost::bind(&Dhcpv4Srv::processParkedPacket,
+                                                    this, query,
+                                                    callout_handle))) {
+            LOG_DEBUG(packet4_logger, DBG_DHCP4_BASIC, DHCP4_PACKET_QUEUE_FULL)
+                .arg(query->getRemoteAddr().toText())
+                .arg(query->getLocalAddr().toText())
+                .arg(query->getIface());
+            Counters.pkt4_receive_drop_->add();
+        }
+        return;
+    }
+
+    // Otherwise the packet is unparked by a handler run by the IOService
+    // of the server, so the response is sent right away.
+    processParkedPacket(query, callout_handle);
+    flushResponses();
+}
+
+void
+Dhcpv4Srv::processParkedPacket(Pkt4Ptr& query,
+                               CalloutHandlePtr& callout_handle) {
+    try {
+        // The callouts may have replaced the query.
+        callout_handle->getArgument("query4", query);
+
+        // Other packets have been processed since the packet was parked,
+        // so the association with its callout handle is restored.
+        restoreCalloutHandle(query, callout_handle);
+
+        // The client was unlocked when the packet was parked.
+        ClientHandler client_handler;
+        if (!client_handler.tryLock(query)) {
+            LOG_DEBUG(bad_packet4_logger, DBG_DHCP4_BASIC, DHCP4_PACKET_DROP_0008)
+                .arg(query->getLabel());
+            Counters.pkt4_receive_drop_->add();
+            return;
+        }
+
+        Pkt4Ptr rsp;
+        processDhcp4Query(query, rsp);
+        if (rsp) {
+            sendResponse(query, rsp);
+        }
+    } catch (const std::exception& e) {
+        LOG_ERROR(packet4_logger, DHCP4_PACKET_PROCESS_STD_EXCEPTION)
+            .arg(e.what());
+    } catch (...) {
+        LOG_ERROR(packet4_logger, DHCP4_PACKET_PROCESS_EXCEPTION);
+    }
+}
+
+void
+Dhcpv4Srv::processPacketAndSendResponse(Pkt4Ptr& query) {
+    // server's response
+    Pkt4Ptr rsp;
+
     processPacket(query, rsp);
 
     if (!rsp) {
         return;
     }
 
+    sendResponse(query, rsp);
+}
+
+void
+Dhcpv4Srv::sendResponse(Pkt4Ptr& query, Pkt4Ptr& rsp) {
+    // In the multi-threading mode the response is sent right away, so
+    // the leases it carries are stored first.
+    if (MultiThreadingMgr::instance().getMode()) {
+        flushPendingLeases();
+    }
+
     try {
         // Now all fields and options are constructed into output wire buffer.
         // Option objects modification does not make sense anymore. Hooks
@@ -860,10 +1113,11 @@ Dhcpv4Srv::run_one() {
             .arg(rsp->getName())
             .arg(static_cast<int>(rsp->getType()))
             .arg(rsp->toText());
-        sendPacket(rsp);
-
-        // Update statistics accordingly for sent packet.
-        processStatsSent(rsp);
+        // Update statistics accordingly for sent packet. The statistics
+        // of the queued packet are updated when it is sent.
+        if (sendPacket(rsp)) {
+            processStatsSent(rsp);
+        }
 
     } catch (const std::exception& e) {
         LOG_ERROR(packet4_logger, DHCP4_PACKET_SEND_FAIL)
@@ -878,8 +1132,7 @@ Dhcpv4Srv::processPacket(Pkt4Ptr& query, Pkt4Ptr& rsp) {
     // failures in unpacking will cause the packet to be dropped. We
     // will increase type specific statistic further down the road.
     // See processStatsReceived().
-    isc::stats::StatsMgr::instance().addValue("pkt4-received",
-                                              static_cast<int64_t>(1));
+    Counters.pkt4_received_->add();
 
     bool skip_unpack = false;
 
@@ -927,6 +1180,8 @@ Dhcpv4Srv::processPacket(Pkt4Ptr& query, Pkt4Ptr& rsp) {
                 .arg(query->getRemoteAddr().toText())
                 .arg(query->getLocalAddr().toText())
                 .arg(query->getIface());
+            // The options are created when the server retrieves them.
+            query->setLazyUnpack(true);
             query->unpack();
         } catch (const std::exception& e) {
             // Failed to parse the packet.
@@ -940,8 +1195,7 @@ Dhcpv4Srv::processPacket(Pkt4Ptr& query, Pkt4Ptr& rsp) {
             // Increase the statistics of parse failures and dropped packets.
             isc::stats::StatsMgr::instance().addValue("pkt4-parse-failed",
                                                       static_cast<int64_t>(1));
-            isc::stats::StatsMgr::instance().addValue("pkt4-receive-drop",
-                                                      static_cast<int64_t>(1));
+            Counters.pkt4_receive_drop_->add();
             return;
         }
     }
@@ -961,8 +1215,18 @@ Dhcpv4Srv::processPacket(Pkt4Ptr& query, Pkt4Ptr& rsp) {
     // There is no need to log anything here. This function logs by itself.
     if (!accept(query)) {
         // Increase the statistic of dropped packets.
-        isc::stats::StatsMgr::instance().addValue("pkt4-receive-drop",
-                                                  static_cast<int64_t>(1));
+        Counters.pkt4_receive_drop_->add();
+        return;
+    }
+
+    // In the multi-threading mode the packets sent by the same client
+    // must not be processed concurrently. The client remains locked
+    // until the end of this method.
+    ClientHandler client_handler;
+    if (!client_handler.tryLock(query)) {
+        LOG_DEBUG(bad_packet4_logger, DBG_DHCP4_BASIC, DHCP4_PACKET_DROP_0008)
+            .arg(query->getLabel());
+        Counters.pkt4_receive_drop_->add();
         return;
     }
 
@@ -984,6 +1248,22 @@ Dhcpv4Srv::processPacket(Pkt4Ptr& query, Pkt4Ptr& rsp) {
     if (HooksManager::calloutsPresent(Hooks.hook_index_pkt4_receive_)) {
         CalloutHandlePtr callout_handle = getCalloutHandle(query);
 
+        // The callouts may park the packet until an asynchronous operation
+        // completes. When too many packets are parked the packet is dropped
+        // before the callouts are called.
+        ParkingLotPtr parking_lot = ServerHooks::getServerHooks().
+            getParkingLotsPtr()->getParkingLotPtr(Hooks.hook_index_pkt4_receive_);
+        if ((parked_packet_limit_ > 0) &&
+            (parking_lot->size() >= parked_packet_limit_)) {
+            LOG_DEBUG(hooks_logger, DBG_DHCP4_HOOKS,
+                      DHCP4_HOOK_PACKET_RCVD_PARK_LIMIT)
+                .arg(query->getLabel())
+                .arg(parked_packet_limit_);
+            Counters.pkt4_park_drop_->add();
+            Counters.pkt4_receive_drop_->add();
+            return;
+        }
+
         // Delete previously set arguments
         callout_handle->deleteAllArguments();
 
@@ -993,10 +1273,28 @@ Dhcpv4Srv::processPacket(Pkt4Ptr& query, Pkt4Ptr& rsp) {
         // Pass incoming packet as argument
         callout_handle->setArgument("query4", query);
 
+        // The packet is parked before the callouts are called, so they can
+        // reference it. It is dropped from the parking lot below unless
+        // the callouts have decided to park it.
+        parking_lot->park(query, boost::bind(&Dhcpv4Srv::unparkPacket, this,
+                                             query, callout_handle));
+
         // Call callouts
         HooksManager::callCallouts(Hooks.hook_index_pkt4_receive_,
                                    *callout_handle);
 
+        // Callouts decided to park the packet. Its processing is resumed
+        // by unparkPacket when the callouts unpark it.
+        if (callout_handle->getStatus() == CalloutHandle::NEXT_STEP_PARK) {
+            LOG_DEBUG(hooks_logger, DBG_DHCP4_HOOKS,
+                      DHCP4_HOOK_PACKET_RCVD_PARK)
+                .arg(query->getLabel());
+            Counters.pkt4_parked_->add();
+            return;
+        }
+
+        parking_lot->drop(query);
+
         // Callouts decided to skip the next processing step. The next
         // processing step would to process the packet, so skip at this
         // stage means drop.
@@ -1012,6 +1310,11 @@ Dhcpv4Srv::processPacket(Pkt4Ptr& query, Pkt4Ptr& rsp) {
         callout_handle->getArgument("query4", query);
     }
 
+    processDhcp4Query(query, rsp);
+}
+
+void
+Dhcpv4Srv::processDhcp4Query(Pkt4Ptr& query, Pkt4Ptr& rsp) {
     try {
         switch (query->getType()) {
         case DHCPDISCOVER:
@@ -1058,8 +1361,7 @@ Dhcpv4Srv::processPacket(Pkt4Ptr& query, Pkt4Ptr& rsp) {
             .arg(e.what());
 
         // Increase the statistic of dropped packets.
-        isc::stats::StatsMgr::instance().addValue("pkt4-receive-drop",
-                                                  static_cast<int64_t>(1));
+        Counters.pkt4_receive_drop_->add();
     }
 
     if (!rsp) {
@@ -2460,6 +2762,9 @@ Dhcpv4Srv::processRelease(Pkt4Ptr& release) {
                     .arg(release->getLabel())
                     .arg(lease->addr_.toText());
 
+                // The address may be allocated again.
+                AllocEngine::updatePoolUsage4(*lease, false);
+
                 // Need to decrease statistic for assigned addresses.
                 StatsMgr::instance().addValue(
                     StatsMgr::generateName("subnet", lease->subnet_id_, "assigned-addresses"),
@@ -2692,9 +2997,37 @@ Dhcpv4Srv::accept(const Pkt4Ptr& query) const {
         return (false);
     }
 
+    // Check that all options are well formed. The function logs a
+    // message if needed.
+    if (!acceptOptions(query)) {
+        return (false);
+    }
+
     return (true);
 }
 
+bool
+Dhcpv4Srv::acceptOptions(const Pkt4Ptr& query) const {
+    // Create the options which haven't been retrieved yet, so as the hooks
+    // and the message processing see all options of the query.
+    query->unpackLazyOptions();
+    const std::string& error = query->getLazyUnpackError();
+    if (error.empty()) {
+        return (true);
+    }
+
+    LOG_DEBUG(bad_packet4_logger, DBG_DHCP4_DETAIL, DHCP4_PACKET_DROP_0001)
+        .arg(query->getRemoteAddr().toText())
+        .arg(query->getLocalAddr().toText())
+        .arg(query->getIface())
+        .arg(error);
+
+    // Increase the statistic of parse failures.
+    isc::stats::StatsMgr::instance().addValue("pkt4-parse-failed",
+                                              static_cast<int64_t>(1));
+    return (false);
+}
+
 bool
 Dhcpv4Srv::acceptDirectRequest(const Pkt4Ptr& pkt) const {
     // Accept all relayed messages.
@@ -2893,7 +3226,10 @@ void Dhcpv4Srv::classifyPacket(const Pkt4Ptr& pkt) {
         // Evaluate the expression which can return false (no match),
         // true (match) or raise an exception (error)
         try {
-            bool status = evaluateBool(*expr_ptr, *pkt);
+            const CompiledExpressionPtr& compiled =
+                it->second->getCompiledMatchExpr();
+            bool status = (compiled ? compiled->evaluateBool(*pkt) :
+                           evaluateBool(*expr_ptr, *pkt));
             if (status) {
                 LOG_INFO(options4_logger, EVAL_RESULT)
                     .arg(it->first)
@@ -3044,35 +3380,35 @@ void Dhcpv4Srv::processStatsReceived(const Pkt4Ptr& query) {
     // Note that we're not bumping pkt4-received statistic as it was
     // increased early in the packet reception code.
 
-    string stat_name = "pkt4-unknown-received";
+    StatsCounterPtr counter = Counters.pkt4_unknown_received_;
     try {
         switch (query->getType()) {
         case DHCPDISCOVER:
-            stat_name = "pkt4-discover-received";
+            counter = Counters.pkt4_discover_received_;
             break;
         case DHCPOFFER:
             // Should not happen, but let's keep a counter for it
-            stat_name = "pkt4-offer-received";
+            counter = Counters.pkt4_offer_received_;
             break;
         case DHCPREQUEST:
-            stat_name = "pkt4-request-received";
+            counter = Counters.pkt4_request_received_;
             break;
         case DHCPACK:
             // Should not happen, but let's keep a counter for it
-            stat_name = "pkt4-ack-received";
+            counter = Counters.pkt4_ack_received_;
             break;
         case DHCPNAK:
             // Should not happen, but let's keep a counter for it
-            stat_name = "pkt4-nak-received";
+            counter = Counters.pkt4_nak_received_;
             break;
         case DHCPRELEASE:
-            stat_name = "pkt4-release-received";
+            counter = Counters.pkt4_release_received_;
         break;
         case DHCPDECLINE:
-            stat_name = "pkt4-decline-received";
+            counter = Counters.pkt4_decline_received_;
             break;
         case DHCPINFORM:
-            stat_name = "pkt4-inform-received";
+            counter = Counters.pkt4_inform_received_;
             break;
         default:
             ; // do nothing
@@ -3082,37 +3418,34 @@ void Dhcpv4Srv::processStatsReceived(const Pkt4Ptr& query) {
         // If the incoming packet doesn't have option 53 (message type)
         // or a hook set pkt4_receive_skip, then Pkt4::getType() may
         // throw an exception. That's ok, we'll then use the default
-        // name of pkt4-unknown-received.
+        // counter of pkt4-unknown-received.
     }
 
-    isc::stats::StatsMgr::instance().addValue(stat_name,
-                                              static_cast<int64_t>(1));
+    counter->add();
 }
 
 void Dhcpv4Srv::processStatsSent(const Pkt4Ptr& response) {
     // Increase generic counter for sent packets.
-    isc::stats::StatsMgr::instance().addValue("pkt4-sent",
-                                              static_cast<int64_t>(1));
+    Counters.pkt4_sent_->add();
 
     // Increase packet type specific counter for packets sent.
-    string stat_name;
+    StatsCounterPtr counter;
     switch (response->getType()) {
     case DHCPOFFER:
-        stat_name = "pkt4-offer-sent";
+        counter = Counters.pkt4_offer_sent_;
         break;
     case DHCPACK:
-        stat_name = "pkt4-ack-sent";
+        counter = Counters.pkt4_ack_sent_;
         break;
     case DHCPNAK:
-        stat_name = "pkt4-nak-sent";
+        counter = Counters.pkt4_nak_sent_;
         break;
     default:
         // That should never happen
         return;
     }
 
-    isc::stats::StatsMgr::instance().addValue(stat_name,
-                                              static_cast<int64_t>(1));
+    counter->add();
 }
 
 int Dhcpv4Srv::getHookIndexBuffer4Receive() {
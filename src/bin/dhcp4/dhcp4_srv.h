@@ -248,18 +248,92 @@ public:
     ///
     /// Main server processing step. Receives one incoming packet, calls
     /// the processing packet routing and (if necessary) transmits
-    /// a response.
+    /// a response. In the multi-threading mode the received packet is
+    /// queued for processing by the thread pool instead.
     void run_one();
 
+    /// @brief Process a single incoming DHCPv4 packet and sends the response.
+    ///
+    /// @param query A pointer to the packet to be processed.
+    void processPacketAndSendResponse(Pkt4Ptr& query);
+
+    /// @brief Process a single incoming DHCPv4 packet and sends the response.
+    ///
+    /// This variant is run by the threads of the pool in the
+    /// multi-threading mode. It logs and swallows all exceptions.
+    ///
+    /// @param query A pointer to the packet to be processed.
+    void processPacketAndSendResponseNoThrow(Pkt4Ptr& query);
+
     /// @brief Process a single incoming DHCPv4 packet.
     ///
     /// It verifies correctness of the passed packet, call per-type processXXX
     /// methods, generates appropriate answer.
     ///
+    /// The pkt4_receive callouts may park the packet, in which case the
+    /// response is not generated: the processing is resumed by
+    /// @c processDhcp4Query when the packet is unparked.
+    ///
     /// @param query A pointer to the packet to be processed.
     /// @param rsp A pointer to the response
     void processPacket(Pkt4Ptr& query, Pkt4Ptr& rsp);
 
+    /// @brief Process a single incoming DHCPv4 query.
+    ///
+    /// It calls per-type processXXX methods, the pkt4_send callouts and
+    /// packs the answer. It is the part of @c processPacket following
+    /// the pkt4_receive callouts.
+    ///
+    /// @param query A pointer to the packet to be processed.
+    /// @param rsp A pointer to the response
+    void processDhcp4Query(Pkt4Ptr& query, Pkt4Ptr& rsp);
+
+    /// @brief Sends the response to a DHCPv4 query.
+    ///
+    /// It calls the buffer4_send callouts and sends the packed response.
+    ///
+    /// @param query A pointer to the processed packet.
+    /// @param rsp A pointer to the response
+    void sendResponse(Pkt4Ptr& query, Pkt4Ptr& rsp);
+
+    /// @brief Sets the maximum number of packets parked by the
+    /// pkt4_receive callouts.
+    ///
+    /// The packets received when the limit is reached are dropped before
+    /// the callouts are called.
+    ///
+    /// @param limit Maximum number of parked packets, 0 for no limit.
+    void setParkedPacketLimit(const size_t limit) {
+        parked_packet_limit_ = limit;
+    }
+
+    /// @brief Returns the maximum number of packets parked by the
+    /// pkt4_receive callouts.
+    ///
+    /// @return Maximum number of parked packets, 0 for no limit.
+    size_t getParkedPacketLimit() const {
+        return (parked_packet_limit_);
+    }
+
+    /// @brief Enables or disables the queueing of the responses.
+    ///
+    /// When enabled, the responses are queued by @c sendPacket in the
+    /// single-threaded mode and the responses to the packets received
+    /// together are sent by @c flushSendQueue at once. It is disabled
+    /// by default.
+    ///
+    /// @param enabled true if the responses are queued.
+    void setSendQueueing(const bool enabled) {
+        send_queueing_ = enabled;
+    }
+
+    /// @brief Checks if the responses are queued.
+    ///
+    /// @return true if the responses are queued.
+    bool getSendQueueing() const {
+        return (send_queueing_);
+    }
+
     /// @brief Instructs the server to shut down.
     void shutdown();
 
@@ -412,6 +486,22 @@ protected:
     /// @return true, if the server identifier is absent or matches one of the
     /// server identifiers that the server is using; false otherwise.
     bool acceptServerId(const Pkt4Ptr& pkt) const;
+
+    /// @brief Verifies that the options of the message are well formed.
+    ///
+    /// The options of the received messages are created when they are
+    /// retrieved (see @c Pkt::setLazyUnpack), so the messages dropped by
+    /// the earlier checks don't pay for the options they don't use. This
+    /// function creates the remaining options, so a malformed option is
+    /// detected before the pkt4_receive callouts are called and before
+    /// any lease is changed. It logs the error and increases the
+    /// "pkt4-parse-failed" statistic, as when the message can't be
+    /// unpacked.
+    ///
+    /// @param query Message sent by a client.
+    ///
+    /// @return true if all options are well formed, false otherwise.
+    bool acceptOptions(const Pkt4Ptr& query) const;
     //@}
 
     /// @brief Verifies if specified packet meets RFC requirements
@@ -781,13 +871,48 @@ protected:
     ///
     /// This method is useful for testing purposes, where its replacement
     /// simulates reception of a packet. For that purpose it is protected.
-    virtual Pkt4Ptr receivePacket(int timeout);
+    ///
+    /// @param timeout Timeout in seconds.
+    /// @param timeout_usec Fractional part of the timeout in microseconds.
+    virtual Pkt4Ptr receivePacket(int timeout, int timeout_usec);
 
     /// @brief dummy wrapper around IfaceMgr::send()
     ///
     /// This method is useful for testing purposes, where its replacement
     /// simulates transmission of a packet. For that purpose it is protected.
-    virtual void sendPacket(const Pkt4Ptr& pkt);
+    ///
+    /// In the single-threaded mode the packet is queued by the
+    /// IfaceMgr::queueSend() and it is sent by @c flushSendQueue when
+    /// the queueing is enabled or when the lease updates it carries are
+    /// still pending.
+    ///
+    /// @param pkt packet to be sent
+    /// @return true if the packet has been sent, false if it has been
+    /// queued.
+    virtual bool sendPacket(const Pkt4Ptr& pkt);
+
+    /// @brief Sends the responses queued by @c sendPacket.
+    ///
+    /// It is called by @c flushResponses when all packets received at
+    /// once have been processed so as the responses are sent together.
+    /// The statistics are updated for the responses actually sent.
+    void flushSendQueue();
+
+    /// @brief Waits until the lease updates are stored persistently.
+    ///
+    /// It calls @c LeaseMgr::flushPending before the responses carrying
+    /// the leases are sent. The errors are logged.
+    void flushPendingLeases();
+
+    /// @brief Sends the queued responses when the lease updates they
+    /// carry are stored.
+    ///
+    /// It is used in the single-threaded mode. It calls
+    /// @c LeaseMgr::flushDuePending and sends the responses queued by
+    /// @c sendPacket unless the lease updates are still pending. In that
+    /// case @c run_one doesn't wait for packets longer than the time
+    /// after which the updates are due. The errors are logged.
+    void flushResponses();
 
     /// @brief Assigns incoming packet to zero or more classes.
     ///
@@ -828,6 +953,28 @@ private:
     /// @param pkt packet to be classified
     void classifyByVendor(const Pkt4Ptr& pkt);
 
+    /// @brief Resumes the processing of a packet parked by the
+    /// pkt4_receive callouts.
+    ///
+    /// It is the callback invoked when the packet is unparked. In the
+    /// multi-threading mode the packet is queued for processing by the
+    /// thread pool, otherwise it is processed and the response is sent
+    /// right away.
+    ///
+    /// @param query A pointer to the parked packet.
+    /// @param callout_handle A pointer to the callout handle of the packet.
+    void unparkPacket(Pkt4Ptr& query, hooks::CalloutHandlePtr& callout_handle);
+
+    /// @brief Processes a packet parked by the pkt4_receive callouts and
+    /// sends the response.
+    ///
+    /// It logs and swallows all exceptions.
+    ///
+    /// @param query A pointer to the parked packet.
+    /// @param callout_handle A pointer to the callout handle of the packet.
+    void processParkedPacket(Pkt4Ptr& query,
+                             hooks::CalloutHandlePtr& callout_handle);
+
     /// @private
     /// @brief Constructs netmask option based on subnet4
     /// @param subnet subnet for which the netmask will be calculated
@@ -838,6 +985,17 @@ private:
     uint16_t port_;  ///< UDP port number on which server listens.
     bool use_bcast_; ///< Should broadcast be enabled on sockets (if true).
 
+    /// @brief Maximum number of packets parked by the pkt4_receive
+    /// callouts, 0 for no limit.
+    size_t parked_packet_limit_;
+
+    /// @brief Queue the responses in the single-threaded mode.
+    bool send_queueing_;
+
+    /// @brief Time in milliseconds after which the lease updates carried
+    /// by the queued responses are due, 0 if no updates are pending.
+    uint32_t pending_leases_timeout_;
+
 public:
     /// Class methods for DHCPv4-over-DHCPv6 handler
 
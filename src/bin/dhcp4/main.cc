@@ -15,6 +15,7 @@
 #include <log/logger_support.h>
 #include <log/logger_manager.h>
 #include <cfgrpt/config_report.h>
+#include <util/threads/multi_threading_mgr.h>
 
 #include <boost/lexical_cast.hpp>
 
@@ -22,6 +23,7 @@
 
 using namespace isc::data;
 using namespace isc::dhcp;
+using namespace isc::util::thread;
 using namespace std;
 
 /// This file contains entry point (main() function) for standard DHCPv4 server
@@ -42,15 +44,24 @@ usage() {
     cerr << "Kea DHCPv4 server, version " << VERSION << endl;
     cerr << endl;
     cerr << "Usage: " << DHCP4_NAME
-         << " -[v|V|W] [-d] [-{c|t} cfgfile] [-p number]" << endl;
+         << " -[v|V|W] [-d] [-B] [-{c|t} cfgfile] [-p number] [-N number]"
+         << " [-Q number] [-P number]" << endl;
     cerr << "  -v: print version number and exit" << endl;
     cerr << "  -V: print extended version and exit" << endl;
     cerr << "  -W: display the configuration report and exit" << endl;
     cerr << "  -d: debug mode with extra verbosity (former -v)" << endl;
+    cerr << "  -B: send the responses to the packets received together"
+         << " at once" << endl;
     cerr << "  -c file: specify configuration file" << endl;
     cerr << "  -t file: check the configuration file syntax and exit" << endl;
     cerr << "  -p number: specify non-standard port number 1-65535 "
          << "(useful for testing only)" << endl;
+    cerr << "  -N number: process packets using the specified number of threads,"
+         << " 0 uses one thread per processor" << endl;
+    cerr << "  -Q number: maximum number of packets waiting for the threads,"
+         << " 0 means unlimited (default)" << endl;
+    cerr << "  -P number: maximum number of packets parked by the hooks"
+         << " libraries, 0 means unlimited (default)" << endl;
     exit(EXIT_FAILURE);
 }
 } // end of anonymous namespace
@@ -62,16 +73,25 @@ main(int argc, char* argv[]) {
                                          // useful for testing only.
     bool verbose_mode = false; // Should server be verbose?
     bool check_mode = false;   // Check syntax
+    bool send_queueing = false; // Queue the responses?
+    bool multi_threading = false; // Process packets by the thread pool?
+    int thread_count = 0;      // Number of threads, 0 means auto detect
+    int queue_size = 0;        // Maximum packet queue size, 0 means unlimited
+    int parked_limit = 0;      // Maximum parked packets, 0 means unlimited
 
     // The standard config file
     std::string config_file("");
 
-    while ((ch = getopt(argc, argv, "dvVWc:p:t:")) != -1) {
+    while ((ch = getopt(argc, argv, "dvVWBc:p:t:N:Q:P:")) != -1) {
         switch (ch) {
         case 'd':
             verbose_mode = true;
             break;
 
+        case 'B':
+            send_queueing = true;
+            break;
+
         case 'v':
             cout << Dhcpv4Srv::getVersion(false) << endl;
             return (EXIT_SUCCESS);
@@ -107,6 +127,46 @@ main(int argc, char* argv[]) {
             }
             break;
 
+        case 'N':
+            try {
+                thread_count = boost::lexical_cast<int>(optarg);
+            } catch (const boost::bad_lexical_cast &) {
+                thread_count = -1;
+            }
+            if (thread_count < 0 || thread_count > 65535) {
+                cerr << "Failed to parse number of threads: [" << optarg
+                     << "], 0-65535 allowed." << endl;
+                usage();
+            }
+            multi_threading = true;
+            break;
+
+        case 'Q':
+            try {
+                queue_size = boost::lexical_cast<int>(optarg);
+            } catch (const boost::bad_lexical_cast &) {
+                queue_size = -1;
+            }
+            if (queue_size < 0) {
+                cerr << "Failed to parse packet queue size: [" << optarg
+                     << "], non-negative number allowed." << endl;
+                usage();
+            }
+            break;
+
+        case 'P':
+            try {
+                parked_limit = boost::lexical_cast<int>(optarg);
+            } catch (const boost::bad_lexical_cast &) {
+                parked_limit = -1;
+            }
+            if (parked_limit < 0) {
+                cerr << "Failed to parse parked packet limit: [" << optarg
+                     << "], non-negative number allowed." << endl;
+                usage();
+            }
+            break;
+
         default:
             usage();
         }
@@ -195,6 +255,12 @@ main(int argc, char* argv[]) {
         // Remember verbose-mode
         server.setVerbose(verbose_mode);
 
+        // Send the responses to the packets received together at once.
+        server.setSendQueueing(send_queueing);
+
+        // Limit the number of packets parked by the hooks libraries.
+        server.setParkedPacketLimit(parked_limit);
+
         // Create our PID file.
         server.setProcName(DHCP4_NAME);
         server.setConfigFile(config_file);
@@ -220,6 +286,14 @@ main(int argc, char* argv[]) {
             return (EXIT_FAILURE);
         }
 
+        // Start the threads processing the packets if requested.
+        if (multi_threading) {
+            MultiThreadingMgr::instance().apply(true, thread_count, queue_size);
+            LOG_INFO(dhcp4_logger, DHCP4_MULTI_THREADING_INFO)
+                .arg(MultiThreadingMgr::instance().getThreadPoolSize())
+                .arg(queue_size);
+        }
+
         // Tell the admin we are ready to process packets
         LOG_INFO(dhcp4_logger, DHCP4_STARTED).arg(VERSION);
 
@@ -14,6 +14,7 @@
 #include <dhcp4/ctrl_dhcp4_srv.h>
 #include <dhcp4/tests/dhcp4_test_utils.h>
 #include <dhcpsrv/cfgmgr.h>
+#include <dhcpsrv/host_mgr.h>
 #include <dhcpsrv/lease.h>
 #include <dhcpsrv/lease_mgr_factory.h>
 #include <hooks/hooks_manager.h>
@@ -483,6 +484,7 @@ TEST_F(CtrlChannelDhcpv4SrvTest, commandsRegistration) {
     EXPECT_TRUE(command_list.find("\"config-get\"") != string::npos);
     EXPECT_TRUE(command_list.find("\"config-set\"") != string::npos);
     EXPECT_TRUE(command_list.find("\"config-write\"") != string::npos);
+    EXPECT_TRUE(command_list.find("\"host-cache-flush\"") != string::npos);
     EXPECT_TRUE(command_list.find("\"leases-reclaim\"") != string::npos);
     EXPECT_TRUE(command_list.find("\"libreload\"") != string::npos);
     EXPECT_TRUE(command_list.find("\"shutdown\"") != string::npos);
@@ -492,6 +494,8 @@ TEST_F(CtrlChannelDhcpv4SrvTest, commandsRegistration) {
     EXPECT_TRUE(command_list.find("\"statistic-remove-all\"") != string::npos);
     EXPECT_TRUE(command_list.find("\"statistic-reset\"") != string::npos);
     EXPECT_TRUE(command_list.find("\"statistic-reset-all\"") != string::npos);
+    EXPECT_TRUE(command_list.find("\"statistic-sample-age-set\"") != string::npos);
+    EXPECT_TRUE(command_list.find("\"statistic-sample-count-set\"") != string::npos);
     EXPECT_TRUE(command_list.find("\"version-get\"") != string::npos);
 
     // Ok, and now delete the server. It should deregister its commands.
@@ -588,6 +592,37 @@ TEST_F(CtrlChannelDhcpv4SrvTest, controlLeasesReclaim) {
     EXPECT_TRUE(lease1->stateExpiredReclaimed());
 }
 
+// This test verifies that the DHCP server flushes the host cache on
+// host-cache-flush command
+TEST_F(CtrlChannelDhcpv4SrvTest, controlHostCacheFlush) {
+    createUnixChannelServer();
+
+    // The host cache is not enabled without the host database.
+    std::string response;
+    sendUnixCommand("{ \"command\": \"host-cache-flush\" }", response);
+    EXPECT_EQ("{ \"result\": 1, \"text\": "
+              "\"Host cache is not enabled.\" }", response);
+
+    // Enable the cache and put an entry into it.
+    HostCachePtr cache(new HostCache(10, 0));
+    HostMgr::instance().setTestHostCache(cache);
+    uint64_t version = 0;
+    HostIdentifier identifier(Host::IDENT_HWADDR,
+                              std::vector<uint8_t>(6, 1));
+    ConstHostPtr host;
+    ASSERT_FALSE(cache->get(Option::V4, SubnetID(1), identifier, host,
+                            version));
+    cache->insert(Option::V4, SubnetID(1), identifier, host, version);
+    ASSERT_EQ(1, cache->size());
+
+    sendUnixCommand("{ \"command\": \"host-cache-flush\" }", response);
+    EXPECT_EQ("{ \"result\": 0, \"text\": \"Host cache flushed.\" }",
+              response);
+    EXPECT_EQ(0, cache->size());
+
+    HostMgr::instance().setTestHostCache(HostCachePtr());
+}
+
 // This test verifies that the DHCP server handles version-get commands
 TEST_F(CtrlChannelDhcpv4SrvTest, getversion) {
     createUnixChannelServer();
@@ -854,6 +889,7 @@ TEST_F(CtrlChannelDhcpv4SrvTest, listCommands) {
     checkListCommands(rsp, "config-set");
     checkListCommands(rsp, "config-write");
     checkListCommands(rsp, "list-commands");
+    checkListCommands(rsp, "host-cache-flush");
     checkListCommands(rsp, "leases-reclaim");
     checkListCommands(rsp, "libreload");
     checkListCommands(rsp, "shutdown");
@@ -863,6 +899,8 @@ TEST_F(CtrlChannelDhcpv4SrvTest, listCommands) {
     checkListCommands(rsp, "statistic-remove-all");
     checkListCommands(rsp, "statistic-reset");
     checkListCommands(rsp, "statistic-reset-all");
+    checkListCommands(rsp, "statistic-sample-age-set");
+    checkListCommands(rsp, "statistic-sample-count-set");
     checkListCommands(rsp, "version-get");
 }
 
@@ -138,7 +138,7 @@ public:
     /// another. Once the queue is empty, it initiates the shutdown procedure.
     ///
     /// See fake_received_ field for description
-    virtual Pkt4Ptr receivePacket(int /*timeout*/) {
+    virtual Pkt4Ptr receivePacket(int /*timeout*/, int /*timeout_usec*/) {
 
         // If there is anything prepared as fake incoming traffic, use it
         if (!fake_received_.empty()) {
@@ -156,8 +156,11 @@ public:
     ///
     /// Pretend to send a packet, but instead just store it in fake_send_ list
     /// where test can later inspect server's response.
-    virtual void sendPacket(const Pkt4Ptr& pkt) {
+    ///
+    /// @return always true.
+    virtual bool sendPacket(const Pkt4Ptr& pkt) {
         fake_sent_.push_back(pkt);
+        return (true);
     }
 
     /// @brief adds a packet to fake receive queue
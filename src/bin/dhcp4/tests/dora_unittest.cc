@@ -638,6 +638,30 @@ TEST_F(DORATest, initRebootRequest) {
     ASSERT_EQ("10.0.0.50", client.config_.lease_.addr_.toText());
 }
 
+// Test that the DHCPREQUEST carrying a malformed option is dropped before
+// the server allocates a lease for the client.
+TEST_F(DORATest, selectingRequestMalformedOption) {
+    Dhcp4Client client(Dhcp4Client::SELECTING);
+    // Configure DHCP server.
+    configure(DORA_CONFIGS[0], *client.getServer());
+
+    // Get the offer.
+    ASSERT_NO_THROW(client.doDiscover());
+    Pkt4Ptr resp = client.getContext().response_;
+    ASSERT_TRUE(resp);
+    ASSERT_EQ(DHCPOFFER, static_cast<int>(resp->getType()));
+    IOAddress offered = resp->getYiaddr();
+
+    // The Client FQDN option is too short to carry the flags and the
+    // RCODE fields.
+    client.addExtraOption(OptionPtr(new Option(Option::V4, DHO_FQDN,
+                                               OptionBuffer(1, 0))));
+    ASSERT_NO_THROW(client.doRequest());
+    // The query has been dropped and no lease has been allocated.
+    EXPECT_FALSE(client.getContext().response_);
+    EXPECT_FALSE(LeaseMgrFactory::instance().getLease4(offered));
+}
+
 // Check that the ciaddr returned by the server is correct for DHCPOFFER and
 // DHCPNAK according to RFC2131, section 4.3.1.
 TEST_F(DORATest, ciaddr) {
@@ -316,6 +316,23 @@ public:
         return pkt4_receive_callout(callout_handle);
     }
 
+    /// test callback that parks the packet
+    /// @param callout_handle handle passed by the hooks framework
+    /// @return always 0
+    static int
+    pkt4_receive_park(CalloutHandle& callout_handle) {
+
+        Pkt4Ptr pkt;
+        callout_handle.getArgument("query4", pkt);
+
+        // The packet is unparked by the test.
+        callout_handle.getParkingLotHandlePtr()->reference(pkt);
+        callout_handle.setStatus(CalloutHandle::NEXT_STEP_PARK);
+
+        // carry on as usual
+        return pkt4_receive_callout(callout_handle);
+    }
+
     /// Test callback that stores received callout name and pkt4 value
     /// @param callout_handle handle passed by the hooks framework
     /// @return always 0
@@ -944,6 +961,67 @@ TEST_F(HooksDhcpv4SrvTest, pkt4ReceiveSkip) {
     ASSERT_EQ(0, srv_->fake_sent_.size());
 }
 
+// Checks if callouts installed on pkt4_received are able to park the packet
+// and that the server resumes its processing when the packet is unparked.
+TEST_F(HooksDhcpv4SrvTest, pkt4ReceivePark) {
+    IfaceMgrTestConfig test_config(true);
+    IfaceMgr::instance().openSockets4();
+
+    // Install pkt4_receive_park
+    EXPECT_NO_THROW(HooksManager::preCalloutsLibraryHandle().registerCallout(
+                        "pkt4_receive", pkt4_receive_park));
+
+    // Let's create a simple DISCOVER
+    Pkt4Ptr sol = generateSimpleDiscover();
+
+    // Simulate that we have received that traffic
+    srv_->fakeReceive(sol);
+    srv_->run();
+
+    // check that the server parked the packet and did not produce any
+    // response yet
+    ASSERT_EQ(0, srv_->fake_sent_.size());
+    ASSERT_TRUE(callback_qry_pkt4_);
+    ParkingLotPtr parking_lot = ServerHooks::getServerHooks().
+        getParkingLotsPtr()->getParkingLotPtr(Dhcpv4Srv::getHookIndexPkt4Receive());
+    EXPECT_EQ(1, parking_lot->size());
+
+    // Unparking the packet resumes its processing and sends the response.
+    EXPECT_TRUE(parking_lot->unpark(callback_qry_pkt4_));
+    EXPECT_EQ(0, parking_lot->size());
+    ASSERT_EQ(1, srv_->fake_sent_.size());
+    Pkt4Ptr adv = srv_->fake_sent_.front();
+    ASSERT_TRUE(adv);
+    EXPECT_EQ(DHCPOFFER, adv->getType());
+}
+
+// Checks that the packets received when the limit of parked packets is
+// reached are dropped.
+TEST_F(HooksDhcpv4SrvTest, pkt4ReceiveParkLimit) {
+    IfaceMgrTestConfig test_config(true);
+    IfaceMgr::instance().openSockets4();
+
+    // Install pkt4_receive_park
+    EXPECT_NO_THROW(HooksManager::preCalloutsLibraryHandle().registerCallout(
+                        "pkt4_receive", pkt4_receive_park));
+    srv_->setParkedPacketLimit(1);
+
+    // Simulate that we have received two DISCOVERs
+    Pkt4Ptr sol1 = generateSimpleDiscover();
+    Pkt4Ptr sol2 = generateSimpleDiscover();
+    srv_->fakeReceive(sol1);
+    srv_->fakeReceive(sol2);
+    srv_->run();
+
+    // Only the first packet has been parked, the second one was dropped
+    // before the callouts were called.
+    ASSERT_EQ(0, srv_->fake_sent_.size());
+    EXPECT_TRUE(callback_qry_pkt4_ == sol1);
+    ParkingLotPtr parking_lot = ServerHooks::getServerHooks().
+        getParkingLotsPtr()->getParkingLotPtr(Dhcpv4Srv::getHookIndexPkt4Receive());
+    EXPECT_EQ(1, parking_lot->size());
+}
+
 
 // Checks if callouts installed on pkt4_send are indeed called and the
 // all necessary parameters are passed.
@@ -11,6 +11,7 @@
 #include <dhcp/libdhcp++.h>
 #include <dhcpsrv/cfgmgr.h>
 #include <dhcpsrv/cfg_db_access.h>
+#include <dhcpsrv/host_mgr.h>
 #include <dhcp6/ctrl_dhcp6_srv.h>
 #include <dhcp6/dhcp6to4_ipc.h>
 #include <dhcp6/dhcp6_log.h>
@@ -18,6 +19,7 @@
 #include <dhcp6/parser_context.h>
 #include <hooks/hooks_manager.h>
 #include <stats/stats_mgr.h>
+#include <util/threads/multi_threading_mgr.h>
 #include <cfgrpt/config_report.h>
 #include <signal.h>
 
@@ -26,6 +28,7 @@ using namespace isc::dhcp;
 using namespace isc::data;
 using namespace isc::hooks;
 using namespace isc::stats;
+using namespace isc::util::thread;
 using namespace std;
 
 namespace {
@@ -185,6 +188,10 @@ ControlledDhcpv6Srv::commandShutdownHandler(const string&, ConstElementPtr) {
 
 ConstElementPtr
 ControlledDhcpv6Srv::commandLibReloadHandler(const string&, ConstElementPtr) {
+    // Stop the packet processing threads, which also releases the
+    // CalloutHandles they hold, while the libraries are reloaded.
+    MultiThreadingCriticalSection cs;
+
     /// @todo delete any stored CalloutHandles referring to the old libraries
     /// Get list of currently loaded libraries and reload them.
     HookLibsCollection loaded = HooksManager::getLibraryInfo();
@@ -395,6 +402,17 @@ ControlledDhcpv6Srv::commandBuildReportHandler(const string&, ConstElementPtr) {
     return (answer);
 }
 
+ConstElementPtr
+ControlledDhcpv6Srv::commandHostCacheFlushHandler(const string&,
+                                                  ConstElementPtr) {
+    if (!HostMgr::instance().flushCache()) {
+        return (isc::config::createAnswer(CONTROL_RESULT_ERROR,
+                                          "Host cache is not enabled."));
+    }
+    return (isc::config::createAnswer(CONTROL_RESULT_SUCCESS,
+                                      "Host cache flushed."));
+}
+
 ConstElementPtr
 ControlledDhcpv6Srv::commandLeasesReclaimHandler(const string&,
                                                  ConstElementPtr args) {
@@ -463,6 +481,9 @@ ControlledDhcpv6Srv::processCommand(const std::string& command,
         } else if (command == "build-report") {
             return (srv->commandBuildReportHandler(command, args));
 
+        } else if (command == "host-cache-flush") {
+            return (srv->commandHostCacheFlushHandler(command, args));
+
         } else if (command == "leases-reclaim") {
             return (srv->commandLeasesReclaimHandler(command, args));
 
@@ -495,6 +516,10 @@ ControlledDhcpv6Srv::processConfig(isc::data::ConstElementPtr config) {
         return (no_srv);
     }
 
+    // The configuration is shared by the packet processing threads so they
+    // are stopped until the new configuration is fully applied.
+    MultiThreadingCriticalSection cs;
+
     ConstElementPtr answer = configureDhcp6Server(*srv, config);
 
     // Check that configuration was successful. If not, do not reopen sockets
@@ -641,6 +666,9 @@ ControlledDhcpv6Srv::ControlledDhcpv6Srv(uint16_t port)
     CommandMgr::instance().registerCommand("leases-reclaim",
         boost::bind(&ControlledDhcpv6Srv::commandLeasesReclaimHandler, this, _1, _2));
 
+    CommandMgr::instance().registerCommand("host-cache-flush",
+        boost::bind(&ControlledDhcpv6Srv::commandHostCacheFlushHandler, this, _1, _2));
+
     CommandMgr::instance().registerCommand("libreload",
         boost::bind(&ControlledDhcpv6Srv::commandLibReloadHandler, this, _1, _2));
 
@@ -671,6 +699,12 @@ ControlledDhcpv6Srv::ControlledDhcpv6Srv(uint16_t port)
 
     CommandMgr::instance().registerCommand("statistic-remove-all",
         boost::bind(&StatsMgr::statisticRemoveAllHandler, _1, _2));
+
+    CommandMgr::instance().registerCommand("statistic-sample-age-set",
+        boost::bind(&StatsMgr::statisticSampleAgeSetHandler, _1, _2));
+
+    CommandMgr::instance().registerCommand("statistic-sample-count-set",
+        boost::bind(&StatsMgr::statisticSampleCountSetHandler, _1, _2));
 }
 
 void ControlledDhcpv6Srv::shutdown() {
@@ -680,6 +714,9 @@ void ControlledDhcpv6Srv::shutdown() {
 
 ControlledDhcpv6Srv::~ControlledDhcpv6Srv() {
     try {
+        // Wait for the packets being processed and stop the threads.
+        MultiThreadingMgr::instance().apply(false, 0);
+
         cleanup();
 
         timer_mgr_->unregisterTimers();
@@ -694,6 +731,7 @@ ControlledDhcpv6Srv::~ControlledDhcpv6Srv() {
         CommandMgr::instance().deregisterCommand("config-reload");
         CommandMgr::instance().deregisterCommand("config-test");
         CommandMgr::instance().deregisterCommand("config-write");
+        CommandMgr::instance().deregisterCommand("host-cache-flush");
         CommandMgr::instance().deregisterCommand("leases-reclaim");
         CommandMgr::instance().deregisterCommand("libreload");
         CommandMgr::instance().deregisterCommand("shutdown");
@@ -701,6 +739,8 @@ ControlledDhcpv6Srv::~ControlledDhcpv6Srv() {
         CommandMgr::instance().deregisterCommand("statistic-get-all");
         CommandMgr::instance().deregisterCommand("statistic-remove");
         CommandMgr::instance().deregisterCommand("statistic-remove-all");
+        CommandMgr::instance().deregisterCommand("statistic-sample-age-set");
+        CommandMgr::instance().deregisterCommand("statistic-sample-count-set");
         CommandMgr::instance().deregisterCommand("statistic-reset");
         CommandMgr::instance().deregisterCommand("statistic-reset-all");
         CommandMgr::instance().deregisterCommand("version-get");
@@ -248,6 +248,20 @@ private:
     commandBuildReportHandler(const std::string& command,
                               isc::data::ConstElementPtr args);
 
+    /// @brief Handler for processing 'host-cache-flush' command
+    ///
+    /// This handler processes host-cache-flush command, which removes all
+    /// entries from the cache of the hosts returned by the host database.
+    ///
+    /// @param command (parameter ignored)
+    /// @param args (parameter ignored)
+    ///
+    /// @return status of the command (error if the host cache is not
+    ///         enabled).
+    isc::data::ConstElementPtr
+    commandHostCacheFlushHandler(const std::string& command,
+                                 isc::data::ConstElementPtr args);
+
     /// @brief Handler for processing 'leases-reclaim' command
     ///
     /// This handler processes leases-reclaim command, which triggers
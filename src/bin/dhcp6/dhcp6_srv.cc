@@ -32,6 +32,7 @@
 #include <dhcpsrv/callout_handle_store.h>
 #include <dhcpsrv/cfg_host_operations.h>
 #include <dhcpsrv/cfgmgr.h>
+#include <dhcpsrv/client_handler.h>
 #include <dhcpsrv/lease_mgr.h>
 #include <dhcpsrv/lease_mgr_factory.h>
 #include <dhcpsrv/ncr_generator.h>
@@ -49,6 +50,7 @@
 #include <util/encode/hex.h>
 #include <util/io_utilities.h>
 #include <util/range_utilities.h>
+#include <util/threads/multi_threading_mgr.h>
 #include <log/logger.h>
 #include <cryptolink/cryptolink.h>
 #include <cfgrpt/config_report.h>
@@ -87,6 +89,7 @@ using namespace isc::hooks;
 using namespace isc::log;
 using namespace isc::stats;
 using namespace isc::util;
+using namespace isc::util::thread;
 using namespace std;
 
 namespace {
@@ -121,6 +124,61 @@ struct Dhcp6Hooks {
 // module is called.
 Dhcp6Hooks Hooks;
 
+/// Structure that holds the counters of the statistics updated for each
+/// packet. The counters are updated without the lookup of the statistics
+/// by name.
+struct Dhcp6Counters {
+    StatsCounterPtr pkt6_received_;                 ///< "pkt6-received"
+    StatsCounterPtr pkt6_receive_drop_;             ///< "pkt6-receive-drop"
+    StatsCounterPtr pkt6_solicit_received_;         ///< "pkt6-solicit-received"
+    StatsCounterPtr pkt6_advertise_received_;       ///< "pkt6-advertise-received"
+    StatsCounterPtr pkt6_request_received_;         ///< "pkt6-request-received"
+    StatsCounterPtr pkt6_confirm_received_;         ///< "pkt6-confirm-received"
+    StatsCounterPtr pkt6_renew_received_;           ///< "pkt6-renew-received"
+    StatsCounterPtr pkt6_rebind_received_;          ///< "pkt6-rebind-received"
+    StatsCounterPtr pkt6_reply_received_;           ///< "pkt6-reply-received"
+    StatsCounterPtr pkt6_release_received_;         ///< "pkt6-release-received"
+    StatsCounterPtr pkt6_decline_received_;         ///< "pkt6-decline-received"
+    StatsCounterPtr pkt6_reconfigure_received_;     ///< "pkt6-reconfigure-received"
+    StatsCounterPtr pkt6_infrequest_received_;      ///< "pkt6-infrequest-received"
+    StatsCounterPtr pkt6_dhcpv4_query_received_;    ///< "pkt6-dhcpv4-query-received"
+    StatsCounterPtr pkt6_dhcpv4_response_received_; ///< "pkt6-dhcpv4-response-received"
+    StatsCounterPtr pkt6_unknown_received_;         ///< "pkt6-unknown-received"
+    StatsCounterPtr pkt6_sent_;                     ///< "pkt6-sent"
+    StatsCounterPtr pkt6_advertise_sent_;           ///< "pkt6-advertise-sent"
+    StatsCounterPtr pkt6_reply_sent_;               ///< "pkt6-reply-sent"
+    StatsCounterPtr pkt6_dhcpv4_response_sent_;     ///< "pkt6-dhcpv4-response-sent"
+
+    /// Constructor that obtains the counters from the statistics manager
+    Dhcp6Counters() {
+        StatsMgr& mgr = StatsMgr::instance();
+        pkt6_received_                 = mgr.getCounter("pkt6-received");
+        pkt6_receive_drop_             = mgr.getCounter("pkt6-receive-drop");
+        pkt6_solicit_received_         = mgr.getCounter("pkt6-solicit-received");
+        pkt6_advertise_received_       = mgr.getCounter("pkt6-advertise-received");
+        pkt6_request_received_         = mgr.getCounter("pkt6-request-received");
+        pkt6_confirm_received_         = mgr.getCounter("pkt6-confirm-received");
+        pkt6_renew_received_           = mgr.getCounter("pkt6-renew-received");
+        pkt6_rebind_received_          = mgr.getCounter("pkt6-rebind-received");
+        pkt6_reply_received_           = mgr.getCounter("pkt6-reply-received");
+        pkt6_release_received_         = mgr.getCounter("pkt6-release-received");
+        pkt6_decline_received_         = mgr.getCounter("pkt6-decline-received");
+        pkt6_reconfigure_received_     = mgr.getCounter("pkt6-reconfigure-received");
+        pkt6_infrequest_received_      = mgr.getCounter("pkt6-infrequest-received");
+        pkt6_dhcpv4_query_received_    = mgr.getCounter("pkt6-dhcpv4-query-received");
+        pkt6_dhcpv4_response_received_ = mgr.getCounter("pkt6-dhcpv4-response-received");
+        pkt6_unknown_received_         = mgr.getCounter("pkt6-unknown-received");
+        pkt6_sent_                     = mgr.getCounter("pkt6-sent");
+        pkt6_advertise_sent_           = mgr.getCounter("pkt6-advertise-sent");
+        pkt6_reply_sent_               = mgr.getCounter("pkt6-reply-sent");
+        pkt6_dhcpv4_response_sent_     = mgr.getCounter("pkt6-dhcpv4-response-sent");
+    }
+};
+
+// Declare a Counters object. Like the Hooks object, it is instantiated when
+// the module is loaded.
+Dhcp6Counters Counters;
+
 /// @brief Creates instance of the Status Code option.
 ///
 /// This variant of the function is used when the Status Code option
@@ -178,7 +236,7 @@ const std::string Dhcpv6Srv::VENDOR_CLASS_PREFIX("VENDOR_CLASS_");
 
 Dhcpv6Srv::Dhcpv6Srv(uint16_t port)
     : io_service_(new IOService()), port_(port), serverid_(), shutdown_(true),
-      alloc_engine_()
+      alloc_engine_(), send_queueing_(false), pending_leases_timeout_(0)
 {
 
     LOG_DEBUG(dhcp6_logger, DBG_DHCP6_START, DHCP6_OPEN_SOCKET).arg(port);
@@ -242,12 +300,70 @@ void Dhcpv6Srv::shutdown() {
     shutdown_ = true;
 }
 
-Pkt6Ptr Dhcpv6Srv::receivePacket(int timeout) {
-    return (IfaceMgr::instance().receive6(timeout));
+Pkt6Ptr Dhcpv6Srv::receivePacket(int timeout, int timeout_usec) {
+    return (IfaceMgr::instance().receive6(timeout, timeout_usec));
 }
 
-void Dhcpv6Srv::sendPacket(const Pkt6Ptr& packet) {
+bool Dhcpv6Srv::sendPacket(const Pkt6Ptr& packet) {
+    // In the multi-threading mode the responses are sent by the threads
+    // which have processed the queries.
+    if (MultiThreadingMgr::instance().getMode()) {
+        IfaceMgr::instance().send(packet);
+        return (true);
+    }
+    // The response is also queued when the lease updates it carries are
+    // not stored yet.
+    if (send_queueing_ || (LeaseMgrFactory::haveInstance() &&
+                           LeaseMgrFactory::instance().hasPending())) {
+        IfaceMgr::instance().queueSend(packet);
+        return (false);
+    }
     IfaceMgr::instance().send(packet);
+    return (true);
+}
+
+void
+Dhcpv6Srv::flushPendingLeases() {
+    try {
+        if (LeaseMgrFactory::haveInstance()) {
+            LeaseMgrFactory::instance().flushPending();
+        }
+    } catch (const std::exception& e) {
+        LOG_ERROR(dhcp6_logger, DHCP6_FLUSH_PENDING_LEASES_FAIL)
+            .arg(e.what());
+    }
+}
+
+void
+Dhcpv6Srv::flushResponses() {
+    pending_leases_timeout_ = 0;
+    try {
+        if (LeaseMgrFactory::haveInstance()) {
+            pending_leases_timeout_ = LeaseMgrFactory::instance().flushDuePending();
+        }
+    } catch (const std::exception& e) {
+        LOG_ERROR(dhcp6_logger, DHCP6_FLUSH_PENDING_LEASES_FAIL)
+            .arg(e.what());
+    }
+
+    if (pending_leases_timeout_ == 0) {
+        flushSendQueue();
+    }
+}
+
+void Dhcpv6Srv::flushSendQueue() {
+    std::vector<Pkt6Ptr> sent;
+    try {
+        IfaceMgr::instance().flushSendQueue6(sent);
+    } catch (const std::exception& e) {
+        LOG_ERROR(packet6_logger, DHCP6_PACKET_SEND_QUEUE_FAIL)
+            .arg(e.what());
+    }
+
+    // Update statistics accordingly for the packets actually sent.
+    BOOST_FOREACH(const Pkt6Ptr& rsp, sent) {
+        processStatsSent(rsp);
+    }
 }
 
 bool
@@ -294,6 +410,27 @@ Dhcpv6Srv::testUnicast(const Pkt6Ptr& pkt) const {
     return (true);
 }
 
+bool
+Dhcpv6Srv::testOptions(const Pkt6Ptr& pkt) const {
+    // Create the options which haven't been retrieved yet, so as the hooks
+    // and the message processing see all options of the message.
+    pkt->unpackLazyOptions();
+    const std::string& error = pkt->getLazyUnpackError();
+    if (error.empty()) {
+        return (true);
+    }
+
+    LOG_DEBUG(bad_packet6_logger, DBG_DHCP6_DETAIL, DHCP6_PACKET_DROP_PARSE_FAIL)
+        .arg(pkt->getRemoteAddr().toText())
+        .arg(pkt->getLocalAddr().toText())
+        .arg(pkt->getIface())
+        .arg(error);
+
+    // Increase the statistic of parse failures.
+    StatsMgr::instance().addValue("pkt6-parse-failed", static_cast<int64_t>(1));
+    return (false);
+}
+
 void
 Dhcpv6Srv::initContext(const Pkt6Ptr& pkt, AllocEngine::ClientContext6& ctx) {
     ctx.subnet_ = selectSubnet(pkt);
@@ -386,22 +523,46 @@ bool Dhcpv6Srv::run() {
             // by more specific catches.
             LOG_ERROR(packet6_logger, DHCP6_PACKET_PROCESS_EXCEPTION);
         }
+
+        // Store the lease updates made by the timers, e.g. the
+        // reclamation of the expired leases, and send the responses
+        // held until the lease updates are due. It is also done when
+        // an exception has interrupted the processing of a batch, so
+        // the responses already queued are not held. In the
+        // multi-threading mode they are stored with the updates of
+        // the threads.
+        if (!MultiThreadingMgr::instance().getMode() &&
+            !IfaceMgr::instance().hasReceivedPackets6()) {
+            flushResponses();
+        }
+    }
+
+    // Send the responses still held when the server is shut down.
+    if (!MultiThreadingMgr::instance().getMode()) {
+        flushPendingLeases();
+        flushSendQueue();
     }
 
     return (true);
 }
 
 void Dhcpv6Srv::run_one() {
-    // client's message and server's response
+    // client's message
     Pkt6Ptr query;
-    Pkt6Ptr rsp;
 
     try {
         // Set select() timeout to 1s. This value should not be modified
         // because it is important that the select() returns control
         // frequently so as the IOService can be polled for ready handlers.
         uint32_t timeout = 1;
-        query = receivePacket(timeout);
+        uint32_t timeout_usec = 0;
+        // The queued responses are sent when the lease updates they carry
+        // are due, so the reception doesn't wait longer than that.
+        if ((pending_leases_timeout_ > 0) && (pending_leases_timeout_ < 1000)) {
+            timeout = 0;
+            timeout_usec = pending_leases_timeout_ * 1000;
+        }
+        query = receivePacket(timeout, timeout_usec);
 
         // Log if packet has arrived. We can't log the detailed information
         // about the DHCP message because it hasn't been unpacked/parsed
@@ -421,7 +582,7 @@ void Dhcpv6Srv::run_one() {
             // any failures in unpacking will cause the packet to be dropped.
             // we will increase type specific packets further down the road.
             // See processStatsReceived().
-            StatsMgr::instance().addValue("pkt6-received", static_cast<int64_t>(1));
+            Counters.pkt6_received_->add();
 
         }
         // We used to log that the wait was interrupted, but this is no longer
@@ -467,12 +628,60 @@ void Dhcpv6Srv::run_one() {
         return;
     }
 
+    // In the multi-threading mode the packet is processed by one of the
+    // threads of the pool and this thread returns to the reception.
+    MultiThreadingMgr& mt_mgr = MultiThreadingMgr::instance();
+    if (mt_mgr.getMode()) {
+        if (!mt_mgr.getThreadPool().add(boost::bind(&Dhcpv6Srv::processPacketAndSendResponseNoThrow,
+                                                    this, query))) {
+            LOG_DEBUG(packet6_logger, DBG_DHCP6_BASIC, DHCP6_PACKET_QUEUE_FULL)
+                .arg(query->getRemoteAddr().toText())
+                .arg(query->getLocalAddr().toText())
+                .arg(query->getIface());
+            Counters.pkt6_receive_drop_->add();
+        }
+        return;
+    }
+
+    processPacketAndSendResponse(query);
+
+    // Send the responses together when all packets received at once
+    // have been processed.
+    if (!IfaceMgr::instance().hasReceivedPackets6()) {
+        // The responses are held until the leases they carry are stored.
+        flushResponses();
+    }
+}
+
+void
+Dhcpv6Srv::processPacketAndSendResponseNoThrow(Pkt6Ptr& query) {
+    try {
+        processPacketAndSendResponse(query);
+    } catch (const std::exception& e) {
+        LOG_ERROR(packet6_logger, DHCP6_PACKET_PROCESS_STD_EXCEPTION)
+            .arg(e.what());
+    } catch (...) {
+        LOG_ERROR(packet6_logger, DHCP6_PACKET_PROCESS_EXCEPTION);
+    }
+}
+
+void
+Dhcpv6Srv::processPacketAndSendResponse(Pkt6Ptr& query) {
+    // server's response
+    Pkt6Ptr rsp;
+
     processPacket(query, rsp);
 
     if (!rsp) {
         return;
     }
 
+    // In the multi-threading mode the response is sent right away, so
+    // the leases it carries are stored first.
+    if (MultiThreadingMgr::instance().getMode()) {
+        flushPendingLeases();
+    }
+
     try {
 
         // Now all fields and options are constructed into output wire buffer.
@@ -511,10 +720,11 @@ void Dhcpv6Srv::run_one() {
         LOG_DEBUG(packet6_logger, DBG_DHCP6_DETAIL_DATA, DHCP6_RESPONSE_DATA)
             .arg(static_cast<int>(rsp->getType())).arg(rsp->toText());
 
-        sendPacket(rsp);
-
-        // Update statistics accordingly for sent packet.
-        processStatsSent(rsp);
+        // Update statistics accordingly for sent packet. The statistics
+        // of the queued packet are updated when it is sent.
+        if (sendPacket(rsp)) {
+            processStatsSent(rsp);
+        }
 
     } catch (const std::exception& e) {
         LOG_ERROR(packet6_logger, DHCP6_PACKET_SEND_FAIL).arg(e.what());
@@ -567,6 +777,8 @@ Dhcpv6Srv::processPacket(Pkt6Ptr& query, Pkt6Ptr& rsp) {
                 .arg(query->getRemoteAddr().toText())
                 .arg(query->getLocalAddr().toText())
                 .arg(query->getIface());
+            // The options are created when the server retrieves them.
+            query->setLazyUnpack(true);
             query->unpack();
         } catch (const std::exception &e) {
             // Failed to parse the packet.
@@ -580,8 +792,7 @@ Dhcpv6Srv::processPacket(Pkt6Ptr& query, Pkt6Ptr& rsp) {
             // Increase the statistics of parse failures and dropped packets.
             StatsMgr::instance().addValue("pkt6-parse-failed",
                                           static_cast<int64_t>(1));
-            StatsMgr::instance().addValue("pkt6-receive-drop",
-                                          static_cast<int64_t>(1));
+            Counters.pkt6_receive_drop_->add();
             return;
         }
     }
@@ -594,7 +805,7 @@ Dhcpv6Srv::processPacket(Pkt6Ptr& query, Pkt6Ptr& rsp) {
     if (!testServerID(query)) {
 
         // Increase the statistic of dropped packets.
-        StatsMgr::instance().addValue("pkt6-receive-drop", static_cast<int64_t>(1));
+        Counters.pkt6_receive_drop_->add();
         return;
     }
 
@@ -604,7 +815,26 @@ Dhcpv6Srv::processPacket(Pkt6Ptr& query, Pkt6Ptr& rsp) {
     if (!testUnicast(query)) {
 
         // Increase the statistic of dropped packets.
-        StatsMgr::instance().addValue("pkt6-receive-drop", static_cast<int64_t>(1));
+        Counters.pkt6_receive_drop_->add();
+        return;
+    }
+
+    // Check that all options are well formed.
+    if (!testOptions(query)) {
+
+        // Increase the statistic of dropped packets.
+        Counters.pkt6_receive_drop_->add();
+        return;
+    }
+
+    // In the multi-threading mode the packets sent by the same client
+    // must not be processed concurrently. The client remains locked
+    // until the end of this method.
+    ClientHandler client_handler;
+    if (!client_handler.tryLock(query)) {
+        LOG_DEBUG(bad_packet6_logger, DBG_DHCP6_BASIC, DHCP6_PACKET_DROP_CLIENT_BUSY)
+            .arg(query->getLabel());
+        Counters.pkt6_receive_drop_->add();
         return;
     }
 
@@ -712,7 +942,7 @@ Dhcpv6Srv::processPacket(Pkt6Ptr& query, Pkt6Ptr& rsp) {
             .arg(e.what());
 
         // Increase the statistic of dropped packets.
-        StatsMgr::instance().addValue("pkt6-receive-drop", static_cast<int64_t>(1));
+        Counters.pkt6_receive_drop_->add();
 
     } catch (const std::exception& e) {
 
@@ -729,7 +959,7 @@ Dhcpv6Srv::processPacket(Pkt6Ptr& query, Pkt6Ptr& rsp) {
             .arg(e.what());
 
         // Increase the statistic of dropped packets.
-        StatsMgr::instance().addValue("pkt6-receive-drop", static_cast<int64_t>(1));
+        Counters.pkt6_receive_drop_->add();
     }
 
     if (!rsp) {
@@ -3090,7 +3320,10 @@ void Dhcpv6Srv::classifyPacket(const Pkt6Ptr& pkt) {
         // Evaluate the expression which can return false (no match),
         // true (match) or raise an exception (error)
         try {
-            bool status = evaluateBool(*expr_ptr, *pkt);
+            const CompiledExpressionPtr& compiled =
+                it->second->getCompiledMatchExpr();
+            bool status = (compiled ? compiled->evaluateBool(*pkt) :
+                           evaluateBool(*expr_ptr, *pkt));
             if (status) {
                 LOG_INFO(dhcp6_logger, EVAL_RESULT)
                     .arg(it->first)
@@ -3349,79 +3582,79 @@ void Dhcpv6Srv::processStatsReceived(const Pkt6Ptr& query) {
     // Note that we're not bumping pkt6-received statistic as it was
     // increased early in the packet reception code.
 
-    string stat_name = "pkt6-unknown-received";
+    StatsCounterPtr counter = Counters.pkt6_unknown_received_;
     switch (query->getType()) {
     case DHCPV6_SOLICIT:
-        stat_name = "pkt6-solicit-received";
+        counter = Counters.pkt6_solicit_received_;
         break;
     case DHCPV6_ADVERTISE:
         // Should not happen, but let's keep a counter for it
-        stat_name = "pkt6-advertise-received";
+        counter = Counters.pkt6_advertise_received_;
         break;
     case DHCPV6_REQUEST:
-        stat_name = "pkt6-request-received";
+        counter = Counters.pkt6_request_received_;
         break;
     case DHCPV6_CONFIRM:
-        stat_name = "pkt6-confirm-received";
+        counter = Counters.pkt6_confirm_received_;
         break;
     case DHCPV6_RENEW:
-        stat_name = "pkt6-renew-received";
+        counter = Counters.pkt6_renew_received_;
         break;
     case DHCPV6_REBIND:
-        stat_name = "pkt6-rebind-received";
+        counter = Counters.pkt6_rebind_received_;
         break;
     case DHCPV6_REPLY:
         // Should not happen, but let's keep a counter for it
-        stat_name = "pkt6-reply-received";
+        counter = Counters.pkt6_reply_received_;
         break;
     case DHCPV6_RELEASE:
-        stat_name = "pkt6-release-received";
+        counter = Counters.pkt6_release_received_;
         break;
     case DHCPV6_DECLINE:
-        stat_name = "pkt6-decline-received";
+        counter = Counters.pkt6_decline_received_;
         break;
     case DHCPV6_RECONFIGURE:
-        stat_name = "pkt6-reconfigure-received";
+        counter = Counters.pkt6_reconfigure_received_;
         break;
     case DHCPV6_INFORMATION_REQUEST:
-        stat_name = "pkt6-infrequest-received";
+        counter = Counters.pkt6_infrequest_received_;
         break;
     case DHCPV6_DHCPV4_QUERY:
-        stat_name = "pkt6-dhcpv4-query-received";
+        counter = Counters.pkt6_dhcpv4_query_received_;
         break;
     case DHCPV6_DHCPV4_RESPONSE:
         // Should not happen, but let's keep a counter for it
-        stat_name = "pkt6-dhcpv4-response-received";
+        counter = Counters.pkt6_dhcpv4_response_received_;
         break;
     default:
             ; // do nothing
     }
 
-    StatsMgr::instance().addValue(stat_name, static_cast<int64_t>(1));
+    counter->add();
 }
 
 void Dhcpv6Srv::processStatsSent(const Pkt6Ptr& response) {
     // Increase generic counter for sent packets.
-    StatsMgr::instance().addValue("pkt6-sent", static_cast<int64_t>(1));
+    Counters.pkt6_sent_->add();
 
     // Increase packet type specific counter for packets sent.
-    string stat_name;
+    StatsCounterPtr counter;
     switch (response->getType()) {
     case DHCPV6_ADVERTISE:
-        stat_name = "pkt6-advertise-sent";
+        counter = Counters.pkt6_advertise_sent_;
         break;
     case DHCPV6_REPLY:
-        stat_name = "pkt6-reply-sent";
+        counter = Counters.pkt6_reply_sent_;
         break;
     case DHCPV6_DHCPV4_RESPONSE:
-        stat_name = "pkt6-dhcpv4-response-sent";
+        counter = Counters.pkt6_dhcpv4_response_sent_;
         break;
     default:
         // That should never happen
         return;
     }
 
-    StatsMgr::instance().addValue(stat_name, static_cast<int64_t>(1));
+    counter->add();
 }
 
 int Dhcpv6Srv::getHookIndexBuffer6Send() {
@@ -109,9 +109,23 @@ public:
     ///
     /// Main server processing step. Receives one incoming packet, calls
     /// the processing packet routing and (if necessary) transmits
-    /// a response.
+    /// a response. In the multi-threading mode the received packet is
+    /// queued for processing by the thread pool instead.
     void run_one();
 
+    /// @brief Process a single incoming DHCPv6 packet and sends the response.
+    ///
+    /// @param query A pointer to the packet to be processed.
+    void processPacketAndSendResponse(Pkt6Ptr& query);
+
+    /// @brief Process a single incoming DHCPv6 packet and sends the response.
+    ///
+    /// This variant is run by the threads of the pool in the
+    /// multi-threading mode. It logs and swallows all exceptions.
+    ///
+    /// @param query A pointer to the packet to be processed.
+    void processPacketAndSendResponseNoThrow(Pkt6Ptr& query);
+
     /// @brief Process a single incoming DHCPv6 packet.
     ///
     /// It verifies correctness of the passed packet, call per-type processXXX
@@ -121,6 +135,25 @@ public:
     /// @param rsp A pointer to the response
     void processPacket(Pkt6Ptr& query, Pkt6Ptr& rsp);
 
+    /// @brief Enables or disables the queueing of the responses.
+    ///
+    /// When enabled, the responses are queued by @c sendPacket in the
+    /// single-threaded mode and the responses to the packets received
+    /// together are sent by @c flushSendQueue at once. It is disabled
+    /// by default.
+    ///
+    /// @param enabled true if the responses are queued.
+    void setSendQueueing(const bool enabled) {
+        send_queueing_ = enabled;
+    }
+
+    /// @brief Checks if the responses are queued.
+    ///
+    /// @return true if the responses are queued.
+    bool getSendQueueing() const {
+        return (send_queueing_);
+    }
+
     /// @brief Instructs the server to shut down.
     void shutdown();
 
@@ -190,6 +223,21 @@ protected:
     /// not allowed according to RFC3315, section 15; true otherwise.
     bool testUnicast(const Pkt6Ptr& pkt) const;
 
+    /// @brief Check if the options of the message are well formed.
+    ///
+    /// The options of the received messages are created when they are
+    /// retrieved (see @c Pkt::setLazyUnpack), so the messages dropped by
+    /// the earlier checks don't pay for the options they don't use. This
+    /// function creates the remaining options, so a malformed option is
+    /// detected before the pkt6_receive callouts are called and before
+    /// any lease is changed. It logs the error and increases the
+    /// "pkt6-parse-failed" statistic, as when the message can't be
+    /// unpacked.
+    ///
+    /// @param pkt DHCPv6 message to be checked.
+    /// @return false if an option is malformed; true otherwise.
+    bool testOptions(const Pkt6Ptr& pkt) const;
+
     /// @brief verifies if specified packet meets RFC requirements
     ///
     /// Checks if mandatory option is really there, that forbidden option
@@ -622,13 +670,48 @@ protected:
     ///
     /// This method is useful for testing purposes, where its replacement
     /// simulates reception of a packet. For that purpose it is protected.
-    virtual Pkt6Ptr receivePacket(int timeout);
+    ///
+    /// @param timeout Timeout in seconds.
+    /// @param timeout_usec Fractional part of the timeout in microseconds.
+    virtual Pkt6Ptr receivePacket(int timeout, int timeout_usec);
 
     /// @brief dummy wrapper around IfaceMgr::send()
     ///
     /// This method is useful for testing purposes, where its replacement
     /// simulates transmission of a packet. For that purpose it is protected.
-    virtual void sendPacket(const Pkt6Ptr& pkt);
+    ///
+    /// In the single-threaded mode the packet is queued by the
+    /// IfaceMgr::queueSend() and it is sent by @c flushSendQueue when
+    /// the queueing is enabled or when the lease updates it carries are
+    /// still pending.
+    ///
+    /// @param pkt packet to be sent
+    /// @return true if the packet has been sent, false if it has been
+    /// queued.
+    virtual bool sendPacket(const Pkt6Ptr& pkt);
+
+    /// @brief Sends the responses queued by @c sendPacket.
+    ///
+    /// It is called by @c flushResponses when all packets received at
+    /// once have been processed so as the responses are sent together.
+    /// The statistics are updated for the responses actually sent.
+    void flushSendQueue();
+
+    /// @brief Waits until the lease updates are stored persistently.
+    ///
+    /// It calls @c LeaseMgr::flushPending before the responses carrying
+    /// the leases are sent. The errors are logged.
+    void flushPendingLeases();
+
+    /// @brief Sends the queued responses when the lease updates they
+    /// carry are stored.
+    ///
+    /// It is used in the single-threaded mode. It calls
+    /// @c LeaseMgr::flushDuePending and sends the responses queued by
+    /// @c sendPacket unless the lease updates are still pending. In that
+    /// case @c run_one doesn't wait for packets longer than the time
+    /// after which the updates are due. The errors are logged.
+    void flushResponses();
 
     /// @brief Assigns incoming packet to zero or more classes.
     ///
@@ -871,6 +954,13 @@ protected:
     /// Holds a list of @c isc::dhcp_ddns::NameChangeRequest objects, which
     /// are waiting for sending to kea-dhcp-ddns module.
     std::queue<isc::dhcp_ddns::NameChangeRequest> name_change_reqs_;
+
+    /// @brief Queue the responses in the single-threaded mode.
+    bool send_queueing_;
+
+    /// @brief Time in milliseconds after which the lease updates carried
+    /// by the queued responses are due, 0 if no updates are pending.
+    uint32_t pending_leases_timeout_;
 };
 
 }; // namespace isc::dhcp
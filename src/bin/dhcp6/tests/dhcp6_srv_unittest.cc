@@ -2340,6 +2340,37 @@ TEST_F(Dhcpv6SrvTest, receiveParseFailedStat) {
     EXPECT_EQ(1, recv_drop->getInteger().first);
 }
 
+// Test checks if reception of a packet carrying a malformed option, which is
+// detected when the server retrieves the option, increases pkt-parse-failed
+// and pkt6-receive-drop and that the packet is dropped.
+TEST_F(Dhcpv6SrvTest, receiveMalformedOptionStat) {
+    using namespace isc::stats;
+    StatsMgr& mgr = StatsMgr::instance();
+    NakedDhcpv6Srv srv(0);
+
+    // Let's get a simple SOLICIT...
+    Pkt6Ptr pkt = PktCaptures::captureSimpleSolicit();
+
+    // And append the IA_NA option which is too short to carry the IAID
+    // and the timers.
+    const uint8_t ia_na[] = { 0, D6O_IA_NA, 0, 4, 1, 2, 3, 4 };
+    pkt->data_.insert(pkt->data_.end(), ia_na, ia_na + sizeof(ia_na));
+
+    // Simulate that we have received that traffic
+    srv.fakeReceive(pkt);
+    srv.run();
+
+    // The packet has been dropped.
+    EXPECT_TRUE(srv.fake_sent_.empty());
+
+    ObservationPtr parse_fail = mgr.getObservation("pkt6-parse-failed");
+    ObservationPtr recv_drop = mgr.getObservation("pkt6-receive-drop");
+    ASSERT_TRUE(parse_fail);
+    ASSERT_TRUE(recv_drop);
+    EXPECT_EQ(1, parse_fail->getInteger().first);
+    EXPECT_EQ(1, recv_drop->getInteger().first);
+}
+
 // This test verifies that the server is able to handle an empty DUID (client-id)
 // in incoming client message.
 TEST_F(Dhcpv6SrvTest, emptyClientId) {
@@ -146,7 +146,8 @@ public:
     /// it initiates the shutdown procedure.
     ///
     /// See fake_received_ field for description
-    virtual isc::dhcp::Pkt6Ptr receivePacket(int /*timeout*/) {
+    virtual isc::dhcp::Pkt6Ptr receivePacket(int /*timeout*/,
+                                             int /*timeout_usec*/) {
 
         // If there is anything prepared as fake incoming
         // traffic, use it
@@ -167,8 +168,11 @@ public:
     /// Pretend to send a packet, but instead just store
     /// it in fake_send_ list where test can later inspect
     /// server's response.
-    virtual void sendPacket(const isc::dhcp::Pkt6Ptr& pkt) {
+    ///
+    /// @return always true.
+    virtual bool sendPacket(const isc::dhcp::Pkt6Ptr& pkt) {
         fake_sent_.push_back(pkt);
+        return (true);
     }
 
     /// @brief adds a packet to fake receive queue
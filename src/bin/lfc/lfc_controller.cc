@@ -10,8 +10,11 @@
 #include <lfc/lfc_log.h>
 #include <util/pid_file.h>
 #include <exceptions/exceptions.h>
+#include <dhcpsrv/binary_lease_file4.h>
+#include <dhcpsrv/binary_lease_file6.h>
 #include <dhcpsrv/csv_lease_file4.h>
 #include <dhcpsrv/csv_lease_file6.h>
+#include <dhcpsrv/lease_file.h>
 #include <dhcpsrv/memfile_lease_mgr.h>
 #include <dhcpsrv/memfile_lease_storage.h>
 #include <dhcpsrv/lease_mgr.h>
@@ -34,6 +37,23 @@ using namespace isc::log;
 namespace {
 /// @brief Maximum number of errors to allow when reading leases from the file.
 const uint32_t MAX_LEASE_ERRORS = 100;
+
+/// @brief Creates the object representing the lease file in the given format.
+///
+/// @param filename Name of the lease file.
+/// @param format Format of the lease file.
+/// @tparam CSVLeaseFileType A @c CSVLeaseFile4 or @c CSVLeaseFile6.
+/// @tparam BinaryLeaseFileType A @c BinaryLeaseFile4 or @c BinaryLeaseFile6.
+/// @tparam LeaseFileType A @c LeaseFile4 or @c LeaseFile6.
+template<typename CSVLeaseFileType, typename BinaryLeaseFileType,
+         typename LeaseFileType>
+boost::shared_ptr<LeaseFileType>
+createLeaseFile(const std::string& filename, const LeaseFileFormat format) {
+    if (format == LEASE_FILE_BINARY) {
+        return (boost::shared_ptr<LeaseFileType>(new BinaryLeaseFileType(filename)));
+    }
+    return (boost::shared_ptr<LeaseFileType>(new CSVLeaseFileType(filename)));
+}
 }; // namespace anonymous
 
 namespace isc {
@@ -51,7 +71,8 @@ const char* LFCController::lfc_bin_name_ = "kea-lfc";
 
 LFCController::LFCController()
     : protocol_version_(0), verbose_(false), config_file_(""), previous_file_(""),
-      copy_file_(""), output_file_(""), finish_file_(""), pid_file_("") {
+      copy_file_(""), output_file_(""), finish_file_(""), pid_file_(""),
+      convert_format_("") {
 }
 
 LFCController::~LFCController() {
@@ -79,6 +100,30 @@ LFCController::launch(int argc, char* argv[], const bool test_mode) {
     // Start up the logging system.
     startLogger(test_mode);
 
+    // The conversion of the lease file doesn't interfere with the server
+    // and the cleanup, so it is done without the PID file.
+    if (!convert_format_.empty()) {
+        LOG_INFO(lfc_logger, LFC_CONVERTING)
+          .arg(copy_file_)
+          .arg(output_file_)
+          .arg(convert_format_);
+
+        try {
+            if (getProtocolVersion() == 4) {
+                convertLeases<Lease4, CSVLeaseFile4, BinaryLeaseFile4,
+                              LeaseFile4>();
+            } else {
+                convertLeases<Lease6, CSVLeaseFile6, BinaryLeaseFile6,
+                              LeaseFile6>();
+            }
+        } catch (const std::exception& conv_ex) {
+            LOG_FATAL(lfc_logger, LFC_FAIL_CONVERT).arg(conv_ex.what());
+        }
+
+        LOG_INFO(lfc_logger, LFC_TERMINATE);
+        return;
+    }
+
     LOG_INFO(lfc_logger, LFC_START);
 
     // verify we are the only instance
@@ -109,9 +154,11 @@ LFCController::launch(int argc, char* argv[], const bool test_mode) {
 
         try {
             if (getProtocolVersion() == 4) {
-                processLeases<Lease4, CSVLeaseFile4, Lease4Storage>();
+                processLeases<Lease4, CSVLeaseFile4, BinaryLeaseFile4,
+                              LeaseFile4, Lease4Storage>();
             } else {
-                processLeases<Lease6, CSVLeaseFile6, Lease6Storage>();
+                processLeases<Lease6, CSVLeaseFile6, BinaryLeaseFile6,
+                              LeaseFile6, Lease6Storage>();
             }
         } catch (const std::exception& proc_ex) {
             // We don't want to do the cleanup but do want to get rid of the pid
@@ -150,7 +197,7 @@ LFCController::parseArgs(int argc, char* argv[]) {
 
     opterr = 0;
     optind = 1;
-    while ((ch = getopt(argc, argv, ":46dhvVWp:x:i:o:c:f:")) != -1) {
+    while ((ch = getopt(argc, argv, ":46dhvVWp:x:i:o:c:f:t:")) != -1) {
         switch (ch) {
         case '4':
             // Process DHCPv4 lease files.
@@ -230,6 +277,18 @@ LFCController::parseArgs(int argc, char* argv[]) {
             config_file_ = optarg;
             break;
 
+        case 't':
+            // Format to which the copy file is converted.
+            if (optarg == NULL) {
+                isc_throw(InvalidUsage, "Conversion format missing");
+            }
+            convert_format_ = optarg;
+            if ((convert_format_ != "csv") && (convert_format_ != "binary")) {
+                isc_throw(InvalidUsage, "Unsupported conversion format: "
+                          << convert_format_);
+            }
+            break;
+
         case 'h':
             usage("");
             exit(EXIT_SUCCESS);
@@ -259,6 +318,26 @@ LFCController::parseArgs(int argc, char* argv[]) {
         isc_throw(InvalidUsage, "DHCP version required");
     }
 
+    // The conversion requires only the input and the output file.
+    if (!convert_format_.empty()) {
+        if (copy_file_.empty()) {
+            isc_throw(InvalidUsage, "Input file not specified");
+        }
+
+        if (output_file_.empty()) {
+            isc_throw(InvalidUsage, "Output file not specified");
+        }
+
+        if (verbose_) {
+            std::cout << "Protocol version:    DHCPv" << protocol_version_ << std::endl
+                      << "Input lease file:          " << copy_file_ << std::endl
+                      << "Output lease file:         " << output_file_ << std::endl
+                      << "Output format:             " << convert_format_ << std::endl
+                      << std::endl;
+        }
+        return;
+    }
+
     if (pid_file_.empty()) {
         isc_throw(InvalidUsage, "PID file not specified");
     }
@@ -304,6 +383,7 @@ LFCController::usage(const std::string& text) {
 
     std::cerr << "Usage: " << lfc_bin_name_ << std::endl
               << " [-4|-6] -p file -x file -i file -o file -f file -c file" << std::endl
+              << " [-4|-6] -t csv|binary -i file -o file" << std::endl
               << "   -4 or -6 clean a set of v4 or v6 lease files" << std::endl
               << "   -p <file>: PID file" << std::endl
               << "   -x <file>: previous or ex lease file" << std::endl
@@ -311,6 +391,9 @@ LFCController::usage(const std::string& text) {
               << "   -o <file>: output lease file" << std::endl
               << "   -f <file>: finish file" << std::endl
               << "   -c <file>: configuration file" << std::endl
+              << "   -t <format>: convert the -i file to the csv or binary format"
+              << std::endl
+              << "                and write it to the -o file" << std::endl
               << "   -v: print version number and exit" << std::endl
               << "   -V: print extended version information and exit" << std::endl
               << "   -d: optional, verbose output " << std::endl
@@ -331,39 +414,63 @@ LFCController::getVersion(const bool extended) const{
     return (version_stream.str());
 }
 
-template<typename LeaseObjectType, typename LeaseFileType, typename StorageType>
+template<typename LeaseObjectType, typename CSVLeaseFileType,
+         typename BinaryLeaseFileType, typename LeaseFileType,
+         typename StorageType>
 void
 LFCController::processLeases() const {
     StorageType storage;
 
+    // The output file is written in the format of the most recent input
+    // file, i.e. in the format in which the server records leases.
+    const LeaseFileFormat format =
+        LeaseFileLoader::detectFormat(getCopyFile(),
+                                      LeaseFileLoader::detectFormat(getPreviousFile(),
+                                                                    LEASE_FILE_CSV));
+    uint32_t read_leases = 0;
+    uint32_t reads = 0;
+    uint32_t read_errs = 0;
+
     // If a previous file exists read the entries into storage
-    LeaseFileType lf_prev(getPreviousFile());
-    if (lf_prev.exists()) {
-        LeaseFileLoader::load<LeaseObjectType>(lf_prev, storage,
-                                               MAX_LEASE_ERRORS);
+    boost::shared_ptr<LeaseFileType> lf_prev;
+    if (CSVFile(getPreviousFile()).exists()) {
+        LeaseFileLoader::loadFile<LeaseObjectType, CSVLeaseFileType,
+                                  BinaryLeaseFileType>(getPreviousFile(), format,
+                                                       lf_prev, storage,
+                                                       MAX_LEASE_ERRORS);
+        read_leases += lf_prev->getReadLeases();
+        reads += lf_prev->getReads();
+        read_errs += lf_prev->getReadErrs();
     }
 
     // Follow that with the copy of the current lease file
-    LeaseFileType lf_copy(getCopyFile());
-    if (lf_copy.exists()) {
-        LeaseFileLoader::load<LeaseObjectType>(lf_copy, storage,
-                                               MAX_LEASE_ERRORS);
+    boost::shared_ptr<LeaseFileType> lf_copy;
+    if (CSVFile(getCopyFile()).exists()) {
+        LeaseFileLoader::loadFile<LeaseObjectType, CSVLeaseFileType,
+                                  BinaryLeaseFileType>(getCopyFile(), format,
+                                                       lf_copy, storage,
+                                                       MAX_LEASE_ERRORS);
+        read_leases += lf_copy->getReadLeases();
+        reads += lf_copy->getReads();
+        read_errs += lf_copy->getReadErrs();
     }
 
     // Write the result out to the output file
-    LeaseFileType lf_output(getOutputFile());
-    LeaseFileLoader::write<LeaseObjectType>(lf_output, storage);
+    boost::shared_ptr<LeaseFileType> lf_output =
+        createLeaseFile<CSVLeaseFileType, BinaryLeaseFileType,
+                        LeaseFileType>(getOutputFile(), format);
+    LeaseFileLoader::write<LeaseObjectType>(*lf_output, storage);
 
     // If desired log the stats
     LOG_INFO(lfc_logger, LFC_READ_STATS)
-      .arg(lf_prev.getReadLeases() + lf_copy.getReadLeases())
-      .arg(lf_prev.getReads() + lf_copy.getReads())
-      .arg(lf_prev.getReadErrs() + lf_copy.getReadErrs());
+      .arg(read_leases)
+      .arg(reads)
+      .arg(read_errs);
 
     LOG_INFO(lfc_logger, LFC_WRITE_STATS)
-      .arg(lf_output.getWriteLeases())
-      .arg(lf_output.getWrites())
-      .arg(lf_output.getWriteErrs());
+      .arg(lf_output->getWriteLeases())
+      .arg(lf_output->getWrites())
+      .arg(lf_output->getWriteErrs());
 
     // Once we've finished the output file move it to the complete file
     if (rename(getOutputFile().c_str(), getFinishFile().c_str()) != 0) {
@@ -373,6 +480,45 @@ LFCController::processLeases() const {
     }
 }
 
+template<typename LeaseObjectType, typename CSVLeaseFileType,
+         typename BinaryLeaseFileType, typename LeaseFileType>
+void
+LFCController::convertLeases() const {
+    // Don't overwrite an existing file, the entries would be appended to it.
+    if (CSVFile(getOutputFile()).exists()) {
+        isc_throw(RunTimeFail, "Output file (" << output_file_
+                  << ") already exists");
+    }
+
+    const LeaseFileFormat format = (convert_format_ == "binary" ?
+                                    LEASE_FILE_BINARY : LEASE_FILE_CSV);
+    boost::shared_ptr<LeaseFileType> lf_input =
+        createLeaseFile<CSVLeaseFileType, BinaryLeaseFileType,
+                        LeaseFileType>(getCopyFile(),
+                                       LeaseFileLoader::detectFormat(getCopyFile(),
+                                                                     LEASE_FILE_CSV));
+    if (!lf_input->exists()) {
+        isc_throw(RunTimeFail, "Input file (" << copy_file_
+                  << ") doesn't exist");
+    }
+
+    boost::shared_ptr<LeaseFileType> lf_output =
+        createLeaseFile<CSVLeaseFileType, BinaryLeaseFileType,
+                        LeaseFileType>(getOutputFile(), format);
+    LeaseFileLoader::convert<LeaseObjectType>(*lf_input, *lf_output,
+                                              MAX_LEASE_ERRORS);
+
+    LOG_INFO(lfc_logger, LFC_READ_STATS)
+      .arg(lf_input->getReadLeases())
+      .arg(lf_input->getReads())
+      .arg(lf_input->getReadErrs());
+
+    LOG_INFO(lfc_logger, LFC_WRITE_STATS)
+      .arg(lf_output->getWriteLeases())
+      .arg(lf_output->getWrites())
+      .arg(lf_output->getWriteErrs());
+}
+
 void
 LFCController::fileRotate() const {
     // Remove the old previous file
@@ -149,6 +149,14 @@ public:
     std::string getPidFile() const {
         return (pid_file_);
     }
+
+    /// @brief Gets the format to which the lease file is converted
+    ///
+    /// @return Returns "csv", "binary" or an empty string when the
+    /// lease files are cleaned up rather than converted
+    std::string getConvertFormat() const {
+        return (convert_format_);
+    }
     //@}
 
 private:
@@ -162,6 +170,7 @@ private:
     std::string output_file_;   ///< The path to the output file
     std::string finish_file_;   ///< The path to the finished output file
     std::string pid_file_;      ///< The path to the pid file
+    std::string convert_format_; ///< The format of the converted file (if any)
 
     /// @brief Prints the program usage text to std error.
     ///
@@ -181,14 +190,40 @@ private:
     /// write the results out to the output file.  Upon completion of
     /// the write move the file to the finish file.
     ///
+    /// The format of each file is detected. The output file is written
+    /// in the format of the copy file or, if it doesn't exist, in the
+    /// format of the previous file.
+    ///
     /// @tparam LeaseObjectType A @c Lease4 or @c Lease6.
-    /// @tparam LeaseFileType A @c CSVLeaseFile4 or @c CSVLeaseFile6.
+    /// @tparam CSVLeaseFileType A @c CSVLeaseFile4 or @c CSVLeaseFile6.
+    /// @tparam BinaryLeaseFileType A @c BinaryLeaseFile4 or
+    /// @c BinaryLeaseFile6.
+    /// @tparam LeaseFileType A @c LeaseFile4 or @c LeaseFile6.
     /// @tparam StorageType A @c Lease4Storage or @c Lease6Storage.
     ///
     /// @throw RunTimeFail if we can't move the file.
-    template<typename LeaseObjectType, typename LeaseFileType, typename StorageType>
+    template<typename LeaseObjectType, typename CSVLeaseFileType,
+             typename BinaryLeaseFileType, typename LeaseFileType,
+             typename StorageType>
     void processLeases() const;
 
+    /// @brief Convert the lease file.
+    ///
+    /// Copy all entries of the copy (input) file to the output file
+    /// written in the format specified with the -t option.
+    ///
+    /// @tparam LeaseObjectType A @c Lease4 or @c Lease6.
+    /// @tparam CSVLeaseFileType A @c CSVLeaseFile4 or @c CSVLeaseFile6.
+    /// @tparam BinaryLeaseFileType A @c BinaryLeaseFile4 or
+    /// @c BinaryLeaseFile6.
+    /// @tparam LeaseFileType A @c LeaseFile4 or @c LeaseFile6.
+    ///
+    /// @throw RunTimeFail if the input file doesn't exist or the output
+    /// file exists.
+    template<typename LeaseObjectType, typename CSVLeaseFileType,
+             typename BinaryLeaseFileType, typename LeaseFileType>
+    void convertLeases() const;
+
     ///@brief Start up the logging system
     ///
     /// @param test_mode indicates if we have have been started from the test
@@ -271,6 +271,39 @@ TEST_F(LFCControllerTest, someBadData) {
     EXPECT_THROW(lfc_controller.parseArgs(argc, argv), InvalidUsage);
 }
 
+/// @brief Verify that the conversion command line is parsed.
+/// The conversion requires only the input and the output file and
+/// accepts the csv and binary formats.
+TEST_F(LFCControllerTest, convertCommandLine) {
+    LFCController lfc_controller;
+
+    char* argv[] = { const_cast<char*>("progName"),
+                     const_cast<char*>("-6"),
+                     const_cast<char*>("-t"),
+                     const_cast<char*>("binary"),
+                     const_cast<char*>("-i"),
+                     const_cast<char*>("copy"),
+                     const_cast<char*>("-o"),
+                     const_cast<char*>("output") };
+    int argc = 8;
+
+    ASSERT_NO_THROW(lfc_controller.parseArgs(argc, argv));
+
+    EXPECT_EQ(lfc_controller.getProtocolVersion(), 6);
+    EXPECT_EQ(lfc_controller.getConvertFormat(), "binary");
+    EXPECT_EQ(lfc_controller.getCopyFile(), "copy");
+    EXPECT_EQ(lfc_controller.getOutputFile(), "output");
+
+    // The output file is required.
+    LFCController lfc_no_output;
+    EXPECT_THROW(lfc_no_output.parseArgs(argc - 2, argv), InvalidUsage);
+
+    // Unknown formats are rejected.
+    LFCController lfc_bad_format;
+    argv[3] = const_cast<char*>("xml");
+    EXPECT_THROW(lfc_bad_format.parseArgs(argc, argv), InvalidUsage);
+}
+
 /// @brief Verify that we do file rotation correctly.  We create different
 /// files and see if we properly delete and move them.
 TEST_F(LFCControllerTest, fileRotate) {
@@ -10,6 +10,7 @@
 #include <asiolink/io_error.h>
 #include <exceptions/exceptions.h>
 
+#include <boost/functional/hash.hpp>
 #include <boost/static_assert.hpp>
 
 #include <unistd.h>             // for some IPC/network system calls
@@ -123,6 +124,16 @@ operator<<(std::ostream& os, const IOAddress& address) {
     return (os);
 }
 
+size_t
+hash_value(const IOAddress& address) {
+    if (address.asio_address_.is_v4()) {
+        return (boost::hash_value(address.asio_address_.to_v4().to_ulong()));
+    }
+    const boost::asio::ip::address_v6::bytes_type bytes =
+        address.asio_address_.to_v6().to_bytes();
+    return (boost::hash_range(bytes.begin(), bytes.end()));
+}
+
 IOAddress
 IOAddress::subtract(const IOAddress& a, const IOAddress& b) {
     if (a.getFamily() != b.getFamily()) {
@@ -310,6 +310,16 @@ public:
 
     //@}
 
+    /// \brief Computes the hash of the address.
+    ///
+    /// This function allows for using \c IOAddress objects as keys in
+    /// hashed containers, e.g. Boost multi index containers with hashed
+    /// indexes.
+    ///
+    /// \param address The address for which the hash is computed.
+    /// \return Hash value.
+    friend size_t hash_value(const IOAddress& address);
+
 private:
     boost::asio::ip::address asio_address_;
 };
@@ -11,6 +11,8 @@
 #include <asiolink/io_address.h>
 #include <exceptions/exceptions.h>
 
+#include <boost/functional/hash.hpp>
+
 #include <algorithm>
 #include <cstring>
 #include <vector>
@@ -339,3 +341,21 @@ TEST(IOAddressTest, increaseAddr) {
     EXPECT_EQ(IOAddress("::1"), IOAddress::increase(any6));
     EXPECT_EQ(IOAddress("::"), IOAddress::increase(the_last_one));
 }
+
+// Test checks that the hash of an address can be computed and that it
+// can be used by boost::hash.
+TEST(IOAddressTest, hashValue) {
+    boost::hash<IOAddress> hasher;
+
+    // Equal addresses must have equal hashes.
+    EXPECT_EQ(hash_value(IOAddress("192.0.2.1")),
+              hash_value(IOAddress("192.0.2.1")));
+    EXPECT_EQ(hasher(IOAddress("2001:db8::1")),
+              hasher(IOAddress("2001:db8::1")));
+    EXPECT_EQ(hash_value(IOAddress("2001:db8::1")),
+              hasher(IOAddress("2001:db8::1")));
+
+    // Different addresses should have different hashes.
+    EXPECT_NE(hasher(IOAddress("192.0.2.1")), hasher(IOAddress("192.0.2.2")));
+    EXPECT_NE(hasher(IOAddress("2001:db8::1")), hasher(IOAddress("2001:db8::2")));
+}
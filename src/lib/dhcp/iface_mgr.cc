@@ -18,17 +18,28 @@
 #include <util/io/pktinfo_utilities.h>
 
 #include <boost/foreach.hpp>
+#include <boost/noncopyable.hpp>
 #include <boost/scoped_ptr.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <climits>
 #include <cstring>
 #include <errno.h>
+#include <fcntl.h>
 #include <fstream>
+#include <map>
 #include <sstream>
 
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include <string.h>
 #include <sys/select.h>
+#include <unistd.h>
+
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
 
 using namespace std;
 using namespace isc::asiolink;
@@ -38,6 +49,279 @@ using namespace isc::util::io::internal;
 namespace isc {
 namespace dhcp {
 
+namespace {
+
+/// @brief Counter incremented each time a socket or an interface is
+/// added or removed.
+///
+/// The sets of sockets waited for are rebuilt only when it has changed.
+/// It also allows for detecting that a closed socket descriptor has been
+/// reused by a new socket, which can't be detected by comparing the
+/// descriptors. It is atomic because the sockets may be opened and closed
+/// by other threads than the one receiving the packets.
+std::atomic<uint64_t> sockets_generation(0);
+
+}
+
+/// @brief Set of sockets waited for by @c IfaceMgr::receive4 or
+/// @c IfaceMgr::receive6.
+///
+/// When epoll is available, the sockets are registered in a persistent
+/// epoll instance. It is updated only when the set of sockets changes,
+/// i.e. when sockets are opened or closed or external sockets are
+/// registered. Otherwise, or when some of the descriptors can't be
+/// registered (e.g. descriptors of regular files used in unit tests),
+/// select() is used.
+class IfaceMgr::ReceiveSet : public boost::noncopyable {
+public:
+
+    /// @brief Interface socket waited for.
+    struct Socket {
+
+        /// @brief Constructor.
+        ///
+        /// @param iface Interface the socket belongs to.
+        /// @param socket Socket information.
+        Socket(const IfacePtr& iface, const SocketInfo& socket)
+            : iface_(iface), socket_(socket) {
+        }
+
+        /// @brief Interface the socket belongs to.
+        IfacePtr iface_;
+
+        /// @brief Socket information.
+        SocketInfo socket_;
+    };
+
+    /// @brief Interface sockets indexed by their descriptors.
+    typedef std::map<int, Socket> SocketMap;
+
+    /// @brief Constructor.
+    ReceiveSet()
+        : fds_(), sockets_(), generation_(0), epoll_fd_(-1),
+          use_epoll_(false) {
+    }
+
+    /// @brief Destructor.
+    ///
+    /// Closes the epoll instance.
+    ~ReceiveSet() {
+        closeEpoll();
+    }
+
+    /// @brief Checks if the set must be rebuilt.
+    ///
+    /// @return true if sockets or interfaces have been added or removed
+    /// since the last update.
+    bool isStale() const {
+        return (generation_ != sockets_generation.load());
+    }
+
+    /// @brief Updates the set of sockets.
+    ///
+    /// @param generation Value of the sockets generation read before
+    /// the sockets were collected.
+    /// @param fds Descriptors of the sockets to be waited for, including
+    /// the external sockets.
+    /// @param sockets Interface sockets to be waited for.
+    void update(const uint64_t generation, const std::vector<int>& fds,
+                const SocketMap& sockets) {
+        fds_ = fds;
+        sockets_ = sockets;
+        generation_ = generation;
+        closeEpoll();
+        use_epoll_ = registerEpoll();
+    }
+
+    /// @brief Returns the interface socket with the specified descriptor.
+    ///
+    /// @param fd Descriptor of the socket.
+    ///
+    /// @return Pointer to the socket or null if it is not an interface
+    /// socket, e.g. it is an external socket.
+    const Socket* getSocket(const int fd) const {
+        SocketMap::const_iterator s = sockets_.find(fd);
+        return (s != sockets_.end() ? &s->second : 0);
+    }
+
+    /// @brief Waits until at least one of the sockets is readable.
+    ///
+    /// @param timeout_sec Integral part of the timeout (in seconds).
+    /// @param timeout_usec Fractional part of the timeout (in microseconds).
+    /// @param [out] ready Sorted descriptors of the readable sockets. It is
+    /// empty when the timeout has been reached.
+    ///
+    /// @throw isc::dhcp::SocketReadError if error occurred when waiting.
+    /// @throw isc::dhcp::SignalInterruptOnSelect when the wait is
+    /// interrupted by a signal.
+    void wait(const uint32_t timeout_sec, const uint32_t timeout_usec,
+              std::vector<int>& ready) {
+        ready.clear();
+        if (use_epoll_) {
+            waitEpoll(timeout_sec, timeout_usec, ready);
+        } else {
+            waitSelect(timeout_sec, timeout_usec, ready);
+        }
+        std::sort(ready.begin(), ready.end());
+    }
+
+private:
+
+    /// @brief Throws an exception appropriate for the errno value.
+    static void throwWaitError() {
+        // In most cases we would like to know whether select() returned
+        // an error because of a signal being received  or for some other
+        // reason. This is because DHCP servers use signals to trigger
+        // certain actions, like reconfiguration or graceful shutdown.
+        // By catching a dedicated exception the caller will know if the
+        // error returned by the function is due to the reception of the
+        // signal or for some other reason.
+        if (errno == EINTR) {
+            isc_throw(SignalInterruptOnSelect, strerror(errno));
+        } else {
+            isc_throw(SocketReadError, strerror(errno));
+        }
+    }
+
+    /// @brief Creates the epoll instance and registers the sockets.
+    ///
+    /// @return true if all sockets have been registered, false if
+    /// select() must be used instead.
+    bool registerEpoll() {
+#ifdef HAVE_SYS_EPOLL_H
+        epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd_ < 0) {
+            return (false);
+        }
+        BOOST_FOREACH(int fd, fds_) {
+            struct epoll_event event;
+            memset(&event, 0, sizeof(event));
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) < 0) {
+                closeEpoll();
+                return (false);
+            }
+        }
+        events_.resize(std::max(fds_.size(), static_cast<size_t>(1)));
+        return (true);
+#else
+        return (false);
+#endif
+    }
+
+    /// @brief Closes the epoll instance.
+    void closeEpoll() {
+        if (epoll_fd_ >= 0) {
+            close(epoll_fd_);
+            epoll_fd_ = -1;
+        }
+        use_epoll_ = false;
+    }
+
+    /// @brief Waits using epoll.
+    ///
+    /// @param timeout_sec Integral part of the timeout (in seconds).
+    /// @param timeout_usec Fractional part of the timeout (in microseconds).
+    /// @param [out] ready Descriptors of the readable sockets.
+    void waitEpoll(const uint32_t timeout_sec, const uint32_t timeout_usec,
+                   std::vector<int>& ready) {
+#ifdef HAVE_SYS_EPOLL_H
+        // epoll has a millisecond resolution: round the timeout up so as
+        // a short non-zero timeout doesn't turn into a busy loop.
+        uint64_t timeout_ms = static_cast<uint64_t>(timeout_sec) * 1000 +
+            (timeout_usec + 999) / 1000;
+        if (timeout_ms > INT_MAX) {
+            timeout_ms = INT_MAX;
+        }
+
+        // zero out the errno to be safe
+        errno = 0;
+
+        int result = epoll_wait(epoll_fd_, &events_[0], events_.size(),
+                                static_cast<int>(timeout_ms));
+        if (result < 0) {
+            throwWaitError();
+        }
+
+        for (int i = 0; i < result; ++i) {
+            ready.push_back(events_[i].data.fd);
+        }
+
+        // A closed descriptor is silently removed from the epoll instance
+        // while select() would report it as an error. Check the
+        // descriptors when nothing has been received to report the error
+        // the same way.
+        if (result == 0) {
+            BOOST_FOREACH(int fd, fds_) {
+                if ((fcntl(fd, F_GETFD) < 0) && (errno == EBADF)) {
+                    isc_throw(SocketReadError, strerror(errno));
+                }
+            }
+        }
+#endif
+    }
+
+    /// @brief Waits using select().
+    ///
+    /// @param timeout_sec Integral part of the timeout (in seconds).
+    /// @param timeout_usec Fractional part of the timeout (in microseconds).
+    /// @param [out] ready Descriptors of the readable sockets.
+    void waitSelect(const uint32_t timeout_sec, const uint32_t timeout_usec,
+                    std::vector<int>& ready) {
+        fd_set sockets;
+        int maxfd = 0;
+
+        FD_ZERO(&sockets);
+        BOOST_FOREACH(int fd, fds_) {
+            FD_SET(fd, &sockets);
+            if (maxfd < fd) {
+                maxfd = fd;
+            }
+        }
+
+        struct timeval select_timeout;
+        select_timeout.tv_sec = timeout_sec;
+        select_timeout.tv_usec = timeout_usec;
+
+        // zero out the errno to be safe
+        errno = 0;
+
+        int result = select(maxfd + 1, &sockets, NULL, NULL, &select_timeout);
+        if (result < 0) {
+            throwWaitError();
+        }
+
+        if (result > 0) {
+            BOOST_FOREACH(int fd, fds_) {
+                if (FD_ISSET(fd, &sockets)) {
+                    ready.push_back(fd);
+                }
+            }
+        }
+    }
+
+    /// @brief Descriptors of the sockets.
+    std::vector<int> fds_;
+
+    /// @brief Interface sockets indexed by their descriptors.
+    SocketMap sockets_;
+
+    /// @brief Value of the sockets generation when the set was updated.
+    uint64_t generation_;
+
+    /// @brief Descriptor of the epoll instance or -1.
+    int epoll_fd_;
+
+    /// @brief Indicates if epoll is used to wait for the sockets.
+    bool use_epoll_;
+
+#ifdef HAVE_SYS_EPOLL_H
+    /// @brief Buffer for the events returned by epoll_wait().
+    std::vector<struct epoll_event> events_;
+#endif
+};
+
 IfaceMgr&
 IfaceMgr::instance() {
     return (*instancePtr());
@@ -94,6 +378,7 @@ Iface::closeSockets(const uint16_t family) {
                 close(sock->fallbackfd_);
             }
             sockets_.erase(sock++);
+            ++sockets_generation;
 
         } else {
             // Different type of socket. Let's move
@@ -148,6 +433,11 @@ bool Iface::delAddress(const isc::asiolink::IOAddress& addr) {
     return (false);
 }
 
+void Iface::addSocket(const SocketInfo& sock) {
+    sockets_.push_back(sock);
+    ++sockets_generation;
+}
+
 bool Iface::delSocket(const uint16_t sockfd) {
     list<SocketInfo>::iterator sock = sockets_.begin();
     while (sock!=sockets_.end()) {
@@ -158,6 +448,7 @@ bool Iface::delSocket(const uint16_t sockfd) {
                 close(sock->fallbackfd_);
             }
             sockets_.erase(sock);
+            ++sockets_generation;
             return (true); //socket found
         }
         ++sock;
@@ -170,6 +461,8 @@ IfaceMgr::IfaceMgr()
      control_buf_(new char[control_buf_len_]),
      packet_filter_(new PktFilterInet()),
      packet_filter6_(new PktFilterInet6()),
+     receive_set4_(new ReceiveSet()),
+     receive_set6_(new ReceiveSet()),
      test_mode_(false)
 {
 
@@ -264,6 +557,7 @@ void IfaceMgr::closeSockets() {
     BOOST_FOREACH(IfacePtr iface, ifaces_) {
         iface->closeSockets();
     }
+    clearQueues();
 }
 
 void
@@ -271,6 +565,13 @@ IfaceMgr::closeSockets(const uint16_t family) {
     BOOST_FOREACH(IfacePtr iface, ifaces_) {
         iface->closeSockets(family);
     }
+    if (family == AF_INET) {
+        received4_.clear();
+        send_queue4_.clear();
+    } else if (family == AF_INET6) {
+        received6_.clear();
+        send_queue6_.clear();
+    }
 }
 
 IfaceMgr::~IfaceMgr() {
@@ -305,6 +606,7 @@ IfaceMgr::addExternalSocket(int socketfd, SocketCallback callback) {
     x.socket_ = socketfd;
     x.callback_ = callback;
     callbacks_.push_back(x);
+    ++sockets_generation;
 }
 
 void
@@ -313,6 +615,7 @@ IfaceMgr::deleteExternalSocket(int socketfd) {
          s != callbacks_.end(); ++s) {
         if (s->socket_ == socketfd) {
             callbacks_.erase(s);
+            ++sockets_generation;
             return;
         }
     }
@@ -321,6 +624,7 @@ IfaceMgr::deleteExternalSocket(int socketfd) {
 void
 IfaceMgr::deleteAllExternalSockets() {
     callbacks_.clear();
+    ++sockets_generation;
 }
 
 void
@@ -673,9 +977,17 @@ IfaceMgr::getIface(const std::string& ifname) {
     return (IfacePtr()); // not found
 }
 
+void
+IfaceMgr::addInterface(const IfacePtr& iface) {
+    ifaces_.push_back(iface);
+    ++sockets_generation;
+}
+
 void
 IfaceMgr::clearIfaces() {
     ifaces_.clear();
+    ++sockets_generation;
+    clearQueues();
 }
 
 void
@@ -879,189 +1191,149 @@ IfaceMgr::send(const Pkt4Ptr& pkt) {
     return (packet_filter_->send(*iface, getSocket(*pkt).sockfd_, pkt));
 }
 
-
-Pkt4Ptr IfaceMgr::receive4(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */) {
-    // Sanity check for microsecond timeout.
-    if (timeout_usec >= 1000000) {
-        isc_throw(BadValue, "fractional timeout must be shorter than"
-                  " one million microseconds");
+void
+IfaceMgr::queueSend(const Pkt6Ptr& pkt) {
+    IfacePtr iface = getIface(pkt->getIface());
+    if (!iface) {
+        isc_throw(BadValue, "Unable to send DHCPv6 message. Invalid interface ("
+                  << pkt->getIface() << ") specified.");
     }
-    boost::scoped_ptr<SocketInfo> candidate;
-    IfacePtr iface;
-    fd_set sockets;
-    int maxfd = 0;
-
-    FD_ZERO(&sockets);
-
-    /// @todo: marginal performance optimization. We could create the set once
-    /// and then use its copy for select(). Please note that select() modifies
-    /// provided set to indicated which sockets have something to read.
-    BOOST_FOREACH(iface, ifaces_) {
-        BOOST_FOREACH(SocketInfo s, iface->getSockets()) {
+    send_queue6_.push_back(QueuedPacket<Pkt6Ptr>(iface, getSocket(*pkt), pkt));
+}
 
-            // Only deal with IPv4 addresses.
-            if (s.addr_.isV4()) {
+void
+IfaceMgr::queueSend(const Pkt4Ptr& pkt) {
+    IfacePtr iface = getIface(pkt->getIface());
+    if (!iface) {
+        isc_throw(BadValue, "Unable to send DHCPv4 message. Invalid interface ("
+                  << pkt->getIface() << ") specified.");
+    }
+    send_queue4_.push_back(QueuedPacket<Pkt4Ptr>(iface,
+                                                 getSocket(*pkt).sockfd_,
+                                                 pkt));
+}
 
-                // Add this socket to listening set
-                FD_SET(s.sockfd_, &sockets);
-                if (maxfd < s.sockfd_) {
-                    maxfd = s.sockfd_;
-                }
-            }
-        }
+void
+IfaceMgr::flushSendQueue6(std::vector<Pkt6Ptr>& sent) {
+    std::vector<QueuedPacket<Pkt6Ptr> > queue;
+    queue.swap(send_queue6_);
+
+    // Group the packets by socket, preserving their order.
+    std::map<uint16_t, std::vector<Pkt6Ptr> > pkts;
+    std::map<uint16_t, IfacePtr> ifaces;
+    BOOST_FOREACH(const QueuedPacket<Pkt6Ptr>& queued, queue) {
+        pkts[queued.sockfd_].push_back(queued.pkt_);
+        ifaces[queued.sockfd_] = queued.iface_;
     }
 
-    // if there are any callbacks for external sockets registered...
-    if (!callbacks_.empty()) {
-        BOOST_FOREACH(SocketCallbackInfo s, callbacks_) {
-            FD_SET(s.socket_, &sockets);
-            if (maxfd < s.socket_) {
-                maxfd = s.socket_;
+    const size_t sent_before = sent.size();
+    std::string error;
+    for (std::map<uint16_t, std::vector<Pkt6Ptr> >::const_iterator it =
+             pkts.begin(); it != pkts.end(); ++it) {
+        try {
+            // Assuming that packet filter is not NULL, because its
+            // modifier checks it.
+            packet_filter6_->sendBatch(*ifaces[it->first], it->first,
+                                       it->second, sent);
+        } catch (const std::exception& ex) {
+            if (error.empty()) {
+                error = ex.what();
             }
         }
     }
-
-    struct timeval select_timeout;
-    select_timeout.tv_sec = timeout_sec;
-    select_timeout.tv_usec = timeout_usec;
-
-    // zero out the errno to be safe
-    errno = 0;
-
-    int result = select(maxfd + 1, &sockets, NULL, NULL, &select_timeout);
-
-    if (result == 0) {
-        // nothing received and timeout has been reached
-        return (Pkt4Ptr()); // NULL
-
-    } else if (result < 0) {
-        // In most cases we would like to know whether select() returned
-        // an error because of a signal being received  or for some other
-        // reason. This is because DHCP servers use signals to trigger
-        // certain actions, like reconfiguration or graceful shutdown.
-        // By catching a dedicated exception the caller will know if the
-        // error returned by the function is due to the reception of the
-        // signal or for some other reason.
-        if (errno == EINTR) {
-            isc_throw(SignalInterruptOnSelect, strerror(errno));
-        } else {
-            isc_throw(SocketReadError, strerror(errno));
-        }
+    if (!error.empty()) {
+        isc_throw(SocketWriteError, "sent " << (sent.size() - sent_before)
+                  << " of " << queue.size() << " queued DHCPv6 packets: "
+                  << error);
     }
+}
 
-    // Let's find out which socket has the data
-    BOOST_FOREACH(SocketCallbackInfo s, callbacks_) {
-        if (!FD_ISSET(s.socket_, &sockets)) {
-            continue;
-        }
-
-        // something received over external socket
-
-        // Calling the external socket's callback provides its service
-        // layer access without integrating any specific features
-        // in IfaceMgr
-        if (s.callback_) {
-            s.callback_();
-        }
-
-        return (Pkt4Ptr());
+void
+IfaceMgr::flushSendQueue4(std::vector<Pkt4Ptr>& sent) {
+    std::vector<QueuedPacket<Pkt4Ptr> > queue;
+    queue.swap(send_queue4_);
+
+    // Group the packets by socket, preserving their order.
+    std::map<uint16_t, std::vector<Pkt4Ptr> > pkts;
+    std::map<uint16_t, IfacePtr> ifaces;
+    BOOST_FOREACH(const QueuedPacket<Pkt4Ptr>& queued, queue) {
+        pkts[queued.sockfd_].push_back(queued.pkt_);
+        ifaces[queued.sockfd_] = queued.iface_;
     }
 
-    // Let's find out which interface/socket has the data
-    BOOST_FOREACH(iface, ifaces_) {
-        BOOST_FOREACH(SocketInfo s, iface->getSockets()) {
-            if (FD_ISSET(s.sockfd_, &sockets)) {
-                candidate.reset(new SocketInfo(s));
-                break;
+    const size_t sent_before = sent.size();
+    std::string error;
+    for (std::map<uint16_t, std::vector<Pkt4Ptr> >::const_iterator it =
+             pkts.begin(); it != pkts.end(); ++it) {
+        try {
+            // Assuming that packet filter is not NULL, because its
+            // modifier checks it.
+            packet_filter_->sendBatch(*ifaces[it->first], it->first,
+                                      it->second, sent);
+        } catch (const std::exception& ex) {
+            if (error.empty()) {
+                error = ex.what();
             }
         }
-        if (candidate) {
-            break;
-        }
     }
-
-    if (!candidate) {
-        isc_throw(SocketReadError, "received data over unknown socket");
+    if (!error.empty()) {
+        isc_throw(SocketWriteError, "sent " << (sent.size() - sent_before)
+                  << " of " << queue.size() << " queued DHCPv4 packets: "
+                  << error);
     }
-
-    // Now we have a socket, let's get some data from it!
-    // Assuming that packet filter is not NULL, because its modifier checks it.
-    return (packet_filter_->receive(*iface, *candidate));
 }
 
-Pkt6Ptr IfaceMgr::receive6(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */ ) {
+void
+IfaceMgr::waitForData(const uint16_t family, const uint32_t timeout_sec,
+                      const uint32_t timeout_usec, std::vector<int>& ready) {
     // Sanity check for microsecond timeout.
     if (timeout_usec >= 1000000) {
         isc_throw(BadValue, "fractional timeout must be shorter than"
                   " one million microseconds");
     }
 
-    boost::scoped_ptr<SocketInfo> candidate;
-    fd_set sockets;
-    int maxfd = 0;
-
-    FD_ZERO(&sockets);
-
-    /// @todo: marginal performance optimization. We could create the set once
-    /// and then use its copy for select(). Please note that select() modifies
-    /// provided set to indicated which sockets have something to read.
-    BOOST_FOREACH(IfacePtr iface, ifaces_) {
-
-        BOOST_FOREACH(SocketInfo s, iface->getSockets()) {
-            // Only deal with IPv6 addresses.
-            if (s.addr_.isV6()) {
-
-                // Add this socket to listening set
-                FD_SET(s.sockfd_, &sockets);
-                if (maxfd < s.sockfd_) {
-                    maxfd = s.sockfd_;
+    // Collect the sockets to be waited for only when sockets or
+    // interfaces have been added or removed since the last call. The
+    // generation is read first so as a concurrent change is detected
+    // by the next call.
+    ReceiveSet& set = (family == AF_INET) ? *receive_set4_ : *receive_set6_;
+    if (set.isStale()) {
+        const uint64_t generation = sockets_generation.load();
+        std::vector<int> fds;
+        ReceiveSet::SocketMap sockets;
+        BOOST_FOREACH(const IfacePtr& iface, ifaces_) {
+            BOOST_FOREACH(const SocketInfo& s, iface->getSockets()) {
+                if ((family == AF_INET) ? s.addr_.isV4() : s.addr_.isV6()) {
+                    fds.push_back(s.sockfd_);
+                    sockets.insert(std::make_pair(s.sockfd_,
+                                                  ReceiveSet::Socket(iface, s)));
                 }
             }
         }
-    }
-
-    // if there are any callbacks for external sockets registered...
-    if (!callbacks_.empty()) {
-        BOOST_FOREACH(SocketCallbackInfo s, callbacks_) {
-            // Add it to the set as well
-            FD_SET(s.socket_, &sockets);
-            if (maxfd < s.socket_) {
-                maxfd = s.socket_;
-            }
+        BOOST_FOREACH(const SocketCallbackInfo& s, callbacks_) {
+            fds.push_back(s.socket_);
         }
+        set.update(generation, fds, sockets);
     }
+    set.wait(timeout_sec, timeout_usec, ready);
+}
 
-    struct timeval select_timeout;
-    select_timeout.tv_sec = timeout_sec;
-    select_timeout.tv_usec = timeout_usec;
-
-    // zero out the errno to be safe
-    errno = 0;
-
-    int result = select(maxfd + 1, &sockets, NULL, NULL, &select_timeout);
-
-    if (result == 0) {
-        // nothing received and timeout has been reached
-        return (Pkt6Ptr()); // NULL
-
-    } else if (result < 0) {
-        // In most cases we would like to know whether select() returned
-        // an error because of a signal being received  or for some other
-        // reason. This is because DHCP servers use signals to trigger
-        // certain actions, like reconfiguration or graceful shutdown.
-        // By catching a dedicated exception the caller will know if the
-        // error returned by the function is due to the reception of the
-        // signal or for some other reason.
-        if (errno == EINTR) {
-            isc_throw(SignalInterruptOnSelect, strerror(errno));
-        } else {
-            isc_throw(SocketReadError, strerror(errno));
+bool
+IfaceMgr::handleExternalSockets(const ReceiveSet& set,
+                                const std::vector<int>& ready) {
+    bool external = false;
+    BOOST_FOREACH(int fd, ready) {
+        if (!set.getSocket(fd)) {
+            external = true;
+            break;
         }
     }
+    if (!external) {
+        return (false);
+    }
 
-    // Let's find out which socket has the data
-    BOOST_FOREACH(SocketCallbackInfo s, callbacks_) {
-        if (!FD_ISSET(s.socket_, &sockets)) {
+    BOOST_FOREACH(const SocketCallbackInfo& s, callbacks_) {
+        if (!std::binary_search(ready.begin(), ready.end(), s.socket_)) {
             continue;
         }
 
@@ -1074,27 +1346,85 @@ Pkt6Ptr IfaceMgr::receive6(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */
             s.callback_();
         }
 
-        return (Pkt6Ptr());
+        return (true);
     }
+    return (false);
+}
 
-    // Let's find out which interface/socket has the data
-    BOOST_FOREACH(IfacePtr iface, ifaces_) {
-        BOOST_FOREACH(SocketInfo s, iface->getSockets()) {
-            if (FD_ISSET(s.sockfd_, &sockets)) {
-                candidate.reset(new SocketInfo(s));
-                break;
+void
+IfaceMgr::clearQueues() {
+    received4_.clear();
+    received6_.clear();
+    send_queue4_.clear();
+    send_queue6_.clear();
+}
+
+Pkt4Ptr IfaceMgr::receive4(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */) {
+    // Return the packets read previously first.
+    if (received4_.empty()) {
+        std::vector<int> ready;
+        waitForData(AF_INET, timeout_sec, timeout_usec, ready);
+        if (ready.empty() || handleExternalSockets(*receive_set4_, ready)) {
+            // nothing received and timeout has been reached or data
+            // received over external socket.
+            return (Pkt4Ptr()); // NULL
+        }
+
+        // Drain all readable sockets.
+        std::vector<Pkt4Ptr> pkts;
+        BOOST_FOREACH(int fd, ready) {
+            const ReceiveSet::Socket* s = receive_set4_->getSocket(fd);
+            if (s) {
+                // Assuming that packet filter is not NULL, because its
+                // modifier checks it.
+                pkts.clear();
+                packet_filter_->receiveBatch(*s->iface_, s->socket_,
+                                             RECEIVE_BATCH_SIZE, pkts);
+                received4_.insert(received4_.end(), pkts.begin(), pkts.end());
             }
         }
-        if (candidate) {
-            break;
+    }
+
+    if (received4_.empty()) {
+        return (Pkt4Ptr());
+    }
+    Pkt4Ptr pkt = received4_.front();
+    received4_.pop_front();
+    return (pkt);
+}
+
+Pkt6Ptr IfaceMgr::receive6(uint32_t timeout_sec, uint32_t timeout_usec /* = 0 */ ) {
+    // Return the packets read previously first.
+    if (received6_.empty()) {
+        std::vector<int> ready;
+        waitForData(AF_INET6, timeout_sec, timeout_usec, ready);
+        if (ready.empty() || handleExternalSockets(*receive_set6_, ready)) {
+            // nothing received and timeout has been reached or data
+            // received over external socket.
+            return (Pkt6Ptr()); // NULL
+        }
+
+        // Drain all readable sockets.
+        std::vector<Pkt6Ptr> pkts;
+        BOOST_FOREACH(int fd, ready) {
+            const ReceiveSet::Socket* s = receive_set6_->getSocket(fd);
+            if (s) {
+                // Assuming that packet filter is not NULL, because its
+                // modifier checks it.
+                pkts.clear();
+                packet_filter6_->receiveBatch(s->socket_, RECEIVE_BATCH_SIZE,
+                                              pkts);
+                received6_.insert(received6_.end(), pkts.begin(), pkts.end());
+            }
         }
     }
 
-    if (!candidate) {
-        isc_throw(SocketReadError, "received data over unknown socket");
+    if (received6_.empty()) {
+        return (Pkt6Ptr());
     }
-    // Assuming that packet filter is not NULL, because its modifier checks it.
-    return (packet_filter6_->receive(*candidate));
+    Pkt6Ptr pkt = received6_.front();
+    received6_.pop_front();
+    return (pkt);
 }
 
 uint16_t IfaceMgr::getSocket(const isc::dhcp::Pkt6& pkt) {
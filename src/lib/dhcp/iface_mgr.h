@@ -19,8 +19,10 @@
 #include <boost/function.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/scoped_array.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 
+#include <deque>
 #include <list>
 #include <vector>
 
@@ -354,9 +356,7 @@ public:
     /// @brief Adds socket descriptor to an interface.
     ///
     /// @param sock SocketInfo structure that describes socket.
-    void addSocket(const SocketInfo& sock) {
-        sockets_.push_back(sock);
-    }
+    void addSocket(const SocketInfo& sock);
 
     /// @brief Closes socket.
     ///
@@ -545,6 +545,12 @@ public:
     /// we don't support packets larger than 1500.
     static const uint32_t RCVBUFSIZE = 1500;
 
+    /// @brief Maximum number of packets read from a socket at once.
+    ///
+    /// When a socket becomes readable, the packets pending on it are read
+    /// with as few system calls as possible and queued for processing.
+    static const size_t RECEIVE_BATCH_SIZE = 32;
+
     // TODO performance improvement: we may change this into
     //      2 maps (ifindex-indexed and name-indexed) and
     //      also hide it (make it public make tests easier for now)
@@ -710,6 +716,74 @@ public:
     /// @return true if sending was successful
     bool send(const Pkt4Ptr& pkt);
 
+    /// @brief Queues an IPv6 packet to be sent by @c flushSendQueue6.
+    ///
+    /// The packets queued while processing a batch of received packets
+    /// are sent together, which reduces the number of system calls.
+    ///
+    /// @param pkt packet to be sent
+    ///
+    /// @throw isc::BadValue if invalid interface specified in the packet.
+    /// @throw isc::dhcp::SocketNotFound if there is no socket to send the
+    /// packet.
+    void queueSend(const Pkt6Ptr& pkt);
+
+    /// @brief Queues an IPv4 packet to be sent by @c flushSendQueue4.
+    ///
+    /// The packets queued while processing a batch of received packets
+    /// are sent together, which reduces the number of system calls.
+    ///
+    /// @param pkt a packet to be sent
+    ///
+    /// @throw isc::BadValue if invalid interface specified in the packet.
+    /// @throw isc::dhcp::SocketNotFound if there is no socket to send the
+    /// packet.
+    void queueSend(const Pkt4Ptr& pkt);
+
+    /// @brief Sends the queued IPv6 packets.
+    ///
+    /// The packets to be sent through the same socket are passed to the
+    /// packet filter at once. The queue is emptied even if some packets
+    /// can't be sent.
+    ///
+    /// @param [out] sent packets which have been sent are appended to
+    /// it, also when the exception is thrown.
+    ///
+    /// @throw isc::dhcp::SocketWriteError if any of the packets couldn't
+    /// be sent.
+    void flushSendQueue6(std::vector<Pkt6Ptr>& sent);
+
+    /// @brief Sends the queued IPv4 packets.
+    ///
+    /// The packets to be sent through the same socket are passed to the
+    /// packet filter at once. The queue is emptied even if some packets
+    /// can't be sent.
+    ///
+    /// @param [out] sent packets which have been sent are appended to
+    /// it, also when the exception is thrown.
+    ///
+    /// @throw isc::dhcp::SocketWriteError if any of the packets couldn't
+    /// be sent.
+    void flushSendQueue4(std::vector<Pkt4Ptr>& sent);
+
+    /// @brief Checks if there are received IPv6 packets which haven't been
+    /// returned by @c receive6 yet.
+    ///
+    /// @return true if the next call to @c receive6 returns a packet
+    /// without waiting.
+    bool hasReceivedPackets6() const {
+        return (!received6_.empty());
+    }
+
+    /// @brief Checks if there are received IPv4 packets which haven't been
+    /// returned by @c receive4 yet.
+    ///
+    /// @return true if the next call to @c receive4 returns a packet
+    /// without waiting.
+    bool hasReceivedPackets4() const {
+        return (!received4_.empty());
+    }
+
     /// @brief Tries to receive DHCPv6 message over open IPv6 sockets.
     ///
     /// Attempts to receive a single DHCPv6 message over any of the open IPv6
@@ -719,6 +793,11 @@ public:
     /// This method also checks if data arrived over registered external socket.
     /// This data may be of a different protocol family than AF_INET6.
     ///
+    /// The sockets are waited for using epoll, when it is available, or
+    /// select(). All messages pending on the readable sockets are read at
+    /// once (up to @c RECEIVE_BATCH_SIZE per socket) and queued. The
+    /// subsequent calls return the queued messages without waiting.
+    ///
     /// @param timeout_sec specifies integral part of the timeout (in seconds)
     /// @param timeout_usec specifies fractional part of the timeout
     /// (in microseconds)
@@ -726,8 +805,8 @@ public:
     /// @throw isc::BadValue if timeout_usec is greater than one million
     /// @throw isc::dhcp::SocketReadError if error occurred when receiving a
     /// packet.
-    /// @throw isc::dhcp::SignalInterruptOnSelect when a call to select() is
-    /// interrupted by a signal.
+    /// @throw isc::dhcp::SignalInterruptOnSelect when a call to select() or
+    /// epoll_wait() is interrupted by a signal.
     ///
     /// @return Pkt6 object representing received packet (or NULL)
     Pkt6Ptr receive6(uint32_t timeout_sec, uint32_t timeout_usec = 0);
@@ -741,6 +820,11 @@ public:
     /// This method also checks if data arrived over registered external socket.
     /// This data may be of a different protocol family than AF_INET.
     ///
+    /// The sockets are waited for using epoll, when it is available, or
+    /// select(). All messages pending on the readable sockets are read at
+    /// once (up to @c RECEIVE_BATCH_SIZE per socket) and queued. The
+    /// subsequent calls return the queued messages without waiting.
+    ///
     /// @param timeout_sec specifies integral part of the timeout (in seconds)
     /// @param timeout_usec specifies fractional part of the timeout
     /// (in microseconds)
@@ -748,8 +832,8 @@ public:
     /// @throw isc::BadValue if timeout_usec is greater than one million
     /// @throw isc::dhcp::SocketReadError if error occurred when receiving a
     /// packet.
-    /// @throw isc::dhcp::SignalInterruptOnSelect when a call to select() is
-    /// interrupted by a signal.
+    /// @throw isc::dhcp::SignalInterruptOnSelect when a call to select() or
+    /// epoll_wait() is interrupted by a signal.
     ///
     /// @return Pkt4 object representing received packet (or NULL)
     Pkt4Ptr receive4(uint32_t timeout_sec, uint32_t timeout_usec = 0);
@@ -1055,9 +1139,7 @@ public:
     /// @param iface reference to Iface object.
     /// @note This function must be public because it has to be callable
     /// from unit tests.
-    void addInterface(const IfacePtr& iface) {
-        ifaces_.push_back(iface);
-    }
+    void addInterface(const IfacePtr& iface);
 
     /// @brief Checks if there is at least one socket of the specified family
     /// open.
@@ -1212,9 +1294,86 @@ private:
     /// setPacketFilter method.
     PktFilter6Ptr packet_filter6_;
 
+    /// @brief Forward declaration of the set of sockets waited for by the
+    /// @c receive4 and @c receive6 methods.
+    class ReceiveSet;
+
+    /// @brief Waits for the data over the sockets of the specified family
+    /// and the external sockets.
+    ///
+    /// @param family Family of the sockets: AF_INET or AF_INET6.
+    /// @param timeout_sec Integral part of the timeout (in seconds).
+    /// @param timeout_usec Fractional part of the timeout (in microseconds).
+    /// @param [out] ready Sorted descriptors of the readable sockets.
+    ///
+    /// @throw isc::dhcp::SocketReadError if error occurred when waiting.
+    /// @throw isc::dhcp::SignalInterruptOnSelect when the wait is
+    /// interrupted by a signal.
+    void waitForData(const uint16_t family, const uint32_t timeout_sec,
+                     const uint32_t timeout_usec, std::vector<int>& ready);
+
+    /// @brief Calls the callback of the first readable external socket.
+    ///
+    /// The external sockets are searched only when some of the readable
+    /// sockets are not interface sockets.
+    ///
+    /// @param set Set of the sockets which have been waited for.
+    /// @param ready Sorted descriptors of the readable sockets.
+    ///
+    /// @return true if a callback has been called, false otherwise.
+    bool handleExternalSockets(const ReceiveSet& set,
+                               const std::vector<int>& ready);
+
+    /// @brief Discards the received packets which haven't been returned
+    /// by @c receive4 and @c receive6 and the packets queued to be sent.
+    ///
+    /// It is called when the sockets are closed.
+    void clearQueues();
+
     /// @brief Contains list of callbacks for external sockets
     SocketCallbackInfoContainer callbacks_;
 
+    /// @brief Sockets waited for by @c receive4.
+    boost::scoped_ptr<ReceiveSet> receive_set4_;
+
+    /// @brief Sockets waited for by @c receive6.
+    boost::scoped_ptr<ReceiveSet> receive_set6_;
+
+    /// @brief DHCPv4 packets received but not returned yet by @c receive4.
+    std::deque<Pkt4Ptr> received4_;
+
+    /// @brief DHCPv6 packets received but not returned yet by @c receive6.
+    std::deque<Pkt6Ptr> received6_;
+
+    /// @brief Packet queued to be sent.
+    template<typename PktPtrType>
+    struct QueuedPacket {
+        /// @brief Constructor.
+        ///
+        /// @param iface Interface to be used to send the packet.
+        /// @param sockfd Socket to be used to send the packet.
+        /// @param pkt Packet to be sent.
+        QueuedPacket(const IfacePtr& iface, const uint16_t sockfd,
+                     const PktPtrType& pkt)
+            : iface_(iface), sockfd_(sockfd), pkt_(pkt) {
+        }
+
+        /// @brief Interface to be used to send the packet.
+        IfacePtr iface_;
+
+        /// @brief Socket to be used to send the packet.
+        uint16_t sockfd_;
+
+        /// @brief Packet to be sent.
+        PktPtrType pkt_;
+    };
+
+    /// @brief DHCPv4 packets queued by @c queueSend.
+    std::vector<QueuedPacket<Pkt4Ptr> > send_queue4_;
+
+    /// @brief DHCPv6 packets queued by @c queueSend.
+    std::vector<QueuedPacket<Pkt6Ptr> > send_queue6_;
+
     /// @brief Indicates if the IfaceMgr is in the test mode.
     bool test_mode_;
 };
@@ -330,8 +330,18 @@ size_t LibDHCP::unpackOptions6(const OptionBuffer& buf,
                                isc::dhcp::OptionCollection& options,
                                size_t* relay_msg_offset /* = 0 */,
                                size_t* relay_msg_len /* = 0 */) {
+    return (unpackOptions6(buf.begin(), buf.end(), option_space, options,
+                           relay_msg_offset, relay_msg_len));
+}
+
+size_t LibDHCP::unpackOptions6(OptionBufferConstIter begin,
+                               OptionBufferConstIter end,
+                               const std::string& option_space,
+                               isc::dhcp::OptionCollection& options,
+                               size_t* relay_msg_offset /* = 0 */,
+                               size_t* relay_msg_len /* = 0 */) {
     size_t offset = 0;
-    size_t length = buf.size();
+    size_t length = std::distance(begin, end);
     size_t last_offset = 0;
 
     // Get the list of standard option definitions.
@@ -362,10 +372,10 @@ size_t LibDHCP::unpackOptions6(const OptionBuffer& buf,
         }
 
         // Parse the option header
-        uint16_t opt_type = isc::util::readUint16(&buf[offset], 2);
+        uint16_t opt_type = isc::util::readUint16(&begin[offset], 2);
         offset += 2;
 
-        uint16_t opt_len = isc::util::readUint16(&buf[offset], 2);
+        uint16_t opt_len = isc::util::readUint16(&begin[offset], 2);
         offset += 2;
 
         if (offset + opt_len > length) {
@@ -399,8 +409,8 @@ size_t LibDHCP::unpackOptions6(const OptionBuffer& buf,
             }
 
             // Parse this as vendor option
-            OptionPtr vendor_opt(new OptionVendor(Option::V6, buf.begin() + offset,
-                                                  buf.begin() + offset + opt_len));
+            OptionPtr vendor_opt(new OptionVendor(Option::V6, begin + offset,
+                                                  begin + offset + opt_len));
             options.insert(std::make_pair(opt_type, vendor_opt));
 
             offset += opt_len;
@@ -444,16 +454,16 @@ size_t LibDHCP::unpackOptions6(const OptionBuffer& buf,
             // all options and we will remove this elseif. For now,
             // return generic option.
             opt = OptionPtr(new Option(Option::V6, opt_type,
-                                       buf.begin() + offset,
-                                       buf.begin() + offset + opt_len));
+                                       begin + offset,
+                                       begin + offset + opt_len));
         } else {
             // The option definition has been found. Use it to create
             // the option instance from the provided buffer chunk.
             const OptionDefinitionPtr& def = *(range.first);
             assert(def);
             opt = def->optionFactory(Option::V6, opt_type,
-                                     buf.begin() + offset,
-                                     buf.begin() + offset + opt_len);
+                                     begin + offset,
+                                     begin + offset + opt_len);
         }
         // add option to options
         options.insert(std::make_pair(opt_type, opt));
@@ -468,8 +478,18 @@ size_t LibDHCP::unpackOptions4(const OptionBuffer& buf,
                                const std::string& option_space,
                                isc::dhcp::OptionCollection& options,
                                std::list<uint16_t>& deferred) {
+    return (unpackOptions4(buf.begin(), buf.end(), option_space, options,
+                           deferred));
+}
+
+size_t LibDHCP::unpackOptions4(OptionBufferConstIter begin,
+                               OptionBufferConstIter end,
+                               const std::string& option_space,
+                               isc::dhcp::OptionCollection& options,
+                               std::list<uint16_t>& deferred) {
     size_t offset = 0;
     size_t last_offset = 0;
+    const size_t length = std::distance(begin, end);
 
     // Get the list of standard option definitions.
     const OptionDefContainerPtr& option_defs = LibDHCP::getOptionDefs(option_space);
@@ -484,12 +504,12 @@ size_t LibDHCP::unpackOptions4(const OptionBuffer& buf,
 
     // The buffer being read comprises a set of options, each starting with
     // a one-byte type code and a one-byte length field.
-    while (offset < buf.size()) {
+    while (offset < length) {
         // Save the current offset for backtracking
         last_offset = offset;
 
         // Get the option type
-        uint8_t opt_type = buf[offset++];
+        uint8_t opt_type = begin[offset++];
 
         // DHO_END is a special, one octet long option
         if (opt_type == DHO_END) {
@@ -504,7 +524,7 @@ size_t LibDHCP::unpackOptions4(const OptionBuffer& buf,
         if (opt_type == DHO_PAD)
             continue;
 
-        if (offset + 1 > buf.size()) {
+        if (offset + 1 > length) {
             // We peeked at the option header of the next option, but
             // discovered that it would end up beyond buffer end, so
             // the option is truncated. Hence we can't parse
@@ -515,8 +535,8 @@ size_t LibDHCP::unpackOptions4(const OptionBuffer& buf,
             return (last_offset);
         }
 
-        uint8_t opt_len =  buf[offset++];
-        if (offset + opt_len > buf.size()) {
+        uint8_t opt_len =  begin[offset++];
+        if (offset + opt_len > length) {
             // We peeked at the option header of the next option, but
             // discovered that it would end up beyond buffer end, so
             // the option is truncated. Hence we can't parse
@@ -563,8 +583,8 @@ size_t LibDHCP::unpackOptions4(const OptionBuffer& buf,
                       " is implemented");
         } else if (num_defs == 0) {
             opt = OptionPtr(new Option(Option::V4, opt_type,
-                                       buf.begin() + offset,
-                                       buf.begin() + offset + opt_len));
+                                       begin + offset,
+                                       begin + offset + opt_len));
             opt->setEncapsulatedSpace(DHCP4_OPTION_SPACE);
         } else {
             // The option definition has been found. Use it to create
@@ -572,8 +592,8 @@ size_t LibDHCP::unpackOptions4(const OptionBuffer& buf,
             const OptionDefinitionPtr& def = *(range.first);
             assert(def);
             opt = def->optionFactory(Option::V4, opt_type,
-                                     buf.begin() + offset,
-                                     buf.begin() + offset + opt_len);
+                                     begin + offset,
+                                     begin + offset + opt_len);
         }
 
         options.insert(std::make_pair(opt_type, opt));
@@ -583,6 +603,58 @@ size_t LibDHCP::unpackOptions4(const OptionBuffer& buf,
     return (last_offset);
 }
 
+size_t LibDHCP::scanOptions6(OptionBufferConstIter begin,
+                             OptionBufferConstIter end,
+                             OptionLocations& locations) {
+    size_t offset = 0;
+    const size_t length = std::distance(begin, end);
+
+    // This follows unpackOptions6 so the same options are found.
+    while (offset + 4 <= length) {
+        uint16_t opt_type = isc::util::readUint16(&begin[offset], 2);
+        uint16_t opt_len = isc::util::readUint16(&begin[offset + 2], 2);
+        if ((offset + 4 + opt_len > length) ||
+            ((opt_type == D6O_VENDOR_OPTS) && (offset + 8 > length))) {
+            return (offset);
+        }
+
+        OptionLocation location = { opt_type, offset,
+                                    static_cast<size_t>(4 + opt_len) };
+        locations.push_back(location);
+        offset += 4 + opt_len;
+    }
+    return (offset);
+}
+
+size_t LibDHCP::scanOptions4(OptionBufferConstIter begin,
+                             OptionBufferConstIter end,
+                             OptionLocations& locations) {
+    size_t offset = 0;
+    const size_t length = std::distance(begin, end);
+
+    // This follows unpackOptions4 so the same options are found.
+    while (offset < length) {
+        uint8_t opt_type = begin[offset];
+        if (opt_type == DHO_END) {
+            return (offset);
+        }
+        if (opt_type == DHO_PAD) {
+            ++offset;
+            continue;
+        }
+        if ((offset + 2 > length) ||
+            (offset + 2 + begin[offset + 1] > length)) {
+            return (offset);
+        }
+
+        OptionLocation location = { opt_type, offset,
+                                    static_cast<size_t>(2 + begin[offset + 1]) };
+        locations.push_back(location);
+        offset += location.length_;
+    }
+    return (offset);
+}
+
 size_t LibDHCP::unpackVendorOptions6(const uint32_t vendor_id,
                                      const OptionBuffer& buf,
                                      isc::dhcp::OptionCollection& options) {
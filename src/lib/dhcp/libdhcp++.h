@@ -238,6 +238,32 @@ public:
                                  size_t* relay_msg_offset = 0,
                                  size_t* relay_msg_len = 0);
 
+    /// @brief Parses DHCPv6 options held in a part of a buffer.
+    ///
+    /// This variant of @ref unpackOptions6 avoids copying the part of
+    /// the buffer holding the options, e.g. the options of the message
+    /// encapsulated in a relay-msg option. The offsets are relative to
+    /// the beginning of the range.
+    ///
+    /// @param begin Iterator pointing to the beginning of the options.
+    /// @param end Iterator pointing to the end of the options.
+    /// @param option_space A name of the option space which holds definitions
+    ///        to be used to parse options in the packets.
+    /// @param options Reference to option container. Options will be
+    ///        put here.
+    /// @param relay_msg_offset reference to a size_t structure. If specified,
+    ///        offset to beginning of relay_msg option will be stored in it.
+    /// @param relay_msg_len reference to a size_t structure. If specified,
+    ///        length of the relay_msg option will be stored in it.
+    /// @return offset to the first byte after the last successfully
+    /// parsed option
+    static size_t unpackOptions6(OptionBufferConstIter begin,
+                                 OptionBufferConstIter end,
+                                 const std::string& option_space,
+                                 isc::dhcp::OptionCollection& options,
+                                 size_t* relay_msg_offset = 0,
+                                 size_t* relay_msg_len = 0);
+
     /// @brief Parses provided buffer as DHCPv4 options and creates
     /// Option objects.
     ///
@@ -260,6 +286,62 @@ public:
                                  isc::dhcp::OptionCollection& options,
                                  std::list<uint16_t>& deferred);
 
+    /// @brief Parses DHCPv4 options held in a part of a buffer.
+    ///
+    /// This variant of @ref unpackOptions4 avoids copying the part of
+    /// the buffer holding the options. The offsets are relative to the
+    /// beginning of the range.
+    ///
+    /// @param begin Iterator pointing to the beginning of the options.
+    /// @param end Iterator pointing to the end of the options.
+    /// @param option_space A name of the option space which holds definitions
+    ///        to be used to parse options in the packets.
+    /// @param options Reference to option container. Options will be
+    ///        put here.
+    /// @param deferred Reference to an option code list. Options which
+    ///        processing is deferred will be put here.
+    /// @return offset to the first byte after the last successfully
+    /// parsed option or the offset of the DHO_END option type.
+    static size_t unpackOptions4(OptionBufferConstIter begin,
+                                 OptionBufferConstIter end,
+                                 const std::string& option_space,
+                                 isc::dhcp::OptionCollection& options,
+                                 std::list<uint16_t>& deferred);
+
+    /// @brief Finds the DHCPv6 options held in a part of a buffer.
+    ///
+    /// This function walks the options the same way as
+    /// @ref unpackOptions6 but it only records their locations without
+    /// creating the options. The option found at a location can be
+    /// created later by calling @ref unpackOptions6 for the range it
+    /// occupies.
+    ///
+    /// @param begin Iterator pointing to the beginning of the options.
+    /// @param end Iterator pointing to the end of the options.
+    /// @param [out] locations Locations of the options relative to the
+    ///        beginning of the range. The found options are appended.
+    /// @return offset to the first byte after the last option found.
+    static size_t scanOptions6(OptionBufferConstIter begin,
+                               OptionBufferConstIter end,
+                               OptionLocations& locations);
+
+    /// @brief Finds the DHCPv4 options held in a part of a buffer.
+    ///
+    /// This function walks the options the same way as
+    /// @ref unpackOptions4 but it only records their locations without
+    /// creating the options. The pad options are skipped and the
+    /// search stops at the end option.
+    ///
+    /// @param begin Iterator pointing to the beginning of the options.
+    /// @param end Iterator pointing to the end of the options.
+    /// @param [out] locations Locations of the options relative to the
+    ///        beginning of the range. The found options are appended.
+    /// @return offset to the first byte after the last option found or
+    /// the offset of the DHO_END option type.
+    static size_t scanOptions4(OptionBufferConstIter begin,
+                               OptionBufferConstIter end,
+                               OptionLocations& locations);
+
     /// Registers factory method that produces options of specific option types.
     ///
     /// @throw isc::BadValue if provided the type is already registered, has
@@ -42,6 +42,23 @@ typedef std::multimap<unsigned int, OptionPtr> OptionCollection;
 /// A pointer to an OptionCollection
 typedef boost::shared_ptr<OptionCollection> OptionCollectionPtr;
 
+/// @brief Location of an option in a buffer.
+///
+/// It is used to unpack the options of a received packet on demand.
+struct OptionLocation {
+    /// @brief Option code.
+    uint16_t type_;
+
+    /// @brief Offset of the option header.
+    size_t offset_;
+
+    /// @brief Length of the option including the header.
+    size_t length_;
+};
+
+/// A collection of option locations in the order of the options
+typedef std::vector<OptionLocation> OptionLocations;
+
 class Option {
 public:
     /// length of the usual DHCPv4 option header (there are exceptions)
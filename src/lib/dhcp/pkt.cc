@@ -1,4 +1,4 @@
-// Copyright (C) 2014-2016 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2014-2017 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -25,7 +25,8 @@ Pkt::Pkt(uint32_t transid, const isc::asiolink::IOAddress& local_addr,
      local_port_(local_port),
      remote_port_(remote_port),
      buffer_out_(0),
-     copy_retrieved_options_(false)
+     copy_retrieved_options_(false),
+     lazy_unpack_(false)
 {
 }
 
@@ -40,7 +41,8 @@ Pkt::Pkt(const uint8_t* buf, uint32_t len, const isc::asiolink::IOAddress& local
      local_port_(local_port),
      remote_port_(remote_port),
      buffer_out_(0),
-     copy_retrieved_options_(false)
+     copy_retrieved_options_(false),
+     lazy_unpack_(false)
 {
 
     if (len != 0) {
@@ -54,11 +56,14 @@ Pkt::Pkt(const uint8_t* buf, uint32_t len, const isc::asiolink::IOAddress& local
 
 void
 Pkt::addOption(const OptionPtr& opt) {
+    // Keep the options of the same type in order.
+    unpackLazyOptions(opt->getType());
     options_.insert(std::pair<int, OptionPtr>(opt->getType(), opt));
 }
 
 OptionPtr
 Pkt::getNonCopiedOption(const uint16_t type) const {
+    unpackLazyOptions(type);
     OptionCollection::const_iterator x = options_.find(type);
     if (x != options_.end()) {
         return (x->second);
@@ -68,6 +73,7 @@ Pkt::getNonCopiedOption(const uint16_t type) const {
 
 OptionPtr
 Pkt::getOption(const uint16_t type) {
+    unpackLazyOptions(type);
     OptionCollection::iterator x = options_.find(type);
     if (x != options_.end()) {
         if (copy_retrieved_options_) {
@@ -81,6 +87,7 @@ Pkt::getOption(const uint16_t type) {
 
 bool
 Pkt::delOption(uint16_t type) {
+    unpackLazyOptions(type);
 
     isc::dhcp::OptionCollection::iterator x = options_.find(type);
     if (x!=options_.end()) {
@@ -91,6 +98,40 @@ Pkt::delOption(uint16_t type) {
     }
 }
 
+void
+Pkt::unpackLazyOptions() const {
+    for (OptionLocations::const_iterator location = lazy_options_.begin();
+         location != lazy_options_.end(); ++location) {
+        unpackLazyOption(*location);
+    }
+    lazy_options_.clear();
+}
+
+void
+Pkt::unpackLazyOptions(const uint16_t type) const {
+    for (OptionLocations::iterator location = lazy_options_.begin();
+         location != lazy_options_.end(); ) {
+        if (location->type_ == type) {
+            unpackLazyOption(*location);
+            location = lazy_options_.erase(location);
+        } else {
+            ++location;
+        }
+    }
+}
+
+void
+Pkt::unpackLazyOption(const OptionLocation& location) const {
+    try {
+        unpackOption(location);
+    } catch (const std::exception& ex) {
+        // The option is discarded. The first error is reported.
+        if (lazy_unpack_error_.empty()) {
+            lazy_unpack_error_ = ex.what();
+        }
+    }
+}
+
 bool
 Pkt::inClass(const std::string& client_class) {
     return (classes_.find(client_class) != classes_.end());
@@ -318,6 +318,27 @@ protected:
     /// if such option is not present.
     OptionPtr getNonCopiedOption(const uint16_t type) const;
 
+    /// @brief Creates the option found at the specified location.
+    ///
+    /// This method is called for the options which are unpacked on
+    /// demand. It creates the option from @ref data_ and adds it to
+    /// the @ref options_ container.
+    ///
+    /// @note This is a pure virtual method and must be implemented in
+    /// the derived classes. The @c Pkt4 and @c Pkt6 class have respective
+    /// implementations of this method.
+    ///
+    /// @param location Location of the option in @ref data_.
+    /// @throw isc::Exception or derived exceptions if the option is
+    /// malformed.
+    virtual void unpackOption(const OptionLocation& location) const = 0;
+
+    /// @brief Creates the option found at the specified location and
+    /// records the error if it is malformed.
+    ///
+    /// @param location Location of the option in @ref data_.
+    void unpackLazyOption(const OptionLocation& location) const;
+
 public:
 
     /// @brief Returns the first option of specified type.
@@ -358,6 +379,10 @@ public:
     /// @param copy Indicates if the options should be copied when
     /// retrieved (if true), or not copied (if false).
     virtual void setCopyRetrievedOptions(const bool copy) {
+        // The hook libraries may walk the options container directly.
+        if (copy) {
+            unpackLazyOptions();
+        }
         copy_retrieved_options_ = copy;
     }
 
@@ -370,6 +395,66 @@ public:
         return (copy_retrieved_options_);
     }
 
+    /// @brief Controls whether the options are unpacked on demand.
+    ///
+    /// By default the @ref unpack method creates all options carried in
+    /// the received packet, although the server typically uses only a
+    /// few of them. When this mode is enabled the @ref unpack method
+    /// only records the locations of the options in the received
+    /// data (@ref data_) and each option is created when the options
+    /// of its type are first retrieved, e.g. with @ref getOption, or
+    /// when all options are needed, e.g. to pack the packet or when
+    /// @ref unpackLazyOptions is called.
+    ///
+    /// An option which can't be created because it is malformed is
+    /// discarded when it is first retrieved rather than by the
+    /// @ref unpack method, and the error is returned by
+    /// @ref getLazyUnpackError. The code processing the packet must
+    /// check it to drop the packet as if the @ref unpack method had
+    /// failed. The code accessing the @ref options_ container directly
+    /// must call @ref unpackLazyOptions first.
+    ///
+    /// The mode must be set before the @ref unpack method is called.
+    ///
+    /// @param lazy Indicates if the options should be unpacked on demand.
+    void setLazyUnpack(const bool lazy) {
+        lazy_unpack_ = lazy;
+    }
+
+    /// @brief Returns whether the options are unpacked on demand.
+    ///
+    /// Also see @ref setLazyUnpack.
+    ///
+    /// @return true if the options are unpacked on demand.
+    bool isLazyUnpack() const {
+        return (lazy_unpack_);
+    }
+
+    /// @brief Creates all options which have not been unpacked yet.
+    ///
+    /// This method must be called before walking the @ref options_
+    /// container directly when the options are unpacked on demand.
+    /// It does nothing when all options have been unpacked. The
+    /// malformed options are discarded (see @ref getLazyUnpackError).
+    void unpackLazyOptions() const;
+
+    /// @brief Creates the options of specified type which have not
+    /// been unpacked yet.
+    ///
+    /// The malformed options are discarded (see @ref getLazyUnpackError).
+    ///
+    /// @param type Option type.
+    void unpackLazyOptions(const uint16_t type) const;
+
+    /// @brief Returns the error of the options unpacked on demand.
+    ///
+    /// @return Description of the first option which couldn't be
+    /// created when it was unpacked on demand or an empty string if
+    /// all options unpacked so far are valid.
+    const std::string& getLazyUnpackError() const {
+        return (lazy_unpack_error_);
+    }
+
     /// @brief Update packet timestamp.
     ///
     /// Updates packet timestamp. This method is invoked
@@ -587,7 +672,11 @@ public:
     /// behavior must be taken into consideration before making
     /// changes to this member such as access scope restriction or
     /// data format change etc.
-    isc::dhcp::OptionCollection options_;
+    ///
+    /// The container is mutable because the options which are unpacked
+    /// on demand (see @ref setLazyUnpack) are added by the const
+    /// accessors.
+    mutable isc::dhcp::OptionCollection options_;
 
 protected:
 
@@ -745,6 +834,24 @@ protected:
     /// @see the documentation for @ref Pkt::setCopyRetrievedOptions.
     bool copy_retrieved_options_;
 
+    /// @brief Indicates if the options are unpacked on demand.
+    ///
+    /// @see the documentation for @ref Pkt::setLazyUnpack.
+    bool lazy_unpack_;
+
+    /// @brief Locations in @ref data_ of the options which have not been
+    /// unpacked yet.
+    ///
+    /// They are held in the order of the options in the packet. The
+    /// unpack method of the derived class fills this container when the
+    /// options are unpacked on demand.
+    mutable OptionLocations lazy_options_;
+
+    /// @brief Error of the first malformed option unpacked on demand.
+    ///
+    /// @see the documentation for @ref Pkt::getLazyUnpackError.
+    mutable std::string lazy_unpack_error_;
+
     /// packet timestamp
     boost::posix_time::ptime timestamp_;
 
@@ -75,6 +75,8 @@ size_t
 Pkt4::len() {
     size_t length = DHCPV4_PKT_HDR_LEN; // DHCPv4 header
 
+    unpackLazyOptions();
+
     // ... and sum of lengths of all options
     for (OptionCollection::const_iterator it = options_.begin();
          it != options_.end();
@@ -135,6 +137,7 @@ Pkt4::pack() {
         // write DHCP magic cookie
         buffer_out_.writeUint32(DHCP_OPTIONS_COOKIE);
 
+        unpackLazyOptions();
         LibDHCP::packOptions4(buffer_out_, options_);
 
         // add END option that indicates end of options
@@ -196,14 +199,31 @@ Pkt4::unpack() {
       isc_throw(Unexpected, "Invalid or missing DHCP magic cookie");
     }
 
-    size_t opts_len = buffer_in.getLength() - buffer_in.getPosition();
-    vector<uint8_t> opts_buffer;
-
-    // Use readVector because a function which parses option requires
-    // a vector as an input.
-    buffer_in.readVector(opts_buffer, opts_len);
+    // The options are parsed in place.
+    const size_t opts_offset = buffer_in.getPosition();
+    OptionBufferConstIter opts_begin = data_.begin() + opts_offset;
+
+    size_t offset = 0;
+    lazy_options_.clear();
+    lazy_unpack_error_.clear();
+    if (lazy_unpack_) {
+        // Only find the options. The deferred options are recorded now
+        // as the server checks them before retrieving the options.
+        offset = LibDHCP::scanOptions4(opts_begin, data_.end(), lazy_options_);
+        for (OptionLocations::iterator location = lazy_options_.begin();
+             location != lazy_options_.end(); ++location) {
+            location->offset_ += opts_offset;
+            if (LibDHCP::shouldDeferOptionUnpack(DHCP4_OPTION_SPACE,
+                                                 location->type_)) {
+                deferred_options_.push_back(location->type_);
+            }
+        }
 
-    size_t offset = LibDHCP::unpackOptions4(opts_buffer, DHCP4_OPTION_SPACE, options_, deferred_options_);
+    } else {
+        offset = LibDHCP::unpackOptions4(opts_begin, data_.end(),
+                                         DHCP4_OPTION_SPACE, options_,
+                                         deferred_options_);
+    }
 
     // If offset is not equal to the size and there is no DHO_END,
     // then something is wrong here. We either parsed past input
@@ -227,6 +247,15 @@ Pkt4::unpack() {
     // so we'll be able to log more detailed drop reason.
 }
 
+void
+Pkt4::unpackOption(const OptionLocation& location) const {
+    // The deferred options have been recorded by unpack().
+    std::list<uint16_t> deferred;
+    OptionBufferConstIter begin = data_.begin() + location.offset_;
+    LibDHCP::unpackOptions4(begin, begin + location.length_,
+                            DHCP4_OPTION_SPACE, options_, deferred);
+}
+
 uint8_t Pkt4::getType() const {
     OptionPtr generic = getNonCopiedOption(DHO_DHCP_MESSAGE_TYPE);
     if (!generic) {
@@ -397,6 +426,9 @@ Pkt4::toText() const {
 
     output << ", transid=0x" << hex << transid_ << dec;
 
+    // The malformed options are not shown.
+    unpackLazyOptions();
+
     if (!options_.empty()) {
         output << "," << std::endl << "options:";
         for (isc::dhcp::OptionCollection::const_iterator opt = options_.begin();
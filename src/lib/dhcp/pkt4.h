@@ -494,6 +494,11 @@ protected:
     /// @brief local HW address (dst if receiving packet, src if sending packet)
     HWAddrPtr local_hwaddr_;
 
+    /// @brief Creates the DHCPv4 option found at the specified location.
+    ///
+    /// @param location Location of the option in @ref data_.
+    virtual void unpackOption(const OptionLocation& location) const;
+
     // @brief List of deferred option codes
     std::list<uint16_t> deferred_options_;
 
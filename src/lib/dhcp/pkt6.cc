@@ -254,6 +254,8 @@ uint16_t Pkt6::calculateRelaySizes() {
 uint16_t Pkt6::directLen() const {
     uint16_t length = DHCPV6_PKT_HDR_LEN; // DHCPv6 header
 
+    unpackLazyOptions();
+
     for (OptionCollection::const_iterator it = options_.begin();
          it != options_.end();
          ++it) {
@@ -335,6 +337,7 @@ Pkt6::packUDP() {
         buffer_out_.writeUint8( (transid_) & 0xff );
 
         // the rest are options
+        unpackLazyOptions();
         LibDHCP::packOptions6(buffer_out_, options_);
     }
     catch (const Exception& e) {
@@ -413,11 +416,24 @@ Pkt6::unpackMsg(OptionBuffer::const_iterator begin,
     // perhaps for stats gathering we can uncomment this.
     //    size -= sizeof(uint32_t); // We just parsed 4 bytes header
 
-    OptionBuffer opt_buffer(begin, end);
+    // The options are parsed in place.
+    size_t offset = 0;
+    lazy_options_.clear();
+    lazy_unpack_error_.clear();
+    if (lazy_unpack_) {
+        // Only find the options. Their offsets are relative to data_
+        // which may hold the relay headers before this message.
+        const size_t opts_offset = std::distance(data_.cbegin(), begin);
+        offset = LibDHCP::scanOptions6(begin, end, lazy_options_);
+        for (OptionLocations::iterator location = lazy_options_.begin();
+             location != lazy_options_.end(); ++location) {
+            location->offset_ += opts_offset;
+        }
 
-    // If custom option parsing function has been set, use this function
-    // to parse options. Otherwise, use standard function from libdhcp.
-    size_t offset = LibDHCP::unpackOptions6(opt_buffer, DHCP6_OPTION_SPACE, options_);
+    } else {
+        offset = LibDHCP::unpackOptions6(begin, end, DHCP6_OPTION_SPACE,
+                                         options_);
+    }
 
     // If offset is not equal to the size, then something is wrong here. We
     // either parsed past input buffer (bug in our code) or we haven't parsed
@@ -463,11 +479,9 @@ Pkt6::unpackRelayMsg() {
         bufsize -= DHCPV6_RELAY_HDR_LEN; // 34 bytes (1+1+16+16)
 
         // parse the rest as options
-        OptionBuffer opt_buffer(&data_[offset], &data_[offset] + bufsize);
-
-        // If custom option parsing function has been set, use this function
-        // to parse options. Otherwise, use standard function from libdhcp.
-        LibDHCP::unpackOptions6(opt_buffer, DHCP6_OPTION_SPACE, relay.options_,
+        LibDHCP::unpackOptions6(data_.begin() + offset,
+                                data_.begin() + offset + bufsize,
+                                DHCP6_OPTION_SPACE, relay.options_,
                                 &relay_msg_offset, &relay_msg_len);
 
         /// @todo: check that each option appears at most once
@@ -628,7 +642,8 @@ Pkt6::toText() const {
         << "), transid=0x" <<
         hex << transid_ << dec << endl;
 
-    // Then print the options
+    // Then print the options. The malformed options are not shown.
+    unpackLazyOptions();
     for (isc::dhcp::OptionCollection::const_iterator opt=options_.begin();
          opt != options_.end();
          ++opt) {
@@ -665,8 +680,16 @@ Pkt6::getClientId() const {
     return (DuidPtr());
 }
 
+void
+Pkt6::unpackOption(const OptionLocation& location) const {
+    OptionBufferConstIter begin = data_.begin() + location.offset_;
+    LibDHCP::unpackOptions6(begin, begin + location.length_,
+                            DHCP6_OPTION_SPACE, options_);
+}
+
 isc::dhcp::OptionCollection
 Pkt6::getNonCopiedOptions(const uint16_t opt_type) const {
+    unpackLazyOptions(opt_type);
     std::pair<OptionCollection::const_iterator,
               OptionCollection::const_iterator> range = options_.equal_range(opt_type);
     return (OptionCollection(range.first, range.second));
@@ -674,6 +697,7 @@ Pkt6::getNonCopiedOptions(const uint16_t opt_type) const {
 
 isc::dhcp::OptionCollection
 Pkt6::getOptions(const uint16_t opt_type) {
+    unpackLazyOptions(opt_type);
     OptionCollection options_copy;
 
     std::pair<OptionCollection::iterator,
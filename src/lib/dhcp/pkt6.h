@@ -368,6 +368,11 @@ protected:
     /// @return Collection of options found.
     OptionCollection getNonCopiedOptions(const uint16_t opt_type) const;
 
+    /// @brief Creates the DHCPv6 option found at the specified location.
+    ///
+    /// @param location Location of the option in @ref data_.
+    virtual void unpackOption(const OptionLocation& location) const;
+
 public:
 
     /// @brief Returns all instances of specified type.
@@ -8,12 +8,52 @@
 #include <dhcp/iface_mgr.h>
 #include <dhcp/pkt_filter.h>
 
+#include <boost/foreach.hpp>
+
 #include <sys/fcntl.h>
 #include <sys/socket.h>
+#include <string>
 
 namespace isc {
 namespace dhcp {
 
+size_t
+PktFilter::receiveBatch(Iface& iface, const SocketInfo& socket_info,
+                        const size_t max_count, std::vector<Pkt4Ptr>& pkts) {
+    if (max_count == 0) {
+        return (0);
+    }
+    Pkt4Ptr pkt = receive(iface, socket_info);
+    if (!pkt) {
+        return (0);
+    }
+    pkts.push_back(pkt);
+    return (1);
+}
+
+void
+PktFilter::sendBatch(const Iface& iface, uint16_t sockfd,
+                     const std::vector<Pkt4Ptr>& pkts,
+                     std::vector<Pkt4Ptr>& sent) {
+    size_t count = 0;
+    std::string error;
+    BOOST_FOREACH(const Pkt4Ptr& pkt, pkts) {
+        try {
+            send(iface, sockfd, pkt);
+            sent.push_back(pkt);
+            ++count;
+        } catch (const std::exception& ex) {
+            if (error.empty()) {
+                error = ex.what();
+            }
+        }
+    }
+    if (!error.empty()) {
+        isc_throw(SocketWriteError, "failed to send " << (pkts.size() - count)
+                  << " of " << pkts.size() << " DHCPv4 packets: " << error);
+    }
+}
+
 int
 PktFilter::openFallbackSocket(const isc::asiolink::IOAddress& addr,
                               const uint16_t port) {
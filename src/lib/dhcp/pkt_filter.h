@@ -10,6 +10,7 @@
 #include <dhcp/pkt4.h>
 #include <asiolink/io_address.h>
 #include <boost/shared_ptr.hpp>
+#include <vector>
 
 namespace isc {
 namespace dhcp {
@@ -93,6 +94,25 @@ public:
     virtual Pkt4Ptr receive(Iface& iface,
                             const SocketInfo& socket_info) = 0;
 
+    /// @brief Receive all packets pending on the specified socket.
+    ///
+    /// This method reads up to @c max_count packets waiting on the socket
+    /// and appends them to the @c pkts container. It is called when the
+    /// socket is known to be readable so at least one packet is normally
+    /// received. The default implementation receives a single packet using
+    /// @c receive. Derived classes may override it to read multiple packets
+    /// with a single system call.
+    ///
+    /// @param iface interface
+    /// @param socket_info structure holding socket information
+    /// @param max_count maximum number of packets to be received.
+    /// @param [out] pkts container to which received packets are appended.
+    ///
+    /// @return Number of packets appended to the container.
+    virtual size_t receiveBatch(Iface& iface, const SocketInfo& socket_info,
+                                const size_t max_count,
+                                std::vector<Pkt4Ptr>& pkts);
+
     /// @brief Send packet over specified socket.
     ///
     /// @param iface interface to be used to send packet
@@ -103,6 +123,25 @@ public:
     virtual int send(const Iface& iface, uint16_t sockfd,
                      const Pkt4Ptr& pkt) = 0;
 
+    /// @brief Send packets over specified socket.
+    ///
+    /// The default implementation sends the packets one by one using
+    /// @c send. Derived classes may override it to send multiple packets
+    /// with a single system call. All packets are attempted even if some
+    /// of them can't be sent.
+    ///
+    /// @param iface interface to be used to send packets
+    /// @param sockfd socket descriptor
+    /// @param pkts packets to be sent
+    /// @param [out] sent packets which have been sent are appended
+    /// to it, also when some of the packets couldn't be sent.
+    ///
+    /// @throw isc::dhcp::SocketWriteError if any of the packets couldn't
+    /// be sent.
+    virtual void sendBatch(const Iface& iface, uint16_t sockfd,
+                           const std::vector<Pkt4Ptr>& pkts,
+                           std::vector<Pkt4Ptr>& sent);
+
 protected:
 
     /// @brief Default implementation to open a fallback socket.
@@ -6,11 +6,53 @@
 
 #include <config.h>
 
+#include <dhcp/iface_mgr.h>
 #include <dhcp/pkt_filter6.h>
 
+#include <boost/foreach.hpp>
+
+#include <string>
+
 namespace isc {
 namespace dhcp {
 
+size_t
+PktFilter6::receiveBatch(const SocketInfo& socket_info, const size_t max_count,
+                         std::vector<Pkt6Ptr>& pkts) {
+    if (max_count == 0) {
+        return (0);
+    }
+    Pkt6Ptr pkt = receive(socket_info);
+    if (!pkt) {
+        return (0);
+    }
+    pkts.push_back(pkt);
+    return (1);
+}
+
+void
+PktFilter6::sendBatch(const Iface& iface, uint16_t sockfd,
+                      const std::vector<Pkt6Ptr>& pkts,
+                      std::vector<Pkt6Ptr>& sent) {
+    size_t count = 0;
+    std::string error;
+    BOOST_FOREACH(const Pkt6Ptr& pkt, pkts) {
+        try {
+            send(iface, sockfd, pkt);
+            sent.push_back(pkt);
+            ++count;
+        } catch (const std::exception& ex) {
+            if (error.empty()) {
+                error = ex.what();
+            }
+        }
+    }
+    if (!error.empty()) {
+        isc_throw(SocketWriteError, "failed to send " << (pkts.size() - count)
+                  << " of " << pkts.size() << " DHCPv6 packets: " << error);
+    }
+}
+
 bool
 PktFilter6::joinMulticast(int sock, const std::string& ifname,
                           const std::string & mcast) {
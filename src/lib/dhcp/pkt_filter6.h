@@ -9,6 +9,7 @@
 
 #include <asiolink/io_address.h>
 #include <dhcp/pkt6.h>
+#include <vector>
 
 namespace isc {
 namespace dhcp {
@@ -101,6 +102,23 @@ public:
     /// @return A pointer to received message.
     virtual Pkt6Ptr receive(const SocketInfo& socket_info) = 0;
 
+    /// @brief Receives all DHCPv6 messages pending on the socket.
+    ///
+    /// This function reads up to @c max_count messages waiting on the
+    /// socket and appends them to the @c pkts container. The default
+    /// implementation receives a single message using @c receive. Derived
+    /// classes may override it to read multiple messages with a single
+    /// system call.
+    ///
+    /// @param socket_info A structure holding socket information.
+    /// @param max_count Maximum number of messages to be received.
+    /// @param [out] pkts Container to which received messages are appended.
+    ///
+    /// @return Number of messages appended to the container.
+    virtual size_t receiveBatch(const SocketInfo& socket_info,
+                                const size_t max_count,
+                                std::vector<Pkt6Ptr>& pkts);
+
     /// @brief Sends DHCPv6 message through a specified interface and socket.
     ///
     /// This function sends a DHCPv6 message through a specified interface and
@@ -115,6 +133,25 @@ public:
     virtual int send(const Iface& iface, uint16_t sockfd,
                      const Pkt6Ptr& pkt) = 0;
 
+    /// @brief Sends DHCPv6 messages through a specified interface and socket.
+    ///
+    /// The default implementation sends the messages one by one using
+    /// @c send. Derived classes may override it to send multiple messages
+    /// with a single system call. All messages are attempted even if some
+    /// of them can't be sent.
+    ///
+    /// @param iface Interface to be used to send messages.
+    /// @param sockfd A socket descriptor
+    /// @param pkts Messages to be sent.
+    /// @param [out] sent Messages which have been sent are appended
+    /// to it, also when some of the messages couldn't be sent.
+    ///
+    /// @throw isc::dhcp::SocketWriteError if any of the messages couldn't
+    /// be sent.
+    virtual void sendBatch(const Iface& iface, uint16_t sockfd,
+                           const std::vector<Pkt6Ptr>& pkts,
+                           std::vector<Pkt6Ptr>& sent);
+
     /// @brief Joins IPv6 multicast group on a socket.
     ///
     /// This function joins the socket to the specified multicast group.
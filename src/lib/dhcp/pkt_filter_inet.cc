@@ -11,6 +11,7 @@
 #include <errno.h>
 #include <cstring>
 #include <fcntl.h>
+#include <string>
 
 using namespace isc::asiolink;
 
@@ -143,8 +144,83 @@ PktFilterInet::receive(Iface& iface, const SocketInfo& socket_info) {
         isc_throw(SocketReadError, "failed to receive UDP4 data");
     }
 
+    return (convertToPacket(iface, socket_info, buf, result, from_addr, m));
+}
+
+size_t
+PktFilterInet::receiveBatch(Iface& iface, const SocketInfo& socket_info,
+                            const size_t max_count,
+                            std::vector<Pkt4Ptr>& pkts) {
+#ifdef HAVE_RECVMMSG
+    if (max_count <= 1) {
+        return (PktFilter::receiveBatch(iface, socket_info, max_count, pkts));
+    }
+
+    // The buffers are kept between the calls to avoid allocating them
+    // for each batch.
+    batch_buf_.resize(max_count * IfaceMgr::RCVBUFSIZE);
+    batch_control_buf_.resize(max_count * control_buf_len_);
+    std::vector<struct sockaddr_in> from_addrs(max_count);
+    std::vector<struct iovec> iovs(max_count);
+    std::vector<struct mmsghdr> msgs(max_count);
+    memset(&batch_control_buf_[0], 0, batch_control_buf_.size());
+    memset(&from_addrs[0], 0, max_count * sizeof(struct sockaddr_in));
+    memset(&msgs[0], 0, max_count * sizeof(struct mmsghdr));
+
+    for (size_t i = 0; i < max_count; ++i) {
+        iovs[i].iov_base = &batch_buf_[i * IfaceMgr::RCVBUFSIZE];
+        iovs[i].iov_len = IfaceMgr::RCVBUFSIZE;
+        struct msghdr& m = msgs[i].msg_hdr;
+        m.msg_name = &from_addrs[i];
+        m.msg_namelen = sizeof(struct sockaddr_in);
+        m.msg_iov = &iovs[i];
+        m.msg_iovlen = 1;
+        m.msg_control = &batch_control_buf_[i * control_buf_len_];
+        m.msg_controllen = control_buf_len_;
+    }
+
+    // The socket is readable so the first message is available. Do not
+    // wait for the remaining ones.
+    int result = recvmmsg(socket_info.sockfd_, &msgs[0], max_count,
+                          MSG_DONTWAIT, NULL);
+    if (result < 0) {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+            return (0);
+        }
+        isc_throw(SocketReadError, "failed to receive UDP4 data");
+    }
+
+    // Malformed messages are skipped so as they don't cause the loss of
+    // the valid ones received in the same batch.
+    size_t count = 0;
+    std::string error;
+    for (size_t i = 0; i < static_cast<size_t>(result); ++i) {
+        try {
+            pkts.push_back(convertToPacket(iface, socket_info,
+                                           &batch_buf_[i * IfaceMgr::RCVBUFSIZE],
+                                           msgs[i].msg_len, from_addrs[i],
+                                           msgs[i].msg_hdr));
+            ++count;
+        } catch (const std::exception& ex) {
+            error = ex.what();
+        }
+    }
+    if ((count == 0) && !error.empty()) {
+        isc_throw(SocketReadError, "failed to receive UDP4 data: " << error);
+    }
+    return (count);
+#else
+    return (PktFilter::receiveBatch(iface, socket_info, max_count, pkts));
+#endif
+}
+
+Pkt4Ptr
+PktFilterInet::convertToPacket(Iface& iface, const SocketInfo& socket_info,
+                               const uint8_t* buf, const size_t len,
+                               const struct sockaddr_in& from_addr,
+                               struct msghdr& m) const {
     // We have all data let's create Pkt4 object.
-    Pkt4Ptr pkt = Pkt4Ptr(new Pkt4(buf, result));
+    Pkt4Ptr pkt = Pkt4Ptr(new Pkt4(buf, len));
 
     pkt->updateTimestamp();
 
@@ -211,16 +287,85 @@ PktFilterInet::receive(Iface& iface, const SocketInfo& socket_info) {
 int
 PktFilterInet::send(const Iface&, uint16_t sockfd,
                     const Pkt4Ptr& pkt) {
-    memset(&control_buf_[0], 0, control_buf_len_);
+    sockaddr_in to;
+    struct iovec v;
+    struct msghdr m;
+    prepareMessage(pkt, to, v, &control_buf_[0], m);
+
+    pkt->updateTimestamp();
+
+    int result = sendmsg(sockfd, &m, 0);
+    if (result < 0) {
+        isc_throw(SocketWriteError, "pkt4 send failed: sendmsg() returned "
+                  " with an error: " << strerror(errno));
+    }
+
+    return (result);
+}
+
+void
+PktFilterInet::sendBatch(const Iface& iface, uint16_t sockfd,
+                         const std::vector<Pkt4Ptr>& pkts,
+                         std::vector<Pkt4Ptr>& sent) {
+#ifdef HAVE_SENDMMSG
+    if (pkts.size() <= 1) {
+        PktFilter::sendBatch(iface, sockfd, pkts, sent);
+        return;
+    }
+
+    const size_t pkts_num = pkts.size();
+    std::vector<sockaddr_in> to(pkts_num);
+    std::vector<struct iovec> iovs(pkts_num);
+    std::vector<struct mmsghdr> msgs(pkts_num);
+    std::vector<char> control(pkts_num * control_buf_len_);
+    for (size_t i = 0; i < pkts_num; ++i) {
+        memset(&msgs[i], 0, sizeof(struct mmsghdr));
+        prepareMessage(pkts[i], to[i], iovs[i],
+                       &control[i * control_buf_len_], msgs[i].msg_hdr);
+        pkts[i]->updateTimestamp();
+    }
+
+    // sendmmsg() stops on the first message which can't be sent. Skip it
+    // and continue with the next ones.
+    size_t failed = 0;
+    std::string error;
+    size_t i = 0;
+    while (i < pkts_num) {
+        int result = sendmmsg(sockfd, &msgs[i], pkts_num - i, 0);
+        if (result < 0) {
+            if (error.empty()) {
+                error = strerror(errno);
+            }
+            ++failed;
+            ++i;
+        } else {
+            sent.insert(sent.end(), pkts.begin() + i,
+                        pkts.begin() + i + result);
+            i += result;
+        }
+    }
+    if (failed > 0) {
+        isc_throw(SocketWriteError, "pkt4 send failed: sendmmsg() failed to"
+                  " send " << failed << " of " << pkts_num << " packets: "
+                  << error);
+    }
+#else
+    PktFilter::sendBatch(iface, sockfd, pkts, sent);
+#endif
+}
+
+void
+PktFilterInet::prepareMessage(const Pkt4Ptr& pkt, sockaddr_in& to,
+                              struct iovec& v, char* control,
+                              struct msghdr& m) const {
+    memset(control, 0, control_buf_len_);
 
     // Set the target address we're sending to.
-    sockaddr_in to;
     memset(&to, 0, sizeof(to));
     to.sin_family = AF_INET;
     to.sin_port = htons(pkt->getRemotePort());
     to.sin_addr.s_addr = htonl(pkt->getRemoteAddr().toUint32());
 
-    struct msghdr m;
     // Initialize our message header structure.
     memset(&m, 0, sizeof(m));
     m.msg_name = &to;
@@ -229,7 +374,6 @@ PktFilterInet::send(const Iface&, uint16_t sockfd,
     // Set the data buffer we're sending. (Using this wacky
     // "scatter-gather" stuff... we only have a single chunk
     // of data to send, so we declare a single vector entry.)
-    struct iovec v;
     memset(&v, 0, sizeof(v));
     // iov_base field is of void * type. We use it for packet
     // transmission, so this buffer will not be modified.
@@ -247,7 +391,7 @@ PktFilterInet::send(const Iface&, uint16_t sockfd,
     // We have to create a "control message", and set that to
     // define the IPv4 packet information. We set the source address
     // to handle correctly interfaces with multiple addresses.
-    m.msg_control = &control_buf_[0];
+    m.msg_control = control;
     m.msg_controllen = control_buf_len_;
     struct cmsghdr* cmsg = CMSG_FIRSTHDR(&m);
     cmsg->cmsg_level = IPPROTO_IP;
@@ -272,16 +416,6 @@ PktFilterInet::send(const Iface&, uint16_t sockfd,
 
     m.msg_controllen = CMSG_SPACE(sizeof(struct in_pktinfo));
 #endif
-
-    pkt->updateTimestamp();
-
-    int result = sendmsg(sockfd, &m, 0);
-    if (result < 0) {
-        isc_throw(SocketWriteError, "pkt4 send failed: sendmsg() returned "
-                  " with an error: " << strerror(errno));
-    }
-
-    return (result);
 }
 
 
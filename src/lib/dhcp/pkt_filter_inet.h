@@ -9,6 +9,9 @@
 
 #include <dhcp/pkt_filter.h>
 #include <boost/scoped_array.hpp>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <vector>
 
 namespace isc {
 namespace dhcp {
@@ -65,6 +68,24 @@ public:
     /// message parsing fails.
     virtual Pkt4Ptr receive(Iface& iface, const SocketInfo& socket_info);
 
+    /// @brief Receive all packets pending on the specified socket.
+    ///
+    /// When the @c recvmmsg system call is available, the packets are
+    /// read with a single call to it. Otherwise a single packet is read
+    /// using @c receive.
+    ///
+    /// @param iface interface
+    /// @param socket_info structure holding socket information
+    /// @param max_count maximum number of packets to be received.
+    /// @param [out] pkts container to which received packets are appended.
+    ///
+    /// @return Number of packets appended to the container.
+    /// @throw isc::dhcp::SocketReadError if an error occurs during reception
+    /// of the packets or none of the received packets could be parsed.
+    virtual size_t receiveBatch(Iface& iface, const SocketInfo& socket_info,
+                                const size_t max_count,
+                                std::vector<Pkt4Ptr>& pkts);
+
     /// @brief Send packet over specified socket.
     ///
     /// This function will use local address specified in the @c pkt as a source
@@ -84,11 +105,61 @@ public:
     virtual int send(const Iface& iface, uint16_t sockfd,
                      const Pkt4Ptr& pkt);
 
+    /// @brief Send packets over specified socket.
+    ///
+    /// When the @c sendmmsg system call is available, the packets are
+    /// sent with a single call to it. Otherwise they are sent one by one.
+    ///
+    /// @param iface interface to be used to send packets
+    /// @param sockfd socket descriptor
+    /// @param pkts packets to be sent
+    /// @param [out] sent packets which have been sent are appended
+    /// to it, also when some of the packets couldn't be sent.
+    ///
+    /// @throw isc::dhcp::SocketWriteError if any of the packets couldn't
+    /// be sent.
+    virtual void sendBatch(const Iface& iface, uint16_t sockfd,
+                           const std::vector<Pkt4Ptr>& pkts,
+                           std::vector<Pkt4Ptr>& sent);
+
 private:
+
+    /// @brief Creates a packet from the received message.
+    ///
+    /// @param iface interface on which the message has been received.
+    /// @param socket_info structure holding socket information.
+    /// @param buf buffer holding the message.
+    /// @param len length of the message.
+    /// @param from_addr address from which the message has been sent.
+    /// @param m message header holding the control data.
+    ///
+    /// @return Received packet.
+    /// @throw An exception thrown by the isc::dhcp::Pkt4 object if DHCPv4
+    /// message parsing fails.
+    Pkt4Ptr convertToPacket(Iface& iface, const SocketInfo& socket_info,
+                            const uint8_t* buf, const size_t len,
+                            const struct sockaddr_in& from_addr,
+                            struct msghdr& m) const;
+
+    /// @brief Prepares the message header to send the packet.
+    ///
+    /// @param pkt packet to be sent.
+    /// @param [out] to structure receiving the destination address.
+    /// @param [out] v structure receiving the data buffer.
+    /// @param control control buffer of the @c control_buf_len_ length.
+    /// @param [out] m message header pointing to the other structures.
+    void prepareMessage(const Pkt4Ptr& pkt, struct sockaddr_in& to,
+                        struct iovec& v, char* control,
+                        struct msghdr& m) const;
+
     /// Length of the control_buf_ array.
     size_t control_buf_len_;
     /// Control buffer, used in transmission and reception.
     boost::scoped_array<char> control_buf_;
+    /// Buffer holding the messages received by @c receiveBatch.
+    std::vector<uint8_t> batch_buf_;
+    /// Control buffers used by @c receiveBatch.
+    std::vector<char> batch_control_buf_;
 };
 
 } // namespace isc::dhcp
@@ -11,8 +11,10 @@
 #include <dhcp/pkt_filter_inet6.h>
 #include <util/io/pktinfo_utilities.h>
 
+#include <errno.h>
 #include <fcntl.h>
 #include <netinet/in.h>
+#include <string>
 
 using namespace isc::asiolink;
 
@@ -167,39 +169,114 @@ PktFilterInet6::receive(const SocketInfo& socket_info) {
     m.msg_controllen = control_buf_len_;
 
     int result = recvmsg(socket_info.sockfd_, &m, 0);
+    if (result < 0) {
+        isc_throw(SocketReadError, "failed to receive data");
+    }
+
+    return (convertToPacket(socket_info, buf, result, from, m));
+}
+
+size_t
+PktFilterInet6::receiveBatch(const SocketInfo& socket_info,
+                             const size_t max_count,
+                             std::vector<Pkt6Ptr>& pkts) {
+#ifdef HAVE_RECVMMSG
+    if (max_count <= 1) {
+        return (PktFilter6::receiveBatch(socket_info, max_count, pkts));
+    }
+
+    // The buffers are kept between the calls to avoid allocating them
+    // for each batch.
+    batch_buf_.resize(max_count * IfaceMgr::RCVBUFSIZE);
+    batch_control_buf_.resize(max_count * control_buf_len_);
+    std::vector<struct sockaddr_in6> from_addrs(max_count);
+    std::vector<struct iovec> iovs(max_count);
+    std::vector<struct mmsghdr> msgs(max_count);
+    memset(&batch_control_buf_[0], 0, batch_control_buf_.size());
+    memset(&from_addrs[0], 0, max_count * sizeof(struct sockaddr_in6));
+    memset(&msgs[0], 0, max_count * sizeof(struct mmsghdr));
+
+    for (size_t i = 0; i < max_count; ++i) {
+        iovs[i].iov_base = &batch_buf_[i * IfaceMgr::RCVBUFSIZE];
+        iovs[i].iov_len = IfaceMgr::RCVBUFSIZE;
+        struct msghdr& m = msgs[i].msg_hdr;
+        m.msg_name = &from_addrs[i];
+        m.msg_namelen = sizeof(struct sockaddr_in6);
+        m.msg_iov = &iovs[i];
+        m.msg_iovlen = 1;
+        m.msg_control = &batch_control_buf_[i * control_buf_len_];
+        m.msg_controllen = control_buf_len_;
+    }
+
+    // The socket is readable so the first message is available. Do not
+    // wait for the remaining ones.
+    int result = recvmmsg(socket_info.sockfd_, &msgs[0], max_count,
+                          MSG_DONTWAIT, NULL);
+    if (result < 0) {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+            return (0);
+        }
+        isc_throw(SocketReadError, "failed to receive data");
+    }
 
+    // Malformed messages are skipped so as they don't cause the loss of
+    // the valid ones received in the same batch.
+    size_t count = 0;
+    std::string error;
+    for (size_t i = 0; i < static_cast<size_t>(result); ++i) {
+        try {
+            Pkt6Ptr pkt = convertToPacket(socket_info,
+                                          &batch_buf_[i * IfaceMgr::RCVBUFSIZE],
+                                          msgs[i].msg_len, from_addrs[i],
+                                          msgs[i].msg_hdr);
+            if (pkt) {
+                pkts.push_back(pkt);
+                ++count;
+            }
+        } catch (const std::exception& ex) {
+            error = ex.what();
+        }
+    }
+    if ((count == 0) && !error.empty()) {
+        isc_throw(SocketReadError, error);
+    }
+    return (count);
+#else
+    return (PktFilter6::receiveBatch(socket_info, max_count, pkts));
+#endif
+}
+
+Pkt6Ptr
+PktFilterInet6::convertToPacket(const SocketInfo& socket_info,
+                                const uint8_t* buf, const size_t len,
+                                const struct sockaddr_in6& from,
+                                struct msghdr& m) const {
     struct in6_addr to_addr;
     memset(&to_addr, 0, sizeof(to_addr));
 
     int ifindex = -1;
-    if (result >= 0) {
-        struct in6_pktinfo* pktinfo = NULL;
-
-
-        // If we did read successfully, then we need to loop
-        // through the control messages we received and
-        // find the one with our destination address.
-        //
-        // We also keep a flag to see if we found it. If we
-        // didn't, then we consider this to be an error.
-        bool found_pktinfo = false;
-        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&m);
-        while (cmsg != NULL) {
-            if ((cmsg->cmsg_level == IPPROTO_IPV6) &&
-                (cmsg->cmsg_type == IPV6_PKTINFO)) {
-                pktinfo = util::io::internal::convertPktInfo6(CMSG_DATA(cmsg));
-                to_addr = pktinfo->ipi6_addr;
-                ifindex = pktinfo->ipi6_ifindex;
-                found_pktinfo = true;
-                break;
-            }
-            cmsg = CMSG_NXTHDR(&m, cmsg);
-        }
-        if (!found_pktinfo) {
-            isc_throw(SocketReadError, "unable to find pktinfo");
+    struct in6_pktinfo* pktinfo = NULL;
+
+    // We need to loop through the control messages we received and
+    // find the one with our destination address.
+    //
+    // We also keep a flag to see if we found it. If we
+    // didn't, then we consider this to be an error.
+    bool found_pktinfo = false;
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&m);
+    while (cmsg != NULL) {
+        if ((cmsg->cmsg_level == IPPROTO_IPV6) &&
+            (cmsg->cmsg_type == IPV6_PKTINFO)) {
+            pktinfo = util::io::internal::convertPktInfo6(CMSG_DATA(cmsg));
+            to_addr = pktinfo->ipi6_addr;
+            ifindex = pktinfo->ipi6_ifindex;
+            found_pktinfo = true;
+            break;
         }
-    } else {
-        isc_throw(SocketReadError, "failed to receive data");
+        cmsg = CMSG_NXTHDR(&m, cmsg);
+    }
+    if (!found_pktinfo) {
+        isc_throw(SocketReadError, "unable to find pktinfo");
     }
 
     // Filter out packets sent to global unicast address (not link local and
@@ -216,7 +293,7 @@ PktFilterInet6::receive(const SocketInfo& socket_info) {
     // Let's create a packet.
     Pkt6Ptr pkt;
     try {
-        pkt = Pkt6Ptr(new Pkt6(buf, result));
+        pkt = Pkt6Ptr(new Pkt6(buf, len));
     } catch (const std::exception& ex) {
         isc_throw(SocketReadError, "failed to create new packet");
     }
@@ -244,11 +321,80 @@ PktFilterInet6::receive(const SocketInfo& socket_info) {
 
 int
 PktFilterInet6::send(const Iface&, uint16_t sockfd, const Pkt6Ptr& pkt) {
+    sockaddr_in6 to;
+    struct iovec v;
+    struct msghdr m;
+    prepareMessage(pkt, to, v, &control_buf_[0], m);
 
-    memset(&control_buf_[0], 0, control_buf_len_);
+    pkt->updateTimestamp();
+
+    int result = sendmsg(sockfd, &m, 0);
+    if  (result < 0) {
+        isc_throw(SocketWriteError, "pkt6 send failed: sendmsg() returned"
+                  " with an error: " << strerror(errno));
+    }
+
+    return (result);
+}
+
+void
+PktFilterInet6::sendBatch(const Iface& iface, uint16_t sockfd,
+                          const std::vector<Pkt6Ptr>& pkts,
+                          std::vector<Pkt6Ptr>& sent) {
+#ifdef HAVE_SENDMMSG
+    if (pkts.size() <= 1) {
+        PktFilter6::sendBatch(iface, sockfd, pkts, sent);
+        return;
+    }
+
+    const size_t pkts_num = pkts.size();
+    std::vector<sockaddr_in6> to(pkts_num);
+    std::vector<struct iovec> iovs(pkts_num);
+    std::vector<struct mmsghdr> msgs(pkts_num);
+    std::vector<char> control(pkts_num * control_buf_len_);
+    for (size_t i = 0; i < pkts_num; ++i) {
+        memset(&msgs[i], 0, sizeof(struct mmsghdr));
+        prepareMessage(pkts[i], to[i], iovs[i],
+                       &control[i * control_buf_len_], msgs[i].msg_hdr);
+        pkts[i]->updateTimestamp();
+    }
+
+    // sendmmsg() stops on the first message which can't be sent. Skip it
+    // and continue with the next ones.
+    size_t failed = 0;
+    std::string error;
+    size_t i = 0;
+    while (i < pkts_num) {
+        int result = sendmmsg(sockfd, &msgs[i], pkts_num - i, 0);
+        if (result < 0) {
+            if (error.empty()) {
+                error = strerror(errno);
+            }
+            ++failed;
+            ++i;
+        } else {
+            sent.insert(sent.end(), pkts.begin() + i,
+                        pkts.begin() + i + result);
+            i += result;
+        }
+    }
+    if (failed > 0) {
+        isc_throw(SocketWriteError, "pkt6 send failed: sendmmsg() failed to"
+                  " send " << failed << " of " << pkts_num << " packets: "
+                  << error);
+    }
+#else
+    PktFilter6::sendBatch(iface, sockfd, pkts, sent);
+#endif
+}
+
+void
+PktFilterInet6::prepareMessage(const Pkt6Ptr& pkt, sockaddr_in6& to,
+                               struct iovec& v, char* control,
+                               struct msghdr& m) const {
+    memset(control, 0, control_buf_len_);
 
     // Set the target address we're sending to.
-    sockaddr_in6 to;
     memset(&to, 0, sizeof(to));
     to.sin6_family = AF_INET6;
     to.sin6_port = htons(pkt->getRemotePort());
@@ -258,7 +404,6 @@ PktFilterInet6::send(const Iface&, uint16_t sockfd, const Pkt6Ptr& pkt) {
     to.sin6_scope_id = pkt->getIndex();
 
     // Initialize our message header structure.
-    struct msghdr m;
     memset(&m, 0, sizeof(m));
     m.msg_name = &to;
     m.msg_namelen = sizeof(to);
@@ -274,7 +419,6 @@ PktFilterInet6::send(const Iface&, uint16_t sockfd, const Pkt6Ptr& pkt) {
     // (defined as void*) we must use const cast from void *.
     // Otherwise C++ compiler would complain that we are trying
     // to assign const void* to void*.
-    struct iovec v;
     memset(&v, 0, sizeof(v));
     v.iov_base = const_cast<void *>(pkt->getBuffer().getData());
     v.iov_len = pkt->getBuffer().getLength();
@@ -287,7 +431,7 @@ PktFilterInet6::send(const Iface&, uint16_t sockfd, const Pkt6Ptr& pkt) {
     // define the IPv6 packet information. We could set the
     // source address if we wanted, but we can safely let the
     // kernel decide what that should be.
-    m.msg_control = &control_buf_[0];
+    m.msg_control = control;
     m.msg_controllen = control_buf_len_;
     struct cmsghdr *cmsg = CMSG_FIRSTHDR(&m);
 
@@ -313,16 +457,6 @@ PktFilterInet6::send(const Iface&, uint16_t sockfd, const Pkt6Ptr& pkt) {
     // which causes sendmsg to return EINVAL if the CMSG_LEN is
     // used to set the msg_controllen value.
     m.msg_controllen = CMSG_SPACE(sizeof(struct in6_pktinfo));
-
-    pkt->updateTimestamp();
-
-    int result = sendmsg(sockfd, &m, 0);
-    if  (result < 0) {
-        isc_throw(SocketWriteError, "pkt6 send failed: sendmsg() returned"
-                  " with an error: " << strerror(errno));
-    }
-
-    return (result);
 }
 
 
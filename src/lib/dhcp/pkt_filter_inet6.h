@@ -9,6 +9,9 @@
 
 #include <dhcp/pkt_filter6.h>
 #include <boost/scoped_array.hpp>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <vector>
 
 namespace isc {
 namespace dhcp {
@@ -67,6 +70,24 @@ public:
     /// reception.
     virtual Pkt6Ptr receive(const SocketInfo& socket_info);
 
+    /// @brief Receives all DHCPv6 messages pending on the socket.
+    ///
+    /// When the @c recvmmsg system call is available, the messages are
+    /// read with a single call to it. Otherwise a single message is read
+    /// using @c receive. The messages are filtered the same way as by
+    /// @c receive.
+    ///
+    /// @param socket_info A structure holding socket information.
+    /// @param max_count Maximum number of messages to be received.
+    /// @param [out] pkts Container to which received messages are appended.
+    ///
+    /// @return Number of messages appended to the container.
+    /// @throw isc::dhcp::SocketReadError if error occurred during packet
+    /// reception or none of the received messages could be parsed.
+    virtual size_t receiveBatch(const SocketInfo& socket_info,
+                                const size_t max_count,
+                                std::vector<Pkt6Ptr>& pkts);
+
     /// @brief Sends DHCPv6 message through a specified interface and socket.
     ///
     /// The function sends a DHCPv6 message through a specified interface and
@@ -83,11 +104,61 @@ public:
     virtual int send(const Iface& iface, uint16_t sockfd,
                      const Pkt6Ptr& pkt);
 
+    /// @brief Sends DHCPv6 messages through a specified interface and socket.
+    ///
+    /// When the @c sendmmsg system call is available, the messages are
+    /// sent with a single call to it. Otherwise they are sent one by one.
+    ///
+    /// @param iface Interface to be used to send messages.
+    /// @param sockfd A socket descriptor
+    /// @param pkts Messages to be sent.
+    /// @param [out] sent Messages which have been sent are appended
+    /// to it, also when some of the messages couldn't be sent.
+    ///
+    /// @throw isc::dhcp::SocketWriteError if any of the messages couldn't
+    /// be sent.
+    virtual void sendBatch(const Iface& iface, uint16_t sockfd,
+                           const std::vector<Pkt6Ptr>& pkts,
+                           std::vector<Pkt6Ptr>& sent);
+
 private:
+
+    /// @brief Creates a DHCPv6 message from the received data.
+    ///
+    /// @param socket_info A structure holding socket information.
+    /// @param buf Buffer holding the message.
+    /// @param len Length of the message.
+    /// @param from Address from which the message has been sent.
+    /// @param m Message header holding the control data.
+    ///
+    /// @return A pointer to received message or null pointer if the
+    /// message has been filtered out.
+    /// @throw isc::dhcp::SocketReadError if the message can't be parsed
+    /// or it lacks the packet information.
+    Pkt6Ptr convertToPacket(const SocketInfo& socket_info,
+                            const uint8_t* buf, const size_t len,
+                            const struct sockaddr_in6& from,
+                            struct msghdr& m) const;
+
+    /// @brief Prepares the message header to send the DHCPv6 message.
+    ///
+    /// @param pkt A message to be sent.
+    /// @param [out] to Structure receiving the destination address.
+    /// @param [out] v Structure receiving the data buffer.
+    /// @param control Control buffer of the @c control_buf_len_ length.
+    /// @param [out] m Message header pointing to the other structures.
+    void prepareMessage(const Pkt6Ptr& pkt, struct sockaddr_in6& to,
+                        struct iovec& v, char* control,
+                        struct msghdr& m) const;
+
     /// Length of the control_buf_ array.
     size_t control_buf_len_;
     /// Control buffer, used in transmission and reception.
     boost::scoped_array<char> control_buf_;
+    /// Buffer holding the messages received by @c receiveBatch.
+    std::vector<uint8_t> batch_buf_;
+    /// Control buffers used by @c receiveBatch.
+    std::vector<char> batch_control_buf_;
 };
 
 } // namespace isc::dhcp
@@ -16,6 +16,7 @@
 #include <linux/filter.h>
 #include <linux/if_ether.h>
 #include <linux/if_packet.h>
+#include <cstring>
 
 namespace {
 
@@ -280,7 +281,95 @@ int
 PktFilterLPF::send(const Iface& iface, uint16_t sockfd, const Pkt4Ptr& pkt) {
 
     OutputBuffer buf(14);
+    writeFrame(iface, pkt, buf);
 
+    sockaddr_ll sa;
+    sa.sll_family = AF_PACKET;
+    sa.sll_ifindex = iface.getIndex();
+    sa.sll_protocol = htons(ETH_P_IP);
+    sa.sll_halen = 6;
+
+    int result = sendto(sockfd, buf.getData(), buf.getLength(), 0,
+                        reinterpret_cast<const struct sockaddr*>(&sa),
+                        sizeof(sockaddr_ll));
+    if (result < 0) {
+        isc_throw(SocketWriteError, "failed to send DHCPv4 packet, errno="
+                  << errno << " (check errno.h)");
+    }
+
+    return (0);
+
+}
+
+void
+PktFilterLPF::sendBatch(const Iface& iface, uint16_t sockfd,
+                        const std::vector<Pkt4Ptr>& pkts,
+                        std::vector<Pkt4Ptr>& sent) {
+#ifdef HAVE_SENDMMSG
+    if (pkts.size() <= 1) {
+        PktFilter::sendBatch(iface, sockfd, pkts, sent);
+        return;
+    }
+
+    // All frames are sent through the same interface.
+    sockaddr_ll sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sll_family = AF_PACKET;
+    sa.sll_ifindex = iface.getIndex();
+    sa.sll_protocol = htons(ETH_P_IP);
+    sa.sll_halen = 6;
+
+    const size_t pkts_num = pkts.size();
+    std::vector<OutputBufferPtr> bufs;
+    bufs.reserve(pkts_num);
+    std::vector<struct iovec> iovs(pkts_num);
+    std::vector<struct mmsghdr> msgs(pkts_num);
+    for (size_t i = 0; i < pkts_num; ++i) {
+        OutputBufferPtr buf(new OutputBuffer(14));
+        writeFrame(iface, pkts[i], *buf);
+        bufs.push_back(buf);
+
+        iovs[i].iov_base = const_cast<void*>(buf->getData());
+        iovs[i].iov_len = buf->getLength();
+        memset(&msgs[i], 0, sizeof(struct mmsghdr));
+        msgs[i].msg_hdr.msg_name = &sa;
+        msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_ll);
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // sendmmsg() stops on the first frame which can't be sent. Skip it
+    // and continue with the next ones.
+    size_t failed = 0;
+    int error = 0;
+    size_t i = 0;
+    while (i < pkts_num) {
+        int result = sendmmsg(sockfd, &msgs[i], pkts_num - i, 0);
+        if (result < 0) {
+            if (error == 0) {
+                error = errno;
+            }
+            ++failed;
+            ++i;
+        } else {
+            sent.insert(sent.end(), pkts.begin() + i,
+                        pkts.begin() + i + result);
+            i += result;
+        }
+    }
+    if (failed > 0) {
+        isc_throw(SocketWriteError, "failed to send " << failed << " of "
+                  << pkts_num << " DHCPv4 packets, errno=" << error
+                  << " (check errno.h)");
+    }
+#else
+    PktFilter::sendBatch(iface, sockfd, pkts, sent);
+#endif
+}
+
+void
+PktFilterLPF::writeFrame(const Iface& iface, const Pkt4Ptr& pkt,
+                         OutputBuffer& buf) const {
     // Some interfaces may have no HW address - e.g. loopback interface.
     // For these interfaces the HW address length is 0. If this is the case,
     // then we will rely on the functions which construct the IP/UDP headers
@@ -303,23 +392,6 @@ PktFilterLPF::send(const Iface& iface, uint16_t sockfd, const Pkt4Ptr& pkt) {
 
     // DHCPv4 message
     buf.writeData(pkt->getBuffer().getData(), pkt->getBuffer().getLength());
-
-    sockaddr_ll sa;
-    sa.sll_family = AF_PACKET;
-    sa.sll_ifindex = iface.getIndex();
-    sa.sll_protocol = htons(ETH_P_IP);
-    sa.sll_halen = 6;
-
-    int result = sendto(sockfd, buf.getData(), buf.getLength(), 0,
-                        reinterpret_cast<const struct sockaddr*>(&sa),
-                        sizeof(sockaddr_ll));
-    if (result < 0) {
-        isc_throw(SocketWriteError, "failed to send DHCPv4 packet, errno="
-                  << errno << " (check errno.h)");
-    }
-
-    return (0);
-
 }
 
 
@@ -67,6 +67,32 @@ public:
     virtual int send(const Iface& iface, uint16_t sockfd,
                      const Pkt4Ptr& pkt);
 
+    /// @brief Send packets over specified socket.
+    ///
+    /// When the @c sendmmsg system call is available, the frames are
+    /// sent with a single call to it. Otherwise they are sent one by one.
+    ///
+    /// @param iface interface to be used to send packets
+    /// @param sockfd socket descriptor
+    /// @param pkts packets to be sent
+    /// @param [out] sent packets which have been sent are appended
+    /// to it, also when some of the packets couldn't be sent.
+    ///
+    /// @throw isc::dhcp::SocketWriteError if any of the packets couldn't
+    /// be sent.
+    virtual void sendBatch(const Iface& iface, uint16_t sockfd,
+                           const std::vector<Pkt4Ptr>& pkts,
+                           std::vector<Pkt4Ptr>& sent);
+
+private:
+
+    /// @brief Writes the Ethernet frame carrying the packet.
+    ///
+    /// @param iface interface to be used to send packet
+    /// @param pkt packet to be sent
+    /// @param [out] buf buffer to which the frame is written.
+    void writeFrame(const Iface& iface, const Pkt4Ptr& pkt,
+                    util::OutputBuffer& buf) const;
 };
 
 } // namespace isc::dhcp
@@ -2441,6 +2441,253 @@ TEST_F(IfaceMgrTest, detectIfaces) {
     iflist = 0;
 }
 
+// Verifies that multiple packets pending on the socket are received in
+// order and that the packets queued by the IfaceMgr are discarded when
+// the sockets are closed.
+TEST_F(IfaceMgrTest, sendReceiveBatch4) {
+    scoped_ptr<NakedIfaceMgr> ifacemgr(new NakedIfaceMgr());
+
+    IOAddress loAddr("127.0.0.1");
+    int socket1 = -1;
+    ASSERT_NO_THROW(
+        socket1 = ifacemgr->openSocket(LOOPBACK, loAddr, DHCP4_SERVER_PORT + 10000);
+    );
+    ASSERT_GE(socket1, 0);
+
+    // Send more packets than can be received at once.
+    const uint32_t pkts_num = IfaceMgr::RECEIVE_BATCH_SIZE + 5;
+    for (uint32_t transid = 1; transid <= pkts_num; ++transid) {
+        Pkt4Ptr sendPkt(new Pkt4(DHCPDISCOVER, transid));
+        sendPkt->setLocalAddr(IOAddress("127.0.0.1"));
+        sendPkt->setRemotePort(DHCP4_SERVER_PORT + 10000);
+        sendPkt->setRemoteAddr(IOAddress("127.0.0.1"));
+        sendPkt->setIndex(1);
+        sendPkt->setIface(string(LOOPBACK));
+        ASSERT_NO_THROW(sendPkt->pack());
+        ASSERT_NO_THROW(ifacemgr->send(sendPkt));
+    }
+
+    // The packets are returned in order.
+    for (uint32_t transid = 1; transid <= pkts_num; ++transid) {
+        Pkt4Ptr rcvPkt;
+        ASSERT_NO_THROW(rcvPkt = ifacemgr->receive4(10));
+        ASSERT_TRUE(rcvPkt);
+        ASSERT_NO_THROW(rcvPkt->unpack());
+        EXPECT_EQ(transid, rcvPkt->getTransid());
+        EXPECT_EQ(LOOPBACK, rcvPkt->getIface());
+    }
+
+    // Nothing more was received.
+    Pkt4Ptr rcvPkt;
+    ASSERT_NO_THROW(rcvPkt = ifacemgr->receive4(0, 1000));
+    EXPECT_FALSE(rcvPkt);
+
+    // Send two packets and receive one: the other one is queued.
+    for (uint32_t transid = 1; transid <= 2; ++transid) {
+        Pkt4Ptr sendPkt(new Pkt4(DHCPDISCOVER, transid));
+        sendPkt->setLocalAddr(IOAddress("127.0.0.1"));
+        sendPkt->setRemotePort(DHCP4_SERVER_PORT + 10000);
+        sendPkt->setRemoteAddr(IOAddress("127.0.0.1"));
+        sendPkt->setIndex(1);
+        sendPkt->setIface(string(LOOPBACK));
+        ASSERT_NO_THROW(sendPkt->pack());
+        ASSERT_NO_THROW(ifacemgr->send(sendPkt));
+    }
+    ASSERT_NO_THROW(rcvPkt = ifacemgr->receive4(10));
+    ASSERT_TRUE(rcvPkt);
+
+    // Closing the sockets discards the queued packet.
+    ifacemgr->closeSockets();
+    ASSERT_NO_THROW(rcvPkt = ifacemgr->receive4(0, 1000));
+    EXPECT_FALSE(rcvPkt);
+}
+
+// This is a performance benchmark measuring the reception of the bursts
+// of packets of different sizes while the number of the other sockets
+// watched by the IfaceMgr grows. The other sockets are the idle pipes
+// installed as external sockets.
+TEST_F(IfaceMgrTest, DISABLED_performanceReceive4) {
+    using namespace boost::posix_time;
+    scoped_ptr<NakedIfaceMgr> ifacemgr(new NakedIfaceMgr());
+
+    IOAddress loAddr("127.0.0.1");
+    int socket1 = -1;
+    ASSERT_NO_THROW(
+        socket1 = ifacemgr->openSocket(LOOPBACK, loAddr, DHCP4_SERVER_PORT + 10000);
+    );
+    ASSERT_GE(socket1, 0);
+
+    Pkt4Ptr sendPkt(new Pkt4(DHCPDISCOVER, 1));
+    sendPkt->setLocalAddr(IOAddress("127.0.0.1"));
+    sendPkt->setRemotePort(DHCP4_SERVER_PORT + 10000);
+    sendPkt->setRemoteAddr(IOAddress("127.0.0.1"));
+    sendPkt->setIndex(1);
+    sendPkt->setIface(string(LOOPBACK));
+    ASSERT_NO_THROW(sendPkt->pack());
+
+    const uint32_t packets = 10000;
+    const uint32_t idle_sockets[] = { 0, 100, 300 };
+    const uint32_t bursts[] = { 1, 8, 32 };
+    std::vector<int> pipe_fds;
+    for (int i = 0; i < 3; ++i) {
+        while (pipe_fds.size() < 2 * idle_sockets[i]) {
+            int fds[2];
+            ASSERT_EQ(0, pipe(fds));
+            pipe_fds.push_back(fds[0]);
+            pipe_fds.push_back(fds[1]);
+            ifacemgr->addExternalSocket(fds[0], IfaceMgr::SocketCallback());
+        }
+
+        for (int j = 0; j < 3; ++j) {
+            // Only the reception is measured.
+            time_duration dur;
+            for (uint32_t received = 0; received < packets;
+                 received += bursts[j]) {
+                for (uint32_t k = 0; k < bursts[j]; ++k) {
+                    ASSERT_NO_THROW(ifacemgr->send(sendPkt));
+                }
+                ptime before = microsec_clock::universal_time();
+                for (uint32_t k = 0; k < bursts[j]; ++k) {
+                    Pkt4Ptr rcvPkt;
+                    ASSERT_NO_THROW(rcvPkt = ifacemgr->receive4(1));
+                    ASSERT_TRUE(rcvPkt);
+                }
+                dur += microsec_clock::universal_time() - before;
+            }
+            std::cout << packets << " packets received in bursts of "
+                      << bursts[j] << " with " << idle_sockets[i]
+                      << " idle sockets took: " << to_simple_string(dur)
+                      << std::endl;
+        }
+    }
+
+    for (size_t i = 0; i < pipe_fds.size(); i += 2) {
+        ifacemgr->deleteExternalSocket(pipe_fds[i]);
+        close(pipe_fds[i]);
+        close(pipe_fds[i + 1]);
+    }
+}
+
+// Verifies that the queued packets are sent when the queue is flushed.
+TEST_F(IfaceMgrTest, queueSend4) {
+    scoped_ptr<NakedIfaceMgr> ifacemgr(new NakedIfaceMgr());
+
+    IOAddress loAddr("127.0.0.1");
+    int socket1 = -1;
+    ASSERT_NO_THROW(
+        socket1 = ifacemgr->openSocket(LOOPBACK, loAddr, DHCP4_SERVER_PORT + 10000);
+    );
+    ASSERT_GE(socket1, 0);
+
+    const uint32_t pkts_num = 10;
+    for (uint32_t transid = 1; transid <= pkts_num; ++transid) {
+        Pkt4Ptr sendPkt(new Pkt4(DHCPOFFER, transid));
+        sendPkt->setLocalAddr(IOAddress("127.0.0.1"));
+        sendPkt->setRemotePort(DHCP4_SERVER_PORT + 10000);
+        sendPkt->setRemoteAddr(IOAddress("127.0.0.1"));
+        sendPkt->setIndex(1);
+        sendPkt->setIface(string(LOOPBACK));
+        ASSERT_NO_THROW(sendPkt->pack());
+        ASSERT_NO_THROW(ifacemgr->queueSend(sendPkt));
+    }
+
+    // Nothing has been sent yet.
+    Pkt4Ptr rcvPkt;
+    ASSERT_NO_THROW(rcvPkt = ifacemgr->receive4(0, 1000));
+    EXPECT_FALSE(rcvPkt);
+
+    // Send the packets and receive them in order.
+    std::vector<Pkt4Ptr> sent;
+    ASSERT_NO_THROW(ifacemgr->flushSendQueue4(sent));
+    ASSERT_EQ(pkts_num, sent.size());
+    for (uint32_t transid = 1; transid <= pkts_num; ++transid) {
+        EXPECT_EQ(transid, sent[transid - 1]->getTransid());
+    }
+    for (uint32_t transid = 1; transid <= pkts_num; ++transid) {
+        ASSERT_NO_THROW(rcvPkt = ifacemgr->receive4(10));
+        ASSERT_TRUE(rcvPkt);
+        ASSERT_NO_THROW(rcvPkt->unpack());
+        EXPECT_EQ(transid, rcvPkt->getTransid());
+#ifdef HAVE_RECVMMSG
+        // The packets are received at once, so the next ones are still
+        // queued and not yet returned.
+        EXPECT_EQ(transid < pkts_num, ifacemgr->hasReceivedPackets4());
+#endif
+    }
+
+    // The queue is empty.
+    sent.clear();
+    ASSERT_NO_THROW(ifacemgr->flushSendQueue4(sent));
+    EXPECT_TRUE(sent.empty());
+
+    // The packet can't be queued for a non-existing interface.
+    Pkt4Ptr badPkt(new Pkt4(DHCPOFFER, 1));
+    badPkt->setIface("non-existing");
+    EXPECT_THROW(ifacemgr->queueSend(badPkt), BadValue);
+}
+
+// This is a performance benchmark comparing sending the packets one by
+// one with queueing them and sending them in batches of different sizes.
+// The packets are sent to a socket which is never read, so the packets
+// are dropped once its receive buffer is full.
+TEST_F(IfaceMgrTest, DISABLED_performanceQueueSend4) {
+    using namespace boost::posix_time;
+    scoped_ptr<NakedIfaceMgr> ifacemgr(new NakedIfaceMgr());
+
+    IOAddress loAddr("127.0.0.1");
+    int socket1 = -1;
+    ASSERT_NO_THROW(
+        socket1 = ifacemgr->openSocket(LOOPBACK, loAddr, DHCP4_SERVER_PORT + 10000);
+    );
+    ASSERT_GE(socket1, 0);
+
+    int sink = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(sink, 0);
+    struct sockaddr_in sink_addr;
+    memset(&sink_addr, 0, sizeof(sink_addr));
+    sink_addr.sin_family = AF_INET;
+    sink_addr.sin_port = htons(DHCP4_SERVER_PORT + 10001);
+    sink_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(0, bind(sink, reinterpret_cast<struct sockaddr*>(&sink_addr),
+                      sizeof(sink_addr)));
+
+    Pkt4Ptr sendPkt(new Pkt4(DHCPOFFER, 1));
+    sendPkt->setLocalAddr(IOAddress("127.0.0.1"));
+    sendPkt->setRemotePort(DHCP4_SERVER_PORT + 10001);
+    sendPkt->setRemoteAddr(IOAddress("127.0.0.1"));
+    sendPkt->setIndex(1);
+    sendPkt->setIface(string(LOOPBACK));
+    ASSERT_NO_THROW(sendPkt->pack());
+
+    const uint32_t packets = 100000;
+    ptime before = microsec_clock::universal_time();
+    for (uint32_t i = 0; i < packets; ++i) {
+        ASSERT_NO_THROW(ifacemgr->send(sendPkt));
+    }
+    time_duration dur = microsec_clock::universal_time() - before;
+    std::cout << packets << " packets sent one by one took: "
+              << to_simple_string(dur) << std::endl;
+
+    const uint32_t batches[] = { 8, 32, 64 };
+    std::vector<Pkt4Ptr> sent;
+    for (int i = 0; i < 3; ++i) {
+        before = microsec_clock::universal_time();
+        for (uint32_t queued = 0; queued < packets; queued += batches[i]) {
+            for (uint32_t j = 0; j < batches[i]; ++j) {
+                ASSERT_NO_THROW(ifacemgr->queueSend(sendPkt));
+            }
+            sent.clear();
+            ASSERT_NO_THROW(ifacemgr->flushSendQueue4(sent));
+            ASSERT_EQ(batches[i], sent.size());
+        }
+        dur = microsec_clock::universal_time() - before;
+        std::cout << packets << " packets sent in batches of " << batches[i]
+                  << " took: " << to_simple_string(dur) << std::endl;
+    }
+
+    close(sink);
+}
+
 volatile bool callback_ok;
 volatile bool callback2_ok;
 
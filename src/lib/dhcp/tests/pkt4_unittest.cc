@@ -14,9 +14,11 @@
 #include <dhcp/option_string.h>
 #include <dhcp/option4_addrlst.h>
 #include <dhcp/pkt4.h>
+#include <dhcp/tests/pkt_captures.h>
 #include <exceptions/exceptions.h>
 #include <util/buffer.h>
 
+#include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/shared_array.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/scoped_ptr.hpp>
@@ -32,7 +34,9 @@ using namespace std;
 using namespace isc;
 using namespace isc::asiolink;
 using namespace isc::dhcp;
+using namespace isc::dhcp::test;
 using namespace isc::util;
+using namespace boost::posix_time;
 // Don't import the entire boost namespace.  It will unexpectedly hide uint8_t
 // for some systems.
 using boost::scoped_ptr;
@@ -674,6 +678,88 @@ TEST_F(Pkt4Test, unpackOptions) {
     verifyParsedOptions(pkt);
 }
 
+// This test verifies that the options are unpacked on demand when the
+// lazy unpacking is enabled.
+TEST_F(Pkt4Test, unpackOptionsLazy) {
+
+    vector<uint8_t> expectedFormat = generateTestPacket2();
+
+    expectedFormat.push_back(0x63);
+    expectedFormat.push_back(0x82);
+    expectedFormat.push_back(0x53);
+    expectedFormat.push_back(0x63);
+
+    for (size_t i = 0; i < sizeof(v4_opts); i++) {
+        expectedFormat.push_back(v4_opts[i]);
+    }
+
+    Pkt4Ptr pkt(new Pkt4(&expectedFormat[0], expectedFormat.size()));
+    pkt->setLazyUnpack(true);
+    ASSERT_NO_THROW(pkt->unpack());
+
+    // No option has been created yet but the deferred option is known.
+    EXPECT_TRUE(pkt->options_.empty());
+    ASSERT_EQ(1, pkt->getDeferredOptions().size());
+    EXPECT_EQ(254, pkt->getDeferredOptions().front());
+
+    // Only the retrieved option is created.
+    EXPECT_EQ(DHCPOFFER, pkt->getType());
+    EXPECT_EQ(1, pkt->options_.size());
+
+    verifyParsedOptions(pkt);
+    EXPECT_EQ(6, pkt->options_.size());
+
+    // The packet is the same as the one unpacked at once.
+    Pkt4Ptr eager(new Pkt4(&expectedFormat[0], expectedFormat.size()));
+    ASSERT_NO_THROW(eager->unpack());
+    pkt.reset(new Pkt4(&expectedFormat[0], expectedFormat.size()));
+    pkt->setLazyUnpack(true);
+    ASSERT_NO_THROW(pkt->unpack());
+    EXPECT_EQ(eager->toText(), pkt->toText());
+    EXPECT_EQ(eager->options_.size(), pkt->options_.size());
+
+    pkt.reset(new Pkt4(&expectedFormat[0], expectedFormat.size()));
+    pkt->setLazyUnpack(true);
+    ASSERT_NO_THROW(pkt->unpack());
+    ASSERT_NO_THROW(eager->pack());
+    ASSERT_NO_THROW(pkt->pack());
+    ASSERT_EQ(eager->getBuffer().getLength(), pkt->getBuffer().getLength());
+    EXPECT_EQ(0, memcmp(eager->getBuffer().getData(), pkt->getBuffer().getData(),
+                        pkt->getBuffer().getLength()));
+
+    // The hook libraries may walk the options directly, so all options
+    // are created when copying the retrieved options is enabled.
+    pkt.reset(new Pkt4(&expectedFormat[0], expectedFormat.size()));
+    pkt->setLazyUnpack(true);
+    ASSERT_NO_THROW(pkt->unpack());
+    pkt->setCopyRetrievedOptions(true);
+    EXPECT_EQ(6, pkt->options_.size());
+}
+
+// This is a performance benchmark comparing unpacking all options of
+// a relayed DHCPDISCOVER with unpacking only the options retrieved by
+// the server.
+TEST_F(Pkt4Test, DISABLED_performanceUnpack) {
+    const int packets = 100000;
+    const OptionBuffer data = PktCaptures::captureRelayedDiscover()->data_;
+    for (int lazy = 0; lazy < 2; ++lazy) {
+        ptime before = microsec_clock::local_time();
+        for (int i = 0; i < packets; ++i) {
+            Pkt4Ptr pkt(new Pkt4(&data[0], data.size()));
+            pkt->setLazyUnpack(lazy);
+            pkt->unpack();
+            ASSERT_EQ(DHCPDISCOVER, pkt->getType());
+            ASSERT_TRUE(pkt->getOption(DHO_DHCP_CLIENT_IDENTIFIER));
+            ASSERT_TRUE(pkt->getOption(DHO_DHCP_AGENT_OPTIONS));
+            ASSERT_TRUE(pkt->getOption(DHO_VENDOR_CLASS_IDENTIFIER));
+        }
+        time_duration dur = microsec_clock::local_time() - before;
+        std::cout << packets << " packets unpacked "
+                  << (lazy ? "on demand" : "at once") << " in: "
+                  << to_simple_string(dur) << std::endl;
+    }
+}
+
 // Checks if the code is able to handle a malformed option
 TEST_F(Pkt4Test, unpackMalformed) {
 
@@ -779,6 +865,55 @@ TEST_F(Pkt4Test, unpackVendorMalformed) {
     EXPECT_THROW(too_short_pkt->unpack(), InvalidOptionValue);
 }
 
+// Checks that a malformed option is discarded and reported when it is
+// retrieved if the lazy unpacking is enabled.
+TEST_F(Pkt4Test, unpackVendorMalformedLazy) {
+
+    vector<uint8_t> orig = generateTestPacket2();
+
+    orig.push_back(0x63);
+    orig.push_back(0x82);
+    orig.push_back(0x53);
+    orig.push_back(0x63);
+
+    orig.push_back(53); // Message Type
+    orig.push_back(1); // length=1
+    orig.push_back(2); // type=2
+
+    orig.push_back(125); // vivso suboptions
+    orig.push_back(10); // length=10 while data-len=10
+    orig.push_back(1); // vendor_id=0x1020304
+    orig.push_back(2);
+    orig.push_back(3);
+    orig.push_back(4);
+    orig.push_back(10); // data-len=10
+    orig.push_back(128); // suboption type=128
+    orig.push_back(3); // suboption length=3
+    orig.push_back(102); // data="foo"
+    orig.push_back(111);
+    orig.push_back(111);
+
+    Pkt4Ptr pkt(new Pkt4(&orig[0], orig.size()));
+    pkt->setLazyUnpack(true);
+    EXPECT_NO_THROW(pkt->unpack());
+
+    // The other options are available.
+    EXPECT_EQ(DHCPOFFER, pkt->getType());
+    EXPECT_TRUE(pkt->getLazyUnpackError().empty());
+
+    // The malformed option is discarded when it is retrieved.
+    EXPECT_FALSE(pkt->getOption(125));
+    EXPECT_FALSE(pkt->getLazyUnpackError().empty());
+    EXPECT_FALSE(pkt->getOption(125));
+    EXPECT_NO_THROW(pkt->unpackLazyOptions());
+    EXPECT_NO_THROW(pkt->toText());
+
+    // The error is cleared when the packet is unpacked again.
+    pkt->setLazyUnpack(false);
+    EXPECT_THROW(pkt->unpack(), InvalidOptionValue);
+    EXPECT_TRUE(pkt->getLazyUnpackError().empty());
+}
+
 // This test verifies methods that are used for manipulating meta fields
 // i.e. fields that are not part of DHCPv4 (e.g. interface name).
 TEST_F(Pkt4Test, metaFields) {
@@ -782,6 +782,50 @@ TEST_F(Pkt6Test, relayUnpack) {
     EXPECT_EQ(243, oro_list[2]);
 }
 
+// This test verifies that the options of the relayed message are
+// unpacked on demand when the lazy unpacking is enabled.
+TEST_F(Pkt6Test, relayUnpackLazy) {
+    Pkt6Ptr eager(capture2());
+    ASSERT_NO_THROW(eager->unpack());
+
+    Pkt6Ptr msg(capture2());
+    msg->setLazyUnpack(true);
+    ASSERT_NO_THROW(msg->unpack());
+
+    // The relay options are unpacked at once.
+    ASSERT_EQ(2, msg->relay_info_.size());
+    EXPECT_EQ(2, msg->relay_info_[0].options_.size());
+    EXPECT_TRUE(msg->options_.empty());
+
+    // The options of the message are created when retrieved.
+    OptionPtr opt;
+    ASSERT_TRUE(opt = msg->getOption(D6O_CLIENTID));
+    EXPECT_EQ(1, msg->options_.size());
+    EXPECT_TRUE(opt->equals(eager->getOption(D6O_CLIENTID)));
+
+    OptionCollection ias = msg->getOptions(D6O_IA_NA);
+    ASSERT_EQ(1, ias.size());
+    boost::shared_ptr<Option6IA> ia =
+        boost::dynamic_pointer_cast<Option6IA>(ias.begin()->second);
+    ASSERT_TRUE(ia);
+    EXPECT_EQ(1, ia->getIAID());
+    EXPECT_FALSE(msg->getOption(D6O_IA_PD));
+
+    // The packet is the same as the one unpacked at once.
+    EXPECT_EQ(eager->len(), msg->len());
+    EXPECT_EQ(eager->options_.size(), msg->options_.size());
+    EXPECT_EQ(eager->toText(), msg->toText());
+
+    msg = capture2();
+    msg->setLazyUnpack(true);
+    ASSERT_NO_THROW(msg->unpack());
+    ASSERT_NO_THROW(eager->pack());
+    ASSERT_NO_THROW(msg->pack());
+    ASSERT_EQ(eager->getBuffer().getLength(), msg->getBuffer().getLength());
+    EXPECT_EQ(0, memcmp(eager->getBuffer().getData(), msg->getBuffer().getData(),
+                        msg->getBuffer().getLength()));
+}
+
 // This test verified that message with relay information can be
 // packed and then unpacked.
 TEST_F(Pkt6Test, relayPack) {
@@ -25,10 +25,13 @@
 #include <dhcpsrv/callout_handle_store.h>
 #include <stats/stats_mgr.h>
 #include <util/stopwatch.h>
+#include <util/threads/multi_threading_mgr.h>
 #include <hooks/server_hooks.h>
 #include <hooks/hooks_manager.h>
 
 #include <boost/foreach.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
 
 #include <algorithm>
 #include <cstring>
@@ -37,6 +40,8 @@
 #include <vector>
 #include <stdint.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
 #include <utility>
 
 using namespace isc::asiolink;
@@ -44,6 +49,8 @@ using namespace isc::dhcp;
 using namespace isc::dhcp_ddns;
 using namespace isc::hooks;
 using namespace isc::stats;
+using isc::util::thread::Mutex;
+using isc::util::thread::MultiThreadingLock;
 
 namespace {
 
@@ -73,17 +80,265 @@ struct AllocEngineHooks {
     }
 };
 
+/// @brief Updates the usage bitmap of the pool an IPv4 address belongs to.
+///
+/// @param subnet Subnet to which the address belongs.
+/// @param address Address which usage has changed.
+/// @param used Boolean value indicating if the address is leased or
+/// reserved (if true) or free (if false).
+void
+markAddressUsed(const SubnetPtr& subnet, const IOAddress& address,
+                const bool used) {
+    PoolPtr pool = subnet->getPool(Lease::TYPE_V4, address, false);
+    if (pool) {
+        boost::static_pointer_cast<Pool4>(pool)->markAddressUsed(address, used);
+    }
+}
+
 // Declare a Hooks object. As this is outside any function or method, it
 // will be instantiated (and the constructor run) when the module is loaded.
 // As a result, the hook indexes will be defined before any method in this
 // module is called.
 AllocEngineHooks Hooks;
 
+/// @brief Returns the address increased by the specified offset.
+///
+/// @param base Address to be increased.
+/// @param offset Value by which the address should be increased.
+/// @param shift Number of bits by which the offset should be shifted left
+/// before it is added to the address. This is used to compute the offset
+/// of the delegated prefix. It must be lower than 128.
+/// @return Increased address.
+IOAddress
+offsetAddress(const IOAddress& base, const uint64_t offset,
+              const uint8_t shift = 0) {
+    if (base.isV4()) {
+        return (IOAddress(static_cast<uint32_t>(base.toUint32() + offset)));
+    }
+
+    // Compute the 128-bit value to be added as two 64-bit halves.
+    uint64_t high = 0;
+    uint64_t low = 0;
+    if (shift >= 64) {
+        high = offset << (shift - 64);
+    } else if (shift > 0) {
+        high = offset >> (64 - shift);
+        low = offset << shift;
+    } else {
+        low = offset;
+    }
+
+    std::vector<uint8_t> packed = base.toBytes();
+    unsigned int carry = 0;
+    for (int i = V6ADDRESS_LEN - 1; i >= 0; --i) {
+        const uint64_t half = (i >= 8 ? low : high);
+        const unsigned int byte = (half >> (8 * ((V6ADDRESS_LEN - 1 - i) % 8))) & 0xff;
+        const unsigned int sum = packed[i] + byte + carry;
+        packed[i] = static_cast<uint8_t>(sum & 0xff);
+        carry = sum >> 8;
+    }
+    return (IOAddress::fromBytes(AF_INET6, &packed[0]));
+}
+
+/// @brief Returns a random number lower than the specified limit.
+///
+/// @param limit Upper bound (exclusive) of the returned value.
+uint64_t
+randomOffset(const uint64_t limit) {
+    static boost::random::mt19937_64 generator(static_cast<uint64_t>(time(NULL)) ^
+                                               static_cast<uint64_t>(getpid()));
+    // The generator is shared by all allocators.
+    static Mutex generator_mutex;
+    if (limit <= 1) {
+        return (0);
+    }
+    boost::random::uniform_int_distribution<uint64_t> dist(0, limit - 1);
+    MultiThreadingLock lock(generator_mutex);
+    return (dist(generator));
+}
+
+/// @brief Returns the FNV-1a hash of the client identifier.
+///
+/// @param duid Client's DUID or client identifier.
+/// @param seed Value mixed into the offset basis of the hash.
+uint64_t
+hashClientId(const DUID& duid, const uint64_t seed = 0) {
+    const std::vector<uint8_t>& data = duid.getDuid();
+    uint64_t hash = 14695981039346656037ULL ^ seed;
+    for (std::vector<uint8_t>::const_iterator byte = data.begin();
+         byte != data.end(); ++byte) {
+        hash ^= *byte;
+        hash *= 1099511628211ULL;
+    }
+    return (hash);
+}
+
 }; // anonymous namespace
 
 namespace isc {
 namespace dhcp {
 
+AllocEngine::Allocator::Allocator(Lease::Type pool_type)
+    :pool_type_(pool_type), use_usage_bitmaps_(pool_type == Lease::TYPE_V4),
+     mutex_(new Mutex()) {
+}
+
+isc::asiolink::IOAddress
+AllocEngine::Allocator::pickAddress(const SubnetPtr& subnet,
+                                    const DuidPtr& duid,
+                                    const IOAddress& hint,
+                                    const uint64_t attempt) {
+    MultiThreadingLock lock(*mutex_);
+    return (pickAddressInternal(subnet, duid, hint, attempt));
+}
+
+bool
+AllocEngine::Allocator::populateUsageBitmaps(const SubnetPtr& subnet) {
+    // Pools larger than this are not indexed because their bitmaps would
+    // consume too much memory.
+    const uint64_t MAX_INDEXED_POOL_CAPACITY = 1 << 24;
+
+    if (!use_usage_bitmaps_) {
+        return (false);
+    }
+
+    const PoolCollection& pools = subnet->getPools(pool_type_);
+    if (pools.empty()) {
+        return (false);
+    }
+
+    bool populated = true;
+    for (PoolCollection::const_iterator pool = pools.begin();
+         pool != pools.end(); ++pool) {
+        if ((*pool)->getCapacity() > MAX_INDEXED_POOL_CAPACITY) {
+            return (false);
+        }
+        Pool4Ptr pool4 = boost::dynamic_pointer_cast<Pool4>(*pool);
+        if (!pool4) {
+            return (false);
+        }
+        if (!pool4->getUsageBitmap()) {
+            populated = false;
+        }
+    }
+
+    if (populated) {
+        return (true);
+    }
+
+    Lease4Collection leases;
+    try {
+        leases = LeaseMgrFactory::instance().getLeases4(subnet->getID());
+
+    } catch (const NotImplemented&) {
+        // The lease backend doesn't support this query, so the bitmaps
+        // will never be available.
+        use_usage_bitmaps_ = false;
+        return (false);
+    }
+
+    // Create bitmaps for the pools which don't have them yet.
+    for (PoolCollection::const_iterator pool = pools.begin();
+         pool != pools.end(); ++pool) {
+        Pool4Ptr pool4 = boost::dynamic_pointer_cast<Pool4>(*pool);
+        if (!pool4->getUsageBitmap()) {
+            pool4->setUsageBitmap(PoolBitmapPtr(new PoolBitmap(pool4->getCapacity())));
+        }
+    }
+
+    // Mark all addresses for which there are valid leases as used. The
+    // addresses of the expired leases are left free so as the leases are
+    // reused. The reserved addresses are marked as used when they are
+    // first picked for another client.
+    for (Lease4Collection::const_iterator lease = leases.begin();
+         lease != leases.end(); ++lease) {
+        if (!(*lease)->expired()) {
+            markAddressUsed(subnet, (*lease)->addr_, true);
+        }
+    }
+
+    return (true);
+}
+
+IOAddress
+AllocEngine::Allocator::getAddressAtOffset(const SubnetPtr& subnet,
+                                           uint64_t offset) const {
+    const PoolCollection& pools = subnet->getPools(pool_type_);
+    for (PoolCollection::const_iterator pool = pools.begin();
+         pool != pools.end(); ++pool) {
+        const uint64_t capacity = (*pool)->getCapacity();
+        if (offset < capacity) {
+            uint8_t shift = 0;
+            if (pool_type_ == Lease::TYPE_PD) {
+                Pool6Ptr pool6 = boost::dynamic_pointer_cast<Pool6>(*pool);
+                if (!pool6) {
+                    // Something is gravely wrong here
+                    isc_throw(Unexpected, "Wrong type of pool: "
+                              << (*pool)->toText() << " is not Pool6");
+                }
+                shift = 128 - pool6->getLength();
+            }
+            return (offsetAddress((*pool)->getFirstAddress(), offset, shift));
+        }
+        offset -= capacity;
+    }
+    isc_throw(BadValue, "offset is out of range of the pools in subnet "
+              << subnet->toText());
+}
+
+IOAddress
+AllocEngine::Allocator::pickAddressFromOffset(const SubnetPtr& subnet,
+                                              const uint64_t first_offset,
+                                              const uint64_t attempt) {
+    const PoolCollection& pools = subnet->getPools(pool_type_);
+    if (pools.empty()) {
+        isc_throw(AllocFailed, "No pools defined in selected subnet");
+    }
+
+    // The previous candidates were rejected, so try the following ones.
+    const uint64_t capacity = subnet->getPoolCapacity(pool_type_);
+    uint64_t offset = (first_offset % capacity + attempt % capacity) % capacity;
+
+    // Skip the addresses for which there are leases already. If all
+    // addresses are used, some of the leases may be expired, so the
+    // addresses are returned one by one to let the allocation engine
+    // find them.
+    if (populateUsageBitmaps(subnet)) {
+        uint64_t pool_start = 0;
+        size_t first_pool = 0;
+        for (; first_pool < pools.size(); ++first_pool) {
+            const uint64_t pool_capacity = pools[first_pool]->getCapacity();
+            if (offset < pool_start + pool_capacity) {
+                break;
+            }
+            pool_start += pool_capacity;
+        }
+
+        // Walk over all pools, beginning from the one found above. The
+        // first pool is visited twice, because the search in this pool
+        // begins in the middle of it.
+        for (size_t i = 0; i <= pools.size(); ++i) {
+            const size_t index = (first_pool + i) % pools.size();
+            if (index == 0) {
+                pool_start = 0;
+            }
+            Pool4Ptr pool4 = boost::static_pointer_cast<Pool4>(pools[index]);
+            const uint32_t first = pool4->getFirstAddress().toUint32();
+            const IOAddress start(first + static_cast<uint32_t>(i == 0 ?
+                                                                offset - pool_start :
+                                                                0));
+            IOAddress free_address = IOAddress::IPV4_ZERO_ADDRESS();
+            if (pool4->findFreeAddress(start, free_address)) {
+                offset = pool_start + (free_address.toUint32() - first);
+                break;
+            }
+            pool_start += pools[index]->getCapacity();
+        }
+    }
+
+    return (getAddressAtOffset(subnet, offset));
+}
+
 AllocEngine::IterativeAllocator::IterativeAllocator(Lease::Type lease_type)
     :Allocator(lease_type) {
 }
@@ -146,9 +401,18 @@ AllocEngine::IterativeAllocator::increasePrefix(const isc::asiolink::IOAddress&
 
 
 isc::asiolink::IOAddress
-AllocEngine::IterativeAllocator::pickAddress(const SubnetPtr& subnet,
+AllocEngine::IterativeAllocator::pickAddressInternal(const SubnetPtr& subnet,
                                              const DuidPtr&,
-                                             const IOAddress&) {
+                                             const IOAddress&,
+                                             const uint64_t) {
+
+    // Use the pools' usage bitmaps to skip the addresses for which
+    // there are leases already, rather than probing each of them.
+    IOAddress free_address("0.0.0.0");
+    if (pickFreeAddress4(subnet, free_address)) {
+        subnet->setLastAllocated(pool_type_, free_address);
+        return (free_address);
+    }
 
     // Is this prefix allocation?
     bool prefix = pool_type_ == Lease::TYPE_PD;
@@ -165,12 +429,7 @@ AllocEngine::IterativeAllocator::pickAddress(const SubnetPtr& subnet,
     }
 
     // first we need to find a pool the last address belongs to.
-    PoolCollection::const_iterator it;
-    for (it = pools.begin(); it != pools.end(); ++it) {
-        if ((*it)->inRange(last)) {
-            break;
-        }
-    }
+    PoolCollection::const_iterator it = subnet->findPool(pool_type_, last);
 
     // last one was bogus for one of several reasons:
     // - we just booted up and that's the first address we're allocating
@@ -220,75 +479,102 @@ AllocEngine::IterativeAllocator::pickAddress(const SubnetPtr& subnet,
     return (next);
 }
 
+bool
+AllocEngine::IterativeAllocator::pickFreeAddress4(const SubnetPtr& subnet,
+                                                  IOAddress& address) {
+    if (!populateUsageBitmaps(subnet)) {
+        return (false);
+    }
+
+    const PoolCollection& pools = subnet->getPools(pool_type_);
+    IOAddress last = subnet->getLastAllocated(pool_type_);
+
+    // Find the pool and the address at which the search should start,
+    // i.e. the address following the last allocated one.
+    size_t first_pool = 0;
+    IOAddress start = pools[0]->getFirstAddress();
+    PoolCollection::const_iterator last_pool = subnet->findPool(pool_type_, last);
+    if (last_pool != pools.end()) {
+        size_t i = last_pool - pools.begin();
+        IOAddress next = IOAddress::increase(last);
+        if (pools[i]->inRange(next)) {
+            first_pool = i;
+            start = next;
+        } else {
+            first_pool = (i + 1) % pools.size();
+            start = pools[first_pool]->getFirstAddress();
+        }
+    }
+
+    // Walk over all pools, beginning from the one found above. The first
+    // pool is visited twice, because the search in this pool begins in
+    // the middle of it.
+    for (size_t i = 0; i <= pools.size(); ++i) {
+        const size_t index = (first_pool + i) % pools.size();
+        Pool4Ptr pool = boost::dynamic_pointer_cast<Pool4>(pools[index]);
+        if (!pool) {
+            return (false);
+        }
+        if (pool->findFreeAddress((i == 0 ? start : pool->getFirstAddress()),
+                                  address)) {
+            return (true);
+        }
+    }
+
+    // All addresses are used. Some of them may be expired leases, which
+    // are found by probing the lease database.
+    return (false);
+}
+
 AllocEngine::HashedAllocator::HashedAllocator(Lease::Type lease_type)
     :Allocator(lease_type) {
-    isc_throw(NotImplemented, "Hashed allocator is not implemented");
 }
 
 
 isc::asiolink::IOAddress
-AllocEngine::HashedAllocator::pickAddress(const SubnetPtr&,
-                                          const DuidPtr&,
-                                          const IOAddress&) {
-    isc_throw(NotImplemented, "Hashed allocator is not implemented");
+AllocEngine::HashedAllocator::pickAddressInternal(const SubnetPtr& subnet,
+                                          const DuidPtr& duid,
+                                          const IOAddress&,
+                                          const uint64_t attempt) {
+    // Without the client identifier, there is nothing to hash.
+    const uint64_t offset = (duid ? hashClientId(*duid) :
+                             randomOffset(subnet->getPoolCapacity(pool_type_)));
+    return (pickAddressFromOffset(subnet, offset, attempt));
 }
 
 AllocEngine::RandomAllocator::RandomAllocator(Lease::Type lease_type)
-    :Allocator(lease_type) {
-    isc_throw(NotImplemented, "Random allocator is not implemented");
+    :Allocator(lease_type),
+     seed_(randomOffset(std::numeric_limits<uint64_t>::max())) {
 }
 
 
 isc::asiolink::IOAddress
-AllocEngine::RandomAllocator::pickAddress(const SubnetPtr&,
-                                          const DuidPtr&,
-                                          const IOAddress&) {
-    isc_throw(NotImplemented, "Random allocator is not implemented");
+AllocEngine::RandomAllocator::pickAddressInternal(const SubnetPtr& subnet,
+                                          const DuidPtr& duid,
+                                          const IOAddress&,
+                                          const uint64_t attempt) {
+    const uint64_t offset = (duid ? hashClientId(*duid, seed_) :
+                             randomOffset(subnet->getPoolCapacity(pool_type_)));
+    return (pickAddressFromOffset(subnet, offset, attempt));
 }
 
 
 AllocEngine::AllocEngine(AllocType engine_type, uint64_t attempts,
                          bool ipv6)
-    : attempts_(attempts), incomplete_v4_reclamations_(0),
-      incomplete_v6_reclamations_(0) {
+    : subnet_allocators_mutex_(new Mutex()), attempts_(attempts),
+      incomplete_v4_reclamations_(0), incomplete_v6_reclamations_(0) {
 
     // Choose the basic (normal address) lease type
     Lease::Type basic_type = ipv6 ? Lease::TYPE_NA : Lease::TYPE_V4;
 
     // Initialize normal address allocators
-    switch (engine_type) {
-    case ALLOC_ITERATIVE:
-        allocators_[basic_type] = AllocatorPtr(new IterativeAllocator(basic_type));
-        break;
-    case ALLOC_HASHED:
-        allocators_[basic_type] = AllocatorPtr(new HashedAllocator(basic_type));
-        break;
-    case ALLOC_RANDOM:
-        allocators_[basic_type] = AllocatorPtr(new RandomAllocator(basic_type));
-        break;
-    default:
-        isc_throw(BadValue, "Invalid/unsupported allocation algorithm");
-    }
+    allocators_[basic_type] = createAllocator(engine_type, basic_type);
 
     // If this is IPv6 allocation engine, initialize also temporary addrs
     // and prefixes
     if (ipv6) {
-        switch (engine_type) {
-        case ALLOC_ITERATIVE:
-            allocators_[Lease::TYPE_TA] = AllocatorPtr(new IterativeAllocator(Lease::TYPE_TA));
-            allocators_[Lease::TYPE_PD] = AllocatorPtr(new IterativeAllocator(Lease::TYPE_PD));
-            break;
-        case ALLOC_HASHED:
-            allocators_[Lease::TYPE_TA] = AllocatorPtr(new HashedAllocator(Lease::TYPE_TA));
-            allocators_[Lease::TYPE_PD] = AllocatorPtr(new HashedAllocator(Lease::TYPE_PD));
-            break;
-        case ALLOC_RANDOM:
-            allocators_[Lease::TYPE_TA] = AllocatorPtr(new RandomAllocator(Lease::TYPE_TA));
-            allocators_[Lease::TYPE_PD] = AllocatorPtr(new RandomAllocator(Lease::TYPE_PD));
-            break;
-        default:
-            isc_throw(BadValue, "Invalid/unsupported allocation algorithm");
-        }
+        allocators_[Lease::TYPE_TA] = createAllocator(engine_type, Lease::TYPE_TA);
+        allocators_[Lease::TYPE_PD] = createAllocator(engine_type, Lease::TYPE_PD);
     }
 
     // Register hook points
@@ -306,6 +592,43 @@ AllocEngine::AllocatorPtr AllocEngine::getAllocator(Lease::Type type) {
     return (alloc->second);
 }
 
+AllocEngine::AllocatorPtr
+AllocEngine::getAllocator(Lease::Type type, const SubnetPtr& subnet) {
+    const std::string& name = subnet->getAllocatorType();
+    if (name.empty()) {
+        return (getAllocator(type));
+    }
+
+    AllocType alloc_type = ALLOC_ITERATIVE;
+    if (name == "random") {
+        alloc_type = ALLOC_RANDOM;
+    } else if (name == "hashed") {
+        alloc_type = ALLOC_HASHED;
+    }
+
+    MultiThreadingLock lock(*subnet_allocators_mutex_);
+    AllocatorPtr& allocator = subnet_allocators_[std::make_pair(alloc_type, type)];
+    if (!allocator) {
+        allocator = createAllocator(alloc_type, type);
+    }
+    return (allocator);
+}
+
+AllocEngine::AllocatorPtr
+AllocEngine::createAllocator(AllocType alloc_type, Lease::Type type) {
+    switch (alloc_type) {
+    case ALLOC_ITERATIVE:
+        return (AllocatorPtr(new IterativeAllocator(type)));
+    case ALLOC_HASHED:
+        return (AllocatorPtr(new HashedAllocator(type)));
+    case ALLOC_RANDOM:
+        return (AllocatorPtr(new RandomAllocator(type)));
+    default:
+        ;
+    }
+    isc_throw(BadValue, "Invalid/unsupported allocation algorithm");
+}
+
 template<typename ContextType>
 void
 AllocEngine::findReservationInternal(ContextType& ctx,
@@ -321,14 +644,14 @@ AllocEngine::findReservationInternal(ContextType& ctx,
         // Only makes sense to get reservations if the client has access
         // to the class.
         if (subnet->clientSupported(ctx.query_->getClasses())) {
-            // Iterate over configured identifiers in the order of preference
-            // and try to use each of them to search for the reservations.
-            BOOST_FOREACH(const IdentifierPair& id_pair, ctx.host_identifiers_) {
-                // Attempt to find a host using a specified identifier.
-                ConstHostPtr host = host_get(subnet->getID(), id_pair.first,
-                                             &id_pair.second[0], id_pair.second.size());
+            // Retrieve the hosts for all configured identifiers at once.
+            // They are returned in the order of preference of identifiers,
+            // so the first matching host is used.
+            ConstHostCollection hosts = host_get(subnet->getID(),
+                                                 ctx.host_identifiers_);
+            BOOST_FOREACH(const ConstHostPtr& host, hosts) {
                 // If we found matching host for this subnet.
-                if (host && (!ipv6_only || host->hasIPv6Reservation())) {
+                if (!ipv6_only || host->hasIPv6Reservation()) {
                     ctx.hosts_[subnet->getID()] = host;
                     break;
                 }
@@ -461,9 +784,9 @@ AllocEngine::ClientContext6::currentHost() const {
 }
 
 void AllocEngine::findReservation(ClientContext6& ctx) {
-    findReservationInternal(ctx, boost::bind(&HostMgr::get6,
+    findReservationInternal(ctx, boost::bind(&HostMgr::getByIdentifiers6,
                                              &HostMgr::instance(),
-                                             _1, _2, _3, _4));
+                                             _1, _2));
 }
 
 Lease6Collection
@@ -640,13 +963,6 @@ AllocEngine::allocateLeases6(ClientContext6& ctx) {
 Lease6Collection
 AllocEngine::allocateUnreservedLeases6(ClientContext6& ctx) {
 
-    AllocatorPtr allocator = getAllocator(ctx.currentIA().type_);
-
-    if (!allocator) {
-        isc_throw(InvalidOperation, "No allocator specified for "
-                  << Lease6::typeToText(ctx.currentIA().type_));
-    }
-
     // Check which host reservation mode is supported in this subnet.
     Network::HRMode hr_mode = ctx.subnet_->getHostReservationMode();
 
@@ -778,12 +1094,19 @@ AllocEngine::allocateUnreservedLeases6(ClientContext6& ctx) {
         uint64_t max_attempts = (attempts_ > 0 ? attempts_  :
                                  subnet->getPoolCapacity(ctx.currentIA().type_));
 
+        // The allocator may be configured for the subnet.
+        AllocatorPtr allocator = getAllocator(ctx.currentIA().type_, subnet);
+        if (!allocator) {
+            isc_throw(InvalidOperation, "No allocator specified for "
+                      << Lease6::typeToText(ctx.currentIA().type_));
+        }
+
         for (uint64_t i = 0; i < max_attempts; ++i) {
 
             ++total_attempts;
 
             IOAddress candidate = allocator->pickAddress(subnet, ctx.duid_,
-                                                         hint);
+                                                         hint, i);
 
             /// In-pool reservations: Check if this address is reserved for someone
             /// else. There is no need to check for whom it is reserved, because if
@@ -1756,12 +2079,16 @@ AllocEngine::reclaimExpiredLeases6(const size_t max_leases, const uint16_t timeo
         callout_handle = HooksManager::createCalloutHandle();
     }
 
+    // The changes to the lease database are applied at the end of the
+    // pass for all reclaimed leases.
+    ReclaimedLeases<Lease6Ptr> reclaimed;
+
     size_t leases_processed = 0;
     BOOST_FOREACH(Lease6Ptr lease, leases) {
 
         try {
             // Reclaim the lease.
-            reclaimExpiredLease(lease, remove_lease, callout_handle);
+            reclaimExpiredLease(lease, remove_lease, callout_handle, &reclaimed);
             ++leases_processed;
 
         } catch (const std::exception& ex) {
@@ -1790,6 +2117,13 @@ AllocEngine::reclaimExpiredLeases6(const size_t max_leases, const uint16_t timeo
         }
     }
 
+    // Store the reclaimed leases in the lease database.
+    applyReclaimedLeases<Lease6Ptr>(reclaimed,
+                                    boost::bind(&LeaseMgr::updateLeases6,
+                                                &lease_mgr, _1),
+                                    boost::bind(&LeaseMgr::updateLease6,
+                                                &lease_mgr, _1));
+
     // Stop measuring the time.
     stopwatch.stop();
 
@@ -1896,12 +2230,16 @@ AllocEngine::reclaimExpiredLeases4(const size_t max_leases, const uint16_t timeo
         callout_handle = HooksManager::createCalloutHandle();
     }
 
+    // The changes to the lease database are applied at the end of the
+    // pass for all reclaimed leases.
+    ReclaimedLeases<Lease4Ptr> reclaimed;
+
     size_t leases_processed = 0;
     BOOST_FOREACH(Lease4Ptr lease, leases) {
 
         try {
             // Reclaim the lease.
-            reclaimExpiredLease(lease, remove_lease, callout_handle);
+            reclaimExpiredLease(lease, remove_lease, callout_handle, &reclaimed);
             ++leases_processed;
 
         } catch (const std::exception& ex) {
@@ -1930,6 +2268,13 @@ AllocEngine::reclaimExpiredLeases4(const size_t max_leases, const uint16_t timeo
         }
     }
 
+    // Store the reclaimed leases in the lease database.
+    applyReclaimedLeases<Lease4Ptr>(reclaimed,
+                                    boost::bind(&LeaseMgr::updateLeases4,
+                                                &lease_mgr, _1),
+                                    boost::bind(&LeaseMgr::updateLease4,
+                                                &lease_mgr, _1));
+
     // Stop measuring the time.
     stopwatch.stop();
 
@@ -1965,9 +2310,10 @@ AllocEngine::reclaimExpiredLeases4(const size_t max_leases, const uint16_t timeo
 template<typename LeasePtrType>
 void
 AllocEngine::reclaimExpiredLease(const LeasePtrType& lease, const bool remove_lease,
-                                 const CalloutHandlePtr& callout_handle) {
+                                 const CalloutHandlePtr& callout_handle,
+                                 ReclaimedLeases<LeasePtrType>* reclaimed) {
     reclaimExpiredLease(lease, remove_lease ? DB_RECLAIM_REMOVE : DB_RECLAIM_UPDATE,
-                        callout_handle);
+                        callout_handle, reclaimed);
 }
 
 template<typename LeasePtrType>
@@ -1985,7 +2331,8 @@ AllocEngine::reclaimExpiredLease(const LeasePtrType& lease,
 void
 AllocEngine::reclaimExpiredLease(const Lease6Ptr& lease,
                                  const DbReclaimMode& reclaim_mode,
-                                 const CalloutHandlePtr& callout_handle) {
+                                 const CalloutHandlePtr& callout_handle,
+                                 ReclaimedLeases<Lease6Ptr>* reclaimed) {
 
     LOG_DEBUG(alloc_engine_logger, ALLOC_ENGINE_DBG_TRACE,
               ALLOC_ENGINE_V6_LEASE_RECLAIM)
@@ -2012,38 +2359,74 @@ AllocEngine::reclaimExpiredLease(const Lease6Ptr& lease,
     /// @todo: Maybe add support for DROP status?
     /// Not sure if we need to support every possible status everywhere.
 
+    bool declined = false;
     if (!skipped) {
 
-        // Generate removal name change request for D2, if required.
-        // This will return immediately if the DNS wasn't updated
-        // when the lease was created.
-        queueNCR(CHG_REMOVE, lease);
-
         // Let's check if the lease that just expired is in DECLINED state.
-        // If it is, we need to perform a couple extra steps.
+        // If it is, we need to call the recover hook. There's no point in
+        // keeping a declined lease after its reclamation. A declined lease
+        // doesn't have any client identifying information anymore.  So
+        // we'll flag it for removal unless the hook has set the skip flag.
         bool remove_lease = (reclaim_mode == DB_RECLAIM_REMOVE);
         if (lease->state_ == Lease::STATE_DECLINED) {
-            // Do extra steps required for declined lease reclamation:
-            // - call the recover hook
-            // - bump decline-related stats
-            // - log separate message
-            // There's no point in keeping a declined lease after its
-            // reclamation. A declined lease doesn't have any client
-            // identifying information anymore.  So we'll flag it for
-            // removal unless the hook has set the skip flag.
             remove_lease = reclaimDeclined(lease);
+            declined = remove_lease;
         }
 
         if (reclaim_mode != DB_RECLAIM_LEAVE_UNCHANGED) {
+            // The FQDN information is cleared when the lease is stored, so
+            // keep a copy of the lease to generate the name change request
+            // once the lease has been stored.
+            Lease6Ptr old_lease(new Lease6(*lease));
+
             // Reclaim the lease - depending on the configuration, set the
             // expired-reclaimed state or simply remove it.
+            if (reclaimed) {
+                // Defer the change to the lease database. The reclamation
+                // is completed when the change has been applied.
+                reclaimLeaseInDatabase<Lease6Ptr>(lease, remove_lease,
+                                                  boost::bind(&ReclaimedLeases<Lease6Ptr>::update,
+                                                              reclaimed, _1,
+                                                              old_lease, declined),
+                                                  boost::bind(&ReclaimedLeases<Lease6Ptr>::remove,
+                                                              reclaimed, old_lease,
+                                                              declined));
+                return;
+            }
+
             LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
             reclaimLeaseInDatabase<Lease6Ptr>(lease, remove_lease,
                                               boost::bind(&LeaseMgr::updateLease6,
+                                                          &lease_mgr, _1),
+                                              boost::bind(&LeaseMgr::deleteLease,
                                                           &lease_mgr, _1));
+            completeReclamation(old_lease, false, declined);
+            return;
         }
     }
 
+    completeReclamation(lease, skipped, declined);
+}
+
+void
+AllocEngine::completeReclamation(const Lease6Ptr& lease, const bool skipped,
+                                 const bool declined) {
+    if (!skipped) {
+        // Generate removal name change request for D2, if required.
+        // This will return immediately if the DNS wasn't updated
+        // when the lease was created.
+        queueNCR(CHG_REMOVE, lease);
+
+        // Lease has been reclaimed.
+        LOG_DEBUG(alloc_engine_logger, ALLOC_ENGINE_DBG_TRACE,
+                  ALLOC_ENGINE_LEASE_RECLAIMED)
+            .arg(lease->addr_.toText());
+    }
+
+    if (declined) {
+        recoverDeclined(lease);
+    }
+
     // Update statistics.
 
     // Decrease number of assigned leases.
@@ -2076,7 +2459,8 @@ AllocEngine::reclaimExpiredLease(const Lease6Ptr& lease,
 void
 AllocEngine::reclaimExpiredLease(const Lease4Ptr& lease,
                                  const DbReclaimMode& reclaim_mode,
-                                 const CalloutHandlePtr& callout_handle) {
+                                 const CalloutHandlePtr& callout_handle,
+                                 ReclaimedLeases<Lease4Ptr>* reclaimed) {
 
     LOG_DEBUG(alloc_engine_logger, ALLOC_ENGINE_DBG_TRACE,
               ALLOC_ENGINE_V4_LEASE_RECLAIM)
@@ -2102,38 +2486,77 @@ AllocEngine::reclaimExpiredLease(const Lease4Ptr& lease,
     /// @todo: Maybe add support for DROP status?
     /// Not sure if we need to support every possible status everywhere.
 
+    bool declined = false;
     if (!skipped) {
 
-        // Generate removal name change request for D2, if required.
-        // This will return immediately if the DNS wasn't updated
-        // when the lease was created.
-        queueNCR(CHG_REMOVE, lease);
-
         // Let's check if the lease that just expired is in DECLINED state.
-        // If it is, we need to perform a couple extra steps.
+        // If it is, we need to call the recover hook. There's no point in
+        // keeping a declined lease after its reclamation. A declined lease
+        // doesn't have any client identifying information anymore.  So
+        // we'll flag it for removal unless the hook has set the skip flag.
         bool remove_lease = (reclaim_mode == DB_RECLAIM_REMOVE);
         if (lease->state_ == Lease::STATE_DECLINED) {
-            // Do extra steps required for declined lease reclamation:
-            // - call the recover hook
-            // - bump decline-related stats
-            // - log separate message
-            // There's no point in keeping a declined lease after its
-            // reclamation. A declined lease doesn't have any client
-            // identifying information anymore.  So we'll flag it for
-            // removal unless the hook has set the skip flag.
             remove_lease = reclaimDeclined(lease);
+            declined = remove_lease;
         }
 
         if (reclaim_mode != DB_RECLAIM_LEAVE_UNCHANGED) {
+            // The FQDN information is cleared when the lease is stored, so
+            // keep a copy of the lease to generate the name change request
+            // once the lease has been stored.
+            Lease4Ptr old_lease(new Lease4(*lease));
+
             // Reclaim the lease - depending on the configuration, set the
             // expired-reclaimed state or simply remove it.
+            if (reclaimed) {
+                // Defer the change to the lease database. The reclamation
+                // is completed when the change has been applied.
+                reclaimLeaseInDatabase<Lease4Ptr>(lease, remove_lease,
+                                                  boost::bind(&ReclaimedLeases<Lease4Ptr>::update,
+                                                              reclaimed, _1,
+                                                              old_lease, declined),
+                                                  boost::bind(&ReclaimedLeases<Lease4Ptr>::remove,
+                                                              reclaimed, old_lease,
+                                                              declined));
+                return;
+            }
+
             LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
             reclaimLeaseInDatabase<Lease4Ptr>(lease, remove_lease,
                                               boost::bind(&LeaseMgr::updateLease4,
+                                                          &lease_mgr, _1),
+                                              boost::bind(&LeaseMgr::deleteLease,
                                                           &lease_mgr, _1));
+            completeReclamation(old_lease, false, declined);
+            return;
         }
     }
 
+    completeReclamation(lease, skipped, declined);
+}
+
+void
+AllocEngine::completeReclamation(const Lease4Ptr& lease, const bool skipped,
+                                 const bool declined) {
+    if (!skipped) {
+        // Generate removal name change request for D2, if required.
+        // This will return immediately if the DNS wasn't updated
+        // when the lease was created.
+        queueNCR(CHG_REMOVE, lease);
+
+        // The address may be allocated again.
+        updatePoolUsage4(*lease, false);
+
+        // Lease has been reclaimed.
+        LOG_DEBUG(alloc_engine_logger, ALLOC_ENGINE_DBG_TRACE,
+                  ALLOC_ENGINE_LEASE_RECLAIMED)
+            .arg(lease->addr_.toText());
+    }
+
+    if (declined) {
+        recoverDeclined(lease);
+    }
+
     // Update statistics.
 
     // Decrease number of assigned addresses.
@@ -2152,6 +2575,15 @@ AllocEngine::reclaimExpiredLease(const Lease4Ptr& lease,
                                   int64_t(1));
 }
 
+void
+AllocEngine::updatePoolUsage4(const Lease4& lease, const bool used) {
+    Subnet4Ptr subnet = CfgMgr::instance().getCurrentCfg()->
+        getCfgSubnets4()->getSubnet(lease.subnet_id_);
+    if (subnet) {
+        markAddressUsed(subnet, lease.addr_, used);
+    }
+}
+
 void
 AllocEngine::deleteExpiredReclaimedLeases4(const uint32_t secs) {
     LOG_DEBUG(alloc_engine_logger, ALLOC_ENGINE_DBG_TRACE,
@@ -2209,6 +2641,11 @@ AllocEngine::reclaimDeclined(const Lease4Ptr& lease) {
         }
     }
 
+    return (true);
+}
+
+void
+AllocEngine::recoverDeclined(const Lease4Ptr& lease) {
     LOG_INFO(alloc_engine_logger, ALLOC_ENGINE_V4_DECLINED_RECOVERED)
         .arg(lease->addr_.toText())
         .arg(lease->valid_lft_);
@@ -2229,7 +2666,6 @@ AllocEngine::reclaimDeclined(const Lease4Ptr& lease) {
 
     // Note that we do not touch assigned-addresses counters. Those are
     // modified in whatever code calls this method.
-    return (true);
 }
 
 bool
@@ -2267,6 +2703,11 @@ AllocEngine::reclaimDeclined(const Lease6Ptr& lease) {
         }
     }
 
+    return (true);
+}
+
+void
+AllocEngine::recoverDeclined(const Lease6Ptr& lease) {
     LOG_INFO(alloc_engine_logger, ALLOC_ENGINE_V6_DECLINED_RECOVERED)
         .arg(lease->addr_.toText())
         .arg(lease->valid_lft_);
@@ -2287,8 +2728,6 @@ AllocEngine::reclaimDeclined(const Lease6Ptr& lease) {
 
     // Note that we do not touch assigned-addresses counters. Those are
     // modified in whatever code calls this method.
-
-    return (true);
 }
 
 
@@ -2296,14 +2735,14 @@ template<typename LeasePtrType>
 void AllocEngine::reclaimLeaseInDatabase(const LeasePtrType& lease,
                                          const bool remove_lease,
                                          const boost::function<void (const LeasePtrType&)>&
-                                         lease_update_fun) const {
-
-    LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
+                                         lease_update_fun,
+                                         const boost::function<void (const IOAddress&)>&
+                                         lease_remove_fun) const {
 
     // Reclaim the lease - depending on the configuration, set the
     // expired-reclaimed state or simply remove it.
     if (remove_lease) {
-        lease_mgr.deleteLease(lease->addr_);
+        lease_remove_fun(lease->addr_);
 
     } else if (!lease_update_fun.empty()) {
         // Clear FQDN information as we have already sent the
@@ -2313,15 +2752,74 @@ void AllocEngine::reclaimLeaseInDatabase(const LeasePtrType& lease,
         lease->fqdn_rev_ = false;
         lease->state_ = Lease::STATE_EXPIRED_RECLAIMED;
         lease_update_fun(lease);
+    }
+}
 
-    } else {
+template<typename LeasePtrType>
+void AllocEngine::applyReclaimedLeases(const ReclaimedLeases<LeasePtrType>& reclaimed,
+                                       const boost::function<void (const std::vector<LeasePtrType>&)>&
+                                       leases_update_fun,
+                                       const boost::function<void (const LeasePtrType&)>&
+                                       lease_update_fun) {
+    if (reclaimed.leases_.empty()) {
         return;
     }
 
-    // Lease has been reclaimed.
-    LOG_DEBUG(alloc_engine_logger, ALLOC_ENGINE_DBG_TRACE,
-              ALLOC_ENGINE_LEASE_RECLAIMED)
-        .arg(lease->addr_.toText());
+    std::vector<LeasePtrType> updated;
+    std::vector<IOAddress> removed;
+    BOOST_FOREACH(const typename ReclaimedLeases<LeasePtrType>::Entry& entry,
+                  reclaimed.leases_) {
+        if (entry.remove_) {
+            removed.push_back(entry.lease_->addr_);
+        } else {
+            updated.push_back(entry.lease_);
+        }
+    }
+
+    LeaseMgr& lease_mgr = LeaseMgrFactory::instance();
+
+    bool stored = false;
+    try {
+        if (!updated.empty()) {
+            leases_update_fun(updated);
+        }
+        if (!removed.empty()) {
+            lease_mgr.deleteLeases(removed);
+        }
+        stored = true;
+
+    } catch (const std::exception& ex) {
+        LOG_WARN(alloc_engine_logger, ALLOC_ENGINE_RECLAIMED_LEASES_BULK_FAILED)
+            .arg(reclaimed.leases_.size())
+            .arg(ex.what());
+    }
+
+    BOOST_FOREACH(const typename ReclaimedLeases<LeasePtrType>::Entry& entry,
+                  reclaimed.leases_) {
+        // If the bulk operation failed, store the leases one by one, so
+        // as the failing lease doesn't affect the others. The leases
+        // which have been already stored by the bulk operation are stored
+        // again with no effect.
+        if (!stored) {
+            try {
+                if (entry.remove_) {
+                    lease_mgr.deleteLease(entry.lease_->addr_);
+                } else {
+                    lease_update_fun(entry.lease_);
+                }
+
+            } catch (const std::exception& ex) {
+                LOG_ERROR(alloc_engine_logger, ALLOC_ENGINE_RECLAIMED_LEASE_STORE_FAILED)
+                    .arg(entry.lease_->addr_.toText())
+                    .arg(ex.what());
+                continue;
+            }
+        }
+
+        // The lease has been stored, so the statistics can be updated
+        // and the name change request sent.
+        completeReclamation(entry.old_lease_, false, entry.declined_);
+    }
 }
 
 
@@ -2600,9 +3098,9 @@ AllocEngine::allocateLease4(ClientContext4& ctx) {
 
 void
 AllocEngine::findReservation(ClientContext4& ctx) {
-    findReservationInternal(ctx, boost::bind(&HostMgr::get4,
+    findReservationInternal(ctx, boost::bind(&HostMgr::getByIdentifiers4,
                                              &HostMgr::instance(),
-                                             _1, _2, _3, _4));
+                                             _1, _2));
 }
 
 Lease4Ptr
@@ -2965,6 +3463,7 @@ AllocEngine::createLease4(const ClientContext4& ctx, const IOAddress& addr) {
         // That is a real (REQUEST) allocation
         bool status = LeaseMgrFactory::instance().addLease(lease);
         if (status) {
+            markAddressUsed(ctx.subnet_, lease->addr_, true);
 
             // The lease insertion succeeded, let's bump up the statistic.
             StatsMgr::instance().addValue(
@@ -3165,6 +3664,7 @@ AllocEngine::reuseExpiredLease4(Lease4Ptr& expired,
     if (!ctx.fake_allocation_) {
         // for REQUEST we do update the lease
         LeaseMgrFactory::instance().updateLease4(expired);
+        markAddressUsed(ctx.subnet_, expired->addr_, true);
 
         // We need to account for the re-assignment of The lease.
         StatsMgr::instance().addValue(
@@ -3195,6 +3695,10 @@ AllocEngine::allocateOrReuseLease4(const IOAddress& candidate, ClientContext4& c
             // to the caller in the context. The caller may need to know
             // which lease we're conflicting with.
             ctx.conflicting_lease_ = exist_lease;
+
+            // The lease may have been added by another server sharing the
+            // lease database, so make sure this address is not picked again.
+            markAddressUsed(ctx.subnet_, candidate, true);
         }
 
     } else {
@@ -3206,7 +3710,6 @@ AllocEngine::allocateOrReuseLease4(const IOAddress& candidate, ClientContext4& c
 Lease4Ptr
 AllocEngine::allocateUnreservedLease4(ClientContext4& ctx) {
     Lease4Ptr new_lease;
-    AllocatorPtr allocator = getAllocator(Lease::TYPE_V4);
     Subnet4Ptr subnet = ctx.subnet_;
     Subnet4Ptr original_subnet = subnet;
     SharedNetwork4Ptr network;
@@ -3219,13 +3722,30 @@ AllocEngine::allocateUnreservedLease4(ClientContext4& ctx) {
             client_id = ctx.clientid_;
         }
 
+        // The client identifier is used by the allocators to select the
+        // candidate addresses for the client. If it is not used, the
+        // HW address is used instead.
+        if (!client_id && ctx.hwaddr_ &&
+            (ctx.hwaddr_->hwaddr_.size() >= ClientId::MIN_CLIENT_ID_LEN) &&
+            (ctx.hwaddr_->hwaddr_.size() <= ClientId::MAX_CLIENT_ID_LEN)) {
+            client_id.reset(new ClientId(ctx.hwaddr_->hwaddr_));
+        }
+
+        // The allocator may be configured for the subnet.
+        AllocatorPtr allocator = getAllocator(Lease::TYPE_V4, subnet);
+
         const uint64_t max_attempts = (attempts_ > 0 ? attempts_ :
                                        subnet->getPoolCapacity(Lease::TYPE_V4));
         for (uint64_t i = 0; i < max_attempts; ++i) {
             IOAddress candidate = allocator->pickAddress(subnet, client_id,
-                                                         ctx.requested_address_);
+                                                         ctx.requested_address_,
+                                                         i);
             // If address is not reserved for another client, try to allocate it.
-            if (!addressReserved(candidate, ctx)) {
+            if (addressReserved(candidate, ctx)) {
+                // Don't pick the reserved address again.
+                markAddressUsed(subnet, candidate, true);
+
+            } else {
                 // The call below will return the non-NULL pointer if we
                 // successfully allocate this lease. This means that the
                 // address is not in use by another client.
@@ -13,14 +13,17 @@
 #include <dhcp/pkt4.h>
 #include <dhcp/pkt6.h>
 #include <dhcp/option6_ia.h>
+#include <dhcpsrv/base_host_data_source.h>
 #include <dhcpsrv/host.h>
 #include <dhcpsrv/subnet.h>
 #include <dhcpsrv/lease_mgr.h>
 #include <hooks/callout_handle.h>
+#include <util/threads/sync.h>
 
 #include <boost/function.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include <list>
 #include <map>
@@ -78,30 +81,115 @@ protected:
         /// than pickResource(), because nobody would immediately know what the
         /// resource means in this context.
         ///
+        /// The allocators are shared by the threads processing packets in
+        /// the multi-threading mode, so this method serializes the picks
+        /// and calls @ref pickAddressInternal implemented by the derived
+        /// classes. The allocators don't keep any per client state: the
+        /// allocation engine passes the number of the candidates it has
+        /// already rejected for the client in the current allocation.
+        ///
         /// @param subnet next address will be returned from pool of that subnet
         /// @param duid Client's DUID
         /// @param hint client's hint
+        /// @param attempt Number of the candidates rejected for the client
+        /// in the current allocation (0 for the first pick).
         ///
         /// @return the next address
-        virtual isc::asiolink::IOAddress
+        isc::asiolink::IOAddress
         pickAddress(const SubnetPtr& subnet, const DuidPtr& duid,
-                    const isc::asiolink::IOAddress& hint) = 0;
+                    const isc::asiolink::IOAddress& hint,
+                    const uint64_t attempt = 0);
 
         /// @brief Default constructor.
         ///
         /// Specifies which type of leases this allocator will assign
         /// @param pool_type specifies pool type (addresses, temp. addr or prefixes)
-        Allocator(Lease::Type pool_type)
-            :pool_type_(pool_type) {
-        }
+        Allocator(Lease::Type pool_type);
 
         /// @brief virtual destructor
         virtual ~Allocator() {
         }
     protected:
 
+        /// @brief picks one address out of available pools in a given subnet
+        ///
+        /// It is called by @ref pickAddress with the allocator's mutex
+        /// locked in the multi-threading mode.
+        ///
+        /// @param subnet next address will be returned from pool of that subnet
+        /// @param duid Client's DUID
+        /// @param hint client's hint
+        /// @param attempt Number of the candidates rejected for the client
+        /// in the current allocation.
+        ///
+        /// @return the next address
+        virtual isc::asiolink::IOAddress
+        pickAddressInternal(const SubnetPtr& subnet, const DuidPtr& duid,
+                            const isc::asiolink::IOAddress& hint,
+                            const uint64_t attempt) = 0;
+
+        /// @brief Creates and populates usage bitmaps for subnet's pools.
+        ///
+        /// @param subnet Subnet which pools' bitmaps should be created.
+        /// @return true if the bitmaps are available for all pools of the
+        /// subnet, false otherwise.
+        bool populateUsageBitmaps(const SubnetPtr& subnet);
+
+        /// @brief Returns the address at the specified offset in the pools.
+        ///
+        /// The pools of the subnet are treated as one contiguous range of
+        /// addresses (or prefixes) and the offset is the position within
+        /// this range, i.e. offset 0 is the first address of the first pool
+        /// and the offset equal to the capacity of the first pool is the
+        /// first address of the second pool.
+        ///
+        /// @param subnet Subnet holding the pools.
+        /// @param offset Offset within the pools. It must be lower than the
+        /// total capacity of the pools.
+        /// @return Address (or prefix) at the specified offset.
+        isc::asiolink::IOAddress
+        getAddressAtOffset(const SubnetPtr& subnet, uint64_t offset) const;
+
+        /// @brief Returns an address picked starting at the specified offset.
+        ///
+        /// This is the common implementation of the random and hashed
+        /// allocators, which differ only in how the first candidate offset
+        /// is selected. The allocation engine calls the allocator repeatedly
+        /// for the same client until a free address is found. The first
+        /// attempt uses the supplied offset and the subsequent attempts
+        /// continue with the following offsets, wrapping at the end of the
+        /// last pool. Hence, the cost of each pick is constant and all
+        /// addresses are visited within the number of attempts equal to the
+        /// capacity of the pools.
+        ///
+        /// For IPv4, the pools' usage bitmaps are used (if available) to
+        /// skip over the leased addresses, so the free address is usually
+        /// returned in the first attempt regardless of the pools' usage.
+        /// The engine marks the rejected candidates as used, so they are
+        /// skipped in the subsequent attempts.
+        ///
+        /// @param subnet Subnet from which the address should be picked.
+        /// @param offset Offset of the candidate picked in the first attempt.
+        /// @param attempt Number of the candidates rejected for the client
+        /// in the current allocation.
+        /// @return Picked address.
+        isc::asiolink::IOAddress
+        pickAddressFromOffset(const SubnetPtr& subnet, const uint64_t offset,
+                              const uint64_t attempt);
+
         /// @brief defines pool type allocation
         Lease::Type pool_type_;
+
+        /// @brief Indicates if the usage bitmaps should be used.
+        ///
+        /// This is set to false when the lease backend doesn't support
+        /// retrieving leases by subnet identifier.
+        bool use_usage_bitmaps_;
+
+    private:
+
+        /// @brief Mutex serializing the picks in the multi-threading mode.
+        boost::scoped_ptr<isc::util::thread::Mutex> mutex_;
     };
 
     /// defines a pointer to allocator
@@ -122,17 +210,20 @@ protected:
         /// @param type - specifies allocation type
         IterativeAllocator(Lease::Type type);
 
+    protected:
+
         /// @brief returns the next address from pools in a subnet
         ///
         /// @param subnet next address will be returned from pool of that subnet
         /// @param duid Client's DUID (ignored)
         /// @param hint client's hint (ignored)
+        /// @param attempt number of the rejected candidates (ignored)
         /// @return the next address
         virtual isc::asiolink::IOAddress
-            pickAddress(const SubnetPtr& subnet,
-                        const DuidPtr& duid,
-                        const isc::asiolink::IOAddress& hint);
-    protected:
+            pickAddressInternal(const SubnetPtr& subnet,
+                                const DuidPtr& duid,
+                                const isc::asiolink::IOAddress& hint,
+                                const uint64_t attempt);
 
         /// @brief Returns the next prefix
         ///
@@ -147,11 +238,32 @@ protected:
         static isc::asiolink::IOAddress
         increasePrefix(const isc::asiolink::IOAddress& prefix,
                        const uint8_t prefix_len);
+
+        /// @brief Returns the next free IPv4 address using pools' bitmaps.
+        ///
+        /// This method walks over the usage bitmaps of the subnet's pools
+        /// (see @ref Pool4::getUsageBitmap), starting after the last
+        /// allocated address, and returns the first address for which
+        /// there is no lease in the lease database. The bitmaps are
+        /// created and populated on first use.
+        ///
+        /// @param subnet Subnet from which the address should be picked.
+        /// @param [out] address Free address found.
+        /// @return true if the free address has been found, false if all
+        /// addresses in the pools are used or the bitmaps can't be used
+        /// for this subnet. In the latter case, the caller should fall
+        /// back to probing the lease database for each candidate.
+        bool pickFreeAddress4(const SubnetPtr& subnet,
+                              isc::asiolink::IOAddress& address);
     };
 
     /// @brief Address/prefix allocator that gets an address based on a hash
     ///
-    /// @todo: This is a skeleton class for now and is missing an implementation.
+    /// This allocator computes the hash of the client's DUID (or client
+    /// identifier) and uses it to select the first candidate address from
+    /// the pools. Returning clients are likely to get the same address
+    /// as long as the pools' configuration doesn't change. If there is no
+    /// client identifier, the first candidate is selected randomly.
     class HashedAllocator : public Allocator {
     public:
 
@@ -159,40 +271,57 @@ protected:
         /// @param type - specifies allocation type
         HashedAllocator(Lease::Type type);
 
+    protected:
+
         /// @brief returns an address based on hash calculated from client's DUID.
         ///
-        /// @todo: Implement this method
-        ///
         /// @param subnet an address will be picked from pool of that subnet
         /// @param duid Client's DUID
-        /// @param hint a hint (last address that was picked)
+        /// @param hint a hint (ignored)
+        /// @param attempt number of the candidates rejected for the client
         /// @return selected address
-        virtual isc::asiolink::IOAddress pickAddress(const SubnetPtr& subnet,
-                                                     const DuidPtr& duid,
-                                                     const isc::asiolink::IOAddress& hint);
+        virtual isc::asiolink::IOAddress
+        pickAddressInternal(const SubnetPtr& subnet, const DuidPtr& duid,
+                            const isc::asiolink::IOAddress& hint,
+                            const uint64_t attempt);
     };
 
     /// @brief Random allocator that picks address randomly
     ///
-    /// @todo: This is a skeleton class for now and is missing an implementation.
+    /// This allocator selects the first candidate address for a client
+    /// randomly, so the addresses allocated by several servers sharing
+    /// the same lease database are unlikely to collide. The client
+    /// identifier is hashed with a random seed selected when the allocator
+    /// is created, so the client retransmitting its message gets the same
+    /// candidate from this allocator. If there is no client identifier,
+    /// each first candidate is selected randomly.
     class RandomAllocator : public Allocator {
     public:
 
-        /// @brief default constructor (does nothing)
+        /// @brief constructor
+        ///
+        /// Selects the random seed.
         /// @param type - specifies allocation type
         RandomAllocator(Lease::Type type);
 
+    protected:
+
         /// @brief returns a random address from pool of specified subnet
         ///
-        /// @todo: Implement this method
-        ///
         /// @param subnet an address will be picked from pool of that subnet
-        /// @param duid Client's DUID (ignored)
+        /// @param duid Client's DUID
         /// @param hint the last address that was picked (ignored)
+        /// @param attempt number of the candidates rejected for the client
         /// @return a random address from the pool
         virtual isc::asiolink::IOAddress
-        pickAddress(const SubnetPtr& subnet, const DuidPtr& duid,
-                    const isc::asiolink::IOAddress& hint);
+        pickAddressInternal(const SubnetPtr& subnet, const DuidPtr& duid,
+                            const isc::asiolink::IOAddress& hint,
+                            const uint64_t attempt);
+
+    private:
+
+        /// @brief Random seed hashed with the client identifiers.
+        uint64_t seed_;
     };
 
 public:
@@ -227,14 +356,45 @@ public:
     /// @return pointer to allocator handling a given resource types
     AllocatorPtr getAllocator(Lease::Type type);
 
+    /// @brief Returns allocator for a given pool type and subnet
+    ///
+    /// If the subnet specifies an allocator (see
+    /// @ref Subnet::getAllocatorType), the allocator of this kind is
+    /// returned. It is created on first use. Otherwise, the allocator
+    /// selected when the engine was created is returned.
+    ///
+    /// @param type type of pool (V4, IA, TA or PD)
+    /// @param subnet subnet from which the lease is allocated
+    /// @throw BadValue if allocator for a given type is missing
+    /// @return pointer to allocator handling a given resource types
+    AllocatorPtr getAllocator(Lease::Type type, const SubnetPtr& subnet);
+
 private:
 
+    /// @brief Creates an allocator of the specified kind.
+    ///
+    /// @param alloc_type Kind of the allocator.
+    /// @param type type of pool (V4, IA, TA or PD)
+    /// @throw BadValue if the allocator kind is invalid
+    /// @return pointer to the new allocator
+    static AllocatorPtr createAllocator(AllocType alloc_type, Lease::Type type);
+
     /// @brief a pointer to currently used allocator
     ///
     /// For IPv4, there will be only one allocator: TYPE_V4
     /// For IPv6, there will be 3 allocators: TYPE_NA, TYPE_TA, TYPE_PD
     std::map<Lease::Type, AllocatorPtr> allocators_;
 
+    /// @brief Allocators selected explicitly for subnets
+    ///
+    /// These allocators are created on first use and are indexed by the
+    /// allocator kind and the pool type.
+    std::map<std::pair<AllocType, Lease::Type>, AllocatorPtr> subnet_allocators_;
+
+    /// @brief Mutex protecting the subnet specific allocators in the
+    /// multi-threading mode.
+    boost::scoped_ptr<isc::util::thread::Mutex> subnet_allocators_mutex_;
+
     /// @brief number of attempts before we give up lease allocation (0=unlimited)
     uint64_t attempts_;
 
@@ -258,10 +418,10 @@ public:
     typedef std::set<ResourceType> ResourceContainer;
 
     /// @brief A tuple holding host identifier type and value.
-    typedef std::pair<Host::IdentifierType, std::vector<uint8_t> > IdentifierPair;
+    typedef HostIdentifier IdentifierPair;
 
     /// @brief Map holding values to be used as host identifiers.
-    typedef std::list<IdentifierPair> IdentifierList;
+    typedef HostIdentifierList IdentifierList;
 
     /// @brief Context information for the DHCPv6 leases allocation.
     ///
@@ -719,10 +879,10 @@ public:
 private:
 
     /// @brief Type of the function used by @ref findReservationInternal to
-    /// retrieve reservations by subnet identifier and host identifier.
-    typedef boost::function<ConstHostPtr(const SubnetID&,
-                                         const Host::IdentifierType&,
-                                         const uint8_t*, const size_t)> HostGetFunc;
+    /// retrieve reservations by subnet identifier and host identifiers.
+    typedef boost::function<ConstHostCollection(const SubnetID&,
+                                                const HostIdentifierList&)>
+    HostGetFunc;
 
     /// @brief Common function for searching host reservations.
     ///
@@ -731,7 +891,7 @@ private:
     ///
     /// @param ctx Reference to a @ref ClientContext6 or @ref ClientContext4.
     /// @param host_get Pointer to the @ref HostMgr functions to be used
-    /// to retrieve reservation by subnet identifier and host identifier.
+    /// to retrieve reservations by subnet identifier and host identifiers.
     /// @param ipv6_only Boolean value indicating if only IPv6 reservations
     /// should be retrieved.
     /// @tparam ContextType Either @ref ClientContext6 or @ref ClientContext4.
@@ -919,6 +1079,67 @@ private:
         DB_RECLAIM_LEAVE_UNCHANGED
     };
 
+    /// @brief Lease database changes collected by the leases reclamation.
+    ///
+    /// The leases reclamation routine collects the changes to the lease
+    /// database made for the reclaimed leases and applies them at the end
+    /// of the pass with the bulk @c LeaseMgr methods, rather than making
+    /// a round trip to the database for each lease.
+    ///
+    /// @tparam LeasePtrType One of the @c Lease6Ptr or @c Lease4Ptr.
+    template<typename LeasePtrType>
+    struct ReclaimedLeases {
+
+        /// @brief Change to the lease database for a reclaimed lease.
+        struct Entry {
+
+            /// @brief Constructor.
+            ///
+            /// @param lease Pointer to the lease to be stored.
+            /// @param old_lease Pointer to the lease before reclamation.
+            /// @param remove Indicates if the lease is to be removed.
+            /// @param declined Indicates if the declined lease is recovered.
+            Entry(const LeasePtrType& lease, const LeasePtrType& old_lease,
+                  const bool remove, const bool declined)
+                : lease_(lease), old_lease_(old_lease), remove_(remove),
+                  declined_(declined) {
+            }
+
+            /// @brief Lease to be updated or removed.
+            LeasePtrType lease_;
+
+            /// @brief Lease before reclamation, used to complete it.
+            LeasePtrType old_lease_;
+
+            /// @brief Indicates if the lease is removed (if true) or updated.
+            bool remove_;
+
+            /// @brief Indicates if the declined lease is recovered.
+            bool declined_;
+        };
+
+        /// @brief Records the lease to be updated.
+        ///
+        /// @param lease Pointer to the reclaimed lease.
+        /// @param old_lease Pointer to the lease before reclamation.
+        /// @param declined Indicates if the declined lease is recovered.
+        void update(const LeasePtrType& lease, const LeasePtrType& old_lease,
+                    const bool declined) {
+            leases_.push_back(Entry(lease, old_lease, false, declined));
+        }
+
+        /// @brief Records the lease to be removed.
+        ///
+        /// @param lease Pointer to the lease before reclamation.
+        /// @param declined Indicates if the declined lease is recovered.
+        void remove(const LeasePtrType& lease, const bool declined) {
+            leases_.push_back(Entry(lease, lease, true, declined));
+        }
+
+        /// @brief Changes to be applied to the lease database.
+        std::vector<Entry> leases_;
+    };
+
     /// @brief Reclaim DHCPv4 or DHCPv6 lease with updating lease database.
     ///
     /// This method is called by the lease reclamation routine to reclaim the
@@ -929,11 +1150,15 @@ private:
     /// @param remove_lease A boolean flag indicating if the lease should be
     /// removed from the lease database (if true) upon reclamation.
     /// @param callout_handle Pointer to the callout handle.
+    /// @param reclaimed Pointer to the object collecting the changes to
+    /// the lease database. If null, the lease database is updated
+    /// immediately.
     /// @tparam LeasePtrPtr Lease type, i.e. @c Lease4Ptr or @c Lease6Ptr.
     template<typename LeasePtrType>
     void reclaimExpiredLease(const LeasePtrType& lease,
                              const bool remove_lease,
-                             const hooks::CalloutHandlePtr& callout_handle);
+                             const hooks::CalloutHandlePtr& callout_handle,
+                             ReclaimedLeases<LeasePtrType>* reclaimed = 0);
 
     /// @brief Reclaim DHCPv4 or DHCPv6 lease without updating lease database.
     ///
@@ -959,9 +1184,13 @@ private:
     /// @param reclaim_mode Indicates what the method should do with the reclaimed
     /// lease in the lease database.
     /// @param callout_handle Pointer to the callout handle.
+    /// @param reclaimed Pointer to the object collecting the changes to
+    /// the lease database. If null, the lease database is updated
+    /// immediately.
     void reclaimExpiredLease(const Lease6Ptr& lease,
                              const DbReclaimMode& reclaim_mode,
-                             const hooks::CalloutHandlePtr& callout_handle);
+                             const hooks::CalloutHandlePtr& callout_handle,
+                             ReclaimedLeases<Lease6Ptr>* reclaimed = 0);
 
     /// @brief Reclaim DHCPv4 lease.
     ///
@@ -973,9 +1202,41 @@ private:
     /// @param reclaim_mode Indicates what the method should do with the reclaimed
     /// lease in the lease database.
     /// @param callout_handle Pointer to the callout handle.
+    /// @param reclaimed Pointer to the object collecting the changes to
+    /// the lease database. If null, the lease database is updated
+    /// immediately.
     void reclaimExpiredLease(const Lease4Ptr& lease,
                              const DbReclaimMode& reclaim_mode,
-                             const hooks::CalloutHandlePtr& callout_handle);
+                             const hooks::CalloutHandlePtr& callout_handle,
+                             ReclaimedLeases<Lease4Ptr>* reclaimed = 0);
+
+    /// @brief Completes the reclamation of the DHCPv6 lease.
+    ///
+    /// This method is called when the reclaimed lease has been stored in
+    /// the lease database, so as the statistics and the DNS aren't updated
+    /// for a lease which failed to be stored. It sends the name change
+    /// request removing the DNS entries and updates the statistics.
+    ///
+    /// @param lease Pointer to the DHCPv6 lease before reclamation.
+    /// @param skipped Indicates if the callouts have taken responsibility
+    /// for reclaiming the lease.
+    /// @param declined Indicates if the declined lease has been recovered.
+    void completeReclamation(const Lease6Ptr& lease, const bool skipped,
+                             const bool declined);
+
+    /// @brief Completes the reclamation of the DHCPv4 lease.
+    ///
+    /// This method is called when the reclaimed lease has been stored in
+    /// the lease database. It sends the name change request removing the
+    /// DNS entries, marks the address as free in the pool's usage bitmap
+    /// and updates the statistics.
+    ///
+    /// @param lease Pointer to the DHCPv4 lease before reclamation.
+    /// @param skipped Indicates if the callouts have taken responsibility
+    /// for reclaiming the lease.
+    /// @param declined Indicates if the declined lease has been recovered.
+    void completeReclamation(const Lease4Ptr& lease, const bool skipped,
+                             const bool declined);
 
     /// @brief Marks lease as reclaimed in the database.
     ///
@@ -993,40 +1254,82 @@ private:
     /// removed from the database (if true).
     /// @param lease_update_fun Pointer to the function in the @c LeaseMgr to
     /// be used to update the lease if the @c remove_lease is set to false.
+    /// @param lease_remove_fun Pointer to the function to be used to remove
+    /// the lease if the @c remove_lease is set to true.
     ///
     /// @tparam LeasePtrType One of the @c Lease6Ptr or @c Lease4Ptr.
     template<typename LeasePtrType>
     void reclaimLeaseInDatabase(const LeasePtrType& lease,
                                 const bool remove_lease,
                                 const boost::function<void (const LeasePtrType&)>&
-                                lease_update_fun) const;
+                                lease_update_fun,
+                                const boost::function<void (const asiolink::IOAddress&)>&
+                                lease_remove_fun) const;
+
+    /// @brief Applies the changes collected by the leases reclamation.
+    ///
+    /// The leases are updated and removed with the bulk @c LeaseMgr
+    /// methods. If the bulk operation fails, the changes are applied
+    /// lease by lease, so as a single failing lease doesn't prevent
+    /// storing the others. The lease which can't be stored remains
+    /// expired in the database and is reclaimed again in the next pass.
+    /// The reclamation of the stored leases is completed with
+    /// @c completeReclamation.
+    ///
+    /// @param reclaimed Changes collected by the leases reclamation.
+    /// @param leases_update_fun Pointer to the function in the @c LeaseMgr
+    /// to be used to update multiple leases.
+    /// @param lease_update_fun Pointer to the function in the @c LeaseMgr
+    /// to be used to update a single lease.
+    ///
+    /// @tparam LeasePtrType One of the @c Lease6Ptr or @c Lease4Ptr.
+    template<typename LeasePtrType>
+    void applyReclaimedLeases(const ReclaimedLeases<LeasePtrType>& reclaimed,
+                              const boost::function<void (const std::vector<LeasePtrType>&)>&
+                              leases_update_fun,
+                              const boost::function<void (const LeasePtrType&)>&
+                              lease_update_fun);
 
     /// @anchor reclaimDeclinedLease4
     /// @brief Conducts steps necessary for reclaiming declined IPv4 lease.
     ///
-    /// These are the additional steps required when recovering a declined lease:
-    /// - bump decline recovered stat
-    /// - log lease recovery
-    /// - call lease4_recover hook
+    /// This method calls the lease4_recover hook. The remaining steps are
+    /// conducted by @c recoverDeclined when the lease has been stored.
     ///
     /// @param lease Lease to be reclaimed from Declined state
     /// @return true if it's ok to remove the lease (false = hooks status says
     ///         to keep it)
     bool reclaimDeclined(const Lease4Ptr& lease);
 
-    /// @anchor reclaimDeclinedLease6
-    /// @brief Conducts steps necessary for reclaiming declined IPv6 lease.
+    /// @brief Conducts steps necessary for recovering declined IPv4 lease.
     ///
     /// These are the additional steps required when recovering a declined lease:
     /// - bump decline recovered stat
     /// - log lease recovery
-    /// - call lease6_recover hook
+    ///
+    /// @param lease Lease recovered from Declined state
+    void recoverDeclined(const Lease4Ptr& lease);
+
+    /// @anchor reclaimDeclinedLease6
+    /// @brief Conducts steps necessary for reclaiming declined IPv6 lease.
+    ///
+    /// This method calls the lease6_recover hook. The remaining steps are
+    /// conducted by @c recoverDeclined when the lease has been stored.
     ///
     /// @param lease Lease to be reclaimed from Declined state
     /// @return true if it's ok to remove the lease (false = hooks status says
     ///         to keep it)
     bool reclaimDeclined(const Lease6Ptr& lease);
 
+    /// @brief Conducts steps necessary for recovering declined IPv6 lease.
+    ///
+    /// These are the additional steps required when recovering a declined lease:
+    /// - bump decline recovered stat
+    /// - log lease recovery
+    ///
+    /// @param lease Lease recovered from Declined state
+    void recoverDeclined(const Lease6Ptr& lease);
+
 public:
 
     /// @brief Context information for the DHCPv4 lease allocation.
@@ -1271,6 +1574,18 @@ public:
     /// @param ctx Client context holding various information about the client.
     static void findReservation(ClientContext4& ctx);
 
+    /// @brief Updates the usage bitmap of the pool an IPv4 lease belongs to.
+    ///
+    /// The usage bitmaps (see @ref Pool4::getUsageBitmap) are maintained
+    /// by the allocation engine as it allocates, reuses and reclaims the
+    /// leases. This method must be called for the leases removed from the
+    /// lease database by other means, e.g. released by the clients.
+    ///
+    /// @param lease Lease which has been added or removed.
+    /// @param used Boolean value indicating if the lease has been added
+    /// (if true) or removed (if false).
+    static void updatePoolUsage4(const Lease4& lease, const bool used);
+
 private:
 
     /// @brief Offers the lease.
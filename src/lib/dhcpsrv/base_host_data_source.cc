@@ -0,0 +1,65 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+#include <dhcpsrv/base_host_data_source.h>
+#include <boost/foreach.hpp>
+
+namespace isc {
+namespace dhcp {
+
+ConstHostCollection
+BaseHostDataSource::getByIdentifiers4(const SubnetID& subnet_id,
+                                      const HostIdentifierList& identifiers) const {
+    ConstHostCollection hosts;
+    BOOST_FOREACH(const HostIdentifier& id, identifiers) {
+        if (id.second.empty()) {
+            continue;
+        }
+        ConstHostPtr host = get4(subnet_id, id.first, &id.second[0],
+                                 id.second.size());
+        if (host) {
+            hosts.push_back(host);
+        }
+    }
+    return (hosts);
+}
+
+ConstHostCollection
+BaseHostDataSource::getByIdentifiers6(const SubnetID& subnet_id,
+                                      const HostIdentifierList& identifiers) const {
+    ConstHostCollection hosts;
+    BOOST_FOREACH(const HostIdentifier& id, identifiers) {
+        if (id.second.empty()) {
+            continue;
+        }
+        ConstHostPtr host = get6(subnet_id, id.first, &id.second[0],
+                                 id.second.size());
+        if (host) {
+            hosts.push_back(host);
+        }
+    }
+    return (hosts);
+}
+
+ConstHostCollection
+BaseHostDataSource::sortByIdentifiers(const ConstHostCollection& hosts,
+                                      const HostIdentifierList& identifiers) {
+    ConstHostCollection sorted;
+    BOOST_FOREACH(const HostIdentifier& id, identifiers) {
+        BOOST_FOREACH(const ConstHostPtr& host, hosts) {
+            if ((host->getIdentifierType() == id.first) &&
+                (host->getIdentifier() == id.second)) {
+                sorted.push_back(host);
+                break;
+            }
+        }
+    }
+    return (sorted);
+}
+
+}
+}
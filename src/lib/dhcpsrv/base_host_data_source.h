@@ -13,6 +13,9 @@
 #include <dhcpsrv/host.h>
 #include <exceptions/exceptions.h>
 #include <boost/shared_ptr.hpp>
+#include <list>
+#include <utility>
+#include <vector>
 
 namespace isc {
 namespace dhcp {
@@ -40,6 +43,12 @@ public:
         isc::BadValue(file, line, what) { };
 };
 
+/// @brief Host identifier type and value.
+typedef std::pair<Host::IdentifierType, std::vector<uint8_t> > HostIdentifier;
+
+/// @brief List of host identifiers ordered by their priority.
+typedef std::list<HostIdentifier> HostIdentifierList;
+
 /// @brief Base interface for the classes implementing simple data source
 /// for host reservations.
 ///
@@ -182,6 +191,25 @@ public:
     get4(const SubnetID& subnet_id,
          const asiolink::IOAddress& address) const = 0;
 
+    /// @brief Returns hosts connected to the IPv4 subnet using any of the
+    /// specified identifiers.
+    ///
+    /// The server uses several identifiers of the client to search for its
+    /// reservation, e.g. the HW address and the client identifier. This
+    /// method returns the hosts for all of them, so the data sources can
+    /// retrieve them using a single query. The default implementation
+    /// calls @c get4 for each identifier.
+    ///
+    /// @param subnet_id Subnet identifier.
+    /// @param identifiers Identifiers of the client ordered by priority.
+    ///
+    /// @return Collection of const @c Host objects ordered by the priority
+    /// of the identifiers used to find them. It holds at most one host for
+    /// each identifier.
+    virtual ConstHostCollection
+    getByIdentifiers4(const SubnetID& subnet_id,
+                      const HostIdentifierList& identifiers) const;
+
     /// @brief Returns a host connected to the IPv6 subnet.
     ///
     /// Implementations of this method should guard against the case when
@@ -216,6 +244,22 @@ public:
          const uint8_t* identifier_begin,
          const size_t identifier_len) const = 0;
 
+    /// @brief Returns hosts connected to the IPv6 subnet using any of the
+    /// specified identifiers.
+    ///
+    /// This is the IPv6 counterpart of @c getByIdentifiers4. The default
+    /// implementation calls @c get6 for each identifier.
+    ///
+    /// @param subnet_id Subnet identifier.
+    /// @param identifiers Identifiers of the client ordered by priority.
+    ///
+    /// @return Collection of const @c Host objects ordered by the priority
+    /// of the identifiers used to find them. It holds at most one host for
+    /// each identifier.
+    virtual ConstHostCollection
+    getByIdentifiers6(const SubnetID& subnet_id,
+                      const HostIdentifierList& identifiers) const;
+
     /// @brief Returns a host using the specified IPv6 prefix.
     ///
     /// @param prefix IPv6 prefix for which the @c Host object is searched.
@@ -305,6 +349,20 @@ public:
     /// Rolls back all pending database operations.  On databases that don't
     /// support transactions, this is a no-op.
     virtual void rollback() {};
+
+    /// @brief Orders hosts by the priority of their identifiers.
+    ///
+    /// This is used by the implementations of @c getByIdentifiers4 and
+    /// @c getByIdentifiers6, which retrieve hosts in an arbitrary order.
+    ///
+    /// @param hosts Hosts to be ordered.
+    /// @param identifiers Identifiers ordered by priority.
+    ///
+    /// @return Collection holding, for each identifier, the first host
+    /// using it. Hosts using none of the identifiers are not included.
+    static ConstHostCollection
+    sortByIdentifiers(const ConstHostCollection& hosts,
+                      const HostIdentifierList& identifiers);
 };
 
 /// @brief HostDataSource pointer
@@ -0,0 +1,470 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+#include <dhcpsrv/binary_lease_file.h>
+#include <boost/crc.hpp>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sstream>
+#include <unistd.h>
+
+using namespace isc::util;
+
+namespace {
+
+/// @brief Leading bytes of the binary lease file.
+const char MAGIC[] = { 'K', 'E', 'A', 'L', 'E', 'A', 'S', 'E' };
+
+/// @brief Computes CRC-32 of the data.
+///
+/// @param data Pointer to the data.
+/// @param length Length of the data.
+uint32_t
+checksum(const void* data, const size_t length) {
+    boost::crc_32_type crc;
+    crc.process_bytes(data, length);
+    return (crc.checksum());
+}
+
+}
+
+namespace isc {
+namespace dhcp {
+
+const uint8_t BinaryLeaseFile::MAJOR_VERSION;
+const uint8_t BinaryLeaseFile::MINOR_VERSION;
+const size_t BinaryLeaseFile::HEADER_SIZE;
+const size_t BinaryLeaseFile::RECORD_HEADER_SIZE;
+const uint32_t BinaryLeaseFile::MAX_RECORD_LENGTH;
+const uint8_t BinaryLeaseFile::FLAG_SNAPSHOT;
+
+BinaryLeaseFile::BinaryLeaseFile(const std::string& filename,
+                                 const uint8_t family)
+    : filename_(filename), family_(family), fs_(), auto_flush_(true),
+      flags_(0), read_msg_(),
+      input_major_(MAJOR_VERSION), input_minor_(MINOR_VERSION),
+      valid_size_(0), truncate_pending_(false),
+      record_header_(RECORD_HEADER_SIZE) {
+}
+
+BinaryLeaseFile::~BinaryLeaseFile() {
+    close();
+}
+
+void
+BinaryLeaseFile::open(const bool seek_to_end) {
+    input_major_ = MAJOR_VERSION;
+    input_minor_ = MINOR_VERSION;
+    truncate_pending_ = false;
+
+    // If file doesn't exist or is empty, we have to create our own file.
+    if (size() == static_cast<std::streampos>(0)) {
+        recreate();
+        return;
+    }
+
+    close();
+    fs_.reset(new std::fstream(filename_.c_str(), std::fstream::in |
+                               std::fstream::out | std::fstream::binary));
+
+    // Catch exceptions so as we can close the file if error occurs.
+    try {
+        if (!fs_->is_open()) {
+            isc_throw(BinaryLeaseFileError, "unable to open '" << filename_
+                      << "'");
+        }
+
+        readHeader();
+
+        if (seek_to_end) {
+            findEnd();
+        }
+
+    } catch (const std::exception&) {
+        close();
+        throw;
+    }
+}
+
+void
+BinaryLeaseFile::close() {
+    // It is allowed to close multiple times. If file has been already closed,
+    // this is no-op.
+    if (fs_) {
+        fs_->close();
+        fs_.reset();
+    }
+}
+
+bool
+BinaryLeaseFile::exists() const {
+    std::ifstream fs(filename_.c_str());
+    const bool file_exists = fs.good();
+    fs.close();
+    return (file_exists);
+}
+
+std::string
+BinaryLeaseFile::getSchemaVersion() const {
+    std::ostringstream s;
+    s << static_cast<int>(MAJOR_VERSION) << "."
+      << static_cast<int>(MINOR_VERSION);
+    return (s.str());
+}
+
+std::string
+BinaryLeaseFile::getInputSchemaVersion() const {
+    std::ostringstream s;
+    s << static_cast<int>(input_major_) << "."
+      << static_cast<int>(input_minor_);
+    return (s.str());
+}
+
+VersionedCSVFile::InputSchemaState
+BinaryLeaseFile::getInputSchemaState() const {
+    if (input_minor_ < MINOR_VERSION) {
+        return (VersionedCSVFile::NEEDS_UPGRADE);
+
+    } else if (input_minor_ > MINOR_VERSION) {
+        return (VersionedCSVFile::NEEDS_DOWNGRADE);
+    }
+    return (VersionedCSVFile::CURRENT);
+}
+
+void
+BinaryLeaseFile::flush() {
+    if (!fs_) {
+        isc_throw(BinaryLeaseFileError, "unable to flush the lease file '"
+                  << filename_ << "': file is not open");
+    }
+    fs_->flush();
+    if (!fs_->good()) {
+        fs_->clear();
+        isc_throw(BinaryLeaseFileError, "failed to flush the lease file '"
+                  << filename_ << "'");
+    }
+}
+
+void
+BinaryLeaseFile::sync() {
+    if (!fs_) {
+        isc_throw(BinaryLeaseFileError, "unable to synchronize the lease"
+                  " file '" << filename_ << "': file is not open");
+    }
+    // The stream doesn't expose its descriptor, so the file is opened
+    // again to synchronize its data.
+    const int fd = ::open(filename_.c_str(), O_RDONLY);
+    if (fd < 0) {
+        isc_throw(BinaryLeaseFileError, "unable to open the lease file '"
+                  << filename_ << "' for synchronization: "
+                  << strerror(errno));
+    }
+#ifdef __APPLE__
+    const int result = fsync(fd);
+#else
+    const int result = fdatasync(fd);
+#endif
+    const int sync_errno = errno;
+    ::close(fd);
+    if (result != 0) {
+        isc_throw(BinaryLeaseFileError, "failed to synchronize the lease"
+                  " file '" << filename_ << "': " << strerror(sync_errno));
+    }
+}
+
+bool
+BinaryLeaseFile::hasBinaryHeader(const std::string& filename) {
+    std::ifstream fs(filename.c_str(), std::ifstream::binary);
+    char magic[sizeof(MAGIC)];
+    fs.read(magic, sizeof(magic));
+    return (fs.good() && (memcmp(magic, MAGIC, sizeof(MAGIC)) == 0));
+}
+
+void
+BinaryLeaseFile::appendRecord(const OutputBuffer& data) {
+    if (!fs_) {
+        isc_throw(BinaryLeaseFileError, "unable to append a record to the"
+                  " lease file '" << filename_ << "': file is not open");
+    }
+
+    if ((data.getLength() == 0) || (data.getLength() > MAX_RECORD_LENGTH)) {
+        isc_throw(BinaryLeaseFileError, "invalid length " << data.getLength()
+                  << " of the record appended to the lease file '"
+                  << filename_ << "'");
+    }
+
+    if (truncate_pending_) {
+        truncateTail();
+    }
+
+    OutputBuffer header(RECORD_HEADER_SIZE);
+    header.writeUint32(data.getLength());
+    header.writeUint32(checksum(data.getData(), data.getLength()));
+
+    // The stream may be in the failed state if the file has been read
+    // to the end.
+    fs_->clear();
+    fs_->seekp(0, std::ios_base::end);
+    fs_->write(static_cast<const char*>(header.getData()), header.getLength());
+    fs_->write(static_cast<const char*>(data.getData()), data.getLength());
+    if (auto_flush_) {
+        fs_->flush();
+    }
+    if (!fs_->good()) {
+        fs_->clear();
+        isc_throw(BinaryLeaseFileError, "failed to append a record to the"
+                  " lease file '" << filename_ << "'");
+    }
+}
+
+bool
+BinaryLeaseFile::nextRecord(std::vector<uint8_t>& data) {
+    data.clear();
+
+    if (!fs_) {
+        setReadMsg("unable to read a record from the lease file '" +
+                   filename_ + "': file is not open");
+        return (false);
+    }
+
+    // There is nothing more to read if the rest of the file has been
+    // found to be corrupted.
+    if (truncate_pending_) {
+        return (true);
+    }
+
+    const std::streamoff offset = fs_->tellg();
+    fs_->read(reinterpret_cast<char*>(&record_header_[0]), RECORD_HEADER_SIZE);
+    const std::streamsize header_read = fs_->gcount();
+    // Nothing was read, so this is the end of file.
+    if ((header_read == 0) && fs_->eof()) {
+        valid_size_ = offset;
+        return (true);
+    }
+
+    uint32_t length = 0;
+    uint32_t crc = 0;
+    if (header_read == static_cast<std::streamsize>(RECORD_HEADER_SIZE)) {
+        InputBuffer header(&record_header_[0], RECORD_HEADER_SIZE);
+        length = header.readUint32();
+        crc = header.readUint32();
+    }
+
+    // If the record header or the record data is incomplete, the rest of
+    // the file can't be parsed. The same applies when the length of the
+    // record is out of range because the next record can't be found.
+    std::ostringstream msg;
+    if (header_read != static_cast<std::streamsize>(RECORD_HEADER_SIZE)) {
+        msg << "truncated record header";
+
+    } else if ((length == 0) || (length > MAX_RECORD_LENGTH)) {
+        msg << "invalid record length " << length;
+
+    } else {
+        data.resize(length);
+        fs_->read(reinterpret_cast<char*>(&data[0]), length);
+        if (fs_->gcount() != static_cast<std::streamsize>(length)) {
+            msg << "truncated record";
+        }
+    }
+
+    if (!msg.str().empty()) {
+        data.clear();
+        valid_size_ = offset;
+        truncate_pending_ = true;
+        msg << " at offset " << offset << " of the lease file '"
+            << filename_ << "'";
+        setReadMsg(msg.str());
+        return (false);
+    }
+
+    if (checksum(&data[0], length) != crc) {
+        data.clear();
+        msg << "invalid checksum of the record at offset " << offset
+            << " of the lease file '" << filename_ << "'";
+        setReadMsg(msg.str());
+        return (false);
+    }
+
+    setReadMsg("success");
+    return (true);
+}
+
+void
+BinaryLeaseFile::writeTime(OutputBuffer& data, const time_t value) {
+    const uint64_t time_value = static_cast<uint64_t>(value);
+    data.writeUint32(static_cast<uint32_t>(time_value >> 32));
+    data.writeUint32(static_cast<uint32_t>(time_value & 0xFFFFFFFF));
+}
+
+time_t
+BinaryLeaseFile::readTime(InputBuffer& data) {
+    uint64_t time_value = static_cast<uint64_t>(data.readUint32()) << 32;
+    time_value |= data.readUint32();
+    return (static_cast<time_t>(time_value));
+}
+
+void
+BinaryLeaseFile::writeBytes(OutputBuffer& data, const uint8_t* value,
+                            const size_t length) {
+    if (length > 255) {
+        isc_throw(BinaryLeaseFileError, "value of " << length << " bytes is"
+                  " too long to be stored in the lease file");
+    }
+    data.writeUint8(static_cast<uint8_t>(length));
+    if (length > 0) {
+        data.writeData(value, length);
+    }
+}
+
+void
+BinaryLeaseFile::readBytes(InputBuffer& data, std::vector<uint8_t>& value) {
+    const uint8_t length = data.readUint8();
+    value.clear();
+    if (length > 0) {
+        data.readVector(value, length);
+    }
+}
+
+void
+BinaryLeaseFile::writeString(OutputBuffer& data, const std::string& value) {
+    if (value.size() > 65535) {
+        isc_throw(BinaryLeaseFileError, "value of " << value.size() << " bytes"
+                  " is too long to be stored in the lease file");
+    }
+    data.writeUint16(static_cast<uint16_t>(value.size()));
+    if (!value.empty()) {
+        data.writeData(value.c_str(), value.size());
+    }
+}
+
+std::string
+BinaryLeaseFile::readString(InputBuffer& data) {
+    const uint16_t length = data.readUint16();
+    if (length == 0) {
+        return (std::string());
+    }
+    std::vector<uint8_t> value;
+    data.readVector(value, length);
+    return (std::string(value.begin(), value.end()));
+}
+
+void
+BinaryLeaseFile::recreate() {
+    // Close any dangling files.
+    close();
+    fs_.reset(new std::fstream(filename_.c_str(), std::fstream::in |
+                               std::fstream::out | std::fstream::trunc |
+                               std::fstream::binary));
+    if (!fs_->is_open()) {
+        close();
+        isc_throw(BinaryLeaseFileError, "unable to open '" << filename_
+                  << "'");
+    }
+
+    OutputBuffer header(HEADER_SIZE);
+    header.writeData(MAGIC, sizeof(MAGIC));
+    header.writeUint8(MAJOR_VERSION);
+    header.writeUint8(MINOR_VERSION);
+    header.writeUint8(family_);
+    header.writeUint8(flags_);
+    fs_->write(static_cast<const char*>(header.getData()), header.getLength());
+    fs_->flush();
+    if (!fs_->good()) {
+        close();
+        isc_throw(BinaryLeaseFileError, "unable to write the header of the"
+                  " lease file '" << filename_ << "'");
+    }
+    valid_size_ = HEADER_SIZE;
+}
+
+void
+BinaryLeaseFile::readHeader() {
+    std::vector<uint8_t> header(HEADER_SIZE);
+    fs_->seekg(0);
+    fs_->read(reinterpret_cast<char*>(&header[0]), HEADER_SIZE);
+    if (fs_->gcount() != static_cast<std::streamsize>(HEADER_SIZE) ||
+        (memcmp(&header[0], MAGIC, sizeof(MAGIC)) != 0)) {
+        isc_throw(BinaryLeaseFileError, "'" << filename_ << "' is not a"
+                  " binary lease file");
+    }
+
+    InputBuffer buf(&header[sizeof(MAGIC)], HEADER_SIZE - sizeof(MAGIC));
+    input_major_ = buf.readUint8();
+    input_minor_ = buf.readUint8();
+    const uint8_t family = buf.readUint8();
+    flags_ = buf.readUint8();
+
+    if (input_major_ != MAJOR_VERSION) {
+        isc_throw(BinaryLeaseFileError, "unsupported version "
+                  << getInputSchemaVersion() << " of the binary lease file '"
+                  << filename_ << "', supported version is "
+                  << getSchemaVersion());
+    }
+
+    if (family != family_) {
+        isc_throw(BinaryLeaseFileError, "the binary lease file '"
+                  << filename_ << "' holds DHCPv"
+                  << static_cast<int>(family) << " leases, expected DHCPv"
+                  << static_cast<int>(family_) << " leases");
+    }
+    valid_size_ = HEADER_SIZE;
+}
+
+void
+BinaryLeaseFile::findEnd() {
+    std::streamoff offset = HEADER_SIZE;
+    const std::streamoff file_size = size();
+    while (offset + static_cast<std::streamoff>(RECORD_HEADER_SIZE)
+           <= file_size) {
+        fs_->seekg(offset);
+        fs_->read(reinterpret_cast<char*>(&record_header_[0]),
+                  RECORD_HEADER_SIZE);
+        InputBuffer header(&record_header_[0], RECORD_HEADER_SIZE);
+        const uint32_t length = header.readUint32();
+        if ((length == 0) || (length > MAX_RECORD_LENGTH) ||
+            (offset + RECORD_HEADER_SIZE + length > file_size)) {
+            break;
+        }
+        offset += RECORD_HEADER_SIZE + length;
+    }
+
+    valid_size_ = offset;
+    truncate_pending_ = (offset < file_size);
+
+    fs_->clear();
+    fs_->seekg(0, std::ios_base::end);
+    fs_->seekp(0, std::ios_base::end);
+}
+
+void
+BinaryLeaseFile::truncateTail() {
+    fs_->flush();
+    if (truncate(filename_.c_str(), valid_size_) != 0) {
+        isc_throw(BinaryLeaseFileError, "unable to remove the incomplete"
+                  " record at offset " << valid_size_ << " of the lease file '"
+                  << filename_ << "': " << strerror(errno));
+    }
+    truncate_pending_ = false;
+}
+
+std::streampos
+BinaryLeaseFile::size() const {
+    std::ifstream fs(filename_.c_str(), std::ifstream::binary);
+    // If something goes wrong, including that the file doesn't exist,
+    // return 0.
+    if (!fs.good()) {
+        return (0);
+    }
+    fs.seekg(0, std::ifstream::end);
+    const std::streampos pos = fs.tellg();
+    return (pos < 0 ? std::streampos(0) : pos);
+}
+
+} // namespace isc::dhcp
+} // namespace isc
@@ -0,0 +1,328 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef BINARY_LEASE_FILE_H
+#define BINARY_LEASE_FILE_H
+
+#include <exceptions/exceptions.h>
+#include <util/buffer.h>
+#include <util/versioned_csv_file.h>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <fstream>
+#include <stdint.h>
+#include <string>
+#include <time.h>
+#include <vector>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Exception thrown when an error occurs during binary lease
+/// file operation.
+class BinaryLeaseFileError : public Exception {
+public:
+    BinaryLeaseFileError(const char* file, size_t line, const char* what) :
+        isc::Exception(file, line, what) { };
+};
+
+/// @brief Provides access to the file holding binary lease records.
+///
+/// The binary lease file is an alternative to the CSV lease file. It
+/// avoids the conversion of the lease values to text when a lease update
+/// is recorded and it is about a third of the size of the CSV file.
+///
+/// The file begins with a header comprising:
+/// - 8 bytes holding the "KEALEASE" string,
+/// - major version (1 byte),
+/// - minor version (1 byte),
+/// - DHCP protocol version, i.e. 4 or 6 (1 byte),
+/// - flags (1 byte).
+///
+/// The only flag defined is @c FLAG_SNAPSHOT. It marks the snapshot of
+/// the lease database, i.e. the file holding exactly one entry for each
+/// lease and no entries for removed leases, which can be loaded without
+/// checking for the previous entries. The readers ignore unknown flags.
+///
+/// The header is followed by the records, each holding one lease entry:
+/// - length of the record data (4 bytes),
+/// - CRC-32 of the record data (4 bytes),
+/// - record data.
+///
+/// All integers are stored in network byte order. The layout of the record
+/// data is defined by the derived classes. The fixed width fields precede
+/// the variable length fields which are prefixed with their length. New
+/// fields may be added at the end of the record data in a new minor version
+/// of the file. The readers ignore the data following the fields they know.
+/// A file with a different major version can't be read.
+///
+/// This class provides the common functions to create and open the file
+/// and to read and write the records. It is meant to be a base class
+/// for the @c BinaryLeaseFile4 and @c BinaryLeaseFile6.
+class BinaryLeaseFile : public boost::noncopyable {
+public:
+
+    /// @brief Major version of the binary lease file.
+    static const uint8_t MAJOR_VERSION = 1;
+
+    /// @brief Minor version of the binary lease file.
+    static const uint8_t MINOR_VERSION = 0;
+
+    /// @brief Size of the file header.
+    static const size_t HEADER_SIZE = 12;
+
+    /// @brief Size of the record length and checksum preceding the data.
+    static const size_t RECORD_HEADER_SIZE = 8;
+
+    /// @brief Maximum length of the record data.
+    static const uint32_t MAX_RECORD_LENGTH = 65535;
+
+    /// @brief Header flag marking the snapshot of the lease database.
+    static const uint8_t FLAG_SNAPSHOT = 0x01;
+
+    /// @brief Constructor.
+    ///
+    /// @param filename Name of the lease file.
+    /// @param family DHCP protocol version of the leases, i.e. 4 or 6.
+    BinaryLeaseFile(const std::string& filename, const uint8_t family);
+
+    /// @brief Destructor.
+    ///
+    /// Closes the file.
+    virtual ~BinaryLeaseFile();
+
+    /// @brief Opens the lease file.
+    ///
+    /// If the file doesn't exist or it is empty, it is created and the
+    /// header is written to it. Otherwise, the header of the file is
+    /// verified.
+    ///
+    /// @param seek_to_end A boolean value which indicates if the input and
+    /// output file pointer should be set at the end of file.
+    ///
+    /// @throw BinaryLeaseFileError if the file can't be opened or if it
+    /// holds no valid header.
+    virtual void open(const bool seek_to_end = false);
+
+    /// @brief Closes the lease file.
+    void close();
+
+    /// @brief Checks if the lease file exists.
+    bool exists() const;
+
+    /// @brief Returns the path to the lease file.
+    std::string getFilename() const {
+        return (filename_);
+    }
+
+    /// @brief Returns the description of the last error reading the file.
+    std::string getReadMsg() const {
+        return (read_msg_);
+    }
+
+    /// @brief Returns the version of the lease file written by this class.
+    std::string getSchemaVersion() const;
+
+    /// @brief Returns the version of the lease file being read.
+    std::string getInputSchemaVersion() const;
+
+    /// @brief Returns the state of the version of the lease file being read.
+    util::VersionedCSVFile::InputSchemaState getInputSchemaState() const;
+
+    /// @brief Checks if the lease file should be rewritten in the current
+    /// version.
+    bool needsConversion() const {
+        return (getInputSchemaState() != util::VersionedCSVFile::CURRENT);
+    }
+
+    /// @brief Enables or disables flushing the file after each record.
+    ///
+    /// The records are flushed by default.
+    ///
+    /// @param auto_flush true if each record should be flushed.
+    void setAutoFlush(const bool auto_flush) {
+        auto_flush_ = auto_flush;
+    }
+
+    /// @brief Writes the buffered records to the file.
+    ///
+    /// @throw BinaryLeaseFileError if the file is not open or the records
+    /// couldn't be written.
+    void flush();
+
+    /// @brief Waits until the flushed records are stored on the disk.
+    ///
+    /// @throw BinaryLeaseFileError if the file is not open or the data
+    /// couldn't be synchronized.
+    void sync();
+
+    /// @brief Marks the file created by the next @c open as a snapshot.
+    ///
+    /// The caller must append each lease at most once and no lease with
+    /// the valid lifetime of 0. The flag of the existing file is not
+    /// modified.
+    ///
+    /// @param snapshot true if the file is a snapshot.
+    void setSnapshot(const bool snapshot) {
+        flags_ = snapshot ? FLAG_SNAPSHOT : 0;
+    }
+
+    /// @brief Checks if the open file is a snapshot.
+    ///
+    /// @return true if the header of the file has the @c FLAG_SNAPSHOT.
+    bool isSnapshot() const {
+        return ((flags_ & FLAG_SNAPSHOT) != 0);
+    }
+
+    /// @brief Checks if the file begins with the binary lease file header.
+    ///
+    /// @param filename Name of the file.
+    ///
+    /// @return true if the file exists and begins with the header.
+    static bool hasBinaryHeader(const std::string& filename);
+
+protected:
+
+    /// @brief Appends the record to the lease file.
+    ///
+    /// The record is preceded with its length and checksum.
+    ///
+    /// @param data Record data.
+    ///
+    /// @throw BinaryLeaseFileError if the file is not open, the record
+    /// is too long or the record couldn't be written.
+    void appendRecord(const util::OutputBuffer& data);
+
+    /// @brief Reads next record from the lease file.
+    ///
+    /// If the record is not entirely written to the file, e.g. because
+    /// the server was killed while it was writing the record, the record
+    /// and the remaining part of the file are reported as an error and
+    /// skipped. This part of the file is removed before the next record is
+    /// appended.
+    ///
+    /// @param [out] data Record data or empty vector at the end of file.
+    ///
+    /// @return false if an error occurred, true otherwise. The error
+    /// message may be read using @c getReadMsg.
+    bool nextRecord(std::vector<uint8_t>& data);
+
+    /// @brief Sets the description of the last error reading the file.
+    ///
+    /// @param read_msg Error description.
+    void setReadMsg(const std::string& read_msg) {
+        read_msg_ = read_msg;
+    }
+
+    /// @name Functions writing and reading the record fields.
+    ///
+    //@{
+    ///
+    /// @brief Writes time value as 8 bytes.
+    ///
+    /// @param [out] data Record data.
+    /// @param value Time value.
+    static void writeTime(util::OutputBuffer& data, const time_t value);
+
+    /// @brief Reads time value written with @c writeTime.
+    ///
+    /// @param data Record data.
+    /// @throw isc::util::InvalidBufferPosition if the data is too short.
+    static time_t readTime(util::InputBuffer& data);
+
+    /// @brief Writes binary value preceded with 1 byte length.
+    ///
+    /// @param [out] data Record data.
+    /// @param value Pointer to the binary value.
+    /// @param length Length of the binary value.
+    /// @throw BinaryLeaseFileError if the value is longer than 255 bytes.
+    static void writeBytes(util::OutputBuffer& data, const uint8_t* value,
+                           const size_t length);
+
+    /// @brief Reads binary value written with @c writeBytes.
+    ///
+    /// @param data Record data.
+    /// @param [out] value Binary value.
+    /// @throw isc::util::InvalidBufferPosition if the data is too short.
+    static void readBytes(util::InputBuffer& data,
+                          std::vector<uint8_t>& value);
+
+    /// @brief Writes string preceded with 2 bytes length.
+    ///
+    /// @param [out] data Record data.
+    /// @param value String value.
+    /// @throw BinaryLeaseFileError if the value is longer than 65535 bytes.
+    static void writeString(util::OutputBuffer& data, const std::string& value);
+
+    /// @brief Reads string written with @c writeString.
+    ///
+    /// @param data Record data.
+    /// @throw isc::util::InvalidBufferPosition if the data is too short.
+    static std::string readString(util::InputBuffer& data);
+    //@}
+
+private:
+
+    /// @brief Creates the new file and writes the header.
+    void recreate();
+
+    /// @brief Reads and verifies the file header.
+    ///
+    /// @throw BinaryLeaseFileError if the header is not valid.
+    void readHeader();
+
+    /// @brief Finds the end of the last complete record in the file.
+    ///
+    /// It is used when the file is opened for appending the records
+    /// without reading it.
+    void findEnd();
+
+    /// @brief Removes the part of the file following the last complete
+    /// record.
+    void truncateTail();
+
+    /// @brief Returns the size of the file.
+    std::streampos size() const;
+
+    /// @brief Name of the lease file.
+    std::string filename_;
+
+    /// @brief DHCP protocol version of the leases.
+    uint8_t family_;
+
+    /// @brief Stream used to read and write the file.
+    boost::scoped_ptr<std::fstream> fs_;
+
+    /// @brief Indicates if the file is flushed after each record.
+    bool auto_flush_;
+
+    /// @brief Flags of the file header.
+    uint8_t flags_;
+
+    /// @brief Description of the last error reading the file.
+    std::string read_msg_;
+
+    /// @brief Major version of the file being read.
+    uint8_t input_major_;
+
+    /// @brief Minor version of the file being read.
+    uint8_t input_minor_;
+
+    /// @brief Position following the last complete record.
+    std::streamoff valid_size_;
+
+    /// @brief Indicates that the file holds an incomplete record
+    /// following the position @c valid_size_.
+    bool truncate_pending_;
+
+    /// @brief Buffer holding the record length and checksum.
+    std::vector<uint8_t> record_header_;
+};
+
+} // namespace isc::dhcp
+} // namespace isc
+
+#endif // BINARY_LEASE_FILE_H
@@ -0,0 +1,173 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+#include <dhcpsrv/binary_lease_file4.h>
+
+using namespace isc::asiolink;
+using namespace isc::util;
+
+namespace {
+
+/// @brief Flag indicating that the forward DNS update has been performed.
+const uint8_t FLAG_FQDN_FWD = 0x01;
+
+/// @brief Flag indicating that the reverse DNS update has been performed.
+const uint8_t FLAG_FQDN_REV = 0x02;
+
+}
+
+namespace isc {
+namespace dhcp {
+
+BinaryLeaseFile4::BinaryLeaseFile4(const std::string& filename)
+    : BinaryLeaseFile(filename, 4), record_() {
+}
+
+void
+BinaryLeaseFile4::open(const bool seek_to_end) {
+    // Call the base class to open the file
+    BinaryLeaseFile::open(seek_to_end);
+
+    // and clear any statistics we may have
+    clearStatistics();
+}
+
+void
+BinaryLeaseFile4::append(const Lease4& lease) {
+    // Bump the number of write attempts
+    ++writes_;
+
+    if (!lease.hwaddr_) {
+        // Bump the error counter
+        ++write_errs_;
+
+        isc_throw(BadValue, "Lease4 must have hardware address specified.");
+    }
+
+    try {
+        OutputBuffer data(64);
+        writeLease(lease, data);
+        appendRecord(data);
+
+    } catch (const std::exception&) {
+        // Catch any errors so we can bump the error counter than rethrow it
+        ++write_errs_;
+        throw;
+    }
+
+    // Bump the number of leases written
+    ++write_leases_;
+}
+
+bool
+BinaryLeaseFile4::next(Lease4Ptr& lease) {
+    // Bump the number of read attempts
+    ++reads_;
+
+    // Read the record and try to create a lease from the values read.
+    // This may easily result in exception. We don't want this function
+    // to throw exceptions, so we catch them all and rather return the
+    // false value.
+    try {
+        if (!nextRecord(record_)) {
+            ++read_errs_;
+            lease.reset();
+            return (false);
+        }
+
+        // The empty record signals EOF.
+        if (record_.empty()) {
+            lease.reset();
+            return (true);
+        }
+
+        lease = readLease(record_);
+
+    } catch (const std::exception& ex) {
+        // bump the read error count
+        ++read_errs_;
+
+        // The lease might have been created, so let's set it back to NULL to
+        // signal that lease hasn't been parsed.
+        lease.reset();
+        setReadMsg(ex.what());
+        return (false);
+    }
+
+    // bump the number of leases read
+    ++read_leases_;
+
+    return (true);
+}
+
+void
+BinaryLeaseFile4::writeLease(const Lease4& lease, OutputBuffer& data) const {
+    data.writeUint32(lease.addr_.toUint32());
+    data.writeUint32(lease.valid_lft_);
+    writeTime(data, lease.cltt_);
+    data.writeUint32(lease.subnet_id_);
+    data.writeUint32(lease.state_);
+    data.writeUint8((lease.fqdn_fwd_ ? FLAG_FQDN_FWD : 0) |
+                    (lease.fqdn_rev_ ? FLAG_FQDN_REV : 0));
+
+    data.writeUint8(static_cast<uint8_t>(lease.hwaddr_->htype_));
+    const std::vector<uint8_t>& hwaddr = lease.hwaddr_->hwaddr_;
+    writeBytes(data, hwaddr.empty() ? NULL : &hwaddr[0], hwaddr.size());
+
+    // Client id may be unset (NULL).
+    if (lease.client_id_) {
+        const std::vector<uint8_t>& client_id = lease.client_id_->getClientId();
+        writeBytes(data, &client_id[0], client_id.size());
+    } else {
+        writeBytes(data, NULL, 0);
+    }
+
+    writeString(data, lease.hostname_);
+}
+
+Lease4Ptr
+BinaryLeaseFile4::readLease(const std::vector<uint8_t>& data) const {
+    InputBuffer buf(&data[0], data.size());
+
+    const IOAddress addr(buf.readUint32());
+    const uint32_t valid_lft = buf.readUint32();
+    const time_t cltt = readTime(buf);
+    const SubnetID subnet_id = buf.readUint32();
+    const uint32_t state = buf.readUint32();
+    const uint8_t flags = buf.readUint8();
+
+    const uint16_t htype = buf.readUint8();
+    std::vector<uint8_t> hwaddr;
+    readBytes(buf, hwaddr);
+    if (hwaddr.empty() && state != Lease::STATE_DECLINED) {
+        isc_throw(isc::BadValue, "A blank hardware address is only"
+                  " valid for declined leases");
+    }
+
+    std::vector<uint8_t> client_id;
+    readBytes(buf, client_id);
+
+    const std::string hostname = readString(buf);
+
+    Lease4Ptr lease(new Lease4(addr,
+                               HWAddrPtr(new HWAddr(hwaddr, htype)),
+                               client_id.empty() ? NULL : &client_id[0],
+                               client_id.size(),
+                               valid_lft,
+                               0, 0, // t1, t2 = 0
+                               cltt,
+                               subnet_id,
+                               (flags & FLAG_FQDN_FWD) != 0,
+                               (flags & FLAG_FQDN_REV) != 0,
+                               hostname));
+    lease->state_ = state;
+
+    return (lease);
+}
+
+} // namespace isc::dhcp
+} // namespace isc
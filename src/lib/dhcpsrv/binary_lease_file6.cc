@@ -0,0 +1,195 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+#include <dhcpsrv/binary_lease_file6.h>
+
+using namespace isc::asiolink;
+using namespace isc::util;
+
+namespace {
+
+/// @brief Flag indicating that the forward DNS update has been performed.
+const uint8_t FLAG_FQDN_FWD = 0x01;
+
+/// @brief Flag indicating that the reverse DNS update has been performed.
+const uint8_t FLAG_FQDN_REV = 0x02;
+
+}
+
+namespace isc {
+namespace dhcp {
+
+BinaryLeaseFile6::BinaryLeaseFile6(const std::string& filename)
+    : BinaryLeaseFile(filename, 6), record_() {
+}
+
+void
+BinaryLeaseFile6::open(const bool seek_to_end) {
+    // Call the base class to open the file
+    BinaryLeaseFile::open(seek_to_end);
+
+    // and clear any statistics we may have
+    clearStatistics();
+}
+
+void
+BinaryLeaseFile6::append(const Lease6& lease) {
+    // Bump the number of write attempts
+    ++writes_;
+
+    if (!lease.duid_) {
+        // Bump the error counter
+        ++write_errs_;
+
+        isc_throw(BadValue, "Lease6 must have DUID specified.");
+    }
+
+    try {
+        OutputBuffer data(96);
+        writeLease(lease, data);
+        appendRecord(data);
+
+    } catch (const std::exception&) {
+        // Catch any errors so we can bump the error counter than rethrow it
+        ++write_errs_;
+        throw;
+    }
+
+    // Bump the number of leases written
+    ++write_leases_;
+}
+
+bool
+BinaryLeaseFile6::next(Lease6Ptr& lease) {
+    // Bump the number of read attempts
+    ++reads_;
+
+    // Read the record and try to create a lease from the values read.
+    // This may easily result in exception. We don't want this function
+    // to throw exceptions, so we catch them all and rather return the
+    // false value.
+    try {
+        if (!nextRecord(record_)) {
+            ++read_errs_;
+            lease.reset();
+            return (false);
+        }
+
+        // The empty record signals EOF.
+        if (record_.empty()) {
+            lease.reset();
+            return (true);
+        }
+
+        lease = readLease(record_);
+
+    } catch (const std::exception& ex) {
+        // bump the read error count
+        ++read_errs_;
+
+        // The lease might have been created, so let's set it back to NULL to
+        // signal that lease hasn't been parsed.
+        lease.reset();
+        setReadMsg(ex.what());
+        return (false);
+    }
+
+    // bump the number of leases read
+    ++read_leases_;
+
+    return (true);
+}
+
+void
+BinaryLeaseFile6::writeLease(const Lease6& lease, OutputBuffer& data) const {
+    const std::vector<uint8_t> addr = lease.addr_.toBytes();
+    if (addr.size() != V6ADDRESS_LEN) {
+        isc_throw(isc::BadValue, "Lease6 must have IPv6 address.");
+    }
+    data.writeData(&addr[0], addr.size());
+    data.writeUint32(lease.valid_lft_);
+    writeTime(data, lease.cltt_);
+    data.writeUint32(lease.subnet_id_);
+    data.writeUint32(lease.state_);
+    data.writeUint32(lease.preferred_lft_);
+    data.writeUint32(lease.iaid_);
+    data.writeUint8(static_cast<uint8_t>(lease.type_));
+    data.writeUint8(lease.prefixlen_);
+    data.writeUint8((lease.fqdn_fwd_ ? FLAG_FQDN_FWD : 0) |
+                    (lease.fqdn_rev_ ? FLAG_FQDN_REV : 0));
+
+    const std::vector<uint8_t>& duid = lease.duid_->getDuid();
+    writeBytes(data, &duid[0], duid.size());
+
+    // We may not have hardware information
+    if (lease.hwaddr_) {
+        data.writeUint8(static_cast<uint8_t>(lease.hwaddr_->htype_));
+        const std::vector<uint8_t>& hwaddr = lease.hwaddr_->hwaddr_;
+        writeBytes(data, hwaddr.empty() ? NULL : &hwaddr[0], hwaddr.size());
+    } else {
+        data.writeUint8(0);
+        writeBytes(data, NULL, 0);
+    }
+
+    writeString(data, lease.hostname_);
+}
+
+Lease6Ptr
+BinaryLeaseFile6::readLease(const std::vector<uint8_t>& data) const {
+    InputBuffer buf(&data[0], data.size());
+
+    uint8_t addr_bytes[V6ADDRESS_LEN];
+    buf.readData(addr_bytes, V6ADDRESS_LEN);
+    const IOAddress addr = IOAddress::fromBytes(AF_INET6, addr_bytes);
+    const uint32_t valid_lft = buf.readUint32();
+    const time_t cltt = readTime(buf);
+    const SubnetID subnet_id = buf.readUint32();
+    const uint32_t state = buf.readUint32();
+    const uint32_t preferred_lft = buf.readUint32();
+    const uint32_t iaid = buf.readUint32();
+    const uint8_t type = buf.readUint8();
+    const uint8_t prefixlen = buf.readUint8();
+    const uint8_t flags = buf.readUint8();
+
+    if (type > Lease::TYPE_PD) {
+        isc_throw(isc::BadValue, "invalid lease type " << static_cast<int>(type));
+    }
+
+    std::vector<uint8_t> duid;
+    readBytes(buf, duid);
+    DuidPtr duid_ptr(new DUID(duid));
+
+    const uint16_t htype = buf.readUint8();
+    std::vector<uint8_t> hwaddr;
+    readBytes(buf, hwaddr);
+    HWAddrPtr hwaddr_ptr;
+    if (!hwaddr.empty()) {
+        hwaddr_ptr.reset(new HWAddr(hwaddr, htype));
+    }
+
+    const std::string hostname = readString(buf);
+
+    Lease6Ptr lease(new Lease6(static_cast<Lease::Type>(type), addr, duid_ptr,
+                               iaid, preferred_lft, valid_lft,
+                               0, 0, // t1, t2 = 0
+                               subnet_id, hwaddr_ptr, prefixlen));
+    lease->cltt_ = cltt;
+    lease->fqdn_fwd_ = (flags & FLAG_FQDN_FWD) != 0;
+    lease->fqdn_rev_ = (flags & FLAG_FQDN_REV) != 0;
+    lease->hostname_ = hostname;
+    lease->state_ = state;
+    if ((*lease->duid_ == DUID::EMPTY())
+        && lease->state_ != Lease::STATE_DECLINED) {
+        isc_throw(isc::BadValue, "The Empty DUID is"
+                  " only valid for declined leases");
+    }
+
+    return (lease);
+}
+
+} // namespace isc::dhcp
+} // namespace isc
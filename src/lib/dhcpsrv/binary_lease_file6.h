@@ -0,0 +1,145 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef BINARY_LEASE_FILE6_H
+#define BINARY_LEASE_FILE6_H
+
+#include <dhcpsrv/binary_lease_file.h>
+#include <dhcpsrv/lease.h>
+#include <dhcpsrv/lease_file.h>
+#include <util/buffer.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Provides methods to access binary file with DHCPv6 leases.
+///
+/// The record data of the DHCPv6 lease comprises the following fields:
+/// - address (16 bytes),
+/// - valid lifetime (4 bytes),
+/// - cltt (8 bytes),
+/// - subnet id (4 bytes),
+/// - state (4 bytes),
+/// - preferred lifetime (4 bytes),
+/// - IAID (4 bytes),
+/// - lease type (1 byte),
+/// - prefix length (1 byte),
+/// - flags: bit 0 is FQDN forward, bit 1 is FQDN reverse (1 byte),
+/// - DUID length (1 byte) and DUID,
+/// - HW address type (1 byte),
+/// - HW address length (1 byte) and HW address, the length of 0
+///   indicates that the lease has no HW address,
+/// - hostname length (2 bytes) and hostname.
+class BinaryLeaseFile6 : public BinaryLeaseFile, public LeaseFile6 {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// @param filename Name of the lease file.
+    BinaryLeaseFile6(const std::string& filename);
+
+    /// @brief Opens a lease file.
+    ///
+    /// This function calls the base class open to do the
+    /// work of opening a file.  It is used to clear any
+    /// statistics associated with any previous use of the file
+    /// While it doesn't throw any exceptions of its own
+    /// the base class may do so.
+    virtual void open(const bool seek_to_end = false);
+
+    /// @brief Closes the lease file.
+    virtual void close() {
+        BinaryLeaseFile::close();
+    }
+
+    /// @brief Checks if the lease file exists.
+    virtual bool exists() const {
+        return (BinaryLeaseFile::exists());
+    }
+
+    /// @brief Returns the path to the lease file.
+    virtual std::string getFilename() const {
+        return (BinaryLeaseFile::getFilename());
+    }
+
+    /// @brief Returns the description of the last error reading the file.
+    virtual std::string getReadMsg() const {
+        return (BinaryLeaseFile::getReadMsg());
+    }
+
+    /// @brief Checks if the lease file should be rewritten in the current
+    /// version.
+    virtual bool needsConversion() const {
+        return (BinaryLeaseFile::needsConversion());
+    }
+
+    /// @brief Enables or disables flushing the lease file after each entry.
+    virtual void setAutoFlush(const bool auto_flush) {
+        BinaryLeaseFile::setAutoFlush(auto_flush);
+    }
+
+    /// @brief Writes the buffered entries to the lease file.
+    virtual void flush() {
+        BinaryLeaseFile::flush();
+    }
+
+    /// @brief Waits until the flushed entries are stored on the disk.
+    virtual void sync() {
+        BinaryLeaseFile::sync();
+    }
+
+    /// @brief Appends the lease record to the binary file.
+    ///
+    /// @param lease Structure representing a DHCPv6 lease.
+    ///
+    /// @throw BadValue if the lease has no DUID.
+    /// @throw BinaryLeaseFileError if the record couldn't be written.
+    virtual void append(const Lease6& lease);
+
+    /// @brief Reads next lease from the binary file.
+    ///
+    /// If this function hits an error during lease read, it sets the error
+    /// message and returns false. The error string may be read using
+    /// @c getReadMsg.
+    ///
+    /// This function is exception safe.
+    ///
+    /// @param [out] lease Pointer to the lease read from the file or
+    /// NULL pointer if lease hasn't been read.
+    ///
+    /// @return Boolean value indicating that the new lease has been
+    /// read from the file (if true), or that the error has occurred
+    /// (false).
+    virtual bool next(Lease6Ptr& lease);
+
+private:
+
+    /// @brief Writes the lease into the record data.
+    ///
+    /// @param lease Structure representing a DHCPv6 lease.
+    /// @param [out] data Buffer to which the record data is written.
+    void writeLease(const Lease6& lease, util::OutputBuffer& data) const;
+
+    /// @brief Creates a lease from the record data.
+    ///
+    /// @param data Record data.
+    ///
+    /// @return Pointer to the lease created.
+    /// @throw isc::Exception or derived exception if the record doesn't
+    /// hold a valid lease.
+    Lease6Ptr readLease(const std::vector<uint8_t>& data) const;
+
+    /// @brief Buffer holding the record data being read.
+    std::vector<uint8_t> record_;
+};
+
+} // namespace isc::dhcp
+} // namespace isc
+
+#endif // BINARY_LEASE_FILE6_H
@@ -0,0 +1,464 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <dhcpsrv/cached_lease_mgr.h>
+#include <stats/stats_mgr.h>
+#include <boost/foreach.hpp>
+#include <boost/lexical_cast.hpp>
+#include <limits>
+
+using namespace isc::asiolink;
+using namespace isc::stats;
+
+namespace isc {
+namespace dhcp {
+
+namespace {
+
+/// @brief Returns the value of the unsigned integer parameter.
+///
+/// @param parameters Database access parameters.
+/// @param name Name of the parameter.
+/// @param default_value Value returned when the parameter is not specified.
+///
+/// @return Value of the parameter.
+/// @throw DbInvalidLeaseCache if the value is invalid.
+uint32_t
+getCacheParameter(const DatabaseConnection::ParameterMap& parameters,
+                  const std::string& name, const uint32_t default_value) {
+    DatabaseConnection::ParameterMap::const_iterator param =
+        parameters.find(name);
+    if (param == parameters.end()) {
+        return (default_value);
+    }
+    // The lexical cast to the unsigned type accepts negative values,
+    // so the value is checked against the range explicitly.
+    int64_t value = -1;
+    try {
+        value = boost::lexical_cast<int64_t>(param->second);
+    } catch (const boost::bad_lexical_cast&) {
+        // The value is reported below.
+    }
+    if ((value < 0) || (value > std::numeric_limits<uint32_t>::max())) {
+        isc_throw(DbInvalidLeaseCache, "invalid value for the " << name
+                  << " parameter: " << param->second);
+    }
+    return (static_cast<uint32_t>(value));
+}
+
+}
+
+size_t
+CachedLeaseMgr::getCacheSize(const DatabaseConnection::ParameterMap&
+                             parameters) {
+    return (getCacheParameter(parameters, "cache-size", 0));
+}
+
+uint32_t
+CachedLeaseMgr::getCacheTtl(const DatabaseConnection::ParameterMap&
+                            parameters) {
+    return (getCacheParameter(parameters, "cache-ttl", 10));
+}
+
+CachedLeaseMgr::CachedLeaseMgr(LeaseMgr* backend, const size_t max_size,
+                               const uint32_t ttl)
+    : LeaseMgr(), backend_(backend),
+      cache_(max_size, ttl,
+             StatsMgr::instance().getCounter("lease-cache-hits"),
+             StatsMgr::instance().getCounter("lease-cache-misses")) {
+}
+
+CachedLeaseMgr::~CachedLeaseMgr() {
+}
+
+size_t
+CachedLeaseMgr::getCacheCount() const {
+    return (cache_.size());
+}
+
+void
+CachedLeaseMgr::clearCache() {
+    cache_.clear();
+}
+
+bool
+CachedLeaseMgr::lookup(const Lease::Type type, const IOAddress& addr,
+                       LeasePtr& lease, uint64_t& version) const {
+    return (cache_.get(CacheKey(type, addr), lease, version));
+}
+
+void
+CachedLeaseMgr::insert(const Lease::Type type, const IOAddress& addr,
+                       const LeasePtr& lease, const uint64_t version) const {
+    cache_.insert(CacheKey(type, addr), lease, version);
+}
+
+void
+CachedLeaseMgr::update(const Lease::Type type, const LeasePtr& lease) {
+    cache_.update(CacheKey(type, lease->addr_), lease);
+}
+
+void
+CachedLeaseMgr::invalidate(const Lease::Type type, const IOAddress& addr) {
+    cache_.erase(CacheKey(type, addr));
+}
+
+void
+CachedLeaseMgr::invalidate(const IOAddress& addr) {
+    cache_.erase(CacheKey(Lease::TYPE_V4, addr));
+    cache_.erase(CacheKey(Lease::TYPE_NA, addr));
+    cache_.erase(CacheKey(Lease::TYPE_TA, addr));
+    cache_.erase(CacheKey(Lease::TYPE_PD, addr));
+}
+
+bool
+CachedLeaseMgr::addLease(const Lease4Ptr& lease) {
+    bool added = false;
+    try {
+        added = backend_->addLease(lease);
+    } catch (...) {
+        invalidate(Lease::TYPE_V4, lease->addr_);
+        throw;
+    }
+    if (added) {
+        update(Lease::TYPE_V4, Lease4Ptr(new Lease4(*lease)));
+    } else {
+        // The lease exists in the database, so the negative entry, if
+        // any, is wrong.
+        invalidate(Lease::TYPE_V4, lease->addr_);
+    }
+    return (added);
+}
+
+bool
+CachedLeaseMgr::addLease(const Lease6Ptr& lease) {
+    bool added = false;
+    try {
+        added = backend_->addLease(lease);
+    } catch (...) {
+        invalidate(lease->type_, lease->addr_);
+        throw;
+    }
+    if (added) {
+        update(lease->type_, Lease6Ptr(new Lease6(*lease)));
+    } else {
+        invalidate(lease->type_, lease->addr_);
+    }
+    return (added);
+}
+
+size_t
+CachedLeaseMgr::addLeases(const Lease4Collection& leases) {
+    // It is not known which of the leases have been added, so the entries
+    // are removed rather than updated.
+    size_t added = 0;
+    try {
+        added = backend_->addLeases(leases);
+    } catch (...) {
+        BOOST_FOREACH(const Lease4Ptr& lease, leases) {
+            invalidate(Lease::TYPE_V4, lease->addr_);
+        }
+        throw;
+    }
+    BOOST_FOREACH(const Lease4Ptr& lease, leases) {
+        invalidate(Lease::TYPE_V4, lease->addr_);
+    }
+    return (added);
+}
+
+size_t
+CachedLeaseMgr::addLeases(const Lease6Collection& leases) {
+    size_t added = 0;
+    try {
+        added = backend_->addLeases(leases);
+    } catch (...) {
+        BOOST_FOREACH(const Lease6Ptr& lease, leases) {
+            invalidate(lease->type_, lease->addr_);
+        }
+        throw;
+    }
+    BOOST_FOREACH(const Lease6Ptr& lease, leases) {
+        invalidate(lease->type_, lease->addr_);
+    }
+    return (added);
+}
+
+Lease4Ptr
+CachedLeaseMgr::getLease4(const IOAddress& addr) const {
+    LeasePtr cached;
+    uint64_t version = 0;
+    if (lookup(Lease::TYPE_V4, addr, cached, version)) {
+        Lease4Ptr lease = boost::dynamic_pointer_cast<Lease4>(cached);
+        return (lease ? Lease4Ptr(new Lease4(*lease)) : Lease4Ptr());
+    }
+
+    Lease4Ptr lease = backend_->getLease4(addr);
+    insert(Lease::TYPE_V4, addr, lease ? Lease4Ptr(new Lease4(*lease)) :
+           Lease4Ptr(), version);
+    return (lease);
+}
+
+Lease4Collection
+CachedLeaseMgr::getLease4(const HWAddr& hwaddr) const {
+    return (backend_->getLease4(hwaddr));
+}
+
+Lease4Ptr
+CachedLeaseMgr::getLease4(const HWAddr& hwaddr, SubnetID subnet_id) const {
+    return (backend_->getLease4(hwaddr, subnet_id));
+}
+
+Lease4Collection
+CachedLeaseMgr::getLease4(const ClientId& clientid) const {
+    return (backend_->getLease4(clientid));
+}
+
+Lease4Ptr
+CachedLeaseMgr::getLease4(const ClientId& client_id, const HWAddr& hwaddr,
+                          SubnetID subnet_id) const {
+    return (backend_->getLease4(client_id, hwaddr, subnet_id));
+}
+
+Lease4Ptr
+CachedLeaseMgr::getLease4(const ClientId& clientid, SubnetID subnet_id) const {
+    return (backend_->getLease4(clientid, subnet_id));
+}
+
+Lease4Collection
+CachedLeaseMgr::getLeases4(SubnetID subnet_id) const {
+    return (backend_->getLeases4(subnet_id));
+}
+
+Lease6Ptr
+CachedLeaseMgr::getLease6(Lease::Type type, const IOAddress& addr) const {
+    LeasePtr cached;
+    uint64_t version = 0;
+    if (lookup(type, addr, cached, version)) {
+        Lease6Ptr lease = boost::dynamic_pointer_cast<Lease6>(cached);
+        return (lease ? Lease6Ptr(new Lease6(*lease)) : Lease6Ptr());
+    }
+
+    Lease6Ptr lease = backend_->getLease6(type, addr);
+    insert(type, addr, lease ? Lease6Ptr(new Lease6(*lease)) : Lease6Ptr(),
+           version);
+    return (lease);
+}
+
+Lease6Collection
+CachedLeaseMgr::getLeases6(Lease::Type type, const DUID& duid,
+                           uint32_t iaid) const {
+    return (backend_->getLeases6(type, duid, iaid));
+}
+
+Lease6Collection
+CachedLeaseMgr::getLeases6(Lease::Type type, const DUID& duid,
+                           uint32_t iaid, SubnetID subnet_id) const {
+    return (backend_->getLeases6(type, duid, iaid, subnet_id));
+}
+
+void
+CachedLeaseMgr::getExpiredLeases6(Lease6Collection& expired_leases,
+                                  const size_t max_leases) const {
+    backend_->getExpiredLeases6(expired_leases, max_leases);
+}
+
+void
+CachedLeaseMgr::getExpiredLeases4(Lease4Collection& expired_leases,
+                                  const size_t max_leases) const {
+    backend_->getExpiredLeases4(expired_leases, max_leases);
+}
+
+void
+CachedLeaseMgr::updateLease4(const Lease4Ptr& lease4) {
+    try {
+        backend_->updateLease4(lease4);
+    } catch (...) {
+        invalidate(Lease::TYPE_V4, lease4->addr_);
+        throw;
+    }
+    update(Lease::TYPE_V4, Lease4Ptr(new Lease4(*lease4)));
+}
+
+void
+CachedLeaseMgr::updateLease6(const Lease6Ptr& lease6) {
+    try {
+        backend_->updateLease6(lease6);
+    } catch (...) {
+        invalidate(lease6->type_, lease6->addr_);
+        throw;
+    }
+    update(lease6->type_, Lease6Ptr(new Lease6(*lease6)));
+}
+
+void
+CachedLeaseMgr::updateLeases4(const Lease4Collection& leases) {
+    try {
+        backend_->updateLeases4(leases);
+    } catch (...) {
+        BOOST_FOREACH(const Lease4Ptr& lease, leases) {
+            invalidate(Lease::TYPE_V4, lease->addr_);
+        }
+        throw;
+    }
+    BOOST_FOREACH(const Lease4Ptr& lease, leases) {
+        update(Lease::TYPE_V4, Lease4Ptr(new Lease4(*lease)));
+    }
+}
+
+void
+CachedLeaseMgr::updateLeases6(const Lease6Collection& leases) {
+    try {
+        backend_->updateLeases6(leases);
+    } catch (...) {
+        BOOST_FOREACH(const Lease6Ptr& lease, leases) {
+            invalidate(lease->type_, lease->addr_);
+        }
+        throw;
+    }
+    BOOST_FOREACH(const Lease6Ptr& lease, leases) {
+        update(lease->type_, Lease6Ptr(new Lease6(*lease)));
+    }
+}
+
+bool
+CachedLeaseMgr::deleteLease(const IOAddress& addr) {
+    // The address doesn't tell the type of the IPv6 lease, so the entries
+    // of all types are removed.
+    bool deleted = false;
+    try {
+        deleted = backend_->deleteLease(addr);
+    } catch (...) {
+        invalidate(addr);
+        throw;
+    }
+    invalidate(addr);
+    return (deleted);
+}
+
+size_t
+CachedLeaseMgr::deleteLeases(const std::vector<IOAddress>& addrs) {
+    size_t deleted = 0;
+    try {
+        deleted = backend_->deleteLeases(addrs);
+    } catch (...) {
+        BOOST_FOREACH(const IOAddress& addr, addrs) {
+            invalidate(addr);
+        }
+        throw;
+    }
+    BOOST_FOREACH(const IOAddress& addr, addrs) {
+        invalidate(addr);
+    }
+    return (deleted);
+}
+
+uint64_t
+CachedLeaseMgr::deleteExpiredReclaimedLeases4(const uint32_t secs) {
+    uint64_t deleted = 0;
+    try {
+        deleted = backend_->deleteExpiredReclaimedLeases4(secs);
+    } catch (...) {
+        clearCache();
+        throw;
+    }
+    clearCache();
+    return (deleted);
+}
+
+uint64_t
+CachedLeaseMgr::deleteExpiredReclaimedLeases6(const uint32_t secs) {
+    uint64_t deleted = 0;
+    try {
+        deleted = backend_->deleteExpiredReclaimedLeases6(secs);
+    } catch (...) {
+        clearCache();
+        throw;
+    }
+    clearCache();
+    return (deleted);
+}
+
+LeaseStatsQueryPtr
+CachedLeaseMgr::startLeaseStatsQuery4() {
+    return (backend_->startLeaseStatsQuery4());
+}
+
+LeaseStatsQueryPtr
+CachedLeaseMgr::startLeaseStatsQuery6() {
+    return (backend_->startLeaseStatsQuery6());
+}
+
+size_t
+CachedLeaseMgr::wipeLeases4(const SubnetID& subnet_id) {
+    size_t deleted = 0;
+    try {
+        deleted = backend_->wipeLeases4(subnet_id);
+    } catch (...) {
+        clearCache();
+        throw;
+    }
+    clearCache();
+    return (deleted);
+}
+
+size_t
+CachedLeaseMgr::wipeLeases6(const SubnetID& subnet_id) {
+    size_t deleted = 0;
+    try {
+        deleted = backend_->wipeLeases6(subnet_id);
+    } catch (...) {
+        clearCache();
+        throw;
+    }
+    clearCache();
+    return (deleted);
+}
+
+std::string
+CachedLeaseMgr::getType() const {
+    return (backend_->getType());
+}
+
+std::string
+CachedLeaseMgr::getName() const {
+    return (backend_->getName());
+}
+
+std::string
+CachedLeaseMgr::getDescription() const {
+    return (backend_->getDescription() + " with the lease cache");
+}
+
+std::pair<uint32_t, uint32_t>
+CachedLeaseMgr::getVersion() const {
+    return (backend_->getVersion());
+}
+
+void
+CachedLeaseMgr::commit() {
+    backend_->commit();
+}
+
+void
+CachedLeaseMgr::rollback() {
+    backend_->rollback();
+    clearCache();
+}
+
+void
+CachedLeaseMgr::flushPending() {
+    backend_->flushPending();
+}
+
+uint32_t
+CachedLeaseMgr::flushDuePending() {
+    return (backend_->flushDuePending());
+}
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
@@ -0,0 +1,432 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef CACHED_LEASE_MGR_H
+#define CACHED_LEASE_MGR_H
+
+#include <asiolink/io_address.h>
+#include <dhcpsrv/database_connection.h>
+#include <dhcpsrv/lease_mgr.h>
+#include <dhcpsrv/lru_cache.h>
+#include <boost/scoped_ptr.hpp>
+#include <boost/tuple/tuple.hpp>
+#include <boost/tuple/tuple_comparison.hpp>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Invalid lease cache parameter specification.
+///
+/// Thrown when the value of the 'cache-size' or 'cache-ttl' parameter
+/// is invalid.
+class DbInvalidLeaseCache : public Exception {
+public:
+    DbInvalidLeaseCache(const char* file, size_t line, const char* what) :
+        isc::Exception(file, line, what) {}
+};
+
+/// @brief Lease manager caching the leases returned by another lease manager.
+///
+/// Each call to @c getLease4 or @c getLease6 for a given address made
+/// against the SQL backends costs a round trip to the database. The
+/// allocation engine makes many such calls when it looks for a free
+/// address in a pool which is almost full. This class is layered over
+/// any lease manager (the backend) and keeps the results of these lookups
+/// in memory, including the information that there is no lease for an
+/// address (negative caching). The subsequent lookups for the same address
+/// are served from the cache until the entry expires.
+///
+/// The leases added, updated and deleted through this lease manager update
+/// or invalidate the cached entries. The entries may become stale when
+/// another server modifies the leases in the same database, so the time
+/// to live of the entries should be short in such deployments. The cache
+/// is bounded: the least recently used entry is removed when the maximum
+/// number of entries is reached.
+///
+/// The cache holds copies of the leases and returns copies to the callers,
+/// so the callers can modify the returned leases like they do with the
+/// leases returned by the backends.
+///
+/// The numbers of lookups served from the cache and forwarded to the backend
+/// are available as the "lease-cache-hits" and "lease-cache-misses"
+/// statistics.
+///
+/// All other methods are forwarded to the backend.
+class CachedLeaseMgr : public LeaseMgr {
+public:
+
+    /// @brief Returns the maximum number of cached entries.
+    ///
+    /// The number is taken from the "cache-size" parameter. The value of
+    /// 0 (the default) disables the cache.
+    ///
+    /// @param parameters Database access parameters.
+    /// @return Maximum number of cached entries.
+    /// @throw DbInvalidLeaseCache if the value is invalid.
+    static size_t getCacheSize(const DatabaseConnection::ParameterMap&
+                               parameters);
+
+    /// @brief Returns the time to live of the cached entries.
+    ///
+    /// The time is taken from the "cache-ttl" parameter and is specified
+    /// in seconds. The default is 10 seconds. The value of 0 means that
+    /// the entries don't expire.
+    ///
+    /// @param parameters Database access parameters.
+    /// @return Time to live of the cached entries in seconds.
+    /// @throw DbInvalidLeaseCache if the value is invalid.
+    static uint32_t getCacheTtl(const DatabaseConnection::ParameterMap&
+                                parameters);
+
+    /// @brief Constructor.
+    ///
+    /// @param backend Lease manager used to access the leases. This object
+    /// takes ownership of it.
+    /// @param max_size Maximum number of cached entries. It must be greater
+    /// than 0.
+    /// @param ttl Time to live of the cached entries in seconds or 0 if the
+    /// entries don't expire.
+    CachedLeaseMgr(LeaseMgr* backend, const size_t max_size,
+                   const uint32_t ttl);
+
+    /// @brief Destructor.
+    virtual ~CachedLeaseMgr();
+
+    /// @brief Returns the lease manager used to access the leases.
+    LeaseMgr& getBackend() const {
+        return (*backend_);
+    }
+
+    /// @brief Returns the number of cached entries.
+    size_t getCacheCount() const;
+
+    /// @brief Removes all cached entries.
+    void clearCache();
+
+    /// @brief Adds an IPv4 lease.
+    ///
+    /// @param lease lease to be added
+    ///
+    /// @result true if the lease was added, false if not
+    virtual bool addLease(const Lease4Ptr& lease);
+
+    /// @brief Adds an IPv6 lease.
+    ///
+    /// @param lease lease to be added
+    ///
+    /// @result true if the lease was added, false if not
+    virtual bool addLease(const Lease6Ptr& lease);
+
+    /// @brief Adds multiple IPv4 leases.
+    ///
+    /// @param leases Leases to be added.
+    ///
+    /// @return Number of leases added.
+    virtual size_t addLeases(const Lease4Collection& leases);
+
+    /// @brief Adds multiple IPv6 leases.
+    ///
+    /// @param leases Leases to be added.
+    ///
+    /// @return Number of leases added.
+    virtual size_t addLeases(const Lease6Collection& leases);
+
+    /// @brief Returns an IPv4 lease for specified IPv4 address
+    ///
+    /// The lease is returned from the cache if it is there.
+    ///
+    /// @param addr address of the searched lease
+    ///
+    /// @return smart pointer to the lease (or NULL if a lease is not found)
+    virtual Lease4Ptr getLease4(const isc::asiolink::IOAddress& addr) const;
+
+    /// @brief Returns existing IPv4 leases for specified hardware address.
+    ///
+    /// @param hwaddr hardware address of the client
+    ///
+    /// @return lease collection
+    virtual Lease4Collection getLease4(const isc::dhcp::HWAddr& hwaddr) const;
+
+    /// @brief Returns existing IPv4 lease for specified hardware address
+    ///        and a subnet
+    ///
+    /// @param hwaddr hardware address of the client
+    /// @param subnet_id identifier of the subnet that lease must belong to
+    ///
+    /// @return a pointer to the lease (or NULL if a lease is not found)
+    virtual Lease4Ptr getLease4(const isc::dhcp::HWAddr& hwaddr,
+                                SubnetID subnet_id) const;
+
+    /// @brief Returns existing IPv4 lease for specified client-id
+    ///
+    /// @param clientid client identifier
+    ///
+    /// @return lease collection
+    virtual Lease4Collection getLease4(const ClientId& clientid) const;
+
+    /// @brief Returns existing IPv4 lease for specified client identifier,
+    /// HW address and subnet identifier.
+    ///
+    /// @param client_id Aclient identifier
+    /// @param hwaddr A HW address.
+    /// @param subnet_id A subnet identifier.
+    ///
+    /// @return A pointer to an existing lease or NULL if lease not found.
+    virtual Lease4Ptr getLease4(const ClientId& client_id,
+                                const HWAddr& hwaddr,
+                                SubnetID subnet_id) const;
+
+    /// @brief Returns existing IPv4 lease for specified client-id
+    ///
+    /// @param clientid client identifier
+    /// @param subnet_id identifier of the subnet that lease must belong to
+    ///
+    /// @return a pointer to the lease (or NULL if a lease is not found)
+    virtual Lease4Ptr getLease4(const ClientId& clientid,
+                                SubnetID subnet_id) const;
+
+    /// @brief Returns all IPv4 leases for the particular subnet identifier.
+    ///
+    /// @param subnet_id subnet identifier.
+    ///
+    /// @return Lease collection (may be empty if no IPv4 lease found).
+    virtual Lease4Collection getLeases4(SubnetID subnet_id) const;
+
+    /// @brief Returns existing IPv6 lease for a given IPv6 address.
+    ///
+    /// The lease is returned from the cache if it is there.
+    ///
+    /// @param type specifies lease type: (NA, TA or PD)
+    /// @param addr address of the searched lease
+    ///
+    /// @return smart pointer to the lease (or NULL if a lease is not found)
+    virtual Lease6Ptr getLease6(Lease::Type type,
+                                const isc::asiolink::IOAddress& addr) const;
+
+    /// @brief Returns existing IPv6 leases for a given DUID+IA combination
+    ///
+    /// @param type specifies lease type: (NA, TA or PD)
+    /// @param duid client DUID
+    /// @param iaid IA identifier
+    ///
+    /// @return Lease collection (may be empty if no lease is found)
+    virtual Lease6Collection getLeases6(Lease::Type type, const DUID& duid,
+                                        uint32_t iaid) const;
+
+    /// @brief Returns existing IPv6 lease for a given DUID+IA combination
+    ///
+    /// @param type specifies lease type: (NA, TA or PD)
+    /// @param duid client DUID
+    /// @param iaid IA identifier
+    /// @param subnet_id subnet id of the subnet the lease belongs to
+    ///
+    /// @return Lease collection (may be empty if no lease is found)
+    virtual Lease6Collection getLeases6(Lease::Type type, const DUID& duid,
+                                        uint32_t iaid,
+                                        SubnetID subnet_id) const;
+
+    /// @brief Returns a collection of expired DHCPv6 leases.
+    ///
+    /// @param [out] expired_leases A container to which expired leases
+    /// returned by the backend are appended.
+    /// @param max_leases A maximum number of leases to be returned.
+    virtual void getExpiredLeases6(Lease6Collection& expired_leases,
+                                   const size_t max_leases) const;
+
+    /// @brief Returns a collection of expired DHCPv4 leases.
+    ///
+    /// @param [out] expired_leases A container to which expired leases
+    /// returned by the backend are appended.
+    /// @param max_leases A maximum number of leases to be returned.
+    virtual void getExpiredLeases4(Lease4Collection& expired_leases,
+                                   const size_t max_leases) const;
+
+    /// @brief Updates IPv4 lease.
+    ///
+    /// @param lease4 The lease to be updated.
+    virtual void updateLease4(const Lease4Ptr& lease4);
+
+    /// @brief Updates IPv6 lease.
+    ///
+    /// @param lease6 The lease to be updated.
+    virtual void updateLease6(const Lease6Ptr& lease6);
+
+    /// @brief Updates multiple IPv4 leases.
+    ///
+    /// @param leases Leases to be updated.
+    virtual void updateLeases4(const Lease4Collection& leases);
+
+    /// @brief Updates multiple IPv6 leases.
+    ///
+    /// @param leases Leases to be updated.
+    virtual void updateLeases6(const Lease6Collection& leases);
+
+    /// @brief Deletes a lease.
+    ///
+    /// @param addr Address of the lease to be deleted.  This can be an IPv4
+    ///             address or an IPv6 address.
+    ///
+    /// @return true if a lease was deleted, false if not.
+    virtual bool deleteLease(const isc::asiolink::IOAddress& addr);
+
+    /// @brief Deletes multiple leases.
+    ///
+    /// @param addrs Addresses of the leases to be deleted.
+    ///
+    /// @return Number of leases deleted.
+    virtual size_t
+    deleteLeases(const std::vector<isc::asiolink::IOAddress>& addrs);
+
+    /// @brief Deletes all expired-reclaimed DHCPv4 leases.
+    ///
+    /// The cache is cleared because the deleted leases are not known.
+    ///
+    /// @param secs Number of seconds since expiration of leases before
+    /// they can be removed.
+    ///
+    /// @return Number of leases deleted.
+    virtual uint64_t deleteExpiredReclaimedLeases4(const uint32_t secs);
+
+    /// @brief Deletes all expired-reclaimed DHCPv6 leases.
+    ///
+    /// The cache is cleared because the deleted leases are not known.
+    ///
+    /// @param secs Number of seconds since expiration of leases before
+    /// they can be removed.
+    ///
+    /// @return Number of leases deleted.
+    virtual uint64_t deleteExpiredReclaimedLeases6(const uint32_t secs);
+
+    /// @brief Creates and runs the IPv4 lease stats query
+    ///
+    /// @return The populated query as a pointer to an LeaseStatsQuery
+    virtual LeaseStatsQueryPtr startLeaseStatsQuery4();
+
+    /// @brief Creates and runs the IPv6 lease stats query
+    ///
+    /// @return The populated query as a pointer to an LeaseStatsQuery
+    virtual LeaseStatsQueryPtr startLeaseStatsQuery6();
+
+    /// @brief Removes specified IPv4 leases.
+    ///
+    /// The cache is cleared because the deleted leases are not known.
+    ///
+    /// @param subnet_id identifier of the subnet
+    /// @return number of leases removed.
+    virtual size_t wipeLeases4(const SubnetID& subnet_id);
+
+    /// @brief Removed specified IPv6 leases.
+    ///
+    /// The cache is cleared because the deleted leases are not known.
+    ///
+    /// @param subnet_id identifier of the subnet
+    /// @return number of leases removed.
+    virtual size_t wipeLeases6(const SubnetID& subnet_id);
+
+    /// @brief Return backend type
+    ///
+    /// @return Type of the backend.
+    virtual std::string getType() const;
+
+    /// @brief Returns backend name.
+    ///
+    /// @return Name of the backend.
+    virtual std::string getName() const;
+
+    /// @brief Returns description of the backend.
+    ///
+    /// @return Description of the backend.
+    virtual std::string getDescription() const;
+
+    /// @brief Returns backend version.
+    ///
+    /// @return Version number as a pair of unsigned integers.
+    virtual std::pair<uint32_t, uint32_t> getVersion() const;
+
+    /// @brief Commit Transactions
+    virtual void commit();
+
+    /// @brief Rollback Transactions
+    ///
+    /// The cache is cleared because the rolled back changes are not known.
+    virtual void rollback();
+
+    /// @brief Writes the pending lease updates of the backend.
+    virtual void flushPending();
+
+    /// @brief Writes the pending lease updates of the backend when they
+    /// are due.
+    ///
+    /// @return Time in milliseconds after which the pending updates are
+    /// due, 0 if no updates are pending.
+    virtual uint32_t flushDuePending();
+
+private:
+
+    /// @brief Key of the cached entry.
+    ///
+    /// It holds the type and the address of the lease.
+    typedef boost::tuple<Lease::Type, isc::asiolink::IOAddress> CacheKey;
+
+    /// @brief Looks up the cached entry.
+    ///
+    /// The entry which is found is moved to the front of the LRU list.
+    /// The expired entry is removed.
+    ///
+    /// @param type Type of the lease.
+    /// @param addr Address of the lease.
+    /// @param [out] lease Copy of the cached lease or null.
+    /// @param [out] version Version of the cache when the entry was not
+    /// found. It is passed to @c insert.
+    ///
+    /// @return true if the entry was found, false otherwise.
+    bool lookup(const Lease::Type type, const isc::asiolink::IOAddress& addr,
+                LeasePtr& lease, uint64_t& version) const;
+
+    /// @brief Caches the result of the lookup made in the backend.
+    ///
+    /// The entry is not inserted when the leases have been modified since
+    /// the lookup began, because the result may be already stale.
+    ///
+    /// @param type Type of the lease.
+    /// @param addr Address of the lease.
+    /// @param lease Copy of the lease returned by the backend or null.
+    /// @param version Version returned by @c lookup.
+    void insert(const Lease::Type type, const isc::asiolink::IOAddress& addr,
+                const LeasePtr& lease, const uint64_t version) const;
+
+    /// @brief Stores the lease written to the backend.
+    ///
+    /// @param type Type of the lease.
+    /// @param lease Copy of the lease.
+    void update(const Lease::Type type, const LeasePtr& lease);
+
+    /// @brief Removes the entry for the lease.
+    ///
+    /// @param type Type of the lease.
+    /// @param addr Address of the lease.
+    void invalidate(const Lease::Type type,
+                    const isc::asiolink::IOAddress& addr);
+
+    /// @brief Removes the entries of all lease types for an address.
+    ///
+    /// @param addr Address of the leases.
+    void invalidate(const isc::asiolink::IOAddress& addr);
+
+    /// @brief Lease manager used to access the leases.
+    boost::scoped_ptr<LeaseMgr> backend_;
+
+    /// @brief The cached entries.
+    LruCache<CacheKey, LeasePtr> cache_;
+};
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
+
+#endif // CACHED_LEASE_MGR_H
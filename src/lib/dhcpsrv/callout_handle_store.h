@@ -1,4 +1,4 @@
-// Copyright (C) 2013-2015 Internet Systems Consortium, Inc. ("ISC")
+// Copyright (C) 2013-2017 Internet Systems Consortium, Inc. ("ISC")
 //
 // This Source Code Form is subject to the terms of the Mozilla Public
 // License, v. 2.0. If a copy of the MPL was not distributed with this
@@ -10,9 +10,24 @@
 #include <hooks/hooks_manager.h>
 #include <hooks/callout_handle.h>
 
+#include <utility>
+
 namespace isc {
 namespace dhcp {
 
+/// @brief Returns the stored packet pointer and CalloutHandle.
+///
+/// The stored data is declared static, so is initialized when first
+/// accessed. It is thread local, see @ref getCalloutHandle.
+///
+/// @return Reference to the pair of the pointer to the last packet seen
+///         and the pointer to its CalloutHandle.
+template <typename T>
+std::pair<T, isc::hooks::CalloutHandlePtr>& getCalloutHandleStore() {
+    static thread_local std::pair<T, isc::hooks::CalloutHandlePtr> store;
+    return (store);
+}
+
 /// @brief CalloutHandle Store
 ///
 /// When using the Hooks Framework, there is a need to associate an
@@ -32,10 +47,12 @@ namespace dhcp {
 /// CalloutHandle.  As the stored pointers are shared pointers, clearing them
 /// removes one reference that keeps the pointed-to objects in existence.
 ///
-/// @note If the behaviour of the server changes so that multiple packets can
-///       be active at the same time, this simplistic approach will no longer
-///       be adequate and a more complicated structure (such as a map) will
-///       be needed.
+/// @note The stored pointers are thread local. Each thread of the pool
+///       processing packets in the multi-threading mode processes a single
+///       request at a time, so the association is maintained per thread.
+///       The stored pointers of a thread are released when the thread
+///       terminates, e.g. when the thread pool is stopped before the
+///       hooks libraries are reloaded.
 ///
 /// @param pktptr Pointer to the packet being processed.  This is typically a
 ///        Pkt4Ptr or Pkt6Ptr object.  An empty pointer is passed to clear
@@ -49,9 +66,10 @@ namespace dhcp {
 template <typename T>
 isc::hooks::CalloutHandlePtr getCalloutHandle(const T& pktptr) {
 
-    // Stored data is declared static, so is initialized when first accessed
-    static T stored_pointer;                // Pointer to last packet seen
-    static isc::hooks::CalloutHandlePtr stored_handle;
+    std::pair<T, isc::hooks::CalloutHandlePtr>& store =
+        getCalloutHandleStore<T>();
+    T& stored_pointer = store.first;        // Pointer to last packet seen
+    isc::hooks::CalloutHandlePtr& stored_handle = store.second;
                                             // Pointer to stored handle
 
     if (pktptr) {
@@ -77,6 +95,25 @@ isc::hooks::CalloutHandlePtr getCalloutHandle(const T& pktptr) {
     return (stored_handle);
 }
 
+/// @brief Restores the association of a packet with its CalloutHandle.
+///
+/// The processing of a packet parked by the callouts is resumed later,
+/// possibly by another thread, when other packets have been processed
+/// in the meantime. The CalloutHandle used before the packet was parked
+/// is restored so the callouts called for the rest of the processing
+/// share the context with the callouts called before.
+///
+/// @param pktptr Pointer to the packet whose processing is resumed.
+/// @param handle Pointer to the CalloutHandle of the packet.
+template <typename T>
+void restoreCalloutHandle(const T& pktptr,
+                          const isc::hooks::CalloutHandlePtr& handle) {
+    std::pair<T, isc::hooks::CalloutHandlePtr>& store =
+        getCalloutHandleStore<T>();
+    store.first = pktptr;
+    store.second = handle;
+}
+
 } // namespace shcp
 } // namespace isc
 
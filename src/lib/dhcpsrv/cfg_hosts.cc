@@ -11,6 +11,9 @@
 #include <dhcpsrv/cfgmgr.h>
 #include <exceptions/exceptions.h>
 #include <util/encode/hex.h>
+#include <boost/functional/hash.hpp>
+#include <algorithm>
+#include <list>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -21,6 +24,88 @@ using namespace isc::data;
 namespace isc {
 namespace dhcp {
 
+namespace {
+
+/// @brief Compares the hosts by identifier and identifier type.
+///
+/// The identifier index of the host container is hashed, so this
+/// function is used to unparse the hosts in a stable order.
+///
+/// @param first First host to compare.
+/// @param second Second host to compare.
+/// @return true if the first host is ordered before the second one.
+bool
+hostIdentifierLess(const HostPtr& first, const HostPtr& second) {
+    if (first->getIdentifier() != second->getIdentifier()) {
+        return (first->getIdentifier() < second->getIdentifier());
+    }
+    return (first->getIdentifierType() < second->getIdentifierType());
+}
+
+/// @brief Compares the hosts by IPv4 and IPv6 subnet id.
+///
+/// The hosts having the same identifier are not ordered by the hashed
+/// identifier index, so this function is used to return them in a stable
+/// order.
+///
+/// @param first First host to compare.
+/// @param second Second host to compare.
+/// @return true if the first host is ordered before the second one.
+///
+/// @tparam HostPointerType Type of the pointer to the host.
+template<typename HostPointerType>
+bool
+hostSubnetLess(const HostPointerType& first, const HostPointerType& second) {
+    if (first->getIPv4SubnetID() != second->getIPv4SubnetID()) {
+        return (first->getIPv4SubnetID() < second->getIPv4SubnetID());
+    }
+    return (first->getIPv6SubnetID() < second->getIPv6SubnetID());
+}
+
+/// @brief Combines the hash of the options with the seed.
+///
+/// @param [out] seed Hash value to be combined with.
+/// @param options Options to be hashed.
+void
+hashOptions(size_t& seed, const OptionContainer& options) {
+    for (OptionContainer::const_iterator desc = options.begin();
+         desc != options.end(); ++desc) {
+        boost::hash_combine(seed, desc->persistent_);
+        boost::hash_combine(seed, desc->formatted_value_);
+        if (desc->option_) {
+            boost::hash_combine(seed, desc->option_->getType());
+            std::vector<uint8_t> data = desc->option_->toBinary();
+            boost::hash_range(seed, data.begin(), data.end());
+        }
+    }
+}
+
+/// @brief Returns the hash of the options held in the option data
+/// configuration.
+///
+/// @param cfg_option Option data configuration.
+/// @return Hash value. The configurations which are equal have the same
+/// hash value.
+size_t
+hashCfgOption(const CfgOption& cfg_option) {
+    size_t seed = 0;
+    std::list<std::string> spaces = cfg_option.getOptionSpaceNames();
+    for (std::list<std::string>::const_iterator space = spaces.begin();
+         space != spaces.end(); ++space) {
+        boost::hash_combine(seed, *space);
+        hashOptions(seed, *cfg_option.getAll(*space));
+    }
+    std::list<uint32_t> vendor_ids = cfg_option.getVendorIds();
+    for (std::list<uint32_t>::const_iterator vendor_id = vendor_ids.begin();
+         vendor_id != vendor_ids.end(); ++vendor_id) {
+        boost::hash_combine(seed, *vendor_id);
+        hashOptions(seed, *cfg_option.getAll(*vendor_id));
+    }
+    return (seed);
+}
+
+}
+
 ConstHostCollection
 CfgHosts::getAll(const HWAddrPtr& hwaddr, const DuidPtr& duid) const {
     // Do not issue logging message here because it will be logged by
@@ -121,8 +206,9 @@ CfgHosts::getAllInternal(const Host::IdentifierType& identifier_type,
                                                identifier_type);
 
     // Append each Host object to the storage.
-    for (HostContainerIndex0::iterator host = idx.lower_bound(t);
-         host != idx.upper_bound(t);
+    const size_t first_found = storage.size();
+    HostContainerIndex0Range r = idx.equal_range(t);
+    for (HostContainerIndex0::iterator host = r.first; host != r.second;
          ++host) {
         LOG_DEBUG(hosts_logger, HOSTS_DBG_TRACE_DETAIL_DATA,
                   HOSTS_CFG_GET_ALL_IDENTIFIER_HOST)
@@ -130,6 +216,8 @@ CfgHosts::getAllInternal(const Host::IdentifierType& identifier_type,
             .arg((*host)->toText());
         storage.push_back(*host);
     }
+    std::sort(storage.begin() + first_found, storage.end(),
+              hostSubnetLess<typename Storage::value_type>);
 
     // Log how many hosts have been found.
     LOG_DEBUG(hosts_logger, HOSTS_DBG_RESULTS, HOSTS_CFG_GET_ALL_IDENTIFIER_COUNT)
@@ -491,43 +579,40 @@ CfgHosts::getHostInternal(const SubnetID& subnet_id, const bool subnet6,
         .arg(subnet_id)
         .arg(Host::getIdentifierAsText(identifier_type, identifier, identifier_len));
 
-    // Get all hosts for a specified identifier. This may return multiple hosts
-    // for different subnets, but the number of hosts returned should be low
-    // because one host presumably doesn't show up in many subnets.
+    // Get the hosts for a specified identifier and subnet using the index
+    // for the IPv4 or IPv6 subnet.
     HostCollection hosts;
-    getAllInternal<HostCollection>(identifier_type, identifier, identifier_len,
-                                   hosts);
+    boost::tuple<const std::vector<uint8_t>, const Host::IdentifierType,
+                 const SubnetID> t =
+        boost::make_tuple(std::vector<uint8_t>(identifier,
+                                               identifier + identifier_len),
+                          identifier_type, subnet_id);
+    if (subnet6) {
+        HostContainerIndex3Range r = hosts_.get<3>().equal_range(t);
+        hosts.insert(hosts.end(), r.first, r.second);
+    } else {
+        HostContainerIndex2Range r = hosts_.get<2>().equal_range(t);
+        hosts.insert(hosts.end(), r.first, r.second);
+    }
+
+    // If there is more than one @c Host object for the same client in
+    // the subnet, it is a misconfiguration. Most likely, the administrator
+    // has specified one reservation for a HW address and another one for
+    // the DUID, which gives an ambiguous result, and we don't know which
+    // reservation we should choose. Therefore, throw an exception.
+    if (hosts.size() > 1) {
+        isc_throw(DuplicateHost,  "more than one reservation found"
+                  " for the host belonging to the subnet with id '"
+                  << subnet_id << "' and using the identifier '"
+                  << Host::getIdentifierAsText(identifier_type,
+                                               identifier,
+                                               identifier_len)
+                  << "'");
+    }
 
     HostPtr host;
-    // Iterate over the returned hosts and select those for which the
-    // subnet id matches.
-    for (HostCollection::const_iterator host_it = hosts.begin();
-         host_it != hosts.end(); ++host_it) {
-        // Check if this is IPv4 subnet or IPv6 subnet.
-        SubnetID host_subnet_id = subnet6 ? (*host_it)->getIPv6SubnetID() :
-            (*host_it)->getIPv4SubnetID();
-
-        if (subnet_id == host_subnet_id) {
-            // If this is the first occurrence of the host for this subnet,
-            // remember it. But, if we find that this is second @c Host object
-            // for the same client, it is a misconfiguration. Most likely,
-            // the administrator has specified one reservation for a HW
-            // address and another one for the DUID, which gives an ambiguous
-            // result, and we don't know which reservation we should choose.
-            // Therefore, throw an exception.
-            if (!host) {
-                host = *host_it;
-
-            } else {
-                isc_throw(DuplicateHost,  "more than one reservation found"
-                          " for the host belonging to the subnet with id '"
-                          << subnet_id << "' and using the identifier '"
-                          << Host::getIdentifierAsText(identifier_type,
-                                                       identifier,
-                                                       identifier_len)
-                          << "'");
-            }
-        }
+    if (!hosts.empty()) {
+        host = hosts.front();
     }
 
     if (host) {
@@ -569,6 +654,25 @@ CfgHosts::add(const HostPtr& host) {
     add4(host);
 
     add6(host);
+
+    // Share the option data configurations with the identical ones of
+    // the hosts added before.
+    host->setCfgOption4(shareCfgOption(host->getCfgOption4()));
+    host->setCfgOption6(shareCfgOption(host->getCfgOption6()));
+}
+
+CfgOptionPtr
+CfgHosts::shareCfgOption(const CfgOptionPtr& cfg_option) {
+    size_t hash = hashCfgOption(*cfg_option);
+    typedef std::multimap<size_t, CfgOptionPtr>::const_iterator Iterator;
+    std::pair<Iterator, Iterator> range = cfg_options_.equal_range(hash);
+    for (Iterator shared = range.first; shared != range.second; ++shared) {
+        if (shared->second->equals(*cfg_option)) {
+            return (shared->second);
+        }
+    }
+    cfg_options_.insert(std::make_pair(hash, cfg_option));
+    return (cfg_option);
 }
 
 void
@@ -731,10 +835,11 @@ CfgHosts::toElement() const {
 ElementPtr
 CfgHosts::toElement4() const {
     CfgHostsList result;
-    // Iterate using arbitrary the index 0
-    const HostContainerIndex0& idx = hosts_.get<0>();
-    for (HostContainerIndex0::const_iterator host = idx.begin();
-         host != idx.end(); ++host) {
+    // The hosts are unparsed ordered by identifier.
+    std::vector<HostPtr> hosts(hosts_.begin(), hosts_.end());
+    std::sort(hosts.begin(), hosts.end(), hostIdentifierLess);
+    for (std::vector<HostPtr>::const_iterator host = hosts.begin();
+         host != hosts.end(); ++host) {
 
         // Convert host to element representation
         ElementPtr map = (*host)->toElement4();
@@ -749,10 +854,11 @@ CfgHosts::toElement4() const {
 ElementPtr
 CfgHosts::toElement6() const {
     CfgHostsList result;
-    // Iterate using arbitrary the index 0
-    const HostContainerIndex0& idx = hosts_.get<0>();
-    for (HostContainerIndex0::const_iterator host = idx.begin();
-         host != idx.end(); ++host) {
+    // The hosts are unparsed ordered by identifier.
+    std::vector<HostPtr> hosts(hosts_.begin(), hosts_.end());
+    std::sort(hosts.begin(), hosts.end(), hostIdentifierLess);
+    for (std::vector<HostPtr>::const_iterator host = hosts.begin();
+         host != hosts.end(); ++host) {
 
         // Convert host to Element representation
         ElementPtr map = (*host)->toElement6();
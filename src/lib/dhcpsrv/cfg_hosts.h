@@ -12,11 +12,13 @@
 #include <dhcp/duid.h>
 #include <dhcp/hwaddr.h>
 #include <dhcpsrv/base_host_data_source.h>
+#include <dhcpsrv/cfg_option.h>
 #include <dhcpsrv/host.h>
 #include <dhcpsrv/host_container.h>
 #include <dhcpsrv/subnet_id.h>
 #include <dhcpsrv/writable_host_data_source.h>
 #include <boost/shared_ptr.hpp>
+#include <map>
 #include <vector>
 
 namespace isc {
@@ -316,6 +318,12 @@ public:
 
     /// @brief Adds a new host to the collection.
     ///
+    /// The option data configurations of the host are replaced with the
+    /// identical configurations of the hosts added before, if any, to
+    /// save memory when many hosts are configured. Therefore, the option
+    /// data configurations of the host must not be modified after it has
+    /// been added.
+    ///
     /// @param host Pointer to the new @c Host object being added.
     ///
     /// @throw DuplicateHost If a host for a particular HW address or DUID
@@ -541,6 +549,15 @@ private:
     /// the IPv6 subnet.
     virtual void add6(const HostPtr& host);
 
+    /// @brief Returns the option data configuration shared by the hosts.
+    ///
+    /// @param cfg_option Option data configuration of the host being added.
+    ///
+    /// @return Option data configuration identical to the specified one,
+    /// used by the hosts added before, or the specified one if there is
+    /// no such configuration.
+    CfgOptionPtr shareCfgOption(const CfgOptionPtr& cfg_option);
+
     /// @brief Multi-index container holding @c Host objects.
     ///
     /// It can be used for finding hosts by the following criteria:
@@ -556,6 +573,10 @@ private:
     /// - IPv6 prefix
     HostContainer6 hosts6_;
 
+    /// @brief Option data configurations shared by the hosts, by hash of
+    /// their contents.
+    std::multimap<size_t, CfgOptionPtr> cfg_options_;
+
     /// @brief Unparse a configuration object (DHCPv4 reservations)
     ///
     /// @return a pointer to unparsed configuration
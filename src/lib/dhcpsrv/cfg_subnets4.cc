@@ -22,6 +22,12 @@ using namespace isc::data;
 namespace isc {
 namespace dhcp {
 
+CfgSubnets4::CfgSubnets4()
+    : subnets_(), indexed_(false), prefix_index_(), relay_index_(),
+      iface_index_(), prefix4o6_index_(), interface_id4o6_index_(),
+      iface4o6_index_() {
+}
+
 void
 CfgSubnets4::add(const Subnet4Ptr& subnet) {
     if (getBySubnetId(subnet->getID())) {
@@ -38,6 +44,12 @@ CfgSubnets4::add(const Subnet4Ptr& subnet) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE, DHCPSRV_CFGMGR_ADD_SUBNET4)
               .arg(subnet->toText());
     subnets_.push_back(subnet);
+
+    // The index is built when the configuration is committed. If it
+    // already exists, the subnet must be added to it.
+    if (indexed_) {
+        buildSelectionIndex();
+    }
 }
 
 void
@@ -50,10 +62,85 @@ CfgSubnets4::del(const ConstSubnet4Ptr& subnet) {
     }
     index.erase(subnet_it);
 
+    // Removing the subnet changes the positions of the following ones.
+    if (indexed_) {
+        buildSelectionIndex();
+    }
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE, DHCPSRV_CFGMGR_DEL_SUBNET4)
         .arg(subnet->toText());
 }
 
+void
+CfgSubnets4::buildSelectionIndex() {
+    prefix_index_.clear();
+    relay_index_.clear();
+    iface_index_.clear();
+    prefix4o6_index_.clear();
+    interface_id4o6_index_.clear();
+    iface4o6_index_.clear();
+
+    for (size_t position = 0; position < subnets_.size(); ++position) {
+        const Subnet4Ptr& subnet = subnets_[position];
+        std::pair<IOAddress, uint8_t> prefix = subnet->get();
+        prefix_index_.add(prefix.first, prefix.second, position);
+
+        // The subnet specific relay address and interface name take
+        // precedence over the shared network specific ones. This must
+        // be consistent with the selection without the index.
+        SharedNetwork4Ptr network;
+        subnet->getSharedNetwork(network);
+
+        if (!subnet->getRelayInfo().addr_.isV4Zero()) {
+            relay_index_[subnet->getRelayInfo().addr_].push_back(position);
+
+        } else if (network && !network->getRelayInfo().addr_.isV4Zero()) {
+            relay_index_[network->getRelayInfo().addr_].push_back(position);
+        }
+
+        if (!subnet->getIface().empty()) {
+            iface_index_[subnet->getIface()].push_back(position);
+
+        } else if (network && !network->getIface().empty()) {
+            iface_index_[network->getIface()].push_back(position);
+        }
+
+        Cfg4o6& cfg4o6 = subnet->get4o6();
+        if (!cfg4o6.enabled()) {
+            continue;
+        }
+
+        std::pair<IOAddress, uint8_t> pref = cfg4o6.getSubnet4o6();
+        if (!pref.first.isV6Zero()) {
+            prefix4o6_index_.add(pref.first, pref.second, position);
+        }
+
+        if (cfg4o6.getInterfaceId()) {
+            interface_id4o6_index_[cfg4o6.getInterfaceId()->getData()].
+                push_back(position);
+        }
+
+        if (!cfg4o6.getIface4o6().empty()) {
+            iface4o6_index_[cfg4o6.getIface4o6()].push_back(position);
+        }
+    }
+
+    indexed_ = true;
+}
+
+Subnet4Ptr
+CfgSubnets4::selectSupported(const std::vector<size_t>& positions,
+                             const ClientClasses& client_classes) const {
+    for (auto position = positions.cbegin(); position != positions.cend();
+         ++position) {
+        const Subnet4Ptr& subnet = subnets_[*position];
+        if (subnet->clientSupported(client_classes)) {
+            return (subnet);
+        }
+    }
+    return (Subnet4Ptr());
+}
+
 ConstSubnet4Ptr
 CfgSubnets4::getBySubnetId(const SubnetID& subnet_id) const {
     const auto& index = subnets_.get<SubnetSubnetIdIndexTag>();
@@ -71,6 +158,44 @@ CfgSubnets4::getByPrefix(const std::string& subnet_text) const {
 Subnet4Ptr
 CfgSubnets4::selectSubnet4o6(const SubnetSelector& selector) const {
 
+    if (indexed_) {
+        // The subnet matching any of the criteria is selected, so take
+        // the first one in the configuration order across all indexes.
+        size_t selected = subnets_.size();
+
+        std::vector<size_t> positions;
+        prefix4o6_index_.find(selector.remote_address_, positions);
+        if (!positions.empty()) {
+            selected = positions.front();
+        }
+
+        if (selector.interface_id_) {
+            auto found =
+                interface_id4o6_index_.find(selector.interface_id_->getData());
+            if (found != interface_id4o6_index_.end()) {
+                for (auto position = found->second.cbegin();
+                     (position != found->second.cend()) && (*position < selected);
+                     ++position) {
+                    if (subnets_[*position]->get4o6().getInterfaceId()->
+                        equals(selector.interface_id_)) {
+                        selected = *position;
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (!selector.iface_name_.empty()) {
+            auto found = iface4o6_index_.find(selector.iface_name_);
+            if ((found != iface4o6_index_.end()) &&
+                (found->second.front() < selected)) {
+                selected = found->second.front();
+            }
+        }
+
+        return (selected < subnets_.size() ? subnets_[selected] : Subnet4Ptr());
+    }
+
     for (Subnet4Collection::const_iterator subnet = subnets_.begin();
          subnet != subnets_.end(); ++subnet) {
         Cfg4o6& cfg4o6 = (*subnet)->get4o6();
@@ -124,7 +249,17 @@ CfgSubnets4::selectSubnet(const SubnetSelector& selector) const {
     // possible that the relay address will not match with any of the relay
     // addresses across all subnets, but we need to verify that for all subnets
     // before we can try to use the giaddr to match with the subnet prefix.
-    if (!selector.giaddr_.isV4Zero()) {
+    if (!selector.giaddr_.isV4Zero() && indexed_) {
+        auto found = relay_index_.find(selector.giaddr_);
+        if (found != relay_index_.end()) {
+            Subnet4Ptr subnet = selectSupported(found->second,
+                                                selector.client_classes_);
+            if (subnet) {
+                return (subnet);
+            }
+        }
+
+    } else if (!selector.giaddr_.isV4Zero()) {
         for (Subnet4Collection::const_iterator subnet = subnets_.begin();
              subnet != subnets_.end(); ++subnet) {
 
@@ -212,6 +347,21 @@ CfgSubnets4::selectSubnet(const SubnetSelector& selector) const {
 Subnet4Ptr
 CfgSubnets4::selectSubnet(const std::string& iface,
                           const ClientClasses& client_classes) const {
+    if (indexed_) {
+        auto found = iface_index_.find(iface);
+        if (found != iface_index_.end()) {
+            Subnet4Ptr subnet = selectSupported(found->second, client_classes);
+            if (subnet) {
+                LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE,
+                          DHCPSRV_CFGMGR_SUBNET4_IFACE)
+                    .arg(subnet->toText())
+                    .arg(iface);
+            }
+            return (subnet);
+        }
+        return (Subnet4Ptr());
+    }
+
     for (Subnet4Collection::const_iterator subnet = subnets_.begin();
          subnet != subnets_.end(); ++subnet) {
 
@@ -268,6 +418,18 @@ CfgSubnets4::getSubnet(const SubnetID id) const {
 Subnet4Ptr
 CfgSubnets4::selectSubnet(const IOAddress& address,
                  const ClientClasses& client_classes) const {
+    if (indexed_) {
+        std::vector<size_t> positions;
+        prefix_index_.find(address, positions);
+        Subnet4Ptr subnet = selectSupported(positions, client_classes);
+        if (subnet) {
+            LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE, DHCPSRV_CFGMGR_SUBNET4_ADDR)
+                .arg(subnet->toText())
+                .arg(address.toText());
+        }
+        return (subnet);
+    }
+
     for (Subnet4Collection::const_iterator subnet = subnets_.begin();
          subnet != subnets_.end(); ++subnet) {
 
@@ -20,6 +20,11 @@ using namespace isc::data;
 namespace isc {
 namespace dhcp {
 
+CfgSubnets6::CfgSubnets6()
+    : subnets_(), indexed_(false), prefix_index_(), relay_index_(),
+      iface_index_(), interface_id_index_() {
+}
+
 void
 CfgSubnets6::add(const Subnet6Ptr& subnet) {
     if (getBySubnetId(subnet->getID())) {
@@ -36,6 +41,12 @@ CfgSubnets6::add(const Subnet6Ptr& subnet) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE, DHCPSRV_CFGMGR_ADD_SUBNET6)
               .arg(subnet->toText());
     subnets_.push_back(subnet);
+
+    // The index is built when the configuration is committed. If it
+    // already exists, the subnet must be added to it.
+    if (indexed_) {
+        buildSelectionIndex();
+    }
 }
 
 void
@@ -48,10 +59,57 @@ CfgSubnets6::del(const ConstSubnet6Ptr& subnet) {
     }
     index.erase(subnet_it);
 
+    // Removing the subnet changes the positions of the following ones.
+    if (indexed_) {
+        buildSelectionIndex();
+    }
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE, DHCPSRV_CFGMGR_DEL_SUBNET6)
         .arg(subnet->toText());
 }
 
+void
+CfgSubnets6::buildSelectionIndex() {
+    prefix_index_.clear();
+    relay_index_.clear();
+    iface_index_.clear();
+    interface_id_index_.clear();
+
+    for (size_t position = 0; position < subnets_.size(); ++position) {
+        const Subnet6Ptr& subnet = subnets_[position];
+        std::pair<IOAddress, uint8_t> prefix = subnet->get();
+        prefix_index_.add(prefix.first, prefix.second, position);
+
+        // The unspecified relay address is indexed too, so the lookup
+        // returns the same subnets as the full scan for any address.
+        relay_index_[subnet->getRelayInfo().addr_].push_back(position);
+
+        if (!subnet->getIface().empty()) {
+            iface_index_[subnet->getIface()].push_back(position);
+        }
+
+        if (subnet->getInterfaceId()) {
+            interface_id_index_[subnet->getInterfaceId()->getData()].
+                push_back(position);
+        }
+    }
+
+    indexed_ = true;
+}
+
+Subnet6Ptr
+CfgSubnets6::selectSupported(const std::vector<size_t>& positions,
+                             const ClientClasses& client_classes) const {
+    for (auto position = positions.cbegin(); position != positions.cend();
+         ++position) {
+        const Subnet6Ptr& subnet = subnets_[*position];
+        if (subnet->clientSupported(client_classes)) {
+            return (subnet);
+        }
+    }
+    return (Subnet6Ptr());
+}
+
 ConstSubnet6Ptr
 CfgSubnets6::getBySubnetId(const SubnetID& subnet_id) const {
     const auto& index = subnets_.get<SubnetSubnetIdIndexTag>();
@@ -110,6 +168,31 @@ CfgSubnets6::selectSubnet(const asiolink::IOAddress& address,
                           const ClientClasses& client_classes,
                           const bool is_relay_address) const {
 
+    if (indexed_) {
+        Subnet6Ptr subnet;
+        if (is_relay_address) {
+            auto found = relay_index_.find(address);
+            if (found != relay_index_.end()) {
+                subnet = selectSupported(found->second, client_classes);
+            }
+            if (subnet) {
+                LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE,
+                          DHCPSRV_CFGMGR_SUBNET6_RELAY)
+                    .arg(subnet->toText()).arg(address.toText());
+                return (subnet);
+            }
+        }
+
+        std::vector<size_t> positions;
+        prefix_index_.find(address, positions);
+        subnet = selectSupported(positions, client_classes);
+        if (subnet) {
+            LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE, DHCPSRV_CFGMGR_SUBNET6)
+                      .arg(subnet->toText()).arg(address.toText());
+        }
+        return (subnet);
+    }
+
     // If the specified address is a relay address we first need to match
     // it with the relay addresses specified for all subnets.
     if (is_relay_address) {
@@ -151,7 +234,19 @@ CfgSubnets6::selectSubnet(const std::string& iface_name,
                           const ClientClasses& client_classes) const {
 
     // If empty interface specified, we can't select subnet by interface.
-    if (!iface_name.empty()) {
+    if (!iface_name.empty() && indexed_) {
+        auto found = iface_index_.find(iface_name);
+        if (found != iface_index_.end()) {
+            Subnet6Ptr subnet = selectSupported(found->second, client_classes);
+            if (subnet) {
+                LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE,
+                          DHCPSRV_CFGMGR_SUBNET6_IFACE)
+                    .arg(subnet->toText()).arg(iface_name);
+            }
+            return (subnet);
+        }
+
+    } else if (!iface_name.empty()) {
         for (Subnet6Collection::const_iterator subnet = subnets_.begin();
              subnet != subnets_.end(); ++subnet) {
 
@@ -178,7 +273,26 @@ CfgSubnets6::selectSubnet(const OptionPtr& interface_id,
                           const ClientClasses& client_classes) const {
     // We can only select subnet using an interface id, if the interface
     // id is known.
-    if (interface_id) {
+    if (interface_id && indexed_) {
+        auto found = interface_id_index_.find(interface_id->getData());
+        if (found != interface_id_index_.end()) {
+            // The index is keyed by the option data only, so the whole
+            // option must still be compared.
+            for (auto position = found->second.cbegin();
+                 position != found->second.cend(); ++position) {
+                const Subnet6Ptr& subnet = subnets_[*position];
+                if (subnet->getInterfaceId()->equals(interface_id) &&
+                    subnet->clientSupported(client_classes)) {
+
+                    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE,
+                              DHCPSRV_CFGMGR_SUBNET6_IFACE_ID)
+                        .arg(subnet->toText());
+                    return (subnet);
+                }
+            }
+        }
+
+    } else if (interface_id) {
         for (Subnet6Collection::const_iterator subnet = subnets_.begin();
              subnet != subnets_.end(); ++subnet) {
 
@@ -12,10 +12,14 @@
 #include <cc/cfg_to_element.h>
 #include <dhcpsrv/subnet.h>
 #include <dhcpsrv/subnet_id.h>
+#include <dhcpsrv/subnet_prefix_index.h>
 #include <dhcpsrv/subnet_selector.h>
 #include <util/optional_value.h>
 #include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+#include <stdint.h>
 #include <string>
+#include <vector>
 
 namespace isc {
 namespace dhcp {
@@ -32,6 +36,9 @@ namespace dhcp {
 class CfgSubnets6 : public isc::data::CfgToElement {
 public:
 
+    /// @brief Constructor.
+    CfgSubnets6();
+
     /// @brief Adds new subnet to the configuration.
     ///
     /// @param subnet Pointer to the subnet being added.
@@ -115,13 +122,9 @@ public:
     /// associated with any subnet. If not, it is checked if the link address
     /// is in range with any of the subnets.
     ///
-    /// @todo This method requires performance improvement! It currently
-    /// iterates over all existing subnets (possibly a couple of times)
-    /// to find the one which fulfills the search criteria. The subnet storage
-    /// is implemented as a simple STL vector which precludes fast searches
-    /// using specific keys. Hence, full scan is required. To improve the
-    /// search performance a different container type is required, e.g.
-    /// multi-index container, or something of a similar functionality.
+    /// This method uses the selection index if it has been built with
+    /// @c buildSelectionIndex. Otherwise, it iterates over all existing
+    /// subnets.
     ///
     /// @param selector Const reference to the selector structure which holds
     /// various information extracted from the client's packet which are used
@@ -156,13 +159,9 @@ public:
     /// address. For other purposes the @c selectSubnet(SubnetSelector) should
     /// rather be used instead.
     ///
-    /// @todo This method requires performance improvement! It currently
-    /// iterates over all existing subnets (possibly a couple of times)
-    /// to find the one which fulfills the search criteria. The subnet storage
-    /// is implemented as a simple STL vector which precludes fast searches
-    /// using specific keys. Hence, full scan is required. To improve the
-    /// search performance a different container type is required, e.g.
-    /// multi-index container, or something of a similar functionality.
+    /// This method uses the selection index if it has been built with
+    /// @c buildSelectionIndex. Otherwise, it iterates over all existing
+    /// subnets.
     ///
     /// @param address Address for which the subnet is searched.
     /// @param client_classes Optional parameter specifying the classes that
@@ -176,6 +175,27 @@ public:
                  const ClientClasses& client_classes = ClientClasses(),
                  const bool is_relay_address = false) const;
 
+    /// @brief Builds the index used for the subnet selection.
+    ///
+    /// The subnet selection methods iterate over all subnets unless this
+    /// index is built. The index maps the prefixes, the relay addresses,
+    /// the interface names and the interface identifiers of the subnets
+    /// to the positions of the subnets, so the selection cost doesn't
+    /// depend on the number of subnets. The first matching subnet in the
+    /// configuration order is still returned.
+    ///
+    /// This method is called when the configuration is committed. The
+    /// index reflects the subnet parameters at the time it is built.
+    /// Subsequent additions and removals of subnets rebuild it, but the
+    /// modifications of the subnets already held in this object do not,
+    /// so they must be followed by another call to this method.
+    void buildSelectionIndex();
+
+    /// @brief Checks if the selection index has been built.
+    bool hasSelectionIndex() const {
+        return (indexed_);
+    }
+
     /// @brief Updates statistics.
     ///
     /// This method updates statistics that are affected by the newly committed
@@ -206,13 +226,9 @@ private:
     /// If any of the subnets is explicitly associated with the interface
     /// name, the subnet is returned.
     ///
-    /// @todo This method requires performance improvement! It currently
-    /// iterates over all existing subnets to find the one which fulfills
-    /// the search criteria. The subnet storage is implemented as a
-    /// simple STL vector which precludes fast searches using specific
-    /// keys. Hence, full scan is required. To improve the search
-    /// performance a different container type is required, e.g.
-    /// multi-index container, or something of a similar functionality.
+    /// This method uses the selection index if it has been built with
+    /// @c buildSelectionIndex. Otherwise, it iterates over all existing
+    /// subnets.
     ///
     /// @param iface_name Interface name.
     /// @param client_classes Optional parameter specifying the classes that
@@ -230,13 +246,9 @@ private:
     /// of the subnets is explicitly associated with that interface id, the
     /// subnet is returned.
     ///
-    /// @todo This method requires performance improvement! It currently
-    /// iterates over all existing subnets to find the one which fulfills
-    /// the search criteria. The subnet storage is implemented as a
-    /// simple STL vector which precludes fast searches using specific
-    /// keys. Hence, full scan is required. To improve the search
-    /// performance a different container type is required, e.g.
-    /// multi-index container, or something of a similar functionality.
+    /// This method uses the selection index if it has been built with
+    /// @c buildSelectionIndex. Otherwise, it iterates over all existing
+    /// subnets.
     ///
     /// @param interface_id An instance of the Interface ID option received
     /// from the client.
@@ -248,9 +260,46 @@ private:
     selectSubnet(const OptionPtr& interface_id,
                  const ClientClasses& client_classes) const;
 
+    /// @brief Returns the first subnet which the client is allowed to use.
+    ///
+    /// @param positions Positions of the candidate subnets in the
+    /// ascending order.
+    /// @param client_classes Classes that the client belongs to.
+    ///
+    /// @return Pointer to the selected subnet or NULL if no subnet found.
+    Subnet6Ptr selectSupported(const std::vector<size_t>& positions,
+                               const ClientClasses& client_classes) const;
+
     /// @brief A container for IPv6 subnets.
     Subnet6Collection subnets_;
 
+    /// @brief Positions of the subnets keyed by a string.
+    typedef boost::unordered_map<std::string, std::vector<size_t> >
+    PositionsByName;
+
+    /// @brief Positions of the subnets keyed by an address.
+    typedef boost::unordered_map<asiolink::IOAddress, std::vector<size_t> >
+    PositionsByAddress;
+
+    /// @brief Positions of the subnets keyed by a binary identifier.
+    typedef boost::unordered_map<std::vector<uint8_t>, std::vector<size_t> >
+    PositionsByIdentifier;
+
+    /// @brief Indicates if the selection index has been built.
+    bool indexed_;
+
+    /// @brief Index of the subnet prefixes.
+    SubnetPrefixIndex prefix_index_;
+
+    /// @brief Index of the subnet relay addresses.
+    PositionsByAddress relay_index_;
+
+    /// @brief Index of the subnet interface names.
+    PositionsByName iface_index_;
+
+    /// @brief Index of the subnet interface identifiers.
+    PositionsByIdentifier interface_id_index_;
+
 };
 
 /// @name Pointer to the @c CfgSubnets6 objects.
@@ -105,6 +105,11 @@ CfgMgr::commit() {
         }
     }
 
+    // The committed configuration is used for the subnet selection,
+    // so build the indexes speeding it up.
+    configuration_->getCfgSubnets4()->buildSelectionIndex();
+    configuration_->getCfgSubnets6()->buildSelectionIndex();
+
     // Now we need to set the statistics back.
     configuration_->updateStatistics();
 }
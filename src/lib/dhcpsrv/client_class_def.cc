@@ -33,6 +33,8 @@ ClientClassDef::ClientClassDef(const std::string& name,
     if (!cfg_option_) {
         cfg_option_.reset(new CfgOption());
     }
+
+    compileMatchExpr();
 }
 
 ClientClassDef::ClientClassDef(const ClientClassDef& rhs)
@@ -43,6 +45,7 @@ ClientClassDef::ClientClassDef(const ClientClassDef& rhs)
     if (rhs.match_expr_) {
         match_expr_.reset(new Expression());
         *match_expr_ = *(rhs.match_expr_);
+        compileMatchExpr();
     }
 
     if (rhs.cfg_option_def_) {
@@ -79,6 +82,23 @@ ClientClassDef::getMatchExpr() const {
 void
 ClientClassDef::setMatchExpr(const ExpressionPtr& match_expr) {
     match_expr_ = match_expr;
+    compileMatchExpr();
+}
+
+const CompiledExpressionPtr&
+ClientClassDef::getCompiledMatchExpr() const {
+    return (compiled_match_expr_);
+}
+
+void
+ClientClassDef::compileMatchExpr() {
+    compiled_match_expr_.reset();
+    if (match_expr_) {
+        try {
+            compiled_match_expr_.reset(new CompiledExpression(*match_expr_));
+        } catch (const EvalBadStack&) {
+        }
+    }
 }
 
 std::string
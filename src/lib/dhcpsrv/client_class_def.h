@@ -10,6 +10,7 @@
 #include <cc/cfg_to_element.h>
 #include <dhcpsrv/cfg_option.h>
 #include <dhcpsrv/cfg_option_def.h>
+#include <eval/compiled_expression.h>
 #include <eval/token.h>
 #include <exceptions/exceptions.h>
 
@@ -72,6 +73,13 @@ public:
     /// @param match_expr the expression to assign the class
     void setMatchExpr(const ExpressionPtr& match_expr);
 
+    /// @brief Fetches the compiled form of the class's match expression
+    ///
+    /// @return pointer to the compiled expression or null if the class
+    /// has no match expression or it could not be compiled. In the
+    /// latter case the match expression should be evaluated instead.
+    const CompiledExpressionPtr& getCompiledMatchExpr() const;
+
     /// @brief Fetches the class's original match expression
     std::string getTest() const;
 
@@ -169,6 +177,12 @@ public:
     virtual isc::data::ElementPtr toElement() const;
 
 private:
+    /// @brief Compiles the match expression.
+    ///
+    /// The malformed expressions are left for the evaluation of the
+    /// tokens to report.
+    void compileMatchExpr();
+
     /// @brief Unique text identifier by which this class is known.
     std::string name_;
 
@@ -176,6 +190,9 @@ private:
     /// this class.
     ExpressionPtr match_expr_;
 
+    /// @brief The compiled form of the match expression.
+    CompiledExpressionPtr compiled_match_expr_;
+
     /// @brief The original expression which determines membership in
     /// this class.
     std::string test_;
@@ -0,0 +1,123 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <dhcp/dhcp4.h>
+#include <dhcp/duid.h>
+#include <dhcp/hwaddr.h>
+#include <dhcpsrv/client_handler.h>
+#include <util/threads/multi_threading_mgr.h>
+#include <set>
+
+using namespace isc::util::thread;
+
+namespace {
+
+/// @brief Prefix of the keys holding a DHCPv4 client identifier.
+const uint8_t KEY_CLIENT_ID = 0;
+
+/// @brief Prefix of the keys holding a hardware address.
+const uint8_t KEY_HWADDR = 1;
+
+/// @brief Prefix of the keys holding a DUID.
+const uint8_t KEY_DUID = 2;
+
+/// @brief Returns the mutex protecting the set of clients.
+Mutex& getClientsMutex() {
+    static Mutex mutex;
+    return (mutex);
+}
+
+/// @brief Returns the set of clients being processed.
+std::set<std::vector<uint8_t> >& getClients() {
+    static std::set<std::vector<uint8_t> > clients;
+    return (clients);
+}
+
+/// @brief Creates a key from the prefix and the identifier.
+///
+/// @param prefix Type of the identifier.
+/// @param id Identifier.
+/// @return Key of the client.
+std::vector<uint8_t>
+makeKey(const uint8_t prefix, const std::vector<uint8_t>& id) {
+    std::vector<uint8_t> key;
+    key.reserve(id.size() + 1);
+    key.push_back(prefix);
+    key.insert(key.end(), id.begin(), id.end());
+    return (key);
+}
+
+} // end of anonymous namespace
+
+namespace isc {
+namespace dhcp {
+
+ClientHandler::ClientHandler()
+    : key_(), locked_(false) {
+}
+
+ClientHandler::~ClientHandler() {
+    if (locked_) {
+        Mutex::Locker lock(getClientsMutex());
+        getClients().erase(key_);
+    }
+}
+
+bool
+ClientHandler::tryLock(const Pkt4Ptr& query) {
+    if (!query || !MultiThreadingMgr::instance().getMode()) {
+        return (true);
+    }
+
+    std::vector<uint8_t> key;
+    OptionPtr client_id = query->getOption(DHO_DHCP_CLIENT_IDENTIFIER);
+    if (client_id && !client_id->getData().empty()) {
+        key = makeKey(KEY_CLIENT_ID, client_id->getData());
+
+    } else {
+        HWAddrPtr hwaddr = query->getHWAddr();
+        if (hwaddr && !hwaddr->hwaddr_.empty()) {
+            key = makeKey(KEY_HWADDR, hwaddr->hwaddr_);
+        }
+    }
+    return (tryLockInternal(key));
+}
+
+bool
+ClientHandler::tryLock(const Pkt6Ptr& query) {
+    if (!query || !MultiThreadingMgr::instance().getMode()) {
+        return (true);
+    }
+
+    std::vector<uint8_t> key;
+    DuidPtr duid = query->getClientId();
+    if (duid) {
+        key = makeKey(KEY_DUID, duid->getDuid());
+    }
+    return (tryLockInternal(key));
+}
+
+bool
+ClientHandler::tryLockInternal(const std::vector<uint8_t>& key) {
+    // The packets without client identification can't be serialized.
+    // They are rejected later by the server anyway.
+    if (key.empty() || locked_) {
+        return (true);
+    }
+
+    Mutex::Locker lock(getClientsMutex());
+    if (!getClients().insert(key).second) {
+        return (false);
+    }
+    key_ = key;
+    locked_ = true;
+    return (true);
+}
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
@@ -0,0 +1,84 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef CLIENT_HANDLER_H
+#define CLIENT_HANDLER_H
+
+#include <dhcp/pkt4.h>
+#include <dhcp/pkt6.h>
+#include <boost/noncopyable.hpp>
+#include <stdint.h>
+#include <vector>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Serializes the processing of the packets sent by the same client.
+///
+/// In the multi-threading mode the packets are processed concurrently
+/// by the threads of the pool. Two packets sent by the same client, e.g.
+/// a retransmitted request, must not be processed at the same time
+/// because they would compete for the same lease. The server creates
+/// an object of this class for each processed packet and calls
+/// @c tryLock before the lease allocation. If another packet of the
+/// same client is being processed, the call fails and the server drops
+/// the packet: the client will retransmit it later if needed.
+///
+/// The client is identified by the client identifier or the hardware
+/// address in DHCPv4 and by the DUID in DHCPv6. The client is released
+/// when the object is destroyed.
+///
+/// When the multi-threading mode is disabled, the packets are processed
+/// one at a time and @c tryLock always succeeds without registering the
+/// client.
+class ClientHandler : public boost::noncopyable {
+public:
+
+    /// @brief Constructor.
+    ClientHandler();
+
+    /// @brief Destructor.
+    ///
+    /// Releases the client if it has been locked by this object.
+    ~ClientHandler();
+
+    /// @brief Tries to lock the client which sent a DHCPv4 query.
+    ///
+    /// @param query DHCPv4 query.
+    ///
+    /// @return false if another query of the same client is being
+    /// processed, true otherwise.
+    bool tryLock(const Pkt4Ptr& query);
+
+    /// @brief Tries to lock the client which sent a DHCPv6 query.
+    ///
+    /// @param query DHCPv6 query.
+    ///
+    /// @return false if another query of the same client is being
+    /// processed, true otherwise.
+    bool tryLock(const Pkt6Ptr& query);
+
+private:
+
+    /// @brief Tries to register the client.
+    ///
+    /// @param key Key identifying the client. An empty key is never
+    /// registered and the method returns true.
+    ///
+    /// @return false if the client is already registered, true otherwise.
+    bool tryLockInternal(const std::vector<uint8_t>& key);
+
+    /// @brief Key of the client locked by this object.
+    std::vector<uint8_t> key_;
+
+    /// @brief Indicates if the client has been locked by this object.
+    bool locked_;
+};
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
+
+#endif // CLIENT_HANDLER_H
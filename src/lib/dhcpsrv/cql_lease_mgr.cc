@@ -20,6 +20,7 @@
 #include <dhcp/hwaddr.h>
 #include <dhcpsrv/dhcpsrv_log.h>
 #include <dhcpsrv/cql_lease_mgr.h>
+#include <util/threads/multi_threading_mgr.h>
 #include <boost/static_assert.hpp>
 #include <iostream>
 #include <iomanip>
@@ -30,6 +31,8 @@
 using namespace isc;
 using namespace isc::dhcp;
 using namespace std;
+using isc::util::thread::Mutex;
+using isc::util::thread::MultiThreadingLock;
 
 namespace isc {
 namespace dhcp {
@@ -1133,7 +1136,8 @@ private:
 
 CqlLeaseMgr::CqlLeaseMgr(const DatabaseConnection::ParameterMap& parameters)
     : LeaseMgr(), dbconn_(parameters), exchange4_(new CqlLease4Exchange()),
-    exchange6_(new CqlLease6Exchange()), versionExchange_(new CqlVersionExchange()) {
+    exchange6_(new CqlLease6Exchange()), versionExchange_(new CqlVersionExchange()),
+    mutex_(new Mutex()) {
     dbconn_.openDatabase();
     dbconn_.prepareStatements(CqlLeaseMgr::tagged_statements_);
 }
@@ -1260,6 +1264,7 @@ CqlLeaseMgr::addLeaseCommon(StatementIndex stindex,
 
 bool
 CqlLeaseMgr::addLease(const Lease4Ptr& lease) {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_CQL_ADD_ADDR4).arg(lease->addr_.toText());
 
@@ -1270,6 +1275,7 @@ CqlLeaseMgr::addLease(const Lease4Ptr& lease) {
 
 bool
 CqlLeaseMgr::addLease(const Lease6Ptr& lease) {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_CQL_ADD_ADDR6).arg(lease->addr_.toText());
 
@@ -1381,6 +1387,7 @@ CqlLeaseMgr::getLease(StatementIndex stindex, CqlDataArray& data,
 
 Lease4Ptr
 CqlLeaseMgr::getLease4(const isc::asiolink::IOAddress& addr) const {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_CQL_GET_ADDR4).arg(addr.toText());
 
@@ -1399,6 +1406,7 @@ CqlLeaseMgr::getLease4(const isc::asiolink::IOAddress& addr) const {
 
 Lease4Collection
 CqlLeaseMgr::getLease4(const HWAddr& hwaddr) const {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_CQL_GET_HWADDR).arg(hwaddr.toText());
 
@@ -1417,6 +1425,7 @@ CqlLeaseMgr::getLease4(const HWAddr& hwaddr) const {
 
 Lease4Ptr
 CqlLeaseMgr::getLease4(const HWAddr& hwaddr, SubnetID subnet_id) const {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_CQL_GET_SUBID_HWADDR)
               .arg(subnet_id).arg(hwaddr.toText());
@@ -1439,6 +1448,7 @@ CqlLeaseMgr::getLease4(const HWAddr& hwaddr, SubnetID subnet_id) const {
 
 Lease4Collection
 CqlLeaseMgr::getLease4(const ClientId& clientid) const {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_CQL_GET_CLIENTID).arg(clientid.toText());
 
@@ -1458,6 +1468,7 @@ CqlLeaseMgr::getLease4(const ClientId& clientid) const {
 Lease4Ptr
 CqlLeaseMgr::getLease4(const ClientId& clientid, const HWAddr& hwaddr,
         SubnetID subnet_id) const {
+    MultiThreadingLock lock(*mutex_);
     /// This function is currently not implemented because allocation engine
     /// searches for the lease using HW address or client identifier.
     /// It never uses both parameters in the same time. We need to
@@ -1472,6 +1483,7 @@ CqlLeaseMgr::getLease4(const ClientId& clientid, const HWAddr& hwaddr,
 
 Lease4Ptr
 CqlLeaseMgr::getLease4(const ClientId& clientid, SubnetID subnet_id) const {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_CQL_GET_SUBID_CLIENTID)
               .arg(subnet_id).arg(clientid.toText());
@@ -1495,6 +1507,7 @@ CqlLeaseMgr::getLease4(const ClientId& clientid, SubnetID subnet_id) const {
 Lease6Ptr
 CqlLeaseMgr::getLease6(Lease::Type lease_type,
                          const isc::asiolink::IOAddress& addr) const {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_CQL_GET_ADDR6).arg(addr.toText())
               .arg(lease_type);
@@ -1526,6 +1539,7 @@ CqlLeaseMgr::getLease6(Lease::Type lease_type,
 Lease6Collection
 CqlLeaseMgr::getLeases6(Lease::Type lease_type,
                           const DUID& duid, uint32_t iaid) const {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_CQL_GET_IAID_DUID).arg(iaid).arg(duid.toText())
               .arg(lease_type);
@@ -1553,6 +1567,7 @@ Lease6Collection
 CqlLeaseMgr::getLeases6(Lease::Type lease_type,
                           const DUID& duid, uint32_t iaid,
                           SubnetID subnet_id) const {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_CQL_GET_IAID_SUBID_DUID)
               .arg(iaid).arg(subnet_id).arg(duid.toText())
@@ -1583,6 +1598,7 @@ CqlLeaseMgr::getLeases6(Lease::Type lease_type,
 void
 CqlLeaseMgr::getExpiredLeases6(Lease6Collection& expired_leases,
                                  const size_t max_leases) const {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_CQL_GET_EXPIRED6)
         .arg(max_leases);
     getExpiredLeasesCommon(expired_leases, max_leases, GET_LEASE6_EXPIRE);
@@ -1591,6 +1607,7 @@ CqlLeaseMgr::getExpiredLeases6(Lease6Collection& expired_leases,
 void
 CqlLeaseMgr::getExpiredLeases4(Lease4Collection& expired_leases,
                                  const size_t max_leases) const {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_CQL_GET_EXPIRED4)
         .arg(max_leases);
     getExpiredLeasesCommon(expired_leases, max_leases, GET_LEASE4_EXPIRE);
@@ -1696,6 +1713,7 @@ CqlLeaseMgr::updateLeaseCommon(StatementIndex stindex,
 
 void
 CqlLeaseMgr::updateLease4(const Lease4Ptr& lease) {
+    MultiThreadingLock lock(*mutex_);
     const StatementIndex stindex = UPDATE_LEASE4;
 
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
@@ -1716,6 +1734,7 @@ CqlLeaseMgr::updateLease4(const Lease4Ptr& lease) {
 
 void
 CqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
+    MultiThreadingLock lock(*mutex_);
     const StatementIndex stindex = UPDATE_LEASE6;
 
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
@@ -1798,9 +1817,15 @@ CqlLeaseMgr::deleteLeaseCommon(StatementIndex stindex,
 
 bool
 CqlLeaseMgr::deleteLease(const isc::asiolink::IOAddress& addr) {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_CQL_DELETE_ADDR).arg(addr.toText());
 
+    return (deleteLeaseInternal(addr));
+}
+
+bool
+CqlLeaseMgr::deleteLeaseInternal(const isc::asiolink::IOAddress& addr) {
     // Set up the WHERE clause value
     CqlDataArray data;
 
@@ -1826,6 +1851,7 @@ CqlLeaseMgr::deleteLease(const isc::asiolink::IOAddress& addr) {
 
 uint64_t
 CqlLeaseMgr::deleteExpiredReclaimedLeases4(const uint32_t secs) {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_CQL_DELETE_EXPIRED_RECLAIMED4)
         .arg(secs);
@@ -1834,6 +1860,7 @@ CqlLeaseMgr::deleteExpiredReclaimedLeases4(const uint32_t secs) {
 
 uint64_t
 CqlLeaseMgr::deleteExpiredReclaimedLeases6(const uint32_t secs) {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_CQL_DELETE_EXPIRED_RECLAIMED6)
         .arg(secs);
@@ -1872,13 +1899,13 @@ CqlLeaseMgr::deleteExpiredReclaimedLeasesCommon(const uint32_t secs,
     }
     for (Lease4Collection::iterator it = result4Leases.begin();
             it != result4Leases.end(); ++it) {
-        if (deleteLease((*it)->addr_)) {
+        if (deleteLeaseInternal((*it)->addr_)) {
             result++;
         }
     }
     for (Lease6Collection::iterator it = result6Leases.begin();
             it != result6Leases.end(); ++it) {
-        if (deleteLease((*it)->addr_)) {
+        if (deleteLeaseInternal((*it)->addr_)) {
             result++;
         }
     }
@@ -1913,6 +1940,7 @@ CqlLeaseMgr::getDescription() const {
 
 pair<uint32_t, uint32_t>
 CqlLeaseMgr::getVersion() const {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_CQL_GET_VERSION);
     uint32_t version;
@@ -1969,11 +1997,13 @@ CqlLeaseMgr::getVersion() const {
 
 void
 CqlLeaseMgr::commit() {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_CQL_COMMIT);
 }
 
 void
 CqlLeaseMgr::rollback() {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_CQL_ROLLBACK);
 }
 
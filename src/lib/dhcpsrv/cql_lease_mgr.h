@@ -20,6 +20,7 @@
 #include <dhcp/hwaddr.h>
 #include <dhcpsrv/lease_mgr.h>
 #include <dhcpsrv/cql_connection.h>
+#include <util/threads/sync.h>
 #include <boost/scoped_ptr.hpp>
 #include <boost/utility.hpp>
 #include <cassandra.h>
@@ -681,6 +682,13 @@ private:
     uint64_t deleteExpiredReclaimedLeasesCommon(const uint32_t secs,
                                                 StatementIndex statement_index);
 
+    /// @brief Deletes a lease without locking the mutex.
+    ///
+    /// @param addr Address of the lease to be deleted.
+    ///
+    /// @return true if the lease was deleted, false if not found.
+    bool deleteLeaseInternal(const isc::asiolink::IOAddress& addr);
+
     /// CQL queries used by CQL backend
     static CqlTaggedStatement tagged_statements_[];
     /// Database connection object
@@ -693,6 +701,10 @@ private:
     boost::scoped_ptr<CqlLease4Exchange> exchange4_; ///< Exchange object
     boost::scoped_ptr<CqlLease6Exchange> exchange6_; ///< Exchange object
     boost::scoped_ptr<CqlVersionExchange> versionExchange_; ///< Exchange object
+
+    /// @brief Mutex serializing the use of the connection and the exchange
+    /// objects in the multi-threading mode.
+    boost::scoped_ptr<isc::util::thread::Mutex> mutex_;
 };
 
 }; // end of isc::dhcp namespace
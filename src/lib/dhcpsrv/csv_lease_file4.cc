@@ -77,44 +77,19 @@ CSVLeaseFile4::next(Lease4Ptr& lease) {
     try {
         // Get the row of CSV values.
         CSVRow row;
-        VersionedCSVFile::next(row);
-        // The empty row signals EOF.
-        if (row == CSVFile::EMPTY_ROW()) {
+        bool row_valid = VersionedCSVFile::next(row);
+        // The empty row signals EOF. Note that the row parsed from a
+        // blank line holds one empty value, so it is an invalid row.
+        if (row.getValuesCount() == 0) {
             lease.reset();
             return (true);
         }
-
-        // Get client id. It is possible that the client id is empty and the
-        // returned pointer is NULL. This is ok, but if the client id is NULL,
-        // we need to be careful to not use the NULL pointer.
-        ClientIdPtr client_id = readClientId(row);
-        std::vector<uint8_t> client_id_vec;
-        if (client_id) {
-            client_id_vec = client_id->getClientId();
-        }
-        size_t client_id_len = client_id_vec.size();
-
-        // Get the HW address. It should never be empty and the readHWAddr checks
-        // that.
-        HWAddr hwaddr = readHWAddr(row);
-        uint32_t state = readState(row);
-        if (hwaddr.hwaddr_.empty() && state != Lease::STATE_DECLINED) {
-            isc_throw(isc::BadValue, "A blank hardware address is only"
-                      " valid for declined leases");
+        // The row doesn't match the schema of the file.
+        if (!row_valid) {
+            isc_throw(isc::BadValue, getReadMsg());
         }
 
-        lease.reset(new Lease4(readAddress(row),
-                               HWAddrPtr(new HWAddr(hwaddr)),
-                               client_id_vec.empty() ? NULL : &client_id_vec[0],
-                               client_id_len,
-                               readValid(row),
-                               0, 0, // t1, t2 = 0
-                               readCltt(row),
-                               readSubnetID(row),
-                               readFqdnFwd(row),
-                               readFqdnRev(row),
-                               readHostname(row)));
-        lease->state_ = state;
+        lease = readLease(row);
 
     } catch (std::exception& ex) {
         // bump the read error count
@@ -133,6 +108,43 @@ CSVLeaseFile4::next(Lease4Ptr& lease) {
     return (true);
 }
 
+Lease4Ptr
+CSVLeaseFile4::readLease(const CSVRow& row) const {
+    // Get client id. It is possible that the client id is empty and the
+    // returned pointer is NULL. This is ok, but if the client id is NULL,
+    // we need to be careful to not use the NULL pointer.
+    ClientIdPtr client_id = readClientId(row);
+    std::vector<uint8_t> client_id_vec;
+    if (client_id) {
+        client_id_vec = client_id->getClientId();
+    }
+    size_t client_id_len = client_id_vec.size();
+
+    // Get the HW address. It should never be empty and the readHWAddr checks
+    // that.
+    HWAddr hwaddr = readHWAddr(row);
+    uint32_t state = readState(row);
+    if (hwaddr.hwaddr_.empty() && state != Lease::STATE_DECLINED) {
+        isc_throw(isc::BadValue, "A blank hardware address is only"
+                  " valid for declined leases");
+    }
+
+    Lease4Ptr lease(new Lease4(readAddress(row),
+                               HWAddrPtr(new HWAddr(hwaddr)),
+                               client_id_vec.empty() ? NULL : &client_id_vec[0],
+                               client_id_len,
+                               readValid(row),
+                               0, 0, // t1, t2 = 0
+                               readCltt(row),
+                               readSubnetID(row),
+                               readFqdnFwd(row),
+                               readFqdnRev(row),
+                               readHostname(row)));
+    lease->state_ = state;
+
+    return (lease);
+}
+
 void
 CSVLeaseFile4::initColumns() {
     addColumn("address", "1.0");
@@ -150,19 +162,19 @@ CSVLeaseFile4::initColumns() {
 }
 
 IOAddress
-CSVLeaseFile4::readAddress(const CSVRow& row) {
+CSVLeaseFile4::readAddress(const CSVRow& row) const {
     IOAddress address(row.readAt(getColumnIndex("address")));
     return (address);
 }
 
 HWAddr
-CSVLeaseFile4::readHWAddr(const CSVRow& row) {
+CSVLeaseFile4::readHWAddr(const CSVRow& row) const {
     HWAddr hwaddr = HWAddr::fromText(row.readAt(getColumnIndex("hwaddr")));
     return (hwaddr);
 }
 
 ClientIdPtr
-CSVLeaseFile4::readClientId(const CSVRow& row) {
+CSVLeaseFile4::readClientId(const CSVRow& row) const {
     std::string client_id = row.readAt(getColumnIndex("client_id"));
     // NULL client ids are allowed in DHCPv4.
     if (client_id.empty()) {
@@ -173,46 +185,46 @@ CSVLeaseFile4::readClientId(const CSVRow& row) {
 }
 
 uint32_t
-CSVLeaseFile4::readValid(const CSVRow& row) {
+CSVLeaseFile4::readValid(const CSVRow& row) const {
     uint32_t valid =
         row.readAndConvertAt<uint32_t>(getColumnIndex("valid_lifetime"));
     return (valid);
 }
 
 time_t
-CSVLeaseFile4::readCltt(const CSVRow& row) {
+CSVLeaseFile4::readCltt(const CSVRow& row) const {
     uint32_t cltt = row.readAndConvertAt<uint32_t>(getColumnIndex("expire"))
         - readValid(row);
     return (cltt);
 }
 
 SubnetID
-CSVLeaseFile4::readSubnetID(const CSVRow& row) {
+CSVLeaseFile4::readSubnetID(const CSVRow& row) const {
     SubnetID subnet_id =
         row.readAndConvertAt<SubnetID>(getColumnIndex("subnet_id"));
     return (subnet_id);
 }
 
 bool
-CSVLeaseFile4::readFqdnFwd(const CSVRow& row) {
+CSVLeaseFile4::readFqdnFwd(const CSVRow& row) const {
     bool fqdn_fwd = row.readAndConvertAt<bool>(getColumnIndex("fqdn_fwd"));
     return (fqdn_fwd);
 }
 
 bool
-CSVLeaseFile4::readFqdnRev(const CSVRow& row) {
+CSVLeaseFile4::readFqdnRev(const CSVRow& row) const {
     bool fqdn_rev = row.readAndConvertAt<bool>(getColumnIndex("fqdn_rev"));
     return (fqdn_rev);
 }
 
 std::string
-CSVLeaseFile4::readHostname(const CSVRow& row) {
+CSVLeaseFile4::readHostname(const CSVRow& row) const {
     std::string hostname = row.readAt(getColumnIndex("hostname"));
     return (hostname);
 }
 
 uint32_t
-CSVLeaseFile4::readState(const util::CSVRow& row) {
+CSVLeaseFile4::readState(const util::CSVRow& row) const {
     uint32_t state = row.readAndConvertAt<uint32_t>(getColumnIndex("state"));
     return (state);
 }
@@ -11,7 +11,7 @@
 #include <dhcp/duid.h>
 #include <dhcpsrv/lease.h>
 #include <dhcpsrv/subnet.h>
-#include <dhcpsrv/lease_file_stats.h>
+#include <dhcpsrv/lease_file.h>
 #include <util/versioned_csv_file.h>
 #include <stdint.h>
 #include <string>
@@ -30,7 +30,7 @@ namespace dhcp {
 /// validation (see http://kea.isc.org/ticket/2405). However, when #2405
 /// is implemented, the @c next function may need to be updated to use the
 /// validation capablity of @c Lease6.
-class CSVLeaseFile6 : public isc::util::VersionedCSVFile, public LeaseFileStats {
+class CSVLeaseFile6 : public isc::util::VersionedCSVFile, public LeaseFile6 {
 public:
 
     /// @brief Constructor.
@@ -49,6 +49,47 @@ public:
     /// the base class may do so.
     virtual void open(const bool seek_to_end = false);
 
+    /// @brief Closes the lease file.
+    virtual void close() {
+        VersionedCSVFile::close();
+    }
+
+    /// @brief Checks if the lease file exists.
+    virtual bool exists() const {
+        return (VersionedCSVFile::exists());
+    }
+
+    /// @brief Returns the path to the lease file.
+    virtual std::string getFilename() const {
+        return (VersionedCSVFile::getFilename());
+    }
+
+    /// @brief Returns the description of the last error reading the file.
+    virtual std::string getReadMsg() const {
+        return (VersionedCSVFile::getReadMsg());
+    }
+
+    /// @brief Checks if the lease file should be rewritten in the current
+    /// version.
+    virtual bool needsConversion() const {
+        return (VersionedCSVFile::needsConversion());
+    }
+
+    /// @brief Enables or disables flushing the lease file after each entry.
+    virtual void setAutoFlush(const bool auto_flush) {
+        VersionedCSVFile::setAutoFlush(auto_flush);
+    }
+
+    /// @brief Writes the buffered entries to the lease file.
+    virtual void flush() {
+        VersionedCSVFile::flush();
+    }
+
+    /// @brief Waits until the flushed entries are stored on the disk.
+    virtual void sync() {
+        VersionedCSVFile::sync();
+    }
+
     /// @brief Appends the lease record to the CSV file.
     ///
     /// This function doesn't throw exceptions itself. In theory, exceptions
@@ -57,7 +98,7 @@ public:
     /// error.
     ///
     /// @param lease Structure representing a DHCPv6 lease.
-    void append(const Lease6& lease);
+    virtual void append(const Lease6& lease);
 
     /// @brief Reads next lease from the CSV file.
     ///
@@ -77,7 +118,25 @@ public:
     /// @todo Make sure that the values read from the file are correct.
     /// The appropriate @c Lease6 validation mechanism should be used once
     /// ticket http://kea.isc.org/ticket/2405 is implemented.
-    bool next(Lease6Ptr& lease);
+    virtual bool next(Lease6Ptr& lease);
+
+    /// @brief Creates a lease from the CSV file row.
+    ///
+    /// This function is used by @c next to create the lease from the
+    /// row it has read. It may also be used to create leases from the
+    /// rows read from the lease file by other means, e.g. when the
+    /// rows are parsed by multiple threads. The row must have been
+    /// adjusted to the current schema with @c adjustRow.
+    ///
+    /// This function doesn't change the state of this object and it
+    /// doesn't update the statistics.
+    ///
+    /// @param row CSV file row holding lease information.
+    ///
+    /// @return Pointer to the lease created.
+    /// @throw isc::Exception or derived exception if the row doesn't
+    /// hold a valid lease.
+    Lease6Ptr readLease(const util::CSVRow& row) const;
 
 private:
 
@@ -108,73 +167,73 @@ private:
     /// @brief Reads lease type from the CSV file row.
     ///
     /// @param row CSV file row holding lease information.
-    Lease::Type readType(const util::CSVRow& row);
+    Lease::Type readType(const util::CSVRow& row) const;
 
     /// @brief Reads lease address from the CSV file row.
     ///
     /// @param row CSV file row holding lease information.
-    asiolink::IOAddress readAddress(const util::CSVRow& row);
+    asiolink::IOAddress readAddress(const util::CSVRow& row) const;
 
     /// @brief Reads DUID from the CSV file row.
     ///
     /// @param row CSV file row holding lease information.
-    DuidPtr readDUID(const util::CSVRow& row);
+    DuidPtr readDUID(const util::CSVRow& row) const;
 
     /// @brief Reads IAID from the CSV file row.
     ///
     /// @param row CSV file row holding lease information.
-    uint32_t readIAID(const util::CSVRow& row);
+    uint32_t readIAID(const util::CSVRow& row) const;
 
     /// @brief Reads preferred lifetime from the CSV file row.
     ///
     /// @param row CSV file row holding lease information.
-    uint32_t readPreferred(const util::CSVRow& row);
+    uint32_t readPreferred(const util::CSVRow& row) const;
 
     /// @brief Reads valid lifetime from the CSV file row.
     ///
     /// @param row CSV file row holding lease information.
-    uint32_t readValid(const util::CSVRow& row);
+    uint32_t readValid(const util::CSVRow& row) const;
 
     /// @brief Reads cltt value from the CSV file row.
     ///
     /// @param row CSV file row holding lease information.
-    uint32_t readCltt(const util::CSVRow& row);
+    uint32_t readCltt(const util::CSVRow& row) const;
 
     /// @brief Reads subnet id from the CSV file row.
     ///
     /// @param row CSV file row holding lease information.
-    SubnetID readSubnetID(const util::CSVRow& row);
+    SubnetID readSubnetID(const util::CSVRow& row) const;
 
     /// @brief Reads prefix length from the CSV file row.
     ///
     /// @param row CSV file row holding lease information.
-    uint8_t readPrefixLen(const util::CSVRow& row);
+    uint8_t readPrefixLen(const util::CSVRow& row) const;
 
     /// @brief Reads the FQDN forward flag from the CSV file row.
     ///
     /// @param row CSV file row holding lease information.
-    bool readFqdnFwd(const util::CSVRow& row);
+    bool readFqdnFwd(const util::CSVRow& row) const;
 
     /// @brief Reads the FQDN reverse flag from the CSV file row.
     ///
     /// @param row CSV file row holding lease information.
-    bool readFqdnRev(const util::CSVRow& row);
+    bool readFqdnRev(const util::CSVRow& row) const;
 
     /// @brief Reads hostname from the CSV file row.
     ///
     /// @param row CSV file row holding lease information.
-    std::string readHostname(const util::CSVRow& row);
+    std::string readHostname(const util::CSVRow& row) const;
 
     /// @brief Reads HW address from the CSV file row.
     ///
     /// @param row CSV file row holding lease information.
     /// @return pointer to the HWAddr structure that was read
-    HWAddrPtr readHWAddr(const util::CSVRow& row);
+    HWAddrPtr readHWAddr(const util::CSVRow& row) const;
 
     /// @brief Reads lease state from the CSV file row.
     ///
     /// @param row CSV file row holding lease information.
-    uint32_t readState(const util::CSVRow& row);
+    uint32_t readState(const util::CSVRow& row) const;
     //@}
 
 };
@@ -10,19 +10,23 @@
 #include <dhcp_ddns/ncr_udp.h>
 #include <dhcpsrv/d2_client_mgr.h>
 #include <dhcpsrv/dhcpsrv_log.h>
+#include <util/threads/multi_threading_mgr.h>
 
 #include <boost/bind.hpp>
 
 #include <string>
 
 using namespace std;
+using isc::util::thread::Mutex;
+using isc::util::thread::MultiThreadingLock;
 
 namespace isc {
 namespace dhcp {
 
 D2ClientMgr::D2ClientMgr() : d2_client_config_(new D2ClientConfig()),
     name_change_sender_(), private_io_service_(),
-    registered_select_fd_(util::WatchSocket::SOCKET_NOT_VALID) {
+    registered_select_fd_(util::WatchSocket::SOCKET_NOT_VALID),
+    mutex_(new Mutex()) {
     // Default constructor initializes with a disabled configuration.
 }
 
@@ -286,6 +290,7 @@ D2ClientMgr::sendRequest(dhcp_ddns::NameChangeRequestPtr& ncr) {
         isc_throw(D2ClientError, "D2ClientMgr::sendRequest not in send mode");
     }
 
+    MultiThreadingLock lock(*mutex_);
     try {
         name_change_sender_->sendRequest(ncr);
     } catch (const std::exception& ex) {
@@ -380,6 +385,7 @@ D2ClientMgr::runReadyIO() {
                   " name_change_sender is null");
     }
 
+    MultiThreadingLock lock(*mutex_);
     name_change_sender_->runReadyIO();
 }
 
@@ -15,7 +15,9 @@
 #include <dhcp_ddns/ncr_io.h>
 #include <dhcpsrv/d2_client_cfg.h>
 #include <exceptions/exceptions.h>
+#include <util/threads/sync.h>
 
+#include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/noncopyable.hpp>
 
@@ -423,6 +425,10 @@ private:
 
     /// @brief Remembers the select-fd registered with IfaceMgr.
     int registered_select_fd_;
+
+    /// @brief Mutex serializing the requests queued by the threads
+    /// processing packets with the IO run by the main thread.
+    boost::scoped_ptr<isc::util::thread::Mutex> mutex_;
 };
 
 template <class T>
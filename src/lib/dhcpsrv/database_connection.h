@@ -63,6 +63,15 @@ public:
         isc::Exception(file, line, what) {}
 };
 
+/// @brief Invalid 'max-connections' value specification.
+///
+/// Thrown when the value of the 'max-connections' parameter is invalid.
+class DbInvalidMaxConnections : public Exception {
+public:
+    DbInvalidMaxConnections(const char* file, size_t line, const char* what) :
+        isc::Exception(file, line, what) {}
+};
+
 
 /// @brief Common database connection class.
 ///
@@ -0,0 +1,260 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef DATABASE_CONTEXT_POOL_H
+#define DATABASE_CONTEXT_POOL_H
+
+#include <dhcpsrv/database_connection.h>
+#include <stats/stats_mgr.h>
+#include <util/threads/multi_threading_mgr.h>
+#include <util/threads/sync.h>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/function.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Pool of the contexts used by a SQL backend.
+///
+/// A context holds everything a SQL backend needs to run queries: the
+/// connection to the database, the prepared statements and the objects
+/// exchanging the data with the database. Only one query can be run
+/// on a connection at a time, so the backend takes a context from this
+/// pool for the duration of each operation. The concurrent callers, e.g.
+/// the packet processing threads, the lease reclamation and the lease
+/// commands, get different contexts and can use the database in parallel.
+///
+/// The contexts are created on demand, so the pool only opens as many
+/// connections as the number of the concurrent callers, not exceeding
+/// the configured maximum. When all contexts are in use, the caller waits
+/// until one is returned to the pool. In the single-threaded mode the pool
+/// never waits: it creates an additional context when a nested operation
+/// needs one.
+///
+/// The pool maintains the following statistics:
+/// - <prefix>-pool-size - number of contexts (connections) opened,
+/// - <prefix>-pool-waits - number of times a caller had to wait for
+///   a context,
+/// - <prefix>-pool-wait-time - total time spent waiting for the contexts.
+///
+/// @tparam ContextType Type of the context held in the pool.
+template<typename ContextType>
+class DatabaseContextPool : public boost::noncopyable {
+public:
+
+    /// @brief Pointer to the context.
+    typedef boost::shared_ptr<ContextType> ContextPtr;
+
+    /// @brief Function creating a new context.
+    typedef boost::function<ContextPtr ()> ContextFactory;
+
+    /// @brief RAII object taking a context from the pool.
+    ///
+    /// The context is returned to the pool when this object is destroyed.
+    class ContextAlloc : public boost::noncopyable {
+    public:
+
+        /// @brief Constructor.
+        ///
+        /// Takes a context from the pool, waiting if necessary.
+        ///
+        /// @param pool Pool from which the context is taken.
+        explicit ContextAlloc(DatabaseContextPool& pool)
+            : ctx_(pool.acquire()), pool_(pool) {
+        }
+
+        /// @brief Destructor.
+        ///
+        /// Returns the context to the pool.
+        ~ContextAlloc() {
+            pool_.release(ctx_);
+        }
+
+        /// @brief The context taken from the pool.
+        ContextPtr ctx_;
+
+    private:
+
+        /// @brief The pool to which the context is returned.
+        DatabaseContextPool& pool_;
+    };
+
+    /// @brief Pointer to the @c ContextAlloc object.
+    typedef boost::shared_ptr<ContextAlloc> ContextAllocPtr;
+
+    /// @brief Name of the database access parameter holding the maximum
+    /// number of connections.
+    static const char* maxConnectionsParameter() {
+        return ("max-connections");
+    }
+
+    /// @brief Returns the maximum number of connections.
+    ///
+    /// The number is taken from the "max-connections" parameter. If it is
+    /// not specified or is 0, the number of processors plus one (for the
+    /// main thread running the lease reclamation and the commands) is used.
+    ///
+    /// @param parameters Database access parameters.
+    /// @return Maximum number of contexts in the pool.
+    /// @throw DbInvalidMaxConnections if the value is invalid.
+    static size_t getMaxConnections(const DatabaseConnection::ParameterMap&
+                                    parameters) {
+        size_t max_size = 0;
+        DatabaseConnection::ParameterMap::const_iterator param =
+            parameters.find(maxConnectionsParameter());
+        if (param != parameters.end()) {
+            try {
+                max_size = boost::lexical_cast<uint16_t>(param->second);
+            } catch (const boost::bad_lexical_cast&) {
+                isc_throw(DbInvalidMaxConnections, "invalid value for the "
+                          << maxConnectionsParameter() << " parameter: "
+                          << param->second);
+            }
+        }
+        if (max_size == 0) {
+            max_size = isc::util::thread::MultiThreadingMgr::
+                detectThreadCount() + 1;
+        }
+        return (max_size);
+    }
+
+    /// @brief Constructor.
+    ///
+    /// The pool is initially empty.
+    ///
+    /// @param factory Function creating a new context.
+    /// @param max_size Maximum number of contexts in the multi-threaded
+    /// mode. It must be greater than 0.
+    /// @param stats_prefix Prefix of the names of the pool statistics.
+    DatabaseContextPool(const ContextFactory& factory, const size_t max_size,
+                        const std::string& stats_prefix)
+        : factory_(factory), max_size_(max_size > 0 ? max_size : 1),
+          size_(0), stats_prefix_(stats_prefix), idle_(),
+          mutex_(new isc::util::thread::Mutex()),
+          condvar_(new isc::util::thread::CondVar()) {
+    }
+
+    /// @brief Returns the maximum number of contexts.
+    size_t getMaxSize() const {
+        return (max_size_);
+    }
+
+    /// @brief Returns the number of contexts created by the pool.
+    size_t getSize() const {
+        isc::util::thread::MultiThreadingLock lock(*mutex_);
+        return (size_);
+    }
+
+    /// @brief Returns the number of contexts which are not in use.
+    size_t getIdleCount() const {
+        isc::util::thread::MultiThreadingLock lock(*mutex_);
+        return (idle_.size());
+    }
+
+    /// @brief Takes a context from the pool.
+    ///
+    /// Returns an idle context if there is one. Otherwise, it creates a new
+    /// context if the maximum has not been reached or waits until another
+    /// caller returns a context to the pool.
+    ///
+    /// @return Pointer to the context.
+    /// @throw any exception thrown by the context factory.
+    ContextPtr acquire() {
+        ContextPtr ctx;
+        bool waited = false;
+        boost::posix_time::ptime wait_start;
+        {
+            isc::util::thread::MultiThreadingLock lock(*mutex_);
+            while (idle_.empty()) {
+                if ((size_ < max_size_) ||
+                    !isc::util::thread::MultiThreadingMgr::instance().getMode()) {
+                    // Reserve the slot for the new context. It is created
+                    // below, without holding the lock.
+                    ++size_;
+                    break;
+                }
+                if (!waited) {
+                    waited = true;
+                    wait_start = boost::posix_time::microsec_clock::
+                        universal_time();
+                }
+                condvar_->wait(*mutex_);
+            }
+            if (!idle_.empty()) {
+                ctx = idle_.back();
+                idle_.pop_back();
+            }
+        }
+
+        if (waited) {
+            isc::stats::StatsMgr::instance().
+                addValue(stats_prefix_ + "-pool-waits", int64_t(1));
+            isc::stats::StatsMgr::instance().
+                addValue(stats_prefix_ + "-pool-wait-time",
+                         boost::posix_time::microsec_clock::universal_time() -
+                         wait_start);
+        }
+
+        if (!ctx) {
+            try {
+                ctx = factory_();
+            } catch (...) {
+                isc::util::thread::MultiThreadingLock lock(*mutex_);
+                --size_;
+                condvar_->signal();
+                throw;
+            }
+            isc::stats::StatsMgr::instance().
+                setValue(stats_prefix_ + "-pool-size",
+                         static_cast<int64_t>(getSize()));
+        }
+        return (ctx);
+    }
+
+    /// @brief Returns the context to the pool.
+    ///
+    /// @param ctx Context taken from this pool with @c acquire.
+    void release(const ContextPtr& ctx) {
+        isc::util::thread::MultiThreadingLock lock(*mutex_);
+        idle_.push_back(ctx);
+        condvar_->signal();
+    }
+
+private:
+
+    /// @brief Function creating a new context.
+    ContextFactory factory_;
+
+    /// @brief Maximum number of contexts in the multi-threaded mode.
+    size_t max_size_;
+
+    /// @brief Number of contexts created by the pool.
+    size_t size_;
+
+    /// @brief Prefix of the names of the pool statistics.
+    std::string stats_prefix_;
+
+    /// @brief Contexts which are not in use.
+    std::vector<ContextPtr> idle_;
+
+    /// @brief Mutex protecting the pool.
+    boost::scoped_ptr<isc::util::thread::Mutex> mutex_;
+
+    /// @brief Condition variable signalled when a context is returned.
+    boost::scoped_ptr<isc::util::thread::CondVar> condvar_;
+};
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
+
+#endif // DATABASE_CONTEXT_POOL_H
@@ -515,6 +515,16 @@ public:
         return (cfg_option4_);
     }
 
+    /// @brief Replaces the DHCPv4 option data configuration for this host.
+    ///
+    /// This is used to share identical option data configurations between
+    /// the hosts.
+    ///
+    /// @param cfg_option Pointer to the option data configuration.
+    void setCfgOption4(const CfgOptionPtr& cfg_option) {
+        cfg_option4_ = cfg_option;
+    }
+
     /// @brief Returns pointer to the DHCPv6 option data configuration for
     /// this host.
     ///
@@ -530,6 +540,16 @@ public:
         return (cfg_option6_);
     }
 
+    /// @brief Replaces the DHCPv6 option data configuration for this host.
+    ///
+    /// This is used to share identical option data configurations between
+    /// the hosts.
+    ///
+    /// @param cfg_option Pointer to the option data configuration.
+    void setCfgOption6(const CfgOptionPtr& cfg_option) {
+        cfg_option6_ = cfg_option;
+    }
+
     /// @brief Returns information about the host in the textual format.
     std::string toText() const;
 
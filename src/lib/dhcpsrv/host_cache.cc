@@ -0,0 +1,105 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <dhcpsrv/host_cache.h>
+#include <stats/stats_mgr.h>
+#include <boost/lexical_cast.hpp>
+#include <limits>
+
+using namespace isc::stats;
+
+namespace isc {
+namespace dhcp {
+
+namespace {
+
+/// @brief Returns the value of the unsigned integer parameter.
+///
+/// @param parameters Hosts database access parameters.
+/// @param name Name of the parameter.
+/// @param default_value Value returned when the parameter is not specified.
+///
+/// @return Value of the parameter.
+/// @throw DbInvalidHostCache if the value is invalid.
+uint32_t
+getCacheParameter(const DatabaseConnection::ParameterMap& parameters,
+                  const std::string& name, const uint32_t default_value) {
+    DatabaseConnection::ParameterMap::const_iterator param =
+        parameters.find(name);
+    if (param == parameters.end()) {
+        return (default_value);
+    }
+    // The lexical cast to the unsigned type accepts negative values,
+    // so the value is checked against the range explicitly.
+    int64_t value = -1;
+    try {
+        value = boost::lexical_cast<int64_t>(param->second);
+    } catch (const boost::bad_lexical_cast&) {
+        // The value is reported below.
+    }
+    if ((value < 0) || (value > std::numeric_limits<uint32_t>::max())) {
+        isc_throw(DbInvalidHostCache, "invalid value for the " << name
+                  << " parameter: " << param->second);
+    }
+    return (static_cast<uint32_t>(value));
+}
+
+}
+
+size_t
+HostCache::getCacheSize(const DatabaseConnection::ParameterMap& parameters) {
+    return (getCacheParameter(parameters, "cache-size", 0));
+}
+
+uint32_t
+HostCache::getCacheTtl(const DatabaseConnection::ParameterMap& parameters) {
+    return (getCacheParameter(parameters, "cache-ttl", 10));
+}
+
+HostCache::HostCache(const size_t max_size, const uint32_t ttl)
+    : cache_(max_size, ttl, StatsMgr::instance().getCounter("host-cache-hits"),
+             StatsMgr::instance().getCounter("host-cache-misses"),
+             StatsMgr::instance().getCounter("host-cache-size")) {
+    // The entries of the previous cache are not counted.
+    StatsMgr::instance().setValue("host-cache-size", static_cast<int64_t>(0));
+}
+
+size_t
+HostCache::size() const {
+    return (cache_.size());
+}
+
+bool
+HostCache::get(const Option::Universe& universe, const SubnetID& subnet_id,
+               const HostIdentifier& identifier, ConstHostPtr& host,
+               uint64_t& version) const {
+    return (cache_.get(makeKey(universe, subnet_id, identifier), host,
+                       version));
+}
+
+void
+HostCache::insert(const Option::Universe& universe, const SubnetID& subnet_id,
+                  const HostIdentifier& identifier, const ConstHostPtr& host,
+                  const uint64_t version) {
+    cache_.insert(makeKey(universe, subnet_id, identifier), host, version);
+}
+
+void
+HostCache::invalidate(const Host& host) {
+    HostIdentifier identifier(host.getIdentifierType(), host.getIdentifier());
+    cache_.erase(makeKey(Option::V4, host.getIPv4SubnetID(), identifier));
+    cache_.erase(makeKey(Option::V6, host.getIPv6SubnetID(), identifier));
+}
+
+void
+HostCache::flush() {
+    cache_.clear();
+}
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
@@ -0,0 +1,180 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef HOST_CACHE_H
+#define HOST_CACHE_H
+
+#include <dhcp/option.h>
+#include <dhcpsrv/base_host_data_source.h>
+#include <dhcpsrv/database_connection.h>
+#include <dhcpsrv/host.h>
+#include <dhcpsrv/lru_cache.h>
+#include <dhcpsrv/subnet_id.h>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/tuple/tuple.hpp>
+#include <boost/tuple/tuple_comparison.hpp>
+#include <stdint.h>
+#include <vector>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Invalid host cache parameter specification.
+///
+/// Thrown when the value of the 'cache-size' or 'cache-ttl' parameter
+/// of the hosts database is invalid.
+class DbInvalidHostCache : public Exception {
+public:
+    DbInvalidHostCache(const char* file, size_t line, const char* what) :
+        isc::Exception(file, line, what) {}
+};
+
+/// @brief Cache of the hosts returned by the alternate host data source.
+///
+/// The @c HostMgr looks up the reservations of each client in the
+/// alternate host data source (the database) when they are not found in
+/// the server configuration. Most clients have no reservation, so most of
+/// these lookups cost a database round trip to learn that there is no
+/// host. This cache keeps the results of the lookups by subnet and host
+/// identifier, including the information that there is no host for an
+/// identifier (negative caching), for the specified time to live.
+///
+/// The IPv4 and IPv6 lookups are cached separately, because the hosts are
+/// connected to the IPv4 and IPv6 subnets independently. The cache is
+/// bounded: the least recently used entry is removed when the maximum
+/// number of entries is reached. The hosts returned by the data sources
+/// are const, so the cache stores and returns the same objects.
+///
+/// The numbers of lookups served from the cache and forwarded to the
+/// data source are available as the "host-cache-hits" and
+/// "host-cache-misses" statistics, the number of cached entries as the
+/// "host-cache-size" statistic. They are accumulated in counters and
+/// recorded when the statistics are read.
+class HostCache : public boost::noncopyable {
+public:
+
+    /// @brief Returns the maximum number of cached entries.
+    ///
+    /// The number is taken from the "cache-size" parameter. The value of
+    /// 0 (the default) disables the cache.
+    ///
+    /// @param parameters Hosts database access parameters.
+    /// @return Maximum number of cached entries.
+    /// @throw DbInvalidHostCache if the value is invalid.
+    static size_t getCacheSize(const DatabaseConnection::ParameterMap&
+                               parameters);
+
+    /// @brief Returns the time to live of the cached entries.
+    ///
+    /// The time is taken from the "cache-ttl" parameter and is specified
+    /// in seconds. The default is 10 seconds. The value of 0 means that
+    /// the entries don't expire.
+    ///
+    /// @param parameters Hosts database access parameters.
+    /// @return Time to live of the cached entries in seconds.
+    /// @throw DbInvalidHostCache if the value is invalid.
+    static uint32_t getCacheTtl(const DatabaseConnection::ParameterMap&
+                                parameters);
+
+    /// @brief Constructor.
+    ///
+    /// @param max_size Maximum number of cached entries. It must be greater
+    /// than 0.
+    /// @param ttl Time to live of the cached entries in seconds or 0 if the
+    /// entries don't expire.
+    HostCache(const size_t max_size, const uint32_t ttl);
+
+    /// @brief Returns the maximum number of cached entries.
+    size_t getMaxSize() const {
+        return (cache_.getMaxSize());
+    }
+
+    /// @brief Returns the time to live of the cached entries.
+    uint32_t getTtl() const {
+        return (cache_.getTtl());
+    }
+
+    /// @brief Returns the number of cached entries.
+    size_t size() const;
+
+    /// @brief Looks up the cached result of a lookup.
+    ///
+    /// The entry which is found is moved to the front of the LRU list.
+    /// The expired entry is removed.
+    ///
+    /// @param universe @c Option::V4 for the hosts connected to the IPv4
+    /// subnet, @c Option::V6 for the hosts connected to the IPv6 subnet.
+    /// @param subnet_id Subnet identifier.
+    /// @param identifier Host identifier.
+    /// @param [out] host Cached host or null if it is known that there is
+    /// no host.
+    /// @param [out] version Version of the cache when the entry was not
+    /// found. It is passed to @c insert.
+    ///
+    /// @return true if the entry was found, false otherwise.
+    bool get(const Option::Universe& universe, const SubnetID& subnet_id,
+             const HostIdentifier& identifier, ConstHostPtr& host,
+             uint64_t& version) const;
+
+    /// @brief Caches the result of the lookup made in the data source.
+    ///
+    /// The entry is not inserted when the cache has been invalidated since
+    /// the lookup began, because the result may be already stale.
+    ///
+    /// @param universe @c Option::V4 or @c Option::V6.
+    /// @param subnet_id Subnet identifier.
+    /// @param identifier Host identifier.
+    /// @param host Host returned by the data source or null.
+    /// @param version Version returned by @c get.
+    void insert(const Option::Universe& universe, const SubnetID& subnet_id,
+                const HostIdentifier& identifier, const ConstHostPtr& host,
+                const uint64_t version);
+
+    /// @brief Removes the entries of the host.
+    ///
+    /// It is called when the host is added to the data source. The entries
+    /// for the host's identifier in its IPv4 and IPv6 subnets are removed.
+    ///
+    /// @param host Host added to the data source.
+    void invalidate(const Host& host);
+
+    /// @brief Removes all cached entries.
+    void flush();
+
+private:
+
+    /// @brief Key of the cached entry.
+    ///
+    /// It holds the universe, the subnet identifier, the type and the
+    /// value of the host identifier.
+    typedef boost::tuple<Option::Universe, SubnetID, Host::IdentifierType,
+                         std::vector<uint8_t> > CacheKey;
+
+    /// @brief Returns the key of the entry.
+    ///
+    /// @param universe @c Option::V4 or @c Option::V6.
+    /// @param subnet_id Subnet identifier.
+    /// @param identifier Host identifier.
+    /// @return Key of the entry.
+    static CacheKey makeKey(const Option::Universe& universe,
+                            const SubnetID& subnet_id,
+                            const HostIdentifier& identifier) {
+        return (CacheKey(universe, subnet_id, identifier.first,
+                         identifier.second));
+    }
+
+    /// @brief The cached entries.
+    LruCache<CacheKey, ConstHostPtr> cache_;
+};
+
+/// @brief Pointer to the host cache.
+typedef boost::shared_ptr<HostCache> HostCachePtr;
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
+
+#endif // HOST_CACHE_H
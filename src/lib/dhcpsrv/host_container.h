@@ -26,6 +26,11 @@ namespace dhcp {
 /// all @c Host objects which are identified by a specified identifier, i.e.
 /// HW address or DUID.
 ///
+/// The hosts can also be found using the identifier and the IPv4 or
+/// IPv6 subnet id in constant time, which is how the servers look up
+/// the reservations of the clients. The indexes using the identifier
+/// are hashed, so they don't order the hosts.
+///
 /// @todo This container will be extended to search for @c Host objects
 /// associated with a specific IPv4 address or IPv6 prefix/length.
 ///
@@ -38,8 +43,9 @@ typedef boost::multi_index_container<
         // First index is used to search for the host using one of the
         // identifiers, i.e. HW address or DUID. The elements of this
         // index are non-unique because there may be multiple reservations
-        // for the same host belonging to a different subnets.
-        boost::multi_index::ordered_non_unique<
+        // for the same host belonging to a different subnets. The index
+        // is only searched for the exact identifier, so it is hashed.
+        boost::multi_index::hashed_non_unique<
             // The index comprises actual identifier (HW address or DUID) in
             // a binary form and a type of the identifier which indicates
             // that it is HW address or DUID.
@@ -67,6 +73,49 @@ typedef boost::multi_index_container<
             // Index using values returned by the @c Host::getIPv4Reservation.
             boost::multi_index::const_mem_fun<Host, const asiolink::IOAddress&,
                                                &Host::getIPv4Reservation>
+        >,
+
+        // Third index is used to search for the host connected to the IPv4
+        // subnet using one of the identifiers. This is the lookup made for
+        // each DHCPv4 packet, so the index is hashed. It is non-unique
+        // because the hosts which are not connected to any IPv4 subnet
+        // share the subnet id of 0.
+        boost::multi_index::hashed_non_unique<
+            boost::multi_index::composite_key<
+                Host,
+                boost::multi_index::const_mem_fun<
+                    Host, const std::vector<uint8_t>&,
+                    &Host::getIdentifier
+                >,
+                boost::multi_index::const_mem_fun<
+                    Host, Host::IdentifierType,
+                    &Host::getIdentifierType
+                >,
+                boost::multi_index::const_mem_fun<
+                    Host, SubnetID,
+                    &Host::getIPv4SubnetID
+                >
+            >
+        >,
+
+        // Fourth index is used to search for the host connected to the IPv6
+        // subnet using one of the identifiers.
+        boost::multi_index::hashed_non_unique<
+            boost::multi_index::composite_key<
+                Host,
+                boost::multi_index::const_mem_fun<
+                    Host, const std::vector<uint8_t>&,
+                    &Host::getIdentifier
+                >,
+                boost::multi_index::const_mem_fun<
+                    Host, Host::IdentifierType,
+                    &Host::getIdentifierType
+                >,
+                boost::multi_index::const_mem_fun<
+                    Host, SubnetID,
+                    &Host::getIPv6SubnetID
+                >
+            >
         >
     >
 > HostContainer;
@@ -91,6 +140,26 @@ typedef HostContainer::nth_index<1>::type HostContainerIndex1;
 typedef std::pair<HostContainerIndex1::iterator,
                   HostContainerIndex1::iterator> HostContainerIndex1Range;
 
+/// @brief Third index type in the @c HostContainer.
+///
+/// This index allows for searching for @c Host objects using an
+/// identifier + identifier type + IPv4 subnet id tuple.
+typedef HostContainer::nth_index<2>::type HostContainerIndex2;
+
+/// @brief Results range returned using the @c HostContainerIndex2.
+typedef std::pair<HostContainerIndex2::iterator,
+                  HostContainerIndex2::iterator> HostContainerIndex2Range;
+
+/// @brief Fourth index type in the @c HostContainer.
+///
+/// This index allows for searching for @c Host objects using an
+/// identifier + identifier type + IPv6 subnet id tuple.
+typedef HostContainer::nth_index<3>::type HostContainerIndex3;
+
+/// @brief Results range returned using the @c HostContainerIndex3.
+typedef std::pair<HostContainerIndex3::iterator,
+                  HostContainerIndex3::iterator> HostContainerIndex3Range;
+
 /// @brief Defines one entry for the Host Container for v6 hosts
 ///
 /// It's essentially a pair of (IPv6 reservation, Host pointer).
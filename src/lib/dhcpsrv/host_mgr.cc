@@ -10,6 +10,8 @@
 #include <dhcpsrv/host_mgr.h>
 #include <dhcpsrv/hosts_log.h>
 #include <dhcpsrv/host_data_source_factory.h>
+#include <util/threads/multi_threading_mgr.h>
+#include <boost/foreach.hpp>
 
 namespace {
 
@@ -23,12 +25,50 @@ isc::dhcp::ConstCfgHostsPtr getCfgHosts() {
     return (isc::dhcp::CfgMgr::instance().getCurrentCfg()->getCfgHosts());
 }
 
+/// @brief Returns the host using the specified identifier.
+///
+/// @param hosts Hosts to be searched.
+/// @param identifier Identifier of the host.
+///
+/// @return Host using the identifier or null.
+isc::dhcp::ConstHostPtr
+findHost(const isc::dhcp::ConstHostCollection& hosts,
+         const isc::dhcp::HostIdentifier& identifier) {
+    BOOST_FOREACH(const isc::dhcp::ConstHostPtr& host, hosts) {
+        if ((host->getIdentifierType() == identifier.first) &&
+            (host->getIdentifier() == identifier.second)) {
+            return (host);
+        }
+    }
+    return (isc::dhcp::ConstHostPtr());
+}
+
+/// @brief Returns the identifiers which are not used by any of the hosts.
+///
+/// @param hosts Hosts found so far.
+/// @param identifiers Identifiers of the client.
+///
+/// @return Identifiers for which no host has been found.
+isc::dhcp::HostIdentifierList
+getMissingIdentifiers(const isc::dhcp::ConstHostCollection& hosts,
+                      const isc::dhcp::HostIdentifierList& identifiers) {
+    isc::dhcp::HostIdentifierList missing;
+    BOOST_FOREACH(const isc::dhcp::HostIdentifier& id, identifiers) {
+        if (!findHost(hosts, id)) {
+            missing.push_back(id);
+        }
+    }
+    return (missing);
+}
+
 } // end of anonymous namespace
 
 namespace isc {
 namespace dhcp {
 
 using namespace isc::asiolink;
+using isc::util::thread::Mutex;
+using isc::util::thread::MultiThreadingLock;
 
 boost::scoped_ptr<HostMgr>&
 HostMgr::getHostMgrPtr() {
@@ -38,6 +78,16 @@ HostMgr::getHostMgrPtr() {
 
 void
 HostMgr::create(const std::string& access) {
+    // Validate the host cache parameters before opening the database.
+    size_t cache_size = 0;
+    uint32_t cache_ttl = 0;
+    if (!access.empty()) {
+        DatabaseConnection::ParameterMap parameters =
+            DatabaseConnection::parse(access);
+        cache_size = HostCache::getCacheSize(parameters);
+        cache_ttl = HostCache::getCacheTtl(parameters);
+    }
+
     getHostMgrPtr().reset(new HostMgr());
 
     if (!access.empty()) {
@@ -55,6 +105,12 @@ HostMgr::create(const std::string& access) {
     // NULL value indicates that there's no host data source configured.
     getHostMgrPtr()->alternate_source_ =
         HostDataSourceFactory::getHostDataSourcePtr();
+
+    if (getHostMgrPtr()->alternate_source_ && (cache_size > 0)) {
+        LOG_INFO(hosts_logger, HOSTS_MGR_CACHE_ENABLED)
+            .arg(cache_size).arg(cache_ttl);
+        getHostMgrPtr()->cache_.reset(new HostCache(cache_size, cache_ttl));
+    }
 }
 
 HostMgr&
@@ -70,6 +126,7 @@ ConstHostCollection
 HostMgr::getAll(const HWAddrPtr& hwaddr, const DuidPtr& duid) const {
     ConstHostCollection hosts = getCfgHosts()->getAll(hwaddr, duid);
     if (alternate_source_) {
+        MultiThreadingLock lock(*mutex_);
         ConstHostCollection hosts_plus = alternate_source_->getAll(hwaddr, duid);
         hosts.insert(hosts.end(), hosts_plus.begin(), hosts_plus.end());
     }
@@ -84,6 +141,7 @@ HostMgr::getAll(const Host::IdentifierType& identifier_type,
                                                       identifier_begin,
                                                       identifier_len);
     if (alternate_source_) {
+        MultiThreadingLock lock(*mutex_);
         ConstHostCollection hosts_plus =
             alternate_source_->getAll(identifier_type, identifier_begin,
                                       identifier_len);
@@ -97,6 +155,7 @@ ConstHostCollection
 HostMgr::getAll4(const IOAddress& address) const {
     ConstHostCollection hosts = getCfgHosts()->getAll4(address);
     if (alternate_source_) {
+        MultiThreadingLock lock(*mutex_);
         ConstHostCollection hosts_plus = alternate_source_->getAll4(address);
         hosts.insert(hosts.end(), hosts_plus.begin(), hosts_plus.end());
     }
@@ -108,6 +167,7 @@ HostMgr::get4(const SubnetID& subnet_id, const HWAddrPtr& hwaddr,
               const DuidPtr& duid) const {
     ConstHostPtr host = getCfgHosts()->get4(subnet_id, hwaddr, duid);
     if (!host && alternate_source_) {
+        MultiThreadingLock lock(*mutex_);
         LOG_DEBUG(hosts_logger, HOSTS_DBG_TRACE,
                   HOSTS_MGR_ALTERNATE_GET4_SUBNET_ID_HWADDR_DUID)
             .arg(subnet_id)
@@ -131,6 +191,19 @@ HostMgr::get4(const SubnetID& subnet_id,
     ConstHostPtr host = getCfgHosts()->get4(subnet_id, identifier_type,
                                             identifier_begin, identifier_len);
     if (!host && alternate_source_) {
+        HostIdentifier identifier;
+        uint64_t version = 0;
+        if (cache_) {
+            identifier.first = identifier_type;
+            identifier.second.assign(identifier_begin,
+                                     identifier_begin + identifier_len);
+            if (cache_->get(Option::V4, subnet_id, identifier, host,
+                            version)) {
+                return (host);
+            }
+        }
+
+        MultiThreadingLock lock(*mutex_);
 
         LOG_DEBUG(hosts_logger, HOSTS_DBG_TRACE,
                   HOSTS_MGR_ALTERNATE_GET4_SUBNET_ID_IDENTIFIER)
@@ -141,6 +214,10 @@ HostMgr::get4(const SubnetID& subnet_id,
         host = alternate_source_->get4(subnet_id, identifier_type,
                                        identifier_begin, identifier_len);
 
+        if (cache_) {
+            cache_->insert(Option::V4, subnet_id, identifier, host, version);
+        }
+
         if (host) {
             LOG_DEBUG(hosts_logger, HOSTS_DBG_RESULTS,
                       HOSTS_MGR_ALTERNATE_GET4_SUBNET_ID_IDENTIFIER_HOST)
@@ -166,6 +243,7 @@ HostMgr::get4(const SubnetID& subnet_id,
               const asiolink::IOAddress& address) const {
     ConstHostPtr host = getCfgHosts()->get4(subnet_id, address);
     if (!host && alternate_source_) {
+        MultiThreadingLock lock(*mutex_);
         LOG_DEBUG(hosts_logger, HOSTS_DBG_TRACE,
                   HOSTS_MGR_ALTERNATE_GET4_SUBNET_ID_ADDRESS4)
             .arg(subnet_id)
@@ -175,12 +253,32 @@ HostMgr::get4(const SubnetID& subnet_id,
     return (host);
 }
 
+ConstHostCollection
+HostMgr::getByIdentifiers4(const SubnetID& subnet_id,
+                           const HostIdentifierList& identifiers) const {
+    ConstHostCollection hosts = getCfgHosts()->getByIdentifiers4(subnet_id,
+                                                                 identifiers);
+    if (!alternate_source_) {
+        return (hosts);
+    }
+
+    HostIdentifierList missing = getMissingIdentifiers(hosts, identifiers);
+    if (missing.empty()) {
+        return (hosts);
+    }
+
+    ConstHostCollection hosts_plus =
+        getAlternateByIdentifiers(Option::V4, subnet_id, missing);
+    hosts.insert(hosts.end(), hosts_plus.begin(), hosts_plus.end());
+    return (sortByIdentifiers(hosts, identifiers));
+}
 
 ConstHostPtr
 HostMgr::get6(const SubnetID& subnet_id, const DuidPtr& duid,
                const HWAddrPtr& hwaddr) const {
     ConstHostPtr host = getCfgHosts()->get6(subnet_id, duid, hwaddr);
     if (!host && alternate_source_) {
+        MultiThreadingLock lock(*mutex_);
         LOG_DEBUG(hosts_logger, HOSTS_DBG_TRACE,
                   HOSTS_MGR_ALTERNATE_GET6_SUBNET_ID_DUID_HWADDR)
             .arg(subnet_id)
@@ -200,6 +298,7 @@ ConstHostPtr
 HostMgr::get6(const IOAddress& prefix, const uint8_t prefix_len) const {
     ConstHostPtr host = getCfgHosts()->get6(prefix, prefix_len);
     if (!host && alternate_source_) {
+        MultiThreadingLock lock(*mutex_);
         LOG_DEBUG(hosts_logger, HOSTS_DBG_TRACE,
                   HOSTS_MGR_ALTERNATE_GET6_PREFIX)
             .arg(prefix.toText())
@@ -217,6 +316,19 @@ HostMgr::get6(const SubnetID& subnet_id,
     ConstHostPtr host = getCfgHosts()->get6(subnet_id, identifier_type,
                                             identifier_begin, identifier_len);
     if (!host && alternate_source_) {
+        HostIdentifier identifier;
+        uint64_t version = 0;
+        if (cache_) {
+            identifier.first = identifier_type;
+            identifier.second.assign(identifier_begin,
+                                     identifier_begin + identifier_len);
+            if (cache_->get(Option::V6, subnet_id, identifier, host,
+                            version)) {
+                return (host);
+            }
+        }
+
+        MultiThreadingLock lock(*mutex_);
 
         LOG_DEBUG(hosts_logger, HOSTS_DBG_TRACE,
                   HOSTS_MGR_ALTERNATE_GET6_SUBNET_ID_IDENTIFIER)
@@ -228,6 +340,10 @@ HostMgr::get6(const SubnetID& subnet_id,
         host = alternate_source_->get6(subnet_id, identifier_type,
                                        identifier_begin, identifier_len);
 
+        if (cache_) {
+            cache_->insert(Option::V6, subnet_id, identifier, host, version);
+        }
+
         if (host) {
             LOG_DEBUG(hosts_logger, HOSTS_DBG_RESULTS,
                       HOSTS_MGR_ALTERNATE_GET6_SUBNET_ID_IDENTIFIER_HOST)
@@ -248,11 +364,93 @@ HostMgr::get6(const SubnetID& subnet_id,
     return (host);
 }
 
+ConstHostCollection
+HostMgr::getByIdentifiers6(const SubnetID& subnet_id,
+                           const HostIdentifierList& identifiers) const {
+    ConstHostCollection hosts = getCfgHosts()->getByIdentifiers6(subnet_id,
+                                                                 identifiers);
+    if (!alternate_source_) {
+        return (hosts);
+    }
+
+    HostIdentifierList missing = getMissingIdentifiers(hosts, identifiers);
+    if (missing.empty()) {
+        return (hosts);
+    }
+
+    ConstHostCollection hosts_plus =
+        getAlternateByIdentifiers(Option::V6, subnet_id, missing);
+    hosts.insert(hosts.end(), hosts_plus.begin(), hosts_plus.end());
+    return (sortByIdentifiers(hosts, identifiers));
+}
+
+ConstHostCollection
+HostMgr::getAlternateByIdentifiers(const Option::Universe& universe,
+                                   const SubnetID& subnet_id,
+                                   const HostIdentifierList& identifiers) const {
+    ConstHostCollection hosts;
+    HostIdentifierList uncached;
+    uint64_t version = 0;
+    if (cache_) {
+        BOOST_FOREACH(const HostIdentifier& id, identifiers) {
+            ConstHostPtr host;
+            uint64_t id_version = 0;
+            if (cache_->get(universe, subnet_id, id, host, id_version)) {
+                if (host) {
+                    hosts.push_back(host);
+                }
+            } else {
+                // The results are cached only if the cache hasn't been
+                // invalidated since the first miss.
+                if (uncached.empty()) {
+                    version = id_version;
+                }
+                uncached.push_back(id);
+            }
+        }
+        if (uncached.empty()) {
+            return (hosts);
+        }
+    } else {
+        uncached = identifiers;
+    }
+
+    ConstHostCollection hosts_plus;
+    {
+        MultiThreadingLock lock(*mutex_);
+        if (universe == Option::V4) {
+            LOG_DEBUG(hosts_logger, HOSTS_DBG_TRACE,
+                      HOSTS_MGR_ALTERNATE_GET4_SUBNET_ID_IDENTIFIERS)
+                .arg(subnet_id)
+                .arg(uncached.size());
+            hosts_plus = alternate_source_->getByIdentifiers4(subnet_id,
+                                                              uncached);
+        } else {
+            LOG_DEBUG(hosts_logger, HOSTS_DBG_TRACE,
+                      HOSTS_MGR_ALTERNATE_GET6_SUBNET_ID_IDENTIFIERS)
+                .arg(subnet_id)
+                .arg(uncached.size());
+            hosts_plus = alternate_source_->getByIdentifiers6(subnet_id,
+                                                              uncached);
+        }
+    }
+
+    if (cache_) {
+        BOOST_FOREACH(const HostIdentifier& id, uncached) {
+            cache_->insert(universe, subnet_id, id, findHost(hosts_plus, id),
+                           version);
+        }
+    }
+    hosts.insert(hosts.end(), hosts_plus.begin(), hosts_plus.end());
+    return (hosts);
+}
+
 ConstHostPtr
 HostMgr::get6(const SubnetID& subnet_id,
               const asiolink::IOAddress& addr) const {
     ConstHostPtr host = getCfgHosts()->get6(subnet_id, addr);
     if (!host && alternate_source_) {
+        MultiThreadingLock lock(*mutex_);
         LOG_DEBUG(hosts_logger, HOSTS_DBG_TRACE,
                   HOSTS_MGR_ALTERNATE_GET6_SUBNET_ID_ADDRESS6)
             .arg(subnet_id)
@@ -268,7 +466,11 @@ HostMgr::add(const HostPtr& host) {
         isc_throw(NoHostDataSourceManager, "Unable to add new host because there is "
                   "no hosts-database configured.");
     }
+    MultiThreadingLock lock(*mutex_);
     alternate_source_->add(host);
+    if (cache_) {
+        cache_->invalidate(*host);
+    }
 }
 
 bool
@@ -278,7 +480,12 @@ HostMgr::del(const SubnetID& subnet_id, const asiolink::IOAddress& addr) {
                   "no hosts-database configured.");
     }
 
-    return (alternate_source_->del(subnet_id, addr));
+    MultiThreadingLock lock(*mutex_);
+    bool deleted = alternate_source_->del(subnet_id, addr);
+    if (deleted && cache_) {
+        cache_->flush();
+    }
+    return (deleted);
 }
 
 bool
@@ -289,8 +496,13 @@ HostMgr::del4(const SubnetID& subnet_id, const Host::IdentifierType& identifier_
                   "no hosts-database configured.");
     }
 
-    return (alternate_source_->del4(subnet_id, identifier_type,
-                                    identifier_begin, identifier_len));
+    MultiThreadingLock lock(*mutex_);
+    bool deleted = alternate_source_->del4(subnet_id, identifier_type,
+                                           identifier_begin, identifier_len);
+    if (deleted && cache_) {
+        cache_->flush();
+    }
+    return (deleted);
 }
 
 bool
@@ -301,8 +513,23 @@ HostMgr::del6(const SubnetID& subnet_id, const Host::IdentifierType& identifier_
                   "no alternate host data source present");
     }
 
-    return (alternate_source_->del6(subnet_id, identifier_type,
-                                    identifier_begin, identifier_len));
+    MultiThreadingLock lock(*mutex_);
+    bool deleted = alternate_source_->del6(subnet_id, identifier_type,
+                                           identifier_begin, identifier_len);
+    if (deleted && cache_) {
+        cache_->flush();
+    }
+    return (deleted);
+}
+
+bool
+HostMgr::flushCache() {
+    if (!cache_) {
+        return (false);
+    }
+    cache_->flush();
+    LOG_INFO(hosts_logger, HOSTS_MGR_CACHE_FLUSHED);
+    return (true);
 }
 
 } // end of isc::dhcp namespace
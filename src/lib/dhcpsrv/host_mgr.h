@@ -9,9 +9,12 @@
 
 #include <dhcp/duid.h>
 #include <dhcp/hwaddr.h>
+#include <dhcp/option.h>
 #include <dhcpsrv/base_host_data_source.h>
 #include <dhcpsrv/host.h>
+#include <dhcpsrv/host_cache.h>
 #include <dhcpsrv/subnet_id.h>
+#include <util/threads/sync.h>
 #include <boost/noncopyable.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <string>
@@ -52,6 +55,14 @@ namespace dhcp {
 /// reconfiguration. However, the use of the primary host data source (i.e.
 /// reservations specified in the configuration file) can't be disabled.
 ///
+/// The results of the lookups by the host identifier made in the alternate
+/// data source can be cached (see @c HostCache). The cache is enabled with
+/// the "cache-size" parameter of the host data source access string. The
+/// cached entries of a host are removed when the host is added with @c add.
+/// All cached entries are removed when a host is deleted, because the
+/// deleted host may be cached for its IPv4 and IPv6 subnets, and when
+/// @c flushCache is called.
+///
 /// @todo Implement alternate host data sources: MySQL, PostgreSQL, etc.
 class HostMgr : public boost::noncopyable, public BaseHostDataSource {
 public:
@@ -66,8 +77,9 @@ public:
     /// host data source. It holds "keyword=value" pairs, separated by spaces.
     /// The supported values are specific to the alternate data source in use.
     /// However, the "type" parameter will be common and it will specify which
-    /// data source is to be used. Currently, no parameters are supported
-    /// and the parameter is ignored.
+    /// data source is to be used. The "cache-size" and "cache-ttl"
+    /// parameters configure the cache of the hosts returned by the alternate
+    /// host data source.
     static void create(const std::string& access = "");
 
     /// @brief Returns a sole instance of the @c HostMgr.
@@ -190,6 +202,24 @@ public:
     virtual ConstHostPtr
     get4(const SubnetID& subnet_id, const asiolink::IOAddress& address) const;
 
+    /// @brief Returns hosts connected to the IPv4 subnet using any of the
+    /// specified identifiers.
+    ///
+    /// For each identifier, the reservation specified in the configuration
+    /// file takes precedence over the reservation in the alternate data
+    /// source, like in @c get4. The identifiers for which no reservation
+    /// is configured are looked up in the alternate data source using a
+    /// single query.
+    ///
+    /// @param subnet_id Subnet identifier.
+    /// @param identifiers Identifiers of the client ordered by priority.
+    ///
+    /// @return Collection of const @c Host objects ordered by the priority
+    /// of the identifiers used to find them.
+    virtual ConstHostCollection
+    getByIdentifiers4(const SubnetID& subnet_id,
+                      const HostIdentifierList& identifiers) const;
+
     /// @brief Returns a host connected to the IPv6 subnet.
     ///
     /// This method returns a host connected to the IPv6 subnet and identified
@@ -223,6 +253,20 @@ public:
     get6(const SubnetID& subnet_id, const Host::IdentifierType& identifier_type,
          const uint8_t* identifier_begin, const size_t identifier_len) const;
 
+    /// @brief Returns hosts connected to the IPv6 subnet using any of the
+    /// specified identifiers.
+    ///
+    /// This is the IPv6 counterpart of @c getByIdentifiers4.
+    ///
+    /// @param subnet_id Subnet identifier.
+    /// @param identifiers Identifiers of the client ordered by priority.
+    ///
+    /// @return Collection of const @c Host objects ordered by the priority
+    /// of the identifiers used to find them.
+    virtual ConstHostCollection
+    getByIdentifiers6(const SubnetID& subnet_id,
+                      const HostIdentifierList& identifiers) const;
+
     /// @brief Returns a host using the specified IPv6 prefix.
     ///
     /// This method returns a host using specified IPv6 prefix, as described
@@ -285,6 +329,29 @@ public:
         alternate_source_ = source;
     }
 
+    /// @brief Returns pointer to the host cache.
+    ///
+    /// @return pointer to the host cache (or NULL if the cache is disabled)
+    HostCachePtr getHostCache() const {
+        return (cache_);
+    }
+
+    /// @brief Sets the host cache.
+    ///
+    /// Note: This should be used only for testing. The cache is normally
+    /// created by HostMgr::create(...) from the host data source access
+    /// parameters.
+    ///
+    /// @param cache new cache to be set (may be NULL)
+    void setTestHostCache(const HostCachePtr& cache) {
+        cache_ = cache;
+    }
+
+    /// @brief Removes all entries from the host cache.
+    ///
+    /// @return true if the cache is enabled, false otherwise.
+    bool flushCache();
+
     /// @brief Attempts to delete a host by address.
     ///
     /// This method supports both v4 and v6.
@@ -325,13 +392,42 @@ public:
 private:
 
     /// @brief Private default constructor.
-    HostMgr() { }
+    HostMgr() : alternate_source_(), cache_(),
+                mutex_(new isc::util::thread::Mutex()) { }
+
+    /// @brief Returns hosts from the alternate data source using any of
+    /// the specified identifiers.
+    ///
+    /// The results cached for the identifiers are used. The remaining
+    /// identifiers are looked up using a single query and the results
+    /// are cached.
+    ///
+    /// @param universe @c Option::V4 to return hosts connected to the IPv4
+    /// subnet, @c Option::V6 to return hosts connected to the IPv6 subnet.
+    /// @param subnet_id Subnet identifier.
+    /// @param identifiers Identifiers to be used.
+    ///
+    /// @return Collection of const @c Host objects in no particular order.
+    ConstHostCollection
+    getAlternateByIdentifiers(const Option::Universe& universe,
+                              const SubnetID& subnet_id,
+                              const HostIdentifierList& identifiers) const;
 
     /// @brief Pointer to an alternate host data source.
     ///
     /// If this pointer is NULL, the source is not in use.
     HostDataSourcePtr alternate_source_;
 
+    /// @brief Pointer to the cache of the hosts returned by the alternate
+    /// host data source.
+    ///
+    /// If this pointer is NULL, the cache is disabled.
+    HostCachePtr cache_;
+
+    /// @brief Mutex serializing the calls to the alternate host data
+    /// source in the multi-threading mode.
+    boost::scoped_ptr<isc::util::thread::Mutex> mutex_;
+
     /// @brief Returns a pointer to the currently used instance of the
     /// @c HostMgr.
     static boost::scoped_ptr<HostMgr>& getHostMgrPtr();
@@ -210,6 +210,9 @@ struct Lease : public isc::data::CfgToElement {
     virtual void decline(uint32_t probation_period) = 0;
 };
 
+/// @brief Pointer to the lease object
+typedef boost::shared_ptr<Lease> LeasePtr;
+
 /// @brief Structure that holds a lease for IPv4 address
 ///
 /// For performance reasons it is a simple structure, not a class. If we chose
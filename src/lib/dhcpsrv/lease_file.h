@@ -0,0 +1,156 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef LEASE_FILE_H
+#define LEASE_FILE_H
+
+#include <dhcpsrv/lease.h>
+#include <dhcpsrv/lease_file_stats.h>
+#include <boost/shared_ptr.hpp>
+#include <string>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Formats of the lease files.
+enum LeaseFileFormat {
+    /// Text file with one row of comma separated values per lease entry.
+    LEASE_FILE_CSV,
+    /// Binary file with one length prefixed and checksummed record per
+    /// lease entry.
+    LEASE_FILE_BINARY
+};
+
+/// @brief Interface of the files holding DHCPv4 leases.
+///
+/// It is implemented by the @c CSVLeaseFile4 and @c BinaryLeaseFile4
+/// so as the @c Memfile_LeaseMgr and the LFC can record and read lease
+/// updates regardless of the format of the lease file.
+class LeaseFile4 : public LeaseFileStats {
+public:
+
+    /// @brief Destructor.
+    virtual ~LeaseFile4() { }
+
+    /// @brief Opens the lease file.
+    ///
+    /// @param seek_to_end A boolean value which indicates if the input and
+    /// output file pointer should be set at the end of file.
+    virtual void open(const bool seek_to_end = false) = 0;
+
+    /// @brief Closes the lease file.
+    virtual void close() = 0;
+
+    /// @brief Checks if the lease file exists.
+    virtual bool exists() const = 0;
+
+    /// @brief Returns the path to the lease file.
+    virtual std::string getFilename() const = 0;
+
+    /// @brief Returns the description of the last error reading the file.
+    virtual std::string getReadMsg() const = 0;
+
+    /// @brief Checks if the lease file should be rewritten in the current
+    /// version of its format.
+    virtual bool needsConversion() const = 0;
+
+    /// @brief Enables or disables flushing the lease file after each entry.
+    ///
+    /// The entries are flushed by default. When disabled, the entries are
+    /// buffered until @c flush is called.
+    ///
+    /// @param auto_flush true if each entry should be flushed.
+    virtual void setAutoFlush(const bool auto_flush) = 0;
+
+    /// @brief Writes the buffered entries to the lease file.
+    virtual void flush() = 0;
+
+    /// @brief Waits until the flushed entries are stored on the disk.
+    virtual void sync() = 0;
+
+    /// @brief Appends the lease entry to the lease file.
+    ///
+    /// @param lease Structure representing a DHCPv4 lease.
+    virtual void append(const Lease4& lease) = 0;
+
+    /// @brief Reads next lease entry from the lease file.
+    ///
+    /// @param [out] lease Pointer to the lease read or NULL pointer at
+    /// the end of file or when the lease hasn't been read.
+    ///
+    /// @return false if an error occurred, true otherwise.
+    virtual bool next(Lease4Ptr& lease) = 0;
+};
+
+/// @brief Pointer to the DHCPv4 lease file.
+typedef boost::shared_ptr<LeaseFile4> LeaseFile4Ptr;
+
+/// @brief Interface of the files holding DHCPv6 leases.
+///
+/// It is implemented by the @c CSVLeaseFile6 and @c BinaryLeaseFile6.
+class LeaseFile6 : public LeaseFileStats {
+public:
+
+    /// @brief Destructor.
+    virtual ~LeaseFile6() { }
+
+    /// @brief Opens the lease file.
+    ///
+    /// @param seek_to_end A boolean value which indicates if the input and
+    /// output file pointer should be set at the end of file.
+    virtual void open(const bool seek_to_end = false) = 0;
+
+    /// @brief Closes the lease file.
+    virtual void close() = 0;
+
+    /// @brief Checks if the lease file exists.
+    virtual bool exists() const = 0;
+
+    /// @brief Returns the path to the lease file.
+    virtual std::string getFilename() const = 0;
+
+    /// @brief Returns the description of the last error reading the file.
+    virtual std::string getReadMsg() const = 0;
+
+    /// @brief Checks if the lease file should be rewritten in the current
+    /// version of its format.
+    virtual bool needsConversion() const = 0;
+
+    /// @brief Enables or disables flushing the lease file after each entry.
+    ///
+    /// The entries are flushed by default. When disabled, the entries are
+    /// buffered until @c flush is called.
+    ///
+    /// @param auto_flush true if each entry should be flushed.
+    virtual void setAutoFlush(const bool auto_flush) = 0;
+
+    /// @brief Writes the buffered entries to the lease file.
+    virtual void flush() = 0;
+
+    /// @brief Waits until the flushed entries are stored on the disk.
+    virtual void sync() = 0;
+
+    /// @brief Appends the lease entry to the lease file.
+    ///
+    /// @param lease Structure representing a DHCPv6 lease.
+    virtual void append(const Lease6& lease) = 0;
+
+    /// @brief Reads next lease entry from the lease file.
+    ///
+    /// @param [out] lease Pointer to the lease read or NULL pointer at
+    /// the end of file or when the lease hasn't been read.
+    ///
+    /// @return false if an error occurred, true otherwise.
+    virtual bool next(Lease6Ptr& lease) = 0;
+};
+
+/// @brief Pointer to the DHCPv6 lease file.
+typedef boost::shared_ptr<LeaseFile6> LeaseFile6Ptr;
+
+} // namespace isc::dhcp
+} // namespace isc
+
+#endif // LEASE_FILE_H
@@ -0,0 +1,152 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <dhcpsrv/binary_lease_file.h>
+#include <dhcpsrv/lease_file_loader.h>
+#include <util/threads/thread.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace isc::util;
+using namespace isc::util::thread;
+
+namespace isc {
+namespace dhcp {
+
+LeaseFileMapping::LeaseFileMapping(const std::string& filename)
+    : data_(0), size_(0) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        isc_throw(CSVFileError, "unable to open '" << filename << "': "
+                  << strerror(errno));
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        const int err = errno;
+        ::close(fd);
+        isc_throw(CSVFileError, "unable to get the size of '" << filename
+                  << "': " << strerror(err));
+    }
+
+    // An empty file can't be mapped but it holds no rows anyway.
+    if (st.st_size > 0) {
+        void* data = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            const int err = errno;
+            ::close(fd);
+            isc_throw(CSVFileError, "unable to map '" << filename
+                      << "' into memory: " << strerror(err));
+        }
+        // The file is read once from the beginning to the end.
+        static_cast<void>(madvise(data, st.st_size, MADV_SEQUENTIAL));
+        data_ = static_cast<const char*>(data);
+        size_ = st.st_size;
+    }
+
+    // The mapping remains valid after the file is closed.
+    ::close(fd);
+}
+
+LeaseFileMapping::~LeaseFileMapping() {
+    if (data_) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+std::vector<LeaseFileMapping::Range>
+LeaseFileMapping::split(const size_t count) const {
+    std::vector<Range> ranges;
+    if (!data_ || (count == 0)) {
+        return (ranges);
+    }
+
+    // Skip the header.
+    const char* end = data_ + size_;
+    const char* begin = static_cast<const char*>(memchr(data_, '\n', size_));
+    if (!begin) {
+        return (ranges);
+    }
+    ++begin;
+
+    const size_t length = end - begin;
+    for (size_t i = 1; (i <= count) && (begin < end); ++i) {
+        // Move the end of the range after the end of the row.
+        const char* range_end = data_ + (size_ - length) + (length * i) / count;
+        if (range_end < begin) {
+            range_end = begin;
+        }
+        if (range_end < end) {
+            const char* row_end = static_cast<const char*>
+                (memchr(range_end, '\n', end - range_end));
+            range_end = (row_end ? row_end + 1 : end);
+        }
+        if (range_end > begin) {
+            ranges.push_back(Range(begin, range_end));
+            begin = range_end;
+        }
+    }
+
+    return (ranges);
+}
+
+LeaseFileFormat
+LeaseFileLoader::detectFormat(const std::string& filename,
+                              const LeaseFileFormat default_format) {
+    struct stat st;
+    if ((stat(filename.c_str(), &st) != 0) || (st.st_size == 0)) {
+        return (default_format);
+    }
+    return (BinaryLeaseFile::hasBinaryHeader(filename) ? LEASE_FILE_BINARY :
+            LEASE_FILE_CSV);
+}
+
+void
+LeaseFileLoader::runTasks(const std::vector<boost::function<void()> >& tasks) {
+    std::vector<boost::shared_ptr<Thread> > threads;
+    try {
+        for (auto task = tasks.begin(); task != tasks.end(); ++task) {
+            threads.push_back(boost::shared_ptr<Thread>(new Thread(*task)));
+        }
+
+    } catch (...) {
+        // The running tasks use the caller's data, so they must complete
+        // before returning.
+        for (auto t = threads.begin(); t != threads.end(); ++t) {
+            try {
+                (*t)->wait();
+            } catch (...) {
+            }
+        }
+        throw;
+    }
+
+    // Wait for all threads before reporting an exception.
+    std::string error;
+    for (auto t = threads.begin(); t != threads.end(); ++t) {
+        try {
+            (*t)->wait();
+        } catch (const std::exception& ex) {
+            if (error.empty()) {
+                error = ex.what();
+            }
+        }
+    }
+    if (!error.empty()) {
+        isc_throw(Thread::UncaughtException, error);
+    }
+}
+
+} // namespace isc::dhcp
+} // namespace isc
@@ -7,15 +7,76 @@
 #ifndef LEASE_FILE_LOADER_H
 #define LEASE_FILE_LOADER_H
 
+#include <asiolink/io_address.h>
 #include <dhcpsrv/dhcpsrv_log.h>
+#include <dhcpsrv/lease_file.h>
 #include <dhcpsrv/memfile_lease_storage.h>
+#include <util/threads/multi_threading_mgr.h>
 #include <util/versioned_csv_file.h>
 
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/noncopyable.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace isc {
 namespace dhcp {
 
+/// @brief Read-only memory mapping of a lease file.
+///
+/// It is used by the @c LeaseFileLoader to parse the rows of a lease
+/// file with multiple threads without copying the file contents.
+class LeaseFileMapping : public boost::noncopyable {
+public:
+
+    /// @brief Part of the file holding whole rows.
+    typedef std::pair<const char*, const char*> Range;
+
+    /// @brief Constructor.
+    ///
+    /// Maps the whole file into memory.
+    ///
+    /// @param filename Name of the lease file.
+    ///
+    /// @throw isc::util::CSVFileError if the file can't be opened or
+    /// mapped.
+    explicit LeaseFileMapping(const std::string& filename);
+
+    /// @brief Destructor.
+    ///
+    /// Unmaps the file.
+    ~LeaseFileMapping();
+
+    /// @brief Splits the rows following the header into ranges.
+    ///
+    /// The ranges have approximately the same size and each of them
+    /// begins at the beginning of a row and ends after a new line
+    /// character or at the end of the file. The empty ranges are not
+    /// returned.
+    ///
+    /// @param count Maximum number of ranges.
+    ///
+    /// @return Ranges in the order of the rows in the file.
+    std::vector<Range> split(const size_t count) const;
+
+private:
+
+    /// @brief Pointer to the beginning of the mapped file.
+    const char* data_;
+
+    /// @brief Size of the mapped file.
+    size_t size_;
+};
+
 /// @brief Utility class to manage bulk of leases in the lease files.
 ///
 /// This class exposes methods which allow for bulk loading leases from
@@ -65,8 +126,15 @@ public:
     /// One case when the file is not opened is when the server starts
     /// up, reads the leases in the file and then leaves the file open
     /// for writing future lease updates.
+    /// @param threads Number of threads parsing the lease file. The
+    /// value of 1 reads the file row by row in the calling thread. The
+    /// value of 0 uses one thread per processor. Other values cause the
+    /// file to be parsed by the specified number of threads as described
+    /// for @c loadParallel. The binary lease files are always read record
+    /// by record.
     /// @tparam LeaseObjectType A @c Lease4 or @c Lease6.
-    /// @tparam LeaseFileType A @c CSVLeaseFile4 or @c CSVLeaseFile6.
+    /// @tparam LeaseFileType A @c CSVLeaseFile4, @c CSVLeaseFile6,
+    /// @c BinaryLeaseFile4 or @c BinaryLeaseFile6.
     /// @tparam StorageType A @c Lease4Storage or @c Lease6Storage.
     ///
     /// @throw isc::util::CSVFileError when the maximum number of errors
@@ -75,8 +143,194 @@ public:
              typename StorageType>
     static void load(LeaseFileType& lease_file, StorageType& storage,
                      const uint32_t max_errors = 0xFFFFFFFF,
-                     const bool close_file_on_exit = true) {
+                     const bool close_file_on_exit = true,
+                     const size_t threads = 1) {
+
+        const size_t thread_count = (threads > 0 ? threads :
+            util::thread::MultiThreadingMgr::detectThreadCount());
+        if (thread_count > 1) {
+            loadParallel<LeaseObjectType>(lease_file, storage, max_errors,
+                                          close_file_on_exit, thread_count,
+                                          isCSVLeaseFile(&lease_file));
+        } else {
+            loadSequential<LeaseObjectType>(lease_file, storage, max_errors,
+                                            close_file_on_exit);
+        }
+    }
+
+    /// @brief Load leases from the lease file in any supported format.
+    ///
+    /// The format of the lease file is detected with @c detectFormat. The
+    /// object representing the lease file in this format is created and
+    /// the leases are loaded from it as described for @c load.
+    ///
+    /// The binary lease file marked as a snapshot is loaded with
+    /// @c loadSnapshot when the storage is empty.
+    ///
+    /// @param filename Name of the lease file.
+    /// @param format Format of the lease file to be created if the file
+    /// doesn't exist or is empty.
+    /// @param [out] lease_file Pointer to the object representing the
+    /// lease file.
+    /// @param storage A reference to the container to which leases
+    /// should be inserted.
+    /// @param max_errors Maximum number of corrupted leases in the
+    /// lease file.
+    /// @param close_file_on_exit A boolean flag which indicates if
+    /// the file should be closed after it has been successfully parsed.
+    /// @param threads Number of threads parsing the lease file.
+    /// @tparam LeaseObjectType A @c Lease4 or @c Lease6.
+    /// @tparam CSVLeaseFileType A @c CSVLeaseFile4 or @c CSVLeaseFile6.
+    /// @tparam BinaryLeaseFileType A @c BinaryLeaseFile4 or
+    /// @c BinaryLeaseFile6.
+    /// @tparam LeaseFilePtrType A @c LeaseFile4Ptr or @c LeaseFile6Ptr.
+    /// @tparam StorageType A @c Lease4Storage or @c Lease6Storage.
+    ///
+    /// @throw isc::util::CSVFileError when the maximum number of errors
+    /// has been exceeded.
+    template<typename LeaseObjectType, typename CSVLeaseFileType,
+             typename BinaryLeaseFileType, typename LeaseFilePtrType,
+             typename StorageType>
+    static void loadFile(const std::string& filename,
+                         const LeaseFileFormat format,
+                         LeaseFilePtrType& lease_file, StorageType& storage,
+                         const uint32_t max_errors = 0xFFFFFFFF,
+                         const bool close_file_on_exit = true,
+                         const size_t threads = 1) {
+        if (detectFormat(filename, format) == LEASE_FILE_BINARY) {
+            boost::shared_ptr<BinaryLeaseFileType>
+                binary_file(new BinaryLeaseFileType(filename));
+            lease_file = binary_file;
+            binary_file->open();
+            if (storage.empty() && binary_file->isSnapshot()) {
+                loadSnapshot<LeaseObjectType>(*binary_file, storage,
+                                              max_errors, close_file_on_exit);
+            } else {
+                load<LeaseObjectType>(*binary_file, storage, max_errors,
+                                      close_file_on_exit, threads);
+            }
+
+        } else {
+            boost::shared_ptr<CSVLeaseFileType>
+                csv_file(new CSVLeaseFileType(filename));
+            lease_file = csv_file;
+            load<LeaseObjectType>(*csv_file, storage, max_errors,
+                                  close_file_on_exit, threads);
+        }
+    }
+
+    /// @brief Returns the format of the lease file.
+    ///
+    /// @param filename Name of the lease file.
+    /// @param default_format Format returned if the file doesn't exist
+    /// or is empty.
+    ///
+    /// @return @c LEASE_FILE_BINARY if the file begins with the binary
+    /// lease file header, @c LEASE_FILE_CSV if it holds other data.
+    static LeaseFileFormat detectFormat(const std::string& filename,
+                                        const LeaseFileFormat default_format);
+
+    /// @brief Copies the lease entries from one lease file to another.
+    ///
+    /// This method is used to convert the lease file from one format to
+    /// another. All entries are copied in the order of the input file,
+    /// including the entries with the valid lifetime of 0, so the leases
+    /// loaded from the output file are the same as the leases loaded from
+    /// the input file. The corrupted entries are skipped.
+    ///
+    /// Both files are reopened and closed when the method completes. The
+    /// entries are appended to the output file, so it should not exist.
+    ///
+    /// @param input A reference to the input lease file.
+    /// @param output A reference to the output lease file.
+    /// @param max_errors Maximum number of corrupted leases in the
+    /// input file.
+    /// @tparam LeaseObjectType A @c Lease4 or @c Lease6.
+    /// @tparam InputFileType Type of the input lease file, e.g.
+    /// @c CSVLeaseFile4 or @c LeaseFile4.
+    /// @tparam OutputFileType Type of the output lease file, e.g.
+    /// @c BinaryLeaseFile4 or @c LeaseFile4.
+    ///
+    /// @throw isc::util::CSVFileError when the maximum number of errors
+    /// has been exceeded.
+    template<typename LeaseObjectType, typename InputFileType,
+             typename OutputFileType>
+    static void convert(InputFileType& input, OutputFileType& output,
+                        const uint32_t max_errors = 0xFFFFFFFF) {
+        LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_LEASE_FILE_CONVERT)
+            .arg(input.getFilename())
+            .arg(output.getFilename());
+
+        input.close();
+        input.open();
+        try {
+            output.close();
+            output.open(true);
+
+        } catch (...) {
+            input.close();
+            throw;
+        }
+
+        boost::shared_ptr<LeaseObjectType> lease;
+        uint32_t errcnt = 0;
+        while (true) {
+            if (!input.next(lease)) {
+                LOG_ERROR(dhcpsrv_logger, DHCPSRV_MEMFILE_LEASE_LOAD_ROW_ERROR)
+                    .arg(input.getReads())
+                    .arg(input.getReadMsg());
+
+                if (++errcnt > max_errors) {
+                    input.close();
+                    output.close();
+                    isc_throw(util::CSVFileError, "exceeded maximum number of"
+                              " failures " << max_errors << " to read a lease"
+                              " from the lease file " << input.getFilename());
+                }
+                continue;
+            }
+
+            // End of file.
+            if (!lease) {
+                break;
+            }
 
+            try {
+                output.append(*lease);
+
+            } catch (...) {
+                input.close();
+                output.close();
+                throw;
+            }
+        }
+
+        input.close();
+        output.close();
+    }
+
+private:
+
+    /// @brief Load leases from the lease file entry by entry.
+    ///
+    /// @param lease_file A reference to the lease file.
+    /// @param storage A reference to the container to which leases
+    /// should be inserted.
+    /// @param max_errors Maximum number of corrupted leases in the
+    /// lease file.
+    /// @param close_file_on_exit A boolean flag which indicates if
+    /// the file should be closed after it has been successfully parsed.
+    /// @tparam LeaseObjectType A @c Lease4 or @c Lease6.
+    /// @tparam LeaseFileType Type of the lease file.
+    /// @tparam StorageType A @c Lease4Storage or @c Lease6Storage.
+    ///
+    /// @throw isc::util::CSVFileError when the maximum number of errors
+    /// has been exceeded.
+    template<typename LeaseObjectType, typename LeaseFileType,
+             typename StorageType>
+    static void loadSequential(LeaseFileType& lease_file, StorageType& storage,
+                               const uint32_t max_errors,
+                               const bool close_file_on_exit) {
         LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_LEASE_FILE_LOAD)
             .arg(lease_file.getFilename());
 
@@ -151,21 +405,90 @@ public:
             }
         }
 
-        if (lease_file.needsConversion()) {
-            LOG_WARN(dhcpsrv_logger,
-                     (lease_file.getInputSchemaState()
-                      == util::VersionedCSVFile::NEEDS_UPGRADE
-                      ?  DHCPSRV_MEMFILE_NEEDS_UPGRADING
-                      : DHCPSRV_MEMFILE_NEEDS_DOWNGRADING))
-                     .arg(lease_file.getFilename())
-                     .arg(lease_file.getSchemaVersion());
+        logConversion(lease_file);
+
+        if (close_file_on_exit) {
+            lease_file.close();
         }
+    }
+
+    /// @brief Load leases from the snapshot of the lease database.
+    ///
+    /// The snapshot holds one entry for each lease, ordered by address,
+    /// so the leases are not looked up in the storage. They are read
+    /// first and then inserted in bulk at the end of the primary index.
+    /// The entries for the same address, which may only be found in a
+    /// corrupted file, override the previous ones.
+    ///
+    /// @param lease_file A reference to the open lease file.
+    /// @param storage A reference to the empty container to which leases
+    /// should be inserted.
+    /// @param max_errors Maximum number of corrupted leases in the
+    /// lease file.
+    /// @param close_file_on_exit A boolean flag which indicates if
+    /// the file should be closed after it has been successfully parsed.
+    /// @tparam LeaseObjectType A @c Lease4 or @c Lease6.
+    /// @tparam LeaseFileType A @c BinaryLeaseFile4 or @c BinaryLeaseFile6.
+    /// @tparam StorageType A @c Lease4Storage or @c Lease6Storage.
+    ///
+    /// @throw isc::util::CSVFileError when the maximum number of errors
+    /// has been exceeded.
+    template<typename LeaseObjectType, typename LeaseFileType,
+             typename StorageType>
+    static void loadSnapshot(LeaseFileType& lease_file, StorageType& storage,
+                             const uint32_t max_errors,
+                             const bool close_file_on_exit) {
+        typedef boost::shared_ptr<LeaseObjectType> LeasePtrType;
+
+        LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_LEASE_FILE_LOAD_SNAPSHOT)
+            .arg(lease_file.getFilename());
+
+        std::vector<LeasePtrType> leases;
+        LeasePtrType lease;
+        uint32_t errcnt = 0;
+        while (true) {
+            if (!lease_file.next(lease)) {
+                LOG_ERROR(dhcpsrv_logger, DHCPSRV_MEMFILE_LEASE_LOAD_ROW_ERROR)
+                    .arg(lease_file.getReads())
+                    .arg(lease_file.getReadMsg());
+
+                if (++errcnt > max_errors) {
+                    lease_file.close();
+                    isc_throw(util::CSVFileError, "exceeded maximum number of"
+                              " failures " << max_errors << " to read a lease"
+                              " from the lease file "
+                              << lease_file.getFilename());
+                }
+                continue;
+            }
+
+            // End of file.
+            if (!lease) {
+                break;
+            }
+
+            if (lease->valid_lft_ > 0) {
+                leases.push_back(lease);
+            }
+        }
+
+        for (auto it = leases.begin(); it != leases.end(); ++it) {
+            typename StorageType::iterator lease_it =
+                storage.insert(storage.end(), *it);
+            if (*lease_it != *it) {
+                storage.replace(lease_it, *it);
+            }
+        }
+
+        logConversion(lease_file);
 
         if (close_file_on_exit) {
             lease_file.close();
         }
     }
 
+public:
+
     /// @brief Write leases from the storage into a lease file
     ///
     /// This method iterates over the @c Lease4 or @c Lease6 object in the
@@ -200,10 +523,19 @@ public:
         lease_file.close();
         lease_file.open();
 
+#ifdef ENABLE_MEMFILE_HASHED_INDEXES
+        // The leases in the storage with hashed indexes are not ordered,
+        // so they have to be sorted by address before they are written.
+        std::vector<typename StorageType::value_type> leases(storage.begin(),
+                                                             storage.end());
+        std::sort(leases.begin(), leases.end(),
+                  lessByAddress<typename StorageType::value_type>);
+#else
+        const StorageType& leases = storage;
+#endif
+
         // Iterate over the storage area writing out the leases
-        for (typename StorageType::const_iterator lease = storage.begin();
-             lease != storage.end();
-             ++lease) {
+        for (auto lease = leases.begin(); lease != leases.end(); ++lease) {
             try {
                 lease_file.append(**lease);
             } catch (const isc::Exception&) {
@@ -216,6 +548,315 @@ public:
         // Close the file
         lease_file.close();
     }
+
+private:
+
+    /// @brief Results of parsing a part of the lease file.
+    ///
+    /// @tparam LeasePtrType A @c Lease4Ptr or @c Lease6Ptr.
+    template<typename LeasePtrType>
+    struct ParsedRows {
+        /// @brief Constructor.
+        ///
+        /// @param partitions Number of partitions of the leases.
+        explicit ParsedRows(const size_t partitions = 0)
+            : leases_(partitions), rows_(0) {
+        }
+
+        /// @brief Leases created from the rows in the order of the rows.
+        ///
+        /// The leases are partitioned by the hash of their addresses, so
+        /// all entries for an address are in the same partition.
+        std::vector<std::vector<LeasePtrType> > leases_;
+
+        /// @brief Indexes of the rows which couldn't be parsed and the
+        /// error messages.
+        std::vector<std::pair<size_t, std::string> > errors_;
+
+        /// @brief Number of rows in this part of the file.
+        size_t rows_;
+    };
+
+    /// @brief Loads leases from the lease file using multiple threads.
+    ///
+    /// The file is mapped into memory and split into as many parts as
+    /// there are threads. Each thread parses the rows of its part and
+    /// creates the leases. Then each thread takes one partition of the
+    /// created leases (by the hash of the address) and keeps the last
+    /// entry for each address, so the entries further in the file
+    /// override the previous ones. Finally, the leases with a positive
+    /// valid lifetime which are not in the storage are inserted at once
+    /// and the existing leases are updated or removed.
+    ///
+    /// The rows which can't be parsed are reported in the order of the
+    /// file before the storage is modified.
+    ///
+    /// @param lease_file A reference to the @c CSVLeaseFile4 or
+    /// @c CSVLeaseFile6 object representing the lease file.
+    /// @param storage A reference to the container to which leases
+    /// should be inserted.
+    /// @param max_errors Maximum number of corrupted leases in the
+    /// lease file.
+    /// @param close_file_on_exit A boolean flag which indicates if
+    /// the file should be closed after it has been successfully parsed.
+    /// @param threads Number of threads.
+    /// @tparam LeaseObjectType A @c Lease4 or @c Lease6.
+    /// @tparam LeaseFileType A @c CSVLeaseFile4 or @c CSVLeaseFile6.
+    /// @tparam StorageType A @c Lease4Storage or @c Lease6Storage.
+    ///
+    /// @throw isc::util::CSVFileError when the maximum number of errors
+    /// has been exceeded or the file can't be mapped.
+    template<typename LeaseObjectType, typename LeaseFileType,
+             typename StorageType>
+    static void loadParallel(LeaseFileType& lease_file, StorageType& storage,
+                             const uint32_t max_errors,
+                             const bool close_file_on_exit,
+                             const size_t threads, boost::true_type) {
+        typedef boost::shared_ptr<LeaseObjectType> LeasePtrType;
+
+        LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_LEASE_FILE_LOAD_PARALLEL)
+            .arg(lease_file.getFilename())
+            .arg(threads);
+
+        // Reopen the file. This validates the header and creates the
+        // file if it doesn't exist.
+        lease_file.close();
+        lease_file.open();
+
+        std::vector<ParsedRows<LeasePtrType> > parts;
+        std::vector<boost::function<void()> > tasks;
+        try {
+            LeaseFileMapping mapping(lease_file.getFilename());
+            std::vector<LeaseFileMapping::Range> ranges = mapping.split(threads);
+            parts.resize(ranges.size(), ParsedRows<LeasePtrType>(threads));
+            for (size_t i = 0; i < ranges.size(); ++i) {
+                tasks.push_back(boost::bind(&LeaseFileLoader::parseRows<LeaseFileType,
+                                                                        LeasePtrType>,
+                                            boost::cref(lease_file), ranges[i],
+                                            boost::ref(parts[i])));
+            }
+            runTasks(tasks);
+
+        } catch (...) {
+            lease_file.close();
+            throw;
+        }
+
+        // Report the errors in the order of the rows.
+        uint32_t reads = 0;
+        uint32_t errcnt = 0;
+        for (size_t i = 0; i < parts.size(); ++i) {
+            for (size_t j = 0; j < parts[i].errors_.size(); ++j) {
+                LOG_ERROR(dhcpsrv_logger, DHCPSRV_MEMFILE_LEASE_LOAD_ROW_ERROR)
+                    .arg(reads + parts[i].errors_[j].first + 1)
+                    .arg(parts[i].errors_[j].second);
+
+                if (++errcnt > max_errors) {
+                    lease_file.close();
+                    isc_throw(util::CSVFileError, "exceeded maximum number of"
+                              " failures " << max_errors << " to read a lease"
+                              " from the lease file "
+                              << lease_file.getFilename());
+                }
+            }
+            reads += parts[i].rows_;
+        }
+        // The last attempt to read a lease finds the end of file.
+        lease_file.addReadStatistics(reads + 1, reads - errcnt, errcnt);
+
+        // Find the last entry for each address.
+        std::vector<std::vector<LeasePtrType> > leases(threads);
+        tasks.clear();
+        for (size_t i = 0; i < threads; ++i) {
+            tasks.push_back(boost::bind(&LeaseFileLoader::mergeLeases<LeasePtrType>,
+                                        boost::cref(parts), i,
+                                        boost::ref(leases[i])));
+        }
+        try {
+            runTasks(tasks);
+
+        } catch (...) {
+            lease_file.close();
+            throw;
+        }
+        parts.clear();
+
+        std::vector<LeasePtrType> inserted;
+        for (size_t i = 0; i < leases.size(); ++i) {
+            for (auto lease = leases[i].begin(); lease != leases[i].end();
+                 ++lease) {
+                LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL_DATA,
+                          DHCPSRV_MEMFILE_LEASE_LOAD)
+                    .arg((*lease)->toText());
+
+                // The storage holds the leases from the previous lease
+                // files, if any.
+                typename StorageType::iterator lease_it =
+                    storage.find((*lease)->addr_);
+                if (lease_it == storage.end()) {
+                    if ((*lease)->valid_lft_ > 0) {
+                        inserted.push_back(*lease);
+                    }
+
+                } else if ((*lease)->valid_lft_ == 0) {
+                    storage.erase(lease_it);
+
+                } else {
+                    storage.replace(lease_it, *lease);
+                }
+            }
+        }
+        storage.insert(inserted.begin(), inserted.end());
+
+        logConversion(lease_file);
+
+        if (close_file_on_exit) {
+            lease_file.close();
+        }
+    }
+
+    /// @brief Loads leases from the lease file which can't be parsed by
+    /// multiple threads.
+    ///
+    /// It is used for the binary lease files which are loaded entry by
+    /// entry regardless of the number of threads.
+    template<typename LeaseObjectType, typename LeaseFileType,
+             typename StorageType>
+    static void loadParallel(LeaseFileType& lease_file, StorageType& storage,
+                             const uint32_t max_errors,
+                             const bool close_file_on_exit,
+                             const size_t, boost::false_type) {
+        loadSequential<LeaseObjectType>(lease_file, storage, max_errors,
+                                        close_file_on_exit);
+    }
+
+    /// @name Functions selecting the variant of the @c loadParallel.
+    ///
+    //@{
+    ///
+    /// @brief Selects the parallel load for the CSV lease files.
+    static boost::true_type isCSVLeaseFile(const util::VersionedCSVFile*) {
+        return (boost::true_type());
+    }
+
+    /// @brief Selects the sequential load for other lease files.
+    static boost::false_type isCSVLeaseFile(const void*) {
+        return (boost::false_type());
+    }
+    //@}
+
+    /// @brief Parses the rows held in a part of the lease file.
+    ///
+    /// It is run by multiple threads, each with its own part of the file.
+    /// The rows are parsed in the same way as by the @c next method of
+    /// the lease file. In particular, the rows which don't match the
+    /// schema of the file are errors and the last row of the file is
+    /// parsed even if it isn't terminated with a new line character.
+    ///
+    /// @param lease_file A reference to the lease file.
+    /// @param range Part of the file to be parsed.
+    /// @param [out] parsed Leases created and errors found.
+    /// @tparam LeaseFileType A @c CSVLeaseFile4 or @c CSVLeaseFile6.
+    /// @tparam LeasePtrType A @c Lease4Ptr or @c Lease6Ptr.
+    template<typename LeaseFileType, typename LeasePtrType>
+    static void parseRows(const LeaseFileType& lease_file,
+                          const LeaseFileMapping::Range& range,
+                          ParsedRows<LeasePtrType>& parsed) {
+        boost::hash<asiolink::IOAddress> hasher;
+        std::string line;
+        const char* row_begin = range.first;
+        while (row_begin < range.second) {
+            const char* row_end = static_cast<const char*>
+                (memchr(row_begin, '\n', range.second - row_begin));
+            if (!row_end) {
+                row_end = range.second;
+            }
+            try {
+                line.assign(row_begin, row_end);
+                util::CSVRow row(line);
+                std::string read_msg;
+                if (!lease_file.adjustRow(row, read_msg)) {
+                    isc_throw(isc::BadValue, read_msg);
+                }
+                LeasePtrType lease = lease_file.readLease(row);
+                parsed.leases_[hasher(lease->addr_) % parsed.leases_.size()].
+                    push_back(lease);
+
+            } catch (const std::exception& ex) {
+                parsed.errors_.push_back(std::make_pair(parsed.rows_,
+                                                        std::string(ex.what())));
+            }
+            ++parsed.rows_;
+            row_begin = row_end + 1;
+        }
+    }
+
+    /// @brief Finds the last entry for each address in a partition.
+    ///
+    /// It is run by multiple threads, each with its own partition of
+    /// the leases.
+    ///
+    /// @param parts Results of parsing the parts of the lease file in
+    /// the order of the parts.
+    /// @param partition Index of the partition.
+    /// @param [out] leases Last entries for the addresses in the
+    /// partition in no particular order.
+    /// @tparam LeasePtrType A @c Lease4Ptr or @c Lease6Ptr.
+    template<typename LeasePtrType>
+    static void mergeLeases(const std::vector<ParsedRows<LeasePtrType> >& parts,
+                            const size_t partition,
+                            std::vector<LeasePtrType>& leases) {
+        boost::unordered_map<asiolink::IOAddress, LeasePtrType> last;
+        for (auto part = parts.begin(); part != parts.end(); ++part) {
+            const std::vector<LeasePtrType>& parsed = part->leases_[partition];
+            for (auto lease = parsed.begin(); lease != parsed.end(); ++lease) {
+                last[(*lease)->addr_] = *lease;
+            }
+        }
+
+        leases.reserve(last.size());
+        for (auto entry = last.begin(); entry != last.end(); ++entry) {
+            leases.push_back(entry->second);
+        }
+    }
+
+    /// @brief Runs the tasks in parallel, each in its own thread.
+    ///
+    /// It returns when all tasks have completed.
+    ///
+    /// @param tasks Tasks to be run.
+    ///
+    /// @throw isc::util::thread::Thread::UncaughtException if a task
+    /// has thrown an exception.
+    static void runTasks(const std::vector<boost::function<void()> >& tasks);
+
+    /// @brief Logs a warning if the lease file needs conversion.
+    ///
+    /// @param lease_file A reference to the lease file.
+    /// @tparam LeaseFileType A @c CSVLeaseFile4 or @c CSVLeaseFile6.
+    template<typename LeaseFileType>
+    static void logConversion(const LeaseFileType& lease_file) {
+        if (lease_file.needsConversion()) {
+            LOG_WARN(dhcpsrv_logger,
+                     (lease_file.getInputSchemaState()
+                      == util::VersionedCSVFile::NEEDS_UPGRADE
+                      ?  DHCPSRV_MEMFILE_NEEDS_UPGRADING
+                      : DHCPSRV_MEMFILE_NEEDS_DOWNGRADING))
+                     .arg(lease_file.getFilename())
+                     .arg(lease_file.getSchemaVersion());
+        }
+    }
+
+    ///
+    /// @param first Pointer to the first lease.
+    /// @param second Pointer to the second lease.
+    /// @return true if the address of the first lease is lower than the
+    /// address of the second lease.
+    template<typename LeasePtrType>
+    static bool lessByAddress(const LeasePtrType& first,
+                              const LeasePtrType& second) {
+        return (first->addr_ < second->addr_);
+    }
 };
 
 }  // namespace dhcp
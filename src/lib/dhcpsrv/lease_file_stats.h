@@ -58,6 +58,21 @@ public:
         return (write_errs_);
     }
 
+    /// @brief Accounts for the leases read outside of the lease file
+    ///
+    /// It is used when the rows of the lease file are parsed by the
+    /// caller rather than read one by one with the @c next method.
+    ///
+    /// @param reads Number of attempts to read a lease
+    /// @param read_leases Number of leases read
+    /// @param read_errs Number of errors when reading
+    void addReadStatistics(const uint32_t reads, const uint32_t read_leases,
+                           const uint32_t read_errs) {
+        reads_       += reads;
+        read_leases_ += read_leases;
+        read_errs_   += read_errs;
+    }
+
     /// @brief Clears the statistics
     void clearStatistics() {
         reads_        = 0;
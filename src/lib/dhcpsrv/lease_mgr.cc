@@ -111,6 +111,59 @@ LeaseMgr::recountLeaseStats4() {
     }
 }
 
+size_t
+LeaseMgr::addLeases(const Lease4Collection& leases) {
+    size_t added = 0;
+    for (auto lease = leases.begin(); lease != leases.end(); ++lease) {
+        if (addLease(*lease)) {
+            ++added;
+        }
+    }
+    return (added);
+}
+
+size_t
+LeaseMgr::addLeases(const Lease6Collection& leases) {
+    size_t added = 0;
+    for (auto lease = leases.begin(); lease != leases.end(); ++lease) {
+        if (addLease(*lease)) {
+            ++added;
+        }
+    }
+    return (added);
+}
+
+void
+LeaseMgr::updateLeases4(const Lease4Collection& leases) {
+    for (auto lease = leases.begin(); lease != leases.end(); ++lease) {
+        updateLease4(*lease);
+    }
+}
+
+void
+LeaseMgr::updateLeases6(const Lease6Collection& leases) {
+    for (auto lease = leases.begin(); lease != leases.end(); ++lease) {
+        updateLease6(*lease);
+    }
+}
+
+size_t
+LeaseMgr::deleteLeases(const std::vector<isc::asiolink::IOAddress>& addrs) {
+    size_t deleted = 0;
+    for (auto addr = addrs.begin(); addr != addrs.end(); ++addr) {
+        if (deleteLease(*addr)) {
+            ++deleted;
+        }
+    }
+    return (deleted);
+}
+
+Lease4Collection
+LeaseMgr::getLeases4(SubnetID) const {
+    isc_throw(NotImplemented, "retrieving leases by subnet identifier is"
+              " not supported by the " << getType() << " lease backend");
+}
+
 LeaseStatsQueryPtr
 LeaseMgr::startLeaseStatsQuery4() {
     return(LeaseStatsQueryPtr());
@@ -267,6 +267,25 @@ public:
     ///         with the same address was already there).
     virtual bool addLease(const Lease6Ptr& lease) = 0;
 
+    /// @brief Adds multiple IPv4 leases.
+    ///
+    /// The leases which can't be added because a lease with the same
+    /// address already exists are skipped. The default implementation
+    /// adds the leases one by one. The database backends add them within
+    /// a single transaction.
+    ///
+    /// @param leases Collection of leases to be added.
+    ///
+    /// @return Number of leases added.
+    virtual size_t addLeases(const Lease4Collection& leases);
+
+    /// @brief Adds multiple IPv6 leases.
+    ///
+    /// @param leases Collection of leases to be added.
+    ///
+    /// @return Number of leases added.
+    virtual size_t addLeases(const Lease6Collection& leases);
+
     /// @brief Returns an IPv4 lease for specified IPv4 address
     ///
     /// This method return a lease that is associated with a given address.
@@ -344,6 +363,20 @@ public:
     virtual Lease4Ptr getLease4(const ClientId& clientid,
                                 SubnetID subnet_id) const = 0;
 
+    /// @brief Returns all IPv4 leases for the particular subnet identifier.
+    ///
+    /// This query is used by the allocation engine to populate the
+    /// address usage bitmaps of the pools (see @ref Pool4::getUsageBitmap).
+    /// The backends which don't support it should not override this
+    /// method, in which case the allocation engine probes the lease
+    /// database for each candidate address.
+    ///
+    /// @param subnet_id subnet identifier.
+    ///
+    /// @return Lease collection (may be empty if no IPv4 lease found).
+    /// @throw NotImplemented if the backend doesn't support this query.
+    virtual Lease4Collection getLeases4(SubnetID subnet_id) const;
+
     /// @brief Returns existing IPv6 lease for a given IPv6 address.
     ///
     /// For a given address, we assume that there will be only one lease.
@@ -459,6 +492,37 @@ public:
     /// @return true if deletion was successful, false if no such lease exists
     virtual bool deleteLease(const isc::asiolink::IOAddress& addr) = 0;
 
+    /// @brief Updates multiple IPv4 leases.
+    ///
+    /// The default implementation updates the leases one by one, so the
+    /// leases preceding the one which doesn't exist remain updated. The
+    /// database backends update the leases within a single transaction
+    /// and don't update any of them in this case.
+    ///
+    /// @param leases Collection of leases to be updated.
+    ///
+    /// @throw NoSuchLease if any of the leases doesn't exist.
+    virtual void updateLeases4(const Lease4Collection& leases);
+
+    /// @brief Updates multiple IPv6 leases.
+    ///
+    /// @param leases Collection of leases to be updated.
+    ///
+    /// @throw NoSuchLease if any of the leases doesn't exist.
+    virtual void updateLeases6(const Lease6Collection& leases);
+
+    /// @brief Deletes multiple leases.
+    ///
+    /// The default implementation deletes the leases one by one. The
+    /// database backends delete them within a single transaction.
+    ///
+    /// @param addrs Addresses of the leases to be deleted. (These can be
+    ///        IPv4 or IPv6.)
+    ///
+    /// @return Number of leases deleted.
+    virtual size_t
+    deleteLeases(const std::vector<isc::asiolink::IOAddress>& addrs);
+
     /// @brief Deletes all expired and reclaimed DHCPv4 leases.
     ///
     /// @param secs Number of seconds since expiration of leases before
@@ -606,6 +670,42 @@ public:
     /// Rolls back all pending database operations.  On databases that don't
     /// support transactions, this is a no-op.
     virtual void rollback() = 0;
+
+    /// @brief Waits until the lease changes are stored persistently.
+    ///
+    /// The servers call this method before sending the responses so as
+    /// the leases they carry are not lost if the server stops abruptly.
+    /// The backends which store each change before the method making it
+    /// returns don't need to wait, which is the default.
+    virtual void flushPending() {
+    }
+
+    /// @brief Stores the lease changes when they are due.
+    ///
+    /// The servers call this method instead of @c flushPending in the
+    /// single-threaded mode, after processing the packets received
+    /// together. The backends storing the changes in groups may leave the
+    /// changes pending, so as they are stored with the changes made for
+    /// the next packets. The pending changes must be stored before the
+    /// returned time elapses, by calling this method or @c flushPending
+    /// again. The default implementation calls @c flushPending.
+    ///
+    /// @return Time in milliseconds after which the pending changes are
+    /// due, 0 if no changes are pending.
+    virtual uint32_t flushDuePending() {
+        flushPending();
+        return (0);
+    }
+
+    /// @brief Checks if lease changes wait for being stored.
+    ///
+    /// The servers don't send the responses directly while the changes
+    /// they carry are pending. The default implementation returns false.
+    ///
+    /// @return true if some changes are left for @c flushPending.
+    virtual bool hasPending() const {
+        return (false);
+    }
 };
 
 }; // end of isc::dhcp namespace
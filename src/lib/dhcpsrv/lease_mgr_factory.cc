@@ -6,6 +6,7 @@
 
 #include <config.h>
 
+#include <dhcpsrv/cached_lease_mgr.h>
 #include <dhcpsrv/dhcpsrv_log.h>
 #include <dhcpsrv/lease_mgr_factory.h>
 #include <dhcpsrv/memfile_lease_mgr.h>
@@ -34,6 +35,30 @@ using namespace std;
 namespace isc {
 namespace dhcp {
 
+namespace {
+
+/// @brief Places the lease cache in front of the lease manager.
+///
+/// @param lease_mgr Lease manager to be used with the cache.
+/// @param parameters Database access parameters.
+///
+/// @return Lease manager with the cache or the lease manager specified
+/// as an argument if the cache is disabled.
+LeaseMgr*
+addLeaseCache(LeaseMgr* lease_mgr,
+              const DatabaseConnection::ParameterMap& parameters) {
+    size_t cache_size = CachedLeaseMgr::getCacheSize(parameters);
+    if (cache_size == 0) {
+        return (lease_mgr);
+    }
+    uint32_t cache_ttl = CachedLeaseMgr::getCacheTtl(parameters);
+    LOG_INFO(dhcpsrv_logger, DHCPSRV_LEASE_CACHE_ENABLED)
+        .arg(cache_size).arg(cache_ttl);
+    return (new CachedLeaseMgr(lease_mgr, cache_size, cache_ttl));
+}
+
+}
+
 boost::scoped_ptr<LeaseMgr>&
 LeaseMgrFactory::getLeaseMgrPtr() {
     static boost::scoped_ptr<LeaseMgr> leaseMgrPtr;
@@ -48,6 +73,11 @@ LeaseMgrFactory::create(const std::string& dbaccess) {
     DatabaseConnection::ParameterMap parameters = DatabaseConnection::parse(dbaccess);
     std::string redacted = DatabaseConnection::redactedAccessString(parameters);
 
+    // Validate the lease cache parameters before opening the database. The
+    // cache is only used in front of the SQL backends.
+    CachedLeaseMgr::getCacheSize(parameters);
+    CachedLeaseMgr::getCacheTtl(parameters);
+
     // Is "type" present?
     if (parameters.find(type) == parameters.end()) {
         LOG_ERROR(dhcpsrv_logger, DHCPSRV_NOTYPE_DB).arg(dbaccess);
@@ -60,21 +90,24 @@ LeaseMgrFactory::create(const std::string& dbaccess) {
 #ifdef HAVE_MYSQL
     if (parameters[type] == string("mysql")) {
         LOG_INFO(dhcpsrv_logger, DHCPSRV_MYSQL_DB).arg(redacted);
-        getLeaseMgrPtr().reset(new MySqlLeaseMgr(parameters));
+        getLeaseMgrPtr().reset(addLeaseCache(new MySqlLeaseMgr(parameters),
+                                             parameters));
         return;
     }
 #endif
 #ifdef HAVE_PGSQL
     if (parameters[type] == string("postgresql")) {
         LOG_INFO(dhcpsrv_logger, DHCPSRV_PGSQL_DB).arg(redacted);
-        getLeaseMgrPtr().reset(new PgSqlLeaseMgr(parameters));
+        getLeaseMgrPtr().reset(addLeaseCache(new PgSqlLeaseMgr(parameters),
+                                             parameters));
         return;
     }
 #endif
 #ifdef HAVE_CQL
     if (parameters[type] == string("cql")) {
         LOG_INFO(dhcpsrv_logger, DHCPSRV_CQL_DB).arg(redacted);
-        getLeaseMgrPtr().reset(new CqlLeaseMgr(parameters));
+        getLeaseMgrPtr().reset(addLeaseCache(new CqlLeaseMgr(parameters),
+                                             parameters));
         return;
     }
 #endif
@@ -0,0 +1,279 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef LRU_CACHE_H
+#define LRU_CACHE_H
+
+#include <stats/stats_counter.h>
+#include <util/threads/multi_threading_mgr.h>
+#include <util/threads/sync.h>
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <ctime>
+#include <stdint.h>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Bounded cache of the results of the lookups made in a database.
+///
+/// The cache maps the keys to the values, e.g. the addresses to the
+/// leases. A null value can be cached to record that the database holds
+/// nothing for the key (negative caching). The entries expire after the
+/// specified time to live and the least recently used entry is removed
+/// when the maximum number of entries is reached.
+///
+/// The lookup returns a version of the cache which is passed to
+/// @c insert with the value read from the database. Every modification
+/// through @c update, @c erase and @c clear increments the version, so a
+/// value read concurrently with the modification is not cached as it may
+/// be already stale.
+///
+/// The numbers of hits, misses and cached entries are accumulated in the
+/// optional statistic counters, which are read without locking the cache.
+///
+/// The cache is protected by a mutex in the multi-threading mode.
+///
+/// @tparam Key Type of the key. It must be less-than comparable.
+/// @tparam Value Type of the cached value, e.g. a pointer to the lease.
+template<typename Key, typename Value>
+class LruCache : public boost::noncopyable {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// @param max_size Maximum number of cached entries. The value of 0
+    /// is replaced with 1.
+    /// @param ttl Time to live of the cached entries in seconds or 0 if the
+    /// entries don't expire.
+    /// @param hits Counter of the lookups served from the cache or null.
+    /// @param misses Counter of the lookups not served from the cache or
+    /// null.
+    /// @param size Counter of the cached entries or null. It is updated
+    /// with the changes of the number of entries.
+    LruCache(const size_t max_size, const uint32_t ttl,
+             const isc::stats::StatsCounterPtr& hits =
+             isc::stats::StatsCounterPtr(),
+             const isc::stats::StatsCounterPtr& misses =
+             isc::stats::StatsCounterPtr(),
+             const isc::stats::StatsCounterPtr& size =
+             isc::stats::StatsCounterPtr())
+        : max_size_(max_size > 0 ? max_size : 1), ttl_(ttl), cache_(),
+          version_(0), hits_(hits), misses_(misses), size_(size),
+          mutex_(new isc::util::thread::Mutex()) {
+    }
+
+    /// @brief Returns the maximum number of cached entries.
+    size_t getMaxSize() const {
+        return (max_size_);
+    }
+
+    /// @brief Returns the time to live of the cached entries.
+    uint32_t getTtl() const {
+        return (ttl_);
+    }
+
+    /// @brief Returns the number of cached entries.
+    size_t size() const {
+        isc::util::thread::MultiThreadingLock lock(*mutex_);
+        return (cache_.size());
+    }
+
+    /// @brief Looks up the cached value.
+    ///
+    /// The entry which is found is moved to the front of the LRU list.
+    /// The expired entry is removed.
+    ///
+    /// @param key Key of the entry.
+    /// @param [out] value Cached value.
+    /// @param [out] version Version of the cache when the entry was not
+    /// found. It is passed to @c insert.
+    ///
+    /// @return true if the entry was found, false otherwise.
+    bool get(const Key& key, Value& value, uint64_t& version) const {
+        bool found = false;
+        {
+            isc::util::thread::MultiThreadingLock lock(*mutex_);
+            typename CacheContainer::iterator entry = cache_.find(key);
+            if (entry != cache_.end()) {
+                if ((entry->expire_ != 0) && (entry->expire_ <= time(NULL))) {
+                    cache_.erase(entry);
+                    addSize(-1);
+
+                } else {
+                    // Mark the entry as the most recently used one.
+                    cache_.template get<1>().relocate(
+                        cache_.template get<1>().begin(),
+                        cache_.template project<1>(entry));
+                    value = entry->value_;
+                    found = true;
+                }
+            }
+            version = version_;
+        }
+
+        const isc::stats::StatsCounterPtr& counter = (found ? hits_ : misses_);
+        if (counter) {
+            counter->add();
+        }
+        return (found);
+    }
+
+    /// @brief Caches the value read from the database.
+    ///
+    /// The entry is not inserted when the cache has been modified since
+    /// the lookup began, because the value may be already stale.
+    ///
+    /// @param key Key of the entry.
+    /// @param value Value read from the database.
+    /// @param version Version returned by @c get.
+    void insert(const Key& key, const Value& value,
+                const uint64_t version) const {
+        isc::util::thread::MultiThreadingLock lock(*mutex_);
+        if (version == version_) {
+            store(key, value);
+        }
+    }
+
+    /// @brief Caches the value written to the database.
+    ///
+    /// @param key Key of the entry.
+    /// @param value Value written to the database.
+    void update(const Key& key, const Value& value) {
+        isc::util::thread::MultiThreadingLock lock(*mutex_);
+        ++version_;
+        store(key, value);
+    }
+
+    /// @brief Removes the entry.
+    ///
+    /// @param key Key of the entry.
+    void erase(const Key& key) {
+        isc::util::thread::MultiThreadingLock lock(*mutex_);
+        ++version_;
+        typename CacheContainer::iterator entry = cache_.find(key);
+        if (entry != cache_.end()) {
+            cache_.erase(entry);
+            addSize(-1);
+        }
+    }
+
+    /// @brief Removes all entries.
+    void clear() {
+        isc::util::thread::MultiThreadingLock lock(*mutex_);
+        ++version_;
+        addSize(-static_cast<int64_t>(cache_.size()));
+        cache_.clear();
+    }
+
+private:
+
+    /// @brief Cached entry.
+    struct CacheEntry {
+
+        /// @brief Constructor.
+        ///
+        /// @param key Key of the entry.
+        /// @param value Cached value.
+        /// @param expire Expiration time or 0.
+        CacheEntry(const Key& key, const Value& value, const time_t expire)
+            : key_(key), value_(value), expire_(expire) {
+        }
+
+        /// @brief Key of the entry.
+        Key key_;
+
+        /// @brief Cached value.
+        Value value_;
+
+        /// @brief Expiration time or 0 if the entry doesn't expire.
+        time_t expire_;
+    };
+
+    /// @brief Container holding the cached entries.
+    ///
+    /// The first index is used to find the entries by the key. The second
+    /// index keeps the entries ordered from the most recently to the least
+    /// recently used.
+    typedef boost::multi_index_container<
+        CacheEntry,
+        boost::multi_index::indexed_by<
+            boost::multi_index::ordered_unique<
+                boost::multi_index::member<CacheEntry, Key, &CacheEntry::key_>
+            >,
+            boost::multi_index::sequenced<>
+        >
+    > CacheContainer;
+
+    /// @brief Stores or replaces the entry.
+    ///
+    /// It must be called with the mutex locked. It removes the least
+    /// recently used entries when the cache is full.
+    ///
+    /// @param key Key of the entry.
+    /// @param value Cached value.
+    void store(const Key& key, const Value& value) const {
+        CacheEntry entry(key, value, (ttl_ > 0 ? time(NULL) + ttl_ : 0));
+        std::pair<typename CacheContainer::iterator, bool> result =
+            cache_.insert(entry);
+        if (result.second) {
+            addSize(1);
+        } else {
+            cache_.replace(result.first, entry);
+        }
+        cache_.template get<1>().relocate(
+            cache_.template get<1>().begin(),
+            cache_.template project<1>(result.first));
+
+        // Remove the least recently used entries.
+        while (cache_.size() > max_size_) {
+            cache_.template get<1>().pop_back();
+            addSize(-1);
+        }
+    }
+
+    /// @brief Updates the counter of the cached entries.
+    ///
+    /// @param delta Change of the number of entries.
+    void addSize(const int64_t delta) const {
+        if (size_) {
+            size_->add(delta);
+        }
+    }
+
+    /// @brief Maximum number of cached entries.
+    size_t max_size_;
+
+    /// @brief Time to live of the cached entries in seconds or 0.
+    uint32_t ttl_;
+
+    /// @brief The cached entries.
+    mutable CacheContainer cache_;
+
+    /// @brief Version of the cache.
+    uint64_t version_;
+
+    /// @brief Counter of the lookups served from the cache.
+    isc::stats::StatsCounterPtr hits_;
+
+    /// @brief Counter of the lookups not served from the cache.
+    isc::stats::StatsCounterPtr misses_;
+
+    /// @brief Counter of the cached entries.
+    isc::stats::StatsCounterPtr size_;
+
+    /// @brief Mutex protecting the cache.
+    boost::scoped_ptr<isc::util::thread::Mutex> mutex_;
+};
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
+
+#endif // LRU_CACHE_H
@@ -12,9 +12,12 @@
 #include <dhcpsrv/timer_mgr.h>
 #include <dhcpsrv/database_connection.h>
 #include <exceptions/exceptions.h>
+#include <stats/stats_mgr.h>
 #include <util/pid_file.h>
 #include <util/process_spawn.h>
 #include <util/signal_set.h>
+#include <util/threads/multi_threading_mgr.h>
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 #include <errno.h>
@@ -36,9 +39,33 @@ const uint32_t MAX_LEASE_ERRORS = 100;
 /// Kea installation directory.
 const char* KEA_LFC_EXECUTABLE_ENV_NAME = "KEA_LFC_EXECUTABLE";
 
+/// @brief Default time in milliseconds the lease updates wait for other
+/// updates to join their group.
+const uint32_t DEFAULT_COMMIT_INTERVAL = 10;
+
+/// @brief Default number of lease updates which triggers the
+/// synchronization of the group.
+const uint32_t DEFAULT_COMMIT_BATCH_SIZE = 64;
+
+/// @brief Compares the addresses of two leases.
+///
+/// It is used to order the leases written to the snapshot.
+template<typename LeasePtrType>
+bool
+leaseAddressLess(const LeasePtrType& first, const LeasePtrType& second) {
+    return (first->addr_ < second->addr_);
+}
+
 } // end of anonymous namespace
 
 using namespace isc::util;
+using namespace isc::stats;
+using namespace boost::posix_time;
+using isc::util::thread::CondVar;
+using isc::util::thread::Mutex;
+using isc::util::thread::MultiThreadingLock;
+using isc::util::thread::MultiThreadingMgr;
+using isc::util::thread::Thread;
 
 namespace isc {
 namespace dhcp {
@@ -82,12 +109,15 @@ public:
     /// or NULL. If this is NULL, the @c lease_file6 must be non-null.
     /// @param lease_file6 A pointer to the DHCPv6 lease file to be cleaned up
     /// or NULL. If this is NULL, the @c lease_file4 must be non-null.
+    /// @param lfc_mode Mode of the cleanup. The @c kea-lfc process is
+    /// prepared only for the @c Memfile_LeaseMgr::LFC_EXTERNAL mode.
     /// @param run_once_now A flag that causes LFC to be invoked immediately,
     /// regardless of the value of lfc_interval.  This is primarily used to
     /// cause lease file schema upgrades upon startup.
     void setup(const uint32_t lfc_interval,
-               const boost::shared_ptr<CSVLeaseFile4>& lease_file4,
-               const boost::shared_ptr<CSVLeaseFile6>& lease_file6,
+               const LeaseFile4Ptr& lease_file4,
+               const LeaseFile6Ptr& lease_file6,
+               const Memfile_LeaseMgr::LFCMode& lfc_mode,
                bool run_once_now = false);
 
     /// @brief Spawns a new process.
@@ -103,6 +133,13 @@ public:
 
 private:
 
+    /// @brief Prepares the command line of the @c kea-lfc process.
+    ///
+    /// @param lease_file4 A pointer to the DHCPv4 lease file or NULL.
+    /// @param lease_file6 A pointer to the DHCPv6 lease file or NULL.
+    void prepareProcess(const LeaseFile4Ptr& lease_file4,
+                        const LeaseFile6Ptr& lease_file6);
+
     /// @brief A pointer to the @c ProcessSpawn object used to execute
     /// the LFC.
     boost::scoped_ptr<util::ProcessSpawn> process_;
@@ -150,8 +187,9 @@ LFCSetup::~LFCSetup() {
 
 void
 LFCSetup::setup(const uint32_t lfc_interval,
-                const boost::shared_ptr<CSVLeaseFile4>& lease_file4,
-                const boost::shared_ptr<CSVLeaseFile6>& lease_file6,
+                const LeaseFile4Ptr& lease_file4,
+                const LeaseFile6Ptr& lease_file6,
+                const Memfile_LeaseMgr::LFCMode& lfc_mode,
                 bool run_once_now) {
 
     // If to nothing to do, punt
@@ -159,6 +197,34 @@ LFCSetup::setup(const uint32_t lfc_interval,
         return;
     }
 
+    // The backend performs the cleanup by itself, so only the timer
+    // is needed.
+    if (lfc_mode == Memfile_LeaseMgr::LFC_EXTERNAL) {
+        prepareProcess(lease_file4, lease_file6);
+    }
+
+    // If we've been told to run it once now, invoke the callback directly.
+    if (run_once_now) {
+        callback_();
+    }
+
+    // If it's supposed to run periodically, setup that now.
+    if (lfc_interval > 0) {
+        // Set the timer to call callback function periodically.
+        LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_LFC_SETUP).arg(lfc_interval);
+
+        // Multiple the lfc_interval value by 1000 as this value specifies
+        // a timeout in seconds, whereas the setup() method expects the
+        // timeout in milliseconds.
+        timer_mgr_->registerTimer("memfile-lfc", callback_, lfc_interval * 1000,
+                                  asiolink::IntervalTimer::REPEATING);
+        timer_mgr_->setup("memfile-lfc");
+    }
+}
+
+void
+LFCSetup::prepareProcess(const LeaseFile4Ptr& lease_file4,
+                         const LeaseFile6Ptr& lease_file6) {
     // Start preparing the command line for kea-lfc.
     std::string executable;
     char* c_executable = getenv(KEA_LFC_EXECUTABLE_ENV_NAME);
@@ -204,24 +270,6 @@ LFCSetup::setup(const uint32_t lfc_interval,
 
     // Create the process (do not start it yet).
     process_.reset(new util::ProcessSpawn(executable, args));
-
-    // If we've been told to run it once now, invoke the callback directly.
-    if (run_once_now) {
-        callback_();
-    }
-
-    // If it's supposed to run periodically, setup that now.
-    if (lfc_interval > 0) {
-        // Set the timer to call callback function periodically.
-        LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_LFC_SETUP).arg(lfc_interval);
-
-        // Multiple the lfc_interval value by 1000 as this value specifies
-        // a timeout in seconds, whereas the setup() method expects the
-        // timeout in milliseconds.
-        timer_mgr_->registerTimer("memfile-lfc", callback_, lfc_interval * 1000,
-                                  asiolink::IntervalTimer::REPEATING);
-        timer_mgr_->setup("memfile-lfc");
-    }
 }
 
 void
@@ -509,27 +557,44 @@ const int Memfile_LeaseMgr::MAJOR_VERSION;
 const int Memfile_LeaseMgr::MINOR_VERSION;
 
 Memfile_LeaseMgr::Memfile_LeaseMgr(const DatabaseConnection::ParameterMap& parameters)
-    : LeaseMgr(), lfc_setup_(), conn_(parameters)
+    : LeaseMgr(), mutex_(new isc::util::thread::Mutex()),
+      persist_mode_(PERSIST_ASYNC), commit_interval_(DEFAULT_COMMIT_INTERVAL),
+      commit_batch_size_(DEFAULT_COMMIT_BATCH_SIZE), pending_writes_(0),
+      first_pending_time_(), write_seq_(0), commit_seq_(0), committing_(false),
+      commit_cond_(new CondVar()), lfc_setup_(), lfc_mode_(LFC_EXTERNAL),
+      lfc_thread_(), lfc_mutex_(new Mutex()), lfc_running_(false),
+      lfc_status_(0), conn_(parameters)
     {
     bool conversion_needed = false;
 
+    persist_mode_ = getPersistMode();
+    lfc_mode_ = getLFCMode();
+    commit_interval_ = getUint32Parameter("commit-interval",
+                                          DEFAULT_COMMIT_INTERVAL);
+    commit_batch_size_ = getUint32Parameter("commit-batch-size",
+                                            DEFAULT_COMMIT_BATCH_SIZE);
+    if (commit_batch_size_ == 0) {
+        isc_throw(isc::BadValue, "invalid value of the commit-batch-size 0"
+                  " specified");
+    }
+
     // Check the universe and use v4 file or v6 file.
     std::string universe = conn_.getParameter("universe");
     if (universe == "4") {
         std::string file4 = initLeaseFilePath(V4);
         if (!file4.empty()) {
-            conversion_needed = loadLeasesFromFiles<Lease4,
-                                                 CSVLeaseFile4>(file4,
-                                                                lease_file4_,
-                                                                storage4_);
+            conversion_needed = loadLeasesFromFiles<Lease4, CSVLeaseFile4,
+                                                    BinaryLeaseFile4>(file4,
+                                                                      lease_file4_,
+                                                                      storage4_);
         }
     } else {
         std::string file6 = initLeaseFilePath(V6);
         if (!file6.empty()) {
-            conversion_needed = loadLeasesFromFiles<Lease6,
-                                                 CSVLeaseFile6>(file6,
-                                                                lease_file6_,
-                                                                storage6_);
+            conversion_needed = loadLeasesFromFiles<Lease6, CSVLeaseFile6,
+                                                    BinaryLeaseFile6>(file6,
+                                                                      lease_file6_,
+                                                                      storage6_);
         }
     }
 
@@ -540,6 +605,15 @@ Memfile_LeaseMgr::Memfile_LeaseMgr(const DatabaseConnection::ParameterMap& param
    if (!persistLeases(V4) && !persistLeases(V6)) {
         LOG_WARN(dhcpsrv_logger, DHCPSRV_MEMFILE_NO_STORAGE);
     } else  {
+        // The updates are buffered until the group is stored.
+        if (persist_mode_ == PERSIST_GROUP) {
+            if (lease_file4_) {
+                lease_file4_->setAutoFlush(false);
+            }
+            if (lease_file6_) {
+                lease_file6_->setAutoFlush(false);
+            }
+        }
         if (conversion_needed) {
             LOG_WARN(dhcpsrv_logger, DHCPSRV_MEMFILE_CONVERTING_LEASE_FILES)
                     .arg(MAJOR_VERSION).arg(MINOR_VERSION);
@@ -550,6 +624,17 @@ Memfile_LeaseMgr::Memfile_LeaseMgr(const DatabaseConnection::ParameterMap& param
 }
 
 Memfile_LeaseMgr::~Memfile_LeaseMgr() {
+    // The cleanup thread must not outlive the backend.
+    lfcWait();
+
+    if (pending_writes_ > 0) {
+        try {
+            commitLeaseFile(pending_writes_);
+        } catch (const std::exception&) {
+            // The destructor must not throw. The buffered updates are
+            // written to the file when it is closed.
+        }
+    }
     if (lease_file4_) {
         lease_file4_->close();
         lease_file4_.reset();
@@ -570,10 +655,11 @@ Memfile_LeaseMgr::getDBVersion() {
 
 bool
 Memfile_LeaseMgr::addLease(const Lease4Ptr& lease) {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_ADD_ADDR4).arg(lease->addr_.toText());
 
-    if (getLease4(lease->addr_)) {
+    if (storage4_.get<AddressIndexTag>().count(lease->addr_) > 0) {
         // there is a lease with specified address already
         return (false);
     }
@@ -583,6 +669,7 @@ Memfile_LeaseMgr::addLease(const Lease4Ptr& lease) {
     // remain consistent.
     if (persistLeases(V4)) {
         lease_file4_->append(*lease);
+        leasesWritten(V4, 1);
     }
 
     storage4_.insert(lease);
@@ -591,10 +678,12 @@ Memfile_LeaseMgr::addLease(const Lease4Ptr& lease) {
 
 bool
 Memfile_LeaseMgr::addLease(const Lease6Ptr& lease) {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_ADD_ADDR6).arg(lease->addr_.toText());
 
-    if (getLease6(lease->type_, lease->addr_)) {
+    Lease6Storage::iterator existing = storage6_.find(lease->addr_);
+    if ((existing != storage6_.end()) && ((*existing)->type_ == lease->type_)) {
         // there is a lease with specified address already
         return (false);
     }
@@ -604,6 +693,7 @@ Memfile_LeaseMgr::addLease(const Lease6Ptr& lease) {
     // remain consistent.
     if (persistLeases(V6)) {
         lease_file6_->append(*lease);
+        leasesWritten(V6, 1);
     }
 
     storage6_.insert(lease);
@@ -612,6 +702,7 @@ Memfile_LeaseMgr::addLease(const Lease6Ptr& lease) {
 
 Lease4Ptr
 Memfile_LeaseMgr::getLease4(const isc::asiolink::IOAddress& addr) const {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_GET_ADDR4).arg(addr.toText());
 
@@ -626,17 +717,18 @@ Memfile_LeaseMgr::getLease4(const isc::asiolink::IOAddress& addr) const {
 
 Lease4Collection
 Memfile_LeaseMgr::getLease4(const HWAddr& hwaddr) const {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_GET_HWADDR).arg(hwaddr.toText());
     Lease4Collection collection;
 
-    // Using composite index by 'hw address' and 'subnet id'. It is
-    // ok to use it for searching by the 'hw address' only.
-    const Lease4StorageHWAddressSubnetIdIndex& idx =
-        storage4_.get<HWAddressSubnetIdIndexTag>();
-    std::pair<Lease4StorageHWAddressSubnetIdIndex::const_iterator,
-              Lease4StorageHWAddressSubnetIdIndex::const_iterator> l
-        = idx.equal_range(boost::make_tuple(hwaddr.hwaddr_));
+    // Get the index by 'hw address'. Depending on the storage layout,
+    // this is the composite index by 'hw address' and 'subnet id' or a
+    // dedicated hashed index.
+    const Lease4StorageHWAddressIndex& idx = storage4_.get<HWAddressIndexTag>();
+    std::pair<Lease4StorageHWAddressIndex::const_iterator,
+              Lease4StorageHWAddressIndex::const_iterator> l
+        = idx.equal_range(hwaddr.hwaddr_);
 
     for(auto lease = l.first; lease != l.second; ++lease) {
         collection.push_back(Lease4Ptr(new Lease4(**lease)));
@@ -647,6 +739,7 @@ Memfile_LeaseMgr::getLease4(const HWAddr& hwaddr) const {
 
 Lease4Ptr
 Memfile_LeaseMgr::getLease4(const HWAddr& hwaddr, SubnetID subnet_id) const {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_GET_SUBID_HWADDR).arg(subnet_id)
         .arg(hwaddr.toText());
@@ -668,16 +761,17 @@ Memfile_LeaseMgr::getLease4(const HWAddr& hwaddr, SubnetID subnet_id) const {
 
 Lease4Collection
 Memfile_LeaseMgr::getLease4(const ClientId& client_id) const {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_GET_CLIENTID).arg(client_id.toText());
     Lease4Collection collection;
-    // Using composite index by 'client id' and 'subnet id'. It is ok
-    // to use it to search by 'client id' only.
-    const Lease4StorageClientIdSubnetIdIndex& idx =
-        storage4_.get<ClientIdSubnetIdIndexTag>();
-    std::pair<Lease4StorageClientIdSubnetIdIndex::const_iterator,
-              Lease4StorageClientIdSubnetIdIndex::const_iterator> l
-        = idx.equal_range(boost::make_tuple(client_id.getClientId()));
+    // Get the index by 'client id'. Depending on the storage layout,
+    // this is the composite index by 'client id' and 'subnet id' or a
+    // dedicated hashed index.
+    const Lease4StorageClientIdIndex& idx = storage4_.get<ClientIdIndexTag>();
+    std::pair<Lease4StorageClientIdIndex::const_iterator,
+              Lease4StorageClientIdIndex::const_iterator> l
+        = idx.equal_range(client_id.getClientId());
 
     for(auto lease = l.first; lease != l.second; ++lease) {
         collection.push_back(Lease4Ptr(new Lease4(**lease)));
@@ -690,6 +784,7 @@ Lease4Ptr
 Memfile_LeaseMgr::getLease4(const ClientId& client_id,
                             const HWAddr& hwaddr,
                             SubnetID subnet_id) const {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_GET_CLIENTID_HWADDR_SUBID).arg(client_id.toText())
                                                         .arg(hwaddr.toText())
@@ -715,6 +810,7 @@ Memfile_LeaseMgr::getLease4(const ClientId& client_id,
 Lease4Ptr
 Memfile_LeaseMgr::getLease4(const ClientId& client_id,
                             SubnetID subnet_id) const {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_GET_SUBID_CLIENTID).arg(subnet_id)
               .arg(client_id.toText());
@@ -733,9 +829,29 @@ Memfile_LeaseMgr::getLease4(const ClientId& client_id,
     return (Lease4Ptr(new Lease4(**lease)));
 }
 
+Lease4Collection
+Memfile_LeaseMgr::getLeases4(SubnetID subnet_id) const {
+    MultiThreadingLock lock(*mutex_);
+    LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+              DHCPSRV_MEMFILE_GET_SUBID4).arg(subnet_id);
+
+    Lease4Collection collection;
+    const Lease4StorageSubnetIdIndex& idx = storage4_.get<SubnetIdIndexTag>();
+    std::pair<Lease4StorageSubnetIdIndex::const_iterator,
+              Lease4StorageSubnetIdIndex::const_iterator> l =
+        idx.equal_range(subnet_id);
+
+    for (auto lease = l.first; lease != l.second; ++lease) {
+        collection.push_back(Lease4Ptr(new Lease4(**lease)));
+    }
+
+    return (collection);
+}
+
 Lease6Ptr
 Memfile_LeaseMgr::getLease6(Lease::Type type,
                             const isc::asiolink::IOAddress& addr) const {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_GET_ADDR6)
         .arg(addr.toText())
@@ -751,6 +867,7 @@ Memfile_LeaseMgr::getLease6(Lease::Type type,
 Lease6Collection
 Memfile_LeaseMgr::getLeases6(Lease::Type type,
                             const DUID& duid, uint32_t iaid) const {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_GET_IAID_DUID)
         .arg(iaid)
@@ -776,6 +893,7 @@ Lease6Collection
 Memfile_LeaseMgr::getLeases6(Lease::Type type,
                              const DUID& duid, uint32_t iaid,
                              SubnetID subnet_id) const {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_GET_IAID_SUBID_DUID)
         .arg(iaid)
@@ -804,6 +922,7 @@ Memfile_LeaseMgr::getLeases6(Lease::Type type,
 void
 Memfile_LeaseMgr::getExpiredLeases6(Lease6Collection& expired_leases,
                                     const size_t max_leases) const {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MEMFILE_GET_EXPIRED6)
         .arg(max_leases);
 
@@ -829,6 +948,7 @@ Memfile_LeaseMgr::getExpiredLeases6(Lease6Collection& expired_leases,
 void
 Memfile_LeaseMgr::getExpiredLeases4(Lease4Collection& expired_leases,
                                     const size_t max_leases) const {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MEMFILE_GET_EXPIRED4)
         .arg(max_leases);
 
@@ -853,6 +973,7 @@ Memfile_LeaseMgr::getExpiredLeases4(Lease4Collection& expired_leases,
 
 void
 Memfile_LeaseMgr::updateLease4(const Lease4Ptr& lease) {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_UPDATE_ADDR4).arg(lease->addr_.toText());
 
@@ -871,6 +992,7 @@ Memfile_LeaseMgr::updateLease4(const Lease4Ptr& lease) {
     // remain consistent.
     if (persistLeases(V4)) {
         lease_file4_->append(*lease);
+        leasesWritten(V4, 1);
     }
 
     // Use replace() to re-index leases.
@@ -879,6 +1001,7 @@ Memfile_LeaseMgr::updateLease4(const Lease4Ptr& lease) {
 
 void
 Memfile_LeaseMgr::updateLease6(const Lease6Ptr& lease) {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_UPDATE_ADDR6).arg(lease->addr_.toText());
 
@@ -897,6 +1020,7 @@ Memfile_LeaseMgr::updateLease6(const Lease6Ptr& lease) {
     // remain consistent.
     if (persistLeases(V6)) {
         lease_file6_->append(*lease);
+        leasesWritten(V6, 1);
     }
 
     // Use replace() to re-index leases.
@@ -905,6 +1029,12 @@ Memfile_LeaseMgr::updateLease6(const Lease6Ptr& lease) {
 
 bool
 Memfile_LeaseMgr::deleteLease(const isc::asiolink::IOAddress& addr) {
+    MultiThreadingLock lock(*mutex_);
+    return (deleteLeaseInternal(addr));
+}
+
+bool
+Memfile_LeaseMgr::deleteLeaseInternal(const isc::asiolink::IOAddress& addr) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_DELETE_ADDR).arg(addr.toText());
     if (addr.isV4()) {
@@ -922,6 +1052,7 @@ Memfile_LeaseMgr::deleteLease(const isc::asiolink::IOAddress& addr) {
                 // removed.
                 lease_copy.valid_lft_ = 0;
                 lease_file4_->append(lease_copy);
+                leasesWritten(V4, 1);
             }
             storage4_.erase(l);
             return (true);
@@ -942,6 +1073,7 @@ Memfile_LeaseMgr::deleteLease(const isc::asiolink::IOAddress& addr) {
                 lease_copy.valid_lft_ = 0;
                 lease_copy.preferred_lft_ = 0;
                 lease_file6_->append(lease_copy);
+                leasesWritten(V6, 1);
             }
 
             storage6_.erase(l);
@@ -952,22 +1084,28 @@ Memfile_LeaseMgr::deleteLease(const isc::asiolink::IOAddress& addr) {
 
 uint64_t
 Memfile_LeaseMgr::deleteExpiredReclaimedLeases4(const uint32_t secs) {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_DELETE_EXPIRED_RECLAIMED4)
         .arg(secs);
-    return (deleteExpiredReclaimedLeases<
-            Lease4StorageExpirationIndex, Lease4
-            >(secs, V4, storage4_, lease_file4_));
+    const uint64_t deleted = deleteExpiredReclaimedLeases<
+        Lease4StorageExpirationIndex, Lease4
+        >(secs, V4, storage4_, lease_file4_);
+    leasesWritten(V4, deleted);
+    return (deleted);
 }
 
 uint64_t
 Memfile_LeaseMgr::deleteExpiredReclaimedLeases6(const uint32_t secs) {
+    MultiThreadingLock lock(*mutex_);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MEMFILE_DELETE_EXPIRED_RECLAIMED6)
         .arg(secs);
-    return (deleteExpiredReclaimedLeases<
-            Lease6StorageExpirationIndex, Lease6
-            >(secs, V6, storage6_, lease_file6_));
+    const uint64_t deleted = deleteExpiredReclaimedLeases<
+        Lease6StorageExpirationIndex, Lease6
+        >(secs, V6, storage6_, lease_file6_);
+    leasesWritten(V6, deleted);
+    return (deleted);
 }
 
 template<typename IndexType, typename LeaseType, typename StorageType,
@@ -1049,6 +1187,140 @@ Memfile_LeaseMgr::rollback() {
               DHCPSRV_MEMFILE_ROLLBACK);
 }
 
+void
+Memfile_LeaseMgr::flushPending() {
+    // The persist mode doesn't change after the backend is created.
+    if (persist_mode_ != PERSIST_GROUP) {
+        return;
+    }
+
+    // All updates have been made by this thread, so there is no reason
+    // to wait for other updates.
+    if (!MultiThreadingMgr::instance().getMode()) {
+        if (pending_writes_ > 0) {
+            commitLeaseFile(pending_writes_);
+        }
+        return;
+    }
+
+    LeaseFile4Ptr lease_file4;
+    LeaseFile6Ptr lease_file6;
+    uint64_t seq = 0;
+    uint64_t count = 0;
+    {
+        Mutex::Locker lock(*mutex_);
+        const uint64_t target = write_seq_;
+        while (commit_seq_ < target) {
+            // Another thread is storing the group, which may or may not
+            // include the updates made by this thread.
+            if (committing_) {
+                commit_cond_->wait(*mutex_);
+                continue;
+            }
+
+            const int64_t elapsed = (microsec_clock::universal_time() -
+                                     first_pending_time_).total_milliseconds();
+            if ((pending_writes_ < commit_batch_size_) &&
+                (elapsed < static_cast<int64_t>(commit_interval_))) {
+                commit_cond_->timedWait(*mutex_, commit_interval_ - elapsed);
+                continue;
+            }
+
+            // This thread stores the group. The buffered updates are
+            // written to the file under the lock, so the other threads
+            // may append new updates while the data are synchronized.
+            lease_file4 = lease_file4_;
+            lease_file6 = lease_file6_;
+            try {
+                if (lease_file4) {
+                    lease_file4->flush();
+                }
+                if (lease_file6) {
+                    lease_file6->flush();
+                }
+            } catch (const std::exception& ex) {
+                commit_seq_ = write_seq_;
+                pending_writes_ = 0;
+                commit_cond_->broadcast();
+                isc_throw(DbOperationError, "failed to write the lease"
+                          " updates: " << ex.what());
+            }
+            seq = write_seq_;
+            count = pending_writes_;
+            pending_writes_ = 0;
+            committing_ = true;
+            break;
+        }
+    }
+
+    // The updates of this thread have been stored by another thread.
+    if (count == 0) {
+        return;
+    }
+
+    const ptime start = microsec_clock::universal_time();
+    std::string error;
+    try {
+        if (lease_file4) {
+            lease_file4->sync();
+        }
+        if (lease_file6) {
+            lease_file6->sync();
+        }
+    } catch (const std::exception& ex) {
+        error = ex.what();
+    }
+    const time_duration latency = microsec_clock::universal_time() - start;
+
+    {
+        Mutex::Locker lock(*mutex_);
+        if (commit_seq_ < seq) {
+            commit_seq_ = seq;
+        }
+        committing_ = false;
+        commit_cond_->broadcast();
+    }
+
+    if (!error.empty()) {
+        isc_throw(DbOperationError, "failed to store the lease updates: "
+                  << error);
+    }
+    updateCommitStats(latency, count);
+}
+
+uint32_t
+Memfile_LeaseMgr::flushDuePending() {
+    if ((persist_mode_ != PERSIST_GROUP) ||
+        MultiThreadingMgr::instance().getMode()) {
+        flushPending();
+        return (0);
+    }
+
+    // The full groups are stored by leasesWritten.
+    if (pending_writes_ == 0) {
+        return (0);
+    }
+    const int64_t elapsed = (microsec_clock::universal_time() -
+                             first_pending_time_).total_milliseconds();
+    if (elapsed < static_cast<int64_t>(commit_interval_)) {
+        return (commit_interval_ - elapsed);
+    }
+    commitLeaseFile(pending_writes_);
+    return (0);
+}
+
+bool
+Memfile_LeaseMgr::hasPending() const {
+    if (persist_mode_ != PERSIST_GROUP) {
+        return (false);
+    }
+    if (MultiThreadingMgr::instance().getMode()) {
+        Mutex::Locker lock(*mutex_);
+        return (pending_writes_ > 0);
+    }
+    return (pending_writes_ > 0);
+}
+
 std::string
 Memfile_LeaseMgr::appendSuffix(const std::string& file_name,
                                const LFCFileType& file_type) {
@@ -1136,7 +1408,9 @@ Memfile_LeaseMgr::initLeaseFilePath(Universe u) {
     return (lease_file);
 }
 
-template<typename LeaseObjectType, typename LeaseFileType, typename StorageType>
+template<typename LeaseObjectType, typename CSVLeaseFileType,
+         typename BinaryLeaseFileType, typename LeaseFileType,
+         typename StorageType>
 bool Memfile_LeaseMgr::loadLeasesFromFiles(const std::string& filename,
                                            boost::shared_ptr<LeaseFileType>& lease_file,
                                            StorageType& storage) {
@@ -1154,53 +1428,287 @@ bool Memfile_LeaseMgr::loadLeasesFromFiles(const std::string& filename,
 
     storage.clear();
 
-    // Load the leasefile.completed, if exists.
+    const size_t load_threads = getLoadThreads();
+    const LeaseFileFormat format = getLeaseFileFormat();
+
+    // Load the leasefile.completed, if exists. The format of each file
+    // is detected, as the files might have been written before the
+    // format was changed.
     bool conversion_needed = false;
-    lease_file.reset(new LeaseFileType(std::string(filename + ".completed")));
-    if (lease_file->exists()) {
-        LeaseFileLoader::load<LeaseObjectType>(*lease_file, storage,
-                                               MAX_LEASE_ERRORS);
+    std::string completed_file = filename + ".completed";
+    if (CSVFile(completed_file).exists()) {
+        LeaseFileLoader::loadFile<LeaseObjectType, CSVLeaseFileType,
+                                  BinaryLeaseFileType>(completed_file, format,
+                                                       lease_file, storage,
+                                                       MAX_LEASE_ERRORS, true,
+                                                       load_threads);
         conversion_needed = conversion_needed || lease_file->needsConversion();
     } else {
         // If the leasefile.completed doesn't exist, let's load the leases
         // from leasefile.2 and leasefile.1, if they exist.
-        lease_file.reset(new LeaseFileType(appendSuffix(filename, FILE_PREVIOUS)));
-        if (lease_file->exists()) {
-            LeaseFileLoader::load<LeaseObjectType>(*lease_file, storage,
-                                                   MAX_LEASE_ERRORS);
+        std::string previous_file = appendSuffix(filename, FILE_PREVIOUS);
+        if (CSVFile(previous_file).exists()) {
+            LeaseFileLoader::loadFile<LeaseObjectType, CSVLeaseFileType,
+                                      BinaryLeaseFileType>(previous_file, format,
+                                                           lease_file, storage,
+                                                           MAX_LEASE_ERRORS, true,
+                                                           load_threads);
             conversion_needed =  conversion_needed || lease_file->needsConversion();
         }
 
-        lease_file.reset(new LeaseFileType(appendSuffix(filename, FILE_INPUT)));
-        if (lease_file->exists()) {
-            LeaseFileLoader::load<LeaseObjectType>(*lease_file, storage,
-                                                   MAX_LEASE_ERRORS);
+        std::string input_file = appendSuffix(filename, FILE_INPUT);
+        if (CSVFile(input_file).exists()) {
+            LeaseFileLoader::loadFile<LeaseObjectType, CSVLeaseFileType,
+                                      BinaryLeaseFileType>(input_file, format,
+                                                           lease_file, storage,
+                                                           MAX_LEASE_ERRORS, true,
+                                                           load_threads);
             conversion_needed =  conversion_needed || lease_file->needsConversion();
         }
     }
 
+    // The server records the lease updates in the configured format, so
+    // the Current Lease File written in the other format is converted.
+    if (LeaseFileLoader::detectFormat(filename, format) != format) {
+        convertLeaseFile<LeaseObjectType, CSVLeaseFileType, BinaryLeaseFileType,
+                         LeaseFileType>(filename, format);
+    }
+
     // Always load leases from the primary lease file. If the lease file
     // doesn't exist it will be created by the LeaseFileLoader. Note
     // that the false value passed as the last parameter to load
     // function causes the function to leave the file open after
     // it is parsed. This file will be used by the backend to record
     // future lease updates.
-    lease_file.reset(new LeaseFileType(filename));
-    LeaseFileLoader::load<LeaseObjectType>(*lease_file, storage,
-                                           MAX_LEASE_ERRORS, false);
+    LeaseFileLoader::loadFile<LeaseObjectType, CSVLeaseFileType,
+                              BinaryLeaseFileType>(filename, format,
+                                                   lease_file, storage,
+                                                   MAX_LEASE_ERRORS, false,
+                                                   load_threads);
     conversion_needed =  conversion_needed || lease_file->needsConversion();
 
     return (conversion_needed);
 }
 
+template<typename LeaseObjectType, typename CSVLeaseFileType,
+         typename BinaryLeaseFileType, typename LeaseFileType>
+void Memfile_LeaseMgr::convertLeaseFile(const std::string& filename,
+                                        const LeaseFileFormat format) {
+    std::string converted_file = filename + ".converted";
+
+    // Remove the leftover of the conversion which didn't complete.
+    static_cast<void>(remove(converted_file.c_str()));
+
+    boost::shared_ptr<LeaseFileType> input;
+    boost::shared_ptr<LeaseFileType> output;
+    if (format == LEASE_FILE_BINARY) {
+        input.reset(new CSVLeaseFileType(filename));
+        output.reset(new BinaryLeaseFileType(converted_file));
+    } else {
+        input.reset(new BinaryLeaseFileType(filename));
+        output.reset(new CSVLeaseFileType(converted_file));
+    }
+
+    LeaseFileLoader::convert<LeaseObjectType>(*input, *output,
+                                              MAX_LEASE_ERRORS);
+
+    if (rename(converted_file.c_str(), filename.c_str()) != 0) {
+        isc_throw(DbOpenError, "unable to rename the converted lease file "
+                  << converted_file << " to " << filename << ": "
+                  << strerror(errno));
+    }
+}
+
+size_t
+Memfile_LeaseMgr::getLoadThreads() const {
+    std::string load_threads_str = "0";
+    try {
+        load_threads_str = conn_.getParameter("load-threads");
+    } catch (const std::exception&) {
+        // Ignore and default to 0.
+    }
+
+    try {
+        return (boost::lexical_cast<uint16_t>(load_threads_str));
+    } catch (boost::bad_lexical_cast&) {
+        isc_throw(isc::BadValue, "invalid value of the load-threads "
+                  << load_threads_str << " specified");
+    }
+}
+
+LeaseFileFormat
+Memfile_LeaseMgr::getLeaseFileFormat() const {
+    std::string format_str = "csv";
+    try {
+        format_str = conn_.getParameter("lease-file-format");
+    } catch (const std::exception&) {
+        // Ignore and default to csv.
+    }
+
+    if (format_str == "csv") {
+        return (LEASE_FILE_CSV);
+
+    } else if (format_str == "binary") {
+        return (LEASE_FILE_BINARY);
+    }
+
+    isc_throw(isc::BadValue, "invalid value of the lease-file-format "
+              << format_str << " specified");
+}
+
+Memfile_LeaseMgr::PersistMode
+Memfile_LeaseMgr::getPersistMode() const {
+    std::string mode_str = "async";
+    try {
+        mode_str = conn_.getParameter("persist-mode");
+    } catch (const std::exception&) {
+        // Ignore and default to async.
+    }
+
+    if (mode_str == "async") {
+        return (PERSIST_ASYNC);
+
+    } else if (mode_str == "sync") {
+        return (PERSIST_SYNC);
+
+    } else if (mode_str == "group") {
+        return (PERSIST_GROUP);
+    }
+
+    isc_throw(isc::BadValue, "invalid value of the persist-mode "
+              << mode_str << " specified");
+}
+
+Memfile_LeaseMgr::LFCMode
+Memfile_LeaseMgr::getLFCMode() const {
+    std::string mode_str = "external";
+    try {
+        mode_str = conn_.getParameter("lfc-mode");
+    } catch (const std::exception&) {
+        // Ignore and default to external.
+    }
+
+    if (mode_str == "external") {
+        return (LFC_EXTERNAL);
+
+    } else if (mode_str == "internal") {
+        return (LFC_INTERNAL);
+    }
+
+    isc_throw(isc::BadValue, "invalid value of the lfc-mode "
+              << mode_str << " specified");
+}
+
+uint32_t
+Memfile_LeaseMgr::getUint32Parameter(const std::string& name,
+                                     const uint32_t default_value) const {
+    std::string value_str;
+    try {
+        value_str = conn_.getParameter(name);
+    } catch (const std::exception&) {
+        return (default_value);
+    }
+
+    try {
+        return (boost::lexical_cast<uint32_t>(value_str));
+    } catch (boost::bad_lexical_cast&) {
+        isc_throw(isc::BadValue, "invalid value of the " << name << " "
+                  << value_str << " specified");
+    }
+}
+
+void
+Memfile_LeaseMgr::leasesWritten(const Universe& u, const uint64_t count) {
+    if ((count == 0) || !persistLeases(u)) {
+        return;
+    }
+
+    switch (persist_mode_) {
+    case PERSIST_SYNC:
+        commitLeaseFile(count);
+        break;
+
+    case PERSIST_GROUP:
+        if (pending_writes_ == 0) {
+            first_pending_time_ = microsec_clock::universal_time();
+        }
+        pending_writes_ += count;
+        write_seq_ += count;
+        if (pending_writes_ >= commit_batch_size_) {
+            // In the multi-threading mode one of the threads waiting in
+            // flushPending stores the full group outside of the lock.
+            if (MultiThreadingMgr::instance().getMode()) {
+                commit_cond_->broadcast();
+            } else {
+                commitLeaseFile(pending_writes_);
+            }
+        }
+        break;
+
+    default:
+        ;
+    }
+}
+
+void
+Memfile_LeaseMgr::commitLeaseFile(const uint64_t count) {
+    const ptime start = microsec_clock::universal_time();
+    std::string error;
+    try {
+        if (lease_file4_) {
+            lease_file4_->flush();
+            lease_file4_->sync();
+        }
+        if (lease_file6_) {
+            lease_file6_->flush();
+            lease_file6_->sync();
+        }
+    } catch (const std::exception& ex) {
+        error = ex.what();
+    }
+
+    pending_writes_ = 0;
+    commit_seq_ = write_seq_;
+    commit_cond_->broadcast();
+
+    if (!error.empty()) {
+        isc_throw(DbOperationError, "failed to store the lease updates: "
+                  << error);
+    }
+    updateCommitStats(microsec_clock::universal_time() - start, count);
+}
+
+void
+Memfile_LeaseMgr::waitForCommit() {
+    while (committing_) {
+        commit_cond_->wait(*mutex_);
+    }
+}
+
+void
+Memfile_LeaseMgr::updateCommitStats(const time_duration& latency,
+                                    const uint64_t count) {
+    StatsMgr& stats_mgr = StatsMgr::instance();
+    stats_mgr.addValue("lease-commits", static_cast<int64_t>(1));
+    stats_mgr.setValue("lease-commit-latency", latency);
+    stats_mgr.setValue("lease-commit-batch-size", static_cast<int64_t>(count));
+}
 
 bool
 Memfile_LeaseMgr::isLFCRunning() const {
+    if (lfc_mode_ == LFC_INTERNAL) {
+        Mutex::Locker lock(*lfc_mutex_);
+        return (lfc_running_);
+    }
     return (lfc_setup_->isRunning());
 }
 
 int
 Memfile_LeaseMgr::getLFCExitStatus() const {
+    if (lfc_mode_ == LFC_INTERNAL) {
+        Mutex::Locker lock(*lfc_mutex_);
+        return (lfc_status_);
+    }
     return (lfc_setup_->getExitStatus());
 }
 
@@ -1210,10 +1718,20 @@ Memfile_LeaseMgr::lfcCallback() {
 
     // Check if we're in the v4 or v6 space and use the appropriate file.
     if (lease_file4_) {
-        lfcExecute(lease_file4_);
+        if (lfc_mode_ == LFC_INTERNAL) {
+            lfcSnapshot<Lease4, CSVLeaseFile4, BinaryLeaseFile4>(lease_file4_,
+                                                                storage4_);
+        } else {
+            lfcExecute(lease_file4_);
+        }
 
     } else if (lease_file6_) {
-        lfcExecute(lease_file6_);
+        if (lfc_mode_ == LFC_INTERNAL) {
+            lfcSnapshot<Lease6, CSVLeaseFile6, BinaryLeaseFile6>(lease_file6_,
+                                                                storage6_);
+        } else {
+            lfcExecute(lease_file6_);
+        }
     }
 }
 
@@ -1236,12 +1754,16 @@ Memfile_LeaseMgr::lfcSetup(bool conversion_needed) {
 
     if (lfc_interval > 0 || conversion_needed) {
         lfc_setup_.reset(new LFCSetup(boost::bind(&Memfile_LeaseMgr::lfcCallback, this)));
-        lfc_setup_->setup(lfc_interval, lease_file4_, lease_file6_, conversion_needed);
+        lfc_setup_->setup(lfc_interval, lease_file4_, lease_file6_, lfc_mode_,
+                          conversion_needed);
     }
 }
 
 template<typename LeaseFileType>
 void Memfile_LeaseMgr::lfcExecute(boost::shared_ptr<LeaseFileType>& lease_file) {
+    // The mutex is locked in both threading modes because waitForCommit
+    // waits on the condition variable using it.
+    Mutex::Locker lock(*mutex_);
     bool do_lfc = true;
 
     // Check the status of the LFC instance.
@@ -1252,6 +1774,17 @@ void Memfile_LeaseMgr::lfcExecute(boost::shared_ptr<LeaseFileType>& lease_file)
     CSVFile lease_file_finish(appendSuffix(lease_file->getFilename(), FILE_FINISH));
     CSVFile lease_file_copy(appendSuffix(lease_file->getFilename(), FILE_INPUT));
     if (!lease_file_finish.exists() && !lease_file_copy.exists()) {
+        // Store the pending lease updates before the file is rotated.
+        waitForCommit();
+        if (pending_writes_ > 0) {
+            try {
+                commitLeaseFile(pending_writes_);
+            } catch (const std::exception& ex) {
+                LOG_ERROR(dhcpsrv_logger, DHCPSRV_MEMFILE_COMMIT_FAILED)
+                    .arg(ex.what());
+            }
+        }
+
         // Close the current file so as we can move it to the copy file.
         lease_file->close();
         // Move the current file to the copy file. Remember the result
@@ -1274,7 +1807,7 @@ void Memfile_LeaseMgr::lfcExecute(boost::shared_ptr<LeaseFileType>& lease_file)
         try {
             lease_file->open(true);
 
-        } catch (const CSVFileError& ex) {
+        } catch (const isc::Exception& ex) {
             // If we're unable to open the lease file this is a serious
             // error because the server will not be able to persist
             // leases.
@@ -1300,8 +1833,244 @@ void Memfile_LeaseMgr::lfcExecute(boost::shared_ptr<LeaseFileType>& lease_file)
     }
 }
 
+template<typename LeaseObjectType, typename CSVLeaseFileType,
+         typename BinaryLeaseFileType, typename LeaseFileType,
+         typename StorageType>
+void Memfile_LeaseMgr::lfcSnapshot(boost::shared_ptr<LeaseFileType>& lease_file,
+                                   const StorageType& storage) {
+    {
+        Mutex::Locker lfc_lock(*lfc_mutex_);
+        if (lfc_running_) {
+            LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_LFC_INTERNAL_IN_PROGRESS);
+            return;
+        }
+    }
+
+    // Join the thread which performed the previous cleanup.
+    lfcWait();
+
+    typedef std::vector<boost::shared_ptr<LeaseObjectType> > LeaseVector;
+    boost::shared_ptr<LeaseVector> leases(new LeaseVector());
+    const std::string filename = lease_file->getFilename();
+    const LeaseFileFormat format = getLeaseFileFormat();
+
+    // The kea-lfc left by the previous configuration may still be
+    // writing the lease files.
+    PIDFile pid_file(appendSuffix(filename, FILE_PID));
+    try {
+        if (pid_file.check()) {
+            LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_LFC_INTERNAL_IN_PROGRESS);
+            return;
+        }
+    } catch (const std::exception&) {
+        // The PID file is unreadable, so there is no process.
+    }
+
+    // The PID file is held until the leases are written, so the backend
+    // created for the new configuration doesn't load the lease files in
+    // the meantime, as with the kea-lfc.
+    try {
+        pid_file.write();
+    } catch (const std::exception& ex) {
+        LOG_ERROR(dhcpsrv_logger, DHCPSRV_MEMFILE_LFC_INTERNAL_FAIL)
+            .arg(ex.what());
+        return;
+    }
+
+    {
+        // The mutex is locked in both threading modes because
+        // waitForCommit waits on the condition variable using it.
+        Mutex::Locker lock(*mutex_);
+
+        // Store the pending lease updates before the file is rotated.
+        waitForCommit();
+        if (pending_writes_ > 0) {
+            try {
+                commitLeaseFile(pending_writes_);
+            } catch (const std::exception& ex) {
+                LOG_ERROR(dhcpsrv_logger, DHCPSRV_MEMFILE_COMMIT_FAILED)
+                    .arg(ex.what());
+            }
+        }
+
+        // Copy the pointers to the leases. They are ordered by address
+        // when they are written, outside of the lock.
+        typedef typename StorageType::template index<AddressIndexTag>::type
+            AddressIndex;
+        const AddressIndex& idx = storage.template get<AddressIndexTag>();
+        leases->reserve(idx.size());
+        for (typename AddressIndex::const_iterator lease = idx.begin();
+             lease != idx.end(); ++lease) {
+            leases->push_back(*lease);
+        }
+
+        // If the Lease File Copy exists, the previous cleanup has been
+        // interrupted. The copied leases include its contents, so the
+        // current file is left in place and the copy will be removed
+        // when the leases are written.
+        CSVFile lease_file_copy(appendSuffix(filename, FILE_INPUT));
+        if (!lease_file_copy.exists()) {
+            lease_file->close();
+            if (rename(filename.c_str(),
+                       lease_file_copy.getFilename().c_str()) != 0) {
+                LOG_ERROR(dhcpsrv_logger, DHCPSRV_MEMFILE_LFC_LEASE_FILE_RENAME_FAIL)
+                    .arg(filename)
+                    .arg(lease_file_copy.getFilename())
+                    .arg(strerror(errno));
+            }
+
+            // Re-open the current file for the new lease updates.
+            try {
+                lease_file->open(true);
+
+            } catch (const isc::Exception& ex) {
+                LOG_ERROR(dhcpsrv_logger, DHCPSRV_MEMFILE_LFC_LEASE_FILE_REOPEN_FAIL)
+                    .arg(filename)
+                    .arg(ex.what());
+                // Reset the pointer to the file so as the backend doesn't
+                // try to write leases to disk.
+                lease_file.reset();
+            }
+        }
+    }
+
+    {
+        Mutex::Locker lfc_lock(*lfc_mutex_);
+        lfc_running_ = true;
+    }
+
+    try {
+        lfc_thread_.reset(new Thread(boost::bind(&Memfile_LeaseMgr::lfcWrite<
+                                                 LeaseObjectType,
+                                                 CSVLeaseFileType,
+                                                 BinaryLeaseFileType,
+                                                 LeaseFileType>,
+                                                 this, filename, format,
+                                                 leases)));
+    } catch (const std::exception& ex) {
+        LOG_ERROR(dhcpsrv_logger, DHCPSRV_MEMFILE_LFC_INTERNAL_FAIL)
+            .arg(ex.what());
+        try {
+            pid_file.deleteFile();
+        } catch (const std::exception&) {
+            // Nothing more can be done here.
+        }
+        Mutex::Locker lfc_lock(*lfc_mutex_);
+        lfc_running_ = false;
+        lfc_status_ = 1;
+    }
+}
+
+template<typename LeaseObjectType, typename CSVLeaseFileType,
+         typename BinaryLeaseFileType, typename LeaseFileType>
+void Memfile_LeaseMgr::lfcWrite(const std::string& filename,
+                                const LeaseFileFormat format,
+                                const boost::shared_ptr<std::vector<
+                                    boost::shared_ptr<LeaseObjectType> > >& leases) {
+    const std::string output_file = appendSuffix(filename, FILE_OUTPUT);
+    const std::string finish_file = appendSuffix(filename, FILE_FINISH);
+    const std::string copy_file = appendSuffix(filename, FILE_INPUT);
+    const std::string previous_file = appendSuffix(filename, FILE_PREVIOUS);
+
+    int status = 0;
+    try {
+        LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_LFC_INTERNAL_START)
+            .arg(leases->size())
+            .arg(output_file);
+
+        // The snapshot is written ordered by address. The address index
+        // is not ordered when it is hashed.
+        if (!std::is_sorted(leases->begin(), leases->end(),
+                            leaseAddressLess<boost::shared_ptr<LeaseObjectType> >)) {
+            std::sort(leases->begin(), leases->end(),
+                      leaseAddressLess<boost::shared_ptr<LeaseObjectType> >);
+        }
+
+        // Remove the leftover of the cleanup which didn't complete.
+        static_cast<void>(remove(output_file.c_str()));
+
+        // The leases are written in the format of the lease files. The
+        // binary file is marked as a snapshot, so it is loaded in bulk.
+        boost::shared_ptr<LeaseFileType> output;
+        if (format == LEASE_FILE_BINARY) {
+            boost::shared_ptr<BinaryLeaseFileType>
+                snapshot(new BinaryLeaseFileType(output_file));
+            snapshot->setSnapshot(true);
+            output = snapshot;
+        } else {
+            output.reset(new CSVLeaseFileType(output_file));
+        }
+        output->open(true);
+        output->setAutoFlush(false);
+        for (typename std::vector<boost::shared_ptr<LeaseObjectType> >::
+                 const_iterator lease = leases->begin();
+             lease != leases->end(); ++lease) {
+            output->append(**lease);
+        }
+        output->flush();
+        output->sync();
+        output->close();
+
+        // From now on the leases are loaded from the finish file.
+        if (rename(output_file.c_str(), finish_file.c_str()) != 0) {
+            isc_throw(DbOperationError, "unable to rename " << output_file
+                      << " to " << finish_file << ": " << strerror(errno));
+        }
+
+        if ((remove(copy_file.c_str()) != 0) && (errno != ENOENT)) {
+            isc_throw(DbOperationError, "unable to remove " << copy_file
+                      << ": " << strerror(errno));
+        }
+
+        if ((remove(previous_file.c_str()) != 0) && (errno != ENOENT)) {
+            isc_throw(DbOperationError, "unable to remove " << previous_file
+                      << ": " << strerror(errno));
+        }
+
+        if (rename(finish_file.c_str(), previous_file.c_str()) != 0) {
+            isc_throw(DbOperationError, "unable to rename " << finish_file
+                      << " to " << previous_file << ": " << strerror(errno));
+        }
+
+        LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_LFC_INTERNAL_COMPLETE)
+            .arg(leases->size())
+            .arg(previous_file);
+
+    } catch (const std::exception& ex) {
+        LOG_ERROR(dhcpsrv_logger, DHCPSRV_MEMFILE_LFC_INTERNAL_FAIL)
+            .arg(ex.what());
+        status = 1;
+    }
+
+    try {
+        PIDFile(appendSuffix(filename, FILE_PID)).deleteFile();
+    } catch (const std::exception& ex) {
+        LOG_ERROR(dhcpsrv_logger, DHCPSRV_MEMFILE_LFC_INTERNAL_FAIL)
+            .arg(ex.what());
+        status = 1;
+    }
+
+    Mutex::Locker lfc_lock(*lfc_mutex_);
+    lfc_running_ = false;
+    lfc_status_ = status;
+}
+
+void
+Memfile_LeaseMgr::lfcWait() {
+    if (lfc_thread_) {
+        try {
+            lfc_thread_->wait();
+        } catch (const std::exception& ex) {
+            LOG_ERROR(dhcpsrv_logger, DHCPSRV_MEMFILE_LFC_INTERNAL_FAIL)
+                .arg(ex.what());
+        }
+        lfc_thread_.reset();
+    }
+}
+
 LeaseStatsQueryPtr
 Memfile_LeaseMgr::startLeaseStatsQuery4() {
+    MultiThreadingLock lock(*mutex_);
     LeaseStatsQueryPtr query(new MemfileLeaseStatsQuery4(storage4_));
     query->start();
     return(query);
@@ -1309,12 +2078,14 @@ Memfile_LeaseMgr::startLeaseStatsQuery4() {
 
 LeaseStatsQueryPtr
 Memfile_LeaseMgr::startLeaseStatsQuery6() {
+    MultiThreadingLock lock(*mutex_);
     LeaseStatsQueryPtr query(new MemfileLeaseStatsQuery6(storage6_));
     query->start();
     return(query);
 }
 
 size_t Memfile_LeaseMgr::wipeLeases4(const SubnetID& subnet_id) {
+    MultiThreadingLock lock(*mutex_);
     LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_WIPE_LEASES4)
         .arg(subnet_id);
 
@@ -1334,7 +2105,7 @@ size_t Memfile_LeaseMgr::wipeLeases4(const SubnetID& subnet_id) {
 
     size_t num = leases.size();
     for (auto l = leases.begin(); l != leases.end(); ++l) {
-        deleteLease((*l)->addr_);
+        deleteLeaseInternal((*l)->addr_);
     }
     LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_WIPE_LEASES4_FINISHED)
         .arg(subnet_id).arg(num);
@@ -1343,6 +2114,7 @@ size_t Memfile_LeaseMgr::wipeLeases4(const SubnetID& subnet_id) {
 }
 
 size_t Memfile_LeaseMgr::wipeLeases6(const SubnetID& subnet_id) {
+    MultiThreadingLock lock(*mutex_);
     LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_WIPE_LEASES6)
         .arg(subnet_id);
 
@@ -1362,7 +2134,7 @@ size_t Memfile_LeaseMgr::wipeLeases6(const SubnetID& subnet_id) {
 
     size_t num = leases.size();
     for (auto l = leases.begin(); l != leases.end(); ++l) {
-        deleteLease((*l)->addr_);
+        deleteLeaseInternal((*l)->addr_);
     }
     LOG_INFO(dhcpsrv_logger, DHCPSRV_MEMFILE_WIPE_LEASES6_FINISHED)
         .arg(subnet_id).arg(num);
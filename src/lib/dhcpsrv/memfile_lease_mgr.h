@@ -9,16 +9,24 @@
 
 #include <asiolink/interval_timer.h>
 #include <dhcp/hwaddr.h>
+#include <dhcpsrv/binary_lease_file4.h>
+#include <dhcpsrv/binary_lease_file6.h>
 #include <dhcpsrv/csv_lease_file4.h>
 #include <dhcpsrv/csv_lease_file6.h>
+#include <dhcpsrv/lease_file.h>
 #include <dhcpsrv/memfile_lease_storage.h>
 #include <dhcpsrv/database_connection.h>
 #include <dhcpsrv/lease_mgr.h>
 #include <util/process_spawn.h>
+#include <util/threads/sync.h>
+#include <util/threads/thread.h>
 
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 
+#include <vector>
+
 namespace isc {
 namespace dhcp {
 
@@ -44,6 +52,21 @@ class LFCSetup;
 /// the startup of the background process which removes redundant information
 /// from the lease file(s).
 ///
+/// With the "lfc-mode=internal" parameter the cleanup is performed by the
+/// backend instead of the @c kea-lfc process. The callback copies the
+/// pointers to the leases held in the container, rotates the Current
+/// %Lease File and writes the copied leases in a background thread using
+/// the same file names as the @c kea-lfc. The leases don't have to be
+/// read from the lease files again, so the cost of the cleanup depends
+/// on the number of leases rather than on the size of the lease files.
+/// The leases are written in the format of the lease files. With the
+/// "lease-file-format=binary" parameter they are written to a binary
+/// snapshot (see @ref BinaryLeaseFile::FLAG_SNAPSHOT). At startup the
+/// snapshot is loaded in bulk and only the lease updates recorded since
+/// it was taken are replayed, so the startup time is bounded by the
+/// number of leases and the "lfc-interval" rather than by the renewal
+/// rate.
+///
 /// When the backend is starting up, it reads leases from the lease file (one
 /// by one) and adds them to the in-memory container as follows:
 /// - if the lease record being parsed identifies a lease which is not present
@@ -73,6 +96,44 @@ class LFCSetup;
 /// is not specified, the default location in the installation
 /// directory is used: var/kea/kea-leases4.csv and
 /// var/kea/kea-leases6.csv.
+///
+/// The lease files are mapped into memory and parsed by multiple threads
+/// at startup (see @ref LeaseFileLoader::load). The number of threads is
+/// specified with the "load-threads=[number]" parameter. The value of 0,
+/// which is the default, uses one thread per processor and the value of
+/// 1 reads the lease files row by row.
+///
+/// The lease updates are recorded in the CSV format by default. The
+/// "lease-file-format=binary" parameter selects the binary format (see
+/// @ref BinaryLeaseFile) which is faster to write and read. The format
+/// of each lease file is detected when it is loaded, so the lease files
+/// written in the other format are still read. If the Current Lease File
+/// is in the other format, it is converted to the configured format when
+/// the backend is created.
+///
+/// The "persist-mode" parameter controls when the lease updates reach
+/// the disk:
+/// - "async", the default, writes each update to the lease file and lets
+/// the operating system store it on the disk,
+/// - "sync" waits until each update is stored on the disk before the
+/// method making it returns,
+/// - "group" buffers the updates and stores them on the disk together
+/// when the group holds "commit-batch-size" updates or "commit-interval"
+/// milliseconds after the first update of the group, whichever comes
+/// first. The servers hold the responses until the leases they carry are
+/// stored: in the single-threaded mode they call @c flushDuePending after
+/// processing the packets received together and send the responses when
+/// the group has been stored. In the multi-threading mode the threads
+/// calling @c flushPending wait for other threads to join the group.
+///
+/// The synchronizations are counted in the "lease-commits" statistic.
+/// The "lease-commit-latency" and "lease-commit-batch-size" statistics
+/// hold the duration and the number of updates of the last one.
+///
+/// When the multi-threading mode is enabled (see
+/// @ref isc::util::thread::MultiThreadingMgr), the public methods of this
+/// backend lock a mutex so the leases can be accessed and modified by
+/// multiple threads concurrently.
 class Memfile_LeaseMgr : public LeaseMgr {
 public:
 
@@ -104,6 +165,19 @@ public:
         V6
     };
 
+    /// @brief Specifies when the lease updates are stored on the disk.
+    enum PersistMode {
+        PERSIST_ASYNC, ///< Stored by the operating system.
+        PERSIST_SYNC,  ///< Stored before each update returns.
+        PERSIST_GROUP  ///< Stored in groups by @c flushPending.
+    };
+
+    /// @brief Specifies how the %Lease File Cleanup is performed.
+    enum LFCMode {
+        LFC_EXTERNAL, ///< By the spawned @c kea-lfc process.
+        LFC_INTERNAL  ///< By a thread of the backend.
+    };
+
     /// @name Methods implementing the API of the lease database backend.
     ///       The following methods are implementing the API of the
     ///       @c LeaseMgr to manage leases.
@@ -220,6 +294,17 @@ public:
     virtual Lease4Ptr getLease4(const ClientId& clientid,
                                 SubnetID subnet_id) const;
 
+    /// @brief Returns all IPv4 leases for the particular subnet identifier.
+    ///
+    /// This function returns copies of the leases. The modification in the
+    /// returned leases does not affect the instances held in the lease
+    /// storage.
+    ///
+    /// @param subnet_id subnet identifier.
+    ///
+    /// @return Lease collection (may be empty if no IPv4 lease found).
+    virtual Lease4Collection getLeases4(SubnetID subnet_id) const;
+
     /// @brief Returns existing IPv6 lease for a given IPv6 address.
     ///
     /// This function returns a copy of the lease. The modification in the
@@ -352,6 +437,16 @@ public:
 
 private:
 
+    /// @brief Deletes a lease (internal version).
+    ///
+    /// It must be called with the mutex locked.
+    ///
+    /// @param addr Address of the lease to be deleted. (This can be IPv4 or
+    ///        IPv6.)
+    ///
+    /// @return true if deletion was successful, false if no such lease exists
+    bool deleteLeaseInternal(const isc::asiolink::IOAddress& addr);
+
     /// @brief Deletes all expired-reclaimed leases.
     ///
     /// This private method is called by both of the public methods:
@@ -432,6 +527,37 @@ public:
     /// support transactions, this is a no-op.
     virtual void rollback();
 
+    /// @brief Waits until the lease updates are stored on the disk.
+    ///
+    /// In the "group" persist mode the buffered lease updates are written
+    /// to the lease file and the file data are synchronized with the disk.
+    /// In the multi-threading mode, the thread waits for the other threads
+    /// to add their updates to the group until the group is full or the
+    /// commit interval elapses. The first thread which finds the group
+    /// ready synchronizes the data while the other threads wait for it.
+    /// In the other persist modes this is no-op.
+    ///
+    /// @throw DbOperationError if the data couldn't be synchronized.
+    virtual void flushPending();
+
+    /// @brief Stores the lease updates on the disk when they are due.
+    ///
+    /// In the "group" persist mode and the single-threaded mode the
+    /// buffered lease updates are stored when "commit-interval"
+    /// milliseconds have elapsed since the first update of the group.
+    /// Otherwise, it calls @c flushPending.
+    ///
+    /// @return Time in milliseconds after which the buffered updates are
+    /// due, 0 if no updates are buffered.
+    /// @throw DbOperationError if the data couldn't be synchronized.
+    virtual uint32_t flushDuePending();
+
+    /// @brief Checks if lease updates are buffered in the "group" persist
+    /// mode.
+    ///
+    /// @return true if some updates are buffered.
+    virtual bool hasPending() const;
+
     //@}
 
     /// @name Public type and method used to determine file names for LFC.
@@ -569,20 +695,126 @@ private:
     /// the server will store lease updates.
     /// @param storage A storage for leases read from the lease file.
     /// @tparam LeaseObjectType @c Lease4 or @c Lease6.
-    /// @tparam LeaseFileType @c CSVLeaseFile4 or @c CSVLeaseFile6.
+    /// @tparam CSVLeaseFileType @c CSVLeaseFile4 or @c CSVLeaseFile6.
+    /// @tparam BinaryLeaseFileType @c BinaryLeaseFile4 or
+    /// @c BinaryLeaseFile6.
+    /// @tparam LeaseFileType @c LeaseFile4 or @c LeaseFile6.
     /// @tparam StorageType @c Lease4Storage or @c Lease6Storage.
     ///
     /// @return Returns true if any of the files loaded need conversion from
     /// an older or newer schema.
     ///
     /// @throw CSVFileError when parsing any of the lease files fails.
-    /// @throw DbOpenError when it is found that the LFC is in progress.
-    template<typename LeaseObjectType, typename LeaseFileType,
+    /// @throw DbOpenError when it is found that the LFC is in progress or
+    /// the Current Lease File couldn't be converted to the configured
+    /// format.
+    template<typename LeaseObjectType, typename CSVLeaseFileType,
+             typename BinaryLeaseFileType, typename LeaseFileType,
              typename StorageType>
     bool loadLeasesFromFiles(const std::string& filename,
                              boost::shared_ptr<LeaseFileType>& lease_file,
                              StorageType& storage);
 
+    /// @brief Converts the lease file to the specified format.
+    ///
+    /// The lease entries are copied to a new file which then replaces
+    /// the original file.
+    ///
+    /// @param filename Name of the lease file.
+    /// @param format Format to which the file is converted.
+    /// @tparam LeaseObjectType @c Lease4 or @c Lease6.
+    /// @tparam CSVLeaseFileType @c CSVLeaseFile4 or @c CSVLeaseFile6.
+    /// @tparam BinaryLeaseFileType @c BinaryLeaseFile4 or
+    /// @c BinaryLeaseFile6.
+    /// @tparam LeaseFileType @c LeaseFile4 or @c LeaseFile6.
+    ///
+    /// @throw DbOpenError if the new file couldn't replace the original
+    /// file.
+    template<typename LeaseObjectType, typename CSVLeaseFileType,
+             typename BinaryLeaseFileType, typename LeaseFileType>
+    void convertLeaseFile(const std::string& filename,
+                          const LeaseFileFormat format);
+
+    /// @brief Returns the format of the lease files.
+    ///
+    /// The format is specified with the "lease-file-format" parameter.
+    ///
+    /// @return Format of the lease files, @c LEASE_FILE_CSV when not
+    /// specified.
+    /// @throw isc::BadValue if the parameter value is invalid.
+    LeaseFileFormat getLeaseFileFormat() const;
+
+    /// @brief Returns the number of threads loading the lease files.
+    ///
+    /// The number is specified with the "load-threads" parameter. The
+    /// value of 0 means one thread per processor.
+    ///
+    /// @return Number of threads, 0 when not specified.
+    /// @throw isc::BadValue if the parameter value is invalid.
+    size_t getLoadThreads() const;
+
+    /// @brief Returns the persist mode of the lease updates.
+    ///
+    /// The mode is specified with the "persist-mode" parameter.
+    ///
+    /// @return Persist mode, @c PERSIST_ASYNC when not specified.
+    /// @throw isc::BadValue if the parameter value is invalid.
+    PersistMode getPersistMode() const;
+
+    /// @brief Returns the mode of the %Lease File Cleanup.
+    ///
+    /// The mode is specified with the "lfc-mode" parameter.
+    ///
+    /// @return Cleanup mode, @c LFC_EXTERNAL when not specified.
+    /// @throw isc::BadValue if the parameter value is invalid.
+    LFCMode getLFCMode() const;
+
+    /// @brief Returns the value of the integer parameter.
+    ///
+    /// @param name Name of the parameter.
+    /// @param default_value Value returned when the parameter is not
+    /// specified.
+    ///
+    /// @return Value of the parameter.
+    /// @throw isc::BadValue if the parameter value is invalid.
+    uint32_t getUint32Parameter(const std::string& name,
+                                const uint32_t default_value) const;
+
+    /// @brief Records that lease updates have been appended to the lease
+    /// file.
+    ///
+    /// Depending on the persist mode, it synchronizes the file or adds
+    /// the updates to the pending group. It must be called with the mutex
+    /// locked.
+    ///
+    /// @param u Universe (V4 or V6).
+    /// @param count Number of appended lease updates.
+    void leasesWritten(const Universe& u, const uint64_t count);
+
+    /// @brief Synchronizes the lease file data with the disk.
+    ///
+    /// Flushes the lease file and waits until its data are on the disk.
+    /// It must be called with the mutex locked and outside of the
+    /// synchronization started by @c flushPending.
+    ///
+    /// @param count Number of lease updates being stored.
+    void commitLeaseFile(const uint64_t count);
+
+    /// @brief Waits for the synchronization started by another thread
+    /// in the "group" persist mode.
+    ///
+    /// It must be called with the mutex locked in both threading modes,
+    /// as the mutex is released while waiting. It must be called before
+    /// the lease file is closed.
+    void waitForCommit();
+
+    /// @brief Updates the statistics of the synchronizations.
+    ///
+    /// @param latency Duration of the synchronization.
+    /// @param count Number of lease updates stored.
+    static void updateCommitStats(const boost::posix_time::time_duration& latency,
+                                  const uint64_t count);
+
     /// @brief stores IPv4 leases
     Lease4Storage storage4_;
 
@@ -590,10 +822,46 @@ private:
     Lease6Storage storage6_;
 
     /// @brief Holds the pointer to the DHCPv4 lease file IO.
-    boost::shared_ptr<CSVLeaseFile4> lease_file4_;
+    LeaseFile4Ptr lease_file4_;
 
     /// @brief Holds the pointer to the DHCPv6 lease file IO.
-    boost::shared_ptr<CSVLeaseFile6> lease_file6_;
+    LeaseFile6Ptr lease_file6_;
+
+    /// @brief Mutex protecting the lease containers and the lease files
+    /// in the multi-threading mode.
+    boost::scoped_ptr<isc::util::thread::Mutex> mutex_;
+
+    /// @brief Persist mode of the lease updates.
+    PersistMode persist_mode_;
+
+    /// @brief Maximum time in milliseconds the lease updates wait for
+    /// other updates to join their group.
+    uint32_t commit_interval_;
+
+    /// @brief Number of lease updates which triggers the synchronization
+    /// of the group.
+    uint32_t commit_batch_size_;
+
+    /// @brief Number of lease updates in the pending group.
+    uint64_t pending_writes_;
+
+    /// @brief Time when the first lease update was added to the pending
+    /// group.
+    boost::posix_time::ptime first_pending_time_;
+
+    /// @brief Sequence number of the last lease update appended to the
+    /// lease file.
+    uint64_t write_seq_;
+
+    /// @brief Sequence number of the last lease update stored on the disk.
+    uint64_t commit_seq_;
+
+    /// @brief Indicates if a thread is synchronizing the lease file.
+    bool committing_;
+
+    /// @brief Condition variable signalled when the pending group is
+    /// full or has been stored.
+    boost::scoped_ptr<isc::util::thread::CondVar> commit_cond_;
 
 public:
 
@@ -605,11 +873,15 @@ public:
 
     /// @brief Checks if the process performing lease file cleanup is running.
     ///
-    /// @return true if the process performing lease file cleanup is running.
+    /// @return true if the process or the thread performing lease file
+    /// cleanup is running.
     bool isLFCRunning() const;
 
     /// @brief Returns the status code returned by the last executed
     /// LFC process.
+    ///
+    /// When the cleanup is performed by the backend, it returns 0 if the
+    /// last cleanup succeeded and 1 otherwise.
     int getLFCExitStatus() const;
     //@}
 
@@ -696,13 +968,94 @@ private:
     /// @param lease_file A pointer to the object representing the Current
     /// %Lease File (DHCPv4 or DHCPv6 lease file).
     ///
-    /// @tparam LeaseFileType One of @c CSVLeaseFile4 or @c CSVLeaseFile6.
+    /// @tparam LeaseFileType One of @c LeaseFile4 or @c LeaseFile6.
     template<typename LeaseFileType>
     void lfcExecute(boost::shared_ptr<LeaseFileType>& lease_file);
 
+    /// @brief Performs a lease file cleanup within the backend.
+    ///
+    /// This method copies the pointers to the leases held in the
+    /// container and, unless the %Lease File Copy exists, moves the
+    /// Current %Lease File to the %Lease File Copy and recreates the
+    /// Current %Lease File. Both happen under the backend lock, so the
+    /// copied leases reflect all updates recorded in the files other than
+    /// the Current %Lease File. The copied leases are then written by the
+    /// @c lfcWrite method in a background thread.
+    ///
+    /// The leases held in the container are never modified (they are
+    /// replaced on update), so sharing them with the thread is safe.
+    ///
+    /// The %Lease File PID is created before the files are rotated and
+    /// removed when the leases are written, so the cleanup is skipped
+    /// while the @c kea-lfc is running and the lease files are not
+    /// loaded by another backend instance in the meantime.
+    ///
+    /// @param lease_file A pointer to the object representing the Current
+    /// %Lease File (DHCPv4 or DHCPv6 lease file).
+    /// @param storage Reference to the container holding the leases.
+    ///
+    /// @tparam LeaseObjectType @c Lease4 or @c Lease6.
+    /// @tparam CSVLeaseFileType @c CSVLeaseFile4 or @c CSVLeaseFile6.
+    /// @tparam BinaryLeaseFileType @c BinaryLeaseFile4 or
+    /// @c BinaryLeaseFile6.
+    /// @tparam LeaseFileType @c LeaseFile4 or @c LeaseFile6.
+    /// @tparam StorageType @c Lease4Storage or @c Lease6Storage.
+    template<typename LeaseObjectType, typename CSVLeaseFileType,
+             typename BinaryLeaseFileType, typename LeaseFileType,
+             typename StorageType>
+    void lfcSnapshot(boost::shared_ptr<LeaseFileType>& lease_file,
+                     const StorageType& storage);
+
+    /// @brief Writes the leases copied by @c lfcSnapshot.
+    ///
+    /// This method runs in the background thread. It writes the leases
+    /// to the %Lease File Output in the format of the lease files. The
+    /// binary file is written as a snapshot, ordered by address. The
+    /// %Lease File Output is synchronized to the disk and moved to the
+    /// %Lease File Finish. Then it removes the %Lease File Copy and
+    /// the %Lease File Previous and moves the %Lease File Finish to the
+    /// %Lease File Previous. If the server is stopped at any point, the
+    /// leases are loaded from the remaining files as after an interrupted
+    /// @c kea-lfc run.
+    ///
+    /// @param filename Name of the Current %Lease File.
+    /// @param format Format of the lease files.
+    /// @param leases Pointer to the copied leases.
+    ///
+    /// @tparam LeaseObjectType @c Lease4 or @c Lease6.
+    /// @tparam CSVLeaseFileType @c CSVLeaseFile4 or @c CSVLeaseFile6.
+    /// @tparam BinaryLeaseFileType @c BinaryLeaseFile4 or
+    /// @c BinaryLeaseFile6.
+    /// @tparam LeaseFileType @c LeaseFile4 or @c LeaseFile6.
+    template<typename LeaseObjectType, typename CSVLeaseFileType,
+             typename BinaryLeaseFileType, typename LeaseFileType>
+    void lfcWrite(const std::string& filename,
+                  const LeaseFileFormat format,
+                  const boost::shared_ptr<std::vector<boost::shared_ptr<
+                      LeaseObjectType> > >& leases);
+
+    /// @brief Waits for the thread performing the cleanup to complete.
+    void lfcWait();
+
     /// @brief A pointer to the Lease File Cleanup configuration.
     boost::scoped_ptr<LFCSetup> lfc_setup_;
 
+    /// @brief Mode of the %Lease File Cleanup.
+    LFCMode lfc_mode_;
+
+    /// @brief Thread writing the leases when the cleanup is performed
+    /// by the backend.
+    boost::scoped_ptr<isc::util::thread::Thread> lfc_thread_;
+
+    /// @brief Mutex protecting the state of the cleanup thread.
+    boost::scoped_ptr<isc::util::thread::Mutex> lfc_mutex_;
+
+    /// @brief Indicates if the cleanup thread is writing the leases.
+    bool lfc_running_;
+
+    /// @brief Status of the last cleanup performed by the thread.
+    int lfc_status_;
+
     /// @brief Parameters storage
     ///
     /// DatabaseConnection object is used only for storing, accessing and
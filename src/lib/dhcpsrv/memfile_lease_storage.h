@@ -11,6 +11,7 @@
 #include <dhcpsrv/lease.h>
 #include <dhcpsrv/subnet_id.h>
 
+#include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/indexed_by.hpp>
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/mem_fun.hpp>
@@ -36,9 +37,15 @@ struct ExpirationIndexTag { };
 /// @brief Tag for indexes by HW address, subnet identifier tuple.
 struct HWAddressSubnetIdIndexTag { };
 
+/// @brief Tag for indexes by HW address.
+struct HWAddressIndexTag { };
+
 /// @brief Tag for indexes by client and subnet identifiers.
 struct ClientIdSubnetIdIndexTag { };
 
+/// @brief Tag for indexes by client identifier.
+struct ClientIdIndexTag { };
+
 /// @brief Tag for indexes by client id, HW address and subnet id.
 struct ClientIdHWAddressSubnetIdIndexTag { };
 
@@ -49,6 +56,8 @@ struct SubnetIdIndexTag { };
 ///
 //@{
 
+#ifndef ENABLE_MEMFILE_HASHED_INDEXES
+
 /// @brief A multi index container holding DHCPv6 leases.
 ///
 /// The leases in the container may be accessed using different indexes:
@@ -146,8 +155,9 @@ typedef boost::multi_index_container<
         >,
 
         // Specification of the second index starts here.
+        // It is also used to search by the HW address only.
         boost::multi_index::ordered_non_unique<
-            boost::multi_index::tag<HWAddressSubnetIdIndexTag>,
+            boost::multi_index::tag<HWAddressSubnetIdIndexTag, HWAddressIndexTag>,
             // This is a composite index that combines two attributes of the
             // Lease4 object: hardware address and subnet id.
             boost::multi_index::composite_key<
@@ -167,8 +177,9 @@ typedef boost::multi_index_container<
         >,
 
         // Specification of the third index starts here.
+        // It is also used to search by the client id only.
         boost::multi_index::ordered_non_unique<
-            boost::multi_index::tag<ClientIdSubnetIdIndexTag>,
+            boost::multi_index::tag<ClientIdSubnetIdIndexTag, ClientIdIndexTag>,
             // This is a composite index that uses two values to search for a
             // lease: client id and subnet id.
             boost::multi_index::composite_key<
@@ -232,6 +243,154 @@ typedef boost::multi_index_container<
     >
 > Lease4Storage; // Specify the type name for this container.
 
+#else // ENABLE_MEMFILE_HASHED_INDEXES
+
+/// @brief A multi index container holding DHCPv6 leases.
+///
+/// This variant of the container is used when Kea is configured with
+/// --enable-memfile-hashed-indexes. The indexes used to search for
+/// individual leases (by address and by DUID, IAID and lease type) are
+/// hashed, so the lookups take constant time regardless of the number of
+/// leases. The indexes used for range scans (by expiration time and by
+/// subnet identifier) remain ordered.
+typedef boost::multi_index_container<
+    // It holds pointers to Lease6 objects.
+    Lease6Ptr,
+    boost::multi_index::indexed_by<
+        // Specification of the first index starts here.
+        // This index is used to search for the lease by IPv6 address.
+        boost::multi_index::hashed_unique<
+            boost::multi_index::tag<AddressIndexTag>,
+            boost::multi_index::member<Lease, isc::asiolink::IOAddress, &Lease::addr_>
+        >,
+
+        // Specification of the second index starts here.
+        boost::multi_index::hashed_non_unique<
+            boost::multi_index::tag<DuidIaidTypeIndexTag>,
+            boost::multi_index::composite_key<
+                Lease6,
+                boost::multi_index::const_mem_fun<Lease6, const std::vector<uint8_t>&,
+                                                  &Lease6::getDuidVector>,
+                boost::multi_index::member<Lease6, uint32_t, &Lease6::iaid_>,
+                boost::multi_index::member<Lease6, Lease::Type, &Lease6::type_>
+            >
+        >,
+
+        // Specification of the third index starts here.
+        boost::multi_index::ordered_non_unique<
+            boost::multi_index::tag<ExpirationIndexTag>,
+            boost::multi_index::composite_key<
+                Lease6,
+                boost::multi_index::const_mem_fun<Lease, bool,
+                                                  &Lease::stateExpiredReclaimed>,
+                boost::multi_index::const_mem_fun<Lease, int64_t,
+                                                  &Lease::getExpirationTime>
+            >
+        >,
+
+        // Specification of the fourth index starts here.
+        // This index sorts leases by SubnetID.
+        boost::multi_index::ordered_non_unique<
+            boost::multi_index::tag<SubnetIdIndexTag>,
+            boost::multi_index::member<Lease, isc::dhcp::SubnetID, &Lease::subnet_id_>
+        >
+     >
+> Lease6Storage; // Specify the type name of this container.
+
+/// @brief A multi index container holding DHCPv4 leases.
+///
+/// This variant of the container is used when Kea is configured with
+/// --enable-memfile-hashed-indexes. The indexes used to search for
+/// individual leases are hashed. Hashed composite indexes can only be
+/// searched using all key components, so there are additional indexes
+/// by HW address and by client identifier which are used to search for
+/// all leases of the client. The indexes by expiration time and by
+/// subnet identifier remain ordered.
+typedef boost::multi_index_container<
+    // It holds pointers to Lease4 objects.
+    Lease4Ptr,
+    boost::multi_index::indexed_by<
+        // Specification of the first index starts here.
+        // This index is used to search for the lease by IPv4 address.
+        boost::multi_index::hashed_unique<
+            boost::multi_index::tag<AddressIndexTag>,
+            boost::multi_index::member<Lease, isc::asiolink::IOAddress, &Lease::addr_>
+        >,
+
+        // Specification of the second index starts here.
+        boost::multi_index::hashed_non_unique<
+            boost::multi_index::tag<HWAddressSubnetIdIndexTag>,
+            boost::multi_index::composite_key<
+                Lease4,
+                boost::multi_index::const_mem_fun<Lease, const std::vector<uint8_t>&,
+                                                  &Lease::getHWAddrVector>,
+                boost::multi_index::member<Lease, SubnetID, &Lease::subnet_id_>
+            >
+        >,
+
+        // Specification of the third index starts here.
+        boost::multi_index::hashed_non_unique<
+            boost::multi_index::tag<ClientIdSubnetIdIndexTag>,
+            boost::multi_index::composite_key<
+                Lease4,
+                boost::multi_index::const_mem_fun<Lease4, const std::vector<uint8_t>&,
+                                                  &Lease4::getClientIdVector>,
+                boost::multi_index::member<Lease, uint32_t, &Lease::subnet_id_>
+            >
+        >,
+
+        // Specification of the fourth index starts here.
+        boost::multi_index::hashed_non_unique<
+            boost::multi_index::tag<ClientIdHWAddressSubnetIdIndexTag>,
+            boost::multi_index::composite_key<
+                Lease4,
+                boost::multi_index::const_mem_fun<Lease4, const std::vector<uint8_t>&,
+                                                  &Lease4::getClientIdVector>,
+                boost::multi_index::const_mem_fun<Lease, const std::vector<uint8_t>&,
+                                                  &Lease::getHWAddrVector>,
+                boost::multi_index::member<Lease, SubnetID, &Lease::subnet_id_>
+            >
+        >,
+
+        // Specification of the fifth index starts here.
+        boost::multi_index::ordered_non_unique<
+            boost::multi_index::tag<ExpirationIndexTag>,
+            boost::multi_index::composite_key<
+                Lease4,
+                boost::multi_index::const_mem_fun<Lease, bool,
+                                                  &Lease::stateExpiredReclaimed>,
+                boost::multi_index::const_mem_fun<Lease, int64_t,
+                                                  &Lease::getExpirationTime>
+            >
+        >,
+
+        // Specification of the sixth index starts here.
+        // This index sorts leases by SubnetID.
+        boost::multi_index::ordered_non_unique<
+            boost::multi_index::tag<SubnetIdIndexTag>,
+            boost::multi_index::member<Lease, isc::dhcp::SubnetID, &Lease::subnet_id_>
+        >,
+
+        // Specification of the seventh index starts here.
+        // This index is used to search for all leases by HW address.
+        boost::multi_index::hashed_non_unique<
+            boost::multi_index::tag<HWAddressIndexTag>,
+            boost::multi_index::const_mem_fun<Lease, const std::vector<uint8_t>&,
+                                              &Lease::getHWAddrVector>
+        >,
+
+        // Specification of the eighth index starts here.
+        // This index is used to search for all leases by client id.
+        boost::multi_index::hashed_non_unique<
+            boost::multi_index::tag<ClientIdIndexTag>,
+            boost::multi_index::const_mem_fun<Lease4, const std::vector<uint8_t>&,
+                                              &Lease4::getClientIdVector>
+        >
+    >
+> Lease4Storage; // Specify the type name for this container.
+
+#endif // ENABLE_MEMFILE_HASHED_INDEXES
+
 //@}
 
 /// @name Indexes used by the multi index containers
@@ -260,10 +419,16 @@ typedef Lease4Storage::index<ExpirationIndexTag>::type Lease4StorageExpirationIn
 typedef Lease4Storage::index<HWAddressSubnetIdIndexTag>::type
 Lease4StorageHWAddressSubnetIdIndex;
 
+/// @brief DHCPv4 lease storage index by HW address.
+typedef Lease4Storage::index<HWAddressIndexTag>::type Lease4StorageHWAddressIndex;
+
 /// @brief DHCPv4 lease storage index by client and subnet identifier.
 typedef Lease4Storage::index<ClientIdSubnetIdIndexTag>::type
 Lease4StorageClientIdSubnetIdIndex;
 
+/// @brief DHCPv4 lease storage index by client identifier.
+typedef Lease4Storage::index<ClientIdIndexTag>::type Lease4StorageClientIdIndex;
+
 /// @brief DHCPv4 lease storage index by client id, HW address and subnet id.
 typedef Lease4Storage::index<ClientIdHWAddressSubnetIdIndexTag>::type
 Lease4StorageClientIdHWAddressSubnetIdIndex;
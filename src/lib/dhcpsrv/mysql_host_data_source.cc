@@ -27,6 +27,7 @@
 #include <mysql.h>
 #include <mysqld_error.h>
 
+#include <algorithm>
 #include <stdint.h>
 #include <string>
 
@@ -1758,6 +1759,8 @@ public:
         GET_HOST_SUBID_ADDR,    // Gets host by IPv4 SubnetID and IPv4 address
         GET_HOST_PREFIX,        // Gets host by IPv6 prefix
         GET_HOST_SUBID6_ADDR,   // Gets host by IPv6 SubnetID and IPv6 prefix
+        GET_HOST_SUBID4_DHCPIDS,// Gets hosts by IPv4 SubnetID, any identifier
+        GET_HOST_SUBID6_DHCPIDS,// Gets hosts by IPv6 SubnetID, any identifier
         GET_VERSION,            // Obtain version number
         INSERT_HOST,            // Insert new host to collection
         INSERT_V6_RESRV,        // Insert v6 reservation
@@ -1776,6 +1779,14 @@ public:
     /// such as INSERT, DELETE, UPDATE.
     static const StatementIndex WRITE_STMTS_BEGIN = INSERT_HOST;
 
+    /// @brief Number of identifiers used by the queries retrieving hosts
+    /// by any of the identifiers.
+    ///
+    /// It must be equal to the number of the identifier conditions in the
+    /// statements. It is equal to the number of identifier types, so all
+    /// identifiers configured for the server are used in a single query.
+    static const size_t MAX_QUERY_IDENTIFIERS = 5;
+
     /// @brief Constructor.
     ///
     /// This constructor opens database connection and initializes prepared
@@ -1890,6 +1901,26 @@ public:
                          StatementIndex stindex,
                          boost::shared_ptr<MySqlHostExchange> exchange) const;
 
+    /// @brief Retrieves hosts by subnet and any of client's identifiers.
+    ///
+    /// This method is used by both MySqlHostDataSource::getByIdentifiers4
+    /// and MySqlHostDataSource::getByIdentifiers6 methods. Up to
+    /// @c MAX_QUERY_IDENTIFIERS identifiers are used in a single query.
+    ///
+    /// @param subnet_id Subnet identifier.
+    /// @param identifiers Identifiers of the client ordered by priority.
+    /// @param stindex Statement index.
+    /// @param exchange Pointer to the exchange object used for the
+    /// particular query.
+    ///
+    /// @return Collection of hosts ordered by the priority of the
+    /// identifiers.
+    ConstHostCollection
+    getHostsByIdentifiers(const SubnetID& subnet_id,
+                          const HostIdentifierList& identifiers,
+                          StatementIndex stindex,
+                          boost::shared_ptr<MySqlHostExchange> exchange) const;
+
     /// @brief Throws exception if database is read only.
     ///
     /// This method should be called by the methods which write to the
@@ -2083,6 +2114,54 @@ TaggedStatementArray tagged_statements = { {
             "WHERE h.dhcp6_subnet_id = ? AND r.address = ? "
             "ORDER BY h.host_id, o.option_id, r.reservation_id"},
 
+    // Retrieves host information and DHCPv4 options using subnet identifier
+    // and any of client's identifiers. The number of the identifiers is
+    // MAX_QUERY_IDENTIFIERS. Left joining the dhcp4_options table results
+    // in multiple rows being returned for the same host.
+    {MySqlHostDataSourceImpl::GET_HOST_SUBID4_DHCPIDS,
+            "SELECT h.host_id, h.dhcp_identifier, h.dhcp_identifier_type, "
+                "h.dhcp4_subnet_id, h.dhcp6_subnet_id, h.ipv4_address, h.hostname, "
+                "h.dhcp4_client_classes, h.dhcp6_client_classes, "
+                "h.dhcp4_next_server, h.dhcp4_server_hostname, h.dhcp4_boot_file_name, "
+                "o.option_id, o.code, o.value, o.formatted_value, o.space, "
+                "o.persistent "
+            "FROM hosts AS h "
+            "LEFT JOIN dhcp4_options AS o "
+                "ON h.host_id = o.host_id "
+            "WHERE h.dhcp4_subnet_id = ? AND ("
+                "(h.dhcp_identifier_type = ? AND h.dhcp_identifier = ?) OR "
+                "(h.dhcp_identifier_type = ? AND h.dhcp_identifier = ?) OR "
+                "(h.dhcp_identifier_type = ? AND h.dhcp_identifier = ?) OR "
+                "(h.dhcp_identifier_type = ? AND h.dhcp_identifier = ?) OR "
+                "(h.dhcp_identifier_type = ? AND h.dhcp_identifier = ?)) "
+            "ORDER BY h.host_id, o.option_id"},
+
+    // Retrieves host information, IPv6 reservations and DHCPv6 options
+    // using subnet identifier and any of client's identifiers. The number
+    // of the identifiers is MAX_QUERY_IDENTIFIERS.
+    {MySqlHostDataSourceImpl::GET_HOST_SUBID6_DHCPIDS,
+            "SELECT h.host_id, h.dhcp_identifier, "
+                "h.dhcp_identifier_type, h.dhcp4_subnet_id, "
+                "h.dhcp6_subnet_id, h.ipv4_address, h.hostname, "
+                "h.dhcp4_client_classes, h.dhcp6_client_classes, "
+                "h.dhcp4_next_server, h.dhcp4_server_hostname, h.dhcp4_boot_file_name, "
+                "o.option_id, o.code, o.value, o.formatted_value, o.space, "
+                "o.persistent, "
+                "r.reservation_id, r.address, r.prefix_len, r.type, "
+                "r.dhcp6_iaid "
+            "FROM hosts AS h "
+            "LEFT JOIN dhcp6_options AS o "
+                "ON h.host_id = o.host_id "
+            "LEFT JOIN ipv6_reservations AS r "
+                "ON h.host_id = r.host_id "
+            "WHERE h.dhcp6_subnet_id = ? AND ("
+                "(h.dhcp_identifier_type = ? AND h.dhcp_identifier = ?) OR "
+                "(h.dhcp_identifier_type = ? AND h.dhcp_identifier = ?) OR "
+                "(h.dhcp_identifier_type = ? AND h.dhcp_identifier = ?) OR "
+                "(h.dhcp_identifier_type = ? AND h.dhcp_identifier = ?) OR "
+                "(h.dhcp_identifier_type = ? AND h.dhcp_identifier = ?)) "
+            "ORDER BY h.host_id, o.option_id, r.reservation_id"},
+
     // Retrieves MySQL schema version.
     {MySqlHostDataSourceImpl::GET_VERSION,
             "SELECT version, minor FROM schema_version"},
@@ -2391,6 +2470,65 @@ getHost(const SubnetID& subnet_id,
     return (result);
 }
 
+ConstHostCollection
+MySqlHostDataSourceImpl::
+getHostsByIdentifiers(const SubnetID& subnet_id,
+                      const HostIdentifierList& identifiers,
+                      StatementIndex stindex,
+                      boost::shared_ptr<MySqlHostExchange> exchange) const {
+    // Empty identifiers can't match any host.
+    std::vector<const HostIdentifier*> ids;
+    for (HostIdentifierList::const_iterator id = identifiers.begin();
+         id != identifiers.end(); ++id) {
+        if (!id->second.empty()) {
+            ids.push_back(&(*id));
+        }
+    }
+
+    ConstHostCollection collection;
+    for (size_t first = 0; first < ids.size();
+         first += MAX_QUERY_IDENTIFIERS) {
+
+        // Set up the WHERE clause value
+        MYSQL_BIND inbind[1 + 2 * MAX_QUERY_IDENTIFIERS];
+        memset(inbind, 0, sizeof(inbind));
+
+        uint32_t subnet_buffer = static_cast<uint32_t>(subnet_id);
+        inbind[0].buffer_type = MYSQL_TYPE_LONG;
+        inbind[0].buffer = reinterpret_cast<char*>(&subnet_buffer);
+        inbind[0].is_unsigned = MLM_TRUE;
+
+        char identifier_type_copy[MAX_QUERY_IDENTIFIERS];
+        std::vector<char> identifier_vec[MAX_QUERY_IDENTIFIERS];
+        unsigned long length[MAX_QUERY_IDENTIFIERS];
+        for (size_t i = 0; i < MAX_QUERY_IDENTIFIERS; ++i) {
+            // The query has a fixed number of conditions. The unused ones
+            // repeat the last identifier.
+            const HostIdentifier& id =
+                *ids[std::min(first + i, ids.size() - 1)];
+
+            // Identifier type.
+            identifier_type_copy[i] = static_cast<char>(id.first);
+            inbind[1 + 2 * i].buffer_type = MYSQL_TYPE_TINY;
+            inbind[1 + 2 * i].buffer =
+                reinterpret_cast<char*>(&identifier_type_copy[i]);
+            inbind[1 + 2 * i].is_unsigned = MLM_TRUE;
+
+            // Identifier value.
+            identifier_vec[i].assign(id.second.begin(), id.second.end());
+            length[i] = identifier_vec[i].size();
+            inbind[2 + 2 * i].buffer_type = MYSQL_TYPE_BLOB;
+            inbind[2 + 2 * i].buffer = &identifier_vec[i][0];
+            inbind[2 + 2 * i].buffer_length = length[i];
+            inbind[2 + 2 * i].length = &length[i];
+        }
+
+        getHostCollection(stindex, inbind, exchange, collection, false);
+    }
+
+    return (BaseHostDataSource::sortByIdentifiers(collection, identifiers));
+}
+
 void
 MySqlHostDataSourceImpl::checkReadOnly() const {
     if (is_readonly_) {
@@ -2667,6 +2805,14 @@ MySqlHostDataSource::get4(const SubnetID& subnet_id,
                    impl_->host_exchange_));
 }
 
+ConstHostCollection
+MySqlHostDataSource::getByIdentifiers4(const SubnetID& subnet_id,
+                                       const HostIdentifierList& identifiers) const {
+    return (impl_->getHostsByIdentifiers(subnet_id, identifiers,
+                MySqlHostDataSourceImpl::GET_HOST_SUBID4_DHCPIDS,
+                impl_->host_exchange_));
+}
+
 ConstHostPtr
 MySqlHostDataSource::get4(const SubnetID& subnet_id,
                           const asiolink::IOAddress& address) const {
@@ -2734,6 +2880,14 @@ MySqlHostDataSource::get6(const SubnetID& subnet_id,
                    impl_->host_ipv6_exchange_));
 }
 
+ConstHostCollection
+MySqlHostDataSource::getByIdentifiers6(const SubnetID& subnet_id,
+                                       const HostIdentifierList& identifiers) const {
+    return (impl_->getHostsByIdentifiers(subnet_id, identifiers,
+                MySqlHostDataSourceImpl::GET_HOST_SUBID6_DHCPIDS,
+                impl_->host_ipv6_exchange_));
+}
+
 ConstHostPtr
 MySqlHostDataSource::get6(const asiolink::IOAddress& prefix,
                           const uint8_t prefix_len) const {
@@ -157,6 +157,20 @@ public:
     virtual ConstHostPtr
     get4(const SubnetID& subnet_id, const asiolink::IOAddress& address) const;
 
+    /// @brief Returns hosts connected to the IPv4 subnet using any of the
+    /// specified identifiers.
+    ///
+    /// The hosts are retrieved using a single query.
+    ///
+    /// @param subnet_id Subnet identifier.
+    /// @param identifiers Identifiers of the client ordered by priority.
+    ///
+    /// @return Collection of const @c Host objects ordered by the priority
+    /// of the identifiers used to find them.
+    virtual ConstHostCollection
+    getByIdentifiers4(const SubnetID& subnet_id,
+                      const HostIdentifierList& identifiers) const;
+
     /// @brief Returns a host connected to the IPv6 subnet.
     ///
     /// Implementations of this method should guard against the case when
@@ -189,6 +203,20 @@ public:
     get6(const SubnetID& subnet_id, const Host::IdentifierType& identifier_type,
          const uint8_t* identifier_begin, const size_t identifier_len) const;
 
+    /// @brief Returns hosts connected to the IPv6 subnet using any of the
+    /// specified identifiers.
+    ///
+    /// The hosts are retrieved using a single query.
+    ///
+    /// @param subnet_id Subnet identifier.
+    /// @param identifiers Identifiers of the client ordered by priority.
+    ///
+    /// @return Collection of const @c Host objects ordered by the priority
+    /// of the identifiers used to find them.
+    virtual ConstHostCollection
+    getByIdentifiers6(const SubnetID& subnet_id,
+                      const HostIdentifierList& identifiers) const;
+
     /// @brief Returns a host using the specified IPv6 prefix.
     ///
     /// @param prefix IPv6 prefix for which the @c Host object is searched.
@@ -12,11 +12,16 @@
 #include <dhcpsrv/dhcpsrv_log.h>
 #include <dhcpsrv/mysql_lease_mgr.h>
 #include <dhcpsrv/mysql_connection.h>
+#include <util/threads/multi_threading_mgr.h>
 
 #include <boost/array.hpp>
+#include <boost/bind.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/static_assert.hpp>
 #include <mysqld_error.h>
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <limits.h>
@@ -84,18 +89,126 @@ const size_t HOSTNAME_MAX_LEN = 255;
 /// colon separators.
 const size_t ADDRESS6_TEXT_MAX_LEN = 39;
 
+/// @brief Maximum number of leases written by one batch statement.
+///
+/// The batch statements for this number of leases are prepared with the
+/// other statements. The last, smaller batch of a bulk operation uses a
+/// statement prepared for its size.
+const size_t MAX_BATCH_LEASES = 64;
+
+/// @brief Creates the text of a batch statement.
+///
+/// @param index Index of the batch statement.
+/// @param leases Number of leases written by the statement.
+///
+/// @return Text of the statement with the placeholders for all leases.
+std::string
+createBatchStatement(const MySqlLeaseMgr::StatementIndex index,
+                     const size_t leases) {
+    std::string text;
+    std::string row;
+    std::string suffix;
+    switch (index) {
+    case MySqlLeaseMgr::DELETE_LEASE4_BATCH:
+        text = "DELETE FROM lease4 WHERE address IN (";
+        row = "?";
+        suffix = ")";
+        break;
+
+    case MySqlLeaseMgr::DELETE_LEASE6_BATCH:
+        text = "DELETE FROM lease6 WHERE address IN (";
+        row = "?";
+        suffix = ")";
+        break;
+
+    case MySqlLeaseMgr::INSERT_LEASE4_BATCH:
+        text = "INSERT INTO lease4(address, hwaddr, client_id, "
+                   "valid_lifetime, expire, subnet_id, "
+                   "fqdn_fwd, fqdn_rev, hostname, state) "
+                       "VALUES ";
+        row = "(?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+        break;
+
+    case MySqlLeaseMgr::INSERT_LEASE6_BATCH:
+        text = "INSERT INTO lease6(address, duid, valid_lifetime, "
+                   "expire, subnet_id, pref_lifetime, "
+                   "lease_type, iaid, prefix_len, "
+                   "fqdn_fwd, fqdn_rev, hostname, "
+                   "hwaddr, hwtype, hwaddr_source, "
+                   "state) "
+                       "VALUES ";
+        row = "(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+        break;
+
+    default:
+        isc_throw(BadValue, "not a batch statement index: " << index);
+    }
+
+    for (size_t i = 0; i < leases; ++i) {
+        if (i > 0) {
+            text += ", ";
+        }
+        text += row;
+    }
+    text += suffix;
+    return (text);
+}
+
+/// @brief Texts of the batch statements prepared in advance.
+///
+/// They must be initialized before the tagged statements which point to
+/// them.
+//@{
+const std::string delete_lease4_batch =
+    createBatchStatement(MySqlLeaseMgr::DELETE_LEASE4_BATCH, MAX_BATCH_LEASES);
+const std::string delete_lease6_batch =
+    createBatchStatement(MySqlLeaseMgr::DELETE_LEASE6_BATCH, MAX_BATCH_LEASES);
+const std::string insert_lease4_batch =
+    createBatchStatement(MySqlLeaseMgr::INSERT_LEASE4_BATCH, MAX_BATCH_LEASES);
+const std::string insert_lease6_batch =
+    createBatchStatement(MySqlLeaseMgr::INSERT_LEASE6_BATCH, MAX_BATCH_LEASES);
+//@}
+
+/// @brief Statement prepared for a single batch.
+///
+/// The statement is closed when the object goes out of scope.
+class MySqlBatchStatement : public boost::noncopyable {
+public:
+    /// @brief Constructor.
+    MySqlBatchStatement() : statement_(NULL) {
+    }
+
+    /// @brief Destructor.
+    ~MySqlBatchStatement() {
+        if (statement_ != NULL) {
+            (void) mysql_stmt_close(statement_);
+        }
+    }
+
+    /// @brief The prepared statement or NULL.
+    MYSQL_STMT* statement_;
+};
+
 boost::array<TaggedStatement, MySqlLeaseMgr::NUM_STATEMENTS>
 tagged_statements = { {
     {MySqlLeaseMgr::DELETE_LEASE4,
                     "DELETE FROM lease4 WHERE address = ?"},
+    {MySqlLeaseMgr::DELETE_LEASE4_BATCH,
+                    delete_lease4_batch.c_str()},
     {MySqlLeaseMgr::DELETE_LEASE4_STATE_EXPIRED,
                     "DELETE FROM lease4 "
                         "WHERE state = ? AND expire < ?"},
+    {MySqlLeaseMgr::DELETE_LEASE4_SUBNET_ID,
+                    "DELETE FROM lease4 WHERE subnet_id = ?"},
     {MySqlLeaseMgr::DELETE_LEASE6,
                     "DELETE FROM lease6 WHERE address = ?"},
+    {MySqlLeaseMgr::DELETE_LEASE6_BATCH,
+                    delete_lease6_batch.c_str()},
     {MySqlLeaseMgr::DELETE_LEASE6_STATE_EXPIRED,
                     "DELETE FROM lease6 "
                         "WHERE state = ? AND expire < ?"},
+    {MySqlLeaseMgr::DELETE_LEASE6_SUBNET_ID,
+                    "DELETE FROM lease6 WHERE subnet_id = ?"},
     {MySqlLeaseMgr::GET_LEASE4_ADDR,
                     "SELECT address, hwaddr, client_id, "
                         "valid_lifetime, expire, subnet_id, "
@@ -186,6 +299,8 @@ tagged_statements = { {
                         "valid_lifetime, expire, subnet_id, "
                         "fqdn_fwd, fqdn_rev, hostname, state) "
                             "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"},
+    {MySqlLeaseMgr::INSERT_LEASE4_BATCH,
+                    insert_lease4_batch.c_str()},
     {MySqlLeaseMgr::INSERT_LEASE6,
                     "INSERT INTO lease6(address, duid, valid_lifetime, "
                         "expire, subnet_id, pref_lifetime, "
@@ -194,6 +309,8 @@ tagged_statements = { {
                         "hwaddr, hwtype, hwaddr_source, "
                         "state) "
                             "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"},
+    {MySqlLeaseMgr::INSERT_LEASE6_BATCH,
+                    insert_lease6_batch.c_str()},
     {MySqlLeaseMgr::UPDATE_LEASE4,
                     "UPDATE lease4 SET address = ?, hwaddr = ?, "
                         "client_id = ?, valid_lifetime = ?, expire = ?, "
@@ -1234,12 +1351,19 @@ class MySqlLeaseStatsQuery : public LeaseStatsQuery {
 public:
     /// @brief Constructor
     ///
-    /// @param conn A open connection to the database housing the lease data
+    /// The context holding the connection is kept out of the pool until
+    /// this object is destroyed, because the rows are fetched using the
+    /// statement of this connection.
+    ///
+    /// @param get_context Context allocation holding an open connection to
+    /// the database housing the lease data
     /// @param statement_index Index of the query's prepared statement
     /// @param fetch_type Indicates if query supplies lease type
-    MySqlLeaseStatsQuery(MySqlConnection& conn, const size_t statement_index,
+    MySqlLeaseStatsQuery(const MySqlLeaseContextAllocPtr& get_context,
+                         const size_t statement_index,
                          const bool fetch_type)
-        : conn_(conn), statement_index_(statement_index), statement_(NULL),
+        : get_context_(get_context), conn_(get_context->ctx_->conn_),
+          statement_index_(statement_index), statement_(NULL),
           fetch_type_(fetch_type),
           // Set the number of columns in the bind array based on fetch_type
           // This is the number of columns expected in the result set
@@ -1250,7 +1374,7 @@ public:
                       " - invalid statement index" << statement_index_);
         }
 
-        statement_ = conn.statements_[statement_index_];
+        statement_ = conn_.statements_[statement_index_];
     }
 
     /// @brief Destructor
@@ -1339,6 +1463,9 @@ public:
     }
 
 private:
+    /// @brief Context allocation holding the connection
+    MySqlLeaseContextAllocPtr get_context_;
+
     /// @brief Database connection to use to execute the query
     MySqlConnection& conn_;
 
@@ -1364,37 +1491,64 @@ private:
     uint32_t state_count_;
 };
 
+// MySqlLeaseContext Constructor and Destructor
+
+MySqlLeaseContext::MySqlLeaseContext(const DatabaseConnection::ParameterMap&
+                                     parameters)
+    : conn_(parameters) {
+}
+
+MySqlLeaseContext::~MySqlLeaseContext() {
+    // The exchange objects are destroyed here, where their type is complete.
+}
+
 // MySqlLeaseMgr Constructor and Destructor
 
 MySqlLeaseMgr::MySqlLeaseMgr(const MySqlConnection::ParameterMap& parameters)
-    : conn_(parameters) {
+    : parameters_(parameters),
+      pool_(boost::bind(&MySqlLeaseMgr::createContext, parameters),
+            MySqlLeaseContextPool::getMaxConnections(parameters),
+            "lease-database") {
+
+    // Open the first connection to verify the parameters.  It is put in
+    // the pool and reused by the subsequent operations.
+    MySqlLeaseContextAlloc get_context(pool_);
+}
+
+
+MySqlLeaseMgr::~MySqlLeaseMgr() {
+    // There is no need to close the databases in this destructor: they are
+    // closed in the destructors of the contexts held in the pool.
+}
+
+MySqlLeaseContextPtr
+MySqlLeaseMgr::createContext(const DatabaseConnection::ParameterMap&
+                             parameters) {
+    MySqlLeaseContextPtr ctx(new MySqlLeaseContext(parameters));
 
     // Open the database.
-    conn_.openDatabase();
+    ctx->conn_.openDatabase();
 
     // Enable autocommit.  To avoid a flush to disk on every commit, the global
     // parameter innodb_flush_log_at_trx_commit should be set to 2.  This will
     // cause the changes to be written to the log, but flushed to disk in the
     // background every second.  Setting the parameter to that value will speed
     // up the system, but at the risk of losing data if the system crashes.
-    my_bool result = mysql_autocommit(conn_.mysql_, 1);
+    my_bool result = mysql_autocommit(ctx->conn_.mysql_, 1);
     if (result != 0) {
-        isc_throw(DbOperationError, mysql_error(conn_.mysql_));
+        isc_throw(DbOperationError, mysql_error(ctx->conn_.mysql_));
     }
 
     // Prepare all statements likely to be used.
-    conn_.prepareStatements(tagged_statements.begin(), tagged_statements.end());
+    ctx->conn_.prepareStatements(tagged_statements.begin(),
+                                 tagged_statements.end());
 
     // Create the exchange objects for use in exchanging data between the
     // program and the database.
-    exchange4_.reset(new MySqlLease4Exchange());
-    exchange6_.reset(new MySqlLease6Exchange());
-}
-
+    ctx->exchange4_.reset(new MySqlLease4Exchange());
+    ctx->exchange6_.reset(new MySqlLease6Exchange());
 
-MySqlLeaseMgr::~MySqlLeaseMgr() {
-    // There is no need to close the database in this destructor: it is
-    // closed in the destructor of the mysql_ member variable.
+    return (ctx);
 }
 
 std::string
@@ -1411,24 +1565,26 @@ MySqlLeaseMgr::getDBVersion() {
 // statement, then call common code to execute the statement.
 
 bool
-MySqlLeaseMgr::addLeaseCommon(StatementIndex stindex,
+MySqlLeaseMgr::addLeaseCommon(MySqlLeaseContextPtr& ctx,
+                              StatementIndex stindex,
                               std::vector<MYSQL_BIND>& bind) {
 
     // Bind the parameters to the statement
-    int status = mysql_stmt_bind_param(conn_.statements_[stindex], &bind[0]);
-    checkError(status, stindex, "unable to bind parameters");
+    int status = mysql_stmt_bind_param(ctx->conn_.statements_[stindex],
+                                       &bind[0]);
+    checkError(ctx, status, stindex, "unable to bind parameters");
 
     // Execute the statement
-    status = mysql_stmt_execute(conn_.statements_[stindex]);
+    status = mysql_stmt_execute(ctx->conn_.statements_[stindex]);
     if (status != 0) {
 
         // Failure: check for the special case of duplicate entry.  If this is
         // the case, we return false to indicate that the row was not added.
         // Otherwise we throw an exception.
-        if (mysql_errno(conn_.mysql_) == ER_DUP_ENTRY) {
+        if (mysql_errno(ctx->conn_.mysql_) == ER_DUP_ENTRY) {
             return (false);
         }
-        checkError(status, stindex, "unable to execute");
+        checkError(ctx, status, stindex, "unable to execute");
     }
 
     // Insert succeeded
@@ -1437,27 +1593,158 @@ MySqlLeaseMgr::addLeaseCommon(StatementIndex stindex,
 
 bool
 MySqlLeaseMgr::addLease(const Lease4Ptr& lease) {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
+    return (addLeaseInternal(ctx, lease));
+}
+
+bool
+MySqlLeaseMgr::addLease(const Lease6Ptr& lease) {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
+    return (addLeaseInternal(ctx, lease));
+}
+
+size_t
+MySqlLeaseMgr::addLeases(const Lease4Collection& leases) {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
+    return (addLeasesCommon<MySqlLease4Exchange>(ctx, INSERT_LEASE4_BATCH,
+                                                 leases));
+}
+
+size_t
+MySqlLeaseMgr::addLeases(const Lease6Collection& leases) {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
+    return (addLeasesCommon<MySqlLease6Exchange>(ctx, INSERT_LEASE6_BATCH,
+                                                 leases));
+}
+
+template <typename Exchange, typename LeaseCollection>
+size_t
+MySqlLeaseMgr::addLeasesCommon(MySqlLeaseContextPtr& ctx,
+                               StatementIndex stindex,
+                               const LeaseCollection& leases) {
+    MySqlTransaction transaction(ctx->conn_);
+    size_t added = 0;
+    for (size_t first = 0; first < leases.size(); first += MAX_BATCH_LEASES) {
+        const size_t count = std::min(MAX_BATCH_LEASES, leases.size() - first);
+        uint64_t affected_rows = 0;
+        if (insertBatch<Exchange>(ctx, stindex, leases, first, count,
+                                  affected_rows)) {
+            added += affected_rows;
+            continue;
+        }
+
+        // The duplicate entry fails the statement but not the transaction.
+        // Add the leases of this batch one by one to skip the existing ones.
+        for (size_t i = first; i < first + count; ++i) {
+            if (addLeaseInternal(ctx, leases[i])) {
+                ++added;
+            }
+        }
+    }
+    transaction.commit();
+    return (added);
+}
+
+template <typename Exchange, typename LeaseCollection>
+bool
+MySqlLeaseMgr::insertBatch(MySqlLeaseContextPtr& ctx, StatementIndex stindex,
+                           const LeaseCollection& leases, const size_t first,
+                           const size_t count, uint64_t& affected_rows) {
+    // The exchange object holds the bound values of a single lease, so
+    // each lease of the batch needs its own.
+    std::vector<boost::shared_ptr<Exchange> > exchanges;
+    std::vector<MYSQL_BIND> bind;
+    for (size_t i = first; i < first + count; ++i) {
+        boost::shared_ptr<Exchange> exchange(new Exchange());
+        exchanges.push_back(exchange);
+        std::vector<MYSQL_BIND> lease_bind =
+            exchange->createBindForSend(leases[i]);
+        bind.insert(bind.end(), lease_bind.begin(), lease_bind.end());
+    }
+
+    return (executeBatch(ctx, stindex, count, bind, affected_rows));
+}
+
+bool
+MySqlLeaseMgr::executeBatch(MySqlLeaseContextPtr& ctx, StatementIndex stindex,
+                            const size_t count, std::vector<MYSQL_BIND>& bind,
+                            uint64_t& affected_rows) {
+    // The statement prepared in advance takes the maximum number of leases.
+    // A smaller batch needs a statement prepared for its size.
+    MYSQL_STMT* statement = ctx->conn_.statements_[stindex];
+    MySqlBatchStatement batch;
+    if (count < MAX_BATCH_LEASES) {
+        batch.statement_ = mysql_stmt_init(ctx->conn_.mysql_);
+        if (batch.statement_ == NULL) {
+            isc_throw(DbOperationError, "unable to allocate MySQL prepared "
+                      "statement structure, reason: "
+                      << mysql_error(ctx->conn_.mysql_));
+        }
+
+        const std::string text = createBatchStatement(stindex, count);
+        int status = mysql_stmt_prepare(batch.statement_, text.c_str(),
+                                        text.size());
+        checkError(ctx, status, stindex, "unable to prepare batch statement");
+        statement = batch.statement_;
+    }
+
+    // Bind the parameters to the statement
+    int status = mysql_stmt_bind_param(statement, &bind[0]);
+    checkError(ctx, status, stindex, "unable to bind parameters");
+
+    // Execute the statement
+    status = mysql_stmt_execute(statement);
+    if (status != 0) {
+        // Failure: check for the special case of duplicate entry.  If this is
+        // the case, we return false to indicate that no row was added.
+        // Otherwise we throw an exception.
+        if (mysql_errno(ctx->conn_.mysql_) == ER_DUP_ENTRY) {
+            return (false);
+        }
+        checkError(ctx, status, stindex, "unable to execute");
+    }
+
+    affected_rows = static_cast<uint64_t>(mysql_stmt_affected_rows(statement));
+    return (true);
+}
+
+bool
+MySqlLeaseMgr::addLeaseInternal(MySqlLeaseContextPtr& ctx,
+                                const Lease4Ptr& lease) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_ADD_ADDR4).arg(lease->addr_.toText());
 
     // Create the MYSQL_BIND array for the lease
-    std::vector<MYSQL_BIND> bind = exchange4_->createBindForSend(lease);
+    std::vector<MYSQL_BIND> bind = ctx->exchange4_->createBindForSend(lease);
 
     // ... and drop to common code.
-    return (addLeaseCommon(INSERT_LEASE4, bind));
+    return (addLeaseCommon(ctx, INSERT_LEASE4, bind));
 }
 
 bool
-MySqlLeaseMgr::addLease(const Lease6Ptr& lease) {
+MySqlLeaseMgr::addLeaseInternal(MySqlLeaseContextPtr& ctx,
+                                const Lease6Ptr& lease) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_ADD_ADDR6).arg(lease->addr_.toText())
               .arg(lease->type_);
 
     // Create the MYSQL_BIND array for the lease
-    std::vector<MYSQL_BIND> bind = exchange6_->createBindForSend(lease);
+    std::vector<MYSQL_BIND> bind = ctx->exchange6_->createBindForSend(lease);
 
     // ... and drop to common code.
-    return (addLeaseCommon(INSERT_LEASE6, bind));
+    return (addLeaseCommon(ctx, INSERT_LEASE6, bind));
 }
 
 // Extraction of leases from the database.
@@ -1486,67 +1773,71 @@ MySqlLeaseMgr::addLease(const Lease6Ptr& lease) {
 // holding zero or one leases into an appropriate Lease object.
 
 template <typename Exchange, typename LeaseCollection>
-void MySqlLeaseMgr::getLeaseCollection(StatementIndex stindex,
+void MySqlLeaseMgr::getLeaseCollection(MySqlLeaseContextPtr& ctx,
+                                       StatementIndex stindex,
                                        MYSQL_BIND* bind,
                                        Exchange& exchange,
                                        LeaseCollection& result,
                                        bool single) const {
 
     // Bind the selection parameters to the statement
-    int status = mysql_stmt_bind_param(conn_.statements_[stindex], bind);
-    checkError(status, stindex, "unable to bind WHERE clause parameter");
+    int status = mysql_stmt_bind_param(ctx->conn_.statements_[stindex], bind);
+    checkError(ctx, status, stindex, "unable to bind WHERE clause parameter");
 
     // Set up the MYSQL_BIND array for the data being returned and bind it to
     // the statement.
     std::vector<MYSQL_BIND> outbind = exchange->createBindForReceive();
-    status = mysql_stmt_bind_result(conn_.statements_[stindex], &outbind[0]);
-    checkError(status, stindex, "unable to bind SELECT clause parameters");
+    status = mysql_stmt_bind_result(ctx->conn_.statements_[stindex],
+                                    &outbind[0]);
+    checkError(ctx, status, stindex, "unable to bind SELECT clause parameters");
 
     // Execute the statement
-    status = mysql_stmt_execute(conn_.statements_[stindex]);
-    checkError(status, stindex, "unable to execute");
+    status = mysql_stmt_execute(ctx->conn_.statements_[stindex]);
+    checkError(ctx, status, stindex, "unable to execute");
 
     // Ensure that all the lease information is retrieved in one go to avoid
     // overhead of going back and forth between client and server.
-    status = mysql_stmt_store_result(conn_.statements_[stindex]);
-    checkError(status, stindex, "unable to set up for storing all results");
+    status = mysql_stmt_store_result(ctx->conn_.statements_[stindex]);
+    checkError(ctx, status, stindex,
+               "unable to set up for storing all results");
 
     // Set up the fetch "release" object to release resources associated
     // with the call to mysql_stmt_fetch when this method exits, then
     // retrieve the data.
-    MySqlFreeResult fetch_release(conn_.statements_[stindex]);
+    MySqlFreeResult fetch_release(ctx->conn_.statements_[stindex]);
     int count = 0;
-    while ((status = mysql_stmt_fetch(conn_.statements_[stindex])) == 0) {
+    while ((status = mysql_stmt_fetch(ctx->conn_.statements_[stindex])) == 0) {
         try {
             result.push_back(exchange->getLeaseData());
 
         } catch (const isc::BadValue& ex) {
             // Rethrow the exception with a bit more data.
             isc_throw(BadValue, ex.what() << ". Statement is <" <<
-                      conn_.text_statements_[stindex] << ">");
+                      ctx->conn_.text_statements_[stindex] << ">");
         }
 
         if (single && (++count > 1)) {
             isc_throw(MultipleRecords, "multiple records were found in the "
                       "database where only one was expected for query "
-                      << conn_.text_statements_[stindex]);
+                      << ctx->conn_.text_statements_[stindex]);
         }
     }
 
     // How did the fetch end?
     if (status == 1) {
         // Error - unable to fetch results
-        checkError(status, stindex, "unable to fetch results");
+        checkError(ctx, status, stindex, "unable to fetch results");
     } else if (status == MYSQL_DATA_TRUNCATED) {
         // Data truncated - throw an exception indicating what was at fault
-        isc_throw(DataTruncated, conn_.text_statements_[stindex]
+        isc_throw(DataTruncated, ctx->conn_.text_statements_[stindex]
                   << " returned truncated data: columns affected are "
                   << exchange->getErrorColumns());
     }
 }
 
 
-void MySqlLeaseMgr::getLease(StatementIndex stindex, MYSQL_BIND* bind,
+void MySqlLeaseMgr::getLease(MySqlLeaseContextPtr& ctx,
+                             StatementIndex stindex, MYSQL_BIND* bind,
                              Lease4Ptr& result) const {
     // Create appropriate collection object and get all leases matching
     // the selection criteria.  The "single" parameter is true to indicate
@@ -1554,7 +1845,7 @@ void MySqlLeaseMgr::getLease(StatementIndex stindex, MYSQL_BIND* bind,
     // matching records are found: this particular method is called when only
     // one or zero matches is expected.
     Lease4Collection collection;
-    getLeaseCollection(stindex, bind, exchange4_, collection, true);
+    getLeaseCollection(ctx, stindex, bind, ctx->exchange4_, collection, true);
 
     // Return single record if present, else clear the lease.
     if (collection.empty()) {
@@ -1565,7 +1856,8 @@ void MySqlLeaseMgr::getLease(StatementIndex stindex, MYSQL_BIND* bind,
 }
 
 
-void MySqlLeaseMgr::getLease(StatementIndex stindex, MYSQL_BIND* bind,
+void MySqlLeaseMgr::getLease(MySqlLeaseContextPtr& ctx,
+                             StatementIndex stindex, MYSQL_BIND* bind,
                              Lease6Ptr& result) const {
     // Create appropriate collection object and get all leases matching
     // the selection criteria.  The "single" parameter is true to indicate
@@ -1573,7 +1865,7 @@ void MySqlLeaseMgr::getLease(StatementIndex stindex, MYSQL_BIND* bind,
     // matching records are found: this particular method is called when only
     // one or zero matches is expected.
     Lease6Collection collection;
-    getLeaseCollection(stindex, bind, exchange6_, collection, true);
+    getLeaseCollection(ctx, stindex, bind, ctx->exchange6_, collection, true);
 
     // Return single record if present, else clear the lease.
     if (collection.empty()) {
@@ -1589,6 +1881,10 @@ void MySqlLeaseMgr::getLease(StatementIndex stindex, MYSQL_BIND* bind,
 
 Lease4Ptr
 MySqlLeaseMgr::getLease4(const isc::asiolink::IOAddress& addr) const {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_GET_ADDR4).arg(addr.toText());
 
@@ -1603,7 +1899,7 @@ MySqlLeaseMgr::getLease4(const isc::asiolink::IOAddress& addr) const {
 
     // Get the data
     Lease4Ptr result;
-    getLease(GET_LEASE4_ADDR, inbind, result);
+    getLease(ctx, GET_LEASE4_ADDR, inbind, result);
 
     return (result);
 }
@@ -1611,6 +1907,10 @@ MySqlLeaseMgr::getLease4(const isc::asiolink::IOAddress& addr) const {
 
 Lease4Collection
 MySqlLeaseMgr::getLease4(const HWAddr& hwaddr) const {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_GET_HWADDR).arg(hwaddr.toText());
 
@@ -1633,7 +1933,7 @@ MySqlLeaseMgr::getLease4(const HWAddr& hwaddr) const {
 
     // Get the data
     Lease4Collection result;
-    getLeaseCollection(GET_LEASE4_HWADDR, inbind, result);
+    getLeaseCollection(ctx, GET_LEASE4_HWADDR, inbind, result);
 
     return (result);
 }
@@ -1641,6 +1941,10 @@ MySqlLeaseMgr::getLease4(const HWAddr& hwaddr) const {
 
 Lease4Ptr
 MySqlLeaseMgr::getLease4(const HWAddr& hwaddr, SubnetID subnet_id) const {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_GET_SUBID_HWADDR)
         .arg(subnet_id).arg(hwaddr.toText());
@@ -1668,7 +1972,7 @@ MySqlLeaseMgr::getLease4(const HWAddr& hwaddr, SubnetID subnet_id) const {
 
     // Get the data
     Lease4Ptr result;
-    getLease(GET_LEASE4_HWADDR_SUBID, inbind, result);
+    getLease(ctx, GET_LEASE4_HWADDR_SUBID, inbind, result);
 
     return (result);
 }
@@ -1676,6 +1980,10 @@ MySqlLeaseMgr::getLease4(const HWAddr& hwaddr, SubnetID subnet_id) const {
 
 Lease4Collection
 MySqlLeaseMgr::getLease4(const ClientId& clientid) const {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_GET_CLIENTID).arg(clientid.toText());
 
@@ -1692,7 +2000,7 @@ MySqlLeaseMgr::getLease4(const ClientId& clientid) const {
 
     // Get the data
     Lease4Collection result;
-    getLeaseCollection(GET_LEASE4_CLIENTID, inbind, result);
+    getLeaseCollection(ctx, GET_LEASE4_CLIENTID, inbind, result);
 
     return (result);
 }
@@ -1709,6 +2017,10 @@ MySqlLeaseMgr::getLease4(const ClientId&, const HWAddr&, SubnetID) const {
 
 Lease4Ptr
 MySqlLeaseMgr::getLease4(const ClientId& clientid, SubnetID subnet_id) const {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_GET_SUBID_CLIENTID)
               .arg(subnet_id).arg(clientid.toText());
@@ -1730,7 +2042,7 @@ MySqlLeaseMgr::getLease4(const ClientId& clientid, SubnetID subnet_id) const {
 
     // Get the data
     Lease4Ptr result;
-    getLease(GET_LEASE4_CLIENTID_SUBID, inbind, result);
+    getLease(ctx, GET_LEASE4_CLIENTID_SUBID, inbind, result);
 
     return (result);
 }
@@ -1739,6 +2051,10 @@ MySqlLeaseMgr::getLease4(const ClientId& clientid, SubnetID subnet_id) const {
 Lease6Ptr
 MySqlLeaseMgr::getLease6(Lease::Type lease_type,
                          const isc::asiolink::IOAddress& addr) const {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_GET_ADDR6).arg(addr.toText())
               .arg(lease_type);
@@ -1763,7 +2079,7 @@ MySqlLeaseMgr::getLease6(Lease::Type lease_type,
     inbind[1].is_unsigned = MLM_TRUE;
 
     Lease6Ptr result;
-    getLease(GET_LEASE6_ADDR, inbind, result);
+    getLease(ctx, GET_LEASE6_ADDR, inbind, result);
 
     return (result);
 }
@@ -1772,6 +2088,10 @@ MySqlLeaseMgr::getLease6(Lease::Type lease_type,
 Lease6Collection
 MySqlLeaseMgr::getLeases6(Lease::Type lease_type,
                           const DUID& duid, uint32_t iaid) const {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_GET_IAID_DUID).arg(iaid).arg(duid.toText())
               .arg(lease_type);
@@ -1812,7 +2132,7 @@ MySqlLeaseMgr::getLeases6(Lease::Type lease_type,
 
     // ... and get the data
     Lease6Collection result;
-    getLeaseCollection(GET_LEASE6_DUID_IAID, inbind, result);
+    getLeaseCollection(ctx, GET_LEASE6_DUID_IAID, inbind, result);
 
     return (result);
 }
@@ -1821,6 +2141,10 @@ Lease6Collection
 MySqlLeaseMgr::getLeases6(Lease::Type lease_type,
                           const DUID& duid, uint32_t iaid,
                           SubnetID subnet_id) const {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_GET_IAID_SUBID_DUID)
               .arg(iaid).arg(subnet_id).arg(duid.toText())
@@ -1857,7 +2181,7 @@ MySqlLeaseMgr::getLeases6(Lease::Type lease_type,
 
     // ... and get the data
     Lease6Collection result;
-    getLeaseCollection(GET_LEASE6_DUID_IAID_SUBID, inbind, result);
+    getLeaseCollection(ctx, GET_LEASE6_DUID_IAID_SUBID, inbind, result);
 
     return (result);
 }
@@ -1865,22 +2189,31 @@ MySqlLeaseMgr::getLeases6(Lease::Type lease_type,
 void
 MySqlLeaseMgr::getExpiredLeases6(Lease6Collection& expired_leases,
                                  const size_t max_leases) const {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_GET_EXPIRED6)
         .arg(max_leases);
-    getExpiredLeasesCommon(expired_leases, max_leases, GET_LEASE6_EXPIRE);
+    getExpiredLeasesCommon(ctx, expired_leases, max_leases, GET_LEASE6_EXPIRE);
 }
 
 void
 MySqlLeaseMgr::getExpiredLeases4(Lease4Collection& expired_leases,
                                  const size_t max_leases) const {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_GET_EXPIRED4)
         .arg(max_leases);
-    getExpiredLeasesCommon(expired_leases, max_leases, GET_LEASE4_EXPIRE);
+    getExpiredLeasesCommon(ctx, expired_leases, max_leases, GET_LEASE4_EXPIRE);
 }
 
 template<typename LeaseCollection>
 void
-MySqlLeaseMgr::getExpiredLeasesCommon(LeaseCollection& expired_leases,
+MySqlLeaseMgr::getExpiredLeasesCommon(MySqlLeaseContextPtr& ctx,
+                                      LeaseCollection& expired_leases,
                                       const size_t max_leases,
                                       StatementIndex statement_index) const {
     // Set up the WHERE clause value
@@ -1895,7 +2228,7 @@ MySqlLeaseMgr::getExpiredLeasesCommon(LeaseCollection& expired_leases,
 
     // Expiration timestamp.
     MYSQL_TIME expire_time;
-    conn_.convertToDatabaseTime(time(NULL), expire_time);
+    ctx->conn_.convertToDatabaseTime(time(NULL), expire_time);
     inbind[1].buffer_type = MYSQL_TYPE_TIMESTAMP;
     inbind[1].buffer = reinterpret_cast<char*>(&expire_time);
     inbind[1].buffer_length = sizeof(expire_time);
@@ -1909,7 +2242,7 @@ MySqlLeaseMgr::getExpiredLeasesCommon(LeaseCollection& expired_leases,
     inbind[2].is_unsigned = MLM_TRUE;
 
     // Get the data
-    getLeaseCollection(statement_index, inbind, expired_leases);
+    getLeaseCollection(ctx, statement_index, inbind, expired_leases);
 }
 
 
@@ -1920,20 +2253,22 @@ MySqlLeaseMgr::getExpiredLeasesCommon(LeaseCollection& expired_leases,
 
 template <typename LeasePtr>
 void
-MySqlLeaseMgr::updateLeaseCommon(StatementIndex stindex, MYSQL_BIND* bind,
+MySqlLeaseMgr::updateLeaseCommon(MySqlLeaseContextPtr& ctx,
+                                 StatementIndex stindex, MYSQL_BIND* bind,
                                  const LeasePtr& lease) {
 
     // Bind the parameters to the statement
-    int status = mysql_stmt_bind_param(conn_.statements_[stindex], bind);
-    checkError(status, stindex, "unable to bind parameters");
+    int status = mysql_stmt_bind_param(ctx->conn_.statements_[stindex], bind);
+    checkError(ctx, status, stindex, "unable to bind parameters");
 
     // Execute
-    status = mysql_stmt_execute(conn_.statements_[stindex]);
-    checkError(status, stindex, "unable to execute");
+    status = mysql_stmt_execute(ctx->conn_.statements_[stindex]);
+    checkError(ctx, status, stindex, "unable to execute");
 
     // See how many rows were affected.  The statement should only update a
     // single row.
-    int affected_rows = mysql_stmt_affected_rows(conn_.statements_[stindex]);
+    int affected_rows =
+        mysql_stmt_affected_rows(ctx->conn_.statements_[stindex]);
     if (affected_rows == 0) {
         isc_throw(NoSuchLease, "unable to update lease for address " <<
                   lease->addr_ << " as it does not exist");
@@ -1948,13 +2283,85 @@ MySqlLeaseMgr::updateLeaseCommon(StatementIndex stindex, MYSQL_BIND* bind,
 
 void
 MySqlLeaseMgr::updateLease4(const Lease4Ptr& lease) {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
+    updateLease4Internal(ctx, lease);
+}
+
+void
+MySqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
+    updateLease6Internal(ctx, lease);
+}
+
+void
+MySqlLeaseMgr::updateLeases4(const Lease4Collection& leases) {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
+    updateLeasesCommon<MySqlLease4Exchange>(ctx, DELETE_LEASE4_BATCH,
+                                            INSERT_LEASE4_BATCH, leases);
+}
+
+void
+MySqlLeaseMgr::updateLeases6(const Lease6Collection& leases) {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
+    updateLeasesCommon<MySqlLease6Exchange>(ctx, DELETE_LEASE6_BATCH,
+                                            INSERT_LEASE6_BATCH, leases);
+}
+
+template <typename Exchange, typename LeaseCollection>
+void
+MySqlLeaseMgr::updateLeasesCommon(MySqlLeaseContextPtr& ctx,
+                                  StatementIndex delete_index,
+                                  StatementIndex insert_index,
+                                  const LeaseCollection& leases) {
+    // MySQL has no multi-row UPDATE, so each batch of leases is deleted
+    // and inserted again. The transaction is rolled back when any of the
+    // leases doesn't exist.
+    MySqlTransaction transaction(ctx->conn_);
+    for (size_t first = 0; first < leases.size(); first += MAX_BATCH_LEASES) {
+        const size_t count = std::min(MAX_BATCH_LEASES, leases.size() - first);
+        std::vector<isc::asiolink::IOAddress> addrs;
+        for (size_t i = first; i < first + count; ++i) {
+            addrs.push_back(leases[i]->addr_);
+        }
+
+        uint64_t deleted = deleteLeasesCommon(ctx, delete_index, addrs);
+        if (deleted < count) {
+            isc_throw(NoSuchLease, "unable to update " << (count - deleted)
+                      << " of " << count << " leases as they do not exist");
+        }
+
+        uint64_t affected_rows = 0;
+        if (!insertBatch<Exchange>(ctx, insert_index, leases, first, count,
+                                   affected_rows)) {
+            isc_throw(DbOperationError, "unable to update the leases as "
+                      "some of them have the same address");
+        }
+    }
+    transaction.commit();
+}
+
+void
+MySqlLeaseMgr::updateLease4Internal(MySqlLeaseContextPtr& ctx,
+                                    const Lease4Ptr& lease) {
     const StatementIndex stindex = UPDATE_LEASE4;
 
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_UPDATE_ADDR4).arg(lease->addr_.toText());
 
     // Create the MYSQL_BIND array for the data being updated
-    std::vector<MYSQL_BIND> bind = exchange4_->createBindForSend(lease);
+    std::vector<MYSQL_BIND> bind = ctx->exchange4_->createBindForSend(lease);
 
     // Set up the WHERE clause and append it to the MYSQL_BIND array
     MYSQL_BIND where;
@@ -1967,12 +2374,13 @@ MySqlLeaseMgr::updateLease4(const Lease4Ptr& lease) {
     bind.push_back(where);
 
     // Drop to common update code
-    updateLeaseCommon(stindex, &bind[0], lease);
+    updateLeaseCommon(ctx, stindex, &bind[0], lease);
 }
 
 
 void
-MySqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
+MySqlLeaseMgr::updateLease6Internal(MySqlLeaseContextPtr& ctx,
+                                    const Lease6Ptr& lease) {
     const StatementIndex stindex = UPDATE_LEASE6;
 
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
@@ -1980,7 +2388,7 @@ MySqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
               .arg(lease->type_);
 
     // Create the MYSQL_BIND array for the data being updated
-    std::vector<MYSQL_BIND> bind = exchange6_->createBindForSend(lease);
+    std::vector<MYSQL_BIND> bind = ctx->exchange6_->createBindForSend(lease);
 
     // Set up the WHERE clause value
     MYSQL_BIND where;
@@ -1998,7 +2406,7 @@ MySqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
     bind.push_back(where);
 
     // Drop to common update code
-    updateLeaseCommon(stindex, &bind[0], lease);
+    updateLeaseCommon(ctx, stindex, &bind[0], lease);
 }
 
 // Delete lease methods.  Similar to other groups of methods, these comprise
@@ -2007,23 +2415,106 @@ MySqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
 // handles the common processing.
 
 uint64_t
-MySqlLeaseMgr::deleteLeaseCommon(StatementIndex stindex, MYSQL_BIND* bind) {
+MySqlLeaseMgr::deleteLeaseCommon(MySqlLeaseContextPtr& ctx,
+                                 StatementIndex stindex, MYSQL_BIND* bind) {
 
     // Bind the input parameters to the statement
-    int status = mysql_stmt_bind_param(conn_.statements_[stindex], bind);
-    checkError(status, stindex, "unable to bind WHERE clause parameter");
+    int status = mysql_stmt_bind_param(ctx->conn_.statements_[stindex], bind);
+    checkError(ctx, status, stindex, "unable to bind WHERE clause parameter");
 
     // Execute
-    status = mysql_stmt_execute(conn_.statements_[stindex]);
-    checkError(status, stindex, "unable to execute");
+    status = mysql_stmt_execute(ctx->conn_.statements_[stindex]);
+    checkError(ctx, status, stindex, "unable to execute");
 
     // See how many rows were affected.  Note that the statement may delete
     // multiple rows.
-    return (static_cast<uint64_t>(mysql_stmt_affected_rows(conn_.statements_[stindex])));
+    return (static_cast<uint64_t>(mysql_stmt_affected_rows(ctx->conn_.statements_[stindex])));
 }
 
 bool
 MySqlLeaseMgr::deleteLease(const isc::asiolink::IOAddress& addr) {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
+    return (deleteLeaseInternal(ctx, addr));
+}
+
+size_t
+MySqlLeaseMgr::deleteLeases(const std::vector<isc::asiolink::IOAddress>& addrs) {
+    // Each batch statement deletes the leases of one address family.
+    std::vector<isc::asiolink::IOAddress> addrs4;
+    std::vector<isc::asiolink::IOAddress> addrs6;
+    for (auto addr = addrs.begin(); addr != addrs.end(); ++addr) {
+        if (addr->isV4()) {
+            addrs4.push_back(*addr);
+        } else {
+            addrs6.push_back(*addr);
+        }
+    }
+
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
+    MySqlTransaction transaction(ctx->conn_);
+    uint64_t deleted = deleteLeasesCommon(ctx, DELETE_LEASE4_BATCH, addrs4);
+    deleted += deleteLeasesCommon(ctx, DELETE_LEASE6_BATCH, addrs6);
+    transaction.commit();
+    return (deleted);
+}
+
+uint64_t
+MySqlLeaseMgr::deleteLeasesCommon(MySqlLeaseContextPtr& ctx,
+                                  StatementIndex stindex,
+                                  const std::vector<isc::asiolink::IOAddress>& addrs) {
+    uint64_t deleted = 0;
+    for (size_t first = 0; first < addrs.size(); first += MAX_BATCH_LEASES) {
+        const size_t count = std::min(MAX_BATCH_LEASES, addrs.size() - first);
+
+        // Set up the WHERE clause values. The vectors are not resized
+        // after binding, so the bound buffers remain valid.
+        std::vector<uint32_t> addrs4(count);
+        std::vector<std::string> addrs6(count);
+        std::vector<unsigned long> addrs6_length(count);
+        std::vector<MYSQL_BIND> inbind(count);
+        memset(&inbind[0], 0, count * sizeof(MYSQL_BIND));
+
+        for (size_t i = 0; i < count; ++i) {
+            const isc::asiolink::IOAddress& addr = addrs[first + i];
+            LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+                      DHCPSRV_MYSQL_DELETE_ADDR).arg(addr.toText());
+
+            if (addr.isV4()) {
+                addrs4[i] = addr.toUint32();
+                inbind[i].buffer_type = MYSQL_TYPE_LONG;
+                inbind[i].buffer = reinterpret_cast<char*>(&addrs4[i]);
+                inbind[i].is_unsigned = MLM_TRUE;
+
+            } else {
+                addrs6[i] = addr.toText();
+                addrs6_length[i] = addrs6[i].size();
+
+                // See the earlier description of the use of "const_cast"
+                // when accessing the address for an explanation of the
+                // reason.
+                inbind[i].buffer_type = MYSQL_TYPE_STRING;
+                inbind[i].buffer = const_cast<char*>(addrs6[i].c_str());
+                inbind[i].buffer_length = addrs6_length[i];
+                inbind[i].length = &addrs6_length[i];
+            }
+        }
+
+        uint64_t affected_rows = 0;
+        executeBatch(ctx, stindex, count, inbind, affected_rows);
+        deleted += affected_rows;
+    }
+    return (deleted);
+}
+
+bool
+MySqlLeaseMgr::deleteLeaseInternal(MySqlLeaseContextPtr& ctx,
+                                   const isc::asiolink::IOAddress& addr) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_DELETE_ADDR).arg(addr.toText());
 
@@ -2038,7 +2529,7 @@ MySqlLeaseMgr::deleteLease(const isc::asiolink::IOAddress& addr) {
         inbind[0].buffer = reinterpret_cast<char*>(&addr4);
         inbind[0].is_unsigned = MLM_TRUE;
 
-        return (deleteLeaseCommon(DELETE_LEASE4, inbind) > 0);
+        return (deleteLeaseCommon(ctx, DELETE_LEASE4, inbind) > 0);
 
     } else {
         std::string addr6 = addr.toText();
@@ -2051,28 +2542,39 @@ MySqlLeaseMgr::deleteLease(const isc::asiolink::IOAddress& addr) {
         inbind[0].buffer_length = addr6_length;
         inbind[0].length = &addr6_length;
 
-        return (deleteLeaseCommon(DELETE_LEASE6, inbind) > 0);
+        return (deleteLeaseCommon(ctx, DELETE_LEASE6, inbind) > 0);
     }
 }
 
 uint64_t
 MySqlLeaseMgr::deleteExpiredReclaimedLeases4(const uint32_t secs) {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_DELETE_EXPIRED_RECLAIMED4)
         .arg(secs);
-    return (deleteExpiredReclaimedLeasesCommon(secs, DELETE_LEASE4_STATE_EXPIRED));
+    return (deleteExpiredReclaimedLeasesCommon(ctx, secs,
+                                               DELETE_LEASE4_STATE_EXPIRED));
 }
 
 uint64_t
 MySqlLeaseMgr::deleteExpiredReclaimedLeases6(const uint32_t secs) {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_DELETE_EXPIRED_RECLAIMED6)
         .arg(secs);
-    return (deleteExpiredReclaimedLeasesCommon(secs, DELETE_LEASE6_STATE_EXPIRED));
+    return (deleteExpiredReclaimedLeasesCommon(ctx, secs,
+                                               DELETE_LEASE6_STATE_EXPIRED));
 }
 
 uint64_t
-MySqlLeaseMgr::deleteExpiredReclaimedLeasesCommon(const uint32_t secs,
+MySqlLeaseMgr::deleteExpiredReclaimedLeasesCommon(MySqlLeaseContextPtr& ctx,
+                                                  const uint32_t secs,
                                                   StatementIndex statement_index) {
     // Set up the WHERE clause value
     MYSQL_BIND inbind[2];
@@ -2086,13 +2588,14 @@ MySqlLeaseMgr::deleteExpiredReclaimedLeasesCommon(const uint32_t secs,
 
     // Expiration timestamp.
     MYSQL_TIME expire_time;
-    conn_.convertToDatabaseTime(time(NULL) - static_cast<time_t>(secs), expire_time);
+    ctx->conn_.convertToDatabaseTime(time(NULL) - static_cast<time_t>(secs),
+                                     expire_time);
     inbind[1].buffer_type = MYSQL_TYPE_TIMESTAMP;
     inbind[1].buffer = reinterpret_cast<char*>(&expire_time);
     inbind[1].buffer_length = sizeof(expire_time);
 
     // Get the number of deleted leases and log it.
-    uint64_t deleted_leases = deleteLeaseCommon(statement_index, inbind);
+    uint64_t deleted_leases = deleteLeaseCommon(ctx, statement_index, inbind);
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_MYSQL_DELETED_EXPIRED_RECLAIMED)
         .arg(deleted_leases);
@@ -2101,13 +2604,47 @@ MySqlLeaseMgr::deleteExpiredReclaimedLeasesCommon(const uint32_t secs,
 }
 
 size_t
-MySqlLeaseMgr::wipeLeases4(const SubnetID& /*subnet_id*/) {
-    isc_throw(NotImplemented, "wipeLeases4 is not implemented for MySQL backend");
+MySqlLeaseMgr::wipeLeases4(const SubnetID& subnet_id) {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
+    LOG_INFO(dhcpsrv_logger, DHCPSRV_MYSQL_WIPE_LEASES4)
+        .arg(subnet_id);
+    uint64_t num = wipeLeasesCommon(ctx, subnet_id, DELETE_LEASE4_SUBNET_ID);
+    LOG_INFO(dhcpsrv_logger, DHCPSRV_MYSQL_WIPE_LEASES4_FINISHED)
+        .arg(subnet_id).arg(num);
+    return (num);
 }
 
 size_t
-MySqlLeaseMgr::wipeLeases6(const SubnetID& /*subnet_id*/) {
-    isc_throw(NotImplemented, "wipeLeases6 is not implemented for MySQL backend");
+MySqlLeaseMgr::wipeLeases6(const SubnetID& subnet_id) {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
+    LOG_INFO(dhcpsrv_logger, DHCPSRV_MYSQL_WIPE_LEASES6)
+        .arg(subnet_id);
+    uint64_t num = wipeLeasesCommon(ctx, subnet_id, DELETE_LEASE6_SUBNET_ID);
+    LOG_INFO(dhcpsrv_logger, DHCPSRV_MYSQL_WIPE_LEASES6_FINISHED)
+        .arg(subnet_id).arg(num);
+    return (num);
+}
+
+uint64_t
+MySqlLeaseMgr::wipeLeasesCommon(MySqlLeaseContextPtr& ctx,
+                                const SubnetID& subnet_id,
+                                StatementIndex statement_index) {
+    // Set up the WHERE clause value
+    MYSQL_BIND inbind[1];
+    memset(inbind, 0, sizeof(inbind));
+
+    uint32_t subnet = static_cast<uint32_t>(subnet_id);
+    inbind[0].buffer_type = MYSQL_TYPE_LONG;
+    inbind[0].buffer = reinterpret_cast<char*>(&subnet);
+    inbind[0].is_unsigned = MLM_TRUE;
+
+    return (deleteLeaseCommon(ctx, statement_index, inbind));
 }
 
 // Miscellaneous database methods.
@@ -2115,10 +2652,10 @@ MySqlLeaseMgr::wipeLeases6(const SubnetID& /*subnet_id*/) {
 std::string
 MySqlLeaseMgr::getName() const {
     std::string name = "";
-    try {
-        name = conn_.getParameter("name");
-    } catch (...) {
-        // Return an empty name
+    DatabaseConnection::ParameterMap::const_iterator param =
+        parameters_.find("name");
+    if (param != parameters_.end()) {
+        name = param->second;
     }
     return (name);
 }
@@ -2132,6 +2669,10 @@ MySqlLeaseMgr::getDescription() const {
 
 std::pair<uint32_t, uint32_t>
 MySqlLeaseMgr::getVersion() const {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
     const StatementIndex stindex = GET_VERSION;
 
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
@@ -2141,11 +2682,11 @@ MySqlLeaseMgr::getVersion() const {
     uint32_t    minor;      // Minor version number
 
     // Execute the prepared statement
-    int status = mysql_stmt_execute(conn_.statements_[stindex]);
+    int status = mysql_stmt_execute(ctx->conn_.statements_[stindex]);
     if (status != 0) {
         isc_throw(DbOperationError, "unable to execute <"
-                  << conn_.text_statements_[stindex] << "> - reason: " <<
-                  mysql_error(conn_.mysql_));
+                  << ctx->conn_.text_statements_[stindex] << "> - reason: " <<
+                  mysql_error(ctx->conn_.mysql_));
     }
 
     // Bind the output of the statement to the appropriate variables.
@@ -2162,19 +2703,19 @@ MySqlLeaseMgr::getVersion() const {
     bind[1].buffer = &minor;
     bind[1].buffer_length = sizeof(minor);
 
-    status = mysql_stmt_bind_result(conn_.statements_[stindex], bind);
+    status = mysql_stmt_bind_result(ctx->conn_.statements_[stindex], bind);
     if (status != 0) {
         isc_throw(DbOperationError, "unable to bind result set: " <<
-                  mysql_error(conn_.mysql_));
+                  mysql_error(ctx->conn_.mysql_));
     }
 
     // Fetch the data and set up the "release" object to release associated
     // resources when this method exits then retrieve the data.
-    MySqlFreeResult fetch_release(conn_.statements_[stindex]);
-    status = mysql_stmt_fetch(conn_.statements_[stindex]);
+    MySqlFreeResult fetch_release(ctx->conn_.statements_[stindex]);
+    status = mysql_stmt_fetch(ctx->conn_.statements_[stindex]);
     if (status != 0) {
         isc_throw(DbOperationError, "unable to obtain result set: " <<
-                  mysql_error(conn_.mysql_));
+                  mysql_error(ctx->conn_.mysql_));
     }
 
     return (std::make_pair(major, minor));
@@ -2182,7 +2723,10 @@ MySqlLeaseMgr::getVersion() const {
 
 LeaseStatsQueryPtr
 MySqlLeaseMgr::startLeaseStatsQuery4() {
-    LeaseStatsQueryPtr query(new MySqlLeaseStatsQuery(conn_,
+    // Get a context which is released by the query object
+    MySqlLeaseContextAllocPtr get_context(new MySqlLeaseContextAlloc(pool_));
+
+    LeaseStatsQueryPtr query(new MySqlLeaseStatsQuery(get_context,
                                                       RECOUNT_LEASE4_STATS,
                                                       false));
     query->start();
@@ -2191,7 +2735,10 @@ MySqlLeaseMgr::startLeaseStatsQuery4() {
 
 LeaseStatsQueryPtr
 MySqlLeaseMgr::startLeaseStatsQuery6() {
-    LeaseStatsQueryPtr query(new MySqlLeaseStatsQuery(conn_,
+    // Get a context which is released by the query object
+    MySqlLeaseContextAllocPtr get_context(new MySqlLeaseContextAlloc(pool_));
+
+    LeaseStatsQueryPtr query(new MySqlLeaseStatsQuery(get_context,
                                                       RECOUNT_LEASE6_STATS,
                                                       true));
     query->start();
@@ -2200,25 +2747,36 @@ MySqlLeaseMgr::startLeaseStatsQuery6() {
 
 void
 MySqlLeaseMgr::commit() {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_COMMIT);
-    if (mysql_commit(conn_.mysql_) != 0) {
-        isc_throw(DbOperationError, "commit failed: " << mysql_error(conn_.mysql_));
+    if (mysql_commit(ctx->conn_.mysql_) != 0) {
+        isc_throw(DbOperationError, "commit failed: "
+                  << mysql_error(ctx->conn_.mysql_));
     }
 }
 
 
 void
 MySqlLeaseMgr::rollback() {
+    // Get a context
+    MySqlLeaseContextAlloc get_context(pool_);
+    MySqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_MYSQL_ROLLBACK);
-    if (mysql_rollback(conn_.mysql_) != 0) {
-        isc_throw(DbOperationError, "rollback failed: " << mysql_error(conn_.mysql_));
+    if (mysql_rollback(ctx->conn_.mysql_) != 0) {
+        isc_throw(DbOperationError, "rollback failed: "
+                  << mysql_error(ctx->conn_.mysql_));
     }
 }
 
 void
-MySqlLeaseMgr::checkError(int status, StatementIndex index,
-                           const char* what) const {
-    conn_.checkError(status, index, what);
+MySqlLeaseMgr::checkError(MySqlLeaseContextPtr& ctx,
+                          int status, StatementIndex index,
+                          const char* what) const {
+    ctx->conn_.checkError(status, index, what);
 }
 
 }; // end of isc::dhcp namespace
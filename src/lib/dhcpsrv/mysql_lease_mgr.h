@@ -8,10 +8,12 @@
 #define MYSQL_LEASE_MGR_H
 
 #include <dhcp/hwaddr.h>
+#include <dhcpsrv/database_context_pool.h>
 #include <dhcpsrv/lease_mgr.h>
 #include <dhcpsrv/mysql_connection.h>
 
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/utility.hpp>
 #include <mysql.h>
 
@@ -25,6 +27,48 @@ namespace dhcp {
 class MySqlLease4Exchange;
 class MySqlLease6Exchange;
 
+/// @brief MySQL Lease Context
+///
+/// This class holds the connection to the database, its prepared statements
+/// and the exchange objects. They can only be used by one thread at a time,
+/// so the lease manager keeps a pool of the contexts and each operation
+/// takes one context from the pool.
+class MySqlLeaseContext : public boost::noncopyable {
+public:
+
+    /// @brief Constructor
+    ///
+    /// The connection is not opened by the constructor.
+    ///
+    /// @param parameters See MySqlLeaseMgr constructor.
+    MySqlLeaseContext(const DatabaseConnection::ParameterMap& parameters);
+
+    /// @brief Destructor
+    ~MySqlLeaseContext();
+
+    /// The exchange objects are used for transfer of data to/from the database.
+    /// They are pointed-to objects as the contents may change in "const" calls,
+    /// while the rest of this object does not.  (At alternative would be to
+    /// declare them as "mutable".)
+    boost::scoped_ptr<MySqlLease4Exchange> exchange4_; ///< Exchange object
+    boost::scoped_ptr<MySqlLease6Exchange> exchange6_; ///< Exchange object
+
+    /// @brief MySQL connection
+    MySqlConnection conn_;
+};
+
+/// @brief Type of pointers to contexts.
+typedef boost::shared_ptr<MySqlLeaseContext> MySqlLeaseContextPtr;
+
+/// @brief Type of the pool of contexts.
+typedef DatabaseContextPool<MySqlLeaseContext> MySqlLeaseContextPool;
+
+/// @brief Type of the object taking a context from the pool.
+typedef MySqlLeaseContextPool::ContextAlloc MySqlLeaseContextAlloc;
+
+/// @brief Type of pointers to the objects taking contexts from the pool.
+typedef MySqlLeaseContextPool::ContextAllocPtr MySqlLeaseContextAllocPtr;
+
 /// @brief MySQL Lease Manager
 ///
 /// This class provides the \ref isc::dhcp::LeaseMgr interface to the MySQL
@@ -42,6 +86,9 @@ public:
     /// - host - Host to which to connect (optional, defaults to "localhost")
     /// - user - Username under which to connect (optional)
     /// - password - Password for "user" on the database (optional)
+    /// - max-connections - Maximum number of connections opened by the
+    ///   lease manager (optional, defaults to the number of processors
+    ///   plus one)
     ///
     /// If the database is successfully opened, the version number in the
     /// schema_version table will be checked against hard-coded value in
@@ -86,6 +133,34 @@ public:
     ///        failed.
     virtual bool addLease(const Lease6Ptr& lease);
 
+    /// @brief Adds multiple IPv4 leases
+    ///
+    /// The leases are added within a single transaction with multi-row
+    /// INSERT statements. The leases which can't be added because a lease
+    /// with the same address already exists are skipped.
+    ///
+    /// @param leases Collection of leases to be added.
+    ///
+    /// @return Number of leases added.
+    ///
+    /// @throw isc::dhcp::DbOperationError An operation on the open database has
+    ///        failed. None of the leases is added in this case.
+    virtual size_t addLeases(const Lease4Collection& leases);
+
+    /// @brief Adds multiple IPv6 leases
+    ///
+    /// The leases are added within a single transaction with multi-row
+    /// INSERT statements. The leases which can't be added because a lease
+    /// with the same address already exists are skipped.
+    ///
+    /// @param leases Collection of leases to be added.
+    ///
+    /// @return Number of leases added.
+    ///
+    /// @throw isc::dhcp::DbOperationError An operation on the open database has
+    ///        failed. None of the leases is added in this case.
+    virtual size_t addLeases(const Lease6Collection& leases);
+
     /// @brief Returns an IPv4 lease for specified IPv4 address
     ///
     /// This method return a lease that is associated with a given address.
@@ -320,6 +395,49 @@ public:
     ///        failed.
     virtual bool deleteLease(const isc::asiolink::IOAddress& addr);
 
+    /// @brief Updates multiple IPv4 leases.
+    ///
+    /// The leases are updated within a single transaction. MySQL has no
+    /// multi-row UPDATE, so the leases are deleted and inserted again
+    /// with multi-row statements.
+    ///
+    /// @param leases Collection of leases to be updated.
+    ///
+    /// @throw isc::dhcp::NoSuchLease Attempt to update a lease that did not
+    ///        exist. None of the leases is updated in this case.
+    /// @throw isc::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    virtual void updateLeases4(const Lease4Collection& leases);
+
+    /// @brief Updates multiple IPv6 leases.
+    ///
+    /// The leases are updated within a single transaction. MySQL has no
+    /// multi-row UPDATE, so the leases are deleted and inserted again
+    /// with multi-row statements.
+    ///
+    /// @param leases Collection of leases to be updated.
+    ///
+    /// @throw isc::dhcp::NoSuchLease Attempt to update a lease that did not
+    ///        exist. None of the leases is updated in this case.
+    /// @throw isc::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    virtual void updateLeases6(const Lease6Collection& leases);
+
+    /// @brief Deletes multiple leases.
+    ///
+    /// The leases are deleted within a single transaction with multi-row
+    /// DELETE statements.
+    ///
+    /// @param addrs Addresses of the leases to be deleted.  These can be IPv4
+    ///              or IPv6 addresses.
+    ///
+    /// @return Number of leases deleted.
+    ///
+    /// @throw isc::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    virtual size_t
+    deleteLeases(const std::vector<isc::asiolink::IOAddress>& addrs);
+
     /// @brief Deletes all expired-reclaimed DHCPv4 leases.
     ///
     /// @param secs Number of seconds since expiration of leases before
@@ -332,9 +450,7 @@ public:
     /// @brief Removes specified IPv4 leases.
     ///
     /// This rather dangerous method is able to remove all leases from specified
-    /// subnet.
-    ///
-    /// @todo: Not implemented yet.
+    /// subnet. The leases are removed with a single statement.
     ///
     /// @param subnet_id identifier of the subnet
     /// @return number of leases removed.
@@ -343,9 +459,7 @@ public:
     /// @brief Removed specified IPv6 leases.
     ///
     /// This rather dangerous method is able to remove all leases from specified
-    /// subnet.
-    ///
-    /// @todo: Not implemented yet.
+    /// subnet. The leases are removed with a single statement.
     ///
     /// @param subnet_id identifier of the subnet
     /// @return number of leases removed.
@@ -413,9 +527,13 @@ public:
     /// The contents of the enum are indexes into the list of SQL statements
     enum StatementIndex {
         DELETE_LEASE4,               // Delete from lease4 by address
+        DELETE_LEASE4_BATCH,         // Delete from lease4 by addresses
         DELETE_LEASE4_STATE_EXPIRED, // Delete expired lease4 in a given state
+        DELETE_LEASE4_SUBNET_ID,     // Delete lease4 by subnet ID
         DELETE_LEASE6,               // Delete from lease6 by address
+        DELETE_LEASE6_BATCH,         // Delete from lease6 by addresses
         DELETE_LEASE6_STATE_EXPIRED, // Delete expired lease6 in a given state
+        DELETE_LEASE6_SUBNET_ID,     // Delete lease6 by subnet ID
         GET_LEASE4_ADDR,             // Get lease4 by address
         GET_LEASE4_CLIENTID,         // Get lease4 by client ID
         GET_LEASE4_CLIENTID_SUBID,   // Get lease4 by client ID & subnet ID
@@ -428,7 +546,9 @@ public:
         GET_LEASE6_EXPIRE,           // Get lease6 by expiration.
         GET_VERSION,                 // Obtain version number
         INSERT_LEASE4,               // Add entry to lease4 table
+        INSERT_LEASE4_BATCH,         // Add entries to lease4 table
         INSERT_LEASE6,               // Add entry to lease6 table
+        INSERT_LEASE6_BATCH,         // Add entries to lease6 table
         UPDATE_LEASE4,               // Update a Lease4 entry
         UPDATE_LEASE6,               // Update a Lease6 entry
         RECOUNT_LEASE4_STATS,        // Fetches IPv4 address statistics
@@ -443,6 +563,7 @@ private:
     /// of the addLease method.  It binds the contents of the lease object to
     /// the prepared statement and adds it to the database.
     ///
+    /// @param ctx Context taken from the pool
     /// @param stindex Index of statement being executed
     /// @param bind MYSQL_BIND array that has been created for the type
     ///        of lease in question.
@@ -452,13 +573,89 @@ private:
     ///
     /// @throw isc::dhcp::DbOperationError An operation on the open database has
     ///        failed.
-    bool addLeaseCommon(StatementIndex stindex, std::vector<MYSQL_BIND>& bind);
+    bool addLeaseCommon(MySqlLeaseContextPtr& ctx, StatementIndex stindex,
+                        std::vector<MYSQL_BIND>& bind);
+
+    /// @brief Adds an IPv4 lease using the specified context.
+    ///
+    /// @param ctx Context taken from the pool
+    /// @param lease lease to be added
+    ///
+    /// @return true if the lease was added, false if a lease with the same
+    ///         address already exists in the database.
+    bool addLeaseInternal(MySqlLeaseContextPtr& ctx, const Lease4Ptr& lease);
+
+    /// @brief Adds an IPv6 lease using the specified context.
+    ///
+    /// @param ctx Context taken from the pool
+    /// @param lease lease to be added
+    ///
+    /// @return true if the lease was added, false if a lease with the same
+    ///         address already exists in the database.
+    bool addLeaseInternal(MySqlLeaseContextPtr& ctx, const Lease6Ptr& lease);
+
+    /// @brief Add multiple leases common code
+    ///
+    /// Adds the leases within a single transaction in batches. If a batch
+    /// fails on the duplicate entry, its leases are added one by one.
+    ///
+    /// @param ctx Context taken from the pool
+    /// @param stindex Index of the batch insert statement
+    /// @param leases Collection of leases to be added.
+    ///
+    /// @tparam Exchange Exchange class of the lease type.
+    /// @tparam LeaseCollection A @c Lease4Collection or @c Lease6Collection.
+    ///
+    /// @return Number of leases added.
+    template <typename Exchange, typename LeaseCollection>
+    size_t addLeasesCommon(MySqlLeaseContextPtr& ctx, StatementIndex stindex,
+                           const LeaseCollection& leases);
+
+    /// @brief Inserts a batch of leases with a single statement.
+    ///
+    /// @param ctx Context taken from the pool
+    /// @param stindex Index of the batch insert statement
+    /// @param leases Collection of leases.
+    /// @param first Index of the first lease of the batch.
+    /// @param count Number of leases in the batch.
+    /// @param [out] affected_rows Number of leases inserted.
+    ///
+    /// @tparam Exchange Exchange class of the lease type.
+    /// @tparam LeaseCollection A @c Lease4Collection or @c Lease6Collection.
+    ///
+    /// @return false if the statement failed on the duplicate entry,
+    ///         true otherwise.
+    template <typename Exchange, typename LeaseCollection>
+    bool insertBatch(MySqlLeaseContextPtr& ctx, StatementIndex stindex,
+                     const LeaseCollection& leases, const size_t first,
+                     const size_t count, uint64_t& affected_rows);
+
+    /// @brief Executes a batch statement.
+    ///
+    /// The statement prepared in advance is used for the full batch. The
+    /// statement for a smaller batch is prepared and closed here.
+    ///
+    /// @param ctx Context taken from the pool
+    /// @param stindex Index of the batch statement
+    /// @param count Number of leases in the batch.
+    /// @param bind MYSQL_BIND array holding the parameters of all leases.
+    /// @param [out] affected_rows Number of rows affected by the statement.
+    ///
+    /// @return false if the statement failed on the duplicate entry,
+    ///         true otherwise.
+    ///
+    /// @throw isc::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    bool executeBatch(MySqlLeaseContextPtr& ctx, StatementIndex stindex,
+                      const size_t count, std::vector<MYSQL_BIND>& bind,
+                      uint64_t& affected_rows);
 
     /// @brief Get Lease Collection Common Code
     ///
     /// This method performs the common actions for obtaining multiple leases
     /// from the database.
     ///
+    /// @param ctx Context taken from the pool
     /// @param stindex Index of statement being executed
     /// @param bind MYSQL_BIND array for input parameters
     /// @param exchange Exchange object to use
@@ -475,7 +672,8 @@ private:
     /// @throw isc::dhcp::MultipleRecords Multiple records were retrieved
     ///        from the database where only one was expected.
     template <typename Exchange, typename LeaseCollection>
-    void getLeaseCollection(StatementIndex stindex, MYSQL_BIND* bind,
+    void getLeaseCollection(MySqlLeaseContextPtr& ctx,
+                            StatementIndex stindex, MYSQL_BIND* bind,
                             Exchange& exchange, LeaseCollection& result,
                             bool single = false) const;
 
@@ -484,6 +682,7 @@ private:
     /// Gets a collection of Lease4 objects.  This is just an interface to
     /// the get lease collection common code.
     ///
+    /// @param ctx Context taken from the pool
     /// @param stindex Index of statement being executed
     /// @param bind MYSQL_BIND array for input parameters
     /// @param lease LeaseCollection object returned.  Note that any leases in
@@ -495,9 +694,10 @@ private:
     ///        failed.
     /// @throw isc::dhcp::MultipleRecords Multiple records were retrieved
     ///        from the database where only one was expected.
-    void getLeaseCollection(StatementIndex stindex, MYSQL_BIND* bind,
+    void getLeaseCollection(MySqlLeaseContextPtr& ctx,
+                            StatementIndex stindex, MYSQL_BIND* bind,
                             Lease4Collection& result) const {
-        getLeaseCollection(stindex, bind, exchange4_, result);
+        getLeaseCollection(ctx, stindex, bind, ctx->exchange4_, result);
     }
 
     /// @brief Get Lease Collection
@@ -505,6 +705,7 @@ private:
     /// Gets a collection of Lease6 objects.  This is just an interface to
     /// the get lease collection common code.
     ///
+    /// @param ctx Context taken from the pool
     /// @param stindex Index of statement being executed
     /// @param bind MYSQL_BIND array for input parameters
     /// @param lease LeaseCollection object returned.  Note that any existing
@@ -515,9 +716,10 @@ private:
     ///        failed.
     /// @throw isc::dhcp::MultipleRecords Multiple records were retrieved
     ///        from the database where only one was expected.
-    void getLeaseCollection(StatementIndex stindex, MYSQL_BIND* bind,
+    void getLeaseCollection(MySqlLeaseContextPtr& ctx,
+                            StatementIndex stindex, MYSQL_BIND* bind,
                             Lease6Collection& result) const {
-        getLeaseCollection(stindex, bind, exchange6_, result);
+        getLeaseCollection(ctx, stindex, bind, ctx->exchange6_, result);
     }
 
     /// @brief Get Lease4 Common Code
@@ -526,10 +728,12 @@ private:
     /// methods.  It acts as an interface to the getLeaseCollection() method,
     /// but retrieving only a single lease.
     ///
+    /// @param ctx Context taken from the pool
     /// @param stindex Index of statement being executed
     /// @param bind MYSQL_BIND array for input parameters
     /// @param lease Lease4 object returned
-    void getLease(StatementIndex stindex, MYSQL_BIND* bind,
+    void getLease(MySqlLeaseContextPtr& ctx,
+                  StatementIndex stindex, MYSQL_BIND* bind,
                   Lease4Ptr& result) const;
 
     /// @brief Get Lease6 Common Code
@@ -538,11 +742,13 @@ private:
     /// methods.  It acts as an interface to the getLeaseCollection() method,
     /// but retrieving only a single lease.
     ///
+    /// @param ctx Context taken from the pool
     /// @param stindex Index of statement being executed
     /// @param bind MYSQL_BIND array for input parameters
     /// @param lease Lease6 object returned
-    void getLease(StatementIndex stindex, MYSQL_BIND* bind,
-                   Lease6Ptr& result) const;
+    void getLease(MySqlLeaseContextPtr& ctx,
+                  StatementIndex stindex, MYSQL_BIND* bind,
+                  Lease6Ptr& result) const;
 
 
     /// @brief Get expired leases common code.
@@ -552,6 +758,7 @@ private:
     /// time. The maximum number of leases to be returned is specified
     /// as an argument.
     ///
+    /// @param ctx Context taken from the pool
     /// @param [out] expired_leases Reference to the container where the
     ///        retrieved leases are put.
     /// @param max_leases Maximum number of leases to be returned.
@@ -560,7 +767,8 @@ private:
     ///
     /// @tparam One of the @c Lease4Collection or @c Lease6Collection.
     template<typename LeaseCollection>
-    void getExpiredLeasesCommon(LeaseCollection& expired_leases,
+    void getExpiredLeasesCommon(MySqlLeaseContextPtr& ctx,
+                                LeaseCollection& expired_leases,
                                 const size_t max_leases,
                                 StatementIndex statement_index) const;
 
@@ -570,6 +778,7 @@ private:
     /// to the prepared statement, executes it, then checks how many rows
     /// were affected.
     ///
+    /// @param ctx Context taken from the pool
     /// @param stindex Index of prepared statement to be executed
     /// @param bind Array of MYSQL_BIND objects representing the parameters.
     ///        (Note that the number is determined by the number of parameters
@@ -581,15 +790,54 @@ private:
     /// @throw isc::dhcp::DbOperationError An operation on the open database has
     ///        failed.
     template <typename LeasePtr>
-    void updateLeaseCommon(StatementIndex stindex, MYSQL_BIND* bind,
+    void updateLeaseCommon(MySqlLeaseContextPtr& ctx,
+                           StatementIndex stindex, MYSQL_BIND* bind,
                            const LeasePtr& lease);
 
+    /// @brief Updates an IPv4 lease using the specified context.
+    ///
+    /// @param ctx Context taken from the pool
+    /// @param lease The lease to be updated.
+    void updateLease4Internal(MySqlLeaseContextPtr& ctx,
+                              const Lease4Ptr& lease);
+
+    /// @brief Updates an IPv6 lease using the specified context.
+    ///
+    /// @param ctx Context taken from the pool
+    /// @param lease The lease to be updated.
+    void updateLease6Internal(MySqlLeaseContextPtr& ctx,
+                              const Lease6Ptr& lease);
+
+    /// @brief Update multiple leases common code
+    ///
+    /// Deletes each batch of leases and inserts it again within a single
+    /// transaction.
+    ///
+    /// @param ctx Context taken from the pool
+    /// @param delete_index Index of the batch delete statement
+    /// @param insert_index Index of the batch insert statement
+    /// @param leases Collection of leases to be updated.
+    ///
+    /// @tparam Exchange Exchange class of the lease type.
+    /// @tparam LeaseCollection A @c Lease4Collection or @c Lease6Collection.
+    ///
+    /// @throw isc::dhcp::NoSuchLease Some of the leases don't exist. None
+    ///        of the leases is updated in this case.
+    /// @throw isc::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    template <typename Exchange, typename LeaseCollection>
+    void updateLeasesCommon(MySqlLeaseContextPtr& ctx,
+                            StatementIndex delete_index,
+                            StatementIndex insert_index,
+                            const LeaseCollection& leases);
+
     /// @brief Delete lease common code
     ///
     /// Holds the common code for deleting a lease.  It binds the parameters
     /// to the prepared statement, executes the statement and checks to
     /// see how many rows were deleted.
     ///
+    /// @param ctx Context taken from the pool
     /// @param stindex Index of prepared statement to be executed
     /// @param bind Array of MYSQL_BIND objects representing the parameters.
     ///        (Note that the number is determined by the number of parameters
@@ -599,10 +847,45 @@ private:
     ///
     /// @throw isc::dhcp::DbOperationError An operation on the open database has
     ///        failed.
-    uint64_t deleteLeaseCommon(StatementIndex stindex, MYSQL_BIND* bind);
+    uint64_t deleteLeaseCommon(MySqlLeaseContextPtr& ctx,
+                               StatementIndex stindex, MYSQL_BIND* bind);
+
+    /// @brief Deletes a lease using the specified context.
+    ///
+    /// @param ctx Context taken from the pool
+    /// @param addr Address of the lease to be deleted.
+    ///
+    /// @return true if deletion was successful, false if no such lease exists
+    bool deleteLeaseInternal(MySqlLeaseContextPtr& ctx,
+                             const isc::asiolink::IOAddress& addr);
+
+    /// @brief Deletes the leases of one address family in batches.
+    ///
+    /// @param ctx Context taken from the pool
+    /// @param stindex One of the @c DELETE_LEASE4_BATCH or
+    ///        @c DELETE_LEASE6_BATCH.
+    /// @param addrs Addresses of the leases to be deleted.
+    ///
+    /// @return Number of leases deleted.
+    uint64_t deleteLeasesCommon(MySqlLeaseContextPtr& ctx,
+                                StatementIndex stindex,
+                                const std::vector<isc::asiolink::IOAddress>& addrs);
+
+    /// @brief Deletes the leases belonging to the subnet.
+    ///
+    /// @param ctx Context taken from the pool
+    /// @param subnet_id Identifier of the subnet.
+    /// @param statement_index One of the @c DELETE_LEASE4_SUBNET_ID or
+    ///        @c DELETE_LEASE6_SUBNET_ID.
+    ///
+    /// @return Number of leases deleted.
+    uint64_t wipeLeasesCommon(MySqlLeaseContextPtr& ctx,
+                              const SubnetID& subnet_id,
+                              StatementIndex statement_index);
 
     /// @brief Delete expired-reclaimed leases.
     ///
+    /// @param ctx Context taken from the pool
     /// @param secs Number of seconds since expiration of leases before
     /// they can be removed. Leases which have expired later than this
     /// time will not be deleted.
@@ -610,7 +893,8 @@ private:
     ///        @c DELETE_LEASE6_STATE_EXPIRED.
     ///
     /// @return Number of leases deleted.
-    uint64_t deleteExpiredReclaimedLeasesCommon(const uint32_t secs,
+    uint64_t deleteExpiredReclaimedLeasesCommon(MySqlLeaseContextPtr& ctx,
+                                                const uint32_t secs,
                                                 StatementIndex statement_index);
 
     /// @brief Creates and runs the IPv4 lease stats query
@@ -637,26 +921,39 @@ private:
     ///
     /// This method invokes @ref MySqlConnection::checkError.
     ///
+    /// @param ctx Context taken from the pool
     /// @param status Status code: non-zero implies an error
     /// @param index Index of statement that caused the error
     /// @param what High-level description of the error
     ///
     /// @throw isc::dhcp::DbOperationError An operation on the open database has
     ///        failed.
-    void checkError(int status, StatementIndex index,
-                    const char* what) const;
+    void checkError(MySqlLeaseContextPtr& ctx, int status,
+                    StatementIndex index, const char* what) const;
+
+    /// @brief Creates a new context.
+    ///
+    /// Opens the connection to the database, enables autocommit, prepares
+    /// the statements and creates the exchange objects.
+    ///
+    /// @param parameters See MySqlLeaseMgr constructor.
+    ///
+    /// @return Pointer to the new context.
+    /// @throw isc::dhcp::DbOpenError Error opening the database
+    /// @throw isc::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    static MySqlLeaseContextPtr
+    createContext(const DatabaseConnection::ParameterMap& parameters);
 
     // Members
 
-    /// The exchange objects are used for transfer of data to/from the database.
-    /// They are pointed-to objects as the contents may change in "const" calls,
-    /// while the rest of this object does not.  (At alternative would be to
-    /// declare them as "mutable".)
-    boost::scoped_ptr<MySqlLease4Exchange> exchange4_; ///< Exchange object
-    boost::scoped_ptr<MySqlLease6Exchange> exchange6_; ///< Exchange object
+    /// @brief Database access parameters
+    DatabaseConnection::ParameterMap parameters_;
 
-    /// @brief MySQL connection
-    MySqlConnection conn_;
+    /// @brief Pool of contexts.
+    ///
+    /// It is mutable because contexts are taken from it in "const" calls.
+    mutable MySqlLeaseContextPool pool_;
 };
 
 }; // end of isc::dhcp namespace
@@ -54,6 +54,12 @@ DbAccessParser::parse(CfgDbAccessPtr& cfg_db,
     std::map<string, string> values_copy = values_;
 
     int64_t lfc_interval = 0;
+    int64_t load_threads = 0;
+    int64_t commit_interval = 0;
+    int64_t commit_batch_size = 1;
+    int64_t max_connections = 0;
+    int64_t cache_size = 0;
+    int64_t cache_ttl = 0;
     int64_t timeout = 0;
     int64_t port = 0;
     // 2. Update the copy with the passed keywords.
@@ -68,6 +74,36 @@ DbAccessParser::parse(CfgDbAccessPtr& cfg_db,
                 values_copy[param.first] =
                     boost::lexical_cast<std::string>(lfc_interval);
 
+            } else if (param.first == "load-threads") {
+                load_threads = param.second->intValue();
+                values_copy[param.first] =
+                    boost::lexical_cast<std::string>(load_threads);
+
+            } else if (param.first == "commit-interval") {
+                commit_interval = param.second->intValue();
+                values_copy[param.first] =
+                    boost::lexical_cast<std::string>(commit_interval);
+
+            } else if (param.first == "commit-batch-size") {
+                commit_batch_size = param.second->intValue();
+                values_copy[param.first] =
+                    boost::lexical_cast<std::string>(commit_batch_size);
+
+            } else if (param.first == "max-connections") {
+                max_connections = param.second->intValue();
+                values_copy[param.first] =
+                    boost::lexical_cast<std::string>(max_connections);
+
+            } else if (param.first == "cache-size") {
+                cache_size = param.second->intValue();
+                values_copy[param.first] =
+                    boost::lexical_cast<std::string>(cache_size);
+
+            } else if (param.first == "cache-ttl") {
+                cache_ttl = param.second->intValue();
+                values_copy[param.first] =
+                    boost::lexical_cast<std::string>(cache_ttl);
+
             } else if (param.first == "connect-timeout") {
                 timeout = param.second->intValue();
                 values_copy[param.first] =
@@ -124,7 +160,17 @@ DbAccessParser::parse(CfgDbAccessPtr& cfg_db,
                   << " (" << value->getPosition() << ")");
     }
 
-    // d. Check that the timeout is within a reasonable range.
+    // d. Check that the load-threads is within a reasonable range.
+    if ((load_threads < 0) ||
+        (load_threads > std::numeric_limits<uint16_t>::max())) {
+        ConstElementPtr value = database_config->get("load-threads");
+        isc_throw(DhcpConfigError, "load-threads value: " << load_threads
+                  << " is out of range, expected value: 0.."
+                  << std::numeric_limits<uint16_t>::max()
+                  << " (" << value->getPosition() << ")");
+    }
+
+    // e. Check that the timeout is within a reasonable range.
     if ((timeout < 0) ||
         (timeout > std::numeric_limits<uint32_t>::max())) {
         ConstElementPtr value = database_config->get("connect-timeout");
@@ -134,7 +180,7 @@ DbAccessParser::parse(CfgDbAccessPtr& cfg_db,
                   << " (" << value->getPosition() << ")");
     }
 
-    // e. Check that the port is within a reasonable range.
+    // f. Check that the port is within a reasonable range.
     if ((port < 0) ||
         (port > std::numeric_limits<uint16_t>::max())) {
         ConstElementPtr value = database_config->get("port");
@@ -144,6 +190,90 @@ DbAccessParser::parse(CfgDbAccessPtr& cfg_db,
                   << " (" << value->getPosition() << ")");
     }
 
+    // g. Check that the lease-file-format is one of the supported formats.
+    ConstElementPtr lease_file_format = database_config->get("lease-file-format");
+    if (lease_file_format &&
+        (values_copy["lease-file-format"] != "csv") &&
+        (values_copy["lease-file-format"] != "binary")) {
+        isc_throw(DhcpConfigError, "lease-file-format value: "
+                  << values_copy["lease-file-format"] << " is invalid,"
+                  " expected value: csv or binary ("
+                  << lease_file_format->getPosition() << ")");
+    }
+
+    // h. Check that the persist-mode is one of the supported modes.
+    ConstElementPtr persist_mode = database_config->get("persist-mode");
+    if (persist_mode &&
+        (values_copy["persist-mode"] != "async") &&
+        (values_copy["persist-mode"] != "sync") &&
+        (values_copy["persist-mode"] != "group")) {
+        isc_throw(DhcpConfigError, "persist-mode value: "
+                  << values_copy["persist-mode"] << " is invalid,"
+                  " expected value: async, sync or group ("
+                  << persist_mode->getPosition() << ")");
+    }
+
+    // i. Check that the commit-interval is within a reasonable range.
+    if ((commit_interval < 0) ||
+        (commit_interval > std::numeric_limits<uint32_t>::max())) {
+        ConstElementPtr value = database_config->get("commit-interval");
+        isc_throw(DhcpConfigError, "commit-interval value: " << commit_interval
+                  << " is out of range, expected value: 0.."
+                  << std::numeric_limits<uint32_t>::max()
+                  << " (" << value->getPosition() << ")");
+    }
+
+    // j. Check that the commit-batch-size is within a reasonable range.
+    if ((commit_batch_size < 1) ||
+        (commit_batch_size > std::numeric_limits<uint32_t>::max())) {
+        ConstElementPtr value = database_config->get("commit-batch-size");
+        isc_throw(DhcpConfigError, "commit-batch-size value: "
+                  << commit_batch_size << " is out of range, expected value: 1.."
+                  << std::numeric_limits<uint32_t>::max()
+                  << " (" << value->getPosition() << ")");
+    }
+
+    // k. Check that the lfc-mode is one of the supported modes.
+    ConstElementPtr lfc_mode = database_config->get("lfc-mode");
+    if (lfc_mode &&
+        (values_copy["lfc-mode"] != "external") &&
+        (values_copy["lfc-mode"] != "internal")) {
+        isc_throw(DhcpConfigError, "lfc-mode value: "
+                  << values_copy["lfc-mode"] << " is invalid,"
+                  " expected value: external or internal ("
+                  << lfc_mode->getPosition() << ")");
+    }
+
+    // l. Check that the max-connections is within a reasonable range.
+    if ((max_connections < 0) ||
+        (max_connections > std::numeric_limits<uint16_t>::max())) {
+        ConstElementPtr value = database_config->get("max-connections");
+        isc_throw(DhcpConfigError, "max-connections value: " << max_connections
+                  << " is out of range, expected value: 0.."
+                  << std::numeric_limits<uint16_t>::max()
+                  << " (" << value->getPosition() << ")");
+    }
+
+    // m. Check that the cache-size is within a reasonable range.
+    if ((cache_size < 0) ||
+        (cache_size > std::numeric_limits<uint32_t>::max())) {
+        ConstElementPtr value = database_config->get("cache-size");
+        isc_throw(DhcpConfigError, "cache-size value: " << cache_size
+                  << " is out of range, expected value: 0.."
+                  << std::numeric_limits<uint32_t>::max()
+                  << " (" << value->getPosition() << ")");
+    }
+
+    // n. Check that the cache-ttl is within a reasonable range.
+    if ((cache_ttl < 0) ||
+        (cache_ttl > std::numeric_limits<uint32_t>::max())) {
+        ConstElementPtr value = database_config->get("cache-ttl");
+        isc_throw(DhcpConfigError, "cache-ttl value: " << cache_ttl
+                  << " is out of range, expected value: 0.."
+                  << std::numeric_limits<uint32_t>::max()
+                  << " (" << value->getPosition() << ")");
+    }
+
     // 4. If all is OK, update the stored keyword/value pairs.  We do this by
     // swapping contents - values_copy is destroyed immediately after the
     // operation (when the method exits), so we are not interested in its new
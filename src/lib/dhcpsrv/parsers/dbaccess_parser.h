@@ -56,6 +56,12 @@ public:
     ///
     /// - "type" is "memfile", "mysql" or "postgresql"
     /// - "lfc-interval" is a number from the range of 0 to 4294967295.
+    /// - "load-threads" is a number from the range of 0 to 65535.
+    /// - "lease-file-format" is "csv" or "binary".
+    /// - "persist-mode" is "async", "sync" or "group".
+    /// - "commit-interval" is a number from the range of 0 to 4294967295.
+    /// - "commit-batch-size" is a number from the range of 1 to 4294967295.
+    /// - "lfc-mode" is "external" or "internal".
     /// - "connect-timeout" is a number from the range of 0 to 4294967295.
     /// - "port" is a number from the range of 0 to 65535.
     ///
@@ -509,6 +509,16 @@ SubnetConfigParser::createSubnet(ConstElementPtr params) {
         subnet_->setContext(user_context);
     }
 
+    // The allocator is optional. If not specified, the default allocator
+    // of the allocation engine is used.
+    if (params->contains("allocator")) {
+        try {
+            subnet_->setAllocatorType(getString(params, "allocator"));
+        } catch (const BadValue& ex) {
+            isc_throw(DhcpConfigError, ex.what() << " ("
+                      << getPosition("allocator", params) << ")");
+        }
+    }
 }
 
 //****************************** Subnet4ConfigParser *************************
@@ -24,6 +24,7 @@
 #include <boost/pointer_cast.hpp>
 #include <boost/static_assert.hpp>
 
+#include <algorithm>
 #include <stdint.h>
 #include <string>
 
@@ -1173,6 +1174,8 @@ public:
         GET_HOST_SUBID_ADDR,    // Gets host by IPv4 SubnetID and IPv4 address
         GET_HOST_PREFIX,        // Gets host by IPv6 prefix
         GET_HOST_SUBID6_ADDR,   // Gets host by IPv6 SubnetID and IPv6 prefix
+        GET_HOST_SUBID4_DHCPIDS,// Gets hosts by IPv4 SubnetID, any identifier
+        GET_HOST_SUBID6_DHCPIDS,// Gets hosts by IPv6 SubnetID, any identifier
         GET_VERSION,            // Obtain version number
         INSERT_HOST,            // Insert new host to collection
         INSERT_V6_RESRV,        // Insert v6 reservation
@@ -1191,6 +1194,14 @@ public:
     /// such as INSERT, DELETE, UPDATE.
     static const StatementIndex WRITE_STMTS_BEGIN = INSERT_HOST;
 
+    /// @brief Number of identifiers used by the queries retrieving hosts
+    /// by any of the identifiers.
+    ///
+    /// It must be equal to the number of the identifier conditions in the
+    /// statements. It is equal to the number of identifier types, so all
+    /// identifiers configured for the server are used in a single query.
+    static const size_t MAX_QUERY_IDENTIFIERS = 5;
+
     /// @brief Constructor.
     ///
     /// This constructor opens database connection and initializes prepared
@@ -1302,6 +1313,26 @@ public:
                          StatementIndex stindex,
                          boost::shared_ptr<PgSqlHostExchange> exchange) const;
 
+    /// @brief Retrieves hosts by subnet and any of client's identifiers.
+    ///
+    /// This method is used by both PgSqlHostDataSource::getByIdentifiers4
+    /// and PgSqlHostDataSource::getByIdentifiers6 methods. Up to
+    /// @c MAX_QUERY_IDENTIFIERS identifiers are used in a single query.
+    ///
+    /// @param subnet_id Subnet identifier.
+    /// @param identifiers Identifiers of the client ordered by priority.
+    /// @param stindex Statement index.
+    /// @param exchange Pointer to the exchange object used for the
+    /// particular query.
+    ///
+    /// @return Collection of hosts ordered by the priority of the
+    /// identifiers.
+    ConstHostCollection
+    getHostsByIdentifiers(const SubnetID& subnet_id,
+                          const HostIdentifierList& identifiers,
+                          StatementIndex stindex,
+                          boost::shared_ptr<PgSqlHostExchange> exchange) const;
+
     /// @brief Throws exception if database is read only.
     ///
     /// This method should be called by the methods which write to the
@@ -1516,6 +1547,59 @@ TaggedStatementArray tagged_statements = { {
      "ORDER BY h.host_id, o.option_id, r.reservation_id"
     },
 
+    // PgSqlHostDataSourceImpl::GET_HOST_SUBID4_DHCPIDS
+    // Retrieves host information and DHCPv4 options using subnet identifier
+    // and any of client's identifiers. The number of the identifiers is
+    // MAX_QUERY_IDENTIFIERS. Left joining the dhcp4_options table results
+    // in multiple rows being returned for the same host.
+    {11,
+     { OID_INT4, OID_INT2, OID_BYTEA, OID_INT2, OID_BYTEA, OID_INT2, OID_BYTEA,
+       OID_INT2, OID_BYTEA, OID_INT2, OID_BYTEA },
+     "get_host_subid4_dhcpids",
+     "SELECT h.host_id, h.dhcp_identifier, h.dhcp_identifier_type, "
+     "  h.dhcp4_subnet_id, h.dhcp6_subnet_id, h.ipv4_address, h.hostname, "
+     "  h.dhcp4_client_classes, h.dhcp6_client_classes, "
+     "  h.dhcp4_next_server, h.dhcp4_server_hostname, h.dhcp4_boot_file_name, "
+     "  o.option_id, o.code, o.value, o.formatted_value, o.space, o.persistent "
+     "FROM hosts AS h "
+     "LEFT JOIN dhcp4_options AS o ON h.host_id = o.host_id "
+     "WHERE h.dhcp4_subnet_id = $1 AND ("
+     "  (h.dhcp_identifier_type = $2 AND h.dhcp_identifier = $3) OR "
+     "  (h.dhcp_identifier_type = $4 AND h.dhcp_identifier = $5) OR "
+     "  (h.dhcp_identifier_type = $6 AND h.dhcp_identifier = $7) OR "
+     "  (h.dhcp_identifier_type = $8 AND h.dhcp_identifier = $9) OR "
+     "  (h.dhcp_identifier_type = $10 AND h.dhcp_identifier = $11)) "
+     "ORDER BY h.host_id, o.option_id"
+    },
+
+    // PgSqlHostDataSourceImpl::GET_HOST_SUBID6_DHCPIDS
+    // Retrieves host information, IPv6 reservations and DHCPv6 options
+    // using subnet identifier and any of client's identifiers. The number
+    // of the identifiers is MAX_QUERY_IDENTIFIERS.
+    {11,
+     { OID_INT4, OID_INT2, OID_BYTEA, OID_INT2, OID_BYTEA, OID_INT2, OID_BYTEA,
+       OID_INT2, OID_BYTEA, OID_INT2, OID_BYTEA },
+     "get_host_subid6_dhcpids",
+     "SELECT h.host_id, h.dhcp_identifier, "
+     "  h.dhcp_identifier_type, h.dhcp4_subnet_id, "
+     "  h.dhcp6_subnet_id, h.ipv4_address, h.hostname, "
+     "  h.dhcp4_client_classes, h.dhcp6_client_classes, "
+     "  h.dhcp4_next_server, h.dhcp4_server_hostname, h.dhcp4_boot_file_name, "
+     "  o.option_id, o.code, o.value, o.formatted_value, o.space, "
+     "  o.persistent, "
+     "  r.reservation_id, r.address, r.prefix_len, r.type, r.dhcp6_iaid "
+     "FROM hosts AS h "
+     "LEFT JOIN dhcp6_options AS o ON h.host_id = o.host_id "
+     "LEFT JOIN ipv6_reservations AS r ON h.host_id = r.host_id "
+     "WHERE h.dhcp6_subnet_id = $1 AND ("
+     "  (h.dhcp_identifier_type = $2 AND h.dhcp_identifier = $3) OR "
+     "  (h.dhcp_identifier_type = $4 AND h.dhcp_identifier = $5) OR "
+     "  (h.dhcp_identifier_type = $6 AND h.dhcp_identifier = $7) OR "
+     "  (h.dhcp_identifier_type = $8 AND h.dhcp_identifier = $9) OR "
+     "  (h.dhcp_identifier_type = $10 AND h.dhcp_identifier = $11)) "
+     "ORDER BY h.host_id, o.option_id, r.reservation_id"
+    },
+
     // PgSqlHostDataSourceImpl::GET_VERSION
     // Retrieves PgSQL schema version.
     {0,
@@ -1803,6 +1887,50 @@ getHost(const SubnetID& subnet_id,
     return (result);
 }
 
+ConstHostCollection
+PgSqlHostDataSourceImpl::
+getHostsByIdentifiers(const SubnetID& subnet_id,
+                      const HostIdentifierList& identifiers,
+                      StatementIndex stindex,
+                      boost::shared_ptr<PgSqlHostExchange> exchange) const {
+    // Empty identifiers can't match any host.
+    std::vector<const HostIdentifier*> ids;
+    for (HostIdentifierList::const_iterator id = identifiers.begin();
+         id != identifiers.end(); ++id) {
+        if (!id->second.empty()) {
+            ids.push_back(&(*id));
+        }
+    }
+
+    ConstHostCollection collection;
+    for (size_t first = 0; first < ids.size();
+         first += MAX_QUERY_IDENTIFIERS) {
+
+        // Set up the WHERE clause value
+        PsqlBindArrayPtr bind_array(new PsqlBindArray());
+
+        // Add the subnet id.
+        bind_array->add(subnet_id);
+
+        for (size_t i = 0; i < MAX_QUERY_IDENTIFIERS; ++i) {
+            // The query has a fixed number of conditions. The unused ones
+            // repeat the last identifier.
+            const HostIdentifier& id =
+                *ids[std::min(first + i, ids.size() - 1)];
+
+            // Add the Identifier type.
+            bind_array->add(static_cast<uint8_t>(id.first));
+
+            // Add the identifier value.
+            bind_array->add(&id.second[0], id.second.size());
+        }
+
+        getHostCollection(stindex, bind_array, exchange, collection, false);
+    }
+
+    return (BaseHostDataSource::sortByIdentifiers(collection, identifiers));
+}
+
 std::pair<uint32_t, uint32_t> PgSqlHostDataSourceImpl::getVersion() const {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_HOST_DB_GET_VERSION);
@@ -2042,6 +2170,14 @@ PgSqlHostDataSource::get4(const SubnetID& subnet_id,
                            impl_->host_exchange_));
 }
 
+ConstHostCollection
+PgSqlHostDataSource::getByIdentifiers4(const SubnetID& subnet_id,
+                                       const HostIdentifierList& identifiers) const {
+    return (impl_->getHostsByIdentifiers(subnet_id, identifiers,
+                PgSqlHostDataSourceImpl::GET_HOST_SUBID4_DHCPIDS,
+                impl_->host_exchange_));
+}
+
 ConstHostPtr
 PgSqlHostDataSource::get4(const SubnetID& subnet_id,
                           const asiolink::IOAddress& address) const {
@@ -2109,6 +2245,14 @@ PgSqlHostDataSource::get6(const SubnetID& subnet_id,
                    impl_->host_ipv6_exchange_));
 }
 
+ConstHostCollection
+PgSqlHostDataSource::getByIdentifiers6(const SubnetID& subnet_id,
+                                       const HostIdentifierList& identifiers) const {
+    return (impl_->getHostsByIdentifiers(subnet_id, identifiers,
+                PgSqlHostDataSourceImpl::GET_HOST_SUBID6_DHCPIDS,
+                impl_->host_ipv6_exchange_));
+}
+
 ConstHostPtr
 PgSqlHostDataSource::get6(const asiolink::IOAddress& prefix,
                           const uint8_t prefix_len) const {
@@ -11,7 +11,9 @@
 #include <dhcp/hwaddr.h>
 #include <dhcpsrv/dhcpsrv_log.h>
 #include <dhcpsrv/pgsql_lease_mgr.h>
+#include <util/threads/multi_threading_mgr.h>
 
+#include <boost/bind.hpp>
 #include <boost/static_assert.hpp>
 
 #include <iomanip>
@@ -38,23 +40,43 @@ PgSqlTaggedStatement tagged_statements[] = {
       "delete_lease4",
       "DELETE FROM lease4 WHERE address = $1"},
 
+    // DELETE_LEASE4_BATCH
+    { 1, { OID_NONE },
+      "delete_lease4_batch",
+      "DELETE FROM lease4 WHERE address = ANY($1::bigint[])"},
+
     // DELETE_LEASE4_STATE_EXPIRED
     { 2, { OID_INT8, OID_TIMESTAMP },
       "delete_lease4_state_expired",
       "DELETE FROM lease4 "
           "WHERE state = $1 AND expire < $2"},
 
+    // DELETE_LEASE4_SUBNET_ID
+    { 1, { OID_INT8 },
+      "delete_lease4_subnet_id",
+      "DELETE FROM lease4 WHERE subnet_id = $1"},
+
     // DELETE_LEASE6
     { 1, { OID_VARCHAR },
       "delete_lease6",
       "DELETE FROM lease6 WHERE address = $1"},
 
+    // DELETE_LEASE6_BATCH
+    { 1, { OID_NONE },
+      "delete_lease6_batch",
+      "DELETE FROM lease6 WHERE address = ANY($1::varchar[])"},
+
     // DELETE_LEASE6_STATE_EXPIRED
     { 2, { OID_INT8, OID_TIMESTAMP },
       "delete_lease6_state_expired",
       "DELETE FROM lease6 "
           "WHERE state = $1 AND expire < $2"},
 
+    // DELETE_LEASE6_SUBNET_ID
+    { 1, { OID_INT8 },
+      "delete_lease6_subnet_id",
+      "DELETE FROM lease6 WHERE subnet_id = $1"},
+
     // GET_LEASE4_ADDR
     { 1, { OID_INT8 },
       "get_lease4_addr",
@@ -169,6 +191,20 @@ PgSqlTaggedStatement tagged_statements[] = {
         "state) "
       "VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10)"},
 
+    // INSERT_LEASE4_BATCH
+    { 10, { OID_NONE },
+      "insert_lease4_batch",
+      "INSERT INTO lease4(address, hwaddr, client_id, "
+        "valid_lifetime, expire, subnet_id, fqdn_fwd, fqdn_rev, hostname, "
+        "state) "
+      "SELECT * FROM unnest($1::bigint[], $2::bytea[], $3::bytea[], "
+        "$4::bigint[], $5::timestamp[], $6::bigint[], $7::boolean[], "
+        "$8::boolean[], $9::varchar[], $10::bigint[]) "
+      "AS v(address, hwaddr, client_id, valid_lifetime, expire, subnet_id, "
+        "fqdn_fwd, fqdn_rev, hostname, state) "
+      "WHERE NOT EXISTS "
+        "(SELECT 1 FROM lease4 WHERE lease4.address = v.address)"},
+
     // INSERT_LEASE6
     { 13, { OID_VARCHAR, OID_BYTEA, OID_INT8, OID_TIMESTAMP, OID_INT8,
             OID_INT8, OID_INT2, OID_INT8, OID_INT2, OID_BOOL, OID_BOOL,
@@ -179,6 +215,21 @@ PgSqlTaggedStatement tagged_statements[] = {
         "lease_type, iaid, prefix_len, fqdn_fwd, fqdn_rev, hostname, state) "
       "VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, $12, $13)"},
 
+    // INSERT_LEASE6_BATCH
+    { 13, { OID_NONE },
+      "insert_lease6_batch",
+      "INSERT INTO lease6(address, duid, valid_lifetime, "
+        "expire, subnet_id, pref_lifetime, "
+        "lease_type, iaid, prefix_len, fqdn_fwd, fqdn_rev, hostname, state) "
+      "SELECT * FROM unnest($1::varchar[], $2::bytea[], $3::bigint[], "
+        "$4::timestamp[], $5::bigint[], $6::bigint[], $7::smallint[], "
+        "$8::bigint[], $9::smallint[], $10::boolean[], $11::boolean[], "
+        "$12::varchar[], $13::bigint[]) "
+      "AS v(address, duid, valid_lifetime, expire, subnet_id, pref_lifetime, "
+        "lease_type, iaid, prefix_len, fqdn_fwd, fqdn_rev, hostname, state) "
+      "WHERE NOT EXISTS "
+        "(SELECT 1 FROM lease6 WHERE lease6.address = v.address)"},
+
     // UPDATE_LEASE4
     { 11, { OID_INT8, OID_BYTEA, OID_BYTEA, OID_INT8, OID_TIMESTAMP, OID_INT8,
             OID_BOOL, OID_BOOL, OID_VARCHAR, OID_INT8, OID_INT8 },
@@ -189,6 +240,21 @@ PgSqlTaggedStatement tagged_statements[] = {
         "state = $10"
       "WHERE address = $11"},
 
+    // UPDATE_LEASE4_BATCH
+    { 10, { OID_NONE },
+      "update_lease4_batch",
+      "UPDATE lease4 SET hwaddr = v.hwaddr, "
+        "client_id = v.client_id, valid_lifetime = v.valid_lifetime, "
+        "expire = v.expire, subnet_id = v.subnet_id, "
+        "fqdn_fwd = v.fqdn_fwd, fqdn_rev = v.fqdn_rev, "
+        "hostname = v.hostname, state = v.state "
+      "FROM unnest($1::bigint[], $2::bytea[], $3::bytea[], "
+        "$4::bigint[], $5::timestamp[], $6::bigint[], $7::boolean[], "
+        "$8::boolean[], $9::varchar[], $10::bigint[]) "
+      "AS v(address, hwaddr, client_id, valid_lifetime, expire, subnet_id, "
+        "fqdn_fwd, fqdn_rev, hostname, state) "
+      "WHERE lease4.address = v.address"},
+
     // UPDATE_LEASE6
     { 14, { OID_VARCHAR, OID_BYTEA, OID_INT8, OID_TIMESTAMP, OID_INT8, OID_INT8,
             OID_INT2, OID_INT8, OID_INT2, OID_BOOL, OID_BOOL, OID_VARCHAR,
@@ -201,6 +267,23 @@ PgSqlTaggedStatement tagged_statements[] = {
         "state = $13 "
       "WHERE address = $14"},
 
+    // UPDATE_LEASE6_BATCH
+    { 13, { OID_NONE },
+      "update_lease6_batch",
+      "UPDATE lease6 SET duid = v.duid, "
+        "valid_lifetime = v.valid_lifetime, expire = v.expire, "
+        "subnet_id = v.subnet_id, pref_lifetime = v.pref_lifetime, "
+        "lease_type = v.lease_type, iaid = v.iaid, "
+        "prefix_len = v.prefix_len, fqdn_fwd = v.fqdn_fwd, "
+        "fqdn_rev = v.fqdn_rev, hostname = v.hostname, state = v.state "
+      "FROM unnest($1::varchar[], $2::bytea[], $3::bigint[], "
+        "$4::timestamp[], $5::bigint[], $6::bigint[], $7::smallint[], "
+        "$8::bigint[], $9::smallint[], $10::boolean[], $11::boolean[], "
+        "$12::varchar[], $13::bigint[]) "
+      "AS v(address, duid, valid_lifetime, expire, subnet_id, pref_lifetime, "
+        "lease_type, iaid, prefix_len, fqdn_fwd, fqdn_rev, hostname, state) "
+      "WHERE lease6.address = v.address"},
+
     // RECOUNT_LEASE4_STATS,
     { 0, { OID_NONE },
       "recount_lease4_stats",
@@ -218,6 +301,85 @@ PgSqlTaggedStatement tagged_statements[] = {
     { 0,  { 0 }, NULL, NULL}
 };
 
+/// @brief Appends a value to the PostgreSQL array literal.
+///
+/// The value is quoted, so it may contain any character. The binary value
+/// is converted to the hex format of the bytea type.
+///
+/// @param [out] array Array literal to which the value is appended. The
+/// opening brace is added if the literal is empty.
+/// @param value Pointer to the value or NULL.
+/// @param length Length of the value.
+/// @param binary true if the value is binary, false if it is text.
+void
+appendArrayElement(std::string& array, const char* value, const size_t length,
+                   const bool binary) {
+    array.push_back(array.empty() ? '{' : ',');
+    if (!value) {
+        array.append("NULL");
+        return;
+    }
+
+    array.push_back('"');
+    if (binary) {
+        // The backslash of the bytea hex format is escaped in the array.
+        static const char digits[] = "0123456789abcdef";
+        array.append("\\\\x");
+        for (size_t i = 0; i < length; ++i) {
+            const uint8_t byte = static_cast<uint8_t>(value[i]);
+            array.push_back(digits[byte >> 4]);
+            array.push_back(digits[byte & 0x0f]);
+        }
+
+    } else {
+        for (size_t i = 0; i < length; ++i) {
+            if ((value[i] == '"') || (value[i] == '\\')) {
+                array.push_back('\\');
+            }
+            array.push_back(value[i]);
+        }
+    }
+    array.push_back('"');
+}
+
+/// @brief Creates the bind array of a batch statement.
+///
+/// The batch statements take the columns of the leases as arrays and
+/// expand them with unnest(), so the leases are written by one statement.
+/// Each lease is bound with the exchange object used for a single lease
+/// and its columns are appended to the array literals.
+///
+/// @param exchange Exchange object of the lease type.
+/// @param leases Leases to be bound. The collection must not be empty.
+/// @param [out] arrays Array literals, one per column. The bind array
+/// points to them.
+/// @param [out] bind_array Bind array of the batch statement.
+///
+/// @tparam Exchange Pointer to the exchange object.
+/// @tparam LeaseCollection A @c Lease4Collection or @c Lease6Collection.
+template <typename Exchange, typename LeaseCollection>
+void
+createBatchBind(Exchange& exchange, const LeaseCollection& leases,
+                std::vector<std::string>& arrays, PsqlBindArray& bind_array) {
+    arrays.clear();
+    for (auto lease = leases.begin(); lease != leases.end(); ++lease) {
+        PsqlBindArray lease_bind;
+        exchange->createBindForSend(*lease, lease_bind);
+        arrays.resize(lease_bind.size());
+        for (size_t i = 0; i < lease_bind.size(); ++i) {
+            appendArrayElement(arrays[i], lease_bind.values_[i],
+                               lease_bind.lengths_[i],
+                               (lease_bind.formats_[i] ==
+                                PsqlBindArray::BINARY_FMT));
+        }
+    }
+
+    for (auto array = arrays.begin(); array != arrays.end(); ++array) {
+        array->push_back('}');
+        bind_array.add(*array);
+    }
+}
+
 };
 
 namespace isc {
@@ -803,21 +965,23 @@ protected:
     bool fetch_type_;
 };
 
-PgSqlLeaseMgr::PgSqlLeaseMgr(const DatabaseConnection::ParameterMap& parameters)
-    : LeaseMgr(), exchange4_(new PgSqlLease4Exchange()),
-    exchange6_(new PgSqlLease6Exchange()), conn_(parameters) {
-    conn_.openDatabase();
-    int i = 0;
-    for( ; tagged_statements[i].text != NULL ; ++i) {
-        conn_.prepareStatement(tagged_statements[i]);
-    }
+PgSqlLeaseContext::PgSqlLeaseContext(const DatabaseConnection::ParameterMap&
+                                     parameters)
+    : exchange4_(new PgSqlLease4Exchange()),
+      exchange6_(new PgSqlLease6Exchange()), conn_(parameters) {
+}
 
-    // Just in case somebody foo-barred things
-    if (i != NUM_STATEMENTS) {
-        isc_throw(DbOpenError, "Number of statements prepared: " << i
-                  << " does not match expected count:" << NUM_STATEMENTS);
-    }
+PgSqlLeaseContext::~PgSqlLeaseContext() {
+    // The exchange objects are destroyed here, where their type is complete.
+}
 
+PgSqlLeaseMgr::PgSqlLeaseMgr(const DatabaseConnection::ParameterMap& parameters)
+    : LeaseMgr(), parameters_(parameters),
+      pool_(boost::bind(&PgSqlLeaseMgr::createContext, parameters),
+            PgSqlLeaseContextPool::getMaxConnections(parameters),
+            "lease-database") {
+    // Getting the version opens the first connection, which is then put
+    // in the pool and reused by the subsequent operations.
     pair<uint32_t, uint32_t> code_version(PG_SCHEMA_VERSION_MAJOR, PG_SCHEMA_VERSION_MINOR);
     pair<uint32_t, uint32_t> db_version = getVersion();
     if (code_version != db_version) {
@@ -832,6 +996,25 @@ PgSqlLeaseMgr::PgSqlLeaseMgr(const DatabaseConnection::ParameterMap& parameters)
 PgSqlLeaseMgr::~PgSqlLeaseMgr() {
 }
 
+PgSqlLeaseContextPtr
+PgSqlLeaseMgr::createContext(const DatabaseConnection::ParameterMap&
+                             parameters) {
+    PgSqlLeaseContextPtr ctx(new PgSqlLeaseContext(parameters));
+    ctx->conn_.openDatabase();
+    int i = 0;
+    for( ; tagged_statements[i].text != NULL ; ++i) {
+        ctx->conn_.prepareStatement(tagged_statements[i]);
+    }
+
+    // Just in case somebody foo-barred things
+    if (i != NUM_STATEMENTS) {
+        isc_throw(DbOpenError, "Number of statements prepared: " << i
+                  << " does not match expected count:" << NUM_STATEMENTS);
+    }
+
+    return (ctx);
+}
+
 std::string
 PgSqlLeaseMgr::getDBVersion() {
     std::stringstream tmp;
@@ -842,9 +1025,10 @@ PgSqlLeaseMgr::getDBVersion() {
 }
 
 bool
-PgSqlLeaseMgr::addLeaseCommon(StatementIndex stindex,
+PgSqlLeaseMgr::addLeaseCommon(PgSqlLeaseContextPtr& ctx,
+                              StatementIndex stindex,
                               PsqlBindArray& bind_array) {
-    PgSqlResult r(PQexecPrepared(conn_, tagged_statements[stindex].name,
+    PgSqlResult r(PQexecPrepared(ctx->conn_, tagged_statements[stindex].name,
                                  tagged_statements[stindex].nbparams,
                                  &bind_array.values_[0],
                                  &bind_array.lengths_[0],
@@ -856,11 +1040,11 @@ PgSqlLeaseMgr::addLeaseCommon(StatementIndex stindex,
         // Failure: check for the special case of duplicate entry.  If this is
         // the case, we return false to indicate that the row was not added.
         // Otherwise we throw an exception.
-        if (conn_.compareError(r, PgSqlConnection::DUPLICATE_KEY)) {
+        if (ctx->conn_.compareError(r, PgSqlConnection::DUPLICATE_KEY)) {
             return (false);
         }
 
-        conn_.checkStatementError(r, tagged_statements[stindex]);
+        ctx->conn_.checkStatementError(r, tagged_statements[stindex]);
     }
 
     return (true);
@@ -868,37 +1052,119 @@ PgSqlLeaseMgr::addLeaseCommon(StatementIndex stindex,
 
 bool
 PgSqlLeaseMgr::addLease(const Lease4Ptr& lease) {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
+    return (addLeaseInternal(ctx, lease));
+}
+
+bool
+PgSqlLeaseMgr::addLease(const Lease6Ptr& lease) {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
+    return (addLeaseInternal(ctx, lease));
+}
+
+template <typename Exchange, typename LeaseCollection>
+size_t
+PgSqlLeaseMgr::addLeasesCommon(PgSqlLeaseContextPtr& ctx,
+                               StatementIndex stindex,
+                               Exchange& exchange,
+                               const LeaseCollection& leases) {
+    if (leases.empty()) {
+        return (0);
+    }
+
+    std::vector<std::string> arrays;
+    PsqlBindArray bind_array;
+    createBatchBind(exchange, leases, arrays, bind_array);
+
+    PgSqlResult r(PQexecPrepared(ctx->conn_, tagged_statements[stindex].name,
+                                 tagged_statements[stindex].nbparams,
+                                 &bind_array.values_[0],
+                                 &bind_array.lengths_[0],
+                                 &bind_array.formats_[0], 0));
+
+    if (PQresultStatus(r) == PGRES_COMMAND_OK) {
+        // The leases which already exist are skipped by the statement.
+        return (boost::lexical_cast<size_t>(PQcmdTuples(r)));
+    }
+
+    // The duplicate entry is only reported when the collection holds the
+    // same address twice or the lease is added concurrently. Add the
+    // leases one by one in this case.
+    if (!ctx->conn_.compareError(r, PgSqlConnection::DUPLICATE_KEY)) {
+        ctx->conn_.checkStatementError(r, tagged_statements[stindex]);
+    }
+
+    size_t added = 0;
+    for (auto lease = leases.begin(); lease != leases.end(); ++lease) {
+        if (addLeaseInternal(ctx, *lease)) {
+            ++added;
+        }
+    }
+    return (added);
+}
+
+size_t
+PgSqlLeaseMgr::addLeases(const Lease4Collection& leases) {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
+    return (addLeasesCommon(ctx, INSERT_LEASE4_BATCH, ctx->exchange4_,
+                            leases));
+}
+
+size_t
+PgSqlLeaseMgr::addLeases(const Lease6Collection& leases) {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
+    return (addLeasesCommon(ctx, INSERT_LEASE6_BATCH, ctx->exchange6_,
+                            leases));
+}
+
+bool
+PgSqlLeaseMgr::addLeaseInternal(PgSqlLeaseContextPtr& ctx,
+                                const Lease4Ptr& lease) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_ADD_ADDR4).arg(lease->addr_.toText());
 
     PsqlBindArray bind_array;
-    exchange4_->createBindForSend(lease, bind_array);
-    return (addLeaseCommon(INSERT_LEASE4, bind_array));
+    ctx->exchange4_->createBindForSend(lease, bind_array);
+    return (addLeaseCommon(ctx, INSERT_LEASE4, bind_array));
 }
 
 bool
-PgSqlLeaseMgr::addLease(const Lease6Ptr& lease) {
+PgSqlLeaseMgr::addLeaseInternal(PgSqlLeaseContextPtr& ctx,
+                                const Lease6Ptr& lease) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_ADD_ADDR6).arg(lease->addr_.toText());
     PsqlBindArray bind_array;
-    exchange6_->createBindForSend(lease, bind_array);
+    ctx->exchange6_->createBindForSend(lease, bind_array);
 
-    return (addLeaseCommon(INSERT_LEASE6, bind_array));
+    return (addLeaseCommon(ctx, INSERT_LEASE6, bind_array));
 }
 
 template <typename Exchange, typename LeaseCollection>
-void PgSqlLeaseMgr::getLeaseCollection(StatementIndex stindex,
+void PgSqlLeaseMgr::getLeaseCollection(PgSqlLeaseContextPtr& ctx,
+                                       StatementIndex stindex,
                                        PsqlBindArray& bind_array,
                                        Exchange& exchange,
                                        LeaseCollection& result,
                                        bool single) const {
-    PgSqlResult r(PQexecPrepared(conn_, tagged_statements[stindex].name,
+    PgSqlResult r(PQexecPrepared(ctx->conn_, tagged_statements[stindex].name,
                                  tagged_statements[stindex].nbparams,
                                  &bind_array.values_[0],
                                  &bind_array.lengths_[0],
                                  &bind_array.formats_[0], 0));
 
-    conn_.checkStatementError(r, tagged_statements[stindex]);
+    ctx->conn_.checkStatementError(r, tagged_statements[stindex]);
 
     int rows = PQntuples(r);
     if (single && rows > 1) {
@@ -914,15 +1180,17 @@ void PgSqlLeaseMgr::getLeaseCollection(StatementIndex stindex,
 
 
 void
-PgSqlLeaseMgr::getLease(StatementIndex stindex, PsqlBindArray& bind_array,
-                             Lease4Ptr& result) const {
+PgSqlLeaseMgr::getLease(PgSqlLeaseContextPtr& ctx,
+                        StatementIndex stindex, PsqlBindArray& bind_array,
+                        Lease4Ptr& result) const {
     // Create appropriate collection object and get all leases matching
     // the selection criteria.  The "single" parameter is true to indicate
     // that the called method should throw an exception if multiple
     // matching records are found: this particular method is called when only
     // one or zero matches is expected.
     Lease4Collection collection;
-    getLeaseCollection(stindex, bind_array, exchange4_, collection, true);
+    getLeaseCollection(ctx, stindex, bind_array, ctx->exchange4_,
+                       collection, true);
 
     // Return single record if present, else clear the lease.
     if (collection.empty()) {
@@ -934,15 +1202,17 @@ PgSqlLeaseMgr::getLease(StatementIndex stindex, PsqlBindArray& bind_array,
 
 
 void
-PgSqlLeaseMgr::getLease(StatementIndex stindex, PsqlBindArray& bind_array,
-                             Lease6Ptr& result) const {
+PgSqlLeaseMgr::getLease(PgSqlLeaseContextPtr& ctx,
+                        StatementIndex stindex, PsqlBindArray& bind_array,
+                        Lease6Ptr& result) const {
     // Create appropriate collection object and get all leases matching
     // the selection criteria.  The "single" parameter is true to indicate
     // that the called method should throw an exception if multiple
     // matching records are found: this particular method is called when only
     // one or zero matches is expected.
     Lease6Collection collection;
-    getLeaseCollection(stindex, bind_array, exchange6_, collection, true);
+    getLeaseCollection(ctx, stindex, bind_array, ctx->exchange6_,
+                       collection, true);
 
     // Return single record if present, else clear the lease.
     if (collection.empty()) {
@@ -954,6 +1224,10 @@ PgSqlLeaseMgr::getLease(StatementIndex stindex, PsqlBindArray& bind_array,
 
 Lease4Ptr
 PgSqlLeaseMgr::getLease4(const isc::asiolink::IOAddress& addr) const {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_GET_ADDR4).arg(addr.toText());
 
@@ -967,13 +1241,17 @@ PgSqlLeaseMgr::getLease4(const isc::asiolink::IOAddress& addr) const {
 
     // Get the data
     Lease4Ptr result;
-    getLease(GET_LEASE4_ADDR, bind_array, result);
+    getLease(ctx, GET_LEASE4_ADDR, bind_array, result);
 
     return (result);
 }
 
 Lease4Collection
 PgSqlLeaseMgr::getLease4(const HWAddr& hwaddr) const {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_GET_HWADDR).arg(hwaddr.toText());
 
@@ -989,13 +1267,17 @@ PgSqlLeaseMgr::getLease4(const HWAddr& hwaddr) const {
 
     // Get the data
     Lease4Collection result;
-    getLeaseCollection(GET_LEASE4_HWADDR, bind_array, result);
+    getLeaseCollection(ctx, GET_LEASE4_HWADDR, bind_array, result);
 
     return (result);
 }
 
 Lease4Ptr
 PgSqlLeaseMgr::getLease4(const HWAddr& hwaddr, SubnetID subnet_id) const {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_GET_SUBID_HWADDR)
               .arg(subnet_id).arg(hwaddr.toText());
@@ -1016,13 +1298,17 @@ PgSqlLeaseMgr::getLease4(const HWAddr& hwaddr, SubnetID subnet_id) const {
 
     // Get the data
     Lease4Ptr result;
-    getLease(GET_LEASE4_HWADDR_SUBID, bind_array, result);
+    getLease(ctx, GET_LEASE4_HWADDR_SUBID, bind_array, result);
 
     return (result);
 }
 
 Lease4Collection
 PgSqlLeaseMgr::getLease4(const ClientId& clientid) const {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_GET_CLIENTID).arg(clientid.toText());
 
@@ -1034,13 +1320,17 @@ PgSqlLeaseMgr::getLease4(const ClientId& clientid) const {
 
     // Get the data
     Lease4Collection result;
-    getLeaseCollection(GET_LEASE4_CLIENTID, bind_array, result);
+    getLeaseCollection(ctx, GET_LEASE4_CLIENTID, bind_array, result);
 
     return (result);
 }
 
 Lease4Ptr
 PgSqlLeaseMgr::getLease4(const ClientId& clientid, SubnetID subnet_id) const {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_GET_SUBID_CLIENTID)
               .arg(subnet_id).arg(clientid.toText());
@@ -1057,7 +1347,7 @@ PgSqlLeaseMgr::getLease4(const ClientId& clientid, SubnetID subnet_id) const {
 
     // Get the data
     Lease4Ptr result;
-    getLease(GET_LEASE4_CLIENTID_SUBID, bind_array, result);
+    getLease(ctx, GET_LEASE4_CLIENTID_SUBID, bind_array, result);
 
     return (result);
 }
@@ -1075,6 +1365,10 @@ PgSqlLeaseMgr::getLease4(const ClientId&, const HWAddr&, SubnetID) const {
 Lease6Ptr
 PgSqlLeaseMgr::getLease6(Lease::Type lease_type,
                          const isc::asiolink::IOAddress& addr) const {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_GET_ADDR6)
               .arg(addr.toText()).arg(lease_type);
 
@@ -1091,7 +1385,7 @@ PgSqlLeaseMgr::getLease6(Lease::Type lease_type,
 
     // ... and get the data
     Lease6Ptr result;
-    getLease(GET_LEASE6_ADDR, bind_array, result);
+    getLease(ctx, GET_LEASE6_ADDR, bind_array, result);
 
     return (result);
 }
@@ -1099,6 +1393,10 @@ PgSqlLeaseMgr::getLease6(Lease::Type lease_type,
 Lease6Collection
 PgSqlLeaseMgr::getLeases6(Lease::Type lease_type, const DUID& duid,
                           uint32_t iaid) const {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_GET_IAID_DUID)
               .arg(iaid).arg(duid.toText()).arg(lease_type);
@@ -1119,7 +1417,7 @@ PgSqlLeaseMgr::getLeases6(Lease::Type lease_type, const DUID& duid,
 
     // ... and get the data
     Lease6Collection result;
-    getLeaseCollection(GET_LEASE6_DUID_IAID, bind_array, result);
+    getLeaseCollection(ctx, GET_LEASE6_DUID_IAID, bind_array, result);
 
     return (result);
 }
@@ -1127,6 +1425,10 @@ PgSqlLeaseMgr::getLeases6(Lease::Type lease_type, const DUID& duid,
 Lease6Collection
 PgSqlLeaseMgr::getLeases6(Lease::Type lease_type, const DUID& duid,
                           uint32_t iaid, SubnetID subnet_id) const {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_GET_IAID_SUBID_DUID)
               .arg(iaid).arg(subnet_id).arg(duid.toText()).arg(lease_type);
@@ -1151,7 +1453,7 @@ PgSqlLeaseMgr::getLeases6(Lease::Type lease_type, const DUID& duid,
 
     // ... and get the data
     Lease6Collection result;
-    getLeaseCollection(GET_LEASE6_DUID_IAID_SUBID, bind_array, result);
+    getLeaseCollection(ctx, GET_LEASE6_DUID_IAID_SUBID, bind_array, result);
 
     return (result);
 }
@@ -1159,22 +1461,31 @@ PgSqlLeaseMgr::getLeases6(Lease::Type lease_type, const DUID& duid,
 void
 PgSqlLeaseMgr::getExpiredLeases6(Lease6Collection& expired_leases,
                                  const size_t max_leases) const {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_GET_EXPIRED6)
         .arg(max_leases);
-    getExpiredLeasesCommon(expired_leases, max_leases, GET_LEASE6_EXPIRE);
+    getExpiredLeasesCommon(ctx, expired_leases, max_leases, GET_LEASE6_EXPIRE);
 }
 
 void
 PgSqlLeaseMgr::getExpiredLeases4(Lease4Collection& expired_leases,
                                  const size_t max_leases) const {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL, DHCPSRV_PGSQL_GET_EXPIRED4)
         .arg(max_leases);
-    getExpiredLeasesCommon(expired_leases, max_leases, GET_LEASE4_EXPIRE);
+    getExpiredLeasesCommon(ctx, expired_leases, max_leases, GET_LEASE4_EXPIRE);
 }
 
 template<typename LeaseCollection>
 void
-PgSqlLeaseMgr::getExpiredLeasesCommon(LeaseCollection& expired_leases,
+PgSqlLeaseMgr::getExpiredLeasesCommon(PgSqlLeaseContextPtr& ctx,
+                                       LeaseCollection& expired_leases,
                                        const size_t max_leases,
                                        StatementIndex statement_index) const {
     PsqlBindArray bind_array;
@@ -1195,25 +1506,26 @@ PgSqlLeaseMgr::getExpiredLeasesCommon(LeaseCollection& expired_leases,
     bind_array.add(limit_str);
 
     // Retrieve leases from the database.
-    getLeaseCollection(statement_index, bind_array, expired_leases);
+    getLeaseCollection(ctx, statement_index, bind_array, expired_leases);
 }
 
 
 template<typename LeasePtr>
 void
-PgSqlLeaseMgr::updateLeaseCommon(StatementIndex stindex,
+PgSqlLeaseMgr::updateLeaseCommon(PgSqlLeaseContextPtr& ctx,
+                                 StatementIndex stindex,
                                  PsqlBindArray& bind_array,
                                  const LeasePtr& lease) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_ADD_ADDR4).arg(tagged_statements[stindex].name);
 
-    PgSqlResult r(PQexecPrepared(conn_, tagged_statements[stindex].name,
+    PgSqlResult r(PQexecPrepared(ctx->conn_, tagged_statements[stindex].name,
                                  tagged_statements[stindex].nbparams,
                                  &bind_array.values_[0],
                                  &bind_array.lengths_[0],
                                  &bind_array.formats_[0], 0));
 
-    conn_.checkStatementError(r, tagged_statements[stindex]);
+    ctx->conn_.checkStatementError(r, tagged_statements[stindex]);
 
     int affected_rows = boost::lexical_cast<int>(PQcmdTuples(r));
 
@@ -1237,6 +1549,79 @@ PgSqlLeaseMgr::updateLeaseCommon(StatementIndex stindex,
 
 void
 PgSqlLeaseMgr::updateLease4(const Lease4Ptr& lease) {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
+    updateLease4Internal(ctx, lease);
+}
+
+void
+PgSqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
+    updateLease6Internal(ctx, lease);
+}
+
+template <typename Exchange, typename LeaseCollection>
+void
+PgSqlLeaseMgr::updateLeasesCommon(PgSqlLeaseContextPtr& ctx,
+                                  StatementIndex stindex,
+                                  Exchange& exchange,
+                                  const LeaseCollection& leases) {
+    if (leases.empty()) {
+        return;
+    }
+
+    std::vector<std::string> arrays;
+    PsqlBindArray bind_array;
+    createBatchBind(exchange, leases, arrays, bind_array);
+
+    // The statement is run in a transaction, so nothing is updated when
+    // some of the leases don't exist.
+    PgSqlTransaction transaction(ctx->conn_);
+
+    PgSqlResult r(PQexecPrepared(ctx->conn_, tagged_statements[stindex].name,
+                                 tagged_statements[stindex].nbparams,
+                                 &bind_array.values_[0],
+                                 &bind_array.lengths_[0],
+                                 &bind_array.formats_[0], 0));
+
+    ctx->conn_.checkStatementError(r, tagged_statements[stindex]);
+
+    size_t affected_rows = boost::lexical_cast<size_t>(PQcmdTuples(r));
+    if (affected_rows < leases.size()) {
+        isc_throw(NoSuchLease, "unable to update "
+                  << (leases.size() - affected_rows) << " of "
+                  << leases.size() << " leases as they do not exist");
+    }
+
+    transaction.commit();
+}
+
+void
+PgSqlLeaseMgr::updateLeases4(const Lease4Collection& leases) {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
+    updateLeasesCommon(ctx, UPDATE_LEASE4_BATCH, ctx->exchange4_, leases);
+}
+
+void
+PgSqlLeaseMgr::updateLeases6(const Lease6Collection& leases) {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
+    updateLeasesCommon(ctx, UPDATE_LEASE6_BATCH, ctx->exchange6_, leases);
+}
+
+void
+PgSqlLeaseMgr::updateLease4Internal(PgSqlLeaseContextPtr& ctx,
+                                    const Lease4Ptr& lease) {
     const StatementIndex stindex = UPDATE_LEASE4;
 
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
@@ -1244,7 +1629,7 @@ PgSqlLeaseMgr::updateLease4(const Lease4Ptr& lease) {
 
     // Create the BIND array for the data being updated
     PsqlBindArray bind_array;
-    exchange4_->createBindForSend(lease, bind_array);
+    ctx->exchange4_->createBindForSend(lease, bind_array);
 
     // Set up the WHERE clause and append it to the SQL_BIND array
     std::string addr4_ = boost::lexical_cast<std::string>
@@ -1252,11 +1637,12 @@ PgSqlLeaseMgr::updateLease4(const Lease4Ptr& lease) {
     bind_array.add(addr4_);
 
     // Drop to common update code
-    updateLeaseCommon(stindex, bind_array, lease);
+    updateLeaseCommon(ctx, stindex, bind_array, lease);
 }
 
 void
-PgSqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
+PgSqlLeaseMgr::updateLease6Internal(PgSqlLeaseContextPtr& ctx,
+                                    const Lease6Ptr& lease) {
     const StatementIndex stindex = UPDATE_LEASE6;
 
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
@@ -1264,26 +1650,27 @@ PgSqlLeaseMgr::updateLease6(const Lease6Ptr& lease) {
 
     // Create the BIND array for the data being updated
     PsqlBindArray bind_array;
-    exchange6_->createBindForSend(lease, bind_array);
+    ctx->exchange6_->createBindForSend(lease, bind_array);
 
     // Set up the WHERE clause and append it to the BIND array
     std::string addr_str = lease->addr_.toText();
     bind_array.add(addr_str);
 
     // Drop to common update code
-    updateLeaseCommon(stindex, bind_array, lease);
+    updateLeaseCommon(ctx, stindex, bind_array, lease);
 }
 
 uint64_t
-PgSqlLeaseMgr::deleteLeaseCommon(StatementIndex stindex,
+PgSqlLeaseMgr::deleteLeaseCommon(PgSqlLeaseContextPtr& ctx,
+                                 StatementIndex stindex,
                                  PsqlBindArray& bind_array) {
-    PgSqlResult r(PQexecPrepared(conn_, tagged_statements[stindex].name,
+    PgSqlResult r(PQexecPrepared(ctx->conn_, tagged_statements[stindex].name,
                                  tagged_statements[stindex].nbparams,
                                  &bind_array.values_[0],
                                  &bind_array.lengths_[0],
                                  &bind_array.formats_[0], 0));
 
-    conn_.checkStatementError(r, tagged_statements[stindex]);
+    ctx->conn_.checkStatementError(r, tagged_statements[stindex]);
     int affected_rows = boost::lexical_cast<int>(PQcmdTuples(r));
 
     return (affected_rows);
@@ -1291,6 +1678,58 @@ PgSqlLeaseMgr::deleteLeaseCommon(StatementIndex stindex,
 
 bool
 PgSqlLeaseMgr::deleteLease(const isc::asiolink::IOAddress& addr) {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
+    return (deleteLeaseInternal(ctx, addr));
+}
+
+size_t
+PgSqlLeaseMgr::deleteLeases(const std::vector<isc::asiolink::IOAddress>& addrs) {
+    // Split the addresses into the arrays of the IPv4 and IPv6 addresses.
+    std::string addrs4;
+    std::string addrs6;
+    for (auto addr = addrs.begin(); addr != addrs.end(); ++addr) {
+        LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
+                  DHCPSRV_PGSQL_DELETE_ADDR).arg(addr->toText());
+        if (addr->isV4()) {
+            std::string addr4_str = boost::lexical_cast<std::string>
+                                    (addr->toUint32());
+            appendArrayElement(addrs4, addr4_str.c_str(), addr4_str.size(),
+                               false);
+        } else {
+            std::string addr6_str = addr->toText();
+            appendArrayElement(addrs6, addr6_str.c_str(), addr6_str.size(),
+                               false);
+        }
+    }
+
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
+    PgSqlTransaction transaction(ctx->conn_);
+    size_t deleted = 0;
+    if (!addrs4.empty()) {
+        addrs4.push_back('}');
+        PsqlBindArray bind_array;
+        bind_array.add(addrs4);
+        deleted += deleteLeaseCommon(ctx, DELETE_LEASE4_BATCH, bind_array);
+    }
+    if (!addrs6.empty()) {
+        addrs6.push_back('}');
+        PsqlBindArray bind_array;
+        bind_array.add(addrs6);
+        deleted += deleteLeaseCommon(ctx, DELETE_LEASE6_BATCH, bind_array);
+    }
+    transaction.commit();
+    return (deleted);
+}
+
+bool
+PgSqlLeaseMgr::deleteLeaseInternal(PgSqlLeaseContextPtr& ctx,
+                                   const isc::asiolink::IOAddress& addr) {
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_DELETE_ADDR).arg(addr.toText());
 
@@ -1301,32 +1740,43 @@ PgSqlLeaseMgr::deleteLease(const isc::asiolink::IOAddress& addr) {
         std::string addr4_str = boost::lexical_cast<std::string>
                                  (addr.toUint32());
         bind_array.add(addr4_str);
-        return (deleteLeaseCommon(DELETE_LEASE4, bind_array) > 0);
+        return (deleteLeaseCommon(ctx, DELETE_LEASE4, bind_array) > 0);
     }
 
     std::string addr6_str = addr.toText();
     bind_array.add(addr6_str);
-    return (deleteLeaseCommon(DELETE_LEASE6, bind_array) > 0);
+    return (deleteLeaseCommon(ctx, DELETE_LEASE6, bind_array) > 0);
 }
 
 uint64_t
 PgSqlLeaseMgr::deleteExpiredReclaimedLeases4(const uint32_t secs) {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_DELETE_EXPIRED_RECLAIMED4)
         .arg(secs);
-    return (deleteExpiredReclaimedLeasesCommon(secs, DELETE_LEASE4_STATE_EXPIRED));
+    return (deleteExpiredReclaimedLeasesCommon(ctx, secs,
+                                               DELETE_LEASE4_STATE_EXPIRED));
 }
 
 uint64_t
 PgSqlLeaseMgr::deleteExpiredReclaimedLeases6(const uint32_t secs) {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_DELETE_EXPIRED_RECLAIMED6)
         .arg(secs);
-    return (deleteExpiredReclaimedLeasesCommon(secs, DELETE_LEASE6_STATE_EXPIRED));
+    return (deleteExpiredReclaimedLeasesCommon(ctx, secs,
+                                               DELETE_LEASE6_STATE_EXPIRED));
 }
 
 uint64_t
-PgSqlLeaseMgr::deleteExpiredReclaimedLeasesCommon(const uint32_t secs,
+PgSqlLeaseMgr::deleteExpiredReclaimedLeasesCommon(PgSqlLeaseContextPtr& ctx,
+                                                  const uint32_t secs,
                                                   StatementIndex statement_index) {
     PsqlBindArray bind_array;
 
@@ -1340,13 +1790,17 @@ PgSqlLeaseMgr::deleteExpiredReclaimedLeasesCommon(const uint32_t secs,
     bind_array.add(expiration_str);
 
     // Delete leases.
-    return (deleteLeaseCommon(statement_index, bind_array));
+    return (deleteLeaseCommon(ctx, statement_index, bind_array));
 }
 
 LeaseStatsQueryPtr
 PgSqlLeaseMgr::startLeaseStatsQuery4() {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
     LeaseStatsQueryPtr query(
-        new PgSqlLeaseStatsQuery(conn_,
+        new PgSqlLeaseStatsQuery(ctx->conn_,
                                  tagged_statements[RECOUNT_LEASE4_STATS],
                                  false));
     query->start();
@@ -1355,8 +1809,12 @@ PgSqlLeaseMgr::startLeaseStatsQuery4() {
 
 LeaseStatsQueryPtr
 PgSqlLeaseMgr::startLeaseStatsQuery6() {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
     LeaseStatsQueryPtr query(
-        new PgSqlLeaseStatsQuery(conn_,
+        new PgSqlLeaseStatsQuery(ctx->conn_,
                                  tagged_statements[RECOUNT_LEASE6_STATS],
                                  true));
     query->start();
@@ -1364,22 +1822,50 @@ PgSqlLeaseMgr::startLeaseStatsQuery6() {
 }
 
 size_t
-PgSqlLeaseMgr::wipeLeases4(const SubnetID& /*subnet_id*/) {
-    isc_throw(NotImplemented, "wipeLeases4 is not implemented for PgSQL backend");
+PgSqlLeaseMgr::wipeLeases4(const SubnetID& subnet_id) {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
+    LOG_INFO(dhcpsrv_logger, DHCPSRV_PGSQL_WIPE_LEASES4)
+        .arg(subnet_id);
+    uint64_t num = wipeLeasesCommon(ctx, subnet_id, DELETE_LEASE4_SUBNET_ID);
+    LOG_INFO(dhcpsrv_logger, DHCPSRV_PGSQL_WIPE_LEASES4_FINISHED)
+        .arg(subnet_id).arg(num);
+    return (num);
 }
 
 size_t
-PgSqlLeaseMgr::wipeLeases6(const SubnetID& /*subnet_id*/) {
-    isc_throw(NotImplemented, "wipeLeases6 is not implemented for PgSQL backend");
+PgSqlLeaseMgr::wipeLeases6(const SubnetID& subnet_id) {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
+    LOG_INFO(dhcpsrv_logger, DHCPSRV_PGSQL_WIPE_LEASES6)
+        .arg(subnet_id);
+    uint64_t num = wipeLeasesCommon(ctx, subnet_id, DELETE_LEASE6_SUBNET_ID);
+    LOG_INFO(dhcpsrv_logger, DHCPSRV_PGSQL_WIPE_LEASES6_FINISHED)
+        .arg(subnet_id).arg(num);
+    return (num);
+}
+
+uint64_t
+PgSqlLeaseMgr::wipeLeasesCommon(PgSqlLeaseContextPtr& ctx,
+                                const SubnetID& subnet_id,
+                                StatementIndex statement_index) {
+    PsqlBindArray bind_array;
+    std::string subnet_id_str = boost::lexical_cast<std::string>(subnet_id);
+    bind_array.add(subnet_id_str);
+    return (deleteLeaseCommon(ctx, statement_index, bind_array));
 }
 
 string
 PgSqlLeaseMgr::getName() const {
     string name = "";
-    try {
-        name = conn_.getParameter("name");
-    } catch (...) {
-        // Return an empty name
+    DatabaseConnection::ParameterMap::const_iterator param =
+        parameters_.find("name");
+    if (param != parameters_.end()) {
+        name = param->second;
     }
     return (name);
 }
@@ -1391,11 +1877,16 @@ PgSqlLeaseMgr::getDescription() const {
 
 pair<uint32_t, uint32_t>
 PgSqlLeaseMgr::getVersion() const {
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
     LOG_DEBUG(dhcpsrv_logger, DHCPSRV_DBG_TRACE_DETAIL,
               DHCPSRV_PGSQL_GET_VERSION);
 
-    PgSqlResult r(PQexecPrepared(conn_, "get_version", 0, NULL, NULL, NULL, 0));
-    conn_.checkStatementError(r, tagged_statements[GET_VERSION]);
+    PgSqlResult r(PQexecPrepared(ctx->conn_, "get_version", 0, NULL, NULL,
+                                 NULL, 0));
+    ctx->conn_.checkStatementError(r, tagged_statements[GET_VERSION]);
 
     istringstream tmp;
     uint32_t version;
@@ -1413,12 +1904,20 @@ PgSqlLeaseMgr::getVersion() const {
 
 void
 PgSqlLeaseMgr::commit() {
-    conn_.commit();
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
+    ctx->conn_.commit();
 }
 
 void
 PgSqlLeaseMgr::rollback() {
-    conn_.rollback();
+    // Get a context
+    PgSqlLeaseContextAlloc get_context(pool_);
+    PgSqlLeaseContextPtr ctx = get_context.ctx_;
+
+    ctx->conn_.rollback();
 }
 
 }; // end of isc::dhcp namespace
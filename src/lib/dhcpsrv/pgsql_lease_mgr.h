@@ -8,11 +8,13 @@
 #define PGSQL_LEASE_MGR_H
 
 #include <dhcp/hwaddr.h>
+#include <dhcpsrv/database_context_pool.h>
 #include <dhcpsrv/lease_mgr.h>
 #include <dhcpsrv/pgsql_connection.h>
 #include <dhcpsrv/pgsql_exchange.h>
 
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/utility.hpp>
 
 #include <vector>
@@ -25,6 +27,45 @@ namespace dhcp {
 class PgSqlLease4Exchange;
 class PgSqlLease6Exchange;
 
+/// @brief PostgreSQL Lease Context
+///
+/// This class holds the connection to the database, its prepared statements
+/// and the exchange objects. They can only be used by one thread at a time,
+/// so the lease manager keeps a pool of the contexts and each operation
+/// takes one context from the pool.
+class PgSqlLeaseContext : public boost::noncopyable {
+public:
+
+    /// @brief Constructor
+    ///
+    /// The connection is not opened by the constructor.
+    ///
+    /// @param parameters See PgSqlLeaseMgr constructor.
+    PgSqlLeaseContext(const DatabaseConnection::ParameterMap& parameters);
+
+    /// @brief Destructor
+    ~PgSqlLeaseContext();
+
+    /// The exchange objects are used for transfer of data to/from the database.
+    /// They are pointed-to objects as the contents may change in "const" calls,
+    /// while the rest of this object does not.  (At alternative would be to
+    /// declare them as "mutable".)
+    boost::scoped_ptr<PgSqlLease4Exchange> exchange4_; ///< Exchange object
+    boost::scoped_ptr<PgSqlLease6Exchange> exchange6_; ///< Exchange object
+
+    /// PostgreSQL connection handle
+    PgSqlConnection conn_;
+};
+
+/// @brief Type of pointers to contexts.
+typedef boost::shared_ptr<PgSqlLeaseContext> PgSqlLeaseContextPtr;
+
+/// @brief Type of the pool of contexts.
+typedef DatabaseContextPool<PgSqlLeaseContext> PgSqlLeaseContextPool;
+
+/// @brief Type of the object taking a context from the pool.
+typedef PgSqlLeaseContextPool::ContextAlloc PgSqlLeaseContextAlloc;
+
 /// @brief PostgreSQL Lease Manager
 ///
 /// This class provides the \ref isc::dhcp::LeaseMgr interface to the PostgreSQL
@@ -41,6 +82,9 @@ public:
     /// - host - Host to which to connect (optional, defaults to "localhost")
     /// - user - Username under which to connect (optional)
     /// - password - Password for "user" on the database (optional)
+    /// - max-connections - Maximum number of connections opened by the
+    ///   lease manager (optional, defaults to the number of processors
+    ///   plus one)
     ///
     /// If the database is successfully opened, the version number in the
     /// schema_version table will be checked against hard-coded value in
@@ -85,6 +129,34 @@ public:
     ///        failed.
     virtual bool addLease(const Lease6Ptr& lease);
 
+    /// @brief Adds multiple IPv4 leases
+    ///
+    /// The leases are added with a single statement. The leases which
+    /// can't be added because a lease with the same address already exists
+    /// are skipped.
+    ///
+    /// @param leases Collection of leases to be added.
+    ///
+    /// @return Number of leases added.
+    ///
+    /// @throw isc::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    virtual size_t addLeases(const Lease4Collection& leases);
+
+    /// @brief Adds multiple IPv6 leases
+    ///
+    /// The leases are added with a single statement. The leases which
+    /// can't be added because a lease with the same address already exists
+    /// are skipped.
+    ///
+    /// @param leases Collection of leases to be added.
+    ///
+    /// @return Number of leases added.
+    ///
+    /// @throw isc::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    virtual size_t addLeases(const Lease6Collection& leases);
+
     /// @brief Returns an IPv4 lease for specified IPv4 address
     ///
     /// This method return a lease that is associated with a given address.
@@ -295,6 +367,45 @@ public:
     ///        failed.
     virtual bool deleteLease(const isc::asiolink::IOAddress& addr);
 
+    /// @brief Updates multiple IPv4 leases.
+    ///
+    /// The leases are updated with a single statement.
+    ///
+    /// @param leases Collection of leases to be updated.
+    ///
+    /// @throw isc::dhcp::NoSuchLease Attempt to update a lease that did not
+    ///        exist. None of the leases is updated in this case.
+    /// @throw isc::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    virtual void updateLeases4(const Lease4Collection& leases);
+
+    /// @brief Updates multiple IPv6 leases.
+    ///
+    /// The leases are updated with a single statement.
+    ///
+    /// @param leases Collection of leases to be updated.
+    ///
+    /// @throw isc::dhcp::NoSuchLease Attempt to update a lease that did not
+    ///        exist. None of the leases is updated in this case.
+    /// @throw isc::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    virtual void updateLeases6(const Lease6Collection& leases);
+
+    /// @brief Deletes multiple leases.
+    ///
+    /// The leases are deleted within a single transaction, with one
+    /// statement for the IPv4 and one for the IPv6 addresses.
+    ///
+    /// @param addrs Addresses of the leases to be deleted.  These can be IPv4
+    ///              or IPv6 addresses.
+    ///
+    /// @return Number of leases deleted.
+    ///
+    /// @throw isc::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    virtual size_t
+    deleteLeases(const std::vector<isc::asiolink::IOAddress>& addrs);
+
     /// @brief Deletes all expired-reclaimed DHCPv4 leases.
     ///
     /// @param secs Number of seconds since expiration of leases before
@@ -336,9 +447,7 @@ public:
     /// @brief Removes specified IPv4 leases.
     ///
     /// This rather dangerous method is able to remove all leases from specified
-    /// subnet.
-    ///
-    /// @todo: Not implemented yet.
+    /// subnet. The leases are removed with a single statement.
     ///
     /// @param subnet_id identifier of the subnet
     /// @return number of leases removed.
@@ -347,9 +456,7 @@ public:
     /// @brief Removed specified IPv6 leases.
     ///
     /// This rather dangerous method is able to remove all leases from specified
-    /// subnet.
-    ///
-    /// @todo: Not implemented yet.
+    /// subnet. The leases are removed with a single statement.
     ///
     /// @param subnet_id identifier of the subnet
     /// @return number of leases removed.
@@ -405,9 +512,13 @@ public:
     /// statements
     enum StatementIndex {
         DELETE_LEASE4,              // Delete from lease4 by address
+        DELETE_LEASE4_BATCH,        // Delete from lease4 by addresses
         DELETE_LEASE4_STATE_EXPIRED,// Delete expired lease4s in certain state.
+        DELETE_LEASE4_SUBNET_ID,    // Delete lease4s by subnet ID
         DELETE_LEASE6,              // Delete from lease6 by address
+        DELETE_LEASE6_BATCH,        // Delete from lease6 by addresses
         DELETE_LEASE6_STATE_EXPIRED,// Delete expired lease6s in certain state.
+        DELETE_LEASE6_SUBNET_ID,    // Delete lease6s by subnet ID
         GET_LEASE4_ADDR,            // Get lease4 by address
         GET_LEASE4_CLIENTID,        // Get lease4 by client ID
         GET_LEASE4_CLIENTID_SUBID,  // Get lease4 by client ID & subnet ID
@@ -420,9 +531,13 @@ public:
         GET_LEASE6_EXPIRE,          // Get expired lease6
         GET_VERSION,                // Obtain version number
         INSERT_LEASE4,              // Add entry to lease4 table
+        INSERT_LEASE4_BATCH,        // Add entries to lease4 table
         INSERT_LEASE6,              // Add entry to lease6 table
+        INSERT_LEASE6_BATCH,        // Add entries to lease6 table
         UPDATE_LEASE4,              // Update a Lease4 entry
+        UPDATE_LEASE4_BATCH,        // Update Lease4 entries
         UPDATE_LEASE6,              // Update a Lease6 entry
+        UPDATE_LEASE6_BATCH,        // Update Lease6 entries
         RECOUNT_LEASE4_STATS,       // Fetch IPv4 lease statistical data
         RECOUNT_LEASE6_STATS,       // Fetch IPv4 lease statistical data
         NUM_STATEMENTS              // Number of statements
@@ -436,6 +551,7 @@ private:
     /// of the addLease method.  It binds the contents of the lease object to
     /// the prepared statement and adds it to the database.
     ///
+    /// @param ctx Context taken from the pool
     /// @param stindex Index of statement being executed
     /// @param bind_array array that has been created for the type
     ///        of lease in question.
@@ -445,13 +561,53 @@ private:
     ///
     /// @throw isc::dhcp::DbOperationError An operation on the open database has
     ///        failed.
-    bool addLeaseCommon(StatementIndex stindex, PsqlBindArray& bind_array);
+    bool addLeaseCommon(PgSqlLeaseContextPtr& ctx, StatementIndex stindex,
+                        PsqlBindArray& bind_array);
+
+    /// @brief Adds an IPv4 lease using the specified context.
+    ///
+    /// @param ctx Context taken from the pool
+    /// @param lease lease to be added
+    ///
+    /// @return true if the lease was added, false if a lease with the same
+    ///         address already exists in the database.
+    bool addLeaseInternal(PgSqlLeaseContextPtr& ctx, const Lease4Ptr& lease);
+
+    /// @brief Adds an IPv6 lease using the specified context.
+    ///
+    /// @param ctx Context taken from the pool
+    /// @param lease lease to be added
+    ///
+    /// @return true if the lease was added, false if a lease with the same
+    ///         address already exists in the database.
+    bool addLeaseInternal(PgSqlLeaseContextPtr& ctx, const Lease6Ptr& lease);
+
+    /// @brief Add multiple leases common code
+    ///
+    /// Adds the leases with a single statement which takes the columns of
+    /// the leases as arrays. The leases which already exist are skipped.
+    /// If the statement fails on the duplicate entry, e.g. because the
+    /// same lease is added concurrently, the leases are added one by one.
+    ///
+    /// @param ctx Context taken from the pool
+    /// @param stindex Index of the batch statement being executed
+    /// @param exchange Exchange object to use
+    /// @param leases Collection of leases to be added.
+    ///
+    /// @tparam Exchange Pointer to the exchange object.
+    /// @tparam LeaseCollection A @c Lease4Collection or @c Lease6Collection.
+    ///
+    /// @return Number of leases added.
+    template <typename Exchange, typename LeaseCollection>
+    size_t addLeasesCommon(PgSqlLeaseContextPtr& ctx, StatementIndex stindex,
+                           Exchange& exchange, const LeaseCollection& leases);
 
     /// @brief Get Lease Collection Common Code
     ///
     /// This method performs the common actions for obtaining multiple leases
     /// from the database.
     ///
+    /// @param ctx Context taken from the pool
     /// @param stindex Index of statement being executed
     /// @param bind_array array containing the where clause input parameters
     /// @param exchange Exchange object to use
@@ -468,7 +624,8 @@ private:
     /// @throw isc::dhcp::MultipleRecords Multiple records were retrieved
     ///        from the database where only one was expected.
     template <typename Exchange, typename LeaseCollection>
-    void getLeaseCollection(StatementIndex stindex, PsqlBindArray& bind_array,
+    void getLeaseCollection(PgSqlLeaseContextPtr& ctx,
+                            StatementIndex stindex, PsqlBindArray& bind_array,
                             Exchange& exchange, LeaseCollection& result,
                             bool single = false) const;
 
@@ -477,6 +634,7 @@ private:
     /// Gets a collection of Lease4 objects.  This is just an interface to
     /// the get lease collection common code.
     ///
+    /// @param ctx Context taken from the pool
     /// @param stindex Index of statement being executed
     /// @param bind_array array containing the where clause input parameters
     /// @param lease LeaseCollection object returned.  Note that any leases in
@@ -488,9 +646,10 @@ private:
     ///        failed.
     /// @throw isc::dhcp::MultipleRecords Multiple records were retrieved
     ///        from the database where only one was expected.
-    void getLeaseCollection(StatementIndex stindex, PsqlBindArray& bind_array,
+    void getLeaseCollection(PgSqlLeaseContextPtr& ctx,
+                            StatementIndex stindex, PsqlBindArray& bind_array,
                             Lease4Collection& result) const {
-        getLeaseCollection(stindex, bind_array, exchange4_, result);
+        getLeaseCollection(ctx, stindex, bind_array, ctx->exchange4_, result);
     }
 
     /// @brief Get Lease6 Collection
@@ -498,6 +657,7 @@ private:
     /// Gets a collection of Lease6 objects.  This is just an interface to
     /// the get lease collection common code.
     ///
+    /// @param ctx Context taken from the pool
     /// @param stindex Index of statement being executed
     /// @param bind_array array containing input parameters for the query
     /// @param lease LeaseCollection object returned.  Note that any existing
@@ -508,9 +668,10 @@ private:
     ///        failed.
     /// @throw isc::dhcp::MultipleRecords Multiple records were retrieved
     ///        from the database where only one was expected.
-    void getLeaseCollection(StatementIndex stindex, PsqlBindArray& bind_array,
+    void getLeaseCollection(PgSqlLeaseContextPtr& ctx,
+                            StatementIndex stindex, PsqlBindArray& bind_array,
                             Lease6Collection& result) const {
-        getLeaseCollection(stindex, bind_array, exchange6_, result);
+        getLeaseCollection(ctx, stindex, bind_array, ctx->exchange6_, result);
     }
 
     /// @brief Get Lease4 Common Code
@@ -519,10 +680,12 @@ private:
     /// methods.  It acts as an interface to the getLeaseCollection() method,
     /// but retrieving only a single lease.
     ///
+    /// @param ctx Context taken from the pool
     /// @param stindex Index of statement being executed
     /// @param bind_array array containing input parameters for the query
     /// @param lease Lease4 object returned
-    void getLease(StatementIndex stindex, PsqlBindArray& bind_array,
+    void getLease(PgSqlLeaseContextPtr& ctx,
+                  StatementIndex stindex, PsqlBindArray& bind_array,
                   Lease4Ptr& result) const;
 
     /// @brief Get Lease6 Common Code
@@ -531,10 +694,12 @@ private:
     /// methods.  It acts as an interface to the getLeaseCollection() method,
     /// but retrieving only a single lease.
     ///
+    /// @param ctx Context taken from the pool
     /// @param stindex Index of statement being executed
     /// @param bind_array array containing input parameters for the query
     /// @param lease Lease6 object returned
-    void getLease(StatementIndex stindex, PsqlBindArray& bind_array,
+    void getLease(PgSqlLeaseContextPtr& ctx,
+                  StatementIndex stindex, PsqlBindArray& bind_array,
                   Lease6Ptr& result) const;
 
     /// @brief Get expired leases common code.
@@ -544,6 +709,7 @@ private:
     /// time. The maximum number of leases to be returned is specified
     /// as an argument.
     ///
+    /// @param ctx Context taken from the pool
     /// @param [out] expired_leases Reference to the container where the
     ///        retrieved leases are put.
     /// @param max_leases Maximum number of leases to be returned.
@@ -552,7 +718,8 @@ private:
     ///
     /// @tparam One of the @c Lease4Collection or @c Lease6Collection.
     template<typename LeaseCollection>
-    void getExpiredLeasesCommon(LeaseCollection& expired_leases,
+    void getExpiredLeasesCommon(PgSqlLeaseContextPtr& ctx,
+                                LeaseCollection& expired_leases,
                                 const size_t max_leases,
                                 StatementIndex statement_index) const;
 
@@ -562,6 +729,7 @@ private:
     /// to the prepared statement, executes it, then checks how many rows
     /// were affected.
     ///
+    /// @param ctx Context taken from the pool
     /// @param stindex Index of prepared statement to be executed
     /// @param bind_array array containing lease values and where clause
     /// parameters for the update.
@@ -572,15 +740,52 @@ private:
     /// @throw isc::dhcp::DbOperationError An operation on the open database has
     ///        failed.
     template <typename LeasePtr>
-    void updateLeaseCommon(StatementIndex stindex, PsqlBindArray& bind_array,
+    void updateLeaseCommon(PgSqlLeaseContextPtr& ctx,
+                           StatementIndex stindex, PsqlBindArray& bind_array,
                            const LeasePtr& lease);
 
+    /// @brief Update multiple leases common code
+    ///
+    /// Updates the leases with a single statement which takes the columns
+    /// of the leases as arrays.
+    ///
+    /// @param ctx Context taken from the pool
+    /// @param stindex Index of the batch statement being executed
+    /// @param exchange Exchange object to use
+    /// @param leases Collection of leases to be updated.
+    ///
+    /// @tparam Exchange Pointer to the exchange object.
+    /// @tparam LeaseCollection A @c Lease4Collection or @c Lease6Collection.
+    ///
+    /// @throw isc::dhcp::NoSuchLease Some of the leases don't exist. None
+    ///        of the leases is updated in this case.
+    /// @throw isc::dhcp::DbOperationError An operation on the open database has
+    ///        failed.
+    template <typename Exchange, typename LeaseCollection>
+    void updateLeasesCommon(PgSqlLeaseContextPtr& ctx, StatementIndex stindex,
+                            Exchange& exchange, const LeaseCollection& leases);
+
+    /// @brief Updates an IPv4 lease using the specified context.
+    ///
+    /// @param ctx Context taken from the pool
+    /// @param lease The lease to be updated.
+    void updateLease4Internal(PgSqlLeaseContextPtr& ctx,
+                              const Lease4Ptr& lease);
+
+    /// @brief Updates an IPv6 lease using the specified context.
+    ///
+    /// @param ctx Context taken from the pool
+    /// @param lease The lease to be updated.
+    void updateLease6Internal(PgSqlLeaseContextPtr& ctx,
+                              const Lease6Ptr& lease);
+
     /// @brief Delete lease common code
     ///
     /// Holds the common code for deleting a lease.  It binds the parameters
     /// to the prepared statement, executes the statement and checks to
     /// see how many rows were deleted.
     ///
+    /// @param ctx Context taken from the pool
     /// @param stindex Index of prepared statement to be executed
     /// @param bind_array array containing lease values and where clause
     /// parameters for the delete
@@ -589,11 +794,34 @@ private:
     ///
     /// @throw isc::dhcp::DbOperationError An operation on the open database has
     ///        failed.
-    uint64_t deleteLeaseCommon(StatementIndex stindex,
+    uint64_t deleteLeaseCommon(PgSqlLeaseContextPtr& ctx,
+                               StatementIndex stindex,
                                PsqlBindArray& bind_array);
 
+    /// @brief Deletes a lease using the specified context.
+    ///
+    /// @param ctx Context taken from the pool
+    /// @param addr Address of the lease to be deleted.
+    ///
+    /// @return true if deletion was successful, false if no such lease exists
+    bool deleteLeaseInternal(PgSqlLeaseContextPtr& ctx,
+                             const isc::asiolink::IOAddress& addr);
+
+    /// @brief Deletes the leases belonging to the subnet.
+    ///
+    /// @param ctx Context taken from the pool
+    /// @param subnet_id Identifier of the subnet.
+    /// @param statement_index One of the @c DELETE_LEASE4_SUBNET_ID or
+    ///        @c DELETE_LEASE6_SUBNET_ID.
+    ///
+    /// @return Number of leases deleted.
+    uint64_t wipeLeasesCommon(PgSqlLeaseContextPtr& ctx,
+                              const SubnetID& subnet_id,
+                              StatementIndex statement_index);
+
     /// @brief Delete expired-reclaimed leases.
     ///
+    /// @param ctx Context taken from the pool
     /// @param secs Number of seconds since expiration of leases before
     /// they can be removed. Leases which have expired later than this
     /// time will not be deleted.
@@ -601,18 +829,28 @@ private:
     ///        @c DELETE_LEASE6_STATE_EXPIRED.
     ///
     /// @return Number of leases deleted.
-    uint64_t deleteExpiredReclaimedLeasesCommon(const uint32_t secs,
+    uint64_t deleteExpiredReclaimedLeasesCommon(PgSqlLeaseContextPtr& ctx,
+                                                const uint32_t secs,
                                                 StatementIndex statement_index);
 
-    /// The exchange objects are used for transfer of data to/from the database.
-    /// They are pointed-to objects as the contents may change in "const" calls,
-    /// while the rest of this object does not.  (At alternative would be to
-    /// declare them as "mutable".)
-    boost::scoped_ptr<PgSqlLease4Exchange> exchange4_; ///< Exchange object
-    boost::scoped_ptr<PgSqlLease6Exchange> exchange6_; ///< Exchange object
+    /// @brief Creates a new context.
+    ///
+    /// Opens the connection to the database and prepares the statements.
+    ///
+    /// @param parameters See PgSqlLeaseMgr constructor.
+    ///
+    /// @return Pointer to the new context.
+    /// @throw isc::dhcp::DbOpenError Error opening the database
+    static PgSqlLeaseContextPtr
+    createContext(const DatabaseConnection::ParameterMap& parameters);
 
-    /// PostgreSQL connection handle
-    PgSqlConnection conn_;
+    /// @brief Database access parameters
+    DatabaseConnection::ParameterMap parameters_;
+
+    /// @brief Pool of contexts.
+    ///
+    /// It is mutable because contexts are taken from it in "const" calls.
+    mutable PgSqlLeaseContextPool pool_;
 };
 
 }; // end of isc::dhcp namespace
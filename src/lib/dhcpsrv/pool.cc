@@ -7,6 +7,7 @@
 #include <asiolink/io_address.h>
 #include <dhcpsrv/addr_utilities.h>
 #include <dhcpsrv/pool.h>
+#include <util/threads/multi_threading_mgr.h>
 #include <sstream>
 
 using namespace isc::asiolink;
@@ -35,7 +36,8 @@ Pool::toText() const {
 
 Pool4::Pool4(const isc::asiolink::IOAddress& first,
              const isc::asiolink::IOAddress& last)
-:Pool(Lease::TYPE_V4, first, last) {
+:Pool(Lease::TYPE_V4, first, last), usage_bitmap_(),
+ usage_mutex_(new isc::util::thread::Mutex()) {
     // check if specified address boundaries are sane
     if (!first.isV4() || !last.isV4()) {
         isc_throw(BadValue, "Invalid Pool4 address boundaries: not IPv4");
@@ -53,7 +55,8 @@ Pool4::Pool4(const isc::asiolink::IOAddress& first,
 }
 
 Pool4::Pool4( const isc::asiolink::IOAddress& prefix, uint8_t prefix_len)
-:Pool(Lease::TYPE_V4, prefix, IOAddress("0.0.0.0")) {
+:Pool(Lease::TYPE_V4, prefix, IOAddress("0.0.0.0")), usage_bitmap_(),
+ usage_mutex_(new isc::util::thread::Mutex()) {
 
     // check if the prefix is sane
     if (!prefix.isV4()) {
@@ -114,6 +117,49 @@ Pool4::toElement() const {
     return (map);
 }
 
+PoolBitmapPtr
+Pool4::getUsageBitmap() const {
+    isc::util::thread::MultiThreadingLock lock(*usage_mutex_);
+    return (usage_bitmap_);
+}
+
+void
+Pool4::setUsageBitmap(const PoolBitmapPtr& bitmap) {
+    if (bitmap && (bitmap->getSize() != capacity_)) {
+        isc_throw(BadValue, "size of the usage bitmap " << bitmap->getSize()
+                  << " doesn't match the capacity " << capacity_
+                  << " of the pool " << toText());
+    }
+    isc::util::thread::MultiThreadingLock lock(*usage_mutex_);
+    usage_bitmap_ = bitmap;
+}
+
+void
+Pool4::markAddressUsed(const isc::asiolink::IOAddress& addr,
+                       const bool used) {
+    isc::util::thread::MultiThreadingLock lock(*usage_mutex_);
+    if (usage_bitmap_ && inRange(addr)) {
+        usage_bitmap_->setUsed(addr.toUint32() - first_.toUint32(), used);
+    }
+}
+
+bool
+Pool4::findFreeAddress(const isc::asiolink::IOAddress& start,
+                       isc::asiolink::IOAddress& addr) const {
+    isc::util::thread::MultiThreadingLock lock(*usage_mutex_);
+    if (!usage_bitmap_) {
+        return (false);
+    }
+    uint64_t offset = 0;
+    if (inRange(start)) {
+        offset = start.toUint32() - first_.toUint32();
+    }
+    if (!usage_bitmap_->findFree(offset, offset)) {
+        return (false);
+    }
+    addr = IOAddress(first_.toUint32() + static_cast<uint32_t>(offset));
+    return (true);
+}
 
 Pool6::Pool6(Lease::Type type, const isc::asiolink::IOAddress& first,
              const isc::asiolink::IOAddress& last)
@@ -13,6 +13,8 @@
 #include <cc/data.h>
 #include <dhcpsrv/cfg_option.h>
 #include <dhcpsrv/lease.h>
+#include <dhcpsrv/pool_bitmap.h>
+#include <util/threads/sync.h>
 #include <boost/shared_ptr.hpp>
 
 #include <vector>
@@ -192,6 +194,57 @@ public:
     ///
     /// @return A pointer to unparsed Pool4 configuration.
     virtual data::ElementPtr toElement() const;
+
+    /// @brief Returns the bitmap holding the usage of the pool addresses.
+    ///
+    /// The bitmap is created and populated by the allocation engine when
+    /// it first allocates an address from this pool. From then on, it is
+    /// kept up to date by the allocation engine.
+    ///
+    /// In the multi-threading mode the bitmap is accessed through
+    /// @ref markAddressUsed and @ref findFreeAddress which serialize the
+    /// access to it. The bitmap is then only a hint: the lease database
+    /// remains the authority on whether an address is leased.
+    ///
+    /// @return Pointer to the bitmap or NULL if it hasn't been created.
+    PoolBitmapPtr getUsageBitmap() const;
+
+    /// @brief Sets the bitmap holding the usage of the pool addresses.
+    ///
+    /// @param bitmap Pointer to the bitmap. Its size must be equal to
+    /// the pool capacity.
+    /// @throw BadValue if the bitmap size doesn't match the pool capacity.
+    void setUsageBitmap(const PoolBitmapPtr& bitmap);
+
+    /// @brief Marks an address as used or free in the usage bitmap.
+    ///
+    /// This method is no-op if the bitmap hasn't been created or the
+    /// address doesn't belong to the pool.
+    ///
+    /// @param addr Address which usage has changed.
+    /// @param used Boolean value indicating if there is a lease for the
+    /// address (if true) or not (if false).
+    void markAddressUsed(const isc::asiolink::IOAddress& addr,
+                         const bool used);
+
+    /// @brief Finds the first free address in the pool using the bitmap.
+    ///
+    /// @param start Address at which the search should start. If it doesn't
+    /// belong to the pool, the search starts at the first address.
+    /// @param [out] addr Free address found.
+    /// @return true if the free address has been found, false if all
+    /// addresses between the start address and the end of the pool are
+    /// used or the bitmap hasn't been created.
+    bool findFreeAddress(const isc::asiolink::IOAddress& start,
+                         isc::asiolink::IOAddress& addr) const;
+
+private:
+
+    /// @brief Bitmap holding the usage of the pool addresses.
+    PoolBitmapPtr usage_bitmap_;
+
+    /// @brief Mutex protecting the bitmap in the multi-threading mode.
+    boost::shared_ptr<isc::util::thread::Mutex> usage_mutex_;
 };
 
 /// @brief a pointer an IPv4 Pool
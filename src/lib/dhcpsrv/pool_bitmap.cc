@@ -0,0 +1,100 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <dhcpsrv/pool_bitmap.h>
+
+namespace {
+
+/// @brief Number of bits in a single bitmap word.
+const uint64_t WORD_BITS = 64;
+
+/// @brief Returns the index of the least significant bit set in a word.
+///
+/// @param word Non-zero word.
+unsigned int
+lowestBitSet(uint64_t word) {
+#if defined(__GNUC__)
+    return (static_cast<unsigned int>(__builtin_ctzll(word)));
+#else
+    unsigned int bit = 0;
+    while ((word & 1) == 0) {
+        word >>= 1;
+        ++bit;
+    }
+    return (bit);
+#endif
+}
+
+}
+
+namespace isc {
+namespace dhcp {
+
+PoolBitmap::PoolBitmap(const uint64_t size)
+    : size_(size), used_(0), words_((size + WORD_BITS - 1) / WORD_BITS, 0) {
+}
+
+bool
+PoolBitmap::isUsed(const uint64_t offset) const {
+    if (offset >= size_) {
+        return (true);
+    }
+    return ((words_[offset / WORD_BITS] &
+             (static_cast<uint64_t>(1) << (offset % WORD_BITS))) != 0);
+}
+
+void
+PoolBitmap::setUsed(const uint64_t offset, const bool used) {
+    if (offset >= size_) {
+        return;
+    }
+    uint64_t& word = words_[offset / WORD_BITS];
+    const uint64_t mask = static_cast<uint64_t>(1) << (offset % WORD_BITS);
+    if (used && ((word & mask) == 0)) {
+        word |= mask;
+        ++used_;
+
+    } else if (!used && ((word & mask) != 0)) {
+        word &= ~mask;
+        --used_;
+    }
+}
+
+bool
+PoolBitmap::findFree(const uint64_t start, uint64_t& offset) const {
+    if ((start >= size_) || (used_ >= size_)) {
+        return (false);
+    }
+
+    uint64_t index = start / WORD_BITS;
+    const uint64_t last_index = (size_ - 1) / WORD_BITS;
+
+    // Bits below the starting offset in the first word must be skipped,
+    // so they are reported as used.
+    uint64_t free_bits = ~words_[index] &
+        (~static_cast<uint64_t>(0) << (start % WORD_BITS));
+
+    for (;;) {
+        if (free_bits != 0) {
+            // The unused bits of the last word are never set, so they
+            // have to be excluded here.
+            const uint64_t found = index * WORD_BITS + lowestBitSet(free_bits);
+            if (found < size_) {
+                offset = found;
+                return (true);
+            }
+            return (false);
+        }
+        if (index == last_index) {
+            break;
+        }
+        free_bits = ~words_[++index];
+    }
+    return (false);
+}
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
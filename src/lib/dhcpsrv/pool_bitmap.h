@@ -0,0 +1,88 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef POOL_BITMAP_H
+#define POOL_BITMAP_H
+
+#include <boost/shared_ptr.hpp>
+#include <stdint.h>
+#include <vector>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Bitmap holding the usage state of the addresses in a pool.
+///
+/// Each bit of the bitmap corresponds to one address of the pool, i.e.
+/// the bit at offset 0 represents the first address of the pool, the bit
+/// at offset 1 represents the second address etc. A bit is set when there
+/// is a lease for the corresponding address in the lease database.
+///
+/// The bits are stored in 64-bit words, so searching for a free address
+/// examines 64 addresses at a time, rather than probing the lease database
+/// for each candidate address.
+class PoolBitmap {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// Creates a bitmap with all addresses marked as free.
+    ///
+    /// @param size Number of addresses represented by the bitmap.
+    explicit PoolBitmap(const uint64_t size);
+
+    /// @brief Returns the number of addresses represented by the bitmap.
+    uint64_t getSize() const {
+        return (size_);
+    }
+
+    /// @brief Returns the number of addresses marked as used.
+    uint64_t getUsedCount() const {
+        return (used_);
+    }
+
+    /// @brief Checks if the address at the specified offset is used.
+    ///
+    /// @param offset Offset of the address from the beginning of the pool.
+    /// @return true if the address is used or the offset is out of range.
+    bool isUsed(const uint64_t offset) const;
+
+    /// @brief Marks the address at the specified offset as used or free.
+    ///
+    /// This method is no-op if the offset is out of range.
+    ///
+    /// @param offset Offset of the address from the beginning of the pool.
+    /// @param used Boolean value indicating if the address should be marked
+    /// as used (if true) or free (if false).
+    void setUsed(const uint64_t offset, const bool used = true);
+
+    /// @brief Finds the first free address at or after the specified offset.
+    ///
+    /// @param start Offset at which the search should start.
+    /// @param [out] offset Offset of the free address found.
+    /// @return true if a free address has been found, false if all addresses
+    /// between the start offset and the end of the bitmap are used.
+    bool findFree(const uint64_t start, uint64_t& offset) const;
+
+private:
+
+    /// @brief Number of addresses represented by the bitmap.
+    uint64_t size_;
+
+    /// @brief Number of bits set.
+    uint64_t used_;
+
+    /// @brief Bitmap words.
+    std::vector<uint64_t> words_;
+};
+
+/// @brief Pointer to the @c PoolBitmap.
+typedef boost::shared_ptr<PoolBitmap> PoolBitmapPtr;
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
+
+#endif // POOL_BITMAP_H
@@ -29,19 +29,6 @@ prefixLessThanFirstAddress(const IOAddress& prefix, const PoolPtr& pool) {
     return (prefix < pool->getFirstAddress());
 }
 
-/// @brief Function used in calls to std::sort to compare first
-/// prefixes of the two pools.
-///
-/// @param pool1 First pool.
-/// @param pool2 Second pool.
-///
-/// @return true if first prefix of the first pool is smaller than
-/// the first address of the second pool.
-bool
-comparePoolFirstAddress(const PoolPtr& pool1, const PoolPtr& pool2) {
-    return (pool1->getFirstAddress() < pool2->getFirstAddress());
-};
-
 }
 
 namespace isc {
@@ -72,6 +59,17 @@ Subnet::inRange(const isc::asiolink::IOAddress& addr) const {
     return ((first <= addr) && (addr <= last));
 }
 
+void
+Subnet::setAllocatorType(const std::string& allocator_type) {
+    if (!allocator_type.empty() && (allocator_type != "iterative") &&
+        (allocator_type != "random") && (allocator_type != "hashed")) {
+        isc_throw(BadValue, "unsupported allocator '" << allocator_type
+                  << "' specified for subnet " << toText()
+                  << ", expected one of: iterative, random, hashed");
+    }
+    allocator_type_ = allocator_type;
+}
+
 isc::asiolink::IOAddress Subnet::getLastAllocated(Lease::Type type) const {
     // check if the type is valid (and throw if it isn't)
     checkType(type);
@@ -285,23 +283,9 @@ const PoolPtr Subnet::getPool(Lease::Type type, const isc::asiolink::IOAddress&
     PoolPtr candidate;
 
     if (!pools.empty()) {
-        // Pools are sorted by their first prefixes. For example: 2001::,
-        // 2001::db8::, 3000:: etc. If our hint is 2001:db8:5:: we want to
-        // find the pool with the longest matching prefix, so: 2001:db8::,
-        // rather than 2001::. upper_bound returns the first pool with a prefix
-        // that is greater than 2001:db8:5::, i.e. 3000::. To find the longest
-        // matching prefix we use decrement operator to go back by one item.
-        // If returned iterator points to begin it means that prefixes in all
-        // pools are greater than out prefix, and thus there is no match.
-        PoolCollection::const_iterator ub =
-            std::upper_bound(pools.begin(), pools.end(), hint,
-                             prefixLessThanFirstAddress);
-
-        if (ub != pools.begin()) {
-            --ub;
-            if ((*ub)->inRange(hint)) {
-                candidate = *ub;
-            }
+        PoolCollection::const_iterator pool = findPool(type, hint);
+        if (pool != pools.end()) {
+            candidate = *pool;
         }
 
         // If we don't find anything better, then let's just use the first pool
@@ -314,6 +298,33 @@ const PoolPtr Subnet::getPool(Lease::Type type, const isc::asiolink::IOAddress&
     return (candidate);
 }
 
+PoolCollection::const_iterator
+Subnet::findPool(Lease::Type type, const isc::asiolink::IOAddress& addr) const {
+    const PoolCollection& pools = getPools(type);
+
+    // Pools are sorted by their first prefixes. For example: 2001::,
+    // 2001::db8::, 3000:: etc. If our hint is 2001:db8:5:: we want to
+    // find the pool with the longest matching prefix, so: 2001:db8::,
+    // rather than 2001::. upper_bound returns the first pool with a prefix
+    // that is greater than 2001:db8:5::, i.e. 3000::. To find the longest
+    // matching prefix we use decrement operator to go back by one item.
+    // If returned iterator points to begin it means that prefixes in all
+    // pools are greater than out prefix, and thus there is no match.
+    PoolCollection::const_iterator ub =
+        std::upper_bound(pools.begin(), pools.end(), addr,
+                         prefixLessThanFirstAddress);
+
+    if (ub != pools.begin()) {
+        --ub;
+        // The pools don't overlap, so if the address doesn't belong to
+        // this pool, it doesn't belong to any other pool either.
+        if ((*ub)->inRange(addr)) {
+            return (ub);
+        }
+    }
+    return (pools.end());
+}
+
 void
 Subnet::addPool(const PoolPtr& pool) {
     // check if the type is valid (and throw if it isn't)
@@ -361,12 +372,13 @@ Subnet::addPool(const PoolPtr& pool) {
 
     PoolCollection& pools_writable = getPoolsWritable(pool->getType());
 
-    // Add the pool to the appropriate pools collection
-    pools_writable.push_back(pool);
-
-    // Sort pools by first address.
-    std::sort(pools_writable.begin(), pools_writable.end(),
-              comparePoolFirstAddress);
+    // Add the pool to the appropriate pools collection, keeping the pools
+    // sorted by first address. The lookups rely on this order.
+    pools_writable.insert(std::upper_bound(pools_writable.begin(),
+                                           pools_writable.end(),
+                                           pool->getFirstAddress(),
+                                           prefixLessThanFirstAddress),
+                          pool);
 }
 
 void
@@ -382,16 +394,7 @@ Subnet::inPool(Lease::Type type, const isc::asiolink::IOAddress& addr) const {
         return (false);
     }
 
-    const PoolCollection& pools = getPools(type);
-
-    for (PoolCollection::const_iterator pool = pools.begin();
-         pool != pools.end(); ++pool) {
-        if ((*pool)->inRange(addr)) {
-            return (true);
-        }
-    }
-    // There's no pool that address belongs to
-    return (false);
+    return (findPool(type, addr) != getPools(type).end());
 }
 
 bool
@@ -556,6 +559,11 @@ Subnet::toElement() const {
         map->set("user-context", ctx);
     }
 
+    // Add allocator, but only if it overrides the default one.
+    if (!allocator_type_.empty()) {
+        map->set("allocator", Element::create(allocator_type_));
+    }
+
     return (map);
 }
 
@@ -142,6 +142,19 @@ public:
     const PoolPtr getPool(Lease::Type type, const isc::asiolink::IOAddress& addr,
                           bool anypool = true) const;
 
+    /// @brief Finds the pool that the address belongs to.
+    ///
+    /// The pools of each type are kept sorted by their first addresses
+    /// and they don't overlap, so the pool is found with a binary search.
+    ///
+    /// @param type pool type that the pool is looked for
+    /// @param addr address (or prefix) that the pool should cover
+    /// @return iterator pointing to the found pool within the collection
+    ///         returned by @c getPools(type) or the end of that collection
+    ///         if there is no such pool
+    PoolCollection::const_iterator
+    findPool(Lease::Type type, const isc::asiolink::IOAddress& addr) const;
+
     /// @brief Returns a pool without any address specified
     ///
     /// @param type pool type that the pool is looked for
@@ -232,6 +245,23 @@ public:
         return (user_context_);
     }
 
+    /// @brief Returns the name of the allocator used for this subnet.
+    ///
+    /// @return Allocator name ("iterative", "random" or "hashed") or an
+    /// empty string if the allocation engine's default allocator should
+    /// be used.
+    const std::string& getAllocatorType() const {
+        return (allocator_type_);
+    }
+
+    /// @brief Sets the name of the allocator used for this subnet.
+    ///
+    /// @param allocator_type Allocator name ("iterative", "random" or
+    /// "hashed") or an empty string to use the allocation engine's default
+    /// allocator.
+    /// @throw BadValue if the allocator name is not supported.
+    void setAllocatorType(const std::string& allocator_type);
+
 protected:
     /// @brief Returns all pools (non-const variant)
     ///
@@ -365,6 +395,9 @@ protected:
 
     /// @brief Pointer to the user context (may be NULL)
     data::ConstElementPtr user_context_;
+
+    /// @brief Name of the allocator used for this subnet.
+    std::string allocator_type_;
 };
 
 /// @brief A generic pointer to either Subnet4 or Subnet6 object
@@ -0,0 +1,50 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+#include <dhcpsrv/addr_utilities.h>
+#include <dhcpsrv/subnet_prefix_index.h>
+#include <algorithm>
+
+using namespace isc::asiolink;
+
+namespace isc {
+namespace dhcp {
+
+void
+SubnetPrefixIndex::add(const IOAddress& prefix, const uint8_t len,
+                       const size_t position) {
+    // This throws if the length is out of range.
+    IOAddress first = firstAddrInPrefix(prefix, len);
+    prefixes_[len][first].push_back(position);
+}
+
+void
+SubnetPrefixIndex::find(const IOAddress& address,
+                        std::vector<size_t>& positions) const {
+    positions.clear();
+    for (auto prefixes = prefixes_.cbegin(); prefixes != prefixes_.cend();
+         ++prefixes) {
+        // The address family mismatch is not an error: such an address
+        // simply doesn't belong to any of the prefixes.
+        if (address.isV4() && (prefixes->first > 32)) {
+            break;
+        }
+        auto found = prefixes->second.find(firstAddrInPrefix(address,
+                                                             prefixes->first));
+        if (found != prefixes->second.end()) {
+            positions.insert(positions.end(), found->second.begin(),
+                             found->second.end());
+        }
+    }
+
+    // Multiple prefixes may include the address. The caller walks them
+    // in the configuration order.
+    std::sort(positions.begin(), positions.end());
+}
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
@@ -0,0 +1,85 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef SUBNET_PREFIX_INDEX_H
+#define SUBNET_PREFIX_INDEX_H
+
+#include <asiolink/io_address.h>
+#include <boost/unordered_map.hpp>
+#include <map>
+#include <stdint.h>
+#include <vector>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Index of prefixes used for the subnet selection.
+///
+/// The subnet selection by address must find all subnets which prefixes
+/// include the address and return the first of them in the configuration
+/// order which the client is allowed to use. The subnets are typically
+/// not nested, but the configuration may contain overlapping prefixes,
+/// e.g. 10.0.0.0/8 and 10.1.0.0/16.
+///
+/// This index groups the prefixes by their length. For each length
+/// present in the configuration the prefixes are held in a hash table
+/// keyed by the first address of the prefix. The lookup masks the
+/// searched address with each length and checks the corresponding
+/// table, so its cost depends on the number of distinct prefix lengths
+/// (at most 33 for IPv4 and 129 for IPv6) rather than on the number of
+/// subnets.
+///
+/// The index doesn't hold the subnets but their positions in the
+/// configuration. The caller is responsible for rebuilding the index
+/// when the order of the subnets changes.
+class SubnetPrefixIndex {
+public:
+
+    /// @brief Adds a prefix to the index.
+    ///
+    /// @param prefix Prefix. It doesn't need to be the first address of
+    /// the prefix, e.g. 10.0.0.5/24 is indexed as 10.0.0.0/24.
+    /// @param len Prefix length.
+    /// @param position Position of the subnet in the configuration.
+    ///
+    /// @throw isc::BadValue if the prefix length is invalid.
+    void add(const asiolink::IOAddress& prefix, const uint8_t len,
+             const size_t position);
+
+    /// @brief Finds all prefixes including the specified address.
+    ///
+    /// @param address Address to be matched with the prefixes.
+    /// @param [out] positions Positions of the subnets which prefixes
+    /// include the address, sorted in the ascending order. The vector
+    /// is cleared before the search.
+    void find(const asiolink::IOAddress& address,
+              std::vector<size_t>& positions) const;
+
+    /// @brief Removes all prefixes from the index.
+    void clear() {
+        prefixes_.clear();
+    }
+
+    /// @brief Checks if the index is empty.
+    bool empty() const {
+        return (prefixes_.empty());
+    }
+
+private:
+
+    /// @brief Positions of the subnets keyed by the first address of
+    /// their prefix.
+    typedef boost::unordered_map<asiolink::IOAddress,
+                                 std::vector<size_t> > PositionsByPrefix;
+
+    /// @brief Prefixes grouped by length.
+    std::map<uint8_t, PositionsByPrefix> prefixes_;
+};
+
+} // end of isc::dhcp namespace
+} // end of isc namespace
+
+#endif // SUBNET_PREFIX_INDEX_H
@@ -10,11 +10,16 @@
 #include <dhcpsrv/tests/alloc_engine_utils.h>
 #include <dhcpsrv/tests/test_utils.h>
 #include <stats/stats_mgr.h>
+#include <util/boost_time_utils.h>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <iostream>
 
 using namespace std;
 using namespace isc::hooks;
 using namespace isc::asiolink;
 using namespace isc::stats;
+using namespace isc::util;
+using namespace boost::posix_time;
 
 namespace isc {
 namespace dhcp {
@@ -25,11 +30,11 @@ namespace test {
 TEST_F(AllocEngine4Test, constructor) {
     boost::scoped_ptr<AllocEngine> x;
 
-    // Hashed and random allocators are not supported yet
-    ASSERT_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_HASHED, 5, false)),
-                 NotImplemented);
-    ASSERT_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_RANDOM, 5, false)),
-                 NotImplemented);
+    // Hashed and random allocators should be created too.
+    ASSERT_NO_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_HASHED, 5, false)));
+    ASSERT_TRUE(x->getAllocator(Lease::TYPE_V4));
+    ASSERT_NO_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_RANDOM, 5, false)));
+    ASSERT_TRUE(x->getAllocator(Lease::TYPE_V4));
 
     // Create V4 (ipv6=false) Allocation Engine that will try at most
     // 100 attempts to pick up a lease
@@ -389,6 +394,260 @@ TEST_F(AllocEngine4Test, IterativeAllocator_manyPools4) {
 }
 
 
+// This test verifies that the iterative allocator uses the pool's usage
+// bitmap to skip the addresses for which there are leases, and that the
+// bitmap is updated for the added and removed leases.
+TEST_F(AllocEngine4Test, IterativeAllocatorUsageBitmap) {
+    NakedAllocEngine::IterativeAllocator alloc(Lease::TYPE_V4);
+
+    // Create leases for the first five addresses of the pool.
+    for (int i = 0; i < 5; ++i) {
+        stringstream addr;
+        addr << "192.0.2." << 100 + i;
+        Lease4Ptr lease(new Lease4(IOAddress(addr.str()), hwaddr_, 0, 0,
+                                   500, 100, 200, time(NULL),
+                                   subnet_->getID()));
+        ASSERT_TRUE(LeaseMgrFactory::instance().addLease(lease));
+    }
+
+    // The bitmap is created when the first address is picked.
+    ASSERT_FALSE(pool_->getUsageBitmap());
+    IOAddress candidate = alloc.pickAddress(subnet_, clientid_,
+                                            IOAddress("0.0.0.0"));
+    EXPECT_EQ("192.0.2.105", candidate.toText());
+    ASSERT_TRUE(pool_->getUsageBitmap());
+    EXPECT_EQ(5, pool_->getUsageBitmap()->getUsedCount());
+
+    // Adding a lease must be reflected in the bitmap.
+    Lease4Ptr lease(new Lease4(IOAddress("192.0.2.106"), hwaddr_, 0, 0,
+                               500, 100, 200, time(NULL), subnet_->getID()));
+    ASSERT_TRUE(LeaseMgrFactory::instance().addLease(lease));
+    AllocEngine::updatePoolUsage4(*lease, true);
+    EXPECT_EQ(6, pool_->getUsageBitmap()->getUsedCount());
+
+    // Deleting a lease must be reflected in the bitmap too.
+    lease = LeaseMgrFactory::instance().getLease4(IOAddress("192.0.2.102"));
+    ASSERT_TRUE(lease);
+    ASSERT_TRUE(LeaseMgrFactory::instance().deleteLease(lease->addr_));
+    AllocEngine::updatePoolUsage4(*lease, false);
+    EXPECT_EQ(5, pool_->getUsageBitmap()->getUsedCount());
+
+    // The allocator should skip the used address and wrap around to the
+    // address which has been freed.
+    EXPECT_EQ("192.0.2.107", alloc.pickAddress(subnet_, clientid_,
+                                               IOAddress("0.0.0.0")).toText());
+    EXPECT_EQ("192.0.2.108", alloc.pickAddress(subnet_, clientid_,
+                                               IOAddress("0.0.0.0")).toText());
+    EXPECT_EQ("192.0.2.109", alloc.pickAddress(subnet_, clientid_,
+                                               IOAddress("0.0.0.0")).toText());
+    EXPECT_EQ("192.0.2.102", alloc.pickAddress(subnet_, clientid_,
+                                               IOAddress("0.0.0.0")).toText());
+}
+
+// This test verifies that the allocation engine finds a free address
+// in the nearly full pool and that it is not confused by the out of
+// date bitmap.
+TEST_F(AllocEngine4Test, allocateUsageBitmapOutOfDate) {
+    boost::scoped_ptr<AllocEngine> engine;
+    ASSERT_NO_THROW(engine.reset(new AllocEngine(AllocEngine::ALLOC_ITERATIVE,
+                                                 0, false)));
+
+    // Create leases for all but the last address in the pool.
+    for (int i = 0; i < 9; ++i) {
+        stringstream addr;
+        addr << "192.0.2." << 100 + i;
+        Lease4Ptr lease(new Lease4(IOAddress(addr.str()), hwaddr2_, 0, 0,
+                                   500, 100, 200, time(NULL),
+                                   subnet_->getID()));
+        ASSERT_TRUE(LeaseMgrFactory::instance().addLease(lease));
+    }
+
+    // Pretend that the bitmap has been populated before the leases were
+    // added, i.e. all addresses are believed to be free.
+    pool_->setUsageBitmap(PoolBitmapPtr(new PoolBitmap(pool_->getCapacity())));
+
+    AllocEngine::ClientContext4 ctx(subnet_, clientid_, hwaddr_,
+                                    IOAddress("0.0.0.0"), false, false,
+                                    "", false);
+    ctx.query_.reset(new Pkt4(DHCPREQUEST, 1234));
+    Lease4Ptr lease = engine->allocateLease4(ctx);
+    ASSERT_TRUE(lease);
+    EXPECT_EQ("192.0.2.109", lease->addr_.toText());
+
+    // The conflicting addresses have been marked as used.
+    EXPECT_EQ(pool_->getCapacity(), pool_->getUsageBitmap()->getUsedCount());
+}
+
+// This test verifies that the expired leases are reused when all other
+// free addresses in the pool are reserved for other clients, and that
+// the reserved addresses are not picked again.
+TEST_F(AllocEngine4Test, allocateUsageBitmapReservations) {
+    boost::scoped_ptr<AllocEngine> engine;
+    ASSERT_NO_THROW(engine.reset(new AllocEngine(AllocEngine::ALLOC_ITERATIVE,
+                                                 0, false)));
+
+    // The lease for the first address in the pool has expired.
+    Lease4Ptr expired(new Lease4(IOAddress("192.0.2.100"), hwaddr2_, 0, 0,
+                                 500, 100, 200, time(NULL) - 1000,
+                                 subnet_->getID()));
+    ASSERT_TRUE(LeaseMgrFactory::instance().addLease(expired));
+
+    // The next five addresses are leased.
+    for (int i = 1; i < 6; ++i) {
+        stringstream addr;
+        addr << "192.0.2." << 100 + i;
+        Lease4Ptr lease(new Lease4(IOAddress(addr.str()), hwaddr2_, 0, 0,
+                                   500, 100, 200, time(NULL),
+                                   subnet_->getID()));
+        ASSERT_TRUE(LeaseMgrFactory::instance().addLease(lease));
+    }
+
+    // The remaining addresses are reserved for other clients.
+    for (int i = 6; i < 10; ++i) {
+        stringstream addr;
+        addr << "192.0.2." << 100 + i;
+        uint8_t mac[] = { 0, 2, 22, 33, 44, static_cast<uint8_t>(i) };
+        HostPtr host(new Host(mac, sizeof(mac), Host::IDENT_HWADDR,
+                              subnet_->getID(), SubnetID(0),
+                              IOAddress(addr.str())));
+        CfgMgr::instance().getStagingCfg()->getCfgHosts()->add(host);
+    }
+    CfgMgr::instance().commit();
+
+    // Begin the search after the leased addresses.
+    subnet_->setLastAllocated(Lease::TYPE_V4, IOAddress("192.0.2.105"));
+
+    AllocEngine::ClientContext4 ctx(subnet_, clientid_, hwaddr_,
+                                    IOAddress("0.0.0.0"), false, false,
+                                    "", false);
+    ctx.query_.reset(new Pkt4(DHCPREQUEST, 1234));
+    Lease4Ptr lease = engine->allocateLease4(ctx);
+    ASSERT_TRUE(lease);
+    EXPECT_EQ("192.0.2.100", lease->addr_.toText());
+
+    // The expired lease has not been counted as used, while the reserved
+    // addresses have been marked as used when they were picked.
+    ASSERT_TRUE(pool_->getUsageBitmap());
+    EXPECT_EQ(pool_->getCapacity(), pool_->getUsageBitmap()->getUsedCount());
+}
+
+// This test verifies that the random allocator returns addresses from
+// the pool, that a fresh pick for the same client returns the same address
+// and that the subsequent attempts for the client return all addresses in
+// the pool.
+TEST_F(AllocEngine4Test, RandomAllocator) {
+    NakedAllocEngine::RandomAllocator alloc(Lease::TYPE_V4);
+
+    IOAddress candidate = alloc.pickAddress(subnet_, clientid_,
+                                            IOAddress("0.0.0.0"));
+    EXPECT_TRUE(subnet_->inPool(Lease::TYPE_V4, candidate));
+
+    // The picks for another client don't affect the next pick.
+    alloc.pickAddress(subnet_, clientid2_, IOAddress("0.0.0.0"));
+    EXPECT_EQ(candidate, alloc.pickAddress(subnet_, clientid_,
+                                           IOAddress("0.0.0.0")));
+
+    std::set<IOAddress> generated;
+    for (uint64_t attempt = 0; attempt < 10; ++attempt) {
+        IOAddress addr = alloc.pickAddress(subnet_, clientid_,
+                                           IOAddress("0.0.0.0"), attempt);
+        EXPECT_TRUE(subnet_->inPool(Lease::TYPE_V4, addr));
+        generated.insert(addr);
+    }
+    EXPECT_EQ(10, generated.size());
+}
+
+// This test verifies that the random allocator skips the addresses for
+// which there are leases.
+TEST_F(AllocEngine4Test, RandomAllocatorNearlyFullPool) {
+    NakedAllocEngine::RandomAllocator alloc(Lease::TYPE_V4);
+
+    // Create leases for all but one address in the pool.
+    for (int i = 0; i < 10; ++i) {
+        if (i == 7) {
+            continue;
+        }
+        stringstream addr;
+        addr << "192.0.2." << 100 + i;
+        Lease4Ptr lease(new Lease4(IOAddress(addr.str()), hwaddr2_, 0, 0,
+                                   500, 100, 200, time(NULL),
+                                   subnet_->getID()));
+        ASSERT_TRUE(LeaseMgrFactory::instance().addLease(lease));
+    }
+
+    // Each new client should get the free address in the first attempt.
+    for (uint8_t i = 0; i < 5; ++i) {
+        ClientIdPtr clientid(new ClientId(std::vector<uint8_t>(8, i)));
+        EXPECT_EQ("192.0.2.107", alloc.pickAddress(subnet_, clientid,
+                                                   IOAddress("0.0.0.0")).toText());
+    }
+}
+
+// This test verifies that the hashed allocator returns the same address
+// for the same client and that it falls back to the next addresses when
+// the allocation engine rejects the candidate.
+TEST_F(AllocEngine4Test, HashedAllocator) {
+    NakedAllocEngine::HashedAllocator alloc(Lease::TYPE_V4);
+
+    IOAddress candidate = alloc.pickAddress(subnet_, clientid_,
+                                            IOAddress("0.0.0.0"));
+    EXPECT_TRUE(subnet_->inPool(Lease::TYPE_V4, candidate));
+
+    // A fresh pick for the same client (e.g. for the retransmitted
+    // DHCPDISCOVER) must return the same address.
+    EXPECT_EQ(candidate, alloc.pickAddress(subnet_, clientid_,
+                                           IOAddress("0.0.0.0")));
+
+    // Another allocator must pick the same address for the same client.
+    NakedAllocEngine::HashedAllocator alloc2(Lease::TYPE_V4);
+    alloc2.pickAddress(subnet_, clientid2_, IOAddress("0.0.0.0"));
+    EXPECT_EQ(candidate, alloc2.pickAddress(subnet_, clientid_,
+                                            IOAddress("0.0.0.0")));
+
+    // The subsequent attempts for the same client return all addresses.
+    std::set<IOAddress> generated;
+    for (uint64_t attempt = 0; attempt < 10; ++attempt) {
+        generated.insert(alloc2.pickAddress(subnet_, clientid_,
+                                            IOAddress("0.0.0.0"), attempt));
+    }
+    EXPECT_EQ(10, generated.size());
+}
+
+// This test verifies that the allocator configured for the subnet is used
+// and that all addresses in the pool can be allocated with it.
+TEST_F(AllocEngine4Test, subnetAllocator) {
+    boost::scoped_ptr<NakedAllocEngine> engine;
+    ASSERT_NO_THROW(engine.reset(new NakedAllocEngine(AllocEngine::ALLOC_ITERATIVE,
+                                                      0, false)));
+
+    // Without the subnet specific allocator, the default one is used.
+    EXPECT_EQ(engine->getAllocator(Lease::TYPE_V4),
+              engine->getAllocator(Lease::TYPE_V4, subnet_));
+
+    ASSERT_NO_THROW(subnet_->setAllocatorType("random"));
+    NakedAllocEngine::AllocatorPtr allocator =
+        engine->getAllocator(Lease::TYPE_V4, subnet_);
+    ASSERT_TRUE(allocator);
+    EXPECT_TRUE(boost::dynamic_pointer_cast<NakedAllocEngine::RandomAllocator>(allocator));
+    // The allocator is created once.
+    EXPECT_EQ(allocator, engine->getAllocator(Lease::TYPE_V4, subnet_));
+
+    std::set<IOAddress> allocated;
+    for (uint8_t i = 0; i < 10; ++i) {
+        ClientIdPtr clientid(new ClientId(std::vector<uint8_t>(8, i)));
+        uint8_t mac[] = { 0, 1, 2, 3, 4, i };
+        HWAddrPtr hwaddr(new HWAddr(mac, sizeof(mac), HTYPE_ETHER));
+        AllocEngine::ClientContext4 ctx(subnet_, clientid, hwaddr,
+                                        IOAddress("0.0.0.0"), false, false,
+                                        "", false);
+        ctx.query_.reset(new Pkt4(DHCPREQUEST, 1234));
+        Lease4Ptr lease = engine->allocateLease4(ctx);
+        ASSERT_TRUE(lease) << "allocation " << static_cast<int>(i) << " failed";
+        allocated.insert(lease->addr_);
+    }
+    EXPECT_EQ(10, allocated.size());
+}
+
 // This test checks if really small pools are working
 TEST_F(AllocEngine4Test, smallPool4) {
     boost::scoped_ptr<AllocEngine> engine;
@@ -2318,6 +2577,95 @@ TEST_F(AllocEngine4Test, reservedAddressExistingLeaseStat) {
     EXPECT_FALSE(ctx.fake_allocation_);
 }
 
+// This is a performance benchmark comparing the allocation rates of the
+// iterative, random and hashed allocators while a pool of 4094 addresses
+// is filled up to 90%.
+TEST_F(AllocEngine4Test, DISABLED_performanceAllocators) {
+    const uint32_t leases = 3684;
+    const char* allocators[] = { "iterative", "random", "hashed" };
+    for (unsigned a = 0; a < sizeof(allocators) / sizeof(allocators[0]); ++a) {
+        // Start every run with an empty lease database.
+        factory_.create("type=memfile universe=4 persist=false");
+        Subnet4Ptr subnet(new Subnet4(IOAddress("10.0.0.0"), 20, 1, 2, 3));
+        subnet->addPool(Pool4Ptr(new Pool4(IOAddress("10.0.0.1"),
+                                           IOAddress("10.0.15.254"))));
+        ASSERT_NO_THROW(subnet->setAllocatorType(allocators[a]));
+
+        AllocEngine engine(AllocEngine::ALLOC_ITERATIVE, 0, false);
+        ptime before = microsec_clock::local_time();
+        for (uint32_t i = 0; i < leases; ++i) {
+            std::vector<uint8_t> duid(8, 0);
+            duid[0] = static_cast<uint8_t>(i >> 8);
+            duid[1] = static_cast<uint8_t>(i);
+            ClientIdPtr clientid(new ClientId(duid));
+            uint8_t mac[] = { 0, 1, 2, 3, static_cast<uint8_t>(i >> 8),
+                              static_cast<uint8_t>(i) };
+            HWAddrPtr hwaddr(new HWAddr(mac, sizeof(mac), HTYPE_ETHER));
+            AllocEngine::ClientContext4 ctx(subnet, clientid, hwaddr,
+                                            IOAddress("0.0.0.0"), false, false,
+                                            "", false);
+            ctx.query_.reset(new Pkt4(DHCPREQUEST, i + 1));
+            ASSERT_TRUE(engine.allocateLease4(ctx))
+                << allocators[a] << " allocation " << i << " failed";
+        }
+        time_duration dur = microsec_clock::local_time() - before;
+
+        std::cout << leases << " allocations with the " << allocators[a]
+                  << " allocator took: " << durationToText(dur) << std::endl;
+    }
+}
+
+// This is a performance benchmark measuring the latency of the DHCPDISCOVER
+// processing by the allocation engine when a pool of 4094 addresses is
+// used in 10% and in 99%. The iterative allocator skips the used addresses
+// using the pool usage bitmap.
+TEST_F(AllocEngine4Test, DISABLED_performanceDiscoverUtilization) {
+    const uint32_t discovers = 10000;
+    const unsigned utilizations[] = { 10, 99 };
+    for (unsigned u = 0; u < sizeof(utilizations) / sizeof(utilizations[0]); ++u) {
+        // Start every run with an empty lease database.
+        factory_.create("type=memfile universe=4 persist=false");
+        Subnet4Ptr subnet(new Subnet4(IOAddress("10.0.0.0"), 20, 1, 2, 3));
+        Pool4Ptr pool(new Pool4(IOAddress("10.0.0.1"),
+                                IOAddress("10.0.15.254")));
+        subnet->addPool(pool);
+
+        // Allocate the leases at the beginning of the pool, so as the
+        // allocator has to go over them to find a free address.
+        const uint32_t used = pool->getCapacity() * utilizations[u] / 100;
+        for (uint32_t i = 0; i < used; ++i) {
+            IOAddress addr(pool->getFirstAddress().toUint32() + i);
+            Lease4Ptr lease(new Lease4(addr, hwaddr_, 0, 0, 500, 100, 200,
+                                       time(NULL), subnet->getID()));
+            ASSERT_TRUE(LeaseMgrFactory::instance().addLease(lease));
+        }
+
+        AllocEngine engine(AllocEngine::ALLOC_ITERATIVE, 0, false);
+        ptime before = microsec_clock::local_time();
+        for (uint32_t i = 0; i < discovers; ++i) {
+            std::vector<uint8_t> duid(8, 0);
+            duid[0] = static_cast<uint8_t>(i >> 8);
+            duid[1] = static_cast<uint8_t>(i);
+            ClientIdPtr clientid(new ClientId(duid));
+            uint8_t mac[] = { 0, 1, 2, 3, static_cast<uint8_t>(i >> 8),
+                              static_cast<uint8_t>(i) };
+            HWAddrPtr hwaddr(new HWAddr(mac, sizeof(mac), HTYPE_ETHER));
+            AllocEngine::ClientContext4 ctx(subnet, clientid, hwaddr,
+                                            IOAddress("0.0.0.0"), false, false,
+                                            "", true);
+            ctx.query_.reset(new Pkt4(DHCPDISCOVER, i + 1));
+            ASSERT_TRUE(engine.allocateLease4(ctx))
+                << "allocation " << i << " failed at " << utilizations[u]
+                << "% pool utilization";
+        }
+        time_duration dur = microsec_clock::local_time() - before;
+
+        std::cout << discovers << " DHCPDISCOVERs with the pool used in "
+                  << utilizations[u] << "% took: " << durationToText(dur)
+                  << std::endl;
+    }
+}
+
 }; // namespace test
 }; // namespace dhcp
 }; // namespace isc
@@ -48,9 +48,11 @@ TEST(ClientContext6Test, addAllocatedResource) {
 TEST_F(AllocEngine6Test, constructor) {
     boost::scoped_ptr<AllocEngine> x;
 
-    // Hashed and random allocators are not supported yet
-    ASSERT_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_HASHED, 5)), NotImplemented);
-    ASSERT_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_RANDOM, 5)), NotImplemented);
+    // Hashed and random allocators should be created too.
+    ASSERT_NO_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_HASHED, 5)));
+    ASSERT_TRUE(x->getAllocator(Lease::TYPE_PD));
+    ASSERT_NO_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_RANDOM, 5)));
+    ASSERT_TRUE(x->getAllocator(Lease::TYPE_PD));
 
     ASSERT_NO_THROW(x.reset(new AllocEngine(AllocEngine::ALLOC_ITERATIVE, 100, true)));
 
@@ -408,6 +410,79 @@ TEST_F(AllocEngine6Test, IterativeAllocator_manyPools6) {
     }
 }
 
+// This test verifies that the random allocator returns prefixes from the
+// pool and that the subsequent attempts for the same client return
+// subsequent prefixes.
+TEST_F(AllocEngine6Test, RandomAllocatorPrefix) {
+    NakedAllocEngine::RandomAllocator alloc(Lease::TYPE_PD);
+
+    IOAddress candidate = alloc.pickAddress(subnet_, duid_, IOAddress("::"));
+    EXPECT_TRUE(subnet_->inPool(Lease::TYPE_PD, candidate));
+
+    // The prefix must be aligned to the delegated length of 80.
+    const std::vector<uint8_t>& bytes = candidate.toBytes();
+    for (int i = 10; i < V6ADDRESS_LEN; ++i) {
+        EXPECT_EQ(0, bytes[i]) << "byte " << i << " of " << candidate;
+    }
+
+    // A fresh pick for the same client returns the same prefix.
+    EXPECT_EQ(candidate, alloc.pickAddress(subnet_, duid_, IOAddress("::")));
+
+    IOAddress next = alloc.pickAddress(subnet_, duid_, IOAddress("::"), 1);
+    EXPECT_TRUE(subnet_->inPool(Lease::TYPE_PD, next));
+    if (candidate != IOAddress("2001:db8:1:2:ffff::")) {
+        EXPECT_EQ(NakedAllocEngine::NakedIterativeAllocator::
+                  increasePrefix(candidate, 80), next);
+    }
+}
+
+// This test verifies that the hashed allocator returns the same address
+// for the same client and that all addresses in the pool are returned
+// for the client when the candidates are rejected.
+TEST_F(AllocEngine6Test, HashedAllocator) {
+    NakedAllocEngine::HashedAllocator alloc(Lease::TYPE_NA);
+
+    IOAddress candidate = alloc.pickAddress(subnet_, duid_, IOAddress("::"));
+    EXPECT_TRUE(subnet_->inPool(Lease::TYPE_NA, candidate));
+
+    NakedAllocEngine::HashedAllocator alloc2(Lease::TYPE_NA);
+    EXPECT_EQ(candidate, alloc2.pickAddress(subnet_, duid_, IOAddress("::")));
+
+    EXPECT_EQ(candidate, alloc2.pickAddress(subnet_, duid_, IOAddress("::")));
+
+    // The pool holds 17 addresses.
+    std::set<IOAddress> generated;
+    for (uint64_t attempt = 0; attempt < 17; ++attempt) {
+        IOAddress addr = alloc2.pickAddress(subnet_, duid_, IOAddress("::"),
+                                            attempt);
+        EXPECT_TRUE(subnet_->inPool(Lease::TYPE_NA, addr));
+        generated.insert(addr);
+    }
+    EXPECT_EQ(17, generated.size());
+}
+
+// This test verifies that the allocator configured for the subnet is used
+// to allocate all addresses in the pool.
+TEST_F(AllocEngine6Test, subnetAllocator) {
+    boost::scoped_ptr<AllocEngine> engine;
+    ASSERT_NO_THROW(engine.reset(new AllocEngine(AllocEngine::ALLOC_ITERATIVE, 0)));
+
+    subnet_->setAllocatorType("hashed");
+
+    std::set<IOAddress> allocated;
+    for (uint8_t i = 0; i < 17; ++i) {
+        DuidPtr duid(new DUID(std::vector<uint8_t>(8, i)));
+        AllocEngine::ClientContext6 ctx(subnet_, duid, false, false, "", false,
+                                        Pkt6Ptr(new Pkt6(DHCPV6_REQUEST, 1234)));
+        ctx.currentIA().iaid_ = iaid_;
+        Lease6Ptr lease;
+        ASSERT_NO_THROW(lease = expectOneLease(engine->allocateLeases6(ctx)));
+        ASSERT_TRUE(lease) << "allocation " << static_cast<int>(i) << " failed";
+        allocated.insert(lease->addr_);
+    }
+    EXPECT_EQ(17, allocated.size());
+}
+
 // This test checks if really small pools are working
 TEST_F(AllocEngine6Test, smallPool6) {
     boost::scoped_ptr<AllocEngine> engine;
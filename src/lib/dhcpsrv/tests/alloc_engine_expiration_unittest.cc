@@ -1782,6 +1782,24 @@ public:
         return (lease4RecoverCallout(callout_handle));
     }
 
+    /// @brief Callout for lease4_expire removing some leases from the
+    /// lease database.
+    ///
+    /// The leases with odd indexes are removed, so as they can't be
+    /// updated when they are reclaimed.
+    ///
+    /// @param callout_handle will be provided by hooks framework
+    /// @return always 0
+    static int lease4ExpireRemoveCallout(CalloutHandle& callout_handle) {
+        Lease4Ptr lease;
+        callout_handle.getArgument("lease4", lease);
+        if (lease->addr_.toUint32() % 2) {
+            LeaseMgrFactory::instance().deleteLease(lease->addr_);
+        }
+
+        return (0);
+    }
+
     /// @brief Test install a hook callout, recovers declined leases
     ///
     /// This test: declines, then expires half of the leases, then
@@ -2197,6 +2215,32 @@ TEST_F(ExpirationAllocEngine4Test, reclaimExpiredLeasesHooks) {
     testReclaimExpiredLeasesHooks();
 }
 
+// This test verifies that the statistics are not updated for the leases
+// which fail to be stored in the lease database.
+TEST_F(ExpirationAllocEngine4Test, reclaimExpiredLeasesStoreFailed) {
+    for (unsigned int i = 0; i < TEST_LEASES_NUM; ++i) {
+        expire(i, 1000 - i);
+    }
+
+    HookLibsCollection libraries; // no libraries at this time
+    HooksManager::loadLibraries(libraries);
+
+    // Install a callout removing the leases with odd indexes before they
+    // are updated.
+    EXPECT_NO_THROW(HooksManager::preCalloutsLibraryHandle().registerCallout(
+                        "lease4_expire", lease4ExpireRemoveCallout));
+
+    ASSERT_NO_THROW(reclaimExpiredLeases(0, 0, false));
+
+    // Only the leases with even indexes have been reclaimed.
+    EXPECT_TRUE(testLeases(&leaseReclaimed, &evenLeaseIndex));
+    EXPECT_TRUE(testStatistics("reclaimed-leases", TEST_LEASES_NUM / 2));
+    EXPECT_TRUE(testStatistics("subnet[1].reclaimed-leases",
+                               TEST_LEASES_NUM / 2));
+    EXPECT_TRUE(testStatistics("subnet[1].assigned-addresses",
+                               TEST_LEASES_NUM / 2));
+}
+
 // This test verifies that callouts are executed for each expired lease
 // and that the lease is not reclaimed when the skip flag is set.
 TEST_F(ExpirationAllocEngine4Test, reclaimExpiredLeasesHooksWithSkip) {
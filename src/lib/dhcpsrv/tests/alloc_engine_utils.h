@@ -61,7 +61,10 @@ public:
 
     // Expose internal classes for testing purposes
     using AllocEngine::Allocator;
+    using AllocEngine::AllocatorPtr;
     using AllocEngine::IterativeAllocator;
+    using AllocEngine::HashedAllocator;
+    using AllocEngine::RandomAllocator;
     using AllocEngine::getAllocator;
 
     /// @brief IterativeAllocator with internal methods exposed
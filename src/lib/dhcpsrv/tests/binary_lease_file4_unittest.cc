@@ -0,0 +1,384 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+#include <asiolink/io_address.h>
+#include <dhcpsrv/binary_lease_file4.h>
+#include <dhcpsrv/binary_lease_file6.h>
+#include <dhcpsrv/lease.h>
+#include <dhcpsrv/tests/lease_file_io.h>
+#include <gtest/gtest.h>
+#include <sstream>
+
+using namespace isc;
+using namespace isc::asiolink;
+using namespace isc::dhcp;
+using namespace isc::dhcp::test;
+using namespace isc::util;
+
+namespace {
+
+// HWADDR values used by unit tests.
+const uint8_t HWADDR0[] = { 0, 1, 2, 3, 4, 5 };
+const uint8_t HWADDR1[] = { 0xd, 0xe, 0xa, 0xd, 0xb, 0xe, 0xe, 0xf };
+
+const uint8_t CLIENTID[] = { 1, 2, 3, 4 };
+
+/// @brief Test fixture class for @c BinaryLeaseFile4 validation.
+class BinaryLeaseFile4Test : public ::testing::Test {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// Initializes IO for lease file used by unit tests.
+    BinaryLeaseFile4Test();
+
+    /// @brief Prepends the absolute path to the file specified
+    /// as an argument.
+    ///
+    /// @param filename Name of the file.
+    /// @return Absolute path to the test file.
+    static std::string absolutePath(const std::string& filename);
+
+    /// @brief Writes the sample leases to the lease file.
+    ///
+    /// The first lease has no client identifier, the second lease has
+    /// the client identifier and the hostname and the third lease is
+    /// declined and has blank HW address.
+    void writeSampleFile() const;
+
+    /// @brief Checks the stats for the file
+    ///
+    /// @param lease_file A reference to the file we are using
+    /// @param reads the number of attempted reads
+    /// @param read_leases the number of valid leases read
+    /// @param read_errs the number of errors while reading leases
+    /// @param writes the number of attempted writes
+    /// @param write_leases the number of leases successfully written
+    /// @param write_errs the number of errors while writing
+    void checkStats(BinaryLeaseFile4& lease_file,
+                    uint32_t reads, uint32_t read_leases,
+                    uint32_t read_errs, uint32_t writes,
+                    uint32_t write_leases, uint32_t write_errs) const {
+        EXPECT_EQ(reads, lease_file.getReads());
+        EXPECT_EQ(read_leases, lease_file.getReadLeases());
+        EXPECT_EQ(read_errs, lease_file.getReadErrs());
+        EXPECT_EQ(writes, lease_file.getWrites());
+        EXPECT_EQ(write_leases, lease_file.getWriteLeases());
+        EXPECT_EQ(write_errs, lease_file.getWriteErrs());
+    }
+
+    /// @brief Name of the test lease file.
+    std::string filename_;
+
+    /// @brief Object providing access to lease file IO.
+    LeaseFileIO io_;
+
+    /// @brief hardware address 0 (corresponds to HWADDR0 const)
+    HWAddrPtr hwaddr0_;
+
+    /// @brief hardware address 1 (corresponds to HWADDR1 const)
+    HWAddrPtr hwaddr1_;
+};
+
+BinaryLeaseFile4Test::BinaryLeaseFile4Test()
+    : filename_(absolutePath("leases4.bin")), io_(filename_) {
+    hwaddr0_.reset(new HWAddr(HWADDR0, sizeof(HWADDR0), HTYPE_ETHER));
+    hwaddr1_.reset(new HWAddr(HWADDR1, sizeof(HWADDR1), HTYPE_ETHER));
+}
+
+std::string
+BinaryLeaseFile4Test::absolutePath(const std::string& filename) {
+    std::ostringstream s;
+    s << DHCP_DATA_DIR << "/" << filename;
+    return (s.str());
+}
+
+void
+BinaryLeaseFile4Test::writeSampleFile() const {
+    BinaryLeaseFile4 lf(filename_);
+    lf.open();
+
+    Lease4 lease1(IOAddress("192.0.2.1"), hwaddr0_, NULL, 0,
+                  200, 50, 80, 0, 8, true, true, "");
+    lf.append(lease1);
+
+    Lease4 lease2(IOAddress("192.0.2.2"), hwaddr1_,
+                  CLIENTID, sizeof(CLIENTID), 100, 30, 40, 1000, 7,
+                  false, true, "host.example.com");
+    lf.append(lease2);
+
+    Lease4 lease3(IOAddress("192.0.2.3"),
+                  HWAddrPtr(new HWAddr(std::vector<uint8_t>(), HTYPE_ETHER)),
+                  NULL, 0, 300, 0, 0, 2000, 9, false, false, "");
+    lease3.state_ = Lease::STATE_DECLINED;
+    lf.append(lease3);
+
+    lf.close();
+}
+
+// This test checks that the leases written to the file are read back
+// with all their attributes.
+TEST_F(BinaryLeaseFile4Test, parse) {
+    ASSERT_NO_THROW(writeSampleFile());
+
+    BinaryLeaseFile4 lf(filename_);
+    ASSERT_NO_THROW(lf.open());
+    checkStats(lf, 0, 0, 0, 0, 0, 0);
+    EXPECT_FALSE(lf.needsConversion());
+    EXPECT_EQ("1.0", lf.getInputSchemaVersion());
+
+    Lease4Ptr lease;
+    {
+    SCOPED_TRACE("First lease valid");
+    ASSERT_TRUE(lf.next(lease));
+    ASSERT_TRUE(lease);
+    checkStats(lf, 1, 1, 0, 0, 0, 0);
+
+    EXPECT_EQ("192.0.2.1", lease->addr_.toText());
+    ASSERT_TRUE(lease->hwaddr_);
+    EXPECT_TRUE(*lease->hwaddr_ == *hwaddr0_);
+    EXPECT_FALSE(lease->client_id_);
+    EXPECT_EQ(200, lease->valid_lft_);
+    EXPECT_EQ(0, lease->cltt_);
+    EXPECT_EQ(8, lease->subnet_id_);
+    EXPECT_TRUE(lease->fqdn_fwd_);
+    EXPECT_TRUE(lease->fqdn_rev_);
+    EXPECT_TRUE(lease->hostname_.empty());
+    EXPECT_EQ(Lease::STATE_DEFAULT, lease->state_);
+    }
+
+    {
+    SCOPED_TRACE("Second lease valid");
+    ASSERT_TRUE(lf.next(lease));
+    ASSERT_TRUE(lease);
+    checkStats(lf, 2, 2, 0, 0, 0, 0);
+
+    EXPECT_EQ("192.0.2.2", lease->addr_.toText());
+    ASSERT_TRUE(lease->hwaddr_);
+    EXPECT_TRUE(*lease->hwaddr_ == *hwaddr1_);
+    ASSERT_TRUE(lease->client_id_);
+    EXPECT_EQ("01:02:03:04", lease->client_id_->toText());
+    EXPECT_EQ(100, lease->valid_lft_);
+    EXPECT_EQ(1000, lease->cltt_);
+    EXPECT_EQ(7, lease->subnet_id_);
+    EXPECT_FALSE(lease->fqdn_fwd_);
+    EXPECT_TRUE(lease->fqdn_rev_);
+    EXPECT_EQ("host.example.com", lease->hostname_);
+    }
+
+    {
+    SCOPED_TRACE("Third lease valid");
+    ASSERT_TRUE(lf.next(lease));
+    ASSERT_TRUE(lease);
+    checkStats(lf, 3, 3, 0, 0, 0, 0);
+
+    EXPECT_EQ("192.0.2.3", lease->addr_.toText());
+    ASSERT_TRUE(lease->hwaddr_);
+    EXPECT_TRUE(lease->hwaddr_->hwaddr_.empty());
+    EXPECT_EQ(Lease::STATE_DECLINED, lease->state_);
+    }
+
+    {
+    SCOPED_TRACE("End of file");
+    EXPECT_TRUE(lf.next(lease));
+    EXPECT_FALSE(lease);
+    checkStats(lf, 4, 3, 0, 0, 0, 0);
+    }
+}
+
+// This test checks that the file begins with the header and that the
+// header is verified when the file is opened.
+TEST_F(BinaryLeaseFile4Test, header) {
+    ASSERT_NO_THROW(writeSampleFile());
+
+    EXPECT_EQ("KEALEASE", io_.readFile().substr(0, 8));
+    EXPECT_TRUE(BinaryLeaseFile::hasBinaryHeader(filename_));
+
+    // The file holding the DHCPv4 leases can't be opened as the file
+    // holding the DHCPv6 leases.
+    BinaryLeaseFile6 lf6(filename_);
+    EXPECT_THROW(lf6.open(), BinaryLeaseFileError);
+
+    // The CSV file is not the binary lease file.
+    io_.writeFile("address,hwaddr,client_id,valid_lifetime,expire,subnet_id,"
+                  "fqdn_fwd,fqdn_rev,hostname,state\n");
+    EXPECT_FALSE(BinaryLeaseFile::hasBinaryHeader(filename_));
+    BinaryLeaseFile4 lf(filename_);
+    EXPECT_THROW(lf.open(), BinaryLeaseFileError);
+
+    // The file with other major version can't be read.
+    io_.writeFile(std::string("KEALEASE\x02\x00\x04\x00", 12));
+    EXPECT_THROW(lf.open(), BinaryLeaseFileError);
+
+    // The file with higher minor version can be read but it has to be
+    // converted.
+    io_.writeFile(std::string("KEALEASE\x01\x05\x04\x00", 12));
+    ASSERT_NO_THROW(lf.open());
+    EXPECT_EQ("1.5", lf.getInputSchemaVersion());
+    EXPECT_TRUE(lf.needsConversion());
+}
+
+// This test checks that the snapshot flag is recorded in the header.
+TEST_F(BinaryLeaseFile4Test, snapshot) {
+    ASSERT_NO_THROW(writeSampleFile());
+
+    BinaryLeaseFile4 lf(filename_);
+    ASSERT_NO_THROW(lf.open());
+    EXPECT_FALSE(lf.isSnapshot());
+    lf.close();
+
+    // Recreate the file as the snapshot. The flag of the existing file
+    // is read from its header so the file must be removed first.
+    io_.removeFile();
+    lf.setSnapshot(true);
+    ASSERT_NO_THROW(lf.open(true));
+    Lease4 lease(IOAddress("192.0.2.1"), hwaddr0_, NULL, 0,
+                 200, 50, 80, 0, 8);
+    ASSERT_NO_THROW(lf.append(lease));
+    lf.close();
+
+    // The flag is read from the header when the file is opened.
+    BinaryLeaseFile4 snapshot(filename_);
+    ASSERT_NO_THROW(snapshot.open());
+    EXPECT_TRUE(snapshot.isSnapshot());
+    EXPECT_FALSE(snapshot.needsConversion());
+}
+
+// This test checks that the record with the invalid checksum is skipped
+// and the following records are read.
+TEST_F(BinaryLeaseFile4Test, checksumError) {
+    ASSERT_NO_THROW(writeSampleFile());
+
+    // Modify the address in the first record.
+    std::string contents = io_.readFile();
+    contents[BinaryLeaseFile::HEADER_SIZE +
+             BinaryLeaseFile::RECORD_HEADER_SIZE + 3] ^= 0x10;
+    io_.writeFile(contents);
+
+    BinaryLeaseFile4 lf(filename_);
+    ASSERT_NO_THROW(lf.open());
+
+    Lease4Ptr lease;
+    EXPECT_FALSE(lf.next(lease));
+    EXPECT_FALSE(lease);
+    EXPECT_FALSE(lf.getReadMsg().empty());
+    checkStats(lf, 1, 0, 1, 0, 0, 0);
+
+    ASSERT_TRUE(lf.next(lease));
+    ASSERT_TRUE(lease);
+    EXPECT_EQ("192.0.2.2", lease->addr_.toText());
+    checkStats(lf, 2, 1, 1, 0, 0, 0);
+}
+
+// This test checks that the incomplete record at the end of the file,
+// e.g. written by the server which has been killed, is reported as an
+// error and it is removed before the next record is appended.
+TEST_F(BinaryLeaseFile4Test, truncatedRecord) {
+    ASSERT_NO_THROW(writeSampleFile());
+
+    // Remove the last bytes of the last record.
+    std::string contents = io_.readFile();
+    io_.writeFile(contents.substr(0, contents.size() - 3));
+
+    BinaryLeaseFile4 lf(filename_);
+    ASSERT_NO_THROW(lf.open());
+
+    Lease4Ptr lease;
+    ASSERT_TRUE(lf.next(lease));
+    ASSERT_TRUE(lease);
+    ASSERT_TRUE(lf.next(lease));
+    ASSERT_TRUE(lease);
+    EXPECT_FALSE(lf.next(lease));
+    EXPECT_FALSE(lease);
+    EXPECT_TRUE(lf.next(lease));
+    EXPECT_FALSE(lease);
+    checkStats(lf, 4, 2, 1, 0, 0, 0);
+
+    // Append the new lease in place of the incomplete record.
+    Lease4 lease4(IOAddress("192.0.2.4"), hwaddr0_, NULL, 0,
+                  200, 50, 80, 0, 8, false, false, "");
+    ASSERT_NO_THROW(lf.append(lease4));
+    lf.close();
+
+    // Make sure that all records can be read.
+    ASSERT_NO_THROW(lf.open());
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(lf.next(lease));
+        ASSERT_TRUE(lease);
+    }
+    EXPECT_EQ("192.0.2.4", lease->addr_.toText());
+    EXPECT_TRUE(lf.next(lease));
+    EXPECT_FALSE(lease);
+    checkStats(lf, 4, 3, 0, 0, 0, 0);
+}
+
+// This test checks that the incomplete record is removed before the
+// record is appended to the file which has been opened without reading.
+TEST_F(BinaryLeaseFile4Test, truncatedRecordSeekToEnd) {
+    ASSERT_NO_THROW(writeSampleFile());
+
+    std::string contents = io_.readFile();
+    io_.writeFile(contents.substr(0, contents.size() - 3));
+
+    BinaryLeaseFile4 lf(filename_);
+    ASSERT_NO_THROW(lf.open(true));
+
+    Lease4 lease4(IOAddress("192.0.2.4"), hwaddr0_, NULL, 0,
+                  200, 50, 80, 0, 8, false, false, "");
+    ASSERT_NO_THROW(lf.append(lease4));
+    checkStats(lf, 0, 0, 0, 1, 1, 0);
+    lf.close();
+
+    ASSERT_NO_THROW(lf.open());
+    Lease4Ptr lease;
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(lf.next(lease));
+        ASSERT_TRUE(lease);
+    }
+    EXPECT_EQ("192.0.2.4", lease->addr_.toText());
+    EXPECT_TRUE(lf.next(lease));
+    EXPECT_FALSE(lease);
+    checkStats(lf, 4, 3, 0, 0, 0, 0);
+}
+
+// This test checks that the records are buffered until the file is
+// flushed when the automatic flush is disabled.
+TEST_F(BinaryLeaseFile4Test, autoFlush) {
+    BinaryLeaseFile4 lf(filename_);
+    ASSERT_NO_THROW(lf.open());
+    lf.setAutoFlush(false);
+    const std::string header = io_.readFile();
+
+    Lease4 lease(IOAddress("192.0.2.1"), hwaddr0_, NULL, 0,
+                 200, 50, 80, 0, 8, false, false, "");
+    ASSERT_NO_THROW(lf.append(lease));
+    EXPECT_EQ(header, io_.readFile());
+
+    ASSERT_NO_THROW(lf.flush());
+    EXPECT_GT(io_.readFile().size(), header.size());
+    EXPECT_NO_THROW(lf.sync());
+    lf.close();
+
+    ASSERT_NO_THROW(lf.open());
+    Lease4Ptr read_lease;
+    ASSERT_TRUE(lf.next(read_lease));
+    ASSERT_TRUE(read_lease);
+    EXPECT_EQ("192.0.2.1", read_lease->addr_.toText());
+}
+
+// This test checks that the lease without HW address can't be written.
+TEST_F(BinaryLeaseFile4Test, appendNoHWAddr) {
+    BinaryLeaseFile4 lf(filename_);
+    ASSERT_NO_THROW(lf.open());
+
+    Lease4 lease(IOAddress("192.0.2.1"), HWAddrPtr(), NULL, 0,
+                 200, 50, 80, 0, 8, false, false, "");
+    EXPECT_THROW(lf.append(lease), BadValue);
+    checkStats(lf, 0, 0, 0, 1, 0, 1);
+}
+
+} // end of anonymous namespace
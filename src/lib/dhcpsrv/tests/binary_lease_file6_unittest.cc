@@ -0,0 +1,273 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+#include <asiolink/io_address.h>
+#include <dhcp/duid.h>
+#include <dhcpsrv/binary_lease_file4.h>
+#include <dhcpsrv/binary_lease_file6.h>
+#include <dhcpsrv/lease.h>
+#include <dhcpsrv/tests/lease_file_io.h>
+#include <gtest/gtest.h>
+#include <sstream>
+
+using namespace isc;
+using namespace isc::asiolink;
+using namespace isc::dhcp;
+using namespace isc::dhcp::test;
+using namespace isc::util;
+
+namespace {
+
+// DUID values used by unit tests.
+const uint8_t DUID0[] = { 0, 1, 2, 3, 4, 5, 6, 0xa, 0xb, 0xc, 0xd, 0xe, 0xf };
+const uint8_t DUID1[] = { 1, 1, 1, 1, 0xa, 1, 2, 3, 4, 5 };
+
+// HWADDR value used by unit tests.
+const uint8_t HWADDR0[] = { 0, 1, 2, 3, 4, 5 };
+
+/// @brief Test fixture class for @c BinaryLeaseFile6 validation.
+class BinaryLeaseFile6Test : public ::testing::Test {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// Initializes IO for lease file used by unit tests.
+    BinaryLeaseFile6Test();
+
+    /// @brief Prepends the absolute path to the file specified
+    /// as an argument.
+    ///
+    /// @param filename Name of the file.
+    /// @return Absolute path to the test file.
+    static std::string absolutePath(const std::string& filename);
+
+    /// @brief Writes the sample leases to the lease file.
+    ///
+    /// The first lease is an address lease with HW address and hostname,
+    /// the second lease is a prefix lease without HW address and the
+    /// third lease is declined and has the empty DUID.
+    void writeSampleFile() const;
+
+    /// @brief Checks the stats for the file
+    ///
+    /// @param lease_file A reference to the file we are using
+    /// @param reads the number of attempted reads
+    /// @param read_leases the number of valid leases read
+    /// @param read_errs the number of errors while reading leases
+    /// @param writes the number of attempted writes
+    /// @param write_leases the number of leases successfully written
+    /// @param write_errs the number of errors while writing
+    void checkStats(BinaryLeaseFile6& lease_file,
+                    uint32_t reads, uint32_t read_leases,
+                    uint32_t read_errs, uint32_t writes,
+                    uint32_t write_leases, uint32_t write_errs) const {
+        EXPECT_EQ(reads, lease_file.getReads());
+        EXPECT_EQ(read_leases, lease_file.getReadLeases());
+        EXPECT_EQ(read_errs, lease_file.getReadErrs());
+        EXPECT_EQ(writes, lease_file.getWrites());
+        EXPECT_EQ(write_leases, lease_file.getWriteLeases());
+        EXPECT_EQ(write_errs, lease_file.getWriteErrs());
+    }
+
+    /// @brief Name of the test lease file.
+    std::string filename_;
+
+    /// @brief Object providing access to lease file IO.
+    LeaseFileIO io_;
+
+    /// @brief DUID 0 (corresponds to DUID0 const)
+    DuidPtr duid0_;
+
+    /// @brief DUID 1 (corresponds to DUID1 const)
+    DuidPtr duid1_;
+
+    /// @brief hardware address 0 (corresponds to HWADDR0 const)
+    HWAddrPtr hwaddr0_;
+};
+
+BinaryLeaseFile6Test::BinaryLeaseFile6Test()
+    : filename_(absolutePath("leases6.bin")), io_(filename_) {
+    duid0_.reset(new DUID(DUID0, sizeof(DUID0)));
+    duid1_.reset(new DUID(DUID1, sizeof(DUID1)));
+    hwaddr0_.reset(new HWAddr(HWADDR0, sizeof(HWADDR0), HTYPE_ETHER));
+}
+
+std::string
+BinaryLeaseFile6Test::absolutePath(const std::string& filename) {
+    std::ostringstream s;
+    s << DHCP_DATA_DIR << "/" << filename;
+    return (s.str());
+}
+
+void
+BinaryLeaseFile6Test::writeSampleFile() const {
+    BinaryLeaseFile6 lf(filename_);
+    lf.open();
+
+    Lease6 lease1(Lease::TYPE_NA, IOAddress("2001:db8:1::1"), duid0_,
+                  7, 150, 300, 0, 0, 8, true, false, "host.example.com",
+                  hwaddr0_);
+    lease1.cltt_ = 1000;
+    lf.append(lease1);
+
+    Lease6 lease2(Lease::TYPE_PD, IOAddress("3000:1::"), duid1_,
+                  8, 200, 400, 0, 0, 9, HWAddrPtr(), 64);
+    lf.append(lease2);
+
+    Lease6 lease3(Lease::TYPE_NA, IOAddress("2001:db8:1::3"),
+                  DuidPtr(new DUID(DUID::EMPTY())), 0, 0, 500, 0, 0, 8);
+    lease3.state_ = Lease::STATE_DECLINED;
+    lf.append(lease3);
+
+    lf.close();
+}
+
+// This test checks that the leases written to the file are read back
+// with all their attributes.
+TEST_F(BinaryLeaseFile6Test, parse) {
+    ASSERT_NO_THROW(writeSampleFile());
+
+    BinaryLeaseFile6 lf(filename_);
+    ASSERT_NO_THROW(lf.open());
+    checkStats(lf, 0, 0, 0, 0, 0, 0);
+    EXPECT_FALSE(lf.needsConversion());
+
+    Lease6Ptr lease;
+    {
+    SCOPED_TRACE("First lease valid");
+    ASSERT_TRUE(lf.next(lease));
+    ASSERT_TRUE(lease);
+    checkStats(lf, 1, 1, 0, 0, 0, 0);
+
+    EXPECT_EQ(Lease::TYPE_NA, lease->type_);
+    EXPECT_EQ("2001:db8:1::1", lease->addr_.toText());
+    ASSERT_TRUE(lease->duid_);
+    EXPECT_TRUE(*lease->duid_ == *duid0_);
+    EXPECT_EQ(7, lease->iaid_);
+    EXPECT_EQ(150, lease->preferred_lft_);
+    EXPECT_EQ(300, lease->valid_lft_);
+    EXPECT_EQ(1000, lease->cltt_);
+    EXPECT_EQ(8, lease->subnet_id_);
+    EXPECT_EQ(128, lease->prefixlen_);
+    EXPECT_TRUE(lease->fqdn_fwd_);
+    EXPECT_FALSE(lease->fqdn_rev_);
+    EXPECT_EQ("host.example.com", lease->hostname_);
+    ASSERT_TRUE(lease->hwaddr_);
+    EXPECT_TRUE(*lease->hwaddr_ == *hwaddr0_);
+    }
+
+    {
+    SCOPED_TRACE("Second lease valid");
+    ASSERT_TRUE(lf.next(lease));
+    ASSERT_TRUE(lease);
+    checkStats(lf, 2, 2, 0, 0, 0, 0);
+
+    EXPECT_EQ(Lease::TYPE_PD, lease->type_);
+    EXPECT_EQ("3000:1::", lease->addr_.toText());
+    ASSERT_TRUE(lease->duid_);
+    EXPECT_TRUE(*lease->duid_ == *duid1_);
+    EXPECT_EQ(64, lease->prefixlen_);
+    EXPECT_EQ(9, lease->subnet_id_);
+    EXPECT_FALSE(lease->hwaddr_);
+    EXPECT_TRUE(lease->hostname_.empty());
+    }
+
+    {
+    SCOPED_TRACE("Third lease valid");
+    ASSERT_TRUE(lf.next(lease));
+    ASSERT_TRUE(lease);
+    checkStats(lf, 3, 3, 0, 0, 0, 0);
+
+    EXPECT_EQ("2001:db8:1::3", lease->addr_.toText());
+    EXPECT_TRUE(*lease->duid_ == DUID::EMPTY());
+    EXPECT_EQ(Lease::STATE_DECLINED, lease->state_);
+    }
+
+    {
+    SCOPED_TRACE("End of file");
+    EXPECT_TRUE(lf.next(lease));
+    EXPECT_FALSE(lease);
+    checkStats(lf, 4, 3, 0, 0, 0, 0);
+    }
+}
+
+// This test checks that the file holding the DHCPv6 leases can't be
+// opened as the file holding the DHCPv4 leases.
+TEST_F(BinaryLeaseFile6Test, wrongFamily) {
+    ASSERT_NO_THROW(writeSampleFile());
+
+    BinaryLeaseFile4 lf4(filename_);
+    EXPECT_THROW(lf4.open(), BinaryLeaseFileError);
+}
+
+// This test checks that the record with the invalid checksum is skipped
+// and the following records are read.
+TEST_F(BinaryLeaseFile6Test, checksumError) {
+    ASSERT_NO_THROW(writeSampleFile());
+
+    // Modify the data of the last record.
+    std::string contents = io_.readFile();
+    contents[contents.size() - 10] ^= 0x01;
+    io_.writeFile(contents);
+
+    BinaryLeaseFile6 lf(filename_);
+    ASSERT_NO_THROW(lf.open());
+
+    Lease6Ptr lease;
+    ASSERT_TRUE(lf.next(lease));
+    ASSERT_TRUE(lease);
+    ASSERT_TRUE(lf.next(lease));
+    ASSERT_TRUE(lease);
+    EXPECT_FALSE(lf.next(lease));
+    EXPECT_FALSE(lease);
+    EXPECT_TRUE(lf.next(lease));
+    EXPECT_FALSE(lease);
+    checkStats(lf, 4, 2, 1, 0, 0, 0);
+}
+
+// This test checks that the incomplete record at the end of the file
+// is removed before the next record is appended.
+TEST_F(BinaryLeaseFile6Test, truncatedRecord) {
+    ASSERT_NO_THROW(writeSampleFile());
+
+    // Remove the second half of the last record.
+    std::string contents = io_.readFile();
+    io_.writeFile(contents.substr(0, contents.size() - 30));
+
+    // Open the file for appending without reading it.
+    BinaryLeaseFile6 lf(filename_);
+    ASSERT_NO_THROW(lf.open(true));
+    Lease6 lease4(Lease::TYPE_NA, IOAddress("2001:db8:1::4"), duid0_,
+                  7, 150, 300, 0, 0, 8);
+    ASSERT_NO_THROW(lf.append(lease4));
+    lf.close();
+
+    ASSERT_NO_THROW(lf.open());
+    Lease6Ptr lease;
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(lf.next(lease));
+        ASSERT_TRUE(lease);
+    }
+    EXPECT_EQ("2001:db8:1::4", lease->addr_.toText());
+    EXPECT_TRUE(lf.next(lease));
+    EXPECT_FALSE(lease);
+    checkStats(lf, 4, 3, 0, 0, 0, 0);
+}
+
+// This test checks that the lease without DUID can't be written.
+TEST_F(BinaryLeaseFile6Test, appendNoDUID) {
+    BinaryLeaseFile6 lf(filename_);
+    ASSERT_NO_THROW(lf.open());
+
+    Lease6 lease(Lease::TYPE_NA, IOAddress("2001:db8:1::1"), duid0_,
+                 7, 150, 300, 0, 0, 8);
+    lease.duid_.reset();
+    EXPECT_THROW(lf.append(lease), BadValue);
+    checkStats(lf, 0, 0, 0, 1, 0, 1);
+}
+
+} // end of anonymous namespace
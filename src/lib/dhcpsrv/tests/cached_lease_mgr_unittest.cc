@@ -0,0 +1,413 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+#include <asiolink/io_address.h>
+#include <dhcpsrv/cached_lease_mgr.h>
+#include <stats/stats_mgr.h>
+#include <util/boost_time_utils.h>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <gtest/gtest.h>
+#include <iostream>
+#include <map>
+#include <vector>
+#include <unistd.h>
+
+using namespace isc;
+using namespace isc::asiolink;
+using namespace isc::dhcp;
+using namespace isc::stats;
+using namespace boost::posix_time;
+
+namespace {
+
+/// @brief Lease manager holding the leases in memory and counting the
+/// lookups by address.
+///
+/// It is used as a backend of the @c CachedLeaseMgr by the tests.
+class TestLeaseMgr : public LeaseMgr {
+public:
+
+    /// @brief Constructor.
+    TestLeaseMgr() : LeaseMgr(), lookups_(0) {
+    }
+
+    virtual bool addLease(const Lease4Ptr& lease) {
+        if (leases4_.count(lease->addr_) > 0) {
+            return (false);
+        }
+        leases4_[lease->addr_] = Lease4Ptr(new Lease4(*lease));
+        return (true);
+    }
+
+    virtual bool addLease(const Lease6Ptr& lease) {
+        if (leases6_.count(lease->addr_) > 0) {
+            return (false);
+        }
+        leases6_[lease->addr_] = Lease6Ptr(new Lease6(*lease));
+        return (true);
+    }
+
+    virtual Lease4Ptr getLease4(const IOAddress& addr) const {
+        ++lookups_;
+        std::map<IOAddress, Lease4Ptr>::const_iterator l = leases4_.find(addr);
+        return (l != leases4_.end() ? Lease4Ptr(new Lease4(*l->second)) :
+                Lease4Ptr());
+    }
+
+    virtual Lease4Collection getLease4(const HWAddr&) const {
+        return (Lease4Collection());
+    }
+
+    virtual Lease4Ptr getLease4(const HWAddr&, SubnetID) const {
+        return (Lease4Ptr());
+    }
+
+    virtual Lease4Collection getLease4(const ClientId&) const {
+        return (Lease4Collection());
+    }
+
+    virtual Lease4Ptr getLease4(const ClientId&, const HWAddr&,
+                                SubnetID) const {
+        return (Lease4Ptr());
+    }
+
+    virtual Lease4Ptr getLease4(const ClientId&, SubnetID) const {
+        return (Lease4Ptr());
+    }
+
+    virtual Lease6Ptr getLease6(Lease::Type type, const IOAddress& addr) const {
+        ++lookups_;
+        std::map<IOAddress, Lease6Ptr>::const_iterator l = leases6_.find(addr);
+        return ((l != leases6_.end()) && (l->second->type_ == type) ?
+                Lease6Ptr(new Lease6(*l->second)) : Lease6Ptr());
+    }
+
+    virtual Lease6Collection getLeases6(Lease::Type, const DUID&,
+                                        uint32_t) const {
+        return (Lease6Collection());
+    }
+
+    virtual Lease6Collection getLeases6(Lease::Type, const DUID&,
+                                        uint32_t, SubnetID) const {
+        return (Lease6Collection());
+    }
+
+    virtual void getExpiredLeases6(Lease6Collection&, const size_t) const {
+    }
+
+    virtual void getExpiredLeases4(Lease4Collection&, const size_t) const {
+    }
+
+    virtual void updateLease4(const Lease4Ptr& lease) {
+        leases4_[lease->addr_] = Lease4Ptr(new Lease4(*lease));
+    }
+
+    virtual void updateLease6(const Lease6Ptr& lease) {
+        leases6_[lease->addr_] = Lease6Ptr(new Lease6(*lease));
+    }
+
+    virtual bool deleteLease(const IOAddress& addr) {
+        return ((leases4_.erase(addr) + leases6_.erase(addr)) > 0);
+    }
+
+    virtual uint64_t deleteExpiredReclaimedLeases4(const uint32_t) {
+        return (0);
+    }
+
+    virtual uint64_t deleteExpiredReclaimedLeases6(const uint32_t) {
+        return (0);
+    }
+
+    virtual size_t wipeLeases4(const SubnetID&) {
+        size_t wiped = leases4_.size();
+        leases4_.clear();
+        return (wiped);
+    }
+
+    virtual size_t wipeLeases6(const SubnetID&) {
+        size_t wiped = leases6_.size();
+        leases6_.clear();
+        return (wiped);
+    }
+
+    virtual std::string getType() const {
+        return (std::string("test"));
+    }
+
+    virtual std::string getName() const {
+        return (std::string("test"));
+    }
+
+    virtual std::string getDescription() const {
+        return (std::string("test lease manager"));
+    }
+
+    virtual std::pair<uint32_t, uint32_t> getVersion() const {
+        return (std::make_pair(1, 0));
+    }
+
+    virtual void commit() {
+    }
+
+    virtual void rollback() {
+    }
+
+    /// @brief Number of the lookups by address.
+    mutable int lookups_;
+
+    /// @brief The DHCPv4 leases.
+    std::map<IOAddress, Lease4Ptr> leases4_;
+
+    /// @brief The DHCPv6 leases.
+    std::map<IOAddress, Lease6Ptr> leases6_;
+};
+
+/// @brief Test fixture class for @c CachedLeaseMgr.
+class CachedLeaseMgrTest : public ::testing::Test {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// Creates the lease manager with the cache of 3 entries which
+    /// don't expire.
+    CachedLeaseMgrTest() : backend_(new TestLeaseMgr()) {
+        StatsMgr::instance().removeAll();
+        lease_mgr_.reset(new CachedLeaseMgr(backend_, 3, 0));
+    }
+
+    /// @brief Destructor.
+    virtual ~CachedLeaseMgrTest() {
+        StatsMgr::instance().removeAll();
+    }
+
+    /// @brief Creates a DHCPv4 lease.
+    ///
+    /// @param addr Address of the lease.
+    /// @param hostname Hostname of the lease.
+    Lease4Ptr createLease4(const std::string& addr,
+                           const std::string& hostname = "") const {
+        const uint8_t hwaddr[] = { 0, 1, 2, 3, 4, 5 };
+        HWAddrPtr hw(new HWAddr(hwaddr, sizeof(hwaddr), HTYPE_ETHER));
+        Lease4Ptr lease(new Lease4(IOAddress(addr), hw, ClientIdPtr(),
+                                   100, 0, 0, 1000, 1));
+        lease->hostname_ = hostname;
+        return (lease);
+    }
+
+    /// @brief Returns the integer value of the statistic.
+    ///
+    /// @param name Name of the statistic.
+    /// @return The value or -1 if the statistic doesn't exist.
+    int64_t getStat(const std::string& name) const {
+        ObservationPtr stat = StatsMgr::instance().getObservation(name);
+        return (stat ? stat->getInteger().first : -1);
+    }
+
+    /// @brief The backend owned by the lease manager.
+    TestLeaseMgr* backend_;
+
+    /// @brief The lease manager with the cache.
+    boost::scoped_ptr<CachedLeaseMgr> lease_mgr_;
+};
+
+// This test checks that the lease cache parameters are parsed.
+TEST_F(CachedLeaseMgrTest, parameters) {
+    DatabaseConnection::ParameterMap parameters;
+    EXPECT_EQ(0, CachedLeaseMgr::getCacheSize(parameters));
+    EXPECT_EQ(10, CachedLeaseMgr::getCacheTtl(parameters));
+
+    parameters["cache-size"] = "1000";
+    parameters["cache-ttl"] = "0";
+    EXPECT_EQ(1000, CachedLeaseMgr::getCacheSize(parameters));
+    EXPECT_EQ(0, CachedLeaseMgr::getCacheTtl(parameters));
+
+    parameters["cache-size"] = "big";
+    EXPECT_THROW(CachedLeaseMgr::getCacheSize(parameters),
+                 DbInvalidLeaseCache);
+    parameters["cache-ttl"] = "-5";
+    EXPECT_THROW(CachedLeaseMgr::getCacheTtl(parameters),
+                 DbInvalidLeaseCache);
+}
+
+// This test checks that the absence of the lease is cached.
+TEST_F(CachedLeaseMgrTest, negativeCaching) {
+    EXPECT_FALSE(lease_mgr_->getLease4(IOAddress("192.0.2.1")));
+    EXPECT_FALSE(lease_mgr_->getLease4(IOAddress("192.0.2.1")));
+    EXPECT_EQ(1, backend_->lookups_);
+    EXPECT_EQ(1, getStat("lease-cache-hits"));
+    EXPECT_EQ(1, getStat("lease-cache-misses"));
+
+    // The lease added through the lease manager replaces the negative
+    // entry.
+    ASSERT_TRUE(lease_mgr_->addLease(createLease4("192.0.2.1")));
+    EXPECT_TRUE(lease_mgr_->getLease4(IOAddress("192.0.2.1")));
+    EXPECT_EQ(1, backend_->lookups_);
+}
+
+// This test checks that the cached leases are copies.
+TEST_F(CachedLeaseMgrTest, copies) {
+    Lease4Ptr lease = createLease4("192.0.2.1", "first.example.org");
+    ASSERT_TRUE(lease_mgr_->addLease(lease));
+    lease->hostname_ = "modified.example.org";
+
+    Lease4Ptr lease1 = lease_mgr_->getLease4(IOAddress("192.0.2.1"));
+    ASSERT_TRUE(lease1);
+    EXPECT_EQ("first.example.org", lease1->hostname_);
+    lease1->hostname_ = "modified.example.org";
+
+    Lease4Ptr lease2 = lease_mgr_->getLease4(IOAddress("192.0.2.1"));
+    ASSERT_TRUE(lease2);
+    EXPECT_NE(lease1, lease2);
+    EXPECT_EQ("first.example.org", lease2->hostname_);
+    EXPECT_EQ(0, backend_->lookups_);
+}
+
+// This test checks that the updates and deletes made through the lease
+// manager are reflected in the cache.
+TEST_F(CachedLeaseMgrTest, writeThrough) {
+    ASSERT_TRUE(lease_mgr_->addLease(createLease4("192.0.2.1")));
+
+    lease_mgr_->updateLease4(createLease4("192.0.2.1", "updated.example.org"));
+    Lease4Ptr lease = lease_mgr_->getLease4(IOAddress("192.0.2.1"));
+    ASSERT_TRUE(lease);
+    EXPECT_EQ("updated.example.org", lease->hostname_);
+    EXPECT_EQ(0, backend_->lookups_);
+
+    EXPECT_TRUE(lease_mgr_->deleteLease(IOAddress("192.0.2.1")));
+    EXPECT_FALSE(lease_mgr_->getLease4(IOAddress("192.0.2.1")));
+    EXPECT_EQ(1, backend_->lookups_);
+
+    // The lease added by another server is not visible until the negative
+    // entry is removed.
+    ASSERT_TRUE(backend_->addLease(createLease4("192.0.2.1")));
+    EXPECT_FALSE(lease_mgr_->getLease4(IOAddress("192.0.2.1")));
+    lease_mgr_->wipeLeases4(1);
+    EXPECT_EQ(0, lease_mgr_->getCacheCount());
+}
+
+// This test checks that the adding of the existing lease removes the
+// negative entry.
+TEST_F(CachedLeaseMgrTest, addExisting) {
+    ASSERT_TRUE(backend_->addLease(createLease4("192.0.2.1")));
+    lease_mgr_->clearCache();
+    backend_->leases4_.clear();
+    EXPECT_FALSE(lease_mgr_->getLease4(IOAddress("192.0.2.1")));
+
+    ASSERT_TRUE(backend_->addLease(createLease4("192.0.2.1")));
+    EXPECT_FALSE(lease_mgr_->addLease(createLease4("192.0.2.1")));
+    EXPECT_TRUE(lease_mgr_->getLease4(IOAddress("192.0.2.1")));
+    EXPECT_EQ(2, backend_->lookups_);
+}
+
+// This test checks that the least recently used entries are removed
+// when the cache is full.
+TEST_F(CachedLeaseMgrTest, leastRecentlyUsed) {
+    lease_mgr_->getLease4(IOAddress("192.0.2.1"));
+    lease_mgr_->getLease4(IOAddress("192.0.2.2"));
+    lease_mgr_->getLease4(IOAddress("192.0.2.3"));
+    EXPECT_EQ(3, lease_mgr_->getCacheCount());
+
+    // Use the first entry, so the second one is the least recently used.
+    lease_mgr_->getLease4(IOAddress("192.0.2.1"));
+    lease_mgr_->getLease4(IOAddress("192.0.2.4"));
+    EXPECT_EQ(3, lease_mgr_->getCacheCount());
+    EXPECT_EQ(4, backend_->lookups_);
+
+    lease_mgr_->getLease4(IOAddress("192.0.2.1"));
+    EXPECT_EQ(4, backend_->lookups_);
+    lease_mgr_->getLease4(IOAddress("192.0.2.2"));
+    EXPECT_EQ(5, backend_->lookups_);
+}
+
+// This test checks that the entries expire.
+TEST_F(CachedLeaseMgrTest, expiration) {
+    backend_ = new TestLeaseMgr();
+    lease_mgr_.reset(new CachedLeaseMgr(backend_, 3, 1));
+
+    lease_mgr_->getLease4(IOAddress("192.0.2.1"));
+    lease_mgr_->getLease4(IOAddress("192.0.2.1"));
+    EXPECT_EQ(1, backend_->lookups_);
+
+    sleep(2);
+    lease_mgr_->getLease4(IOAddress("192.0.2.1"));
+    EXPECT_EQ(2, backend_->lookups_);
+}
+
+// This test checks that the DHCPv6 leases are cached by type and address.
+TEST_F(CachedLeaseMgrTest, leases6) {
+    DuidPtr duid(new DUID(std::vector<uint8_t>(8, 0x42)));
+    Lease6Ptr lease(new Lease6(Lease::TYPE_NA, IOAddress("2001:db8:1::1"),
+                               duid, 1, 100, 200, 0, 0, 1));
+    ASSERT_TRUE(lease_mgr_->addLease(lease));
+
+    EXPECT_TRUE(lease_mgr_->getLease6(Lease::TYPE_NA,
+                                      IOAddress("2001:db8:1::1")));
+    EXPECT_EQ(0, backend_->lookups_);
+    EXPECT_FALSE(lease_mgr_->getLease6(Lease::TYPE_TA,
+                                       IOAddress("2001:db8:1::1")));
+    EXPECT_EQ(1, backend_->lookups_);
+
+    // Deleting the lease removes the entries of all types.
+    EXPECT_TRUE(lease_mgr_->deleteLease(IOAddress("2001:db8:1::1")));
+    EXPECT_EQ(0, lease_mgr_->getCacheCount());
+}
+
+// This is a performance benchmark measuring the lookups by address served
+// from the cache (hits) and forwarded to the backend (misses), with and
+// without the expiration of the entries. The addresses are looked up in
+// a round robin fashion. The cache holding all of them serves every
+// lookup, while the cache holding a tenth of them evicts each entry before
+// it is used again. Half of the addresses have leases. The backend holds
+// the leases in memory, so the results show the overhead of the cache.
+TEST_F(CachedLeaseMgrTest, DISABLED_performanceLookups) {
+    const size_t addresses = 10000;
+    const uint32_t lookups = 1000000;
+    const size_t sizes[] = { addresses, addresses / 10 };
+    const uint32_t ttls[] = { 0, 10 };
+
+    std::vector<IOAddress> addrs;
+    for (size_t i = 0; i < addresses; ++i) {
+        addrs.push_back(IOAddress(IOAddress("10.0.0.0").toUint32() + i));
+    }
+
+    for (unsigned t = 0; t < sizeof(ttls) / sizeof(ttls[0]); ++t) {
+        for (unsigned s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+            backend_ = new TestLeaseMgr();
+            lease_mgr_.reset(new CachedLeaseMgr(backend_, sizes[s], ttls[t]));
+            for (size_t i = 0; i < addrs.size(); i += 2) {
+                ASSERT_TRUE(backend_->addLease(createLease4(addrs[i].toText())));
+            }
+            // Populate the cache.
+            for (size_t i = 0; i < addrs.size(); ++i) {
+                lease_mgr_->getLease4(addrs[i]);
+            }
+            backend_->lookups_ = 0;
+
+            ptime before = microsec_clock::local_time();
+            for (uint32_t i = 0; i < lookups; ++i) {
+                lease_mgr_->getLease4(addrs[i % addrs.size()]);
+            }
+            time_duration dur = microsec_clock::local_time() - before;
+
+            std::cout << lookups << " lookups with cache-size " << sizes[s]
+                      << " and cache-ttl " << ttls[t] << " took: "
+                      << isc::util::durationToText(dur) << " ("
+                      << backend_->lookups_ << " misses)" << std::endl;
+        }
+    }
+
+    // Compare with the lookups made directly against the backend.
+    ptime before = microsec_clock::local_time();
+    for (uint32_t i = 0; i < lookups; ++i) {
+        backend_->getLease4(addrs[i % addrs.size()]);
+    }
+    time_duration dur = microsec_clock::local_time() - before;
+    std::cout << lookups << " lookups without the cache took: "
+              << isc::util::durationToText(dur) << std::endl;
+}
+
+} // end of anonymous namespace
@@ -94,6 +94,30 @@ TEST(CalloutHandleStoreTest, StoreRetrieve) {
     EXPECT_EQ(1, pktptr_2.use_count());
 }
 
+// Checks that the association of a packet with its CalloutHandle can be
+// restored after another packet has been processed, as it is done when the
+// processing of a parked packet is resumed.
+TEST(CalloutHandleStoreTest, Restore) {
+    Pkt4Ptr pktptr_1(new Pkt4(DHCPDISCOVER, 1234));
+    Pkt4Ptr pktptr_2(new Pkt4(DHCPDISCOVER, 5678));
+
+    CalloutHandlePtr chptr_1 = getCalloutHandle(pktptr_1);
+    ASSERT_TRUE(chptr_1);
+    CalloutHandlePtr chptr_2 = getCalloutHandle(pktptr_2);
+    EXPECT_FALSE(chptr_1 == chptr_2);
+
+    // The first packet is associated with its handle again.
+    restoreCalloutHandle(pktptr_1, chptr_1);
+    EXPECT_TRUE(getCalloutHandle(pktptr_1) == chptr_1);
+    EXPECT_EQ(2, pktptr_1.use_count());
+    EXPECT_EQ(1, pktptr_2.use_count());
+
+    // Clear the stored pointers.
+    getCalloutHandle(Pkt4Ptr());
+    EXPECT_EQ(1, pktptr_1.use_count());
+    EXPECT_EQ(1, chptr_1.use_count());
+}
+
 // The followings is a trivial test to check that if the template function
 // is referred to in a separate compilation unit, only one copy of the static
 // objects stored in it are returned.  (For a change, we'll use a Pkt6 as the
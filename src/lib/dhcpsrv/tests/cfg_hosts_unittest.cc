@@ -8,17 +8,25 @@
 #include <asiolink/io_address.h>
 #include <dhcp/duid.h>
 #include <dhcp/hwaddr.h>
+#include <dhcp/option_space.h>
 #include <dhcpsrv/cfg_hosts.h>
 #include <dhcpsrv/cfg_hosts_util.h>
 #include <dhcpsrv/host.h>
 #include <dhcpsrv/cfgmgr.h>
+#include <util/boost_time_utils.h>
+#include <boost/date_time/posix_time/posix_time.hpp>
 #include <gtest/gtest.h>
+#include <fstream>
+#include <iostream>
 #include <sstream>
 #include <set>
+#include <unistd.h>
 
 using namespace isc;
 using namespace isc::dhcp;
 using namespace isc::asiolink;
+using namespace isc::util;
+using namespace boost::posix_time;
 
 namespace {
 
@@ -46,6 +54,27 @@ public:
     /// @param address Address to be increased.
     IOAddress increase(const IOAddress& address, const uint8_t num) const;
 
+    /// @brief Returns the resident set size of the process.
+    ///
+    /// @return Resident set size in bytes or 0 if it is not available.
+    static size_t getRss();
+
+    /// @brief Returns a host identified by the HW address built from
+    /// the counter.
+    ///
+    /// The host is connected to one of 100 IPv4 subnets and has one of
+    /// 10 option data configurations.
+    ///
+    /// @param counter Value making the HW address and the reserved address
+    /// unique.
+    static HostPtr createHost(const uint32_t counter);
+
+    /// @brief Measures the memory used by the specified number of hosts
+    /// and the time of the lookups by HW address and subnet.
+    ///
+    /// @param hosts_num Number of hosts.
+    static void testPerformance(const uint32_t hosts_num);
+
     /// @brief Collection of HW address objects allocated for unit tests.
     std::vector<HWAddrPtr> hwaddrs_;
     /// @brief Collection of DUIDs allocated for unit tests.
@@ -98,6 +127,88 @@ CfgHostsTest::increase(const IOAddress& address, const uint8_t num) const {
     return (address);
 }
 
+size_t
+CfgHostsTest::getRss() {
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0;
+    size_t resident = 0;
+    if (!(statm >> pages >> resident)) {
+        return (0);
+    }
+    return (resident * sysconf(_SC_PAGESIZE));
+}
+
+HostPtr
+CfgHostsTest::createHost(const uint32_t counter) {
+    std::vector<uint8_t> hwaddr(6, 0);
+    for (size_t i = 0; i < 4; ++i) {
+        hwaddr[hwaddr.size() - 1 - i] = (counter >> (8 * i)) & 0xFF;
+    }
+    HostPtr host(new Host(&hwaddr[0], hwaddr.size(), Host::IDENT_HWADDR,
+                          SubnetID(counter % 100 + 1), SubnetID(0),
+                          IOAddress(0x0a000000 + counter)));
+    OptionBuffer data(1, counter % 10);
+    host->getCfgOption4()->add(OptionPtr(new Option(Option::V4, 224, data)),
+                               false, DHCP4_OPTION_SPACE);
+    return (host);
+}
+
+void
+CfgHostsTest::testPerformance(const uint32_t hosts_num) {
+    const uint32_t lookups = 100000;
+
+    size_t rss_before = getRss();
+    ptime before = microsec_clock::local_time();
+    CfgHosts cfg;
+    for (uint32_t i = 0; i < hosts_num; ++i) {
+        cfg.add(createHost(i));
+    }
+    time_duration add_dur = microsec_clock::local_time() - before;
+    size_t rss_after = getRss();
+
+    // Look up the reserved hosts spread over the configuration.
+    std::vector<uint8_t> hwaddr(6, 0);
+    size_t found = 0;
+    before = microsec_clock::local_time();
+    for (uint32_t i = 0; i < lookups; ++i) {
+        uint32_t counter = (i * 7919) % hosts_num;
+        for (size_t j = 0; j < 4; ++j) {
+            hwaddr[hwaddr.size() - 1 - j] = (counter >> (8 * j)) & 0xFF;
+        }
+        if (cfg.get4(SubnetID(counter % 100 + 1), Host::IDENT_HWADDR,
+                     &hwaddr[0], hwaddr.size())) {
+            ++found;
+        }
+    }
+    time_duration hit_dur = microsec_clock::local_time() - before;
+    EXPECT_EQ(lookups, found);
+
+    // Look up the clients without reservations.
+    hwaddr[0] = 1;
+    found = 0;
+    before = microsec_clock::local_time();
+    for (uint32_t i = 0; i < lookups; ++i) {
+        if (cfg.get4(SubnetID(i % 100 + 1), Host::IDENT_HWADDR,
+                     &hwaddr[0], hwaddr.size())) {
+            ++found;
+        }
+    }
+    time_duration miss_dur = microsec_clock::local_time() - before;
+    EXPECT_EQ(0, found);
+
+    std::cout << "adding " << hosts_num << " hosts took: "
+              << durationToText(add_dur) << ", resident memory grew by: ";
+    if ((rss_before > 0) && (rss_after >= rss_before)) {
+        std::cout << (rss_after - rss_before) / 1024 << " KiB";
+    } else {
+        std::cout << "n/a";
+    }
+    std::cout << std::endl << lookups << " lookups of reserved hosts took: "
+              << durationToText(hit_dur) << ", " << lookups
+              << " lookups of not reserved hosts took: "
+              << durationToText(miss_dur) << std::endl;
+}
+
 // This test checks that hosts with unique HW addresses and DUIDs can be
 // retrieved from the host configuration.
 TEST_F(CfgHostsTest, getAllNonRepeatingHosts) {
@@ -758,5 +869,46 @@ TEST_F(CfgHostsTest, duplicatesSubnet6DUID) {
                                              "foo.example.com"))));
 }
 
+// This test checks that the hosts having identical options share the
+// option data configuration.
+TEST_F(CfgHostsTest, shareCfgOption) {
+    CfgHosts cfg;
+    // The hosts 0 and 10 have the same options, the host 1 has different
+    // options.
+    HostPtr host0 = createHost(0);
+    HostPtr host1 = createHost(1);
+    HostPtr host10 = createHost(10);
+    ASSERT_NO_THROW(cfg.add(host0));
+    ASSERT_NO_THROW(cfg.add(host1));
+    ASSERT_NO_THROW(cfg.add(host10));
+
+    EXPECT_TRUE(host0->getCfgOption4() == host10->getCfgOption4());
+    EXPECT_FALSE(host0->getCfgOption4() == host1->getCfgOption4());
+    // The hosts have no DHCPv6 options, so they share the empty
+    // configuration.
+    EXPECT_TRUE(host0->getCfgOption6() == host1->getCfgOption6());
+    EXPECT_TRUE(host0->getCfgOption6()->empty());
+
+    // The options are returned for the hosts.
+    HostPtr host = cfg.get4(SubnetID(11), Host::IDENT_HWADDR,
+                            &host10->getIdentifier()[0],
+                            host10->getIdentifier().size());
+    ASSERT_TRUE(host);
+    OptionDescriptor desc =
+        host->getCfgOption4()->get(DHCP4_OPTION_SPACE, 224);
+    ASSERT_TRUE(desc.option_);
+    EXPECT_EQ(OptionBuffer(1, 0), desc.option_->getData());
+}
+
+// The following tests measure the memory used by 100 thousand and 1 million
+// reservations and the time of the lookups. They are disabled, because they
+// are slow.
+TEST_F(CfgHostsTest, DISABLED_performance100k) {
+    testPerformance(100000);
+}
+
+TEST_F(CfgHostsTest, DISABLED_performance1M) {
+    testPerformance(1000000);
+}
 
 } // end of anonymous namespace
@@ -13,7 +13,10 @@
 #include <dhcpsrv/subnet_id.h>
 #include <dhcpsrv/subnet_selector.h>
 #include <testutils/test_to_element.h>
+#include <util/boost_time_utils.h>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <gtest/gtest.h>
+#include <iostream>
 #include <vector>
 
 using namespace isc;
@@ -21,6 +24,8 @@ using namespace isc::asiolink;
 using namespace isc::dhcp;
 using namespace isc::dhcp::test;
 using namespace isc::test;
+using namespace isc::util;
+using namespace boost::posix_time;
 
 namespace {
 
@@ -856,4 +861,200 @@ TEST(CfgSubnets4Test, getSubnet) {
     EXPECT_EQ(Subnet4Ptr(), cfg.getSubnet(400)); // no such subnet
 }
 
+// This test verifies that the subnets selected using the selection index
+// are the same as the subnets selected with the full scan, including the
+// overlapping prefixes, client classes and shared networks.
+TEST(CfgSubnets4Test, selectSubnetIndexed) {
+    CfgSubnets4 cfg;
+
+    // The first subnet includes the second one, but it is only available
+    // to the clients in the foo class.
+    Subnet4Ptr subnet1(new Subnet4(IOAddress("10.0.0.0"), 8, 1, 2, 3));
+    Subnet4Ptr subnet2(new Subnet4(IOAddress("10.1.0.0"), 16, 1, 2, 3));
+    Subnet4Ptr subnet3(new Subnet4(IOAddress("192.0.2.0"), 26, 1, 2, 3));
+    Subnet4Ptr subnet4(new Subnet4(IOAddress("192.0.2.64"), 26, 1, 2, 3));
+    subnet1->allowClientClass("foo");
+    subnet3->setRelayInfo(IOAddress("10.2.0.1"));
+    subnet3->setIface("eth1");
+
+    cfg.add(subnet1);
+    cfg.add(subnet2);
+    cfg.add(subnet3);
+    cfg.add(subnet4);
+
+    // The relay address and interface of the last subnet are specified
+    // on the shared network level.
+    SharedNetwork4Ptr network(new SharedNetwork4("network"));
+    network->setRelayInfo(IOAddress("10.2.0.2"));
+    network->setIface("eth2");
+    network->add(subnet4);
+
+    std::vector<SubnetSelector> selectors;
+    SubnetSelector selector;
+    selector.local_address_ = IOAddress("10.0.0.10");
+    const char* ciaddrs[] = { "10.1.2.3", "10.3.2.1", "192.0.2.70",
+                              "192.0.2.200" };
+    for (size_t i = 0; i < sizeof(ciaddrs) / sizeof(ciaddrs[0]); ++i) {
+        selector.ciaddr_ = IOAddress(ciaddrs[i]);
+        selectors.push_back(selector);
+    }
+    selector.ciaddr_ = IOAddress::IPV4_ZERO_ADDRESS();
+    const char* giaddrs[] = { "10.2.0.1", "10.2.0.2", "10.1.0.1",
+                              "172.16.0.1" };
+    for (size_t i = 0; i < sizeof(giaddrs) / sizeof(giaddrs[0]); ++i) {
+        selector.giaddr_ = IOAddress(giaddrs[i]);
+        selectors.push_back(selector);
+    }
+
+    // Run all selectors without and with the foo class.
+    for (size_t i = 0, size = selectors.size(); i < size; ++i) {
+        selectors.push_back(selectors[i]);
+        selectors.back().client_classes_.insert("foo");
+    }
+    std::vector<Subnet4Ptr> expected;
+    for (auto sel = selectors.cbegin(); sel != selectors.cend(); ++sel) {
+        expected.push_back(cfg.selectSubnet(*sel));
+    }
+    Subnet4Ptr expected_eth1 = cfg.selectSubnet("eth1", ClientClasses());
+    Subnet4Ptr expected_eth2 = cfg.selectSubnet("eth2", ClientClasses());
+
+    ASSERT_FALSE(cfg.hasSelectionIndex());
+    ASSERT_NO_THROW(cfg.buildSelectionIndex());
+    ASSERT_TRUE(cfg.hasSelectionIndex());
+
+    std::vector<Subnet4Ptr> selected;
+    for (auto sel = selectors.cbegin(); sel != selectors.cend(); ++sel) {
+        selected.push_back(cfg.selectSubnet(*sel));
+    }
+    ASSERT_EQ(expected.size(), selected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(expected[i], selected[i]) << "selector " << i;
+    }
+    EXPECT_EQ(expected_eth1, cfg.selectSubnet("eth1", ClientClasses()));
+    EXPECT_EQ(expected_eth2, cfg.selectSubnet("eth2", ClientClasses()));
+
+    // Check a few of the results explicitly.
+    EXPECT_EQ(subnet2, selected[0]);
+    EXPECT_FALSE(selected[1]);
+    EXPECT_EQ(subnet3, selected[4]);
+    EXPECT_EQ(subnet4, selected[5]);
+    EXPECT_EQ(subnet1, selected[8]);
+    EXPECT_EQ(subnet1, selected[9]);
+    EXPECT_EQ(subnet3, expected_eth1);
+    EXPECT_EQ(subnet4, expected_eth2);
+}
+
+// This test verifies that the selection index is updated when the subnets
+// are added or removed.
+TEST(CfgSubnets4Test, selectionIndexAddDelete) {
+    CfgSubnets4 cfg;
+
+    Subnet4Ptr subnet1(new Subnet4(IOAddress("192.0.2.0"), 26, 1, 2, 3, 1));
+    Subnet4Ptr subnet2(new Subnet4(IOAddress("192.0.2.64"), 26, 1, 2, 3, 2));
+    Subnet4Ptr subnet3(new Subnet4(IOAddress("192.0.2.128"), 26, 1, 2, 3, 3));
+    subnet3->setRelayInfo(IOAddress("10.0.0.3"));
+
+    cfg.add(subnet1);
+    cfg.add(subnet2);
+    cfg.buildSelectionIndex();
+
+    EXPECT_EQ(subnet2, cfg.selectSubnet(IOAddress("192.0.2.65")));
+    EXPECT_FALSE(cfg.selectSubnet(IOAddress("192.0.2.129")));
+
+    ASSERT_NO_THROW(cfg.add(subnet3));
+    EXPECT_EQ(subnet3, cfg.selectSubnet(IOAddress("192.0.2.129")));
+
+    // Removing the first subnet shifts the positions of the others.
+    ASSERT_NO_THROW(cfg.del(subnet1));
+    EXPECT_FALSE(cfg.selectSubnet(IOAddress("192.0.2.1")));
+    EXPECT_EQ(subnet2, cfg.selectSubnet(IOAddress("192.0.2.65")));
+
+    SubnetSelector selector;
+    selector.giaddr_ = IOAddress("10.0.0.3");
+    EXPECT_EQ(subnet3, cfg.selectSubnet(selector));
+}
+
+// This test verifies that the DHCPv4o6 subnet selection using the index
+// returns the first subnet matching any of the criteria.
+TEST(CfgSubnets4Test, 4o6subnetMatchIndexed) {
+    CfgSubnets4 cfg;
+
+    Subnet4Ptr subnet1(new Subnet4(IOAddress("192.0.2.0"), 26, 1, 2, 3, 123));
+    Subnet4Ptr subnet2(new Subnet4(IOAddress("192.0.2.64"), 26, 1, 2, 3, 124));
+    Subnet4Ptr subnet3(new Subnet4(IOAddress("192.0.2.128"), 26, 1, 2, 3, 125));
+
+    const uint8_t payload[] = { 1, 2, 3, 4 };
+    std::vector<uint8_t> data(payload, payload + sizeof(payload));
+    OptionPtr interface_id(new Option(Option::V6, D6O_INTERFACE_ID, data));
+
+    subnet1->get4o6().setIface4o6("eth7");
+    subnet2->get4o6().setInterfaceId(interface_id);
+    subnet3->get4o6().setSubnet4o6(IOAddress("2001:db8:1::"), 48);
+
+    cfg.add(subnet1);
+    cfg.add(subnet2);
+    cfg.add(subnet3);
+    cfg.buildSelectionIndex();
+
+    SubnetSelector selector;
+    selector.dhcp4o6_ = true;
+    selector.remote_address_ = IOAddress("2001:db8:1::dead:beef");
+    EXPECT_EQ(subnet3, cfg.selectSubnet4o6(selector));
+
+    selector.interface_id_ = interface_id;
+    EXPECT_EQ(subnet2, cfg.selectSubnet4o6(selector));
+
+    selector.iface_name_ = "eth7";
+    EXPECT_EQ(subnet1, cfg.selectSubnet4o6(selector));
+
+    selector.remote_address_ = IOAddress("2001:db8:2::1");
+    selector.interface_id_.reset();
+    selector.iface_name_ = "eth5";
+    EXPECT_FALSE(cfg.selectSubnet4o6(selector));
+}
+
+// This is a performance benchmark comparing the subnet selection by
+// the relay address and by the address with and without the selection
+// index for 10^2 to 10^5 subnets.
+TEST(CfgSubnets4Test, DISABLED_performanceSelectSubnet) {
+    const uint32_t lookups = 10000;
+    for (uint32_t subnets = 100; subnets <= 100000; subnets *= 10) {
+        CfgSubnets4 cfg;
+        for (uint32_t i = 0; i < subnets; ++i) {
+            Subnet4Ptr subnet(new Subnet4(IOAddress(0x0a000000 + (i << 8)),
+                                          24, 1, 2, 3, i + 1));
+            subnet->setRelayInfo(IOAddress(0x0a000001 + (i << 8)));
+            cfg.add(subnet);
+        }
+
+        for (int indexed = 0; indexed < 2; ++indexed) {
+            if (indexed) {
+                cfg.buildSelectionIndex();
+            }
+            SubnetSelector selector;
+            ptime before = microsec_clock::local_time();
+            for (uint32_t i = 0; i < lookups; ++i) {
+                // Use the relay address of a different subnet every time.
+                selector.giaddr_ = IOAddress(0x0a000001 +
+                                             (((i * 7919) % subnets) << 8));
+                ASSERT_TRUE(cfg.selectSubnet(selector));
+            }
+            time_duration relay_dur = microsec_clock::local_time() - before;
+
+            before = microsec_clock::local_time();
+            for (uint32_t i = 0; i < lookups; ++i) {
+                ASSERT_TRUE(cfg.selectSubnet(IOAddress(0x0a000002 +
+                                             (((i * 7919) % subnets) << 8))));
+            }
+            time_duration addr_dur = microsec_clock::local_time() - before;
+
+            std::cout << lookups << " selections among " << subnets
+                      << " subnets " << (indexed ? "with" : "without")
+                      << " index took: " << durationToText(relay_dur)
+                      << " (relay), " << durationToText(addr_dur)
+                      << " (address)" << std::endl;
+        }
+    }
+}
+
 } // end of anonymous namespace
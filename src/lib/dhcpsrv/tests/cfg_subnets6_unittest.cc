@@ -13,13 +13,20 @@
 #include <dhcpsrv/subnet_id.h>
 #include <dhcpsrv/subnet_selector.h>
 #include <testutils/test_to_element.h>
+#include <util/boost_time_utils.h>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <gtest/gtest.h>
+#include <iostream>
+#include <sstream>
 #include <string>
+#include <vector>
 
 using namespace isc;
 using namespace isc::asiolink;
 using namespace isc::dhcp;
 using namespace isc::test;
+using namespace isc::util;
+using namespace boost::posix_time;
 
 namespace {
 
@@ -32,6 +39,20 @@ generateInterfaceId(const std::string& text) {
     return OptionPtr(new Option(Option::V6, D6O_INTERFACE_ID, buffer));
 }
 
+/// @brief Returns the address in the specified /64 prefix.
+///
+/// @param first First 32 bits of the prefix in a textual format.
+/// @param prefix Next 32 bits of the prefix.
+/// @param host Last 16 bits of the address.
+IOAddress
+prefixAddress(const std::string& first, const uint32_t prefix,
+              const uint16_t host) {
+    std::ostringstream s;
+    s << first << ":" << std::hex << (prefix >> 16) << ":"
+      << (prefix & 0xffff) << "::" << host;
+    return (IOAddress(s.str()));
+}
+
 // This test verifies that specific subnet can be retrieved by specifying
 // subnet identifier or subnet prefix.
 TEST(CfgSubnets6Test, getSpecificSubnet) {
@@ -603,4 +624,170 @@ TEST(CfgSubnets6Test, getSubnet) {
     EXPECT_EQ(Subnet6Ptr(), cfg.getSubnet(400)); // no such subnet
 }
 
+// This test verifies that the subnets selected using the selection index
+// are the same as the subnets selected with the full scan.
+TEST(CfgSubnets6Test, selectSubnetIndexed) {
+    CfgSubnets6 cfg;
+
+    // The first subnet includes the second one, but it is only available
+    // to the clients in the foo class.
+    Subnet6Ptr subnet1(new Subnet6(IOAddress("2001:db8::"), 32, 1, 2, 3, 4));
+    Subnet6Ptr subnet2(new Subnet6(IOAddress("2001:db8:1::"), 48, 1, 2, 3, 4));
+    Subnet6Ptr subnet3(new Subnet6(IOAddress("3000::"), 64, 1, 2, 3, 4));
+    Subnet6Ptr subnet4(new Subnet6(IOAddress("4000::"), 64, 1, 2, 3, 4));
+    subnet1->allowClientClass("foo");
+    subnet3->setRelayInfo(IOAddress("5000::1"));
+    subnet3->setIface("eth1");
+    subnet4->setInterfaceId(generateInterfaceId("relay4"));
+
+    cfg.add(subnet1);
+    cfg.add(subnet2);
+    cfg.add(subnet3);
+    cfg.add(subnet4);
+
+    std::vector<SubnetSelector> selectors;
+    SubnetSelector selector;
+    const char* addresses[] = { "2001:db8:1::1", "2001:db8:2::1", "3000::1",
+                                "6000::1" };
+    for (size_t i = 0; i < sizeof(addresses) / sizeof(addresses[0]); ++i) {
+        selector.remote_address_ = IOAddress(addresses[i]);
+        selectors.push_back(selector);
+    }
+    selector.remote_address_ = IOAddress("fe80::1");
+    selector.iface_name_ = "eth1";
+    selectors.push_back(selector);
+    selector.iface_name_.clear();
+    const char* linkaddrs[] = { "5000::1", "2001:db8:1::1", "6000::1" };
+    for (size_t i = 0; i < sizeof(linkaddrs) / sizeof(linkaddrs[0]); ++i) {
+        selector.first_relay_linkaddr_ = IOAddress(linkaddrs[i]);
+        selectors.push_back(selector);
+    }
+    selector.interface_id_ = generateInterfaceId("relay4");
+    selectors.push_back(selector);
+    selector.interface_id_ = generateInterfaceId("relay5");
+    selectors.push_back(selector);
+
+    // Run all selectors without and with the foo class.
+    for (size_t i = 0, size = selectors.size(); i < size; ++i) {
+        selectors.push_back(selectors[i]);
+        selectors.back().client_classes_.insert("foo");
+    }
+    std::vector<Subnet6Ptr> expected;
+    for (auto sel = selectors.cbegin(); sel != selectors.cend(); ++sel) {
+        expected.push_back(cfg.selectSubnet(*sel));
+    }
+
+    ASSERT_FALSE(cfg.hasSelectionIndex());
+    ASSERT_NO_THROW(cfg.buildSelectionIndex());
+    ASSERT_TRUE(cfg.hasSelectionIndex());
+
+    std::vector<Subnet6Ptr> selected;
+    for (auto sel = selectors.cbegin(); sel != selectors.cend(); ++sel) {
+        selected.push_back(cfg.selectSubnet(*sel));
+    }
+    ASSERT_EQ(expected.size(), selected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(expected[i], selected[i]) << "selector " << i;
+    }
+
+    // Check a few of the results explicitly.
+    EXPECT_EQ(subnet2, selected[0]);
+    EXPECT_FALSE(selected[1]);
+    EXPECT_EQ(subnet3, selected[4]);
+    EXPECT_EQ(subnet3, selected[5]);
+    EXPECT_EQ(subnet2, selected[6]);
+    EXPECT_EQ(subnet4, selected[8]);
+    EXPECT_FALSE(selected[9]);
+    EXPECT_EQ(subnet1, selected[10]);
+    EXPECT_EQ(subnet1, selected[11]);
+}
+
+// This test verifies that the selection index is updated when the subnets
+// are added or removed.
+TEST(CfgSubnets6Test, selectionIndexAddDelete) {
+    CfgSubnets6 cfg;
+
+    Subnet6Ptr subnet1(new Subnet6(IOAddress("2000::"), 48, 1, 2, 3, 4, 1));
+    Subnet6Ptr subnet2(new Subnet6(IOAddress("3000::"), 48, 1, 2, 3, 4, 2));
+    Subnet6Ptr subnet3(new Subnet6(IOAddress("4000::"), 48, 1, 2, 3, 4, 3));
+    subnet3->setRelayInfo(IOAddress("5000::3"));
+
+    cfg.add(subnet1);
+    cfg.add(subnet2);
+    cfg.buildSelectionIndex();
+
+    EXPECT_EQ(subnet2, cfg.selectSubnet(IOAddress("3000::1")));
+    EXPECT_FALSE(cfg.selectSubnet(IOAddress("4000::1")));
+
+    ASSERT_NO_THROW(cfg.add(subnet3));
+    EXPECT_EQ(subnet3, cfg.selectSubnet(IOAddress("4000::1")));
+
+    // Removing the first subnet shifts the positions of the others.
+    ASSERT_NO_THROW(cfg.del(subnet1));
+    EXPECT_FALSE(cfg.selectSubnet(IOAddress("2000::1")));
+    EXPECT_EQ(subnet2, cfg.selectSubnet(IOAddress("3000::1")));
+    EXPECT_EQ(subnet3, cfg.selectSubnet(IOAddress("5000::3"), ClientClasses(),
+                                        true));
+}
+
+// This is a performance benchmark comparing the subnet selection by
+// the relay address, by the interface and by the address with and
+// without the selection index for 10^2 to 10^5 subnets.
+TEST(CfgSubnets6Test, DISABLED_performanceSelectSubnet) {
+    const uint32_t lookups = 1000;
+    for (uint32_t subnets = 100; subnets <= 100000; subnets *= 10) {
+        CfgSubnets6 cfg;
+        for (uint32_t i = 0; i < subnets; ++i) {
+            Subnet6Ptr subnet(new Subnet6(prefixAddress("2001:db8", i, 0),
+                                          64, 1, 2, 3, 4, i + 1));
+            subnet->setRelayInfo(prefixAddress("3000:db8", i, 1));
+            std::ostringstream iface;
+            iface << "eth" << i;
+            subnet->setIface(iface.str());
+            cfg.add(subnet);
+        }
+
+        for (int indexed = 0; indexed < 2; ++indexed) {
+            if (indexed) {
+                cfg.buildSelectionIndex();
+            }
+            // Use a different subnet every time.
+            SubnetSelector selector;
+            ptime before = microsec_clock::local_time();
+            for (uint32_t i = 0; i < lookups; ++i) {
+                selector.first_relay_linkaddr_ =
+                    prefixAddress("3000:db8", (i * 7919) % subnets, 1);
+                ASSERT_TRUE(cfg.selectSubnet(selector));
+            }
+            time_duration relay_dur = microsec_clock::local_time() - before;
+
+            selector = SubnetSelector();
+            selector.remote_address_ = IOAddress("fe80::1");
+            before = microsec_clock::local_time();
+            for (uint32_t i = 0; i < lookups; ++i) {
+                std::ostringstream iface;
+                iface << "eth" << (i * 7919) % subnets;
+                selector.iface_name_ = iface.str();
+                ASSERT_TRUE(cfg.selectSubnet(selector));
+            }
+            time_duration iface_dur = microsec_clock::local_time() - before;
+
+            before = microsec_clock::local_time();
+            for (uint32_t i = 0; i < lookups; ++i) {
+                ASSERT_TRUE(cfg.selectSubnet(prefixAddress("2001:db8",
+                                                           (i * 7919) % subnets,
+                                                           2)));
+            }
+            time_duration addr_dur = microsec_clock::local_time() - before;
+
+            std::cout << lookups << " selections among " << subnets
+                      << " subnets " << (indexed ? "with" : "without")
+                      << " index took: " << durationToText(relay_dur)
+                      << " (relay), " << durationToText(iface_dur)
+                      << " (interface), " << durationToText(addr_dur)
+                      << " (address)" << std::endl;
+        }
+    }
+}
+
 } // end of anonymous namespace
@@ -7,8 +7,10 @@
 #include <config.h>
 #include <dhcpsrv/client_class_def.h>
 #include <dhcpsrv/cfgmgr.h>
+#include <dhcp/dhcp4.h>
 #include <dhcp/libdhcp++.h>
 #include <dhcp/option_space.h>
+#include <dhcp/pkt4.h>
 #include <testutils/test_to_element.h>
 #include <exceptions/exceptions.h>
 #include <boost/scoped_ptr.hpp>
@@ -52,6 +54,37 @@ TEST(ClientClassDef, construction) {
     EXPECT_TRUE(cfg_option->empty());
 }
 
+// Tests that the match expression is compiled.
+TEST(ClientClassDef, compiledMatchExpr) {
+    boost::scoped_ptr<ClientClassDef> cclass;
+
+    // No expression, nothing to compile.
+    ASSERT_NO_THROW(cclass.reset(new ClientClassDef("class1", ExpressionPtr())));
+    EXPECT_FALSE(cclass->getCompiledMatchExpr());
+
+    // A malformed expression is not compiled.
+    ExpressionPtr expr(new Expression());
+    expr->push_back(TokenPtr(new TokenEqual()));
+    ASSERT_NO_THROW(cclass->setMatchExpr(expr));
+    EXPECT_FALSE(cclass->getCompiledMatchExpr());
+
+    // A valid expression is compiled.
+    expr.reset(new Expression());
+    expr->push_back(TokenPtr(new TokenString("foo")));
+    expr->push_back(TokenPtr(new TokenString("foo")));
+    expr->push_back(TokenPtr(new TokenEqual()));
+    ASSERT_NO_THROW(cclass->setMatchExpr(expr));
+    ASSERT_TRUE(cclass->getCompiledMatchExpr());
+    Pkt4 pkt(DHCPDISCOVER, 1234);
+    EXPECT_TRUE(cclass->getCompiledMatchExpr()->evaluateBool(pkt));
+
+    // The copy gets its own compiled expression.
+    ClientClassDef copy(*cclass);
+    ASSERT_TRUE(copy.getCompiledMatchExpr());
+    EXPECT_NE(cclass->getCompiledMatchExpr().get(),
+              copy.getCompiledMatchExpr().get());
+}
+
 // Tests options operations.  Note we just do the basics
 // as CfgOption is heavily tested elsewhere.
 TEST(ClientClassDef, cfgOptionBasics) {
@@ -0,0 +1,128 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+#include <dhcp/dhcp4.h>
+#include <dhcp/dhcp6.h>
+#include <dhcp/duid.h>
+#include <dhcp/option.h>
+#include <dhcpsrv/client_handler.h>
+#include <util/threads/multi_threading_mgr.h>
+#include <gtest/gtest.h>
+
+using namespace isc;
+using namespace isc::dhcp;
+using namespace isc::util::thread;
+
+namespace {
+
+/// @brief Test fixture enabling the multi-threading mode.
+class ClientHandlerTest : public ::testing::Test {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// Enables the multi-threading mode without starting the thread pool.
+    ClientHandlerTest() {
+        MultiThreadingMgr::instance().setMode(true);
+    }
+
+    /// @brief Destructor.
+    ///
+    /// Disables the multi-threading mode.
+    virtual ~ClientHandlerTest() {
+        MultiThreadingMgr::instance().setMode(false);
+    }
+
+    /// @brief Creates a DHCPv4 query.
+    ///
+    /// @param mac Last byte of the hardware address.
+    /// @param client_id Last byte of the client identifier or 0 if the
+    /// query should not carry the client identifier.
+    Pkt4Ptr createQuery4(const uint8_t mac, const uint8_t client_id = 0) {
+        Pkt4Ptr query(new Pkt4(DHCPDISCOVER, 1234));
+        std::vector<uint8_t> hwaddr(6, 1);
+        hwaddr[5] = mac;
+        query->setHWAddr(HWTYPE_ETHERNET, hwaddr.size(), hwaddr);
+        if (client_id != 0) {
+            OptionBuffer id(7, 2);
+            id[6] = client_id;
+            query->addOption(OptionPtr(new Option(Option::V4,
+                                                  DHO_DHCP_CLIENT_IDENTIFIER,
+                                                  id)));
+        }
+        return (query);
+    }
+
+    /// @brief Creates a DHCPv6 query.
+    ///
+    /// @param duid Last byte of the DUID.
+    Pkt6Ptr createQuery6(const uint8_t duid) {
+        Pkt6Ptr query(new Pkt6(DHCPV6_SOLICIT, 1234));
+        OptionBuffer id(10, 3);
+        id[9] = duid;
+        query->addOption(OptionPtr(new Option(Option::V6, D6O_CLIENTID, id)));
+        return (query);
+    }
+};
+
+// This test verifies that the DHCPv4 client can't be locked twice.
+TEST_F(ClientHandlerTest, lock4) {
+    Pkt4Ptr query = createQuery4(1, 1);
+    {
+        ClientHandler handler;
+        ASSERT_TRUE(handler.tryLock(query));
+
+        // The same client identifier is busy even with another MAC.
+        ClientHandler same_client;
+        EXPECT_FALSE(same_client.tryLock(createQuery4(2, 1)));
+
+        // Another client identifier is not.
+        ClientHandler other_client;
+        EXPECT_TRUE(other_client.tryLock(createQuery4(1, 2)));
+
+        // The clients without client identifier are identified by MAC.
+        ClientHandler mac_client;
+        EXPECT_TRUE(mac_client.tryLock(createQuery4(3)));
+        ClientHandler same_mac_client;
+        EXPECT_FALSE(same_mac_client.tryLock(createQuery4(3)));
+    }
+
+    // The client is released by the destructor.
+    ClientHandler handler;
+    EXPECT_TRUE(handler.tryLock(query));
+}
+
+// This test verifies that the DHCPv6 client can't be locked twice.
+TEST_F(ClientHandlerTest, lock6) {
+    Pkt6Ptr query = createQuery6(1);
+    {
+        ClientHandler handler;
+        ASSERT_TRUE(handler.tryLock(query));
+
+        ClientHandler same_client;
+        EXPECT_FALSE(same_client.tryLock(createQuery6(1)));
+
+        ClientHandler other_client;
+        EXPECT_TRUE(other_client.tryLock(createQuery6(2)));
+    }
+
+    ClientHandler handler;
+    EXPECT_TRUE(handler.tryLock(query));
+}
+
+// This test verifies that the clients are not locked when the
+// multi-threading mode is disabled.
+TEST_F(ClientHandlerTest, singleThreaded) {
+    MultiThreadingMgr::instance().setMode(false);
+    Pkt6Ptr query = createQuery6(1);
+    ClientHandler handler;
+    ASSERT_TRUE(handler.tryLock(query));
+    ClientHandler same_client;
+    EXPECT_TRUE(same_client.tryLock(query));
+}
+
+} // end of anonymous namespace
@@ -0,0 +1,229 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+#include <dhcpsrv/database_context_pool.h>
+#include <stats/stats_mgr.h>
+#include <util/threads/multi_threading_mgr.h>
+#include <util/threads/thread.h>
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+using namespace isc;
+using namespace isc::dhcp;
+using namespace isc::stats;
+using namespace isc::util::thread;
+
+namespace {
+
+/// @brief Context used by the tests.
+struct TestContext {
+
+    /// @brief Constructor.
+    ///
+    /// @param id Sequential number of the context.
+    explicit TestContext(const int id) : id_(id) {
+    }
+
+    /// @brief Sequential number of the context.
+    int id_;
+};
+
+/// @brief Pointer to the test context.
+typedef boost::shared_ptr<TestContext> TestContextPtr;
+
+/// @brief Type of the pool used by the tests.
+typedef DatabaseContextPool<TestContext> TestContextPool;
+
+/// @brief Test fixture class for @c DatabaseContextPool.
+class DatabaseContextPoolTest : public ::testing::Test {
+public:
+
+    /// @brief Constructor.
+    DatabaseContextPoolTest() : created_(0), fail_(false) {
+        StatsMgr::instance().removeAll();
+    }
+
+    /// @brief Destructor.
+    ///
+    /// Disables the multi-threading mode and removes the statistics.
+    virtual ~DatabaseContextPoolTest() {
+        MultiThreadingMgr::instance().setMode(false);
+        StatsMgr::instance().removeAll();
+    }
+
+    /// @brief Context factory used by the tests.
+    ///
+    /// @throw isc::Unexpected when the @c fail_ flag is set.
+    TestContextPtr createContext() {
+        if (fail_) {
+            isc_throw(Unexpected, "unable to create the context");
+        }
+        return (TestContextPtr(new TestContext(++created_)));
+    }
+
+    /// @brief Returns the integer value of the statistic.
+    ///
+    /// @param name Name of the statistic.
+    /// @return The value or -1 if the statistic doesn't exist.
+    int64_t getStat(const std::string& name) const {
+        ObservationPtr stat = StatsMgr::instance().getObservation(name);
+        return (stat ? stat->getInteger().first : -1);
+    }
+
+    /// @brief Takes a context from the pool and holds it for a while.
+    ///
+    /// @param pool The pool.
+    void holdContext(TestContextPool* pool) {
+        TestContextPool::ContextAlloc get_context(*pool);
+        usleep(10000);
+    }
+
+    /// @brief Number of contexts created by the factory.
+    int created_;
+
+    /// @brief Indicates if the factory should fail.
+    bool fail_;
+};
+
+// This test checks that the contexts are created on demand and reused.
+TEST_F(DatabaseContextPoolTest, reuse) {
+    TestContextPool pool(boost::bind(&DatabaseContextPoolTest::createContext,
+                                     this), 2, "test");
+    EXPECT_EQ(2, pool.getMaxSize());
+    EXPECT_EQ(0, pool.getSize());
+
+    {
+        TestContextPool::ContextAlloc get_context(pool);
+        ASSERT_TRUE(get_context.ctx_);
+        EXPECT_EQ(1, get_context.ctx_->id_);
+        EXPECT_EQ(1, pool.getSize());
+        EXPECT_EQ(0, pool.getIdleCount());
+    }
+    EXPECT_EQ(1, pool.getIdleCount());
+    EXPECT_EQ(1, getStat("test-pool-size"));
+
+    // The context returned to the pool is reused.
+    {
+        TestContextPool::ContextAlloc get_context(pool);
+        EXPECT_EQ(1, get_context.ctx_->id_);
+
+        // The nested operation gets another context.
+        TestContextPool::ContextAlloc get_context2(pool);
+        EXPECT_EQ(2, get_context2.ctx_->id_);
+    }
+    EXPECT_EQ(2, pool.getSize());
+    EXPECT_EQ(2, pool.getIdleCount());
+    EXPECT_EQ(2, created_);
+}
+
+// This test checks that the pool doesn't wait in the single-threaded
+// mode when the maximum number of contexts is reached.
+TEST_F(DatabaseContextPoolTest, singleThreadedOverflow) {
+    TestContextPool pool(boost::bind(&DatabaseContextPoolTest::createContext,
+                                     this), 1, "test");
+    TestContextPool::ContextAlloc get_context(pool);
+    TestContextPool::ContextAlloc get_context2(pool);
+    EXPECT_EQ(2, pool.getSize());
+    EXPECT_EQ(-1, getStat("test-pool-waits"));
+}
+
+// This test checks that the failure to create the context doesn't
+// consume the slot in the pool.
+TEST_F(DatabaseContextPoolTest, factoryFailure) {
+    TestContextPool pool(boost::bind(&DatabaseContextPoolTest::createContext,
+                                     this), 1, "test");
+    fail_ = true;
+    EXPECT_THROW(TestContextPool::ContextAlloc get_context(pool), Unexpected);
+    EXPECT_EQ(0, pool.getSize());
+
+    fail_ = false;
+    TestContextPool::ContextAlloc get_context(pool);
+    EXPECT_EQ(1, pool.getSize());
+}
+
+// This test checks that the threads wait for a context when the maximum
+// number of contexts is reached in the multi-threaded mode.
+TEST_F(DatabaseContextPoolTest, wait) {
+    MultiThreadingMgr::instance().setMode(true);
+    TestContextPool pool(boost::bind(&DatabaseContextPoolTest::createContext,
+                                     this), 1, "test");
+
+    std::vector<boost::shared_ptr<Thread> > threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.push_back(boost::shared_ptr<Thread>
+                          (new Thread(boost::bind(&DatabaseContextPoolTest::
+                                                  holdContext, this, &pool))));
+    }
+    for (int i = 0; i < threads.size(); ++i) {
+        threads[i]->wait();
+    }
+
+    // Only one context has been created and at least one thread had to
+    // wait for it.
+    EXPECT_EQ(1, created_);
+    EXPECT_EQ(1, pool.getIdleCount());
+    EXPECT_LE(1, getStat("test-pool-waits"));
+    EXPECT_TRUE(StatsMgr::instance().getObservation("test-pool-wait-time"));
+}
+
+// This test checks that several contexts can be taken from the pool at
+// once in the multi-threaded mode and that they are reused by the threads.
+TEST_F(DatabaseContextPoolTest, severalContexts) {
+    MultiThreadingMgr::instance().setMode(true);
+    TestContextPool pool(boost::bind(&DatabaseContextPoolTest::createContext,
+                                     this), 3, "test");
+    {
+        TestContextPool::ContextAlloc get_context1(pool);
+        TestContextPool::ContextAlloc get_context2(pool);
+        TestContextPool::ContextAlloc get_context3(pool);
+        EXPECT_EQ(1, get_context1.ctx_->id_);
+        EXPECT_EQ(2, get_context2.ctx_->id_);
+        EXPECT_EQ(3, get_context3.ctx_->id_);
+        EXPECT_EQ(3, pool.getSize());
+        EXPECT_EQ(0, pool.getIdleCount());
+        EXPECT_EQ(3, getStat("test-pool-size"));
+    }
+    EXPECT_EQ(3, pool.getIdleCount());
+
+    // The threads holding the contexts at the same time get the contexts
+    // returned to the pool.
+    std::vector<boost::shared_ptr<Thread> > threads;
+    for (int i = 0; i < 3; ++i) {
+        threads.push_back(boost::shared_ptr<Thread>
+                          (new Thread(boost::bind(&DatabaseContextPoolTest::
+                                                  holdContext, this, &pool))));
+    }
+    for (int i = 0; i < threads.size(); ++i) {
+        threads[i]->wait();
+    }
+    EXPECT_EQ(3, created_);
+    EXPECT_EQ(3, pool.getIdleCount());
+    EXPECT_EQ(-1, getStat("test-pool-waits"));
+}
+
+// This test checks the maximum number of connections is taken from the
+// database access parameters.
+TEST_F(DatabaseContextPoolTest, getMaxConnections) {
+    DatabaseConnection::ParameterMap parameters;
+    EXPECT_EQ(MultiThreadingMgr::detectThreadCount() + 1,
+              TestContextPool::getMaxConnections(parameters));
+
+    parameters["max-connections"] = "0";
+    EXPECT_EQ(MultiThreadingMgr::detectThreadCount() + 1,
+              TestContextPool::getMaxConnections(parameters));
+
+    parameters["max-connections"] = "5";
+    EXPECT_EQ(5, TestContextPool::getMaxConnections(parameters));
+
+    parameters["max-connections"] = "many";
+    EXPECT_THROW(TestContextPool::getMaxConnections(parameters),
+                 DbInvalidMaxConnections);
+}
+
+} // end of anonymous namespace
@@ -177,6 +177,12 @@ private:
      bool quoteValue(const std::string& parameter) const {
          return ((parameter != "persist") && (parameter != "lfc-interval") &&
                  (parameter != "connect-timeout") &&
+                 (parameter != "load-threads") &&
+                 (parameter != "commit-interval") &&
+                 (parameter != "commit-batch-size") &&
+                 (parameter != "max-connections") &&
+                 (parameter != "cache-size") &&
+                 (parameter != "cache-ttl") &&
                  (parameter != "port") &&
                  (parameter != "readonly"));
     }
@@ -352,6 +358,280 @@ TEST_F(DbAccessParserTest, largeLFCInterval) {
     EXPECT_THROW(parser.parse(json_elements), DhcpConfigError);
 }
 
+// This test checks that the parser accepts the valid value of the
+// load-threads parameter.
+TEST_F(DbAccessParserTest, validLoadThreads) {
+    const char* config[] = {"type", "memfile",
+                            "name", "/opt/kea/var/kea-leases6.csv",
+                            "load-threads", "4",
+                            NULL};
+
+    string json_config = toJson(config);
+    ConstElementPtr json_elements = Element::fromJSON(json_config);
+    EXPECT_TRUE(json_elements);
+
+    TestDbAccessParser parser(DbAccessParser::LEASE_DB);
+    EXPECT_NO_THROW(parser.parse(json_elements));
+    checkAccessString("Valid load threads", parser.getDbAccessParameters(),
+                      config);
+}
+
+// This test checks that the parser rejects the negative value of the
+// load-threads parameter.
+TEST_F(DbAccessParserTest, negativeLoadThreads) {
+    const char* config[] = {"type", "memfile",
+                            "name", "/opt/kea/var/kea-leases6.csv",
+                            "load-threads", "-1",
+                            NULL};
+
+    string json_config = toJson(config);
+    ConstElementPtr json_elements = Element::fromJSON(json_config);
+    EXPECT_TRUE(json_elements);
+
+    TestDbAccessParser parser(DbAccessParser::LEASE_DB);
+    EXPECT_THROW(parser.parse(json_elements), DhcpConfigError);
+}
+
+// This test checks that the parser rejects the too large (greater than
+// the max uint16_t) value of the load-threads parameter.
+TEST_F(DbAccessParserTest, largeLoadThreads) {
+    const char* config[] = {"type", "memfile",
+                            "name", "/opt/kea/var/kea-leases6.csv",
+                            "load-threads", "65536",
+                            NULL};
+
+    string json_config = toJson(config);
+    ConstElementPtr json_elements = Element::fromJSON(json_config);
+    EXPECT_TRUE(json_elements);
+
+    TestDbAccessParser parser(DbAccessParser::LEASE_DB);
+    EXPECT_THROW(parser.parse(json_elements), DhcpConfigError);
+}
+
+// This test checks that the parser accepts the valid value of the
+// max-connections parameter.
+TEST_F(DbAccessParserTest, validMaxConnections) {
+    const char* config[] = {"type", "mysql",
+                            "name", "keatest",
+                            "max-connections", "8",
+                            NULL};
+
+    string json_config = toJson(config);
+    ConstElementPtr json_elements = Element::fromJSON(json_config);
+    EXPECT_TRUE(json_elements);
+
+    TestDbAccessParser parser(DbAccessParser::LEASE_DB);
+    EXPECT_NO_THROW(parser.parse(json_elements));
+    checkAccessString("Valid max connections", parser.getDbAccessParameters(),
+                      config);
+}
+
+// This test checks that the parser rejects the negative value of the
+// max-connections parameter.
+TEST_F(DbAccessParserTest, negativeMaxConnections) {
+    const char* config[] = {"type", "mysql",
+                            "name", "keatest",
+                            "max-connections", "-1",
+                            NULL};
+
+    string json_config = toJson(config);
+    ConstElementPtr json_elements = Element::fromJSON(json_config);
+    EXPECT_TRUE(json_elements);
+
+    TestDbAccessParser parser(DbAccessParser::LEASE_DB);
+    EXPECT_THROW(parser.parse(json_elements), DhcpConfigError);
+}
+
+// This test checks that the parser rejects the too large (greater than
+// the max uint16_t) value of the max-connections parameter.
+TEST_F(DbAccessParserTest, largeMaxConnections) {
+    const char* config[] = {"type", "mysql",
+                            "name", "keatest",
+                            "max-connections", "65536",
+                            NULL};
+
+    string json_config = toJson(config);
+    ConstElementPtr json_elements = Element::fromJSON(json_config);
+    EXPECT_TRUE(json_elements);
+
+    TestDbAccessParser parser(DbAccessParser::LEASE_DB);
+    EXPECT_THROW(parser.parse(json_elements), DhcpConfigError);
+}
+
+// This test checks that the parser accepts the valid values of the
+// lease cache parameters.
+TEST_F(DbAccessParserTest, validLeaseCache) {
+    const char* config[] = {"type", "mysql",
+                            "name", "keatest",
+                            "cache-size", "10000",
+                            "cache-ttl", "5",
+                            NULL};
+
+    string json_config = toJson(config);
+    ConstElementPtr json_elements = Element::fromJSON(json_config);
+    EXPECT_TRUE(json_elements);
+
+    TestDbAccessParser parser(DbAccessParser::LEASE_DB);
+    EXPECT_NO_THROW(parser.parse(json_elements));
+    checkAccessString("Valid lease cache", parser.getDbAccessParameters(),
+                      config);
+}
+
+// This test checks that the parser rejects the negative values of the
+// lease cache parameters.
+TEST_F(DbAccessParserTest, negativeLeaseCache) {
+    const char* config1[] = {"type", "mysql",
+                             "name", "keatest",
+                             "cache-size", "-1",
+                             NULL};
+
+    string json_config = toJson(config1);
+    ConstElementPtr json_elements = Element::fromJSON(json_config);
+    EXPECT_TRUE(json_elements);
+
+    TestDbAccessParser parser1(DbAccessParser::LEASE_DB);
+    EXPECT_THROW(parser1.parse(json_elements), DhcpConfigError);
+
+    const char* config2[] = {"type", "mysql",
+                             "name", "keatest",
+                             "cache-size", "1000",
+                             "cache-ttl", "-1",
+                             NULL};
+
+    json_config = toJson(config2);
+    json_elements = Element::fromJSON(json_config);
+    EXPECT_TRUE(json_elements);
+
+    TestDbAccessParser parser2(DbAccessParser::LEASE_DB);
+    EXPECT_THROW(parser2.parse(json_elements), DhcpConfigError);
+}
+
+// This test checks that the parser accepts the valid values of the
+// lease-file-format parameter.
+TEST_F(DbAccessParserTest, validLeaseFileFormat) {
+    const char* config[] = {"type", "memfile",
+                            "name", "/opt/kea/var/kea-leases6.csv",
+                            "lease-file-format", "binary",
+                            NULL};
+
+    string json_config = toJson(config);
+    ConstElementPtr json_elements = Element::fromJSON(json_config);
+    EXPECT_TRUE(json_elements);
+
+    TestDbAccessParser parser(DbAccessParser::LEASE_DB);
+    EXPECT_NO_THROW(parser.parse(json_elements));
+    checkAccessString("Valid lease file format",
+                      parser.getDbAccessParameters(), config);
+}
+
+// This test checks that the parser rejects the unsupported value of the
+// lease-file-format parameter.
+TEST_F(DbAccessParserTest, invalidLeaseFileFormat) {
+    const char* config[] = {"type", "memfile",
+                            "name", "/opt/kea/var/kea-leases6.csv",
+                            "lease-file-format", "xml",
+                            NULL};
+
+    string json_config = toJson(config);
+    ConstElementPtr json_elements = Element::fromJSON(json_config);
+    EXPECT_TRUE(json_elements);
+
+    TestDbAccessParser parser(DbAccessParser::LEASE_DB);
+    EXPECT_THROW(parser.parse(json_elements), DhcpConfigError);
+}
+
+// This test checks that the parser accepts the valid values of the
+// persist-mode, commit-interval and commit-batch-size parameters.
+TEST_F(DbAccessParserTest, validPersistMode) {
+    const char* config[] = {"type", "memfile",
+                            "name", "/opt/kea/var/kea-leases6.csv",
+                            "persist-mode", "group",
+                            "commit-interval", "5",
+                            "commit-batch-size", "128",
+                            NULL};
+
+    string json_config = toJson(config);
+    ConstElementPtr json_elements = Element::fromJSON(json_config);
+    EXPECT_TRUE(json_elements);
+
+    TestDbAccessParser parser(DbAccessParser::LEASE_DB);
+    EXPECT_NO_THROW(parser.parse(json_elements));
+    checkAccessString("Valid persist mode",
+                      parser.getDbAccessParameters(), config);
+}
+
+// This test checks that the parser rejects the unsupported value of the
+// persist-mode parameter.
+TEST_F(DbAccessParserTest, invalidPersistMode) {
+    const char* config[] = {"type", "memfile",
+                            "name", "/opt/kea/var/kea-leases6.csv",
+                            "persist-mode", "never",
+                            NULL};
+
+    string json_config = toJson(config);
+    ConstElementPtr json_elements = Element::fromJSON(json_config);
+    EXPECT_TRUE(json_elements);
+
+    TestDbAccessParser parser(DbAccessParser::LEASE_DB);
+    EXPECT_THROW(parser.parse(json_elements), DhcpConfigError);
+}
+
+// This test checks that the parser rejects the out of range values of the
+// commit-interval and commit-batch-size parameters.
+TEST_F(DbAccessParserTest, invalidCommitParameters) {
+    const char* config_interval[] = {"type", "memfile",
+                                     "name", "/opt/kea/var/kea-leases6.csv",
+                                     "commit-interval", "-1",
+                                     NULL};
+
+    ConstElementPtr json_elements =
+        Element::fromJSON(toJson(config_interval));
+    EXPECT_TRUE(json_elements);
+
+    TestDbAccessParser parser(DbAccessParser::LEASE_DB);
+    EXPECT_THROW(parser.parse(json_elements), DhcpConfigError);
+
+    const char* config_batch[] = {"type", "memfile",
+                                  "name", "/opt/kea/var/kea-leases6.csv",
+                                  "commit-batch-size", "0",
+                                  NULL};
+
+    json_elements = Element::fromJSON(toJson(config_batch));
+    EXPECT_TRUE(json_elements);
+
+    TestDbAccessParser parser_batch(DbAccessParser::LEASE_DB);
+    EXPECT_THROW(parser_batch.parse(json_elements), DhcpConfigError);
+}
+
+// This test checks that the parser accepts the valid values of the
+// lfc-mode parameter and rejects the unsupported one.
+TEST_F(DbAccessParserTest, lfcMode) {
+    const char* config[] = {"type", "memfile",
+                            "name", "/opt/kea/var/kea-leases4.csv",
+                            "lfc-mode", "internal",
+                            NULL};
+
+    string json_config = toJson(config);
+    ConstElementPtr json_elements = Element::fromJSON(json_config);
+    EXPECT_TRUE(json_elements);
+
+    TestDbAccessParser parser(DbAccessParser::LEASE_DB);
+    EXPECT_NO_THROW(parser.parse(json_elements));
+    checkAccessString("Valid LFC mode", parser.getDbAccessParameters(),
+                      config);
+
+    const char* config_invalid[] = {"type", "memfile",
+                                    "name", "/opt/kea/var/kea-leases4.csv",
+                                    "lfc-mode", "fork",
+                                    NULL};
+
+    json_elements = Element::fromJSON(toJson(config_invalid));
+    EXPECT_TRUE(json_elements);
+
+    TestDbAccessParser parser_invalid(DbAccessParser::LEASE_DB);
+    EXPECT_THROW(parser_invalid.parse(json_elements), DhcpConfigError);
+}
+
 // This test checks that the parser accepts the valid value of the
 // timeout parameter.
 TEST_F(DbAccessParserTest, validTimeout) {
@@ -661,6 +661,66 @@ GenericHostDataSourceTest::testGet4ByIdentifier(const Host::IdentifierType& iden
     compareHosts(host2, from_hds2);
 }
 
+void
+GenericHostDataSourceTest::testGetByIdentifiers() {
+    // Make sure we have a pointer to the host data source.
+    ASSERT_TRUE(hdsptr_);
+
+    // Create two hosts in the same subnets, using different identifiers.
+    std::vector<uint8_t> hwaddr = generateHWAddr();
+    std::vector<uint8_t> duid = generateIdentifier();
+    HostPtr host1(new Host(&hwaddr[0], hwaddr.size(), Host::IDENT_HWADDR,
+                           SubnetID(10), SubnetID(20), IOAddress("192.0.2.1")));
+    HostPtr host2(new Host(&duid[0], duid.size(), Host::IDENT_DUID,
+                           SubnetID(10), SubnetID(20), IOAddress("192.0.2.2")));
+    host2->addReservation(IPv6Resrv(IPv6Resrv::TYPE_NA,
+                                    IOAddress("2001:db8::2")));
+
+    ASSERT_NO_THROW(hdsptr_->add(host1));
+    ASSERT_NO_THROW(hdsptr_->add(host2));
+
+    // The first identifier doesn't match any host.
+    HostIdentifierList identifiers;
+    identifiers.push_back(HostIdentifier(Host::IDENT_CIRCUIT_ID,
+                                         generateIdentifier()));
+    identifiers.push_back(HostIdentifier(Host::IDENT_DUID, duid));
+    identifiers.push_back(HostIdentifier(Host::IDENT_HWADDR, hwaddr));
+
+    // The hosts should be returned in the order of identifiers.
+    ConstHostCollection hosts = hdsptr_->getByIdentifiers4(SubnetID(10),
+                                                           identifiers);
+    ASSERT_EQ(2, hosts.size());
+    compareHosts(host2, hosts[0]);
+    compareHosts(host1, hosts[1]);
+
+    hosts = hdsptr_->getByIdentifiers6(SubnetID(20), identifiers);
+    ASSERT_EQ(2, hosts.size());
+    compareHosts(host2, hosts[0]);
+    compareHosts(host1, hosts[1]);
+
+    // Reverse the priority of the identifiers.
+    identifiers.reverse();
+    hosts = hdsptr_->getByIdentifiers4(SubnetID(10), identifiers);
+    ASSERT_EQ(2, hosts.size());
+    compareHosts(host1, hosts[0]);
+    compareHosts(host2, hosts[1]);
+
+    // There are no hosts in other subnets.
+    EXPECT_TRUE(hdsptr_->getByIdentifiers4(SubnetID(20), identifiers).empty());
+    EXPECT_TRUE(hdsptr_->getByIdentifiers6(SubnetID(10), identifiers).empty());
+
+    // The backends may use several queries when there are many identifiers.
+    identifiers.clear();
+    for (int i = 0; i < 6; ++i) {
+        identifiers.push_back(HostIdentifier(Host::IDENT_CIRCUIT_ID,
+                                             generateIdentifier()));
+    }
+    identifiers.push_back(HostIdentifier(Host::IDENT_HWADDR, hwaddr));
+    hosts = hdsptr_->getByIdentifiers4(SubnetID(10), identifiers);
+    ASSERT_EQ(1, hosts.size());
+    compareHosts(host1, hosts[0]);
+}
+
 void GenericHostDataSourceTest::testHWAddrNotClientId() {
     // Make sure we have a pointer to the host data source.
     ASSERT_TRUE(hdsptr_);
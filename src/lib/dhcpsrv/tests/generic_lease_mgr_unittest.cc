@@ -12,7 +12,9 @@
 #include <dhcpsrv/tests/generic_lease_mgr_unittest.h>
 #include <dhcpsrv/tests/test_utils.h>
 #include <stats/stats_mgr.h>
+#include <util/boost_time_utils.h>
 
+#include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/foreach.hpp>
 
 #include <gtest/gtest.h>
@@ -1219,6 +1221,34 @@ GenericLeaseMgrTest::testGetLease4ClientIdSubnetId() {
     EXPECT_FALSE(returned);
 }
 
+void
+GenericLeaseMgrTest::testGetLeases4SubnetId() {
+    // Get the leases to be used for the test and add to the database
+    vector<Lease4Ptr> leases = createLeases4();
+    for (size_t i = 0; i < leases.size(); ++i) {
+        EXPECT_TRUE(lmptr_->addLease(leases[i]));
+    }
+
+    // There should be no leases in the unknown subnet.
+    Lease4Collection returned = lmptr_->getLeases4(1);
+    EXPECT_TRUE(returned.empty());
+
+    // Leases 1 and 2 belong to the same subnet.
+    returned = lmptr_->getLeases4(leases[1]->subnet_id_);
+    ASSERT_EQ(2, returned.size());
+    for (Lease4Collection::const_iterator lease = returned.begin();
+         lease != returned.end(); ++lease) {
+        EXPECT_EQ(leases[1]->subnet_id_, (*lease)->subnet_id_);
+        EXPECT_TRUE(((*lease)->addr_ == leases[1]->addr_) ||
+                    ((*lease)->addr_ == leases[2]->addr_));
+    }
+
+    // Lease 0 is alone in its subnet.
+    returned = lmptr_->getLeases4(leases[0]->subnet_id_);
+    ASSERT_EQ(1, returned.size());
+    detailCompareLease(leases[0], *returned.begin());
+}
+
 void
 GenericLeaseMgrTest::testGetLeases6DuidIaid() {
     // Get the leases to be used for the test.
@@ -2748,6 +2778,158 @@ GenericLeaseMgrTest::testWipeLeases4() {
     EXPECT_EQ(0, lmptr_->wipeLeases4(333));
 }
 
+void
+GenericLeaseMgrTest::testBulkLeases4() {
+    // Add the first half of the leases one by one.
+    vector<Lease4Ptr> leases = createLeases4();
+    for (size_t i = 0; i < leases.size() / 2; ++i) {
+        EXPECT_TRUE(lmptr_->addLease(leases[i]));
+    }
+
+    // Add all leases at once. The leases already in the database should
+    // be skipped.
+    Lease4Collection collection(leases.begin(), leases.end());
+    EXPECT_EQ(leases.size() - leases.size() / 2,
+              lmptr_->addLeases(collection));
+    for (size_t i = 0; i < leases.size(); ++i) {
+        Lease4Ptr l_returned = lmptr_->getLease4(ioaddress4_[i]);
+        ASSERT_TRUE(l_returned);
+        detailCompareLease(leases[i], l_returned);
+    }
+
+    // Modify all leases and update them at once.
+    for (size_t i = 0; i < leases.size(); ++i) {
+        leases[i]->valid_lft_ *= 2;
+        leases[i]->hostname_ = "modified.hostname.";
+    }
+    ASSERT_NO_THROW(lmptr_->updateLeases4(collection));
+    for (size_t i = 0; i < leases.size(); ++i) {
+        Lease4Ptr l_returned = lmptr_->getLease4(ioaddress4_[i]);
+        ASSERT_TRUE(l_returned);
+        detailCompareLease(leases[i], l_returned);
+    }
+
+    // Delete the first half of the leases at once. The address not
+    // in the database should not be counted.
+    vector<IOAddress> addrs(ioaddress4_.begin(),
+                            ioaddress4_.begin() + leases.size() / 2);
+    addrs.push_back(IOAddress("192.0.2.250"));
+    EXPECT_EQ(leases.size() / 2, lmptr_->deleteLeases(addrs));
+    for (size_t i = 0; i < leases.size(); ++i) {
+        EXPECT_EQ(i >= leases.size() / 2,
+                  static_cast<bool>(lmptr_->getLease4(ioaddress4_[i])));
+    }
+
+    // Updating the leases not in the database should fail.
+    EXPECT_THROW(lmptr_->updateLeases4(collection), isc::dhcp::NoSuchLease);
+}
+
+void
+GenericLeaseMgrTest::testBulkLeases6() {
+    // Add the first half of the leases one by one.
+    vector<Lease6Ptr> leases = createLeases6();
+    for (size_t i = 0; i < leases.size() / 2; ++i) {
+        EXPECT_TRUE(lmptr_->addLease(leases[i]));
+    }
+
+    // Add all leases at once. The leases already in the database should
+    // be skipped.
+    Lease6Collection collection(leases.begin(), leases.end());
+    EXPECT_EQ(leases.size() - leases.size() / 2,
+              lmptr_->addLeases(collection));
+    for (size_t i = 0; i < leases.size(); ++i) {
+        Lease6Ptr l_returned = lmptr_->getLease6(leasetype6_[i],
+                                                 ioaddress6_[i]);
+        ASSERT_TRUE(l_returned);
+        detailCompareLease(leases[i], l_returned);
+    }
+
+    // Modify all leases and update them at once.
+    for (size_t i = 0; i < leases.size(); ++i) {
+        leases[i]->valid_lft_ *= 2;
+        leases[i]->hostname_ = "modified.hostname.v6.";
+    }
+    ASSERT_NO_THROW(lmptr_->updateLeases6(collection));
+    for (size_t i = 0; i < leases.size(); ++i) {
+        Lease6Ptr l_returned = lmptr_->getLease6(leasetype6_[i],
+                                                 ioaddress6_[i]);
+        ASSERT_TRUE(l_returned);
+        detailCompareLease(leases[i], l_returned);
+    }
+
+    // Delete the first half of the leases at once. The address not
+    // in the database should not be counted.
+    vector<IOAddress> addrs(ioaddress6_.begin(),
+                            ioaddress6_.begin() + leases.size() / 2);
+    addrs.push_back(IOAddress("2001:db8::250"));
+    EXPECT_EQ(leases.size() / 2, lmptr_->deleteLeases(addrs));
+    for (size_t i = 0; i < leases.size(); ++i) {
+        EXPECT_EQ(i >= leases.size() / 2,
+                  static_cast<bool>(lmptr_->getLease6(leasetype6_[i],
+                                                      ioaddress6_[i])));
+    }
+
+    // Updating the leases not in the database should fail.
+    EXPECT_THROW(lmptr_->updateLeases6(collection), isc::dhcp::NoSuchLease);
+}
+
+void
+GenericLeaseMgrTest::testBulkLeases4Performance(const size_t leases_num) {
+    using namespace boost::posix_time;
+
+    Lease4Collection leases;
+    vector<IOAddress> addrs;
+    for (size_t i = 0; i < leases_num; ++i) {
+        IOAddress addr(IOAddress("10.0.0.0").toUint32() + i);
+        vector<uint8_t> mac(6, 0);
+        mac[4] = static_cast<uint8_t>(i >> 8);
+        mac[5] = static_cast<uint8_t>(i);
+        HWAddrPtr hwaddr(new HWAddr(mac, HTYPE_ETHER));
+        leases.push_back(Lease4Ptr(new Lease4(addr, hwaddr, ClientIdPtr(),
+                                              3600, 1800, 2700, time(NULL),
+                                              1)));
+        addrs.push_back(addr);
+    }
+
+    // Add, update and delete the leases one by one.
+    ptime before = microsec_clock::local_time();
+    for (size_t i = 0; i < leases.size(); ++i) {
+        ASSERT_TRUE(lmptr_->addLease(leases[i]));
+    }
+    time_duration add_dur = microsec_clock::local_time() - before;
+    before = microsec_clock::local_time();
+    for (size_t i = 0; i < leases.size(); ++i) {
+        ASSERT_NO_THROW(lmptr_->updateLease4(leases[i]));
+    }
+    time_duration update_dur = microsec_clock::local_time() - before;
+    before = microsec_clock::local_time();
+    for (size_t i = 0; i < addrs.size(); ++i) {
+        ASSERT_TRUE(lmptr_->deleteLease(addrs[i]));
+    }
+    time_duration delete_dur = microsec_clock::local_time() - before;
+
+    std::cout << leases_num << " single lease operations took: add "
+              << isc::util::durationToText(add_dur) << ", update "
+              << isc::util::durationToText(update_dur) << ", delete "
+              << isc::util::durationToText(delete_dur) << std::endl;
+
+    // Do the same at once.
+    before = microsec_clock::local_time();
+    ASSERT_EQ(leases.size(), lmptr_->addLeases(leases));
+    add_dur = microsec_clock::local_time() - before;
+    before = microsec_clock::local_time();
+    ASSERT_NO_THROW(lmptr_->updateLeases4(leases));
+    update_dur = microsec_clock::local_time() - before;
+    before = microsec_clock::local_time();
+    ASSERT_EQ(addrs.size(), lmptr_->deleteLeases(addrs));
+    delete_dur = microsec_clock::local_time() - before;
+
+    std::cout << leases_num << " bulk lease operations took: add "
+              << isc::util::durationToText(add_dur) << ", update "
+              << isc::util::durationToText(update_dur) << ", delete "
+              << isc::util::durationToText(delete_dur) << std::endl;
+}
+
 }; // namespace test
 }; // namespace dhcp
 }; // namespace isc
@@ -200,6 +200,9 @@ public:
     /// a combination of client and subnet IDs.
     void testGetLease4ClientIdSubnetId();
 
+    /// @brief Test method which returns all IPv4 leases for Subnet ID.
+    void testGetLeases4SubnetId();
+
     /// @brief Basic Lease4 Checks
     ///
     /// Checks that the addLease, getLease4(by address), getLease4(hwaddr,subnet_id),
@@ -387,6 +390,27 @@ public:
     /// attempts to delete them, one subnet at a time.
     void testWipeLeases6();
 
+    /// @brief Check if the bulk operations on the IPv4 leases work properly.
+    ///
+    /// This test adds, updates and deletes several leases at once and
+    /// verifies that the returned counts and the stored leases are correct.
+    void testBulkLeases4();
+
+    /// @brief Check if the bulk operations on the IPv6 leases work properly.
+    ///
+    /// This test adds, updates and deletes several leases at once and
+    /// verifies that the returned counts and the stored leases are correct.
+    void testBulkLeases6();
+
+    /// @brief Compares the throughput of the bulk and single operations on
+    /// the IPv4 leases.
+    ///
+    /// This is a performance benchmark. It adds, updates and deletes the
+    /// leases one by one and then at once, and prints the times taken.
+    ///
+    /// @param leases_num Number of leases.
+    void testBulkLeases4Performance(const size_t leases_num);
+
     /// @brief String forms of IPv4 addresses
     std::vector<std::string>  straddress4_;
 
@@ -0,0 +1,223 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+#include <asiolink/io_address.h>
+#include <dhcpsrv/host_cache.h>
+#include <stats/stats_mgr.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+using namespace isc;
+using namespace isc::asiolink;
+using namespace isc::dhcp;
+using namespace isc::stats;
+
+namespace {
+
+/// @brief Test fixture class for the @c HostCache.
+class HostCacheTest : public ::testing::Test {
+public:
+
+    /// @brief Constructor.
+    HostCacheTest() {
+        StatsMgr::instance().removeAll();
+    }
+
+    /// @brief Destructor.
+    virtual ~HostCacheTest() {
+        StatsMgr::instance().removeAll();
+    }
+
+    /// @brief Returns the value of the integer statistic.
+    ///
+    /// @param name Name of the statistic.
+    /// @return Value of the statistic or 0 if it doesn't exist.
+    int64_t getStatistic(const std::string& name) const {
+        ObservationPtr stat = StatsMgr::instance().getObservation(name);
+        return (stat ? stat->getInteger().first : 0);
+    }
+
+    /// @brief Returns the host identifier.
+    ///
+    /// @param seed Value making the identifier unique.
+    HostIdentifier getIdentifier(const uint8_t seed) const {
+        return (HostIdentifier(Host::IDENT_HWADDR,
+                               std::vector<uint8_t>(6, seed)));
+    }
+
+    /// @brief Returns a host using the identifier.
+    ///
+    /// @param identifier Identifier of the host.
+    /// @param subnet_id4 IPv4 subnet of the host.
+    /// @param subnet_id6 IPv6 subnet of the host.
+    HostPtr createHost(const HostIdentifier& identifier,
+                       const SubnetID& subnet_id4,
+                       const SubnetID& subnet_id6) const {
+        return (HostPtr(new Host(&identifier.second[0],
+                                 identifier.second.size(), identifier.first,
+                                 subnet_id4, subnet_id6,
+                                 IOAddress("192.0.2.1"))));
+    }
+};
+
+// Checks that the cache parameters are taken from the host database
+// access parameters.
+TEST_F(HostCacheTest, parameters) {
+    DatabaseConnection::ParameterMap parameters;
+    EXPECT_EQ(0, HostCache::getCacheSize(parameters));
+    EXPECT_EQ(10, HostCache::getCacheTtl(parameters));
+
+    parameters["cache-size"] = "1000";
+    parameters["cache-ttl"] = "0";
+    EXPECT_EQ(1000, HostCache::getCacheSize(parameters));
+    EXPECT_EQ(0, HostCache::getCacheTtl(parameters));
+
+    parameters["cache-size"] = "-1";
+    EXPECT_THROW(HostCache::getCacheSize(parameters), DbInvalidHostCache);
+    parameters["cache-ttl"] = "bogus";
+    EXPECT_THROW(HostCache::getCacheTtl(parameters), DbInvalidHostCache);
+}
+
+// Checks that the positive and negative results are cached separately for
+// the subnets and universes, and that the hits and misses are counted.
+TEST_F(HostCacheTest, getInsert) {
+    HostCache cache(10, 0);
+    HostIdentifier identifier = getIdentifier(1);
+    ConstHostPtr host = createHost(identifier, SubnetID(1), SubnetID(2));
+
+    ConstHostPtr cached;
+    uint64_t version = 0;
+    EXPECT_FALSE(cache.get(Option::V4, SubnetID(1), identifier, cached,
+                           version));
+    cache.insert(Option::V4, SubnetID(1), identifier, host, version);
+
+    EXPECT_FALSE(cache.get(Option::V6, SubnetID(1), identifier, cached,
+                           version));
+    cache.insert(Option::V6, SubnetID(1), identifier, ConstHostPtr(), version);
+    EXPECT_EQ(2, cache.size());
+    EXPECT_EQ(2, getStatistic("host-cache-size"));
+
+    // The host is returned for the IPv4 lookup.
+    ASSERT_TRUE(cache.get(Option::V4, SubnetID(1), identifier, cached,
+                          version));
+    EXPECT_TRUE(cached == host);
+
+    // The negative entry is returned for the IPv6 lookup.
+    ASSERT_TRUE(cache.get(Option::V6, SubnetID(1), identifier, cached,
+                          version));
+    EXPECT_FALSE(cached);
+
+    // Nothing is cached for another subnet and identifier.
+    EXPECT_FALSE(cache.get(Option::V4, SubnetID(2), identifier, cached,
+                           version));
+    EXPECT_FALSE(cache.get(Option::V4, SubnetID(1), getIdentifier(2), cached,
+                           version));
+
+    EXPECT_EQ(2, getStatistic("host-cache-hits"));
+    EXPECT_EQ(4, getStatistic("host-cache-misses"));
+}
+
+// Checks that the least recently used entries are removed when the cache
+// is full.
+TEST_F(HostCacheTest, maxSize) {
+    HostCache cache(2, 0);
+    ConstHostPtr cached;
+    uint64_t version = 0;
+    for (uint8_t i = 1; i <= 3; ++i) {
+        cache.get(Option::V4, SubnetID(1), getIdentifier(i), cached, version);
+        cache.insert(Option::V4, SubnetID(1), getIdentifier(i), ConstHostPtr(),
+                     version);
+        // Use the first entry, so it is not the least recently used one.
+        cache.get(Option::V4, SubnetID(1), getIdentifier(1), cached, version);
+    }
+    EXPECT_EQ(2, cache.size());
+    EXPECT_EQ(2, getStatistic("host-cache-size"));
+    EXPECT_TRUE(cache.get(Option::V4, SubnetID(1), getIdentifier(1), cached,
+                          version));
+    EXPECT_FALSE(cache.get(Option::V4, SubnetID(1), getIdentifier(2), cached,
+                           version));
+    EXPECT_TRUE(cache.get(Option::V4, SubnetID(1), getIdentifier(3), cached,
+                          version));
+}
+
+// Checks that the entries expire.
+TEST_F(HostCacheTest, ttl) {
+    HostCache cache(10, 1);
+    ConstHostPtr cached;
+    uint64_t version = 0;
+    cache.get(Option::V4, SubnetID(1), getIdentifier(1), cached, version);
+    cache.insert(Option::V4, SubnetID(1), getIdentifier(1), ConstHostPtr(),
+                 version);
+    EXPECT_TRUE(cache.get(Option::V4, SubnetID(1), getIdentifier(1), cached,
+                          version));
+
+    sleep(2);
+    EXPECT_FALSE(cache.get(Option::V4, SubnetID(1), getIdentifier(1), cached,
+                           version));
+    EXPECT_EQ(0, cache.size());
+    EXPECT_EQ(0, getStatistic("host-cache-size"));
+}
+
+// Checks that adding a host removes its entries and that the results of
+// the lookups started before are not cached.
+TEST_F(HostCacheTest, invalidate) {
+    HostCache cache(10, 0);
+    HostIdentifier identifier = getIdentifier(1);
+    ConstHostPtr cached;
+    uint64_t version4 = 0;
+    uint64_t version6 = 0;
+    uint64_t version_other = 0;
+    cache.get(Option::V4, SubnetID(1), identifier, cached, version4);
+    cache.insert(Option::V4, SubnetID(1), identifier, ConstHostPtr(),
+                 version4);
+    cache.get(Option::V6, SubnetID(2), identifier, cached, version6);
+    cache.insert(Option::V6, SubnetID(2), identifier, ConstHostPtr(),
+                 version6);
+    cache.get(Option::V4, SubnetID(3), identifier, cached, version_other);
+    cache.insert(Option::V4, SubnetID(3), identifier, ConstHostPtr(),
+                 version_other);
+    ASSERT_EQ(3, cache.size());
+
+    // A lookup is in progress when the host is added.
+    uint64_t version = 0;
+    EXPECT_FALSE(cache.get(Option::V4, SubnetID(4), identifier, cached,
+                           version));
+
+    cache.invalidate(*createHost(identifier, SubnetID(1), SubnetID(2)));
+    EXPECT_FALSE(cache.get(Option::V4, SubnetID(1), identifier, cached,
+                           version4));
+    EXPECT_FALSE(cache.get(Option::V6, SubnetID(2), identifier, cached,
+                           version6));
+    EXPECT_TRUE(cache.get(Option::V4, SubnetID(3), identifier, cached,
+                          version_other));
+    EXPECT_EQ(1, getStatistic("host-cache-size"));
+
+    // The result of the lookup may be stale, so it is not cached.
+    cache.insert(Option::V4, SubnetID(4), identifier, ConstHostPtr(), version);
+    EXPECT_EQ(1, cache.size());
+}
+
+// Checks that all entries are removed on flush.
+TEST_F(HostCacheTest, flush) {
+    HostCache cache(10, 0);
+    ConstHostPtr cached;
+    uint64_t version = 0;
+    for (uint8_t i = 1; i <= 3; ++i) {
+        cache.get(Option::V4, SubnetID(1), getIdentifier(i), cached, version);
+        cache.insert(Option::V4, SubnetID(1), getIdentifier(i), ConstHostPtr(),
+                     version);
+    }
+    ASSERT_EQ(3, cache.size());
+
+    cache.flush();
+    EXPECT_EQ(0, cache.size());
+    EXPECT_EQ(0, getStatistic("host-cache-size"));
+    EXPECT_FALSE(cache.get(Option::V4, SubnetID(1), getIdentifier(1), cached,
+                           version));
+}
+
+} // end of anonymous namespace
@@ -11,6 +11,7 @@
 #include <dhcpsrv/host.h>
 #include <dhcpsrv/host_data_source_factory.h>
 #include <dhcpsrv/host_mgr.h>
+#include <util/boost_time_utils.h>
 
 #if defined HAVE_MYSQL
 #include <dhcpsrv/testutils/mysql_schema.h>
@@ -20,12 +21,18 @@
 #include <dhcpsrv/testutils/pgsql_schema.h>
 #endif
 
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/foreach.hpp>
 #include <gtest/gtest.h>
+#include <iostream>
 #include <vector>
+#include <unistd.h>
 
 using namespace isc;
 using namespace isc::dhcp;
 using namespace isc::asiolink;
+using namespace isc::util;
+using namespace boost::posix_time;
 
 namespace {
 
@@ -400,6 +407,269 @@ TEST_F(HostMgrTest, addNoDataSource) {
     EXPECT_THROW(HostMgr::instance().add(host), NoHostDataSourceManager);
 }
 
+/// @brief Alternate host data source counting the queries.
+///
+/// The hosts are held in memory. Each query can be delayed to simulate
+/// the round trip to the database server.
+class CountingHostDataSource : public CfgHosts {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// @param delay Delay of each query in microseconds.
+    CountingHostDataSource(const useconds_t delay = 0)
+        : queries_(0), delay_(delay) {
+    }
+
+    /// @brief Returns a host connected to the IPv4 subnet using a single
+    /// query.
+    virtual ConstHostPtr
+    get4(const SubnetID& subnet_id,
+         const Host::IdentifierType& identifier_type,
+         const uint8_t* identifier_begin,
+         const size_t identifier_len) const {
+        query();
+        return (CfgHosts::get4(subnet_id, identifier_type, identifier_begin,
+                               identifier_len));
+    }
+
+    /// @brief Returns hosts connected to the IPv4 subnet using a single
+    /// query.
+    virtual ConstHostCollection
+    getByIdentifiers4(const SubnetID& subnet_id,
+                      const HostIdentifierList& identifiers) const {
+        query();
+        ConstHostCollection hosts;
+        BOOST_FOREACH(const HostIdentifier& id, identifiers) {
+            ConstHostPtr host = CfgHosts::get4(subnet_id, id.first,
+                                               &id.second[0],
+                                               id.second.size());
+            if (host) {
+                hosts.push_back(host);
+            }
+        }
+        return (hosts);
+    }
+
+    /// @brief Number of queries.
+    mutable size_t queries_;
+
+private:
+
+    /// @brief Counts the query and simulates the round trip.
+    void query() const {
+        ++queries_;
+        if (delay_ > 0) {
+            usleep(delay_);
+        }
+    }
+
+    /// @brief Delay of each query in microseconds.
+    useconds_t delay_;
+};
+
+/// @brief Returns the identifiers of a client.
+///
+/// @param seed Value making the identifiers unique.
+HostIdentifierList
+clientIdentifiers(const uint32_t seed) {
+    HostIdentifierList identifiers;
+    for (int type = 0; type <= Host::LAST_IDENTIFIER_TYPE; ++type) {
+        std::vector<uint8_t> id(6, static_cast<uint8_t>(type));
+        id[2] = static_cast<uint8_t>(seed >> 16);
+        id[3] = static_cast<uint8_t>(seed >> 8);
+        id[4] = static_cast<uint8_t>(seed);
+        identifiers.push_back(HostIdentifier(static_cast<Host::IdentifierType>(type),
+                                             id));
+    }
+    return (identifiers);
+}
+
+// This test verifies that the hosts can be retrieved by any of the client
+// identifiers from the configuration and the alternate data source using
+// a single query.
+TEST_F(HostMgrTest, getByIdentifiers4) {
+    boost::shared_ptr<CountingHostDataSource> source(new CountingHostDataSource());
+    HostMgr::instance().setTestHostDataSource(source);
+
+    HostIdentifierList identifiers = clientIdentifiers(1);
+    const HostIdentifier& hwaddr = identifiers.front();
+    const HostIdentifier& duid = *(++identifiers.begin());
+    const HostIdentifier& circuit_id = *(++(++identifiers.begin()));
+
+    // No reservations yet.
+    ConstHostCollection hosts =
+        HostMgr::instance().getByIdentifiers4(SubnetID(1), identifiers);
+    EXPECT_TRUE(hosts.empty());
+    EXPECT_EQ(1, source->queries_);
+
+    // The DUID reservation is in the configuration, the HW address and
+    // circuit id reservations are in the alternate data source. The
+    // circuit id reservation is also in the configuration.
+    getCfgHosts()->add(HostPtr(new Host(&duid.second[0], duid.second.size(),
+                                        duid.first, SubnetID(1), SubnetID(0),
+                                        IOAddress("192.0.2.2"))));
+    getCfgHosts()->add(HostPtr(new Host(&circuit_id.second[0],
+                                        circuit_id.second.size(),
+                                        circuit_id.first, SubnetID(1),
+                                        SubnetID(0), IOAddress("192.0.2.3"))));
+    CfgMgr::instance().commit();
+    source->add(HostPtr(new Host(&hwaddr.second[0], hwaddr.second.size(),
+                                 hwaddr.first, SubnetID(1), SubnetID(0),
+                                 IOAddress("192.0.2.1"))));
+    source->add(HostPtr(new Host(&circuit_id.second[0],
+                                 circuit_id.second.size(),
+                                 circuit_id.first, SubnetID(1), SubnetID(0),
+                                 IOAddress("192.0.2.30"))));
+
+    // The hosts are returned in the order of identifiers and the
+    // configuration takes precedence over the alternate data source.
+    source->queries_ = 0;
+    hosts = HostMgr::instance().getByIdentifiers4(SubnetID(1), identifiers);
+    ASSERT_EQ(3, hosts.size());
+    EXPECT_EQ("192.0.2.1", hosts[0]->getIPv4Reservation().toText());
+    EXPECT_EQ("192.0.2.2", hosts[1]->getIPv4Reservation().toText());
+    EXPECT_EQ("192.0.2.3", hosts[2]->getIPv4Reservation().toText());
+    EXPECT_EQ(1, source->queries_);
+
+    // There are no reservations in other subnets.
+    EXPECT_TRUE(HostMgr::instance().getByIdentifiers4(SubnetID(2),
+                                                      identifiers).empty());
+
+    // The alternate data source is not used when all identifiers have
+    // reservations in the configuration.
+    HostIdentifierList cfg_identifiers;
+    cfg_identifiers.push_back(circuit_id);
+    cfg_identifiers.push_back(duid);
+    source->queries_ = 0;
+    hosts = HostMgr::instance().getByIdentifiers4(SubnetID(1), cfg_identifiers);
+    ASSERT_EQ(2, hosts.size());
+    EXPECT_EQ("192.0.2.3", hosts[0]->getIPv4Reservation().toText());
+    EXPECT_EQ("192.0.2.2", hosts[1]->getIPv4Reservation().toText());
+    EXPECT_EQ(0, source->queries_);
+}
+
+// This test verifies that the lookups in the alternate data source are
+// cached, and that the cache is updated when hosts are added and flushed.
+TEST_F(HostMgrTest, cache) {
+    boost::shared_ptr<CountingHostDataSource> source(new CountingHostDataSource());
+    HostMgr::instance().setTestHostDataSource(source);
+    EXPECT_FALSE(HostMgr::instance().getHostCache());
+    EXPECT_FALSE(HostMgr::instance().flushCache());
+    HostCachePtr cache(new HostCache(100, 0));
+    HostMgr::instance().setTestHostCache(cache);
+
+    HostIdentifierList identifiers = clientIdentifiers(1);
+    const HostIdentifier& hwaddr = identifiers.front();
+
+    // The negative result is cached.
+    EXPECT_FALSE(HostMgr::instance().get4(SubnetID(1), hwaddr.first,
+                                          &hwaddr.second[0],
+                                          hwaddr.second.size()));
+    EXPECT_FALSE(HostMgr::instance().get4(SubnetID(1), hwaddr.first,
+                                          &hwaddr.second[0],
+                                          hwaddr.second.size()));
+    EXPECT_EQ(1, source->queries_);
+
+    // Only the identifiers which are not cached are looked up.
+    source->queries_ = 0;
+    EXPECT_TRUE(HostMgr::instance().getByIdentifiers4(SubnetID(1),
+                                                      identifiers).empty());
+    EXPECT_TRUE(HostMgr::instance().getByIdentifiers4(SubnetID(1),
+                                                      identifiers).empty());
+    EXPECT_EQ(1, source->queries_);
+    EXPECT_EQ(identifiers.size(), cache->size());
+
+    // Adding the host removes the negative entry.
+    HostPtr host(new Host(&hwaddr.second[0], hwaddr.second.size(),
+                          hwaddr.first, SubnetID(1), SubnetID(0),
+                          IOAddress("192.0.2.1")));
+    ASSERT_NO_THROW(HostMgr::instance().add(host));
+    source->queries_ = 0;
+    ConstHostCollection hosts =
+        HostMgr::instance().getByIdentifiers4(SubnetID(1), identifiers);
+    ASSERT_EQ(1, hosts.size());
+    EXPECT_EQ("192.0.2.1", hosts[0]->getIPv4Reservation().toText());
+    ConstHostPtr found = HostMgr::instance().get4(SubnetID(1), hwaddr.first,
+                                                  &hwaddr.second[0],
+                                                  hwaddr.second.size());
+    ASSERT_TRUE(found);
+    EXPECT_EQ("192.0.2.1", found->getIPv4Reservation().toText());
+    EXPECT_EQ(1, source->queries_);
+
+    // The lookups go to the data source again after the flush.
+    EXPECT_TRUE(HostMgr::instance().flushCache());
+    EXPECT_EQ(0, cache->size());
+    source->queries_ = 0;
+    EXPECT_TRUE(HostMgr::instance().get4(SubnetID(1), hwaddr.first,
+                                         &hwaddr.second[0],
+                                         hwaddr.second.size()));
+    EXPECT_EQ(1, source->queries_);
+}
+
+// This is a performance benchmark of the reservation lookup done for each
+// packet by a client without a reservation, which is the common case. It
+// compares the lookup by each identifier with the lookup by all identifiers
+// at once, with an alternate data source simulating 100us round trips.
+TEST_F(HostMgrTest, DISABLED_performanceGetByIdentifiers4) {
+    const uint32_t packets = 1000;
+    boost::shared_ptr<CountingHostDataSource> source(new CountingHostDataSource(100));
+    HostMgr::instance().setTestHostDataSource(source);
+
+    // Every tenth client has a reservation in the alternate data source
+    // using its last identifier.
+    for (uint32_t i = 0; i < packets; i += 10) {
+        const HostIdentifier& id = clientIdentifiers(i).back();
+        source->add(HostPtr(new Host(&id.second[0], id.second.size(), id.first,
+                                     SubnetID(1), SubnetID(0),
+                                     IOAddress(0x0a000000 + i))));
+    }
+
+    source->queries_ = 0;
+    ptime before = microsec_clock::local_time();
+    for (uint32_t i = 0; i < packets; ++i) {
+        HostIdentifierList identifiers = clientIdentifiers(i);
+        BOOST_FOREACH(const HostIdentifier& id, identifiers) {
+            if (HostMgr::instance().get4(SubnetID(1), id.first, &id.second[0],
+                                         id.second.size())) {
+                break;
+            }
+        }
+    }
+    time_duration each_dur = microsec_clock::local_time() - before;
+    size_t each_queries = source->queries_;
+
+    source->queries_ = 0;
+    before = microsec_clock::local_time();
+    for (uint32_t i = 0; i < packets; ++i) {
+        HostMgr::instance().getByIdentifiers4(SubnetID(1), clientIdentifiers(i));
+    }
+    time_duration all_dur = microsec_clock::local_time() - before;
+
+    size_t all_queries = source->queries_;
+
+    // The same lookups repeated with the host cache enabled.
+    HostMgr::instance().setTestHostCache(HostCachePtr(new HostCache(packets * 10,
+                                                                   0)));
+    for (uint32_t i = 0; i < packets; ++i) {
+        HostMgr::instance().getByIdentifiers4(SubnetID(1), clientIdentifiers(i));
+    }
+    source->queries_ = 0;
+    before = microsec_clock::local_time();
+    for (uint32_t i = 0; i < packets; ++i) {
+        HostMgr::instance().getByIdentifiers4(SubnetID(1), clientIdentifiers(i));
+    }
+    time_duration cached_dur = microsec_clock::local_time() - before;
+
+    std::cout << packets << " reservation lookups took: "
+              << durationToText(each_dur) << " with " << each_queries
+              << " queries (by each identifier), " << durationToText(all_dur)
+              << " with " << all_queries
+              << " queries (by all identifiers), " << durationToText(cached_dur)
+              << " with " << source->queries_
+              << " queries (by all identifiers, cached)" << std::endl;
+}
+
 // The following tests require MySQL enabled.
 #if defined HAVE_MYSQL
 
@@ -6,13 +6,18 @@
 
 #include <config.h>
 #include <asiolink/io_address.h>
+#include <dhcpsrv/binary_lease_file4.h>
+#include <dhcpsrv/binary_lease_file6.h>
 #include <dhcpsrv/csv_lease_file4.h>
 #include <dhcpsrv/csv_lease_file6.h>
 #include <dhcpsrv/memfile_lease_storage.h>
 #include <dhcpsrv/lease_file_loader.h>
 #include <dhcpsrv/tests/lease_file_io.h>
+#include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <gtest/gtest.h>
+#include <fstream>
+#include <iostream>
 #include <sstream>
 #include <string>
 
@@ -20,6 +25,7 @@ using namespace isc;
 using namespace isc::asiolink;
 using namespace isc::dhcp;
 using namespace isc::dhcp::test;
+using namespace boost::posix_time;
 
 namespace {
 
@@ -130,6 +136,49 @@ public:
         EXPECT_EQ(write_errs, lease_file.getWriteErrs());
     }
 
+    /// @brief Checks that the parallel load gives the same results as
+    /// the sequential load.
+    ///
+    /// This method loads the leases from the test file into the specified
+    /// storage with multiple threads. It also loads the leases from the
+    /// same file into a copy of the storage row by row and compares the
+    /// leases in both containers and the statistics of both lease files.
+    ///
+    /// @param storage A reference to the container to which leases
+    /// should be inserted.
+    /// @param max_errors Maximum number of corrupted leases.
+    /// @param threads Number of threads.
+    ///
+    /// @tparam LeaseObjectType A @c Lease4 or @c Lease6.
+    /// @tparam LeaseFileType A @c CSVLeaseFile4 or @c CSVLeaseFile6.
+    /// @tparam StorageType A @c Lease4Storage or @c Lease6Storage.
+    template<typename LeaseObjectType, typename LeaseFileType,
+             typename StorageType>
+    void compareLoads(StorageType& storage, const uint32_t max_errors,
+                      const size_t threads) {
+        StorageType expected(storage);
+        LeaseFileType lf_expected(filename_);
+        ASSERT_NO_THROW(LeaseFileLoader::load<LeaseObjectType>(lf_expected,
+                                                               expected,
+                                                               max_errors));
+
+        LeaseFileType lf(filename_);
+        ASSERT_NO_THROW(LeaseFileLoader::load<LeaseObjectType>(lf, storage,
+                                                               max_errors,
+                                                               true,
+                                                               threads));
+
+        checkStats(lf, lf_expected.getReads(), lf_expected.getReadLeases(),
+                   lf_expected.getReadErrs(), 0, 0, 0);
+
+        ASSERT_EQ(expected.size(), storage.size());
+        for (auto lease = expected.begin(); lease != expected.end(); ++lease) {
+            typename StorageType::iterator found = storage.find((*lease)->addr_);
+            ASSERT_TRUE(found != storage.end()) << (*lease)->addr_;
+            EXPECT_TRUE(**found == **lease) << (*lease)->toText();
+        }
+    }
+
     /// @brief Name of the test lease file.
     std::string filename_;
 
@@ -531,4 +580,392 @@ TEST_F(LeaseFileLoaderTest, loadWriteLeaseWithZeroLifetime) {
     checkStats(*lf, 0, 0, 0, 1, 1, 0);
     }
 }
+
+// This test verifies that the DHCPv4 leases loaded by multiple threads
+// are the same as the leases loaded row by row, i.e. only the most
+// recent entry for each lease is loaded, the leases with a valid lifetime
+// of 0 are removed and the invalid entries are discarded.
+TEST_F(LeaseFileLoaderTest, loadParallel4) {
+    std::string test_str = v4_hdr_;
+    // Several entries for each address spread over the file, so the
+    // entries for an address are parsed by different threads.
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 1; i <= 50; ++i) {
+            std::ostringstream row;
+            row << "192.0.2." << i << ",06:07:08:09:0a:" << std::hex << i
+                << std::dec << ",," << ((i % 7 == round) ? 0 : 200)
+                << "," << (200 + 100 * round) << ",8,1,1,host"
+                << i << ".example.com,1\n";
+            test_str += row.str();
+        }
+        // Invalid entry lacking HW address.
+        test_str += "192.0.2.100,,a:11:01:04,200,200,8,1,1,host.example.com,0\n";
+    }
+    io_.writeFile(test_str);
+
+    Lease4Storage storage;
+    compareLoads<Lease4, CSVLeaseFile4>(storage, 10, 4);
+
+    // The lease for 192.0.2.1 is released in the second round and
+    // allocated again in the last round.
+    Lease4Ptr lease = getLease<Lease4Ptr>("192.0.2.1", storage);
+    ASSERT_TRUE(lease);
+    EXPECT_EQ(200, lease->cltt_);
+
+    // The lease for 192.0.2.2 is released in the last round.
+    EXPECT_FALSE(getLease<Lease4Ptr>("192.0.2.2", storage));
+
+    // The invalid entry should not be loaded.
+    EXPECT_FALSE(getLease<Lease4Ptr>("192.0.2.100", storage));
+}
+
+// This test verifies that the DHCPv6 leases loaded by multiple threads
+// are the same as the leases loaded row by row.
+TEST_F(LeaseFileLoaderTest, loadParallel6) {
+    std::string a_1 = "2001:db8:1::1,00:01:02:03:04:05:06:0a:0b:0c:0d:0e:0f,"
+                      "200,200,8,100,0,7,0,1,1,host.example.com,,1\n";
+    std::string a_2 = "2001:db8:1::1,,"
+                      "200,200,8,100,0,7,0,1,1,host.example.com,,1\n";
+    std::string a_3 = "2001:db8:1::1,00:01:02:03:04:05:06:0a:0b:0c:0d:0e:0f,"
+                      "200,400,8,100,0,7,0,1,1,host.example.com,,1\n";
+
+    std::string b_1 = "2001:db8:2::10,01:01:01:01:0a:01:02:03:04:05,"
+                      "300,300,6,150,0,8,0,0,0,,,1\n";
+    std::string b_2 = "2001:db8:2::10,01:01:01:01:0a:01:02:03:04:05,"
+                      "0,800,6,150,0,8,0,0,0,,,1\n";
+
+    std::string c_1 = "3000:1::,00:01:02:03:04:05:06:0a:0b:0c:0d:0e:0f,"
+                      "100,200,8,0,2,16,64,0,0,,,1\n";
+
+    io_.writeFile(v6_hdr_ + a_1 + a_2 + b_1 + c_1 + b_2 + a_3);
+
+    Lease6Storage storage;
+    compareLoads<Lease6, CSVLeaseFile6>(storage, 10, 3);
+
+    // The 2001:db8:2::10 has been released.
+    ASSERT_EQ(2, storage.size());
+    Lease6Ptr lease = getLease<Lease6Ptr>("2001:db8:1::1", storage);
+    ASSERT_TRUE(lease);
+    EXPECT_EQ(200, lease->cltt_);
+    EXPECT_TRUE(getLease<Lease6Ptr>("3000:1::", storage));
+}
+
+// This test verifies that the leases loaded by multiple threads update
+// and remove the leases already held in the storage, e.g. the leases
+// loaded from the previous lease file.
+TEST_F(LeaseFileLoaderTest, loadParallelExistingLeases) {
+    std::string a_1 = "192.0.2.1,06:07:08:09:0a:bc,,"
+                      "200,200,8,1,1,host.example.com,1\n";
+    std::string a_2 = "192.0.2.1,06:07:08:09:0a:bc,,"
+                      "200,500,8,1,1,host.example.com,1\n";
+    std::string b_1 = "192.0.3.15,dd:de:ba:0d:1b:2e:3e:4f,0a:00:01:04,"
+                      "100,100,7,0,0,,1\n";
+    std::string b_2 = "192.0.3.15,dd:de:ba:0d:1b:2e:3e:4f,0a:00:01:04,"
+                      "0,135,7,0,0,,1\n";
+    std::string c_1 = "192.0.2.10,01:02:03:04:05:06,,200,300,8,1,1,,1\n";
+
+    io_.writeFile(v4_hdr_ + a_1 + b_1);
+    CSVLeaseFile4 lf_previous(filename_);
+    Lease4Storage storage;
+    ASSERT_NO_THROW(LeaseFileLoader::load<Lease4>(lf_previous, storage, 0));
+    ASSERT_EQ(2, storage.size());
+
+    io_.writeFile(v4_hdr_ + b_2 + a_2 + c_1);
+    compareLoads<Lease4, CSVLeaseFile4>(storage, 0, 2);
+
+    ASSERT_EQ(2, storage.size());
+    Lease4Ptr lease = getLease<Lease4Ptr>("192.0.2.1", storage);
+    ASSERT_TRUE(lease);
+    EXPECT_EQ(300, lease->cltt_);
+    EXPECT_TRUE(getLease<Lease4Ptr>("192.0.2.10", storage));
+    EXPECT_FALSE(getLease<Lease4Ptr>("192.0.3.15", storage));
+}
+
+// This test verifies that the exception is thrown when the specific
+// number of errors occur during the parallel load and that the storage
+// is not modified in this case.
+TEST_F(LeaseFileLoaderTest, loadParallelMaxErrors) {
+    std::string a_1 = "192.0.2.1,06:07:08:09:0a:bc,,"
+                      "200,200,8,1,1,host.example.com,1\n";
+    std::string a_2 = "192.0.2.1,06:07:08:09:0a:bc,,"
+                      "200,500,8,1,1,host.example.com,1\n";
+    std::string b_1 = "192.0.2.3,,a:11:01:04,200,200,8,1,1,host.example.com,0\n";
+    std::string c_1 = "192.0.2.10,01:02:03:04:05:06,,200,300,8,1,1,,1\n";
+
+    io_.writeFile(v4_hdr_ + a_1 + b_1 + b_1 + c_1 + b_1 + b_1 + a_2);
+
+    CSVLeaseFile4 lf(filename_);
+    Lease4Storage storage;
+    ASSERT_THROW(LeaseFileLoader::load<Lease4>(lf, storage, 3, true, 4),
+                 util::CSVFileError);
+    EXPECT_TRUE(storage.empty());
+
+    compareLoads<Lease4, CSVLeaseFile4>(storage, 4, 4);
+    EXPECT_EQ(2, storage.size());
+}
+
+// This test verifies that the last row which is not terminated with a new
+// line character is loaded by the parallel load, as it is by the
+// sequential load, and that it is an error when it is truncated.
+TEST_F(LeaseFileLoaderTest, loadParallelUnterminatedRow) {
+    std::string a_1 = "192.0.2.1,06:07:08:09:0a:bc,,"
+                      "200,200,8,1,1,host.example.com,1\n";
+    std::string b_1 = "192.0.2.3,06:07:08:09:0a:bd,,200,200,8,1,1,,1";
+
+    io_.writeFile(v4_hdr_ + a_1 + b_1);
+
+    Lease4Storage storage;
+    compareLoads<Lease4, CSVLeaseFile4>(storage, 0, 2);
+    EXPECT_EQ(2, storage.size());
+
+    // The last row was truncated while it was written.
+    io_.writeFile(v4_hdr_ + a_1 + b_1.substr(0, 20));
+    storage.clear();
+    compareLoads<Lease4, CSVLeaseFile4>(storage, 1, 2);
+    EXPECT_EQ(1, storage.size());
+
+    // A file holding only the header.
+    io_.writeFile(v4_hdr_);
+    storage.clear();
+    compareLoads<Lease4, CSVLeaseFile4>(storage, 0, 2);
+    EXPECT_TRUE(storage.empty());
+}
+
+// This test verifies that the parallel and the sequential loads report
+// the same errors and load the same leases from a corrupted lease file,
+// regardless of the number of threads.
+TEST_F(LeaseFileLoaderTest, loadParallelCorrupted) {
+    const char* rows[] = {
+        "192.0.2.1,06:07:08:09:0a:bc,,200,200,8,1,1,host.example.com,1\n",
+        // Invalid address.
+        "192.0.2.256,06:07:08:09:0a:bd,,200,200,8,1,1,,1\n",
+        // Too few columns.
+        "192.0.2.2,06:07:08:09:0a:be,,200,200,8\n",
+        "192.0.2.3,06:07:08:09:0a:bf,,200,200,8,1,1,,1\n",
+        // Too many columns.
+        "192.0.2.4,06:07:08:09:0a:c0,,200,200,8,1,1,,1,extra\n",
+        // Empty row.
+        "\n",
+        // Invalid lifetime.
+        "192.0.2.5,06:07:08:09:0a:c1,,abc,200,8,1,1,,1\n",
+        // Garbage.
+        "\x01\x02,\x03\xff\n",
+        // Removes the lease for 192.0.2.1.
+        "192.0.2.1,06:07:08:09:0a:bc,,0,300,8,1,1,,1\n",
+        "192.0.2.6,06:07:08:09:0a:c2,,200,200,8,1,1,,1\n",
+        // Truncated last row.
+        "192.0.2.7,06:07:08:09:0a"
+    };
+    std::string test_str = v4_hdr_;
+    for (size_t i = 0; i < sizeof(rows) / sizeof(rows[0]); ++i) {
+        test_str += rows[i];
+    }
+    io_.writeFile(test_str);
+
+    for (size_t threads = 2; threads <= 12; ++threads) {
+        SCOPED_TRACE(threads);
+        Lease4Storage storage;
+        compareLoads<Lease4, CSVLeaseFile4>(storage, 7, threads);
+        EXPECT_EQ(2, storage.size());
+        EXPECT_TRUE(getLease<Lease4Ptr>("192.0.2.3", storage));
+        EXPECT_TRUE(getLease<Lease4Ptr>("192.0.2.6", storage));
+    }
+
+    // Both loads fail when there are too many errors. The parallel load
+    // doesn't modify the storage in this case.
+    CSVLeaseFile4 lf_sequential(filename_);
+    Lease4Storage storage;
+    EXPECT_THROW(LeaseFileLoader::load<Lease4>(lf_sequential, storage, 6),
+                 util::CSVFileError);
+    storage.clear();
+    CSVLeaseFile4 lf_parallel(filename_);
+    EXPECT_THROW(LeaseFileLoader::load<Lease4>(lf_parallel, storage, 6, true,
+                                               4),
+                 util::CSVFileError);
+    EXPECT_TRUE(storage.empty());
+}
+
+// This test verifies that the DHCPv4 lease file is converted to the
+// binary format and back, and that the same leases are loaded from the
+// converted files.
+TEST_F(LeaseFileLoaderTest, convert4) {
+    std::string a_1 = "192.0.2.1,06:07:08:09:0a:bc,,"
+                      "200,200,8,1,1,host.example.com,1\n";
+    std::string a_2 = "192.0.2.1,06:07:08:09:0a:bc,,"
+                      "200,500,8,1,1,host.example.com,1\n";
+    std::string b_1 = "192.0.3.15,dd:de:ba:0d:1b:2e:3e:4f,0a:00:01:04,"
+                      "100,100,7,0,0,,1\n";
+    std::string b_2 = "192.0.3.15,dd:de:ba:0d:1b:2e:3e:4f,0a:00:01:04,"
+                      "0,135,7,0,0,,1\n";
+    std::string c_1 = "192.0.2.3,,a:11:01:04,"
+                      "200,200,8,1,1,host.example.com,0\n";
+    io_.writeFile(v4_hdr_ + a_1 + b_1 + c_1 + b_2 + a_2);
+
+    EXPECT_EQ(LEASE_FILE_CSV,
+              LeaseFileLoader::detectFormat(filename_, LEASE_FILE_BINARY));
+
+    Lease4Storage expected;
+    CSVLeaseFile4 lf(filename_);
+    ASSERT_NO_THROW(LeaseFileLoader::load<Lease4>(lf, expected, 10));
+
+    // Convert the file to the binary format. The invalid entry is
+    // skipped and the entry with a valid lifetime of 0 is copied.
+    std::string binary_filename = absolutePath("leases4.bin");
+    LeaseFileIO binary_io(binary_filename);
+    BinaryLeaseFile4 binary_lf(binary_filename);
+    ASSERT_NO_THROW(LeaseFileLoader::convert<Lease4>(lf, binary_lf, 10));
+    checkStats(lf, 6, 4, 1, 0, 0, 0);
+    checkStats(binary_lf, 0, 0, 0, 4, 4, 0);
+    EXPECT_EQ(LEASE_FILE_BINARY,
+              LeaseFileLoader::detectFormat(binary_filename, LEASE_FILE_CSV));
+
+    // Convert the binary file back to the CSV format.
+    std::string csv_filename = absolutePath("leases4.converted.csv");
+    LeaseFileIO csv_io(csv_filename);
+    CSVLeaseFile4 csv_lf(csv_filename);
+    ASSERT_NO_THROW(LeaseFileLoader::convert<Lease4>(binary_lf, csv_lf, 10));
+    checkStats(binary_lf, 5, 4, 0, 0, 0, 0);
+    checkStats(csv_lf, 0, 0, 0, 4, 4, 0);
+
+    // The leases loaded from each file should be the same.
+    const std::string filenames[] = { binary_filename, csv_filename };
+    for (int i = 0; i < 2; ++i) {
+        SCOPED_TRACE(filenames[i]);
+        Lease4Storage storage;
+        LeaseFile4Ptr loaded;
+        ASSERT_NO_THROW((LeaseFileLoader::loadFile<Lease4, CSVLeaseFile4,
+                         BinaryLeaseFile4>(filenames[i], LEASE_FILE_CSV,
+                                           loaded, storage, 0)));
+        ASSERT_EQ(expected.size(), storage.size());
+        for (auto lease = expected.begin(); lease != expected.end(); ++lease) {
+            Lease4Ptr found = getLease<Lease4Ptr>((*lease)->addr_.toText(),
+                                                  storage);
+            ASSERT_TRUE(found);
+            EXPECT_TRUE(*found == **lease) << (*lease)->toText();
+        }
+    }
+}
+
+// This test verifies that the DHCPv6 lease file is converted to the
+// binary format and that the same leases are loaded from the converted
+// file.
+TEST_F(LeaseFileLoaderTest, convert6) {
+    std::string a_1 = "2001:db8:1::1,00:01:02:03:04:05:06:0a:0b:0c:0d:0e:0f,"
+                      "200,200,8,100,0,7,0,1,1,host.example.com,,1\n";
+    std::string a_2 = "2001:db8:1::1,00:01:02:03:04:05:06:0a:0b:0c:0d:0e:0f,"
+                      "200,400,8,100,0,7,0,1,1,host.example.com,,1\n";
+    std::string b_1 = "2001:db8:2::10,01:01:01:01:0a:01:02:03:04:05,"
+                      "300,300,6,150,0,8,0,0,0,,,1\n";
+    std::string b_2 = "2001:db8:2::10,01:01:01:01:0a:01:02:03:04:05,"
+                      "0,800,6,150,0,8,0,0,0,,,1\n";
+    std::string c_1 = "3000:1::,00:01:02:03:04:05:06:0a:0b:0c:0d:0e:0f,"
+                      "100,200,8,0,2,16,64,0,0,,06:07:08:09:0a:bc,1\n";
+    io_.writeFile(v6_hdr_ + a_1 + b_1 + c_1 + b_2 + a_2);
+
+    Lease6Storage expected;
+    CSVLeaseFile6 lf(filename_);
+    ASSERT_NO_THROW(LeaseFileLoader::load<Lease6>(lf, expected, 0));
+    ASSERT_EQ(2, expected.size());
+
+    std::string binary_filename = absolutePath("leases6.bin");
+    LeaseFileIO binary_io(binary_filename);
+    BinaryLeaseFile6 binary_lf(binary_filename);
+    ASSERT_NO_THROW(LeaseFileLoader::convert<Lease6>(lf, binary_lf, 0));
+    checkStats(binary_lf, 0, 0, 0, 5, 5, 0);
+
+    Lease6Storage storage;
+    ASSERT_NO_THROW(LeaseFileLoader::load<Lease6>(binary_lf, storage, 0));
+    ASSERT_EQ(expected.size(), storage.size());
+    for (auto lease = expected.begin(); lease != expected.end(); ++lease) {
+        Lease6Ptr found = getLease<Lease6Ptr>((*lease)->addr_.toText(),
+                                              storage);
+        ASSERT_TRUE(found);
+        EXPECT_TRUE(*found == **lease) << (*lease)->toText();
+    }
+}
+
+// This test verifies that the leases are loaded in bulk from the binary
+// snapshot into the empty storage and that the entries of the lease file
+// loaded afterwards are replayed on top of the snapshot.
+TEST_F(LeaseFileLoaderTest, loadSnapshot4) {
+    std::string binary_filename = absolutePath("leases4.bin");
+    LeaseFileIO binary_io(binary_filename);
+    {
+        BinaryLeaseFile4 snapshot(binary_filename);
+        snapshot.setSnapshot(true);
+        ASSERT_NO_THROW(snapshot.open());
+        for (int i = 1; i <= 3; ++i) {
+            std::ostringstream addr;
+            addr << "192.0.2." << i;
+            HWAddrPtr hwaddr(new HWAddr(std::vector<uint8_t>(6, i),
+                                        HTYPE_ETHER));
+            ASSERT_NO_THROW(snapshot.append(Lease4(IOAddress(addr.str()),
+                                                   hwaddr, NULL, 0, 200,
+                                                   0, 0, 100, 8)));
+        }
+    }
+
+    Lease4Storage storage;
+    LeaseFile4Ptr lf;
+    ASSERT_NO_THROW((LeaseFileLoader::loadFile<Lease4, CSVLeaseFile4,
+                     BinaryLeaseFile4>(binary_filename, LEASE_FILE_CSV,
+                                       lf, storage, 0)));
+    ASSERT_EQ(3, storage.size());
+    Lease4Ptr lease = getLease<Lease4Ptr>("192.0.2.2", storage);
+    ASSERT_TRUE(lease);
+    EXPECT_EQ(100, lease->cltt_);
+
+    // The journal removes one lease and renews the other one.
+    io_.writeFile(v4_hdr_ +
+                  "192.0.2.1,01:01:01:01:01:01,,0,200,8,0,0,,0\n"
+                  "192.0.2.2,02:02:02:02:02:02,,200,500,8,0,0,,0\n");
+    ASSERT_NO_THROW((LeaseFileLoader::loadFile<Lease4, CSVLeaseFile4,
+                     BinaryLeaseFile4>(filename_, LEASE_FILE_CSV,
+                                       lf, storage, 0)));
+    ASSERT_EQ(2, storage.size());
+    EXPECT_FALSE(getLease<Lease4Ptr>("192.0.2.1", storage));
+    lease = getLease<Lease4Ptr>("192.0.2.2", storage);
+    ASSERT_TRUE(lease);
+    EXPECT_EQ(300, lease->cltt_);
+    EXPECT_TRUE(getLease<Lease4Ptr>("192.0.2.3", storage));
+}
+
+// This is a benchmark comparing the time to load the DHCPv4 lease file
+// row by row and with multiple threads. The lease file holds a renewal
+// entry for each lease.
+TEST_F(LeaseFileLoaderTest, DISABLED_performanceLoad4) {
+    const size_t lease_counts[] = { 1000000 };
+    for (size_t c = 0; c < sizeof(lease_counts) / sizeof(lease_counts[0]); ++c) {
+        const size_t leases = lease_counts[c];
+        {
+            std::ofstream file(filename_.c_str());
+            file << v4_hdr_;
+            for (size_t round = 0; round < 2; ++round) {
+                for (size_t i = 0; i < leases; ++i) {
+                    const uint32_t addr = 0x0a000000 + i;
+                    file << IOAddress(addr).toText() << ",01:02:"
+                         << std::hex << ((i >> 24) & 0xff) << ":"
+                         << ((i >> 16) & 0xff) << ":" << ((i >> 8) & 0xff)
+                         << ":" << (i & 0xff) << std::dec
+                         << ",,3600," << (1500000000 + round * 1800)
+                         << ",1,0,0,,0\n";
+                }
+            }
+        }
+
+        const size_t threads[] = { 1, 0 };
+        for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); ++t) {
+            Lease4Storage storage;
+            CSVLeaseFile4 lf(filename_);
+            ptime before = microsec_clock::local_time();
+            LeaseFileLoader::load<Lease4>(lf, storage, 0, true, threads[t]);
+            time_duration dur = microsec_clock::local_time() - before;
+            ASSERT_EQ(leases, storage.size());
+            std::cout << leases << " leases loaded "
+                      << (threads[t] == 1 ? "row by row" : "in parallel")
+                      << " in: " << to_simple_string(dur) << std::endl;
+        }
+    }
+}
+
 } // end of anonymous namespace
@@ -10,6 +10,8 @@
 #include <asiolink/io_address.h>
 #include <dhcp/duid.h>
 #include <dhcp/iface_mgr.h>
+#include <dhcpsrv/binary_lease_file4.h>
+#include <dhcpsrv/binary_lease_file6.h>
 #include <dhcpsrv/cfgmgr.h>
 #include <dhcpsrv/lease_mgr.h>
 #include <dhcpsrv/lease_mgr_factory.h>
@@ -18,11 +20,14 @@
 #include <dhcpsrv/tests/lease_file_io.h>
 #include <dhcpsrv/tests/test_utils.h>
 #include <dhcpsrv/tests/generic_lease_mgr_unittest.h>
+#include <stats/stats_mgr.h>
+#include <util/boost_time_utils.h>
 #include <util/pid_file.h>
 #include <util/range_utilities.h>
 #include <util/stopwatch.h>
 
 #include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
 #include <gtest/gtest.h>
 
 #include <cstdlib>
@@ -33,10 +38,12 @@
 #include <unistd.h>
 
 using namespace std;
+using namespace boost::posix_time;
 using namespace isc;
 using namespace isc::asiolink;
 using namespace isc::dhcp;
 using namespace isc::dhcp::test;
+using namespace isc::stats;
 using namespace isc::util;
 
 namespace {
@@ -648,6 +655,156 @@ TEST_F(MemfileLeaseMgrTest, leaseFileCleanup6) {
     EXPECT_EQ(result_file_contents, input_file.readFile());
 }
 
+// This test checks that the lease file cleanup performed by the backend
+// writes the leases held in memory and rotates the current lease file.
+TEST_F(MemfileLeaseMgrTest, leaseFileCleanupInternal4) {
+    std::string new_file_contents =
+        "address,hwaddr,client_id,valid_lifetime,expire,"
+        "subnet_id,fqdn_fwd,fqdn_rev,hostname,state\n";
+
+    std::string current_file_contents = new_file_contents +
+        "192.0.2.2,02:02:02:02:02:02,,200,200,8,1,1,,1\n"
+        "192.0.2.2,02:02:02:02:02:02,,200,800,8,1,1,,1\n";
+    LeaseFileIO current_file(getLeaseFilePath("leasefile4_0.csv"));
+    current_file.writeFile(current_file_contents);
+
+    std::string previous_file_contents = new_file_contents +
+        "192.0.2.3,03:03:03:03:03:03,,200,200,8,1,1,,1\n"
+        "192.0.2.3,03:03:03:03:03:03,,200,800,8,1,1,,1\n"
+        "192.0.2.4,04:04:04:04:04:04,,200,800,8,1,1,,1\n"
+        "192.0.2.4,04:04:04:04:04:04,,0,800,8,1,1,,1\n";
+    LeaseFileIO previous_file(getLeaseFilePath("leasefile4_0.csv.2"));
+    previous_file.writeFile(previous_file_contents);
+
+    DatabaseConnection::ParameterMap pmap;
+    pmap["type"] = "memfile";
+    pmap["universe"] = "4";
+    pmap["name"] = getLeaseFilePath("leasefile4_0.csv");
+    pmap["lfc-interval"] = "1";
+    pmap["lfc-mode"] = "internal";
+    boost::scoped_ptr<NakedMemfileLeaseMgr> lease_mgr(new NakedMemfileLeaseMgr(pmap));
+
+    ASSERT_NO_THROW(lease_mgr->lfcCallback());
+
+    // The current lease file has been recreated.
+    ASSERT_TRUE(current_file.exists());
+    EXPECT_EQ(new_file_contents, current_file.readFile());
+
+    ASSERT_TRUE(waitForProcess(*lease_mgr, 2));
+    EXPECT_EQ(0, lease_mgr->getLFCExitStatus());
+
+    // The leases held in memory have been written to the previous file
+    // in the format of the lease files and the copy of the current lease
+    // file has been removed.
+    EXPECT_EQ(new_file_contents +
+              "192.0.2.2,02:02:02:02:02:02,,200,800,8,1,1,,1\n"
+              "192.0.2.3,03:03:03:03:03:03,,200,800,8,1,1,,1\n",
+              previous_file.readFile());
+    LeaseFileIO input_file(getLeaseFilePath("leasefile4_0.csv.1"), false);
+    EXPECT_FALSE(input_file.exists());
+    LeaseFileIO finish_file(getLeaseFilePath("leasefile4_0.csv.completed"),
+                            false);
+    EXPECT_FALSE(finish_file.exists());
+
+    // The updates are recorded in the new lease file.
+    std::vector<uint8_t> hwaddr_vec(6);
+    HWAddrPtr hwaddr(new HWAddr(hwaddr_vec, HTYPE_ETHER));
+    Lease4Ptr new_lease(new Lease4(IOAddress("192.0.2.45"), hwaddr, 0, 0,
+                                   100, 50, 60, 0, 1));
+    ASSERT_NO_THROW(lease_mgr->addLease(new_lease));
+    std::string updated_file_contents = new_file_contents +
+        "192.0.2.45,00:00:00:00:00:00,,100,100,1,0,0,,0\n";
+    EXPECT_EQ(updated_file_contents, current_file.readFile());
+
+    // All leases are loaded from the files.
+    lease_mgr.reset();
+    lease_mgr.reset(new NakedMemfileLeaseMgr(pmap));
+    EXPECT_TRUE(lease_mgr->getLease4(IOAddress("192.0.2.2")));
+    EXPECT_TRUE(lease_mgr->getLease4(IOAddress("192.0.2.3")));
+    EXPECT_FALSE(lease_mgr->getLease4(IOAddress("192.0.2.4")));
+    EXPECT_TRUE(lease_mgr->getLease4(IOAddress("192.0.2.45")));
+}
+
+// This test checks that the lease file cleanup performed by the backend
+// doesn't move the current lease file when the copy of the lease file
+// left by the interrupted cleanup exists, that the copy is removed and
+// that the leases are written as a binary snapshot when the lease files
+// are binary.
+TEST_F(MemfileLeaseMgrTest, leaseFileCleanupInternal6) {
+    std::string new_file_contents =
+        "address,duid,valid_lifetime,expire,subnet_id,pref_lifetime,"
+        "lease_type,iaid,prefix_len,fqdn_fwd,fqdn_rev,hostname,hwaddr,"
+        "state\n";
+
+    std::string current_file_contents = new_file_contents +
+        "2001:db8:1::1,00:01:02:03:04:05:06:0a:0b:0c:0d:0e:0f,"
+        "200,800,8,100,0,7,0,1,1,,,1\n";
+    LeaseFileIO current_file(getLeaseFilePath("leasefile6_0.csv"));
+    current_file.writeFile(current_file_contents);
+
+    std::string input_file_contents = new_file_contents +
+        "2001:db8:1::2,01:01:01:01:0a:01:02:03:04:05,"
+        "200,800,8,100,0,7,0,1,1,,,1\n";
+    LeaseFileIO input_file(getLeaseFilePath("leasefile6_0.csv.1"), false);
+    input_file.writeFile(input_file_contents);
+
+    DatabaseConnection::ParameterMap pmap;
+    pmap["type"] = "memfile";
+    pmap["universe"] = "6";
+    pmap["name"] = getLeaseFilePath("leasefile6_0.csv");
+    pmap["lfc-interval"] = "1";
+    pmap["lfc-mode"] = "internal";
+    pmap["lease-file-format"] = "binary";
+    boost::scoped_ptr<NakedMemfileLeaseMgr> lease_mgr(new NakedMemfileLeaseMgr(pmap));
+
+    // The current lease file has been converted to the binary format.
+    const std::string converted_file_contents = current_file.readFile();
+    ASSERT_TRUE(BinaryLeaseFile::hasBinaryHeader(getLeaseFilePath("leasefile6_0.csv")));
+
+    ASSERT_NO_THROW(lease_mgr->lfcCallback());
+    ASSERT_TRUE(waitForProcess(*lease_mgr, 2));
+    EXPECT_EQ(0, lease_mgr->getLFCExitStatus());
+
+    // The current lease file is left in place.
+    EXPECT_EQ(converted_file_contents, current_file.readFile());
+    EXPECT_FALSE(input_file.exists());
+
+    const std::string snapshot_name = getLeaseFilePath("leasefile6_0.csv.2");
+    ASSERT_TRUE(BinaryLeaseFile::hasBinaryHeader(snapshot_name));
+    BinaryLeaseFile6 snapshot(snapshot_name);
+    ASSERT_NO_THROW(snapshot.open());
+    EXPECT_TRUE(snapshot.isSnapshot());
+    Lease6Ptr lease;
+    ASSERT_TRUE(snapshot.next(lease));
+    ASSERT_TRUE(lease);
+    EXPECT_EQ("2001:db8:1::1", lease->addr_.toText());
+    ASSERT_TRUE(snapshot.next(lease));
+    ASSERT_TRUE(lease);
+    EXPECT_EQ("2001:db8:1::2", lease->addr_.toText());
+    ASSERT_TRUE(snapshot.next(lease));
+    EXPECT_FALSE(lease);
+    snapshot.close();
+
+    // The leases are loaded from the snapshot and the current lease file.
+    lease_mgr.reset();
+    lease_mgr.reset(new NakedMemfileLeaseMgr(pmap));
+    EXPECT_TRUE(lease_mgr->getLease6(Lease::TYPE_NA,
+                                     IOAddress("2001:db8:1::1")));
+    EXPECT_TRUE(lease_mgr->getLease6(Lease::TYPE_NA,
+                                     IOAddress("2001:db8:1::2")));
+}
+
+// This test checks that the backend refuses the invalid lfc-mode.
+TEST_F(MemfileLeaseMgrTest, invalidLFCMode) {
+    DatabaseConnection::ParameterMap pmap;
+    pmap["type"] = "memfile";
+    pmap["universe"] = "4";
+    pmap["name"] = getLeaseFilePath("leasefile4_0.csv");
+    pmap["lfc-mode"] = "fork";
+    boost::scoped_ptr<NakedMemfileLeaseMgr> lease_mgr;
+    EXPECT_THROW(lease_mgr.reset(new NakedMemfileLeaseMgr(pmap)), BadValue);
+}
+
 // This test verifies that EXIT_FAILURE status code is returned when
 // the LFC process fails to start.
 TEST_F(MemfileLeaseMgrTest, leaseFileCleanupStartFail) {
@@ -915,6 +1072,12 @@ TEST_F(MemfileLeaseMgrTest, getLease4ClientIdSubnetId) {
     testGetLease4ClientIdSubnetId();
 }
 
+// This test checks that all IPv4 leases for a specified subnet id are returned.
+TEST_F(MemfileLeaseMgrTest, getLeases4SubnetId) {
+    startBackend(V4);
+    testGetLeases4SubnetId();
+}
+
 /// @brief Basic Lease6 Checks
 ///
 /// Checks that the addLease, getLease6 (by address) and deleteLease (with an
@@ -1234,6 +1397,261 @@ TEST_F(MemfileLeaseMgrTest, load4LFCInProgress) {
     ASSERT_NO_THROW(lease_mgr.reset(new NakedMemfileLeaseMgr(pmap)));
 }
 
+// This test checks that the backend records the DHCPv4 leases in the
+// binary lease file, that the CSV lease file is converted to the binary
+// format and that the leases are loaded from both formats.
+TEST_F(MemfileLeaseMgrTest, binaryLeaseFile4) {
+    LeaseFileIO io1(getLeaseFilePath("leasefile4_0.csv.1"));
+    io1.writeFile("address,hwaddr,client_id,valid_lifetime,expire,subnet_id,"
+                  "fqdn_fwd,fqdn_rev,hostname,state\n"
+                  "192.0.2.1,01:01:01:01:01:01,,200,200,8,1,1,,1\n"
+                  "192.0.2.11,bb:bb:bb:bb:bb:bb,,200,400,8,1,1,,1\n");
+
+    LeaseFileIO io(getLeaseFilePath("leasefile4_0.csv"));
+    io.writeFile("address,hwaddr,client_id,valid_lifetime,expire,subnet_id,"
+                 "fqdn_fwd,fqdn_rev,hostname,state\n"
+                 "192.0.2.10,0a:0a:0a:0a:0a:0a,,200,200,8,1,1,,1\n"
+                 "192.0.2.11,bb:bb:bb:bb:bb:bb,,200,500,8,1,1,,1\n");
+
+    DatabaseConnection::ParameterMap pmap;
+    pmap["type"] = "memfile";
+    pmap["universe"] = "4";
+    pmap["name"] = getLeaseFilePath("leasefile4_0.csv");
+    pmap["lease-file-format"] = "binary";
+    boost::scoped_ptr<NakedMemfileLeaseMgr> lease_mgr;
+    ASSERT_NO_THROW(lease_mgr.reset(new NakedMemfileLeaseMgr(pmap)));
+
+    // The current lease file has been converted and the copy of the lease
+    // file is left in the CSV format.
+    EXPECT_TRUE(BinaryLeaseFile::hasBinaryHeader(pmap["name"]));
+    EXPECT_FALSE(BinaryLeaseFile::hasBinaryHeader(getLeaseFilePath("leasefile4_0.csv.1")));
+
+    Lease4Ptr lease = lease_mgr->getLease4(IOAddress("192.0.2.1"));
+    ASSERT_TRUE(lease);
+    lease = lease_mgr->getLease4(IOAddress("192.0.2.11"));
+    ASSERT_TRUE(lease);
+    EXPECT_EQ(300, lease->cltt_);
+
+    // Add a new lease and update the existing one.
+    HWAddrPtr hwaddr(new HWAddr(HWAddr::fromText("0c:0c:0c:0c:0c:0c")));
+    Lease4Ptr new_lease(new Lease4(IOAddress("192.0.2.12"), hwaddr, NULL, 0,
+                                   300, 100, 200, 1000, 8));
+    ASSERT_TRUE(lease_mgr->addLease(new_lease));
+    lease->hostname_ = "host.example.com";
+    ASSERT_NO_THROW(lease_mgr->updateLease4(lease));
+    ASSERT_NO_THROW(lease_mgr->deleteLease(IOAddress("192.0.2.10")));
+
+    // The leases should be loaded from the binary lease file.
+    ASSERT_NO_THROW(lease_mgr.reset(new NakedMemfileLeaseMgr(pmap)));
+    lease = lease_mgr->getLease4(IOAddress("192.0.2.12"));
+    ASSERT_TRUE(lease);
+    EXPECT_EQ(1000, lease->cltt_);
+    lease = lease_mgr->getLease4(IOAddress("192.0.2.11"));
+    ASSERT_TRUE(lease);
+    EXPECT_EQ("host.example.com", lease->hostname_);
+    EXPECT_FALSE(lease_mgr->getLease4(IOAddress("192.0.2.10")));
+    EXPECT_TRUE(lease_mgr->getLease4(IOAddress("192.0.2.1")));
+
+    // Switch back to the CSV format. The binary lease file should be
+    // converted and the same leases loaded.
+    pmap["lease-file-format"] = "csv";
+    ASSERT_NO_THROW(lease_mgr.reset(new NakedMemfileLeaseMgr(pmap)));
+    EXPECT_FALSE(BinaryLeaseFile::hasBinaryHeader(pmap["name"]));
+    EXPECT_TRUE(lease_mgr->getLease4(IOAddress("192.0.2.12")));
+    EXPECT_TRUE(lease_mgr->getLease4(IOAddress("192.0.2.11")));
+    EXPECT_FALSE(lease_mgr->getLease4(IOAddress("192.0.2.10")));
+}
+
+// This test checks that the backend records the DHCPv6 leases in the
+// binary lease file.
+TEST_F(MemfileLeaseMgrTest, binaryLeaseFile6) {
+    DatabaseConnection::ParameterMap pmap;
+    pmap["type"] = "memfile";
+    pmap["universe"] = "6";
+    pmap["name"] = getLeaseFilePath("leasefile6_0.csv");
+    pmap["lease-file-format"] = "binary";
+    boost::scoped_ptr<NakedMemfileLeaseMgr> lease_mgr;
+    ASSERT_NO_THROW(lease_mgr.reset(new NakedMemfileLeaseMgr(pmap)));
+    EXPECT_TRUE(BinaryLeaseFile::hasBinaryHeader(pmap["name"]));
+
+    DuidPtr duid(new DUID(DUID::fromText("01:02:03:04:05:06:07:08")));
+    Lease6Ptr lease(new Lease6(Lease::TYPE_NA, IOAddress("2001:db8:1::1"),
+                               duid, 7, 150, 300, 0, 0, 8));
+    ASSERT_TRUE(lease_mgr->addLease(lease));
+    lease.reset(new Lease6(Lease::TYPE_PD, IOAddress("3000:1::"), duid,
+                           8, 150, 300, 0, 0, 8, HWAddrPtr(), 64));
+    ASSERT_TRUE(lease_mgr->addLease(lease));
+
+    ASSERT_NO_THROW(lease_mgr.reset(new NakedMemfileLeaseMgr(pmap)));
+    EXPECT_TRUE(lease_mgr->getLease6(Lease::TYPE_NA,
+                                     IOAddress("2001:db8:1::1")));
+    lease = lease_mgr->getLease6(Lease::TYPE_PD, IOAddress("3000:1::"));
+    ASSERT_TRUE(lease);
+    EXPECT_EQ(64, lease->prefixlen_);
+}
+
+// This test checks that the backend refuses the unsupported lease file
+// format.
+TEST_F(MemfileLeaseMgrTest, invalidLeaseFileFormat) {
+    DatabaseConnection::ParameterMap pmap;
+    pmap["type"] = "memfile";
+    pmap["universe"] = "4";
+    pmap["name"] = getLeaseFilePath("leasefile4_0.csv");
+    pmap["lease-file-format"] = "xml";
+    boost::scoped_ptr<NakedMemfileLeaseMgr> lease_mgr;
+    EXPECT_THROW(lease_mgr.reset(new NakedMemfileLeaseMgr(pmap)), BadValue);
+}
+
+// This test checks that the lease updates are held in the buffer until
+// the batch is complete or the pending updates are flushed when the
+// group commit is enabled.
+TEST_F(MemfileLeaseMgrTest, groupCommit) {
+    DatabaseConnection::ParameterMap pmap;
+    pmap["type"] = "memfile";
+    pmap["universe"] = "4";
+    pmap["name"] = getLeaseFilePath("leasefile4_0.csv");
+    pmap["persist-mode"] = "group";
+    pmap["commit-batch-size"] = "2";
+    boost::scoped_ptr<NakedMemfileLeaseMgr> lease_mgr;
+    ASSERT_NO_THROW(lease_mgr.reset(new NakedMemfileLeaseMgr(pmap)));
+
+    StatsMgr::instance().removeAll();
+    LeaseFileIO io(getLeaseFilePath("leasefile4_0.csv"), false);
+    const std::string header = io.readFile();
+
+    // The first update is buffered.
+    HWAddrPtr hwaddr(new HWAddr(HWAddr::fromText("0c:0c:0c:0c:0c:0c")));
+    Lease4Ptr lease(new Lease4(IOAddress("192.0.2.1"), hwaddr, NULL, 0,
+                               300, 100, 200, 1000, 8));
+    ASSERT_TRUE(lease_mgr->addLease(lease));
+    EXPECT_EQ(header, io.readFile());
+
+    // Flushing the pending updates writes them to the file.
+    ASSERT_NO_THROW(lease_mgr->flushPending());
+    EXPECT_NE(std::string::npos, io.readFile().find("192.0.2.1"));
+    ObservationPtr commits = StatsMgr::instance().getObservation("lease-commits");
+    ASSERT_TRUE(commits);
+    EXPECT_EQ(1, commits->getInteger().first);
+
+    // The second update of the batch commits the whole batch.
+    lease.reset(new Lease4(IOAddress("192.0.2.2"), hwaddr, NULL, 0,
+                           300, 100, 200, 1000, 8));
+    ASSERT_TRUE(lease_mgr->addLease(lease));
+    EXPECT_EQ(std::string::npos, io.readFile().find("192.0.2.2"));
+    lease.reset(new Lease4(IOAddress("192.0.2.3"), hwaddr, NULL, 0,
+                           300, 100, 200, 1000, 8));
+    ASSERT_TRUE(lease_mgr->addLease(lease));
+    EXPECT_NE(std::string::npos, io.readFile().find("192.0.2.3"));
+    EXPECT_EQ(2, commits->getInteger().first);
+    ObservationPtr batch =
+        StatsMgr::instance().getObservation("lease-commit-batch-size");
+    ASSERT_TRUE(batch);
+    EXPECT_EQ(2, batch->getInteger().first);
+
+    // The pending updates are committed when the backend is destroyed.
+    lease.reset(new Lease4(IOAddress("192.0.2.4"), hwaddr, NULL, 0,
+                           300, 100, 200, 1000, 8));
+    ASSERT_TRUE(lease_mgr->addLease(lease));
+    lease_mgr.reset();
+    EXPECT_NE(std::string::npos, io.readFile().find("192.0.2.4"));
+    StatsMgr::instance().removeAll();
+}
+
+// This test checks that the pending lease updates are stored when the
+// commit interval elapses in the single-threaded mode.
+TEST_F(MemfileLeaseMgrTest, groupCommitInterval) {
+    DatabaseConnection::ParameterMap pmap;
+    pmap["type"] = "memfile";
+    pmap["universe"] = "6";
+    pmap["name"] = getLeaseFilePath("leasefile6_0.csv");
+    pmap["persist-mode"] = "group";
+    pmap["commit-interval"] = "100";
+    boost::scoped_ptr<NakedMemfileLeaseMgr> lease_mgr;
+    ASSERT_NO_THROW(lease_mgr.reset(new NakedMemfileLeaseMgr(pmap)));
+
+    StatsMgr::instance().removeAll();
+    LeaseFileIO io(getLeaseFilePath("leasefile6_0.csv"), false);
+
+    // Nothing is pending.
+    uint32_t timeout = 1;
+    ASSERT_NO_THROW(timeout = lease_mgr->flushDuePending());
+    EXPECT_EQ(0, timeout);
+    EXPECT_FALSE(lease_mgr->hasPending());
+
+    // The update is not due before the commit interval elapses.
+    DuidPtr duid(new DUID(DUID::fromText("01:02:03:04:05:06:07:08")));
+    Lease6Ptr lease(new Lease6(Lease::TYPE_NA, IOAddress("2001:db8:1::1"),
+                               duid, 7, 150, 300, 0, 0, 8));
+    ASSERT_TRUE(lease_mgr->addLease(lease));
+    ASSERT_NO_THROW(timeout = lease_mgr->flushDuePending());
+    EXPECT_GT(timeout, 0);
+    EXPECT_LE(timeout, 100);
+    EXPECT_TRUE(lease_mgr->hasPending());
+    EXPECT_EQ(std::string::npos, io.readFile().find("2001:db8:1::1"));
+
+    // The next update joins the group, so it is due at the same time.
+    lease.reset(new Lease6(Lease::TYPE_NA, IOAddress("2001:db8:1::2"),
+                           duid, 7, 150, 300, 0, 0, 8));
+    ASSERT_TRUE(lease_mgr->addLease(lease));
+    usleep((timeout + 10) * 1000);
+    ASSERT_NO_THROW(timeout = lease_mgr->flushDuePending());
+    EXPECT_EQ(0, timeout);
+    EXPECT_FALSE(lease_mgr->hasPending());
+    std::string contents = io.readFile();
+    EXPECT_NE(std::string::npos, contents.find("2001:db8:1::1"));
+    EXPECT_NE(std::string::npos, contents.find("2001:db8:1::2"));
+
+    ObservationPtr commits = StatsMgr::instance().getObservation("lease-commits");
+    ASSERT_TRUE(commits);
+    EXPECT_EQ(1, commits->getInteger().first);
+    ObservationPtr batch =
+        StatsMgr::instance().getObservation("lease-commit-batch-size");
+    ASSERT_TRUE(batch);
+    EXPECT_EQ(2, batch->getInteger().first);
+    StatsMgr::instance().removeAll();
+}
+
+// This test checks that each lease update is written and synced to the
+// disk when the sync persist mode is used.
+TEST_F(MemfileLeaseMgrTest, syncCommit) {
+    DatabaseConnection::ParameterMap pmap;
+    pmap["type"] = "memfile";
+    pmap["universe"] = "6";
+    pmap["name"] = getLeaseFilePath("leasefile6_0.csv");
+    pmap["persist-mode"] = "sync";
+    boost::scoped_ptr<NakedMemfileLeaseMgr> lease_mgr;
+    ASSERT_NO_THROW(lease_mgr.reset(new NakedMemfileLeaseMgr(pmap)));
+
+    StatsMgr::instance().removeAll();
+    LeaseFileIO io(getLeaseFilePath("leasefile6_0.csv"), false);
+    DuidPtr duid(new DUID(DUID::fromText("01:02:03:04:05:06:07:08")));
+    Lease6Ptr lease(new Lease6(Lease::TYPE_NA, IOAddress("2001:db8:1::1"),
+                               duid, 7, 150, 300, 0, 0, 8));
+    ASSERT_TRUE(lease_mgr->addLease(lease));
+    EXPECT_NE(std::string::npos, io.readFile().find("2001:db8:1::1"));
+
+    ObservationPtr commits = StatsMgr::instance().getObservation("lease-commits");
+    ASSERT_TRUE(commits);
+    EXPECT_EQ(1, commits->getInteger().first);
+    StatsMgr::instance().removeAll();
+}
+
+// This test checks that the backend refuses the invalid persist mode and
+// the commit batch size of 0.
+TEST_F(MemfileLeaseMgrTest, invalidPersistMode) {
+    DatabaseConnection::ParameterMap pmap;
+    pmap["type"] = "memfile";
+    pmap["universe"] = "4";
+    pmap["name"] = getLeaseFilePath("leasefile4_0.csv");
+    pmap["persist-mode"] = "never";
+    boost::scoped_ptr<NakedMemfileLeaseMgr> lease_mgr;
+    EXPECT_THROW(lease_mgr.reset(new NakedMemfileLeaseMgr(pmap)), BadValue);
+
+    pmap["persist-mode"] = "group";
+    pmap["commit-batch-size"] = "0";
+    EXPECT_THROW(lease_mgr.reset(new NakedMemfileLeaseMgr(pmap)), BadValue);
+}
+
 // This test checks that the backend reads DHCPv6 lease data from multiple
 // files.
 TEST_F(MemfileLeaseMgrTest, load6MultipleLeaseFiles) {
@@ -1906,4 +2324,89 @@ TEST_F(MemfileLeaseMgrTest, wipeLeases6) {
     testWipeLeases6();
 }
 
+// Tests that several leases can be added, updated and deleted at once.
+TEST_F(MemfileLeaseMgrTest, bulkLeases4) {
+    startBackend(V4);
+    testBulkLeases4();
+}
+
+// Tests that several leases can be added, updated and deleted at once.
+TEST_F(MemfileLeaseMgrTest, bulkLeases6) {
+    startBackend(V6);
+    testBulkLeases6();
+}
+
+// This is a performance benchmark comparing the throughput of the bulk
+// and single lease operations.
+TEST_F(MemfileLeaseMgrTest, DISABLED_performanceBulkLeases4) {
+    startBackend(V4);
+    testBulkLeases4Performance(1000);
+}
+
+// This is a performance benchmark measuring the getLease4 lookups by
+// address, HW address and client identifier for 10^3 to 10^6 leases.
+// The results depend on the storage layout selected with
+// --enable-memfile-hashed-indexes.
+TEST_F(MemfileLeaseMgrTest, DISABLED_performanceGetLease4) {
+    const uint32_t lookups = 100000;
+    for (uint32_t leases = 1000; leases <= 1000000; leases *= 10) {
+        DatabaseConnection::ParameterMap pmap;
+        pmap["universe"] = "4";
+        pmap["persist"] = "false";
+        boost::scoped_ptr<Memfile_LeaseMgr> lease_mgr(new Memfile_LeaseMgr(pmap));
+
+        // The leases belong to 10 subnets and each client uses a distinct
+        // HW address and client identifier.
+        std::vector<uint8_t> id(6, 0);
+        for (uint32_t i = 0; i < leases; ++i) {
+            id[2] = (i >> 24) & 0xFF;
+            id[3] = (i >> 16) & 0xFF;
+            id[4] = (i >> 8) & 0xFF;
+            id[5] = i & 0xFF;
+            HWAddrPtr hwaddr(new HWAddr(id, HTYPE_ETHER));
+            Lease4Ptr lease(new Lease4(IOAddress(0x0A000000 + i), hwaddr,
+                                       &id[0], id.size(), 3600, 1800, 2700,
+                                       time(NULL), i % 10 + 1));
+            ASSERT_TRUE(lease_mgr->addLease(lease));
+        }
+
+        // Look up the leases in an order unrelated to the order in which
+        // they were added.
+        ptime before = microsec_clock::local_time();
+        for (uint32_t i = 0; i < lookups; ++i) {
+            const uint32_t index = (i * 7919) % leases;
+            ASSERT_TRUE(lease_mgr->getLease4(IOAddress(0x0A000000 + index)));
+        }
+        time_duration addr_dur = microsec_clock::local_time() - before;
+
+        before = microsec_clock::local_time();
+        for (uint32_t i = 0; i < lookups; ++i) {
+            const uint32_t index = (i * 7919) % leases;
+            id[2] = (index >> 24) & 0xFF;
+            id[3] = (index >> 16) & 0xFF;
+            id[4] = (index >> 8) & 0xFF;
+            id[5] = index & 0xFF;
+            ASSERT_EQ(1, lease_mgr->getLease4(HWAddr(id, HTYPE_ETHER)).size());
+        }
+        time_duration hwaddr_dur = microsec_clock::local_time() - before;
+
+        before = microsec_clock::local_time();
+        for (uint32_t i = 0; i < lookups; ++i) {
+            const uint32_t index = (i * 7919) % leases;
+            id[2] = (index >> 24) & 0xFF;
+            id[3] = (index >> 16) & 0xFF;
+            id[4] = (index >> 8) & 0xFF;
+            id[5] = index & 0xFF;
+            ASSERT_TRUE(lease_mgr->getLease4(ClientId(id), index % 10 + 1));
+        }
+        time_duration clientid_dur = microsec_clock::local_time() - before;
+
+        std::cout << lookups << " lookups among " << leases
+                  << " leases took: " << durationToText(addr_dur)
+                  << " (address), " << durationToText(hwaddr_dur)
+                  << " (HW address), " << durationToText(clientid_dur)
+                  << " (client id and subnet id)" << std::endl;
+    }
+}
+
 }; // end of anonymous namespace
@@ -313,6 +313,12 @@ TEST_F(MySqlHostDataSourceTest, get4ByClientId) {
     testGet4ByIdentifier(Host::IDENT_CLIENT_ID);
 }
 
+// Test verifies if host reservations can be retrieved by any of the
+// identifiers in the order of their priority.
+TEST_F(MySqlHostDataSourceTest, getByIdentifiers) {
+    testGetByIdentifiers();
+}
+
 // Test verifies if hardware address and client identifier are not confused.
 TEST_F(MySqlHostDataSourceTest, hwaddrNotClientId1) {
     testHWAddrNotClientId();
@@ -14,6 +14,7 @@
 #include <dhcpsrv/tests/generic_lease_mgr_unittest.h>
 #include <dhcpsrv/testutils/mysql_schema.h>
 #include <exceptions/exceptions.h>
+#include <stats/stats_mgr.h>
 
 #include <gtest/gtest.h>
 
@@ -27,6 +28,7 @@ using namespace isc;
 using namespace isc::asiolink;
 using namespace isc::dhcp;
 using namespace isc::dhcp::test;
+using namespace isc::stats;
 using namespace std;
 
 namespace {
@@ -488,13 +490,78 @@ TEST_F(MySqlLeaseMgrTest, recountLeaseStats6) {
 }
 
 // Tests that leases from specific subnet can be removed.
-TEST_F(MySqlLeaseMgrTest, DISABLED_wipeLeases4) {
+TEST_F(MySqlLeaseMgrTest, wipeLeases4) {
     testWipeLeases4();
 }
 
 // Tests that leases from specific subnet can be removed.
-TEST_F(MySqlLeaseMgrTest, DISABLED_wipeLeases6) {
+TEST_F(MySqlLeaseMgrTest, wipeLeases6) {
     testWipeLeases6();
 }
 
+// Tests that several leases can be added, updated and deleted at once.
+TEST_F(MySqlLeaseMgrTest, bulkLeases4) {
+    testBulkLeases4();
+}
+
+// Tests that several leases can be added, updated and deleted at once.
+TEST_F(MySqlLeaseMgrTest, bulkLeases6) {
+    testBulkLeases6();
+}
+
+// Tests that the lease manager uses several connections at once. Each
+// lease statistics query holds a connection until it is destroyed.
+TEST_F(MySqlLeaseMgrTest, severalContexts) {
+    vector<Lease4Ptr> leases = createLeases4();
+    for (size_t i = 0; i < leases.size(); ++i) {
+        ASSERT_TRUE(lmptr_->addLease(leases[i]));
+    }
+
+    vector<LeaseStatsQueryPtr> queries;
+    for (int i = 0; i < 3; ++i) {
+        LeaseStatsQueryPtr query;
+        ASSERT_NO_THROW(query = lmptr_->startLeaseStatsQuery4());
+        ASSERT_TRUE(query);
+        queries.push_back(query);
+    }
+
+    // The lease manager runs other queries while the connections of the
+    // statistics queries are busy.
+    for (size_t i = 0; i < leases.size(); ++i) {
+        Lease4Ptr l_returned = lmptr_->getLease4(ioaddress4_[i]);
+        ASSERT_TRUE(l_returned);
+        detailCompareLease(leases[i], l_returned);
+    }
+
+    // The statistics queries return the same rows.
+    vector<LeaseStatsRow> rows;
+    LeaseStatsRow row;
+    while (queries[0]->getNextRow(row)) {
+        rows.push_back(row);
+    }
+    EXPECT_FALSE(rows.empty());
+    for (size_t q = 1; q < queries.size(); ++q) {
+        for (size_t i = 0; i < rows.size(); ++i) {
+            ASSERT_TRUE(queries[q]->getNextRow(row));
+            EXPECT_EQ(rows[i].subnet_id_, row.subnet_id_);
+            EXPECT_EQ(rows[i].lease_state_, row.lease_state_);
+            EXPECT_EQ(rows[i].state_count_, row.state_count_);
+        }
+        EXPECT_FALSE(queries[q]->getNextRow(row));
+    }
+
+    // A connection has been opened for each statistics query and one for
+    // the other queries.
+    ObservationPtr pool_size =
+        StatsMgr::instance().getObservation("lease-database-pool-size");
+    ASSERT_TRUE(pool_size);
+    EXPECT_EQ(queries.size() + 1, pool_size->getInteger().first);
+}
+
+// This is a performance benchmark comparing the throughput of the bulk
+// and single lease operations.
+TEST_F(MySqlLeaseMgrTest, DISABLED_performanceBulkLeases4) {
+    testBulkLeases4Performance(1000);
+}
+
 }; // Of anonymous namespace
@@ -269,6 +269,12 @@ TEST_F(PgSqlHostDataSourceTest, get4ByClientId) {
     testGet4ByIdentifier(Host::IDENT_CLIENT_ID);
 }
 
+// Test verifies if host reservations can be retrieved by any of the
+// identifiers in the order of their priority.
+TEST_F(PgSqlHostDataSourceTest, getByIdentifiers) {
+    testGetByIdentifiers();
+}
+
 // Test verifies if hardware address and client identifier are not confused.
 TEST_F(PgSqlHostDataSourceTest, hwaddrNotClientId1) {
     testHWAddrNotClientId();
@@ -413,13 +413,29 @@ TEST_F(PgSqlLeaseMgrTest, recountLeaseStats6) {
 }
 
 // Tests that leases from specific subnet can be removed.
-TEST_F(PgSqlLeaseMgrTest, DISABLED_wipeLeases4) {
+TEST_F(PgSqlLeaseMgrTest, wipeLeases4) {
     testWipeLeases4();
 }
 
 // Tests that leases from specific subnet can be removed.
-TEST_F(PgSqlLeaseMgrTest, DISABLED_wipeLeases6) {
+TEST_F(PgSqlLeaseMgrTest, wipeLeases6) {
     testWipeLeases6();
 }
 
+// Tests that several leases can be added, updated and deleted at once.
+TEST_F(PgSqlLeaseMgrTest, bulkLeases4) {
+    testBulkLeases4();
+}
+
+// Tests that several leases can be added, updated and deleted at once.
+TEST_F(PgSqlLeaseMgrTest, bulkLeases6) {
+    testBulkLeases6();
+}
+
+// This is a performance benchmark comparing the throughput of the bulk
+// and single lease operations.
+TEST_F(PgSqlLeaseMgrTest, DISABLED_performanceBulkLeases4) {
+    testBulkLeases4Performance(1000);
+}
+
 }; // namespace
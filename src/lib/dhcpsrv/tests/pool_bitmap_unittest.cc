@@ -0,0 +1,110 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <dhcpsrv/pool_bitmap.h>
+
+#include <gtest/gtest.h>
+
+using namespace isc;
+using namespace isc::dhcp;
+
+namespace {
+
+// This test verifies that the newly created bitmap has all bits cleared.
+TEST(PoolBitmapTest, constructor) {
+    PoolBitmap bitmap(100);
+    EXPECT_EQ(100, bitmap.getSize());
+    EXPECT_EQ(0, bitmap.getUsedCount());
+    for (uint64_t i = 0; i < 100; ++i) {
+        EXPECT_FALSE(bitmap.isUsed(i)) << "bit " << i;
+    }
+    // Out of range offsets are reported as used.
+    EXPECT_TRUE(bitmap.isUsed(100));
+}
+
+// This test verifies that the bits can be set and cleared and that the
+// number of used addresses is tracked.
+TEST(PoolBitmapTest, setUsed) {
+    PoolBitmap bitmap(130);
+    bitmap.setUsed(0);
+    bitmap.setUsed(63);
+    bitmap.setUsed(64);
+    bitmap.setUsed(129);
+    EXPECT_EQ(4, bitmap.getUsedCount());
+    EXPECT_TRUE(bitmap.isUsed(0));
+    EXPECT_TRUE(bitmap.isUsed(63));
+    EXPECT_TRUE(bitmap.isUsed(64));
+    EXPECT_TRUE(bitmap.isUsed(129));
+    EXPECT_FALSE(bitmap.isUsed(1));
+    EXPECT_FALSE(bitmap.isUsed(128));
+
+    // Setting the bit twice must not affect the counter.
+    bitmap.setUsed(63);
+    EXPECT_EQ(4, bitmap.getUsedCount());
+
+    bitmap.setUsed(63, false);
+    EXPECT_FALSE(bitmap.isUsed(63));
+    EXPECT_EQ(3, bitmap.getUsedCount());
+
+    // Clearing the bit twice must not affect the counter.
+    bitmap.setUsed(63, false);
+    EXPECT_EQ(3, bitmap.getUsedCount());
+
+    // Out of range offset is ignored.
+    bitmap.setUsed(130);
+    EXPECT_EQ(3, bitmap.getUsedCount());
+}
+
+// This test verifies that free addresses are found across the word
+// boundaries.
+TEST(PoolBitmapTest, findFree) {
+    PoolBitmap bitmap(200);
+    for (uint64_t i = 0; i < 150; ++i) {
+        bitmap.setUsed(i);
+    }
+
+    uint64_t offset = 0;
+    ASSERT_TRUE(bitmap.findFree(0, offset));
+    EXPECT_EQ(150, offset);
+
+    ASSERT_TRUE(bitmap.findFree(170, offset));
+    EXPECT_EQ(170, offset);
+
+    // Free an address in the first word and make sure it is found when
+    // the search starts below it but not when it starts above it.
+    bitmap.setUsed(10, false);
+    ASSERT_TRUE(bitmap.findFree(5, offset));
+    EXPECT_EQ(10, offset);
+    ASSERT_TRUE(bitmap.findFree(11, offset));
+    EXPECT_EQ(150, offset);
+
+    // The start offset beyond the end of the bitmap.
+    EXPECT_FALSE(bitmap.findFree(200, offset));
+}
+
+// This test verifies that the unused bits of the last word are never
+// returned as free.
+TEST(PoolBitmapTest, findFreeFull) {
+    PoolBitmap bitmap(70);
+    for (uint64_t i = 0; i < 69; ++i) {
+        bitmap.setUsed(i);
+    }
+    uint64_t offset = 0;
+    ASSERT_TRUE(bitmap.findFree(0, offset));
+    EXPECT_EQ(69, offset);
+
+    bitmap.setUsed(69);
+    EXPECT_FALSE(bitmap.findFree(0, offset));
+    EXPECT_FALSE(bitmap.findFree(65, offset));
+
+    // Make one address free and search past it.
+    bitmap.setUsed(3, false);
+    EXPECT_FALSE(bitmap.findFree(4, offset));
+}
+
+} // end of anonymous namespace
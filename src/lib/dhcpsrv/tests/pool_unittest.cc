@@ -78,6 +78,44 @@ TEST(Pool4Test, in_range) {
    EXPECT_FALSE(pool1.inRange(IOAddress("0.0.0.0")));
 }
 
+// This test verifies that the usage bitmap can be used to find free
+// addresses in the pool.
+TEST(Pool4Test, usageBitmap) {
+    Pool4 pool(IOAddress("192.0.2.10"), IOAddress("192.0.2.20"));
+    IOAddress addr("0.0.0.0");
+
+    // No bitmap, so the free address can't be found.
+    EXPECT_FALSE(pool.findFreeAddress(IOAddress("192.0.2.10"), addr));
+    EXPECT_NO_THROW(pool.markAddressUsed(IOAddress("192.0.2.10"), true));
+
+    // The bitmap size must match the pool capacity.
+    EXPECT_THROW(pool.setUsageBitmap(PoolBitmapPtr(new PoolBitmap(10))),
+                 BadValue);
+    ASSERT_NO_THROW(pool.setUsageBitmap(PoolBitmapPtr(new PoolBitmap(11))));
+    ASSERT_TRUE(pool.getUsageBitmap());
+
+    pool.markAddressUsed(IOAddress("192.0.2.10"), true);
+    pool.markAddressUsed(IOAddress("192.0.2.11"), true);
+    // Addresses out of the pool are ignored.
+    pool.markAddressUsed(IOAddress("192.0.2.21"), true);
+    EXPECT_EQ(2, pool.getUsageBitmap()->getUsedCount());
+
+    // The search begins at the first address if the start address doesn't
+    // belong to the pool.
+    ASSERT_TRUE(pool.findFreeAddress(IOAddress("10.0.0.1"), addr));
+    EXPECT_EQ("192.0.2.12", addr.toText());
+
+    ASSERT_TRUE(pool.findFreeAddress(IOAddress("192.0.2.15"), addr));
+    EXPECT_EQ("192.0.2.15", addr.toText());
+
+    pool.markAddressUsed(IOAddress("192.0.2.20"), true);
+    EXPECT_FALSE(pool.findFreeAddress(IOAddress("192.0.2.20"), addr));
+
+    pool.markAddressUsed(IOAddress("192.0.2.11"), false);
+    ASSERT_TRUE(pool.findFreeAddress(IOAddress("192.0.2.10"), addr));
+    EXPECT_EQ("192.0.2.11", addr.toText());
+}
+
 // Checks if the number of possible leases in range is reported correctly.
 TEST(Pool4Test, leasesCount) {
     Pool4 pool1(IOAddress("192.0.2.10"), IOAddress("192.0.2.20"));
@@ -0,0 +1,87 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+#include <asiolink/io_address.h>
+#include <dhcpsrv/subnet_prefix_index.h>
+#include <exceptions/exceptions.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace isc;
+using namespace isc::asiolink;
+using namespace isc::dhcp;
+
+namespace {
+
+// This test verifies that all IPv4 prefixes including an address are
+// returned in the order of positions.
+TEST(SubnetPrefixIndexTest, find4) {
+    SubnetPrefixIndex index;
+    EXPECT_TRUE(index.empty());
+
+    index.add(IOAddress("10.1.0.0"), 16, 0);
+    // The prefix doesn't need to be the first address.
+    index.add(IOAddress("10.1.2.5"), 24, 1);
+    index.add(IOAddress("10.0.0.0"), 8, 2);
+    index.add(IOAddress("0.0.0.0"), 0, 3);
+    index.add(IOAddress("192.0.2.0"), 24, 4);
+    EXPECT_FALSE(index.empty());
+
+    std::vector<size_t> positions;
+    index.find(IOAddress("10.1.2.3"), positions);
+    ASSERT_EQ(4, positions.size());
+    EXPECT_EQ(0, positions[0]);
+    EXPECT_EQ(1, positions[1]);
+    EXPECT_EQ(2, positions[2]);
+    EXPECT_EQ(3, positions[3]);
+
+    index.find(IOAddress("192.0.2.255"), positions);
+    ASSERT_EQ(2, positions.size());
+    EXPECT_EQ(3, positions[0]);
+    EXPECT_EQ(4, positions[1]);
+
+    // An IPv6 address doesn't match IPv4 prefixes.
+    index.find(IOAddress("2001:db8::1"), positions);
+    EXPECT_TRUE(positions.empty());
+
+    index.clear();
+    EXPECT_TRUE(index.empty());
+    index.find(IOAddress("10.1.2.3"), positions);
+    EXPECT_TRUE(positions.empty());
+}
+
+// This test verifies that IPv6 prefixes are indexed and that the same
+// prefix may be used by multiple subnets.
+TEST(SubnetPrefixIndexTest, find6) {
+    SubnetPrefixIndex index;
+    index.add(IOAddress("2001:db8:1::"), 48, 2);
+    index.add(IOAddress("2001:db8:1::"), 48, 0);
+    index.add(IOAddress("2001:db8::"), 32, 1);
+    index.add(IOAddress("2001:db8:1::1"), 128, 3);
+
+    std::vector<size_t> positions;
+    index.find(IOAddress("2001:db8:1::1"), positions);
+    ASSERT_EQ(4, positions.size());
+    EXPECT_EQ(0, positions[0]);
+    EXPECT_EQ(1, positions[1]);
+    EXPECT_EQ(2, positions[2]);
+    EXPECT_EQ(3, positions[3]);
+
+    index.find(IOAddress("2001:db8:2::1"), positions);
+    ASSERT_EQ(1, positions.size());
+    EXPECT_EQ(1, positions[0]);
+
+    // An IPv4 address doesn't match IPv6 prefixes.
+    index.find(IOAddress("10.0.0.1"), positions);
+    EXPECT_TRUE(positions.empty());
+
+    // The prefix length is validated.
+    EXPECT_THROW(index.add(IOAddress("2001:db8::"), 129, 4), BadValue);
+    EXPECT_THROW(index.add(IOAddress("10.0.0.0"), 33, 4), BadValue);
+}
+
+} // end of anonymous namespace
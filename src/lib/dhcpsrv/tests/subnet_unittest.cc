@@ -126,6 +126,33 @@ TEST(Subnet4Test, matchClientId) {
     EXPECT_TRUE(subnet.getMatchClientId());
 }
 
+// Checks that the allocator can be set for the subnet and that it is
+// unparsed only when set.
+TEST(Subnet4Test, allocatorType) {
+    Subnet4 subnet(IOAddress("192.0.2.1"), 24, 1000, 2000, 3000);
+
+    // By default the engine's allocator is used.
+    EXPECT_TRUE(subnet.getAllocatorType().empty());
+    EXPECT_FALSE(subnet.toElement()->contains("allocator"));
+
+    EXPECT_NO_THROW(subnet.setAllocatorType("random"));
+    EXPECT_EQ("random", subnet.getAllocatorType());
+    ASSERT_TRUE(subnet.toElement()->contains("allocator"));
+    EXPECT_EQ("random", subnet.toElement()->get("allocator")->stringValue());
+
+    EXPECT_NO_THROW(subnet.setAllocatorType("hashed"));
+    EXPECT_EQ("hashed", subnet.getAllocatorType());
+    EXPECT_NO_THROW(subnet.setAllocatorType("iterative"));
+    EXPECT_EQ("iterative", subnet.getAllocatorType());
+
+    // Unsupported allocator is rejected and the previous value is kept.
+    EXPECT_THROW(subnet.setAllocatorType("sequential"), BadValue);
+    EXPECT_EQ("iterative", subnet.getAllocatorType());
+
+    EXPECT_NO_THROW(subnet.setAllocatorType(""));
+    EXPECT_TRUE(subnet.getAllocatorType().empty());
+}
+
 // Checks that it is possible to add and retrieve multiple pools.
 TEST(Subnet4Test, pool4InSubnet4) {
 
@@ -416,6 +443,45 @@ TEST(Subnet4Test, inRangeinPool) {
     EXPECT_FALSE(subnet->inPool(Lease::TYPE_V4, IOAddress("192.3.0.0")));
 }
 
+// This test checks that the pools added in any order are kept sorted and
+// that the pool an address belongs to is found among many pools.
+TEST(Subnet4Test, findPool) {
+    Subnet4Ptr subnet(new Subnet4(IOAddress("10.0.0.0"), 8, 1, 2, 3));
+    const PoolCollection& pools = subnet->getPools(Lease::TYPE_V4);
+
+    EXPECT_TRUE(subnet->findPool(Lease::TYPE_V4, IOAddress("10.0.0.1")) ==
+                pools.end());
+
+    // Add 200 fragmented pools of 16 addresses in a scrambled order.
+    // Each pool is followed by a gap of 16 addresses.
+    for (uint32_t i = 0; i < 200; ++i) {
+        uint32_t first = 0x0a000000 + ((i * 77) % 200) * 32;
+        Pool4Ptr pool(new Pool4(IOAddress(first), IOAddress(first + 15)));
+        ASSERT_NO_THROW(subnet->addPool(pool));
+    }
+    ASSERT_EQ(200, pools.size());
+    for (size_t i = 1; i < pools.size(); ++i) {
+        EXPECT_TRUE(pools[i - 1]->getLastAddress() < pools[i]->getFirstAddress());
+    }
+
+    for (uint32_t i = 0; i < 200; ++i) {
+        uint32_t first = 0x0a000000 + i * 32;
+        PoolCollection::const_iterator pool =
+            subnet->findPool(Lease::TYPE_V4, IOAddress(first + 7));
+        ASSERT_TRUE(pool != pools.end());
+        EXPECT_EQ(i, pool - pools.begin());
+        EXPECT_EQ(*pool, subnet->getPool(Lease::TYPE_V4, IOAddress(first + 15),
+                                         false));
+        EXPECT_TRUE(subnet->inPool(Lease::TYPE_V4, IOAddress(first)));
+        // The gap between the pools doesn't belong to any pool.
+        EXPECT_TRUE(subnet->findPool(Lease::TYPE_V4, IOAddress(first + 16)) ==
+                    pools.end());
+        EXPECT_FALSE(subnet->getPool(Lease::TYPE_V4, IOAddress(first + 31),
+                                     false));
+        EXPECT_FALSE(subnet->inPool(Lease::TYPE_V4, IOAddress(first + 16)));
+    }
+}
+
 // This test checks if the toText() method returns text representation
 TEST(Subnet4Test, toText) {
     Subnet4Ptr subnet(new Subnet4(IOAddress("192.0.2.0"), 24, 1, 2, 3));
@@ -0,0 +1,396 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <eval/compiled_expression.h>
+#include <eval/eval_log.h>
+#include <eval/evaluate.h>
+#include <dhcp/dhcp4.h>
+#include <dhcp/pkt4.h>
+#include <boost/lexical_cast.hpp>
+#include <cstring>
+#include <stack>
+#include <vector>
+
+using namespace isc::dhcp;
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Node of the compiled expression tree.
+struct CompiledExpression::Node {
+
+    /// @brief Type of the node.
+    enum Type {
+        CONSTANT,     ///< constant value (literal or folded sub-expression)
+        LEAF,         ///< token extracting a value from the packet
+        OPERATOR,     ///< other operator evaluated by its token
+        EQUAL,        ///< == operator
+        NOT,          ///< not operator
+        AND,          ///< and operator
+        OR,           ///< or operator
+        IFELSE,       ///< ifelse operator
+        OPTION_MATCH  ///< option content (or substring) == constant
+    };
+
+    /// @brief Constructor.
+    ///
+    /// @param type type of the node.
+    /// @param token token evaluated by the node.
+    Node(const Type type, const TokenPtr& token)
+        : type_(type), token_(token), children_(), value_(), option_(),
+          substring_(false), start_(0), length_(0), length_all_(false) {
+    }
+
+    /// @brief Type of the node.
+    Type type_;
+
+    /// @brief Token evaluated by the node.
+    TokenPtr token_;
+
+    /// @brief Operands in the order they were pushed on the stack.
+    std::vector<NodePtr> children_;
+
+    /// @brief Value of the constant or the compared value of the option
+    /// match.
+    std::string value_;
+
+    /// @brief Option token of the option match.
+    boost::shared_ptr<TokenOption> option_;
+
+    /// @brief Indicates if the option match compares a substring.
+    bool substring_;
+
+    /// @brief Starting position of the substring.
+    int start_;
+
+    /// @brief Length of the substring.
+    int length_;
+
+    /// @brief Indicates if the substring extends to the end of the data.
+    bool length_all_;
+};
+
+}
+}
+
+namespace {
+
+typedef CompiledExpression::Node Node;
+typedef CompiledExpression::NodePtr NodePtr;
+
+/// @brief Returns the number of operands of the token.
+///
+/// @param token token.
+/// @param [out] type type of the node evaluating the token.
+/// @return number of values the token pops from the stack.
+size_t
+getOperands(const TokenPtr& token, Node::Type& type) {
+    const Token* raw = token.get();
+    if (dynamic_cast<const TokenString*>(raw) ||
+        dynamic_cast<const TokenHexString*>(raw) ||
+        dynamic_cast<const TokenIpAddress*>(raw)) {
+        type = Node::CONSTANT;
+        return (0);
+    } else if (dynamic_cast<const TokenEqual*>(raw)) {
+        type = Node::EQUAL;
+        return (2);
+    } else if (dynamic_cast<const TokenNot*>(raw)) {
+        type = Node::NOT;
+        return (1);
+    } else if (dynamic_cast<const TokenAnd*>(raw)) {
+        type = Node::AND;
+        return (2);
+    } else if (dynamic_cast<const TokenOr*>(raw)) {
+        type = Node::OR;
+        return (2);
+    } else if (dynamic_cast<const TokenIfElse*>(raw)) {
+        type = Node::IFELSE;
+        return (3);
+    } else if (dynamic_cast<const TokenSubstring*>(raw)) {
+        type = Node::OPERATOR;
+        return (3);
+    } else if (dynamic_cast<const TokenConcat*>(raw)) {
+        type = Node::OPERATOR;
+        return (2);
+    }
+    type = Node::LEAF;
+    return (0);
+}
+
+/// @brief Returns the option token pushing the option content in the
+/// hexadecimal representation.
+///
+/// @param node node to be checked.
+/// @return pointer to the token or null if the node is not such a token.
+boost::shared_ptr<TokenOption>
+getHexOption(const NodePtr& node) {
+    boost::shared_ptr<TokenOption> option;
+    if (node->type_ == Node::LEAF) {
+        option = boost::dynamic_pointer_cast<TokenOption>(node->token_);
+        // The vendor tokens push other values than the option content.
+        if (option &&
+            ((option->getRepresentation() != TokenOption::HEXADECIMAL) ||
+             boost::dynamic_pointer_cast<TokenVendor>(option))) {
+            option.reset();
+        }
+    }
+    return (option);
+}
+
+/// @brief Tries to convert the equality node into an option match.
+///
+/// @param node equality node with one constant operand.
+/// @param constant constant operand.
+/// @param other the other operand.
+/// @return true if the node was converted.
+bool
+makeOptionMatch(Node& node, const NodePtr& constant, const NodePtr& other) {
+    boost::shared_ptr<TokenOption> option = getHexOption(other);
+    if (option) {
+        node.option_ = option;
+
+    } else if ((other->type_ == Node::OPERATOR) &&
+               boost::dynamic_pointer_cast<TokenSubstring>(other->token_) &&
+               (other->children_[1]->type_ == Node::CONSTANT) &&
+               (other->children_[2]->type_ == Node::CONSTANT)) {
+        option = getHexOption(other->children_[0]);
+        if (!option) {
+            return (false);
+        }
+        // Invalid numbers are reported by the substring token during
+        // the evaluation, so such expressions are not converted.
+        try {
+            node.start_ = boost::lexical_cast<int>(other->children_[1]->value_);
+            if (other->children_[2]->value_ == "all") {
+                node.length_all_ = true;
+            } else {
+                node.length_ =
+                    boost::lexical_cast<int>(other->children_[2]->value_);
+            }
+        } catch (const boost::bad_lexical_cast&) {
+            return (false);
+        }
+        node.option_ = option;
+        node.substring_ = true;
+
+    } else {
+        return (false);
+    }
+
+    node.type_ = Node::OPTION_MATCH;
+    node.value_ = constant->value_;
+    node.children_.clear();
+    return (true);
+}
+
+/// @brief Builds the tree from the expression.
+///
+/// @param expr expression.
+/// @return root of the tree.
+/// @throw EvalBadStack if the expression is not well formed.
+NodePtr
+compile(const Expression& expr) {
+    // Constant sub-expressions don't use the packet, but the tokens
+    // require one.
+    Pkt4 pkt(DHCPDISCOVER, 0);
+
+    std::stack<NodePtr> nodes;
+    for (auto token = expr.begin(); token != expr.end(); ++token) {
+        Node::Type type;
+        size_t operands = getOperands(*token, type);
+        if (nodes.size() < operands) {
+            isc_throw(EvalBadStack, "Incorrect stack order. Expected at least "
+                      << operands << " values for an operator, got "
+                      << nodes.size());
+        }
+
+        NodePtr node(new Node(type, *token));
+        node->children_.resize(operands);
+        bool constant = true;
+        for (size_t i = operands; i > 0; --i) {
+            node->children_[i - 1] = nodes.top();
+            nodes.pop();
+            constant = constant && (node->children_[i - 1]->type_ == Node::CONSTANT);
+        }
+
+        // Evaluate the literals and the operators on literals. If the
+        // operator fails, it is left to fail during each evaluation.
+        if (constant && (type != Node::LEAF)) {
+            ValueStack values;
+            for (auto child = node->children_.begin();
+                 child != node->children_.end(); ++child) {
+                values.push((*child)->value_);
+            }
+            try {
+                (*token)->evaluate(pkt, values);
+                node->type_ = Node::CONSTANT;
+                node->value_ = values.top();
+                node->children_.clear();
+            } catch (const std::exception&) {
+            }
+
+        } else if (type == Node::EQUAL) {
+            if (node->children_[0]->type_ == Node::CONSTANT) {
+                makeOptionMatch(*node, node->children_[0], node->children_[1]);
+            } else if (node->children_[1]->type_ == Node::CONSTANT) {
+                makeOptionMatch(*node, node->children_[1], node->children_[0]);
+            }
+        }
+        nodes.push(node);
+    }
+
+    if (nodes.size() != 1) {
+        isc_throw(EvalBadStack, "Incorrect stack order. Expected exactly "
+                  "1 value at the end of evaluation, got " << nodes.size());
+    }
+    return (nodes.top());
+}
+
+/// @brief Compares the option content or its substring with a value.
+///
+/// The substring is computed the same way as by @c TokenSubstring.
+///
+/// @param node option match node.
+/// @param pkt packet being classified.
+/// @return true if the values are equal.
+bool
+matchOption(const Node& node, Pkt& pkt) {
+    OptionPtr opt = node.option_->getOption(pkt);
+    if (!opt) {
+        // A missing option is represented by an empty string.
+        return (node.value_.empty());
+    }
+
+    const std::vector<uint8_t> binary = opt->toBinary();
+    const int string_length = binary.size();
+    int start_pos = 0;
+    int length = string_length;
+
+    if (node.substring_) {
+        if (string_length == 0) {
+            return (node.value_.empty());
+        }
+        start_pos = node.start_;
+        if (!node.length_all_) {
+            length = node.length_;
+        }
+        if ((start_pos < -string_length) || (start_pos >= string_length)) {
+            return (node.value_.empty());
+        }
+        if (start_pos < 0) {
+            start_pos = string_length + start_pos;
+        }
+        if (length < 0) {
+            length = -length;
+            if (length <= start_pos) {
+                start_pos -= length;
+            } else {
+                length = start_pos;
+                start_pos = 0;
+            }
+        }
+        if (length > string_length - start_pos) {
+            length = string_length - start_pos;
+        }
+    }
+
+    return ((static_cast<size_t>(length) == node.value_.size()) &&
+            ((length == 0) ||
+             (memcmp(&binary[start_pos], node.value_.data(), length) == 0)));
+}
+
+std::string evaluateNode(const Node& node, Pkt& pkt);
+
+/// @brief Evaluates the node to a boolean value.
+///
+/// @param node node to be evaluated.
+/// @param pkt packet being classified.
+/// @return the boolean value of the node.
+bool
+evaluateNodeBool(const Node& node, Pkt& pkt) {
+    switch (node.type_) {
+    case Node::EQUAL:
+        return (evaluateNode(*node.children_[0], pkt) ==
+                evaluateNode(*node.children_[1], pkt));
+    case Node::NOT:
+        return (!evaluateNodeBool(*node.children_[0], pkt));
+    case Node::AND:
+        return (evaluateNodeBool(*node.children_[0], pkt) &&
+                evaluateNodeBool(*node.children_[1], pkt));
+    case Node::OR:
+        return (evaluateNodeBool(*node.children_[0], pkt) ||
+                evaluateNodeBool(*node.children_[1], pkt));
+    case Node::OPTION_MATCH:
+        return (matchOption(node, pkt));
+    default:
+        return (Token::toBool(evaluateNode(node, pkt)));
+    }
+}
+
+/// @brief Evaluates the node to a string value.
+///
+/// @param node node to be evaluated.
+/// @param pkt packet being classified.
+/// @return the string value of the node.
+std::string
+evaluateNode(const Node& node, Pkt& pkt) {
+    switch (node.type_) {
+    case Node::CONSTANT:
+        return (node.value_);
+    case Node::IFELSE:
+        return (evaluateNodeBool(*node.children_[0], pkt) ?
+                evaluateNode(*node.children_[1], pkt) :
+                evaluateNode(*node.children_[2], pkt));
+    case Node::LEAF:
+    case Node::OPERATOR:
+        break;
+    default:
+        return (evaluateNodeBool(node, pkt) ? "true" : "false");
+    }
+
+    ValueStack values;
+    for (auto child = node.children_.begin(); child != node.children_.end();
+         ++child) {
+        values.push(evaluateNode(**child, pkt));
+    }
+    node.token_->evaluate(pkt, values);
+    return (values.top());
+}
+
+} // end of anonymous namespace
+
+namespace isc {
+namespace dhcp {
+
+CompiledExpression::CompiledExpression(const Expression& expr)
+    : expression_(expr), root_(compile(expr)) {
+}
+
+bool
+CompiledExpression::evaluateBool(Pkt& pkt) const {
+    if (eval_logger.isDebugEnabled(EVAL_DBG_STACK)) {
+        return (isc::dhcp::evaluateBool(expression_, pkt));
+    }
+    return (evaluateNodeBool(*root_, pkt));
+}
+
+std::string
+CompiledExpression::evaluateString(Pkt& pkt) const {
+    if (eval_logger.isDebugEnabled(EVAL_DBG_STACK)) {
+        return (isc::dhcp::evaluateString(expression_, pkt));
+    }
+    return (evaluateNode(*root_, pkt));
+}
+
+bool
+CompiledExpression::isConstant() const {
+    return (root_->type_ == Node::CONSTANT);
+}
+
+}; // end of isc::dhcp namespace
+}; // end of isc namespace
@@ -0,0 +1,103 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef COMPILED_EXPRESSION_H
+#define COMPILED_EXPRESSION_H
+
+#include <eval/token.h>
+#include <boost/shared_ptr.hpp>
+#include <string>
+
+namespace isc {
+namespace dhcp {
+
+/// @brief Expression compiled for the repeated evaluation.
+///
+/// The @c Expression produced by the parser is a list of tokens in the
+/// reverse Polish notation which are evaluated one after another over
+/// a stack of strings. This is simple but every evaluation of every
+/// token copies strings and all operands are evaluated even when the
+/// result is already known, e.g. for the "and" operator which first
+/// operand is false.
+///
+/// This class converts the list of tokens into a tree when the
+/// configuration is loaded. The tree is evaluated recursively without
+/// the stack:
+/// - the sub-expressions which don't depend on the packet are replaced
+///   with their values (constant folding),
+/// - the "and", "or" and "ifelse" operators evaluate only the operands
+///   needed to produce the result (short-circuit evaluation),
+/// - the boolean operators don't convert their results to strings,
+/// - the comparisons of the option content or its substring with a
+///   constant, e.g. substring(option[61].hex,0,3) == 'foo', compare
+///   the option data in place.
+///
+/// The result of the evaluation is the same as the result of the
+/// @c evaluateBool and @c evaluateString functions with the following
+/// exception: the operand skipped by the short-circuit evaluation is
+/// not checked for errors, e.g. an expression using pkt4 fields in the
+/// second operand of "or" evaluates to true for a DHCPv6 packet when
+/// the first operand is true.
+///
+/// The per token debug messages are only logged by the evaluation of
+/// the original tokens, so the compiled form is not used when the
+/// debug logging of the evaluation is enabled.
+class CompiledExpression {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// @param expr expression to be compiled.
+    ///
+    /// @throw EvalBadStack if the expression is not well formed, e.g.
+    /// it is empty or an operator doesn't have enough operands.
+    explicit CompiledExpression(const Expression& expr);
+
+    /// @brief Evaluates the expression to a boolean value.
+    ///
+    /// @param pkt packet being classified.
+    /// @return the boolean value of the expression.
+    /// @throw EvalTypeError if the value is not a boolean.
+    bool evaluateBool(Pkt& pkt) const;
+
+    /// @brief Evaluates the expression to a string value.
+    ///
+    /// @param pkt packet being classified.
+    /// @return the string value of the expression.
+    std::string evaluateString(Pkt& pkt) const;
+
+    /// @brief Checks if the expression has been folded to a constant.
+    ///
+    /// This method is used in testing.
+    bool isConstant() const;
+
+    /// @brief Node of the compiled expression tree.
+    ///
+    /// It is defined in the implementation file.
+    struct Node;
+
+    /// @brief Pointer to the node.
+    typedef boost::shared_ptr<Node> NodePtr;
+
+private:
+
+    /// @brief Original expression.
+    ///
+    /// It holds the tokens referenced by the tree and it is evaluated
+    /// instead of the tree when the debug logging is enabled.
+    Expression expression_;
+
+    /// @brief Root of the compiled expression tree.
+    NodePtr root_;
+};
+
+/// @brief Pointer to the compiled expression.
+typedef boost::shared_ptr<CompiledExpression> CompiledExpressionPtr;
+
+}; // end of isc::dhcp namespace
+}; // end of isc namespace
+
+#endif
@@ -0,0 +1,300 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+#include <eval/compiled_expression.h>
+#include <eval/eval_context.h>
+#include <eval/evaluate.h>
+#include <dhcp/dhcp4.h>
+#include <dhcp/dhcp6.h>
+#include <dhcp/option_string.h>
+#include <dhcp/pkt4.h>
+#include <dhcp/pkt6.h>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/lexical_cast.hpp>
+#include <gtest/gtest.h>
+#include <iostream>
+
+using namespace std;
+using namespace isc::dhcp;
+using namespace boost::posix_time;
+
+namespace {
+
+/// @brief Test fixture for testing compiled expressions.
+class CompiledExpressionTest : public ::testing::Test {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// Creates the packets with the option 100 holding "hundred4" or
+    /// "hundred6" depending on the universe.
+    CompiledExpressionTest()
+        : pkt4_(new Pkt4(DHCPDISCOVER, 12345)),
+          pkt6_(new Pkt6(DHCPV6_SOLICIT, 12345)) {
+        pkt4_->addOption(OptionPtr(new OptionString(Option::V4, 100,
+                                                    "hundred4")));
+        pkt6_->addOption(OptionPtr(new OptionString(Option::V6, 100,
+                                                    "hundred6")));
+    }
+
+    /// @brief Parses the expression.
+    ///
+    /// @param expr expression to be parsed.
+    /// @param u universe of the expression.
+    /// @param type type of the expression.
+    /// @return parsed expression.
+    Expression parse(const string& expr, const Option::Universe& u = Option::V4,
+                     EvalContext::ParserType type = EvalContext::PARSER_BOOL) {
+        EvalContext eval(u);
+        EXPECT_TRUE(eval.parseString(expr, type)) << " for expression " << expr;
+        return (eval.expression);
+    }
+
+    /// @brief Compiles the expression.
+    ///
+    /// @param expr expression to be compiled.
+    /// @param u universe of the expression.
+    /// @param type type of the expression.
+    /// @return compiled expression.
+    CompiledExpressionPtr compile(const string& expr,
+                                  const Option::Universe& u = Option::V4,
+                                  EvalContext::ParserType type =
+                                  EvalContext::PARSER_BOOL) {
+        return (CompiledExpressionPtr(new CompiledExpression(parse(expr, u,
+                                                                   type))));
+    }
+
+    Pkt4Ptr pkt4_; ///< A stub DHCPv4 packet
+    Pkt6Ptr pkt6_; ///< A stub DHCPv6 packet
+};
+
+// This test verifies that the malformed expressions are rejected.
+TEST_F(CompiledExpressionTest, badStack) {
+    Expression expr;
+    EXPECT_THROW(CompiledExpression compiled(expr), EvalBadStack);
+
+    // An operator without operands.
+    expr.push_back(TokenPtr(new TokenEqual()));
+    EXPECT_THROW(CompiledExpression compiled(expr), EvalBadStack);
+
+    // Too many values.
+    expr.clear();
+    expr.push_back(TokenPtr(new TokenString("foo")));
+    expr.push_back(TokenPtr(new TokenString("bar")));
+    EXPECT_THROW(CompiledExpression compiled(expr), EvalBadStack);
+}
+
+// This test verifies that the sub-expressions which don't depend on the
+// packet are folded to constants.
+TEST_F(CompiledExpressionTest, constantFolding) {
+    CompiledExpressionPtr compiled;
+
+    ASSERT_NO_THROW(compiled = compile("'foo' == 'foo'"));
+    EXPECT_TRUE(compiled->isConstant());
+    EXPECT_TRUE(compiled->evaluateBool(*pkt4_));
+
+    ASSERT_NO_THROW(compiled = compile("concat('foo', 'bar') == 'foobar' and "
+                                       "not (substring('foobar', 0, 3) == "
+                                       "'bar')"));
+    EXPECT_TRUE(compiled->isConstant());
+    EXPECT_TRUE(compiled->evaluateBool(*pkt4_));
+
+    ASSERT_NO_THROW(compiled = compile("ifelse('a' == 'b', 'foo', 'bar')",
+                                       Option::V4,
+                                       EvalContext::PARSER_STRING));
+    EXPECT_TRUE(compiled->isConstant());
+    EXPECT_EQ("bar", compiled->evaluateString(*pkt4_));
+
+    // The expressions using the packet are not folded.
+    ASSERT_NO_THROW(compiled = compile("option[100].hex == 'hundred4'"));
+    EXPECT_FALSE(compiled->isConstant());
+    EXPECT_TRUE(compiled->evaluateBool(*pkt4_));
+
+    // The erroneous constant expressions fail when evaluated.
+    Expression expr;
+    expr.push_back(TokenPtr(new TokenString("foo")));
+    expr.push_back(TokenPtr(new TokenString("bar")));
+    expr.push_back(TokenPtr(new TokenAnd()));
+    ASSERT_NO_THROW(compiled.reset(new CompiledExpression(expr)));
+    EXPECT_FALSE(compiled->isConstant());
+    EXPECT_THROW(compiled->evaluateBool(*pkt4_), EvalTypeError);
+}
+
+// This test verifies that the comparisons of the option content or its
+// substring with a constant give the same results as the tokens.
+TEST_F(CompiledExpressionTest, optionMatch) {
+    vector<string> lengths;
+    for (int i = -10; i <= 10; ++i) {
+        lengths.push_back(boost::lexical_cast<string>(i));
+    }
+    lengths.push_back("all");
+
+    // Option 200 is not present in the packets.
+    for (int code = 100; code <= 200; code += 100) {
+        string option = "option[" + boost::lexical_cast<string>(code) + "].hex";
+        for (int start = -10; start <= 10; ++start) {
+            for (auto length = lengths.begin(); length != lengths.end();
+                 ++length) {
+                string substring = "substring(" + option + "," +
+                    boost::lexical_cast<string>(start) + "," + *length + ")";
+                string value = evaluateString(parse(substring, Option::V4,
+                                                    EvalContext::PARSER_STRING),
+                                              *pkt4_);
+
+                // Check the matching value and one character more or less.
+                vector<string> values;
+                values.push_back(value);
+                values.push_back(value + "x");
+                if (!value.empty()) {
+                    values.push_back(value.substr(1));
+                }
+                for (auto v = values.begin(); v != values.end(); ++v) {
+                    string expr = substring + " == '" + *v + "'";
+                    CompiledExpressionPtr compiled = compile(expr);
+                    EXPECT_EQ(evaluateBool(parse(expr), *pkt4_),
+                              compiled->evaluateBool(*pkt4_))
+                        << " for expression " << expr;
+                }
+            }
+        }
+
+        // The whole option.
+        const string values[] = { "hundred4", "hundred", "" };
+        for (int i = 0; i < 3; ++i) {
+            string expr = "'" + values[i] + "' == " + option;
+            CompiledExpressionPtr compiled = compile(expr);
+            EXPECT_EQ(evaluateBool(parse(expr), *pkt4_),
+                      compiled->evaluateBool(*pkt4_))
+                << " for expression " << expr;
+        }
+    }
+}
+
+// This test verifies that only the operands needed to produce the result
+// are evaluated.
+TEST_F(CompiledExpressionTest, shortCircuit) {
+    // The pkt4 fields can't be evaluated for a DHCPv6 packet.
+    string expr = "pkt4.mac == 0x010203";
+    EXPECT_THROW(evaluateBool(parse(expr), *pkt6_), EvalTypeError);
+    EXPECT_THROW(compile(expr)->evaluateBool(*pkt6_), EvalTypeError);
+
+    // The tokens evaluate both operands of "or" but the compiled
+    // expression doesn't need the second one.
+    expr = "option[100].exists or pkt4.mac == 0x010203";
+    EXPECT_THROW(evaluateBool(parse(expr), *pkt6_), EvalTypeError);
+    EXPECT_TRUE(compile(expr)->evaluateBool(*pkt6_));
+
+    // The same for "and".
+    expr = "option[200].exists and pkt4.mac == 0x010203";
+    EXPECT_THROW(evaluateBool(parse(expr), *pkt6_), EvalTypeError);
+    EXPECT_FALSE(compile(expr)->evaluateBool(*pkt6_));
+
+    // And for the branch of "ifelse" which is not taken.
+    expr = "ifelse(option[100].exists, 'foo', pkt4.mac)";
+    EXPECT_THROW(evaluateString(parse(expr, Option::V4,
+                                      EvalContext::PARSER_STRING), *pkt6_),
+                 EvalTypeError);
+    EXPECT_EQ("foo", compile(expr, Option::V4,
+                             EvalContext::PARSER_STRING)->evaluateString(*pkt6_));
+
+    // The evaluated operands still report errors.
+    expr = "option[200].exists or pkt4.mac == 0x010203";
+    EXPECT_THROW(compile(expr)->evaluateBool(*pkt6_), EvalTypeError);
+}
+
+// This is a performance benchmark comparing the evaluation of the tokens
+// with the evaluation of the compiled expressions.
+TEST_F(CompiledExpressionTest, DISABLED_performanceEvaluate) {
+    const int evaluations = 1000000;
+    const string exprs[] = {
+        "option[100].hex == 'hundred4'",
+        "substring(option[100].hex, 0, 3) == 'hun'",
+        "option[200].exists or (pkt4.msgtype == 1 and "
+        "substring(option[100].hex, -1, all) == '4')",
+        "option[100].exists or (concat('foo', 'bar') == pkt4.mac)"
+    };
+    for (int i = 0; i < 4; ++i) {
+        Expression expr = parse(exprs[i]);
+        CompiledExpression compiled(expr);
+        ASSERT_EQ(evaluateBool(expr, *pkt4_), compiled.evaluateBool(*pkt4_));
+
+        ptime before = microsec_clock::local_time();
+        for (int j = 0; j < evaluations; ++j) {
+            evaluateBool(expr, *pkt4_);
+        }
+        time_duration tokens_dur = microsec_clock::local_time() - before;
+
+        before = microsec_clock::local_time();
+        for (int j = 0; j < evaluations; ++j) {
+            compiled.evaluateBool(*pkt4_);
+        }
+        time_duration compiled_dur = microsec_clock::local_time() - before;
+
+        std::cout << evaluations << " evaluations of " << exprs[i]
+                  << " took: " << to_simple_string(tokens_dur)
+                  << " (tokens), " << to_simple_string(compiled_dur)
+                  << " (compiled)" << std::endl;
+    }
+}
+
+// This is a performance benchmark comparing the evaluation of the tokens
+// with the evaluation of the compiled expressions when a packet is
+// classified with 200 classes, most of which don't match.
+TEST_F(CompiledExpressionTest, DISABLED_performanceClassify) {
+    const int packets = 10000;
+    std::vector<Expression> exprs;
+    std::vector<CompiledExpressionPtr> compiled;
+    for (int i = 0; i < 200; ++i) {
+        string text;
+        switch (i % 4) {
+        case 0:
+            text = "option[100].hex == 'class" +
+                boost::lexical_cast<string>(i) + "'";
+            break;
+        case 1:
+            text = "substring(option[100].hex, 0, 3) == 'c" +
+                boost::lexical_cast<string>(i) + "'";
+            break;
+        case 2:
+            text = "option[" + boost::lexical_cast<string>(i) +
+                "].exists and pkt4.msgtype == 1";
+            break;
+        default:
+            text = "pkt4.msgtype == 3 or option[100].hex == 'hundred" +
+                boost::lexical_cast<string>(i) + "'";
+        }
+        exprs.push_back(parse(text));
+        compiled.push_back(CompiledExpressionPtr(
+                               new CompiledExpression(exprs.back())));
+        ASSERT_EQ(evaluateBool(exprs.back(), *pkt4_),
+                  compiled.back()->evaluateBool(*pkt4_)) << text;
+    }
+
+    ptime before = microsec_clock::local_time();
+    for (int i = 0; i < packets; ++i) {
+        for (size_t j = 0; j < exprs.size(); ++j) {
+            evaluateBool(exprs[j], *pkt4_);
+        }
+    }
+    time_duration tokens_dur = microsec_clock::local_time() - before;
+
+    before = microsec_clock::local_time();
+    for (int i = 0; i < packets; ++i) {
+        for (size_t j = 0; j < compiled.size(); ++j) {
+            compiled[j]->evaluateBool(*pkt4_);
+        }
+    }
+    time_duration compiled_dur = microsec_clock::local_time() - before;
+
+    std::cout << packets << " packets classified with " << exprs.size()
+              << " classes took: " << to_simple_string(tokens_dur)
+              << " (tokens), " << to_simple_string(compiled_dur)
+              << " (compiled)" << std::endl;
+}
+
+} // end of anonymous namespace
@@ -5,6 +5,7 @@
 // file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
 #include <config.h>
+#include <eval/compiled_expression.h>
 #include <eval/evaluate.h>
 #include <eval/eval_context.h>
 #include <eval/token.h>
@@ -325,6 +326,16 @@ public:
         }
 
         EXPECT_EQ(exp_result, result) << " for expression " << expr;
+
+        // The compiled expression must give the same result.
+        CompiledExpressionPtr compiled;
+        ASSERT_NO_THROW(compiled.reset(new CompiledExpression(eval.expression)))
+            << " while compiling expression " << expr;
+        Pkt& pkt = (u == Option::V4 ? static_cast<Pkt&>(*pkt4_) :
+                    static_cast<Pkt&>(*pkt6_));
+        ASSERT_NO_THROW(result = compiled->evaluateBool(pkt))
+            << " for compiled expression " << expr;
+        EXPECT_EQ(exp_result, result) << " for compiled expression " << expr;
     }
 
     /// @brief Checks if expression can be parsed and evaluated to string
@@ -358,6 +369,16 @@ public:
         }
 
         EXPECT_EQ(exp_result, result) << " for expression " << expr;
+
+        // The compiled expression must give the same result.
+        CompiledExpressionPtr compiled;
+        ASSERT_NO_THROW(compiled.reset(new CompiledExpression(eval.expression)))
+            << " while compiling expression " << expr;
+        Pkt& pkt = (u == Option::V4 ? static_cast<Pkt&>(*pkt4_) :
+                    static_cast<Pkt&>(*pkt6_));
+        ASSERT_NO_THROW(result = compiled->evaluateString(pkt))
+            << " for compiled expression " << expr;
+        EXPECT_EQ(exp_result, result) << " for compiled expression " << expr;
     }
 
     /// @brief Checks that specified expression throws expected exception.
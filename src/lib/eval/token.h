@@ -273,18 +273,20 @@ public:
         return (representation_type_);
     }
 
-protected:
     /// @brief Attempts to retrieve an option
     ///
     /// For this class it simply attempts to retrieve the option from the packet,
     /// but there may be derived classes that would attempt to extract it from
     /// other places (e.g. relay option, or as a suboption of other specific option).
     ///
+    /// This method is public so the compiled expressions can match the
+    /// option contents without pushing them on the stack.
     ///
     /// @param pkt the option will be retrieved from here
     /// @return option instance (or NULL if not found)
     virtual OptionPtr getOption(Pkt& pkt);
 
+protected:
     /// @brief Auxiliary method that puts string representing a failure
     ///
     /// Depending on the representation type, this is either "" or "false".
@@ -18,13 +18,19 @@ using namespace std;
 namespace isc {
 namespace hooks {
 
+const size_t CalloutHandle::ARGUMENTS_RESERVED;
+
 // Constructor.
 CalloutHandle::CalloutHandle(const boost::shared_ptr<CalloutManager>& manager,
                     const boost::shared_ptr<LibraryManagerCollection>& lmcoll)
-    : lm_collection_(lmcoll), arguments_(), context_collection_(),
-      manager_(manager), server_hooks_(ServerHooks::getServerHooks()),
+    : lm_collection_(lmcoll), arguments_(), arguments_count_(0),
+      context_collection_(), manager_(manager),
+      server_hooks_(ServerHooks::getServerHooks()),
       next_step_(NEXT_STEP_CONTINUE) {
 
+    // Allocate the elements for the arguments usually passed to a hook.
+    arguments_.reserve(ARGUMENTS_RESERVED);
+
     // Call the "context_create" hook.  We should be OK doing this - although
     // the constructor has not finished running, all the member variables
     // have been created.
@@ -42,6 +48,7 @@ CalloutHandle::~CalloutHandle() {
     // Explicitly clear the argument and context objects.  This should free up
     // all memory that could have been allocated by libraries that were loaded.
     arguments_.clear();
+    arguments_count_ = 0;
     context_collection_.clear();
 
     // Normal destruction of the remaining variables will include the
@@ -64,14 +71,81 @@ vector<string>
 CalloutHandle::getArgumentNames() const {
 
     vector<string> names;
-    for (ElementCollection::const_iterator i = arguments_.begin();
-         i != arguments_.end(); ++i) {
-        names.push_back(i->first);
+    for (size_t i = 0; i < arguments_count_; ++i) {
+        names.push_back(arguments_[i].first);
     }
 
     return (names);
 }
 
+// Delete an argument, keeping its element for reuse.
+
+void
+CalloutHandle::deleteArgument(const std::string& name) {
+    for (size_t i = 0; i < arguments_count_; ++i) {
+        if (arguments_[i].first == name) {
+            // Release the value and move the element past the arguments.
+            boost::any().swap(arguments_[i].second);
+            --arguments_count_;
+            arguments_[i].first.swap(arguments_[arguments_count_].first);
+            arguments_[i].second.swap(arguments_[arguments_count_].second);
+            return;
+        }
+    }
+}
+
+// Delete all arguments, keeping their elements for reuse.
+
+void
+CalloutHandle::deleteAllArguments() {
+    for (size_t i = 0; i < arguments_count_; ++i) {
+        boost::any().swap(arguments_[i].second);
+    }
+    arguments_count_ = 0;
+}
+
+// Return the value of an argument or null.
+
+const boost::any*
+CalloutHandle::findArgument(const std::string& name) const {
+    for (size_t i = 0; i < arguments_count_; ++i) {
+        if (arguments_[i].first == name) {
+            return (&arguments_[i].second);
+        }
+    }
+    return (NULL);
+}
+
+// Return the value of an argument to be set, creating the argument if
+// it doesn't exist.
+
+boost::any&
+CalloutHandle::getArgumentForSet(const std::string& name) {
+    for (size_t i = 0; i < arguments_count_; ++i) {
+        if (arguments_[i].first == name) {
+            return (arguments_[i].second);
+        }
+    }
+
+    // Prefer the deleted element having the same name, so the name is not
+    // assigned when the same arguments are set for each hook.
+    size_t index = arguments_count_;
+    for (size_t i = arguments_count_; i < arguments_.size(); ++i) {
+        if (arguments_[i].first == name) {
+            index = i;
+            break;
+        }
+    }
+    if (index == arguments_.size()) {
+        arguments_.push_back(make_pair(name, boost::any()));
+    } else {
+        arguments_[index].first.swap(arguments_[arguments_count_].first);
+        arguments_[index].second.swap(arguments_[arguments_count_].second);
+        arguments_[arguments_count_].first = name;
+    }
+    return (arguments_[arguments_count_++].second);
+}
+
 // Return the library handle allowing the callout to access the CalloutManager
 // registration/deregistration functions.
 
@@ -129,6 +203,19 @@ CalloutHandle::getContextNames() const {
     return (names);
 }
 
+// Return the handle of the parking lot of the current hook.
+
+ParkingLotHandlePtr
+CalloutHandle::getParkingLotHandlePtr() const {
+    int index = manager_->getHookIndex();
+    if (index < 0) {
+        isc_throw(NoSuchHook, "the parking lot is only available to the"
+                  " callouts");
+    }
+    return (ParkingLotHandlePtr(new ParkingLotHandle(
+        server_hooks_.getParkingLotsPtr()->getParkingLotPtr(index))));
+}
+
 // Return name of current hook (the hook to which the current callout is
 // attached) or the empty string if not called within the context of a
 // callout.
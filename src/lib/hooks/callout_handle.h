@@ -9,6 +9,7 @@
 
 #include <exceptions/exceptions.h>
 #include <hooks/library_handle.h>
+#include <hooks/parking_lots.h>
 
 #include <boost/any.hpp>
 #include <boost/shared_ptr.hpp>
@@ -91,7 +92,8 @@ public:
     enum CalloutNextStep {
         NEXT_STEP_CONTINUE = 0, ///< continue normally
         NEXT_STEP_SKIP = 1,     ///< skip the next processing step
-        NEXT_STEP_DROP = 2      ///< drop the packet
+        NEXT_STEP_DROP = 2,     ///< drop the packet
+        NEXT_STEP_PARK = 3      ///< park the packet
     };
 
 
@@ -143,13 +145,20 @@ public:
     /// @brief Set argument
     ///
     /// Sets the value of an argument.  The argument is created if it does not
-    /// already exist.
+    /// already exist.  If the argument exists and holds a value of the same
+    /// type, the value is assigned in place without allocating memory.
     ///
     /// @param name Name of the argument.
     /// @param value Value to set.  That can be of any data type.
     template <typename T>
     void setArgument(const std::string& name, T value) {
-        arguments_[name] = value;
+        boost::any& element = getArgumentForSet(name);
+        T* current = boost::any_cast<T>(&element);
+        if (current) {
+            *current = value;
+        } else {
+            element = value;
+        }
     }
 
     /// @brief Get argument
@@ -166,13 +175,13 @@ public:
     ///        the variable provided to receive the value.
     template <typename T>
     void getArgument(const std::string& name, T& value) const {
-        ElementCollection::const_iterator element_ptr = arguments_.find(name);
-        if (element_ptr == arguments_.end()) {
+        const boost::any* element = findArgument(name);
+        if (!element) {
             isc_throw(NoSuchArgument, "unable to find argument with name " <<
                       name);
         }
 
-        value = boost::any_cast<T>(element_ptr->second);
+        value = boost::any_cast<T>(*element);
     }
 
     /// @brief Get argument names
@@ -192,9 +201,7 @@ public:
     /// by this method.
     ///
     /// @param name Name of the element in the argument list to set.
-    void deleteArgument(const std::string& name) {
-        static_cast<void>(arguments_.erase(name));
-    }
+    void deleteArgument(const std::string& name);
 
     /// @brief Delete all arguments
     ///
@@ -202,9 +209,7 @@ public:
     ///
     /// N.B. If any elements are raw pointers, the pointed-to data is NOT
     /// deleted by this method.
-    void deleteAllArguments() {
-        arguments_.clear();
-    }
+    void deleteAllArguments();
 
     /// @brief Sets the next processing step.
     ///
@@ -223,6 +228,11 @@ public:
     /// NEXT_STEP_DROP - tells the server to unconditionally drop the packet
     ///                  and do not process it further.
     ///
+    /// NEXT_STEP_PARK - tells the server to park the packet until the callout
+    ///                  unparks it using the handle returned by
+    ///                  @ref getParkingLotHandlePtr.  Only the hooks which
+    ///                  document it support this value.
+    ///
     /// This variable is interrogated by the server to see if the remaining
     /// callouts associated with the current hook should be bypassed.
     ///
@@ -337,7 +347,51 @@ public:
     /// @return Name of the current hook or the empty string if none.
     std::string getHookName() const;
 
+    /// @brief Returns the handle of the parking lot of the current hook.
+    ///
+    /// The callout which sets the NEXT_STEP_PARK status uses the handle
+    /// to reference the parked packet and then to unpark it when its
+    /// asynchronous operation completes.  The handle may be kept by the
+    /// library after the callout returns.
+    ///
+    /// @return Pointer to the parking lot handle.
+    ///
+    /// @throw NoSuchHook if it is not called by a callout.
+    ParkingLotHandlePtr getParkingLotHandlePtr() const;
+
 private:
+    /// @brief Collection of arguments passed to the callouts.
+    ///
+    /// The arguments are held in a vector of name/value pairs rather than
+    /// in a map.  The server sets the same few arguments before calling
+    /// each hook, so the first @c arguments_count_ elements hold the
+    /// arguments and the remaining elements are kept, with their names,
+    /// for reuse by the next arguments.  Setting an argument therefore
+    /// doesn't allocate the map node or the name.
+    typedef std::vector<std::pair<std::string, boost::any> >
+        ArgumentCollection;
+
+    /// @brief Number of argument elements allocated by the constructor.
+    static const size_t ARGUMENTS_RESERVED = 8;
+
+    /// @brief Returns the value of the argument.
+    ///
+    /// @param name Name of the argument.
+    ///
+    /// @return Pointer to the value or null if there is no such argument.
+    const boost::any* findArgument(const std::string& name) const;
+
+    /// @brief Returns the value of the argument to be set.
+    ///
+    /// If there is no such argument, it is created, reusing the element
+    /// of a deleted argument if possible.
+    ///
+    /// @param name Name of the argument.
+    ///
+    /// @return Reference to the value, which is empty if the argument has
+    ///         been created.
+    boost::any& getArgumentForSet(const std::string& name);
+
     /// @brief Check index
     ///
     /// Gets the current library index, throwing an exception if it is not set
@@ -382,7 +436,10 @@ private:
     boost::shared_ptr<LibraryManagerCollection> lm_collection_;
 
     /// Collection of arguments passed to the callouts
-    ElementCollection arguments_;
+    ArgumentCollection arguments_;
+
+    /// Number of arguments held at the beginning of @c arguments_.
+    size_t arguments_count_;
 
     /// Context collection - there is one entry per library context.
     ContextCollection context_collection_;
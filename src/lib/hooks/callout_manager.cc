@@ -24,11 +24,80 @@ using namespace std;
 namespace isc {
 namespace hooks {
 
+namespace {
+
+/// @brief Callouts being called by a thread.
+///
+/// In the multi-threading mode several threads call the callouts at the
+/// same time, so the indexes of the current hook and library can't be
+/// stored in the CalloutManager while the callouts are called. They are
+/// stored in this object instead, which is created by callCallouts and
+/// linked from a thread local pointer. The objects are chained, as a
+/// callout may call the callouts of another CalloutManager.
+class CalloutCall {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// Makes this object the current call of the thread.
+    ///
+    /// @param manager CalloutManager calling the callouts.
+    /// @param hook_index Index of the hook.
+    CalloutCall(const CalloutManager* manager, int hook_index)
+        : manager_(manager), hook_index_(hook_index), library_index_(-1),
+          previous_(current_) {
+        current_ = this;
+    }
+
+    /// @brief Destructor.
+    ///
+    /// Restores the previous call of the thread.
+    ~CalloutCall() {
+        current_ = previous_;
+    }
+
+    /// @brief Returns the call of the callouts of the manager by the
+    /// current thread.
+    ///
+    /// @param manager CalloutManager.
+    /// @return Pointer to the call or null if the thread is not calling
+    ///         the callouts of the manager.
+    static CalloutCall* find(const CalloutManager* manager) {
+        CalloutCall* call = current_;
+        while (call && (call->manager_ != manager)) {
+            call = call->previous_;
+        }
+        return (call);
+    }
+
+    /// CalloutManager calling the callouts.
+    const CalloutManager* manager_;
+
+    /// Index of the hook on which the callouts are called.
+    int hook_index_;
+
+    /// Index of the library which has registered the current callout.
+    int library_index_;
+
+private:
+
+    /// Previous call of the thread.
+    CalloutCall* previous_;
+
+    /// Current call of the thread.
+    static thread_local CalloutCall* current_;
+};
+
+thread_local CalloutCall* CalloutCall::current_ = 0;
+
+}
+
 // Constructor
 CalloutManager::CalloutManager(int num_libraries)
     : server_hooks_(ServerHooks::getServerHooks()),
-      current_hook_(-1), current_library_(-1),
-      hook_vector_(ServerHooks::getServerHooks().getCount()),
+      current_library_(-1),
+      hook_vector_(ServerHooks::getServerHooks().getCount(),
+                   CalloutVectorPtr(new CalloutVector())),
       library_handle_(this), pre_library_handle_(this, 0),
       post_library_handle_(this, INT_MAX), num_libraries_(num_libraries)
 {
@@ -55,39 +124,68 @@ CalloutManager::checkLibraryIndex(int library_index) const {
               num_libraries_ << ")");
 }
 
+// Get the index of the hook on which callouts are being called.
+
+int
+CalloutManager::getHookIndex() const {
+    CalloutCall* call = CalloutCall::find(this);
+    return (call ? call->hook_index_ : -1);
+}
+
+// Get and set the index of the current library.
+
+int
+CalloutManager::getLibraryIndex() const {
+    CalloutCall* call = CalloutCall::find(this);
+    return (call ? call->library_index_ : current_library_);
+}
+
+void
+CalloutManager::setLibraryIndex(int library_index) {
+    checkLibraryIndex(library_index);
+    CalloutCall* call = CalloutCall::find(this);
+    if (call) {
+        call->library_index_ = library_index;
+    } else {
+        current_library_ = library_index;
+    }
+}
+
 // Register a callout for the current library.
 
 void
 CalloutManager::registerCallout(const std::string& name, CalloutPtr callout) {
+    int library_index = getLibraryIndex();
+
     // Note the registration.
     LOG_DEBUG(callouts_logger, HOOKS_DBG_CALLS, HOOKS_CALLOUT_REGISTRATION)
-        .arg(current_library_).arg(name);
+        .arg(library_index).arg(name);
 
     // Sanity check that the current library index is set to a valid value.
-    checkLibraryIndex(current_library_);
+    checkLibraryIndex(library_index);
 
     // Get the index associated with this hook (validating the name in the
     // process).
     int hook_index = server_hooks_.getIndex(name);
 
+    // The callout vector may be in use by callCallouts, so the callout is
+    // added to a copy which then replaces it.
+    boost::shared_ptr<CalloutVector>
+        callouts(new CalloutVector(*hook_vector_[hook_index]));
+
     // Iterate through the callout vector for the hook from start to end,
     // looking for the first entry where the library index is greater than
     // the present index.
-    for (CalloutVector::iterator i = hook_vector_[hook_index].begin();
-         i != hook_vector_[hook_index].end(); ++i) {
-        if (i->first > current_library_) {
-            // Found an element whose library index number is greater than the
-            // current index, so insert the new element ahead of this one.
-            hook_vector_[hook_index].insert(i, make_pair(current_library_,
-                                                         callout));
-            return;
-        }
+    CalloutVector::iterator i = callouts->begin();
+    while ((i != callouts->end()) && (i->first <= library_index)) {
+        ++i;
     }
 
-    // Reached the end of the vector, so there is no element in the (possibly
-    // empty) set of callouts with a library index greater than the current
-    // library index.  Inset the callout at the end of the list.
-    hook_vector_[hook_index].push_back(make_pair(current_library_, callout));
+    // Insert the new element ahead of the element whose library index number
+    // is greater than the current index or, if there is no such element, at
+    // the end of the list.
+    callouts->insert(i, make_pair(library_index, callout));
+    hook_vector_[hook_index] = callouts;
 }
 
 // Check if callouts are present for a given hook index.
@@ -101,7 +199,7 @@ CalloutManager::calloutsPresent(int hook_index) const {
     }
 
     // Valid, so are there any callouts associated with that hook?
-    return (!hook_vector_[hook_index].empty());
+    return (!hook_vector_[hook_index]->empty());
 }
 
 bool
@@ -140,15 +238,16 @@ CalloutManager::callCallouts(int hook_index, CalloutHandle& callout_handle) {
     if (calloutsPresent(hook_index)) {
 
         // Set the current hook index.  This is used should a callout wish to
-        // determine to what hook it is attached.
-        current_hook_ = hook_index;
+        // determine to what hook it is attached.  The indexes are kept by
+        // the thread, as other threads may call callouts at the same time.
+        CalloutCall call(this, hook_index);
 
-        // Duplicate the callout vector for this hook and work through that.
-        // This step is needed because we allow dynamic registration and
-        // deregistration of callouts.  If a callout attached to a hook modified
-        // the list of callouts on that hook, the underlying CalloutVector would
-        // change and potentially affect the iteration through that vector.
-        CalloutVector callouts(hook_vector_[hook_index]);
+        // Hold the callout vector for this hook and work through that.  We
+        // allow dynamic registration and deregistration of callouts, but if a
+        // callout attached to a hook modifies the list of callouts on that
+        // hook, the vector is replaced rather than modified, so holding the
+        // pointer is enough to keep the iteration unaffected.
+        CalloutVectorPtr callouts = hook_vector_[hook_index];
 
         // This object will be used to measure execution time of each callout
         // and the total time spent in callouts for this hook point.
@@ -156,15 +255,15 @@ CalloutManager::callCallouts(int hook_index, CalloutHandle& callout_handle) {
 
         // Mark that the callouts begin for the hook.
         LOG_DEBUG(callouts_logger, HOOKS_DBG_CALLS, HOOKS_CALLOUTS_BEGIN)
-            .arg(server_hooks_.getName(current_hook_));
+            .arg(server_hooks_.getName(hook_index));
 
         // Call all the callouts.
-        for (CalloutVector::const_iterator i = callouts.begin();
-             i != callouts.end(); ++i) {
+        for (CalloutVector::const_iterator i = callouts->begin();
+             i != callouts->end(); ++i) {
             // In case the callout tries to register or deregister a callout,
             // set the current library index to the index associated with the
             // library that registered the callout being called.
-            current_library_ = i->first;
+            call.library_index_ = i->first;
 
             // Call the callout
             try {
@@ -173,14 +272,14 @@ CalloutManager::callCallouts(int hook_index, CalloutHandle& callout_handle) {
                 stopwatch.stop();
                 if (status == 0) {
                     LOG_DEBUG(callouts_logger, HOOKS_DBG_EXTENDED_CALLS,
-                              HOOKS_CALLOUT_CALLED).arg(current_library_)
-                        .arg(server_hooks_.getName(current_hook_))
+                              HOOKS_CALLOUT_CALLED).arg(call.library_index_)
+                        .arg(server_hooks_.getName(hook_index))
                         .arg(PointerConverter(i->second).dlsymPtr())
                         .arg(stopwatch.logFormatLastDuration());
                 } else {
                     LOG_ERROR(callouts_logger, HOOKS_CALLOUT_ERROR)
-                        .arg(current_library_)
-                        .arg(server_hooks_.getName(current_hook_))
+                        .arg(call.library_index_)
+                        .arg(server_hooks_.getName(hook_index))
                         .arg(PointerConverter(i->second).dlsymPtr())
                         .arg(stopwatch.logFormatLastDuration());
                 }
@@ -190,8 +289,8 @@ CalloutManager::callCallouts(int hook_index, CalloutHandle& callout_handle) {
                 stopwatch.stop();
                 // Any exception, not just ones based on isc::Exception
                 LOG_ERROR(callouts_logger, HOOKS_CALLOUT_EXCEPTION)
-                    .arg(current_library_)
-                    .arg(server_hooks_.getName(current_hook_))
+                    .arg(call.library_index_)
+                    .arg(server_hooks_.getName(hook_index))
                     .arg(PointerConverter(i->second).dlsymPtr())
                     .arg(e.what())
                     .arg(stopwatch.logFormatLastDuration());
@@ -202,13 +301,11 @@ CalloutManager::callCallouts(int hook_index, CalloutHandle& callout_handle) {
         // Mark end of callout execution. Include the total execution
         // time for callouts.
         LOG_DEBUG(callouts_logger, HOOKS_DBG_CALLS, HOOKS_CALLOUTS_COMPLETE)
-            .arg(server_hooks_.getName(current_hook_))
+            .arg(server_hooks_.getName(hook_index))
             .arg(stopwatch.logFormatTotalDuration());
 
-        // Reset the current hook and library indexes to an invalid value to
-        // catch any programming errors.
-        current_hook_ = -1;
-        current_library_ = -1;
+        // The current hook and library indexes are reset to an invalid
+        // value when the call object goes out of scope.
     }
 }
 
@@ -230,8 +327,10 @@ CalloutManager::callCommandHandlers(const std::string& command_name,
 
 bool
 CalloutManager::deregisterCallout(const std::string& name, CalloutPtr callout) {
+    int library_index = getLibraryIndex();
+
     // Sanity check that the current library index is set to a valid value.
-    checkLibraryIndex(current_library_);
+    checkLibraryIndex(library_index);
 
     // Get the index associated with this hook (validating the name in the
     // process).
@@ -239,12 +338,13 @@ CalloutManager::deregisterCallout(const std::string& name, CalloutPtr callout) {
 
     /// Construct a CalloutEntry matching the current library and the callout
     /// we want to remove.
-    CalloutEntry target(current_library_, callout);
+    CalloutEntry target(library_index, callout);
 
-    /// To decide if any entries were removed, we'll record the initial size
-    /// of the callout vector for the hook, and compare it with the size after
-    /// the removal.
-    size_t initial_size = hook_vector_[hook_index].size();
+    /// The callout vector may be in use by callCallouts, so the callouts are
+    /// removed from a copy which then replaces it.  To decide if any entries
+    /// were removed, we'll compare the sizes of the vectors.
+    boost::shared_ptr<CalloutVector>
+        callouts(new CalloutVector(*hook_vector_[hook_index]));
 
     // The next bit is standard STL (see "Item 33" in "Effective STL" by
     // Scott Meyers).
@@ -255,17 +355,16 @@ CalloutManager::deregisterCallout(const std::string& name, CalloutPtr callout) {
     // is equal to the value of the passed callout.)  The erase() call
     // removes everything from that element to the end of the vector, i.e.
     // all the matching elements.
-    hook_vector_[hook_index].erase(remove_if(hook_vector_[hook_index].begin(),
-                                             hook_vector_[hook_index].end(),
-                                             bind1st(equal_to<CalloutEntry>(),
-                                                     target)),
-                                   hook_vector_[hook_index].end());
+    callouts->erase(remove_if(callouts->begin(), callouts->end(),
+                              bind1st(equal_to<CalloutEntry>(), target)),
+                    callouts->end());
 
     // Return an indication of whether anything was removed.
-    bool removed = initial_size != hook_vector_[hook_index].size();
+    bool removed = hook_vector_[hook_index]->size() != callouts->size();
     if (removed) {
+        hook_vector_[hook_index] = callouts;
         LOG_DEBUG(callouts_logger, HOOKS_DBG_EXTENDED_CALLS,
-                  HOOKS_CALLOUT_DEREGISTERED).arg(current_library_).arg(name);
+                  HOOKS_CALLOUT_DEREGISTERED).arg(library_index).arg(name);
     }
 
     return (removed);
@@ -275,6 +374,7 @@ CalloutManager::deregisterCallout(const std::string& name, CalloutPtr callout) {
 
 bool
 CalloutManager::deregisterAllCallouts(const std::string& name) {
+    int library_index = getLibraryIndex();
 
     // Get the index associated with this hook (validating the name in the
     // process).
@@ -282,25 +382,24 @@ CalloutManager::deregisterAllCallouts(const std::string& name) {
 
     /// Construct a CalloutEntry matching the current library (the callout
     /// pointer is NULL as we are not checking that).
-    CalloutEntry target(current_library_, static_cast<CalloutPtr>(0));
+    CalloutEntry target(library_index, static_cast<CalloutPtr>(0));
 
-    /// To decide if any entries were removed, we'll record the initial size
-    /// of the callout vector for the hook, and compare it with the size after
-    /// the removal.
-    size_t initial_size = hook_vector_[hook_index].size();
+    /// The callouts are removed from a copy of the callout vector, as in
+    /// deregisterCallout.
+    boost::shared_ptr<CalloutVector>
+        callouts(new CalloutVector(*hook_vector_[hook_index]));
 
     // Remove all callouts matching this library.
-    hook_vector_[hook_index].erase(remove_if(hook_vector_[hook_index].begin(),
-                                             hook_vector_[hook_index].end(),
-                                             bind1st(CalloutLibraryEqual(),
-                                                     target)),
-                                   hook_vector_[hook_index].end());
+    callouts->erase(remove_if(callouts->begin(), callouts->end(),
+                              bind1st(CalloutLibraryEqual(), target)),
+                    callouts->end());
 
     // Return an indication of whether anything was removed.
-    bool removed = initial_size != hook_vector_[hook_index].size();
+    bool removed = hook_vector_[hook_index]->size() != callouts->size();
     if (removed) {
+        hook_vector_[hook_index] = callouts;
         LOG_DEBUG(callouts_logger, HOOKS_DBG_EXTENDED_CALLS,
-                  HOOKS_ALL_CALLOUTS_DEREGISTERED).arg(current_library_)
+                  HOOKS_ALL_CALLOUTS_DEREGISTERED).arg(library_index)
                                                 .arg(name);
     }
 
@@ -319,7 +418,8 @@ CalloutManager::registerCommandHook(const std::string& command_name) {
         // add new element at the end of the hook_vector_. The index of this
         // element will match the index of the hook point in the ServerHooks
         // because ServerHooks allocates indexes incrementally.
-        hook_vector_.resize(server_hooks_.getCount());
+        hook_vector_.resize(server_hooks_.getCount(),
+                            CalloutVectorPtr(new CalloutVector()));
     }
 }
 
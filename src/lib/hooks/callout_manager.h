@@ -145,6 +145,11 @@ private:
     /// associated with a given hook.
     typedef std::vector<CalloutEntry> CalloutVector;
 
+    /// Pointer to the vector of callouts associated with a given hook.  The
+    /// vector is never modified after it has been created: registration
+    /// and deregistration of callouts replace it with a modified copy.
+    typedef boost::shared_ptr<const CalloutVector> CalloutVectorPtr;
+
 public:
 
     /// @brief Constructor
@@ -269,10 +274,9 @@ public:
     /// @brief Get current hook index
     ///
     /// Made available during callCallouts, this is the index of the hook
-    /// on which callouts are being called.
-    int getHookIndex() const {
-        return (current_hook_);
-    }
+    /// on which callouts are being called by the current thread.  It is
+    /// -1 otherwise.
+    int getHookIndex() const;
 
     /// @brief Get number of libraries
     ///
@@ -292,13 +296,14 @@ public:
     /// function in a user-library is called during the library load process),
     /// the index can be set by setLibraryIndex().
     ///
-    /// @note The value set by this method is lost after a call to
-    ///       callCallouts.
+    /// @note While callCallouts is executing, the index is kept by the
+    ///       thread calling the callouts, so the callouts called by other
+    ///       threads at the same time don't see it.  The value set by
+    ///       setLibraryIndex() from within a callout is lost when
+    ///       callCallouts returns.
     ///
     /// @return Current library index.
-    int getLibraryIndex() const {
-        return (current_library_);
-    }
+    int getLibraryIndex() const;
 
     /// @brief Set current library index
     ///
@@ -314,10 +319,7 @@ public:
     /// @param library_index New library index.
     ///
     /// @throw NoSuchLibrary if the index is not valid.
-    void setLibraryIndex(int library_index) {
-        checkLibraryIndex(library_index);
-        current_library_ = library_index;
-    }
+    void setLibraryIndex(int library_index);
 
     /// @defgroup calloutManagerLibraryHandles Callout manager library handles
     ///
@@ -406,20 +408,19 @@ private:
     /// a reference instead of accessing the singleton within the code.
     ServerHooks& server_hooks_;
 
-    /// Current hook.  When a call is made to callCallouts, this holds the
-    /// index of the current hook.  It is set to an invalid value (-1)
-    /// otherwise.
-    int current_hook_;
-
     /// Current library index.  When a call is made to any of the callout
-    /// registration methods, this variable indicates the index of the user
-    /// library that should be associated with the call.
+    /// registration methods outside callCallouts, this variable indicates
+    /// the index of the user library that should be associated with the
+    /// call.  The indexes of the current hook and library used while
+    /// callCallouts is executing are kept by the calling thread.
     int current_library_;
 
     /// Vector of callout vectors.  There is one entry in this outer vector for
-    /// each hook. Each element is itself a vector, with one entry for each
-    /// callout registered for that hook.
-    std::vector<CalloutVector> hook_vector_;
+    /// each hook. Each element points to a vector, with one entry for each
+    /// callout registered for that hook.  As the pointed-to vectors are not
+    /// modified, @c callCallouts iterates through the vector it has obtained
+    /// without copying it, even if a callout modifies the list of callouts.
+    std::vector<CalloutVectorPtr> hook_vector_;
 
     /// LibraryHandle object user by the callout to access the callout
     /// registration methods on this CalloutManager object.  The object is set
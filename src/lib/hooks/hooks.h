@@ -12,8 +12,9 @@
 
 namespace {
 
-// Version 4 of the hooks framework, set for Kea 1.1.
-const int KEA_HOOKS_VERSION = 4;
+// Version 5 of the hooks framework, set when the storage of the callout
+// arguments changed.
+const int KEA_HOOKS_VERSION = 5;
 
 // Names of the framework functions.
 const char* const LOAD_FUNCTION_NAME = "load";
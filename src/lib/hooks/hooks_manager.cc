@@ -121,6 +121,11 @@ HooksManager::loadLibraries(const HookLibsCollection& libraries) {
 
 void
 HooksManager::unloadLibrariesInternal() {
+    // The callbacks of the parked packets may hold the callout handles,
+    // which keep the libraries loaded, and may refer to the libraries'
+    // data, so the parked packets are dropped first.
+    ServerHooks::getServerHooks().getParkingLotsPtr()->clear();
+
     // The order of deletion does not matter here, as each library manager
     // holds its own pointer to the callout manager.  However, we may as
     // well delete the library managers first: if there are no other references
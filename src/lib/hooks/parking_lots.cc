@@ -0,0 +1,67 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <hooks/parking_lots.h>
+
+using namespace isc::util::thread;
+
+namespace isc {
+namespace hooks {
+
+ParkingLot::ParkingLot()
+    : parking_(), mutex_(new Mutex()) {
+}
+
+size_t
+ParkingLot::size() const {
+    MultiThreadingLock lock(*mutex_);
+    return (parking_.size());
+}
+
+void
+ParkingLot::clear() {
+    // The parked objects and the callbacks are destroyed without the
+    // mutex, as their destruction may release the resources of the
+    // hooks libraries.
+    ParkingInfoMap parking;
+    {
+        MultiThreadingLock lock(*mutex_);
+        parking.swap(parking_);
+    }
+}
+
+ParkingLots::ParkingLots()
+    : parking_lots_(), mutex_(new Mutex()) {
+}
+
+ParkingLotPtr
+ParkingLots::getParkingLotPtr(const int hook_index) {
+    MultiThreadingLock lock(*mutex_);
+    ParkingLotPtr& parking_lot = parking_lots_[hook_index];
+    if (!parking_lot) {
+        parking_lot.reset(new ParkingLot());
+    }
+    return (parking_lot);
+}
+
+void
+ParkingLots::clear() {
+    std::map<int, ParkingLotPtr> parking_lots;
+    {
+        MultiThreadingLock lock(*mutex_);
+        parking_lots = parking_lots_;
+    }
+    for (std::map<int, ParkingLotPtr>::const_iterator parking_lot =
+             parking_lots.begin(); parking_lot != parking_lots.end();
+         ++parking_lot) {
+        parking_lot->second->clear();
+    }
+}
+
+} // end of namespace hooks
+} // end of namespace isc
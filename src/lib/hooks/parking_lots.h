@@ -0,0 +1,290 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef PARKING_LOTS_H
+#define PARKING_LOTS_H
+
+#include <exceptions/exceptions.h>
+#include <util/threads/sync.h>
+#include <util/threads/multi_threading_mgr.h>
+
+#include <boost/any.hpp>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <map>
+
+namespace isc {
+namespace hooks {
+
+/// @brief Parking lot for objects, e.g. packets, for a hook point.
+///
+/// Callouts may need to perform asynchronous operations, e.g. query an
+/// external server, before the processing of a packet can continue. The
+/// callout which starts such an operation returns with the
+/// @c CalloutHandle::NEXT_STEP_PARK status and the server "parks" the
+/// packet, i.e. stores it along with a callback which resumes its
+/// processing. Meanwhile the server processes other packets. When the
+/// asynchronous operation completes, e.g. in a callback invoked by the
+/// IOService, the library "unparks" the packet and the server callback
+/// is invoked.
+///
+/// The server parks the packet before calling the callouts, and drops it
+/// from the parking lot if none of the callouts has set the
+/// @c CalloutHandle::NEXT_STEP_PARK status. Thus the packet is always
+/// parked when the callouts are called. A callout which is going to
+/// unpark the packet must first increase its reference count with
+/// @c ParkingLotHandle::reference. The packet is unparked when all the
+/// callouts which have referenced it have unparked it, so several
+/// libraries can perform their asynchronous operations concurrently.
+///
+/// The parked objects are shared pointers. They are identified by the
+/// address of the object they point to.
+///
+/// The parking lot may be used by the threads processing the packets and
+/// by the thread unparking them, so its state is protected by a mutex in
+/// the multi-threading mode. The callback is invoked without the mutex.
+class ParkingLot : public boost::noncopyable {
+public:
+
+    /// @brief Constructor.
+    ParkingLot();
+
+    /// @brief Parks an object.
+    ///
+    /// @tparam Type of the parked object, a shared pointer.
+    /// @param parked_object Object to be parked, e.g. a packet.
+    /// @param unpark_callback Callback invoked when the object is unparked.
+    ///
+    /// @throw InvalidOperation if the object is already parked.
+    template<typename T>
+    void park(T parked_object, boost::function<void()> unpark_callback) {
+        util::thread::MultiThreadingLock lock(*mutex_);
+        const void* key = parked_object.get();
+        if (parking_.count(key) > 0) {
+            isc_throw(InvalidOperation, "object is already parked");
+        }
+        parking_.insert(std::make_pair(key, ParkingInfo(parked_object,
+                                                        unpark_callback)));
+    }
+
+    /// @brief Increases the reference count of the parked object.
+    ///
+    /// It is called by the callouts which are going to unpark the object.
+    ///
+    /// @tparam Type of the parked object.
+    /// @param parked_object Parked object.
+    ///
+    /// @return New reference count.
+    /// @throw InvalidOperation if the object is not parked.
+    template<typename T>
+    int reference(T parked_object) {
+        util::thread::MultiThreadingLock lock(*mutex_);
+        ParkingInfoMap::iterator info = parking_.find(parked_object.get());
+        if (info == parking_.end()) {
+            isc_throw(InvalidOperation, "unable to reference an object"
+                      " which has not been parked");
+        }
+        return (++info->second.refcount_);
+    }
+
+    /// @brief Decreases the reference count of the parked object and
+    /// unparks it when the count drops to zero.
+    ///
+    /// When the object is unparked, it is removed from the parking lot
+    /// and the callback is invoked.
+    ///
+    /// @tparam Type of the parked object.
+    /// @param parked_object Parked object.
+    /// @param force Unpark the object regardless of the reference count.
+    ///
+    /// @return false if the object is not parked, true otherwise.
+    template<typename T>
+    bool unpark(T parked_object, bool force = false) {
+        boost::function<void()> unpark_callback;
+        {
+            util::thread::MultiThreadingLock lock(*mutex_);
+            ParkingInfoMap::iterator info = parking_.find(parked_object.get());
+            if (info == parking_.end()) {
+                return (false);
+            }
+            if (!force && (--info->second.refcount_ > 0)) {
+                return (true);
+            }
+            unpark_callback = info->second.unpark_callback_;
+            parking_.erase(info);
+        }
+
+        // The callback usually resumes the processing of the packet, so it
+        // is invoked without the mutex.
+        if (unpark_callback) {
+            unpark_callback();
+        }
+        return (true);
+    }
+
+    /// @brief Removes the object from the parking lot without invoking
+    /// the callback.
+    ///
+    /// @tparam Type of the parked object.
+    /// @param parked_object Parked object.
+    ///
+    /// @return false if the object is not parked, true otherwise.
+    template<typename T>
+    bool drop(T parked_object) {
+        util::thread::MultiThreadingLock lock(*mutex_);
+        return (parking_.erase(parked_object.get()) > 0);
+    }
+
+    /// @brief Returns the number of parked objects.
+    size_t size() const;
+
+    /// @brief Removes all parked objects without invoking the callbacks.
+    void clear();
+
+private:
+
+    /// @brief Parked object and its callback.
+    struct ParkingInfo {
+
+        /// @brief Constructor.
+        ///
+        /// @param parked_object Parked object.
+        /// @param unpark_callback Callback invoked when the object is
+        /// unparked.
+        ParkingInfo(const boost::any& parked_object,
+                    const boost::function<void()>& unpark_callback)
+            : parked_object_(parked_object), unpark_callback_(unpark_callback),
+              refcount_(0) {
+        }
+
+        /// @brief Parked object, held to keep it in existence.
+        boost::any parked_object_;
+
+        /// @brief Callback invoked when the object is unparked.
+        boost::function<void()> unpark_callback_;
+
+        /// @brief Number of callouts which are going to unpark the object.
+        int refcount_;
+    };
+
+    /// @brief Parked objects by the address of the pointed-to object.
+    typedef std::map<const void*, ParkingInfo> ParkingInfoMap;
+
+    /// @brief Parked objects.
+    ParkingInfoMap parking_;
+
+    /// @brief Mutex protecting the parked objects.
+    boost::scoped_ptr<util::thread::Mutex> mutex_;
+};
+
+/// @brief Pointer to the parking lot.
+typedef boost::shared_ptr<ParkingLot> ParkingLotPtr;
+
+/// @brief Restricted view of the parking lot used by the callouts.
+///
+/// The callouts can reference, unpark and drop the parked objects but
+/// they can't park them: the objects are parked by the server.
+class ParkingLotHandle {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// @param parking_lot Parking lot of the hook point.
+    explicit ParkingLotHandle(const ParkingLotPtr& parking_lot)
+        : parking_lot_(parking_lot) {
+    }
+
+    /// @brief Increases the reference count of the parked object.
+    ///
+    /// A callout which returns the @c CalloutHandle::NEXT_STEP_PARK
+    /// status must call it before the asynchronous operation is started.
+    ///
+    /// @tparam Type of the parked object.
+    /// @param parked_object Parked object.
+    ///
+    /// @return New reference count.
+    /// @throw InvalidOperation if the object is not parked.
+    template<typename T>
+    int reference(T parked_object) {
+        return (parking_lot_->reference(parked_object));
+    }
+
+    /// @brief Signals that the callout is done with the parked object.
+    ///
+    /// The object is unparked and its processing is resumed when all the
+    /// callouts which have referenced it have unparked it.
+    ///
+    /// @tparam Type of the parked object.
+    /// @param parked_object Parked object.
+    ///
+    /// @return false if the object is not parked, true otherwise.
+    template<typename T>
+    bool unpark(T parked_object) {
+        return (parking_lot_->unpark(parked_object));
+    }
+
+    /// @brief Removes the parked object, so its processing is not resumed.
+    ///
+    /// @tparam Type of the parked object.
+    /// @param parked_object Parked object.
+    ///
+    /// @return false if the object is not parked, true otherwise.
+    template<typename T>
+    bool drop(T parked_object) {
+        return (parking_lot_->drop(parked_object));
+    }
+
+private:
+
+    /// @brief Parking lot of the hook point.
+    ParkingLotPtr parking_lot_;
+};
+
+/// @brief Pointer to the parking lot handle.
+typedef boost::shared_ptr<ParkingLotHandle> ParkingLotHandlePtr;
+
+/// @brief Collection of the parking lots of the hook points.
+///
+/// The parking lot of a hook point is created on first use.
+class ParkingLots : public boost::noncopyable {
+public:
+
+    /// @brief Constructor.
+    ParkingLots();
+
+    /// @brief Returns the parking lot of the hook point.
+    ///
+    /// @param hook_index Index of the hook point.
+    ///
+    /// @return Pointer to the parking lot.
+    ParkingLotPtr getParkingLotPtr(const int hook_index);
+
+    /// @brief Removes the parked objects from all parking lots.
+    ///
+    /// It is called when the hooks libraries are unloaded, because the
+    /// callbacks of the parked objects may hold resources of the
+    /// libraries.
+    void clear();
+
+private:
+
+    /// @brief Parking lots by hook index.
+    std::map<int, ParkingLotPtr> parking_lots_;
+
+    /// @brief Mutex protecting the collection.
+    boost::scoped_ptr<util::thread::Mutex> mutex_;
+};
+
+/// @brief Pointer to the collection of the parking lots.
+typedef boost::shared_ptr<ParkingLots> ParkingLotsPtr;
+
+} // end of namespace hooks
+} // end of namespace isc
+
+#endif // PARKING_LOTS_H
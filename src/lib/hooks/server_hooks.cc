@@ -83,6 +83,9 @@ ServerHooks::initialize() {
     hooks_.clear();
     inverse_hooks_.clear();
 
+    // The parked objects belong to the hooks being cleared.
+    parking_lots_.reset(new ParkingLots());
+
     // Register the pre-defined hooks.
     int create = registerHook("context_create");
     int destroy = registerHook("context_destroy");
@@ -8,6 +8,7 @@
 #define SERVER_HOOKS_H
 
 #include <exceptions/exceptions.h>
+#include <hooks/parking_lots.h>
 
 #include <boost/noncopyable.hpp>
 #include <boost/shared_ptr.hpp>
@@ -140,6 +141,13 @@ public:
     /// @return Vector of strings holding hook names.
     std::vector<std::string> getHookNames() const;
 
+    /// @brief Returns the parking lots of the hook points.
+    ///
+    /// @return Pointer to the collection of the parking lots.
+    ParkingLotsPtr getParkingLotsPtr() const {
+        return (parking_lots_);
+    }
+
     /// @brief Return ServerHooks object
     ///
     /// Returns the global ServerHooks object.
@@ -216,6 +224,8 @@ private:
     /// simpler than using a multi-indexed container.)
     HookCollection  hooks_;                 ///< Hook name/index collection
     InverseHookCollection inverse_hooks_;   ///< Hook index/name collection
+
+    ParkingLotsPtr parking_lots_;           ///< Parking lots of the hooks
 };
 
 } // namespace util
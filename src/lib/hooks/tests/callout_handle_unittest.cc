@@ -299,6 +299,60 @@ TEST_F(CalloutHandleTest, DeleteAllArguments) {
     EXPECT_THROW(handle.getArgument("four", value), NoSuchArgument);
 }
 
+// Test that the arguments can be set again after they have been deleted,
+// with the same or different names and types.
+
+TEST_F(CalloutHandleTest, ReuseArguments) {
+    CalloutHandle handle(getCalloutManager());
+
+    int value = 0;
+    string text;
+
+    handle.setArgument("one", 1);
+    handle.setArgument("two", 2);
+    handle.setArgument("three", 3);
+
+    // Set the arguments again, in a different order and with a new name.
+    handle.deleteAllArguments();
+    handle.setArgument("three", string("three"));
+    handle.setArgument("one", 11);
+    handle.setArgument("four", 4);
+
+    EXPECT_THROW(handle.getArgument("two", value), NoSuchArgument);
+    handle.getArgument("one", value);
+    EXPECT_EQ(11, value);
+    handle.getArgument("three", text);
+    EXPECT_EQ("three", text);
+    EXPECT_THROW(handle.getArgument("three", value), boost::bad_any_cast);
+    handle.getArgument("four", value);
+    EXPECT_EQ(4, value);
+
+    // Replace the value of an existing argument with the same type and
+    // with a different type.
+    handle.setArgument("one", 111);
+    handle.getArgument("one", value);
+    EXPECT_EQ(111, value);
+    handle.setArgument("four", string("four"));
+    handle.getArgument("four", text);
+    EXPECT_EQ("four", text);
+
+    // Delete an argument and set a new one.
+    handle.deleteArgument("one");
+    handle.setArgument("five", 5);
+    EXPECT_THROW(handle.getArgument("one", value), NoSuchArgument);
+    handle.getArgument("five", value);
+    EXPECT_EQ(5, value);
+    handle.getArgument("three", text);
+    EXPECT_EQ("three", text);
+
+    vector<string> names = handle.getArgumentNames();
+    sort(names.begin(), names.end());
+    ASSERT_EQ(3, names.size());
+    EXPECT_EQ("five", names[0]);
+    EXPECT_EQ("four", names[1]);
+    EXPECT_EQ("three", names[2]);
+}
+
 // Test the "status" field.
 TEST_F(CalloutHandleTest, StatusField) {
     CalloutHandle handle(getCalloutManager());
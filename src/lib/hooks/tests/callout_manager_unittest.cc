@@ -9,15 +9,22 @@
 #include <hooks/callout_manager.h>
 #include <hooks/library_handle.h>
 #include <hooks/server_hooks.h>
+#include <util/boost_time_utils.h>
+#include <util/threads/thread.h>
 
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <gtest/gtest.h>
 
 #include <algorithm>
 #include <climits>
+#include <iostream>
 #include <string>
 #include <vector>
 
+#include <sched.h>
+
 /// @file
 /// @brief CalloutManager and LibraryHandle tests
 ///
@@ -28,6 +35,9 @@
 
 using namespace isc;
 using namespace isc::hooks;
+using namespace isc::util;
+using namespace isc::util::thread;
+using namespace boost::posix_time;
 using namespace std;
 
 namespace {
@@ -158,6 +168,31 @@ int callout_four_error(CalloutHandle& handle) {
     return (1);
 }
 
+// The next functions check that the callout sees the index of its library
+// and its hook, counting the failures in the "failures" argument.
+
+int callout_check_indexes(CalloutHandle& handle, int library_index) {
+    handle.setContext("library", library_index);
+    // Give the other threads a chance to run.
+    sched_yield();
+    int context = -1;
+    handle.getContext("library", context);
+    if ((context != library_index) || (handle.getHookName() != "alpha")) {
+        int failures = 0;
+        handle.getArgument("failures", failures);
+        handle.setArgument("failures", failures + 1);
+    }
+    return (0);
+}
+
+int callout_check_indexes_one(CalloutHandle& handle) {
+    return (callout_check_indexes(handle, 1));
+}
+
+int callout_check_indexes_two(CalloutHandle& handle) {
+    return (callout_check_indexes(handle, 2));
+}
+
 };  // extern "C"
 
 // *** Callout Tests ***
@@ -921,4 +956,85 @@ TEST_F(CalloutManagerTest, LibraryHandleRegisterCommandHandler) {
 // set of tests, as access restrictions mean it is not easily tested
 // on its own.
 
+// Calls the callouts of the hook in a loop, as the threads processing the
+// packets do, and returns the number of failures reported by the callouts.
+void
+callCalloutsInLoop(boost::shared_ptr<CalloutManager> manager, int hook_index,
+                   int* failures) {
+    CalloutHandle handle(manager);
+    *failures = 0;
+    for (int i = 0; i < 10000; ++i) {
+        handle.setArgument("failures", 0);
+        manager->callCallouts(hook_index, handle);
+        int call_failures = 0;
+        handle.getArgument("failures", call_failures);
+        *failures += call_failures;
+    }
+}
+
+// Check that the callouts called by several threads at the same time see
+// the indexes of their own library and hook.
+
+TEST_F(CalloutManagerTest, CallCalloutsMultipleThreads) {
+    getCalloutManager()->setLibraryIndex(1);
+    getCalloutManager()->registerCallout("alpha", callout_check_indexes_one);
+    getCalloutManager()->setLibraryIndex(2);
+    getCalloutManager()->registerCallout("alpha", callout_check_indexes_two);
+    getCalloutManager()->setLibraryIndex(-1);
+
+    int failures1 = -1;
+    int failures2 = -1;
+    Thread thread1(boost::bind(&callCalloutsInLoop, getCalloutManager(),
+                               alpha_index_, &failures1));
+    Thread thread2(boost::bind(&callCalloutsInLoop, getCalloutManager(),
+                               alpha_index_, &failures2));
+    thread1.wait();
+    thread2.wait();
+    EXPECT_EQ(0, failures1);
+    EXPECT_EQ(0, failures2);
+
+    // The indexes are not set outside the calls.
+    EXPECT_EQ(-1, getCalloutManager()->getHookIndex());
+    EXPECT_EQ(-1, getCalloutManager()->getLibraryIndex());
+}
+
+// This test measures the overhead of calling a hook, as the server does
+// it: the arguments are set and the callouts are called.  It is disabled,
+// because it only reports the time.
+
+TEST_F(CalloutManagerTest, DISABLED_performanceCallCallouts) {
+    const int calls = 1000000;
+    CalloutHandle& handle = getCalloutHandle();
+    boost::shared_ptr<int> pkt(new int(1));
+    boost::shared_ptr<int> lease(new int(2));
+
+    // The hook "alpha" has no callouts, the hook "beta" has one callout
+    // and the hook "gamma" has three callouts from two libraries.
+    getCalloutManager()->setLibraryIndex(1);
+    getCalloutManager()->registerCallout("beta", callout_one);
+    getCalloutManager()->registerCallout("gamma", callout_one);
+    getCalloutManager()->registerCallout("gamma", callout_two);
+    getCalloutManager()->setLibraryIndex(2);
+    getCalloutManager()->registerCallout("gamma", callout_three);
+
+    const int hooks[] = { alpha_index_, beta_index_, gamma_index_ };
+    for (int h = 0; h < sizeof(hooks) / sizeof(hooks[0]); ++h) {
+        ptime before = microsec_clock::local_time();
+        for (int i = 0; i < calls; ++i) {
+            callout_value_ = 0;
+            handle.deleteAllArguments();
+            handle.setArgument("query4", pkt);
+            handle.setArgument("lease4", lease);
+            handle.setArgument("fake_allocation", false);
+            getCalloutManager()->callCallouts(hooks[h], handle);
+        }
+        time_duration dur = microsec_clock::local_time() - before;
+        std::cout << calls << " calls of the hook with "
+                  << (h == 0 ? 0 : 2 * h - 1) << " callouts took: "
+                  << durationToText(dur) << ", "
+                  << dur.total_nanoseconds() / calls << " ns per call"
+                  << std::endl;
+    }
+}
+
 } // Anonymous namespace
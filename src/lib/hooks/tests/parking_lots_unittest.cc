@@ -0,0 +1,168 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <hooks/callout_handle.h>
+#include <hooks/callout_manager.h>
+#include <hooks/parking_lots.h>
+#include <hooks/server_hooks.h>
+
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <gtest/gtest.h>
+
+#include <string>
+
+using namespace isc;
+using namespace isc::hooks;
+
+namespace {
+
+/// @brief Parked object used by the tests.
+typedef boost::shared_ptr<std::string> StringPtr;
+
+/// @brief Test fixture class for the parking lots.
+class ParkingLotsTest : public ::testing::Test {
+public:
+
+    /// @brief Constructor.
+    ParkingLotsTest() : unparked_(0) {
+    }
+
+    /// @brief Callback invoked when the object is unparked.
+    void unparkCallback() {
+        ++unparked_;
+    }
+
+    /// @brief Returns the callback incrementing the @c unparked_ counter.
+    boost::function<void()> getCallback() {
+        return (boost::bind(&ParkingLotsTest::unparkCallback, this));
+    }
+
+    /// @brief Number of callbacks invoked.
+    int unparked_;
+};
+
+// Checks that the object is unparked when all references are released.
+TEST_F(ParkingLotsTest, referenceUnpark) {
+    ParkingLotPtr parking_lot(new ParkingLot());
+    StringPtr parked(new std::string("parked"));
+
+    ASSERT_NO_THROW(parking_lot->park(parked, getCallback()));
+    EXPECT_EQ(1, parking_lot->size());
+    EXPECT_THROW(parking_lot->park(parked, getCallback()), InvalidOperation);
+
+    // Two callouts are going to unpark the object.
+    ParkingLotHandle handle(parking_lot);
+    EXPECT_EQ(1, handle.reference(parked));
+    EXPECT_EQ(2, handle.reference(parked));
+
+    EXPECT_TRUE(handle.unpark(parked));
+    EXPECT_EQ(0, unparked_);
+    EXPECT_EQ(1, parking_lot->size());
+
+    EXPECT_TRUE(handle.unpark(parked));
+    EXPECT_EQ(1, unparked_);
+    EXPECT_EQ(0, parking_lot->size());
+
+    // The object is not parked anymore.
+    EXPECT_FALSE(handle.unpark(parked));
+    EXPECT_THROW(handle.reference(parked), InvalidOperation);
+    EXPECT_EQ(1, unparked_);
+}
+
+// Checks that the object can be unparked regardless of the references.
+TEST_F(ParkingLotsTest, forceUnpark) {
+    ParkingLot parking_lot;
+    StringPtr parked(new std::string("parked"));
+
+    ASSERT_NO_THROW(parking_lot.park(parked, getCallback()));
+    parking_lot.reference(parked);
+    parking_lot.reference(parked);
+    EXPECT_TRUE(parking_lot.unpark(parked, true));
+    EXPECT_EQ(1, unparked_);
+    EXPECT_EQ(0, parking_lot.size());
+}
+
+// Checks that the dropped objects are not unparked.
+TEST_F(ParkingLotsTest, drop) {
+    ParkingLot parking_lot;
+    StringPtr parked1(new std::string("parked"));
+    StringPtr parked2(new std::string("parked"));
+
+    ASSERT_NO_THROW(parking_lot.park(parked1, getCallback()));
+    ASSERT_NO_THROW(parking_lot.park(parked2, getCallback()));
+    EXPECT_EQ(2, parking_lot.size());
+
+    // The objects are distinguished by the address, not by the value.
+    EXPECT_TRUE(parking_lot.drop(parked1));
+    EXPECT_FALSE(parking_lot.drop(parked1));
+    EXPECT_FALSE(parking_lot.unpark(parked1));
+    EXPECT_EQ(1, parking_lot.size());
+
+    parking_lot.clear();
+    EXPECT_EQ(0, parking_lot.size());
+    EXPECT_FALSE(parking_lot.unpark(parked2));
+    EXPECT_EQ(0, unparked_);
+}
+
+// Checks that there is one parking lot per hook and that the parked
+// objects are removed when the parking lots are cleared.
+TEST_F(ParkingLotsTest, parkingLots) {
+    ParkingLots parking_lots;
+    ParkingLotPtr parking_lot = parking_lots.getParkingLotPtr(1);
+    ASSERT_TRUE(parking_lot);
+    EXPECT_TRUE(parking_lot == parking_lots.getParkingLotPtr(1));
+    EXPECT_FALSE(parking_lot == parking_lots.getParkingLotPtr(2));
+
+    StringPtr parked(new std::string("parked"));
+    ASSERT_NO_THROW(parking_lot->park(parked, getCallback()));
+    parking_lots.clear();
+    EXPECT_EQ(0, parking_lot->size());
+    EXPECT_EQ(0, unparked_);
+}
+
+// Callout taking the reference to the parked object and parking it.
+extern "C" int
+park_callout(CalloutHandle& handle) {
+    StringPtr parked;
+    handle.getArgument("parked", parked);
+    handle.getParkingLotHandlePtr()->reference(parked);
+    handle.setStatus(CalloutHandle::NEXT_STEP_PARK);
+    return (0);
+}
+
+// Checks that the callouts get the parking lot of their hook.
+TEST_F(ParkingLotsTest, calloutHandle) {
+    ServerHooks& hooks = ServerHooks::getServerHooks();
+    hooks.reset();
+    int hook_index = hooks.registerHook("alpha");
+
+    boost::shared_ptr<CalloutManager> manager(new CalloutManager(1));
+    manager->setLibraryIndex(1);
+    manager->registerCallout("alpha", park_callout);
+    CalloutHandle handle(manager);
+
+    // The parking lot is only available to the callouts.
+    EXPECT_THROW(handle.getParkingLotHandlePtr(), NoSuchHook);
+
+    // The server parks the object and calls the callouts.
+    StringPtr parked(new std::string("parked"));
+    ParkingLotPtr parking_lot =
+        hooks.getParkingLotsPtr()->getParkingLotPtr(hook_index);
+    parking_lot->park(parked, getCallback());
+    handle.setArgument("parked", parked);
+    manager->callCallouts(hook_index, handle);
+    ASSERT_EQ(CalloutHandle::NEXT_STEP_PARK, handle.getStatus());
+
+    // The callout has referenced the object, so it is unparked by the
+    // library.
+    EXPECT_TRUE(parking_lot->unpark(parked));
+    EXPECT_EQ(1, unparked_);
+}
+
+} // end of anonymous namespace
@@ -9,6 +9,7 @@
 #include <cc/data.h>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/date_time/gregorian/gregorian.hpp>
+#include <algorithm>
 #include <utility>
 
 using namespace std;
@@ -18,23 +19,37 @@ using namespace boost::posix_time;
 namespace isc {
 namespace stats {
 
+const uint32_t Observation::DEFAULT_MAX_AGED_SAMPLES;
+
 Observation::Observation(const std::string& name, const int64_t value)
-    :name_(name), type_(STAT_INTEGER) {
+    :name_(name), type_(STAT_INTEGER),
+     max_sample_age_(false, StatsDuration(0, 0, 0, 0)),
+     max_aged_samples_(DEFAULT_MAX_AGED_SAMPLES),
+     max_sample_count_(true, 1) {
     setValue(value);
 }
 
 Observation::Observation(const std::string& name, const double value)
-    :name_(name), type_(STAT_FLOAT) {
+    :name_(name), type_(STAT_FLOAT),
+     max_sample_age_(false, StatsDuration(0, 0, 0, 0)),
+     max_aged_samples_(DEFAULT_MAX_AGED_SAMPLES),
+     max_sample_count_(true, 1) {
     setValue(value);
 }
 
 Observation::Observation(const std::string& name, const StatsDuration& value)
-    :name_(name), type_(STAT_DURATION) {
+    :name_(name), type_(STAT_DURATION),
+     max_sample_age_(false, StatsDuration(0, 0, 0, 0)),
+     max_aged_samples_(DEFAULT_MAX_AGED_SAMPLES),
+     max_sample_count_(true, 1) {
     setValue(value);
 }
 
 Observation::Observation(const std::string& name, const std::string& value)
-    :name_(name), type_(STAT_STRING) {
+    :name_(name), type_(STAT_STRING),
+     max_sample_age_(false, StatsDuration(0, 0, 0, 0)),
+     max_aged_samples_(DEFAULT_MAX_AGED_SAMPLES),
+     max_sample_count_(true, 1) {
     setValue(value);
 }
 
@@ -83,15 +98,105 @@ void Observation::setValueInternal(SampleType value, StorageType& storage,
                   << typeToText(type_) );
     }
 
-    if (storage.empty()) {
-        storage.push_back(make_pair(value, microsec_clock::local_time()));
-    } else {
+    ptime now = microsec_clock::local_time();
+    if (max_sample_age_.first) {
+        // Discard the expired samples. When all samples are still valid,
+        // make room for the new one unless the buffer has reached its
+        // maximum size. The oldest sample is then overwritten.
+        while (!storage.empty() &&
+               (now - storage.back().second > max_sample_age_.second)) {
+            storage.pop_back();
+        }
+        if (storage.full() && (storage.capacity() < max_aged_samples_)) {
+            storage.set_capacity(std::min(std::max(storage.capacity() * 2,
+                                                   static_cast<size_t>(1)),
+                                          static_cast<size_t>(max_aged_samples_)));
+        }
+    } else if (storage.capacity() != max_sample_count_.second) {
+        storage.set_capacity(max_sample_count_.second);
+    }
+
+    // The most recent sample is at the front. The oldest sample is
+    // overwritten when the buffer is full.
+    storage.push_front(make_pair(value, now));
+}
+
+void Observation::setMaxSampleAge(const StatsDuration& duration,
+                                  uint32_t max_samples) {
+    if (max_samples == 0) {
+        isc_throw(BadValue, "the maximum number of samples of the statistic "
+                  << name_ << " must be greater than 0");
+    }
+    max_sample_age_ = make_pair(true, duration);
+    max_aged_samples_ = max_samples;
+    max_sample_count_.first = false;
+    applyLimits();
+}
+
+void Observation::setMaxSampleCount(uint32_t max_samples) {
+    if (max_samples == 0) {
+        isc_throw(BadValue, "the maximum number of samples of the statistic "
+                  << name_ << " must be greater than 0");
+    }
+    max_sample_count_ = make_pair(true, max_samples);
+    max_sample_age_.first = false;
+    applyLimits();
+}
 
-        /// @todo: Update once more than one sample is supported
-        *storage.begin() = make_pair(value, microsec_clock::local_time());
+template<typename StorageType>
+void Observation::applyLimitsInternal(StorageType& storage) {
+    if (max_sample_age_.first) {
+        ptime now = microsec_clock::local_time();
+        while ((storage.size() > 1) &&
+               (now - storage.back().second > max_sample_age_.second)) {
+            storage.pop_back();
+        }
+        // The buffer may have been larger with the previous limits.
+        if (storage.capacity() > max_aged_samples_) {
+            storage.set_capacity(max_aged_samples_);
+        }
+    } else {
+        // Shrinking the buffer discards the oldest samples.
+        storage.set_capacity(max_sample_count_.second);
     }
 }
 
+void Observation::applyLimits() {
+    switch (type_) {
+    case STAT_INTEGER:
+        applyLimitsInternal(integer_samples_);
+        return;
+    case STAT_FLOAT:
+        applyLimitsInternal(float_samples_);
+        return;
+    case STAT_DURATION:
+        applyLimitsInternal(duration_samples_);
+        return;
+    case STAT_STRING:
+        applyLimitsInternal(string_samples_);
+        return;
+    default:
+        isc_throw(InvalidStatType, "Unknown statistic type: "
+                  << typeToText(type_));
+    };
+}
+
+size_t Observation::getSize() const {
+    switch (type_) {
+    case STAT_INTEGER:
+        return (integer_samples_.size());
+    case STAT_FLOAT:
+        return (float_samples_.size());
+    case STAT_DURATION:
+        return (duration_samples_.size());
+    case STAT_STRING:
+        return (string_samples_.size());
+    default:
+        isc_throw(InvalidStatType, "Unknown statistic type: "
+                  << typeToText(type_));
+    };
+}
+
 IntegerSample Observation::getInteger() const {
     return (getValueInternal<IntegerSample>(integer_samples_, STAT_INTEGER));
 }
@@ -108,6 +213,22 @@ StringSample Observation::getString() const {
     return (getValueInternal<StringSample>(string_samples_, STAT_STRING));
 }
 
+std::list<IntegerSample> Observation::getIntegers() const {
+    return (getValuesInternal<IntegerSample>(integer_samples_, STAT_INTEGER));
+}
+
+std::list<FloatSample> Observation::getFloats() const {
+    return (getValuesInternal<FloatSample>(float_samples_, STAT_FLOAT));
+}
+
+std::list<DurationSample> Observation::getDurations() const {
+    return (getValuesInternal<DurationSample>(duration_samples_, STAT_DURATION));
+}
+
+std::list<StringSample> Observation::getStrings() const {
+    return (getValuesInternal<StringSample>(string_samples_, STAT_STRING));
+}
+
 template<typename SampleType, typename Storage>
 SampleType Observation::getValueInternal(Storage& storage, Type exp_type) const {
     if (type_ != exp_type) {
@@ -125,6 +246,22 @@ SampleType Observation::getValueInternal(Storage& storage, Type exp_type) const
     return (*storage.begin());
 }
 
+template<typename SampleType, typename Storage>
+std::list<SampleType>
+Observation::getValuesInternal(Storage& storage, Type exp_type) const {
+    if (type_ != exp_type) {
+        isc_throw(InvalidStatType, "Invalid statistic type requested: "
+                  << typeToText(exp_type) << ", but the actual type is "
+                  << typeToText(type_) );
+    }
+
+    if (storage.empty()) {
+        // That should never happen. See getValueInternal.
+        isc_throw(Unexpected, "Observation storage container empty");
+    }
+    return (std::list<SampleType>(storage.begin(), storage.end()));
+}
+
 std::string Observation::typeToText(Type type) {
     std::stringstream tmp;
     switch (type) {
@@ -148,70 +285,91 @@ std::string Observation::typeToText(Type type) {
     return (tmp.str());
 }
 
+namespace {
+
+/// @brief Appends the samples to the list in the JSON format.
+///
+/// @tparam SampleType type of sample (e.g. IntegerSample)
+/// @tparam Converter type of the function converting the value
+/// @param samples samples, the most recent first
+/// @param list the list the samples are appended to
+/// @param to_element converts the value to the JSON element
+template<typename SampleType, typename Converter>
+void samplesToJSON(const std::list<SampleType>& samples, ElementPtr list,
+                   Converter to_element) {
+    for (typename std::list<SampleType>::const_iterator s = samples.begin();
+         s != samples.end(); ++s) {
+        ElementPtr entry = Element::createList();
+        entry->add(to_element(s->first));
+        entry->add(Element::create(isc::util::ptimeToText(s->second)));
+        list->add(entry);
+    }
+}
+
+ElementPtr integerToElement(const int64_t value) {
+    return (Element::create(static_cast<int64_t>(value)));
+}
+
+ElementPtr floatToElement(const double value) {
+    return (Element::create(value));
+}
+
+ElementPtr durationToElement(const StatsDuration& value) {
+    return (Element::create(isc::util::durationToText(value)));
+}
+
+ElementPtr stringToElement(const std::string& value) {
+    return (Element::create(value));
+}
+
+}
+
 isc::data::ConstElementPtr
 Observation::getJSON() const {
 
-    ElementPtr entry = isc::data::Element::createList(); // a single observation
-    ElementPtr value;
-    ElementPtr timestamp;
-
-    /// @todo: Add support for retrieving more than one sample for a given
-    /// observation
+    // The list of [value, timestamp] entries, the most recent first.
+    ElementPtr list = isc::data::Element::createList();
 
     switch (type_) {
-    case STAT_INTEGER: {
-        IntegerSample s = getInteger();
-        value = isc::data::Element::create(static_cast<int64_t>(s.first));
-        timestamp = isc::data::Element::create(isc::util::ptimeToText(s.second));
+    case STAT_INTEGER:
+        samplesToJSON(getIntegers(), list, integerToElement);
         break;
-    }
-    case STAT_FLOAT: {
-        FloatSample s = getFloat();
-        value = isc::data::Element::create(s.first);
-        timestamp = isc::data::Element::create(isc::util::ptimeToText(s.second));
+    case STAT_FLOAT:
+        samplesToJSON(getFloats(), list, floatToElement);
         break;
-    }
-    case STAT_DURATION: {
-        DurationSample s = getDuration();
-        value = isc::data::Element::create(isc::util::durationToText(s.first));
-        timestamp = isc::data::Element::create(isc::util::ptimeToText(s.second));
+    case STAT_DURATION:
+        samplesToJSON(getDurations(), list, durationToElement);
         break;
-    }
-    case STAT_STRING: {
-        StringSample s = getString();
-        value = isc::data::Element::create(s.first);
-        timestamp = isc::data::Element::create(isc::util::ptimeToText(s.second));
+    case STAT_STRING:
+        samplesToJSON(getStrings(), list, stringToElement);
         break;
-    }
     default:
         isc_throw(InvalidStatType, "Unknown statistic type: "
                   << typeToText(type_));
     };
 
-    entry->add(value);
-    entry->add(timestamp);
-
-    ElementPtr list = isc::data::Element::createList(); // a single observation
-    list->add(entry);
-
     return (list);
 }
 
 void Observation::reset() {
     switch(type_) {
     case STAT_INTEGER: {
+        integer_samples_.clear();
         setValue(static_cast<int64_t>(0));
         return;
     }
     case STAT_FLOAT: {
+        float_samples_.clear();
         setValue(0.0);
         return;
     }
     case STAT_DURATION: {
+        duration_samples_.clear();
         setValue(time_duration(0,0,0,0));
         return;
     }
     case STAT_STRING: {
+        string_samples_.clear();
         setValue(string(""));
         return;
     }
@@ -9,6 +9,7 @@
 
 #include <cc/data.h>
 #include <exceptions/exceptions.h>
+#include <boost/circular_buffer.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/date_time/time_duration.hpp>
 #include <boost/date_time/posix_time/posix_time_types.hpp>
@@ -66,8 +67,11 @@ typedef std::pair<std::string, boost::posix_time::ptime> StringSample;
 /// @ref getDuration, @ref getString (appropriate type must be used) or
 /// @ref getJSON, which is generic and can be used for all types.
 ///
-/// @todo: Eventually it will be possible to retain multiple samples for the same
-/// observation, but that is outside of scope for 0.9.2.
+/// By default only the most recent sample is kept. The observation can keep
+/// more samples, limited either by their number (see @ref setMaxSampleCount)
+/// or by their age (see @ref setMaxSampleAge). The samples are kept in ring
+/// buffers, so recording a sample doesn't allocate memory once the buffer
+/// has grown to hold all samples within the limit.
 class Observation {
  public:
 
@@ -86,6 +90,10 @@ class Observation {
         STAT_STRING   ///< this statistic represents a string
     };
 
+    /// @brief Default maximum number of samples kept when their age is
+    /// limited.
+    static const uint32_t DEFAULT_MAX_AGED_SAMPLES = 1024;
+
     /// @brief Constructor for integer observations
     ///
     /// @param name observation name
@@ -158,9 +166,60 @@ class Observation {
     /// @throw InvalidStatType if statistic is not a string
     void addValue(const std::string& value);
 
+    /// @brief Determines maximum age of samples.
+    ///
+    /// Specifies that the samples older than duration should be discarded.
+    /// The most recent sample is always kept. This disables the limit on the
+    /// number of samples set by @ref setMaxSampleCount. The memory used by
+    /// the samples is still bounded: no more than max_samples samples are
+    /// kept, so a statistic updated more often than max_samples times per
+    /// duration keeps the samples of a shorter period.
+    ///
+    /// @param duration maximum age of the samples
+    /// @param max_samples maximum number of the samples
+    /// @throw BadValue if max_samples is 0
+    void setMaxSampleAge(const StatsDuration& duration,
+                         uint32_t max_samples = DEFAULT_MAX_AGED_SAMPLES);
+
+    /// @brief Determines how many samples should be kept.
+    ///
+    /// When the sample is recorded and there are already max_samples
+    /// samples, the oldest one is discarded. This disables the limit on
+    /// the age of samples. The default is to keep one sample.
+    ///
+    /// @param max_samples maximum number of the samples
+    /// @throw BadValue if max_samples is 0
+    void setMaxSampleCount(uint32_t max_samples);
+
+    /// @brief Returns the maximum age of samples.
+    ///
+    /// @return pair of the flag indicating if the limit is in use and
+    /// the maximum age
+    std::pair<bool, StatsDuration> getMaxSampleAge() const {
+        return (max_sample_age_);
+    }
+
+    /// @brief Returns the maximum number of samples kept when their age
+    /// is limited.
+    uint32_t getMaxAgedSamples() const {
+        return (max_aged_samples_);
+    }
+
+    /// @brief Returns the maximum number of samples.
+    ///
+    /// @return pair of the flag indicating if the limit is in use and
+    /// the maximum number of samples
+    std::pair<bool, uint32_t> getMaxSampleCount() const {
+        return (max_sample_count_);
+    }
+
+    /// @brief Returns the number of samples currently kept.
+    size_t getSize() const;
+
     /// @brief Resets statistic.
     ///
-    /// Sets statistic to a neutral (0, 0.0 or "") value.
+    /// Discards all samples and sets statistic to a neutral (0, 0.0 or "")
+    /// value.
     void reset();
 
     /// @brief Returns statistic type
@@ -189,6 +248,26 @@ class Observation {
     /// @throw InvalidStatType if statistic is not a string
     StringSample getString() const;
 
+    /// @brief Returns all observed integer samples
+    /// @return list of the samples, the most recent first
+    /// @throw InvalidStatType if statistic is not integer
+    std::list<IntegerSample> getIntegers() const;
+
+    /// @brief Returns all observed float samples
+    /// @return list of the samples, the most recent first
+    /// @throw InvalidStatType if statistic is not fp
+    std::list<FloatSample> getFloats() const;
+
+    /// @brief Returns all observed duration samples
+    /// @return list of the samples, the most recent first
+    /// @throw InvalidStatType if statistic is not time duration
+    std::list<DurationSample> getDurations() const;
+
+    /// @brief Returns all observed string samples
+    /// @return list of the samples, the most recent first
+    /// @throw InvalidStatType if statistic is not a string
+    std::list<StringSample> getStrings() const;
+
     /// @brief Returns as a JSON structure
     /// @return JSON structures representing all observations
     isc::data::ConstElementPtr getJSON() const;
@@ -207,10 +286,11 @@ private:
     ///
     /// This method records an absolute value of an observation.
     /// It is used by public methods to add sample to one of
-    /// available storages.
+    /// available storages. The samples exceeding the limits are
+    /// discarded.
     ///
     /// @tparam SampleType type of sample (e.g. IntegerSample)
-    /// @tparam StorageType type of storage (e.g. list<IntegerSample>)
+    /// @tparam StorageType type of storage (e.g. circular_buffer<IntegerSample>)
     /// @param value observation to be recorded
     /// @param storage observation will be stored here
     /// @param exp_type expected observation type (used for sanity checking)
@@ -222,7 +302,7 @@ private:
     /// @brief Returns a sample (internal version)
     ///
     /// @tparam SampleType type of sample (e.g. IntegerSample)
-    /// @tparam StorageType type of storage (e.g. list<IntegerSample>)
+    /// @tparam StorageType type of storage (e.g. circular_buffer<IntegerSample>)
     /// @param observation storage
     /// @param exp_type expected observation type (used for sanity checking)
     /// @throw InvalidStatType if observation type mismatches
@@ -230,12 +310,51 @@ private:
     template<typename SampleType, typename Storage>
     SampleType getValueInternal(Storage& storage, Type exp_type) const;
 
+    /// @brief Returns all samples (internal version)
+    ///
+    /// @tparam SampleType type of sample (e.g. IntegerSample)
+    /// @tparam StorageType type of storage (e.g. circular_buffer<IntegerSample>)
+    /// @param observation storage
+    /// @param exp_type expected observation type (used for sanity checking)
+    /// @throw InvalidStatType if observation type mismatches
+    /// @return List of the samples, the most recent first
+    template<typename SampleType, typename Storage>
+    std::list<SampleType> getValuesInternal(Storage& storage,
+                                            Type exp_type) const;
+
+    /// @brief Discards the samples exceeding the limits (internal version)
+    ///
+    /// The most recent sample is always kept.
+    ///
+    /// @tparam StorageType type of storage (e.g. circular_buffer<IntegerSample>)
+    /// @param storage observation storage
+    template<typename StorageType>
+    void applyLimitsInternal(StorageType& storage);
+
+    /// @brief Discards the samples exceeding the limits
+    ///
+    /// It is called when the limits are changed.
+    void applyLimits();
+
     /// @brief Observation (statistic) name
     std::string name_;
 
     /// @brief Observation (statistic) type)
     Type type_;
 
+    /// @brief Maximum age of the samples
+    ///
+    /// The flag indicates if the limit is in use.
+    std::pair<bool, StatsDuration> max_sample_age_;
+
+    /// @brief Maximum number of the samples when their age is limited
+    uint32_t max_aged_samples_;
+
+    /// @brief Maximum number of the samples
+    ///
+    /// The flag indicates if the limit is in use.
+    std::pair<bool, uint32_t> max_sample_count_;
+
     /// @defgroup samples_storage Storage for supported observations
     ///
     /// @brief The following containers serve as a storage for all supported
@@ -244,16 +363,16 @@ private:
     /// @{
 
     /// @brief Storage for integer samples
-    std::list<IntegerSample> integer_samples_;
+    boost::circular_buffer<IntegerSample> integer_samples_;
 
     /// @brief Storage for floating point samples
-    std::list<FloatSample> float_samples_;
+    boost::circular_buffer<FloatSample> float_samples_;
 
     /// @brief Storage for time duration samples
-    std::list<DurationSample> duration_samples_;
+    boost::circular_buffer<DurationSample> duration_samples_;
 
     /// @brief Storage for string samples
-    std::list<StringSample> string_samples_;
+    boost::circular_buffer<StringSample> string_samples_;
     /// @}
 };
 
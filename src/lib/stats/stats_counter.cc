@@ -0,0 +1,49 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <stats/stats_counter.h>
+#include <stats/stats_mgr.h>
+#include <boost/functional/hash.hpp>
+#include <pthread.h>
+
+namespace isc {
+namespace stats {
+
+const size_t StatsCounter::SHARDS;
+
+StatsCounter::StatsCounter(const std::string& name)
+    : name_(name), sampled_(false) {
+}
+
+void StatsCounter::add(const int64_t value) {
+    if (isSampled()) {
+        StatsMgr::instance().addValue(name_, value);
+        return;
+    }
+
+    // The value is only read by fetchAndReset, which needs no ordering
+    // with the other memory accesses.
+    getShard().value_.fetch_add(value, std::memory_order_relaxed);
+}
+
+int64_t StatsCounter::fetchAndReset() {
+    int64_t sum = 0;
+    for (size_t i = 0; i < SHARDS; ++i) {
+        sum += shards_[i].value_.exchange(0, std::memory_order_relaxed);
+    }
+    return (sum);
+}
+
+StatsCounter::Shard& StatsCounter::getShard() {
+    // The thread identifiers are often aligned addresses, so the hash is
+    // mixed before the shard is selected.
+    uint64_t hash = boost::hash<pthread_t>()(pthread_self());
+    hash *= 0x9E3779B97F4A7C15ULL;
+    return (shards_[(hash >> 32) % SHARDS]);
+}
+
+};
+};
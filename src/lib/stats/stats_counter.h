@@ -0,0 +1,116 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef STATS_COUNTER_H
+#define STATS_COUNTER_H
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <atomic>
+#include <stdint.h>
+#include <string>
+
+namespace isc {
+namespace stats {
+
+/// @brief Handle of an integer statistic updated on the hot path.
+///
+/// Updating a statistic with @ref StatsMgr::addValue requires a lookup
+/// of the statistic by name and the exclusive lock of the statistics
+/// manager, which the packet processing threads compete for. A counter
+/// is obtained once with @ref StatsMgr::getCounter and is then updated
+/// without any lookup. The increments are accumulated in several atomic
+/// shards and the shard is selected by the calling thread, so the threads
+/// rarely update the same cache line.
+///
+/// The accumulated increments are moved to the observation of the same
+/// name by the statistics manager when the statistics are read, so the
+/// counter is transparent to the consumers of the values. The increments
+/// made between two reads would be recorded as a single sample, so the
+/// counter of a statistic which keeps more than one sample passes each
+/// increment to the statistics manager instead (see @ref setSampled).
+/// Such a counter is as costly to update as the statistic itself.
+class StatsCounter : public boost::noncopyable {
+public:
+
+    /// @brief Number of shards.
+    static const size_t SHARDS = 16;
+
+    /// @brief Constructor.
+    ///
+    /// @param name Name of the statistic.
+    explicit StatsCounter(const std::string& name);
+
+    /// @brief Returns the name of the statistic.
+    const std::string& getName() const {
+        return (name_);
+    }
+
+    /// @brief Adds the value to the counter.
+    ///
+    /// The value is added to the statistic when the counter records
+    /// samples.
+    ///
+    /// @param value Value to be added.
+    void add(const int64_t value = 1);
+
+    /// @brief Sets whether the counter records samples.
+    ///
+    /// It is called by the statistics manager when the sample limits of
+    /// the statistic are changed.
+    ///
+    /// @param sampled true if the values should be added to the statistic
+    /// one by one, false if they should be accumulated.
+    void setSampled(const bool sampled) {
+        sampled_.store(sampled, std::memory_order_relaxed);
+    }
+
+    /// @brief Checks whether the counter records samples.
+    bool isSampled() const {
+        return (sampled_.load(std::memory_order_relaxed));
+    }
+
+    /// @brief Returns the accumulated value and resets the counter.
+    ///
+    /// @return Sum of the values added since the previous call.
+    int64_t fetchAndReset();
+
+private:
+
+    /// @brief Part of the counter updated by a subset of the threads.
+    struct Shard {
+
+        /// @brief Constructor.
+        Shard() : value_(0) {
+        }
+
+        /// @brief Accumulated value.
+        std::atomic<int64_t> value_;
+
+        /// @brief Keeps the shards in separate cache lines.
+        char padding_[64 - sizeof(std::atomic<int64_t>)];
+    };
+
+    /// @brief Returns the shard used by the calling thread.
+    Shard& getShard();
+
+    /// @brief Name of the statistic.
+    std::string name_;
+
+    /// @brief Indicates if the values are added to the statistic one by one.
+    std::atomic<bool> sampled_;
+
+    /// @brief The shards.
+    Shard shards_[SHARDS];
+};
+
+/// @brief Pointer to the counter.
+typedef boost::shared_ptr<StatsCounter> StatsCounterPtr;
+
+};
+};
+
+#endif // STATS_COUNTER_H
@@ -8,10 +8,13 @@
 #include <stats/stats_mgr.h>
 #include <cc/data.h>
 #include <cc/command_interpreter.h>
+#include <util/threads/multi_threading_mgr.h>
+#include <limits>
 
 using namespace std;
 using namespace isc::data;
 using namespace isc::config;
+using namespace isc::util::thread;
 
 namespace isc {
 namespace stats {
@@ -22,42 +25,70 @@ StatsMgr& StatsMgr::instance() {
 }
 
 StatsMgr::StatsMgr()
-    :global_(new StatContext()) {
+    :global_(new StatContext()), mutex_(new Mutex()) {
 
 }
 
 void StatsMgr::setValue(const std::string& name, const int64_t value) {
+    MultiThreadingLock lock(*mutex_);
+    discardCounter(name);
     setValueInternal(name, value);
 }
 
 void StatsMgr::setValue(const std::string& name, const double value) {
+    MultiThreadingLock lock(*mutex_);
+    discardCounter(name);
     setValueInternal(name, value);
 }
 
 void StatsMgr::setValue(const std::string& name, const StatsDuration& value) {
+    MultiThreadingLock lock(*mutex_);
+    discardCounter(name);
     setValueInternal(name, value);
 }
 void StatsMgr::setValue(const std::string& name, const std::string& value) {
+    MultiThreadingLock lock(*mutex_);
+    discardCounter(name);
     setValueInternal(name, value);
 }
 
 void StatsMgr::addValue(const std::string& name, const int64_t value) {
+    MultiThreadingLock lock(*mutex_);
     addValueInternal(name, value);
 }
 
 void StatsMgr::addValue(const std::string& name, const double value) {
+    MultiThreadingLock lock(*mutex_);
     addValueInternal(name, value);
 }
 
 void StatsMgr::addValue(const std::string& name, const StatsDuration& value) {
+    MultiThreadingLock lock(*mutex_);
     addValueInternal(name, value);
 }
 
 void StatsMgr::addValue(const std::string& name, const std::string& value) {
+    MultiThreadingLock lock(*mutex_);
     addValueInternal(name, value);
 }
 
+StatsCounterPtr StatsMgr::getCounter(const std::string& name) {
+    MultiThreadingLock lock(*mutex_);
+    StatsCounterPtr& counter = counters_[name];
+    if (!counter) {
+        counter.reset(new StatsCounter(name));
+        updateCounterSampling(name, getObservationInternal(name));
+    }
+    return (counter);
+}
+
 ObservationPtr StatsMgr::getObservation(const std::string& name) const {
+    MultiThreadingLock lock(*mutex_);
+    flushCounters();
+    return (getObservationInternal(name));
+}
+
+ObservationPtr StatsMgr::getObservationInternal(const std::string& name) const {
     /// @todo: Implement contexts.
     // Currently we keep everything in a global context.
     return (global_->get(name));
@@ -69,23 +100,92 @@ void StatsMgr::addObservation(const ObservationPtr& stat) {
     return (global_->add(stat));
 }
 
+void StatsMgr::flushCounters() const {
+    for (std::map<std::string, StatsCounterPtr>::const_iterator c =
+             counters_.begin(); c != counters_.end(); ++c) {
+        int64_t value = c->second->fetchAndReset();
+        if (value == 0) {
+            continue;
+        }
+        ObservationPtr stat = getObservationInternal(c->first);
+        if (stat) {
+            // The values can't be added to the statistic of another type
+            // and there is no caller to report that to, so they are dropped.
+            if (stat->getType() == Observation::STAT_INTEGER) {
+                stat->addValue(value);
+            }
+        } else {
+            /// @todo: Implement contexts.
+            // Currently we keep everything in a global context.
+            global_->add(ObservationPtr(new Observation(c->first, value)));
+        }
+    }
+}
+
+void StatsMgr::updateCounterSampling(const std::string& name,
+                                     const ObservationPtr& obs) {
+    std::map<std::string, StatsCounterPtr>::const_iterator c =
+        counters_.find(name);
+    if (c != counters_.end()) {
+        c->second->setSampled(obs && (obs->getMaxSampleAge().first ||
+                                      (obs->getMaxSampleCount().second > 1)));
+    }
+}
+
+void StatsMgr::discardCounter(const std::string& name) {
+    std::map<std::string, StatsCounterPtr>::const_iterator c =
+        counters_.find(name);
+    if (c != counters_.end()) {
+        c->second->fetchAndReset();
+    }
+}
+
+void StatsMgr::discardCounters() {
+    for (std::map<std::string, StatsCounterPtr>::const_iterator c =
+             counters_.begin(); c != counters_.end(); ++c) {
+        c->second->fetchAndReset();
+    }
+}
+
 bool StatsMgr::deleteObservation(const std::string& name) {
     /// @todo: Implement contexts.
     // Currently we keep everything in a global context.
     return (global_->del(name));
 }
 
-void StatsMgr::setMaxSampleAge(const std::string& ,
-                               const StatsDuration&) {
-    isc_throw(NotImplemented, "setMaxSampleAge not implemented");
+bool StatsMgr::setMaxSampleAge(const std::string& name,
+                               const StatsDuration& duration,
+                               uint32_t max_samples) {
+    MultiThreadingLock lock(*mutex_);
+    flushCounters();
+    ObservationPtr obs = getObservationInternal(name);
+    if (obs) {
+        obs->setMaxSampleAge(duration, max_samples);
+        updateCounterSampling(name, obs);
+        return (true);
+    } else {
+        return (false);
+    }
 }
 
-void StatsMgr::setMaxSampleCount(const std::string& , uint32_t){
-    isc_throw(NotImplemented, "setMaxSampleCount not implemented");
+bool StatsMgr::setMaxSampleCount(const std::string& name,
+                                 uint32_t max_samples) {
+    MultiThreadingLock lock(*mutex_);
+    flushCounters();
+    ObservationPtr obs = getObservationInternal(name);
+    if (obs) {
+        obs->setMaxSampleCount(max_samples);
+        updateCounterSampling(name, obs);
+        return (true);
+    } else {
+        return (false);
+    }
 }
 
 bool StatsMgr::reset(const std::string& name) {
-    ObservationPtr obs = getObservation(name);
+    MultiThreadingLock lock(*mutex_);
+    flushCounters();
+    ObservationPtr obs = getObservationInternal(name);
     if (obs) {
         obs->reset();
         return (true);
@@ -95,16 +195,27 @@ bool StatsMgr::reset(const std::string& name) {
 }
 
 bool StatsMgr::del(const std::string& name) {
-    return (global_->del(name));
+    MultiThreadingLock lock(*mutex_);
+    discardCounter(name);
+    updateCounterSampling(name, ObservationPtr());
+    return (deleteObservation(name));
 }
 
 void StatsMgr::removeAll() {
+    MultiThreadingLock lock(*mutex_);
+    discardCounters();
+    for (std::map<std::string, StatsCounterPtr>::const_iterator c =
+             counters_.begin(); c != counters_.end(); ++c) {
+        c->second->setSampled(false);
+    }
     global_->stats_.clear();
 }
 
 isc::data::ConstElementPtr StatsMgr::get(const std::string& name) const {
+    MultiThreadingLock lock(*mutex_);
     isc::data::ElementPtr response = isc::data::Element::createMap(); // a map
-    ObservationPtr obs = getObservation(name);
+    flushCounters();
+    ObservationPtr obs = getObservationInternal(name);
     if (obs) {
         response->set(name, obs->getJSON()); // that contains the observation
     }
@@ -112,7 +223,9 @@ isc::data::ConstElementPtr StatsMgr::get(const std::string& name) const {
 }
 
 isc::data::ConstElementPtr StatsMgr::getAll() const {
+    MultiThreadingLock lock(*mutex_);
     isc::data::ElementPtr map = isc::data::Element::createMap(); // a map
+    flushCounters();
 
     // Let's iterate over all stored statistics...
     for (std::map<std::string, ObservationPtr>::iterator s = global_->stats_.begin();
@@ -125,6 +238,8 @@ isc::data::ConstElementPtr StatsMgr::getAll() const {
 }
 
 void StatsMgr::resetAll() {
+    MultiThreadingLock lock(*mutex_);
+    flushCounters();
     // Let's iterate over all stored statistics...
     for (std::map<std::string, ObservationPtr>::iterator s = global_->stats_.begin();
          s != global_->stats_.end(); ++s) {
@@ -135,6 +250,8 @@ void StatsMgr::resetAll() {
 }
 
 size_t StatsMgr::count() const {
+    MultiThreadingLock lock(*mutex_);
+    flushCounters();
     return (global_->stats_.size());
 }
 
@@ -183,6 +300,48 @@ StatsMgr::statisticRemoveHandler(const std::string& /*name*/,
 
 }
 
+isc::data::ConstElementPtr
+StatsMgr::statisticSampleAgeSetHandler(const std::string& /*name*/,
+                                       const isc::data::ConstElementPtr& params) {
+    std::string name, error;
+    uint32_t max_age;
+    uint32_t max_samples = Observation::DEFAULT_MAX_AGED_SAMPLES;
+    if (!getStatName(params, name, error) ||
+        !getSampleLimit(params, "max-age", max_age, error) ||
+        (params->contains("max-samples") &&
+         !getSampleLimit(params, "max-samples", max_samples, error))) {
+        return (createAnswer(CONTROL_RESULT_ERROR, error));
+    }
+    if (instance().setMaxSampleAge(name, StatsDuration(0, 0, max_age, 0),
+                                   max_samples)) {
+        std::ostringstream text;
+        text << "Statistic '" << name << "' samples limited by age, at most "
+             << max_samples << " samples are kept.";
+        return (createAnswer(CONTROL_RESULT_SUCCESS, text.str()));
+    } else {
+        return (createAnswer(CONTROL_RESULT_ERROR,
+                             "No '" + name + "' statistic found"));
+    }
+}
+
+isc::data::ConstElementPtr
+StatsMgr::statisticSampleCountSetHandler(const std::string& /*name*/,
+                                         const isc::data::ConstElementPtr& params) {
+    std::string name, error;
+    uint32_t max_samples;
+    if (!getStatName(params, name, error) ||
+        !getSampleLimit(params, "max-samples", max_samples, error)) {
+        return (createAnswer(CONTROL_RESULT_ERROR, error));
+    }
+    if (instance().setMaxSampleCount(name, max_samples)) {
+        return (createAnswer(CONTROL_RESULT_SUCCESS,
+                             "Statistic '" + name + "' samples limited by count."));
+    } else {
+        return (createAnswer(CONTROL_RESULT_ERROR,
+                             "No '" + name + "' statistic found"));
+    }
+}
+
 isc::data::ConstElementPtr
 StatsMgr::statisticRemoveAllHandler(const std::string& /*name*/,
                                     const isc::data::ConstElementPtr& /*params*/) {
@@ -228,5 +387,31 @@ StatsMgr::getStatName(const isc::data::ConstElementPtr& params,
     return (true);
 }
 
+bool
+StatsMgr::getSampleLimit(const isc::data::ConstElementPtr& params,
+                         const std::string& param_name,
+                         uint32_t& limit,
+                         std::string& reason) {
+    ConstElementPtr value = params ? params->get(param_name) : ConstElementPtr();
+    if (!value) {
+        reason = "Missing mandatory '" + param_name + "' parameter.";
+        return (false);
+    }
+    if (value->getType() != Element::integer) {
+        reason = "'" + param_name + "' parameter expected to be an integer.";
+        return (false);
+    }
+    int64_t int_value = value->intValue();
+    if ((int_value <= 0) ||
+        (int_value > std::numeric_limits<uint32_t>::max())) {
+        reason = "'" + param_name + "' parameter expected to be a positive"
+            " 32 bit integer.";
+        return (false);
+    }
+
+    limit = static_cast<uint32_t>(int_value);
+    return (true);
+}
+
 };
 };
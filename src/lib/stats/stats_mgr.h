@@ -9,7 +9,10 @@
 
 #include <stats/observation.h>
 #include <stats/context.h>
+#include <stats/stats_counter.h>
+#include <util/threads/sync.h>
 #include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include <map>
 #include <string>
@@ -28,19 +31,23 @@ namespace stats {
 /// As of May 2015, Tomek ran performance benchmarks (see unit-tests in
 /// stats_mgr_unittest.cc with performance in their names) and it seems
 /// the code is able to register ~2.5-3 million observations per second, even
-/// with 1000 different statistics recorded. That seems sufficient for now,
-/// so there is no immediate need to develop any multi-threading solutions
-/// for now. However, should this decision be revised in the future, the
-/// best place for it would to be modify @ref addObservation method here.
-/// It's the common code point that all new observations must pass through.
-/// One possible way to enable multi-threading would be to run a separate
-/// thread handling collection. The main thread would call @ref addValue and
-/// @ref setValue methods that would end up calling @ref addObservation.
-/// That method would pass the data to separate thread to be collected and
-/// would immediately return. Further processing would be mostly as it
-/// is today, except happening in a separate thread. One unsolved issue in
-/// this approach is how to extract data, but that will remain unsolvable
-/// until we get the control socket implementation.
+/// with 1000 different statistics recorded.
+///
+/// The statistics are updated by the threads processing packets when the
+/// multi-threading mode is enabled (see
+/// @ref isc::util::thread::MultiThreadingMgr). All public methods of this
+/// class lock the mutex protecting the statistics in this mode. The lock is
+/// not taken when the mode is disabled. The observations returned by
+/// @ref getObservation are not protected, so they should only be accessed
+/// when no other thread updates the statistics.
+///
+/// The integer statistics updated for each packet should be updated using
+/// the counters returned by @ref getCounter. The counters don't require the
+/// lookup of the statistic by name nor the lock of this class. The values
+/// accumulated by the counters are added to the statistics before they are
+/// read, reset or removed. The counter of a statistic configured to keep
+/// more than one sample (see @ref setMaxSampleAge and @ref setMaxSampleCount)
+/// adds each value to the statistic instead, so the samples are not merged.
 ///
 /// Statistics Manager does not use logging by design. The reasons are:
 /// - performance impact (logging every observation would degrade performance
@@ -126,34 +133,59 @@ class StatsMgr : public boost::noncopyable {
     /// @throw InvalidStatType if statistic is not a string
     void addValue(const std::string& name, const std::string& value);
 
+    /// @brief Returns the counter used to update an integer statistic.
+    ///
+    /// The counter is created when it is requested for the first time and
+    /// then the same counter is returned for the statistic. The values added
+    /// to the counter are added to the statistic of the same name (created
+    /// if it doesn't exist) when the statistics are read. The counter remains
+    /// valid when the statistic is removed.
+    ///
+    /// @param name name of the statistic
+    /// @return Pointer to the counter.
+    StatsCounterPtr getCounter(const std::string& name);
+
     /// @brief Determines maximum age of samples.
     ///
     /// Specifies that statistic name should be stored not as a single value,
     /// but rather as a set of values. duration determines the timespan.
     /// Samples older than duration will be discarded. This is time-constrained
     /// approach. For sample count constrained approach, see @ref
-    /// setMaxSampleCount() below.
-    ///
-    /// @todo: Not implemented.
+    /// setMaxSampleCount() below. The most recent sample is always kept and
+    /// no more than max_samples samples are kept, so the samples of a
+    /// statistic updated more often than max_samples times per duration
+    /// span a shorter period.
     ///
     /// Example: to set a statistic to keep observations for the last 5 minutes,
     /// call setMaxSampleAge("incoming-packets", time_duration(0,5,0,0));
     /// to revert statistic to a single value, call:
     /// setMaxSampleAge("incoming-packets" time_duration(0,0,0,0))
-    void setMaxSampleAge(const std::string& name, const StatsDuration& duration);
+    ///
+    /// @param name name of the statistic
+    /// @param duration maximum age of the samples
+    /// @param max_samples maximum number of the samples
+    /// @return true if successful, false if there's no such statistic
+    /// @throw BadValue if max_samples is 0
+    bool setMaxSampleAge(const std::string& name, const StatsDuration& duration,
+                         uint32_t max_samples =
+                         Observation::DEFAULT_MAX_AGED_SAMPLES);
 
     /// @brief Determines how many samples of a given statistic should be kept.
     ///
     /// Specifies that statistic name should be stored not as single value, but
     /// rather as a set of values. In this form, at most max_samples will be kept.
     /// When adding max_samples+1 sample, the oldest sample will be discarded.
-    ///
-    /// @todo: Not implemented.
+    /// By default, a single sample is kept.
     ///
     /// Example:
     /// To set a statistic to keep the last 100 observations, call:
     /// setMaxSampleCount("incoming-packets", 100);
-    void setMaxSampleCount(const std::string& name, uint32_t max_samples);
+    ///
+    /// @param name name of the statistic
+    /// @param max_samples maximum number of the samples
+    /// @return true if successful, false if there's no such statistic
+    /// @throw BadValue if max_samples is 0
+    bool setMaxSampleCount(const std::string& name, uint32_t max_samples);
 
     /// @}
 
@@ -289,6 +321,55 @@ class StatsMgr : public boost::noncopyable {
     statisticRemoveHandler(const std::string& name,
                            const isc::data::ConstElementPtr& params);
 
+    /// @brief Handles statistic-sample-age-set command
+    ///
+    /// This method handles statistic-sample-age-set command, which sets
+    /// the maximum age of the samples of a given statistic. It expects two
+    /// parameters stored in params map and an optional third one:
+    /// name: name-of-the-statistic
+    /// max-age: maximum age of the samples in seconds
+    /// max-samples: maximum number of the samples, by default
+    /// @ref Observation::DEFAULT_MAX_AGED_SAMPLES
+    ///
+    /// Example params structure:
+    /// {
+    ///     "name": "packets-received",
+    ///     "max-age": 300,
+    ///     "max-samples": 10000
+    /// }
+    ///
+    /// @param name name of the command (ignored, should be
+    /// "statistic-sample-age-set")
+    /// @param params structure containing a map that contains "name" and
+    /// "max-age" elements and optionally the "max-samples" element
+    /// @return answer containing confirmation
+    static isc::data::ConstElementPtr
+    statisticSampleAgeSetHandler(const std::string& name,
+                                 const isc::data::ConstElementPtr& params);
+
+    /// @brief Handles statistic-sample-count-set command
+    ///
+    /// This method handles statistic-sample-count-set command, which sets
+    /// the maximum number of the samples of a given statistic. It expects
+    /// two parameters stored in params map:
+    /// name: name-of-the-statistic
+    /// max-samples: maximum number of the samples
+    ///
+    /// Example params structure:
+    /// {
+    ///     "name": "packets-received",
+    ///     "max-samples": 100
+    /// }
+    ///
+    /// @param name name of the command (ignored, should be
+    /// "statistic-sample-count-set")
+    /// @param params structure containing a map that contains "name" and
+    /// "max-samples" elements
+    /// @return answer containing confirmation
+    static isc::data::ConstElementPtr
+    statisticSampleCountSetHandler(const std::string& name,
+                                   const isc::data::ConstElementPtr& params);
+
     /// @brief Handles statistic-get-all command
     ///
     /// This method handles statistic-get-all command, which returns values
@@ -340,7 +421,7 @@ class StatsMgr : public boost::noncopyable {
     ///
     /// This template method sets statistic identified by name to a value
     /// specified by value. This internal method is used by public @ref setValue
-    /// methods.
+    /// methods. It must be called with the mutex locked.
     ///
     /// @tparam DataType one of int64_t, double, StatsDuration or string
     /// @param name name of the statistic
@@ -350,7 +431,7 @@ class StatsMgr : public boost::noncopyable {
     void setValueInternal(const std::string& name, DataType value) {
 
         // If we want to log each observation, here would be the best place for it.
-        ObservationPtr stat = getObservation(name);
+        ObservationPtr stat = getObservationInternal(name);
         if (stat) {
             stat->setValue(value);
         } else {
@@ -365,7 +446,7 @@ class StatsMgr : public boost::noncopyable {
     ///
     /// This template method adds specified value to a given statistic (identified
     /// by name to a value). This internal method is used by public @ref setValue
-    /// methods.
+    /// methods. It must be called with the mutex locked.
     ///
     /// @tparam DataType one of int64_t, double, StatsDuration or string
     /// @param name name of the statistic
@@ -375,12 +456,12 @@ class StatsMgr : public boost::noncopyable {
     void addValueInternal(const std::string& name, DataType value) {
 
         // If we want to log each observation, here would be the best place for it.
-        ObservationPtr existing = getObservation(name);
+        ObservationPtr existing = getObservationInternal(name);
         if (!existing) {
             // We tried to add to a non-existing statistic. We can recover from
             // that. Simply add the new incremental value as a new statistic and
             // we're done.
-            setValue(name, value);
+            setValueInternal(name, value);
             return;
         } else {
             // Let's hope it is of correct type. If not, the underlying
@@ -391,17 +472,58 @@ class StatsMgr : public boost::noncopyable {
 
     /// @public
 
+    /// @brief Returns an observation (internal version).
+    ///
+    /// It must be called with the mutex locked.
+    ///
+    /// @param name name of the statistic
+    /// @return Pointer to the Observation object
+    ObservationPtr getObservationInternal(const std::string& name) const;
+
     /// @brief Adds a new observation.
     ///
     /// That's an utility method used by public @ref setValue() and
-    /// @ref addValue() methods.
+    /// @ref addValue() methods. It must be called with the mutex locked.
     /// @param stat observation
     void addObservation(const ObservationPtr& stat);
 
+    /// @brief Adds the values accumulated by the counters to the statistics.
+    ///
+    /// The values accumulated by a counter since the previous call are
+    /// added as one sample. The values of a counter are
+    /// dropped if the statistic of the same name is not an integer. It
+    /// must be called with the mutex locked.
+    void flushCounters() const;
+
+    /// @brief Sets whether the counter of a statistic records samples.
+    ///
+    /// The counter of a statistic which keeps more than one sample adds
+    /// each value to the statistic, so the samples show the individual
+    /// updates. It must be called with the mutex locked.
+    ///
+    /// @param name name of the statistic
+    /// @param obs the statistic or null if it doesn't exist
+    void updateCounterSampling(const std::string& name,
+                               const ObservationPtr& obs);
+
+    /// @brief Discards the values accumulated by a counter.
+    ///
+    /// It must be called with the mutex locked.
+    ///
+    /// @param name name of the statistic
+    void discardCounter(const std::string& name);
+
+    /// @brief Discards the values accumulated by all counters.
+    ///
+    /// It must be called with the mutex locked.
+    void discardCounters();
+
     /// @private
 
     /// @brief Tries to delete an observation.
     ///
+    /// It must be called with the mutex locked.
+    ///
     /// @param name of the statistic to be deleted
     /// @return true if deleted, false if not found
     bool deleteObservation(const std::string& name);
@@ -422,8 +544,33 @@ class StatsMgr : public boost::noncopyable {
                             std::string& name,
                             std::string& reason);
 
+    /// @brief Utility method that attempts to extract a sample limit
+    ///
+    /// This method attempts to extract the limit of the samples from the
+    /// params structure. It is expected to be a map that contains the
+    /// element of the specified name, that is a positive integer. If present
+    /// as expected, the limit is set and true is returned. If missing or is
+    /// of incorrect type or value, the reason is specified in reason
+    /// parameter and false is returned.
+    ///
+    /// @param params parameters structure received in command
+    /// @param param_name name of the element holding the limit
+    /// @param limit [out] the limit (if no error detected)
+    /// @param reason [out] failure reason (if error is detected)
+    /// @return true (if everything is ok), false otherwise
+    static bool getSampleLimit(const isc::data::ConstElementPtr& params,
+                               const std::string& param_name,
+                               uint32_t& limit,
+                               std::string& reason);
+
     // This is a global context. All statistics will initially be stored here.
     StatContextPtr global_;
+
+    /// @brief Counters used to update the statistics.
+    std::map<std::string, StatsCounterPtr> counters_;
+
+    /// @brief Mutex protecting the statistics in the multi-threading mode.
+    boost::scoped_ptr<isc::util::thread::Mutex> mutex_;
 };
 
 };
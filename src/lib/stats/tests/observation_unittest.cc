@@ -224,6 +224,129 @@ TEST_F(ObservationTest, reset) {
     EXPECT_EQ("", d.getString().first);
 }
 
+// Checks whether the number of samples can be limited.
+TEST_F(ObservationTest, setMaxSampleCount) {
+    // By default a single sample is kept.
+    EXPECT_TRUE(a.getMaxSampleCount().first);
+    EXPECT_EQ(1, a.getMaxSampleCount().second);
+    EXPECT_FALSE(a.getMaxSampleAge().first);
+    a.setValue(static_cast<int64_t>(1));
+    EXPECT_EQ(1, a.getSize());
+
+    EXPECT_THROW(a.setMaxSampleCount(0), BadValue);
+
+    ASSERT_NO_THROW(a.setMaxSampleCount(4));
+    for (int64_t i = 2; i <= 6; ++i) {
+        a.setValue(i);
+    }
+
+    // The oldest samples are discarded, the most recent is the first one.
+    std::list<IntegerSample> samples = a.getIntegers();
+    ASSERT_EQ(4, samples.size());
+    int64_t expected = 6;
+    for (std::list<IntegerSample>::const_iterator s = samples.begin();
+         s != samples.end(); ++s) {
+        EXPECT_EQ(expected--, s->first);
+    }
+    EXPECT_EQ(6, a.getInteger().first);
+
+    // Incremental observation uses the most recent sample.
+    a.addValue(static_cast<int64_t>(10));
+    EXPECT_EQ(16, a.getInteger().first);
+    EXPECT_EQ(4, a.getSize());
+
+    // All samples are reported in JSON, the most recent first.
+    ASSERT_EQ(4, a.getJSON()->size());
+    EXPECT_EQ(16, a.getJSON()->get(0)->get(0)->intValue());
+    EXPECT_EQ(4, a.getJSON()->get(3)->get(0)->intValue());
+
+    // Decreasing the limit discards the oldest samples.
+    a.setMaxSampleCount(2);
+    samples = a.getIntegers();
+    ASSERT_EQ(2, samples.size());
+    EXPECT_EQ(16, samples.front().first);
+    EXPECT_EQ(6, samples.back().first);
+
+    // Reset discards the samples.
+    a.reset();
+    EXPECT_EQ(1, a.getSize());
+    EXPECT_EQ(0, a.getInteger().first);
+
+    EXPECT_THROW(a.getFloats(), InvalidStatType);
+    EXPECT_THROW(b.getIntegers(), InvalidStatType);
+}
+
+// Checks whether the age of samples can be limited.
+TEST_F(ObservationTest, setMaxSampleAge) {
+    d.setMaxSampleAge(millisec::time_duration(0,0,0,200000));
+    EXPECT_TRUE(d.getMaxSampleAge().first);
+    EXPECT_FALSE(d.getMaxSampleCount().first);
+
+    // The samples within the age limit are kept.
+    d.setValue("a");
+    d.setValue("b");
+    d.setValue("c");
+    EXPECT_EQ(4, d.getSize());
+    EXPECT_EQ("c", d.getStrings().front().first);
+
+    // The expired samples are discarded when a new one is recorded.
+    usleep(300000);
+    d.setValue("d");
+    ASSERT_EQ(1, d.getSize());
+    EXPECT_EQ("d", d.getString().first);
+
+    // Changing the limit discards the expired samples except the most
+    // recent one.
+    c.setMaxSampleCount(3);
+    c.setValue(time_duration(0,0,1,0));
+    c.setValue(time_duration(0,0,2,0));
+    EXPECT_EQ(3, c.getSize());
+    usleep(10000);
+    c.setMaxSampleAge(millisec::time_duration(0,0,0,1000));
+    ASSERT_EQ(1, c.getSize());
+    EXPECT_EQ(time_duration(0,0,2,0), c.getDuration().first);
+}
+
+// Checks that the number of samples is bounded when their age is limited.
+TEST_F(ObservationTest, setMaxSampleAgeBounded) {
+    a.setMaxSampleAge(time_duration(1,0,0,0));
+    const size_t max_samples = Observation::DEFAULT_MAX_AGED_SAMPLES;
+    for (int64_t i = 0; i < 2 * max_samples; ++i) {
+        a.setValue(i);
+    }
+    std::list<IntegerSample> samples = a.getIntegers();
+    ASSERT_EQ(max_samples, samples.size());
+    EXPECT_EQ(2 * max_samples - 1, samples.front().first);
+    EXPECT_EQ(max_samples, samples.back().first);
+
+    // The buffer shrinks when the larger count limit is replaced by the
+    // age limit.
+    a.setMaxSampleCount(2 * max_samples);
+    for (int64_t i = 0; i < 2 * max_samples; ++i) {
+        a.setValue(i);
+    }
+    EXPECT_EQ(2 * max_samples, a.getSize());
+    a.setMaxSampleAge(time_duration(1,0,0,0));
+    EXPECT_EQ(max_samples, a.getSize());
+    EXPECT_EQ(2 * max_samples - 1, a.getInteger().first);
+
+    // The maximum number of samples can be raised.
+    a.setMaxSampleAge(time_duration(1,0,0,0), 3 * max_samples);
+    EXPECT_EQ(3 * max_samples, a.getMaxAgedSamples());
+    for (int64_t i = 0; i < 4 * max_samples; ++i) {
+        a.setValue(i);
+    }
+    EXPECT_EQ(3 * max_samples, a.getSize());
+
+    // It can be lowered and the oldest samples are discarded.
+    a.setMaxSampleAge(time_duration(1,0,0,0), 2);
+    EXPECT_EQ(2, a.getSize());
+    EXPECT_EQ(4 * max_samples - 1, a.getInteger().first);
+
+    // It must be greater than 0.
+    EXPECT_THROW(a.setMaxSampleAge(time_duration(1,0,0,0), 0), BadValue);
+}
+
 // Checks whether an observation can keep its name.
 TEST_F(ObservationTest, names) {
     EXPECT_EQ("alpha", a.getName());
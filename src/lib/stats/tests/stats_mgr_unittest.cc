@@ -11,6 +11,9 @@
 #include <cc/data.h>
 #include <cc/command_interpreter.h>
 #include <util/boost_time_utils.h>
+#include <util/threads/multi_threading_mgr.h>
+#include <util/threads/thread.h>
+#include <boost/bind.hpp>
 #include <boost/date_time/posix_time/posix_time_types.hpp>
 #include <boost/shared_ptr.hpp>
 #include <gtest/gtest.h>
@@ -22,6 +25,7 @@ using namespace isc;
 using namespace isc::data;
 using namespace isc::stats;
 using namespace isc::config;
+using namespace isc::util::thread;
 using namespace boost::posix_time;
 
 namespace {
@@ -122,12 +126,39 @@ TEST_F(StatsMgrTest, stringStat) {
 // Setting limits is currently not implemented, so those methods should
 // throw.
 TEST_F(StatsMgrTest, setLimits) {
-    EXPECT_THROW(StatsMgr::instance().setMaxSampleAge("foo",
-                                                      time_duration(1,0,0,0)),
-                 NotImplemented);
+    // The limits can't be set for a non-existing statistic.
+    EXPECT_FALSE(StatsMgr::instance().setMaxSampleAge("foo",
+                                                      time_duration(1,0,0,0)));
+    EXPECT_FALSE(StatsMgr::instance().setMaxSampleCount("foo", 100));
 
-    EXPECT_THROW(StatsMgr::instance().setMaxSampleCount("foo", 100),
-                 NotImplemented);
+    StatsMgr::instance().setValue("foo", static_cast<int64_t>(1));
+
+    EXPECT_TRUE(StatsMgr::instance().setMaxSampleCount("foo", 3));
+    EXPECT_THROW(StatsMgr::instance().setMaxSampleCount("foo", 0), BadValue);
+    for (int64_t i = 2; i <= 5; ++i) {
+        StatsMgr::instance().setValue("foo", i);
+    }
+
+    // Only the three most recent samples are kept.
+    ObservationPtr obs = StatsMgr::instance().getObservation("foo");
+    ASSERT_TRUE(obs);
+    std::list<IntegerSample> samples = obs->getIntegers();
+    ASSERT_EQ(3, samples.size());
+    EXPECT_EQ(5, samples.front().first);
+    EXPECT_EQ(3, samples.back().first);
+
+    // The samples are reported by statistic-get, the most recent first.
+    ConstElementPtr rep = StatsMgr::instance().get("foo");
+    ASSERT_TRUE(rep->get("foo"));
+    ASSERT_EQ(3, rep->get("foo")->size());
+    EXPECT_EQ(5, rep->get("foo")->get(0)->get(0)->intValue());
+    EXPECT_EQ(3, rep->get("foo")->get(2)->get(0)->intValue());
+
+    // All samples are within the age limit.
+    EXPECT_TRUE(StatsMgr::instance().setMaxSampleAge("foo",
+                                                     time_duration(1,0,0,0)));
+    StatsMgr::instance().setValue("foo", static_cast<int64_t>(6));
+    EXPECT_EQ(4, obs->getSize());
 }
 
 // This test checks whether a single (get("foo")) and all (getAll())
@@ -288,6 +319,190 @@ TEST_F(StatsMgrTest, removeAll) {
     EXPECT_FALSE(StatsMgr::instance().getObservation("delta"));
 }
 
+/// @brief Increments the statistics from a separate thread.
+///
+/// @param cycles Number of the increments of each statistic.
+void
+incrementStats(const int64_t cycles) {
+    for (int64_t i = 0; i < cycles; ++i) {
+        StatsMgr::instance().addValue("alpha", static_cast<int64_t>(1));
+        StatsMgr::instance().addValue("beta", 0.5);
+    }
+}
+
+// Test checks that the statistics can be updated concurrently when the
+// multi-threading mode is enabled.
+TEST_F(StatsMgrTest, multiThreading) {
+    MultiThreadingMgr::instance().setMode(true);
+
+    const int64_t cycles = 10000;
+    {
+        Thread t1(boost::bind(&incrementStats, cycles));
+        Thread t2(boost::bind(&incrementStats, cycles));
+        Thread t3(boost::bind(&incrementStats, cycles));
+        // Read the statistics while they're being updated.
+        for (int i = 0; i < 100; ++i) {
+            EXPECT_TRUE(StatsMgr::instance().getAll());
+        }
+        t1.wait();
+        t2.wait();
+        t3.wait();
+    }
+
+    MultiThreadingMgr::instance().setMode(false);
+
+    ObservationPtr alpha = StatsMgr::instance().getObservation("alpha");
+    ASSERT_TRUE(alpha);
+    EXPECT_EQ(3 * cycles, alpha->getInteger().first);
+
+    ObservationPtr beta = StatsMgr::instance().getObservation("beta");
+    ASSERT_TRUE(beta);
+    EXPECT_DOUBLE_EQ(1.5 * cycles, beta->getFloat().first);
+}
+
+// This test checks that the values added to the counter are visible
+// in the statistic of the same name.
+TEST_F(StatsMgrTest, counter) {
+    StatsCounterPtr counter = StatsMgr::instance().getCounter("alpha");
+    ASSERT_TRUE(counter);
+    EXPECT_EQ(counter, StatsMgr::instance().getCounter("alpha"));
+
+    // The statistic is created when the counter is used.
+    EXPECT_EQ(0, StatsMgr::instance().count());
+    counter->add();
+    counter->add(2);
+    ObservationPtr alpha = StatsMgr::instance().getObservation("alpha");
+    ASSERT_TRUE(alpha);
+    EXPECT_EQ(3, alpha->getInteger().first);
+
+    // The counter and the name based methods can be mixed.
+    StatsMgr::instance().addValue("alpha", static_cast<int64_t>(10));
+    counter->add();
+    EXPECT_EQ(14, StatsMgr::instance().getObservation("alpha")->
+              getInteger().first);
+
+    // The absolute value replaces the accumulated values.
+    counter->add();
+    StatsMgr::instance().setValue("alpha", static_cast<int64_t>(5));
+    EXPECT_EQ(5, StatsMgr::instance().getObservation("alpha")->
+              getInteger().first);
+
+    // The accumulated values are reset.
+    counter->add();
+    EXPECT_TRUE(StatsMgr::instance().reset("alpha"));
+    EXPECT_EQ(0, StatsMgr::instance().getObservation("alpha")->
+              getInteger().first);
+
+    // The accumulated values are discarded when the statistic is removed.
+    counter->add();
+    EXPECT_TRUE(StatsMgr::instance().del("alpha"));
+    EXPECT_FALSE(StatsMgr::instance().getObservation("alpha"));
+    counter->add();
+    StatsMgr::instance().removeAll();
+    EXPECT_EQ(0, StatsMgr::instance().count());
+
+    // The counter remains valid.
+    counter->add();
+    EXPECT_EQ(1, StatsMgr::instance().getObservation("alpha")->
+              getInteger().first);
+}
+
+// This test checks that the values added to the counter of a statistic
+// which keeps more than one sample are recorded as separate samples.
+TEST_F(StatsMgrTest, counterSamples) {
+    StatsCounterPtr counter = StatsMgr::instance().getCounter("alpha");
+    counter->add();
+    counter->add();
+    EXPECT_FALSE(counter->isSampled());
+    ASSERT_TRUE(StatsMgr::instance().getObservation("alpha"));
+    ASSERT_TRUE(StatsMgr::instance().setMaxSampleCount("alpha", 10));
+    EXPECT_TRUE(counter->isSampled());
+
+    counter->add();
+    counter->add(2);
+    counter->add();
+    ObservationPtr alpha = StatsMgr::instance().getObservation("alpha");
+    ASSERT_TRUE(alpha);
+    std::list<IntegerSample> samples = alpha->getIntegers();
+    ASSERT_EQ(4, samples.size());
+    EXPECT_EQ(6, samples.front().first);
+    EXPECT_EQ(2, samples.back().first);
+
+    // Nothing is recorded when the counter hasn't been updated.
+    alpha = StatsMgr::instance().getObservation("alpha");
+    EXPECT_EQ(4, alpha->getSize());
+
+    // The same applies to the limit on the age of the samples.
+    ASSERT_TRUE(StatsMgr::instance().setMaxSampleCount("alpha", 1));
+    EXPECT_FALSE(counter->isSampled());
+    ASSERT_TRUE(StatsMgr::instance().setMaxSampleAge("alpha",
+                                                     time_duration(1,0,0,0)));
+    EXPECT_TRUE(counter->isSampled());
+    counter->add();
+    counter->add();
+    EXPECT_EQ(3, StatsMgr::instance().getObservation("alpha")->getSize());
+
+    // The removed statistic is created again with one sample.
+    EXPECT_TRUE(StatsMgr::instance().del("alpha"));
+    EXPECT_FALSE(counter->isSampled());
+    EXPECT_FALSE(StatsMgr::instance().setMaxSampleAge("alpha",
+                                                      time_duration(1,0,0,0)));
+
+    // The counter of a statistic which keeps more samples records them
+    // from the start.
+    StatsMgr::instance().setValue("beta", static_cast<int64_t>(0));
+    ASSERT_TRUE(StatsMgr::instance().setMaxSampleCount("beta", 10));
+    EXPECT_TRUE(StatsMgr::instance().getCounter("beta")->isSampled());
+}
+
+// This test checks that the values of the counter of a statistic which
+// is not an integer are dropped.
+TEST_F(StatsMgrTest, counterInvalidType) {
+    StatsMgr::instance().setValue("beta", 0.5);
+    StatsMgr::instance().getCounter("beta")->add();
+    EXPECT_NO_THROW(StatsMgr::instance().getAll());
+    EXPECT_DOUBLE_EQ(0.5, StatsMgr::instance().getObservation("beta")->
+                     getFloat().first);
+}
+
+/// @brief Increments the counter.
+///
+/// @param counter Counter to be incremented.
+/// @param cycles Number of the increments.
+void
+incrementCounter(const StatsCounterPtr& counter, const int64_t cycles) {
+    for (int64_t i = 0; i < cycles; ++i) {
+        counter->add();
+    }
+}
+
+// Test checks that the counters can be updated concurrently when the
+// multi-threading mode is enabled.
+TEST_F(StatsMgrTest, counterMultiThreading) {
+    MultiThreadingMgr::instance().setMode(true);
+
+    StatsCounterPtr counter = StatsMgr::instance().getCounter("alpha");
+    const int64_t cycles = 10000;
+    {
+        Thread t1(boost::bind(&incrementCounter, counter, cycles));
+        Thread t2(boost::bind(&incrementCounter, counter, cycles));
+        Thread t3(boost::bind(&incrementCounter, counter, cycles));
+        // Read the statistics while they're being updated.
+        for (int i = 0; i < 100; ++i) {
+            EXPECT_TRUE(StatsMgr::instance().getAll());
+        }
+        t1.wait();
+        t2.wait();
+        t3.wait();
+    }
+
+    MultiThreadingMgr::instance().setMode(false);
+
+    ObservationPtr alpha = StatsMgr::instance().getObservation("alpha");
+    ASSERT_TRUE(alpha);
+    EXPECT_EQ(3 * cycles, alpha->getInteger().first);
+}
+
 // This is a performance benchmark that checks how long does it take
 // to increment a single statistic million times.
 //
@@ -310,6 +525,26 @@ TEST_F(StatsMgrTest, DISABLED_performanceSingleAdd) {
               << isc::util::durationToText(dur) << std::endl;
 }
 
+// This is a performance benchmark that checks how long does it take
+// to increment a single statistic million times using the counter.
+TEST_F(StatsMgrTest, DISABLED_performanceCounterAdd) {
+    StatsMgr::instance().removeAll();
+
+    uint32_t cycles = 1000000;
+    StatsCounterPtr counter = StatsMgr::instance().getCounter("metric1");
+
+    ptime before = microsec_clock::local_time();
+    for (uint32_t i = 0; i < cycles; ++i) {
+        counter->add();
+    }
+    ptime after = microsec_clock::local_time();
+
+    time_duration dur = after - before;
+
+    std::cout << "Incrementing a single counter " << cycles << " times took: "
+              << isc::util::durationToText(dur) << std::endl;
+}
+
 // This is a performance benchmark that checks how long does it take
 // to set absolute value of a single statistic million times.
 //
@@ -654,6 +889,108 @@ TEST_F(StatsMgrTest, commandStatisticRemoveNegative) {
               rsp->str());
 }
 
+// Test checks if statistic-sample-count-set handler is able to set
+// the maximum number of samples.
+TEST_F(StatsMgrTest, commandStatisticSampleCountSet) {
+    StatsMgr::instance().setValue("alpha", static_cast<int64_t>(1234));
+
+    ElementPtr params = Element::createMap();
+    params->set("name", Element::create("alpha"));
+    params->set("max-samples", Element::create(2));
+
+    ConstElementPtr rsp = StatsMgr::instance().statisticSampleCountSetHandler(
+        "statistic-sample-count-set", params);
+    int status_code;
+    ASSERT_NO_THROW(parseAnswer(status_code, rsp));
+    EXPECT_EQ(CONTROL_RESULT_SUCCESS, status_code);
+
+    ObservationPtr obs = StatsMgr::instance().getObservation("alpha");
+    ASSERT_TRUE(obs);
+    EXPECT_EQ(2, obs->getMaxSampleCount().second);
+    EXPECT_TRUE(obs->getMaxSampleCount().first);
+    EXPECT_FALSE(obs->getMaxSampleAge().first);
+}
+
+// Test checks if statistic-sample-age-set handler is able to set
+// the maximum age of samples.
+TEST_F(StatsMgrTest, commandStatisticSampleAgeSet) {
+    StatsMgr::instance().setValue("alpha", static_cast<int64_t>(1234));
+
+    ElementPtr params = Element::createMap();
+    params->set("name", Element::create("alpha"));
+    params->set("max-age", Element::create(300));
+
+    ConstElementPtr rsp = StatsMgr::instance().statisticSampleAgeSetHandler(
+        "statistic-sample-age-set", params);
+    int status_code;
+    ASSERT_NO_THROW(parseAnswer(status_code, rsp));
+    EXPECT_EQ(CONTROL_RESULT_SUCCESS, status_code);
+
+    ObservationPtr obs = StatsMgr::instance().getObservation("alpha");
+    ASSERT_TRUE(obs);
+    EXPECT_TRUE(obs->getMaxSampleAge().first);
+    EXPECT_EQ(time_duration(0,5,0,0), obs->getMaxSampleAge().second);
+    EXPECT_EQ(Observation::DEFAULT_MAX_AGED_SAMPLES, obs->getMaxAgedSamples());
+    EXPECT_FALSE(obs->getMaxSampleCount().first);
+
+    // The maximum number of samples can be specified too.
+    params->set("max-samples", Element::create(10000));
+    rsp = StatsMgr::instance().statisticSampleAgeSetHandler(
+        "statistic-sample-age-set", params);
+    ASSERT_NO_THROW(parseAnswer(status_code, rsp));
+    EXPECT_EQ(CONTROL_RESULT_SUCCESS, status_code);
+    EXPECT_EQ(10000, obs->getMaxAgedSamples());
+}
+
+// Test checks if statistic-sample-count-set and statistic-sample-age-set
+// are able to handle:
+// - a request without parameters
+// - a request with missing or invalid limit
+// - a request for non-existing statistic.
+TEST_F(StatsMgrTest, commandStatisticSampleSetNegative) {
+
+    // Case 1: a request without parameters
+    ConstElementPtr rsp = StatsMgr::instance().statisticSampleCountSetHandler(
+        "statistic-sample-count-set", ElementPtr());
+    int status_code;
+    ASSERT_NO_THROW(parseAnswer(status_code, rsp));
+    EXPECT_EQ(CONTROL_RESULT_ERROR, status_code);
+
+    // Case 2: a request with missing limit
+    ElementPtr params = Element::createMap();
+    params->set("name", Element::create("alpha"));
+    rsp = StatsMgr::instance().statisticSampleCountSetHandler(
+        "statistic-sample-count-set", params);
+    EXPECT_EQ("{ \"result\": 1, \"text\": \"Missing mandatory "
+              "'max-samples' parameter.\" }", rsp->str());
+
+    // Case 3: a request with invalid limits
+    params->set("max-samples", Element::create(0));
+    rsp = StatsMgr::instance().statisticSampleCountSetHandler(
+        "statistic-sample-count-set", params);
+    ASSERT_NO_THROW(parseAnswer(status_code, rsp));
+    EXPECT_EQ(CONTROL_RESULT_ERROR, status_code);
+
+    params->set("max-age", Element::create("300"));
+    rsp = StatsMgr::instance().statisticSampleAgeSetHandler(
+        "statistic-sample-age-set", params);
+    ASSERT_NO_THROW(parseAnswer(status_code, rsp));
+    EXPECT_EQ(CONTROL_RESULT_ERROR, status_code);
+
+    params->set("max-age", Element::create(300));
+    rsp = StatsMgr::instance().statisticSampleAgeSetHandler(
+        "statistic-sample-age-set", params);
+    ASSERT_NO_THROW(parseAnswer(status_code, rsp));
+    EXPECT_EQ(CONTROL_RESULT_ERROR, status_code);
+
+    // Case 4: a request for non-existing statistic
+    params->set("max-samples", Element::create(10));
+    rsp = StatsMgr::instance().statisticSampleCountSetHandler(
+        "statistic-sample-count-set", params);
+    EXPECT_EQ("{ \"result\": 1, \"text\": \"No 'alpha' statistic found\" }",
+              rsp->str());
+}
+
 // This test checks whether statistic-remove-all command really resets all
 // statistics correctly.
 TEST_F(StatsMgrTest, commandRemoveAll) {
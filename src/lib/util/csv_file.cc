@@ -9,8 +9,12 @@
 #include <boost/algorithm/string/constants.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <fstream>
 #include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace isc {
 namespace util {
@@ -79,7 +83,7 @@ CSVRow::checkIndex(const size_t at) const {
 }
 
 CSVFile::CSVFile(const std::string& filename)
-    : filename_(filename), fs_(), cols_(0), read_msg_() {
+    : filename_(filename), fs_(), cols_(0), auto_flush_(true), read_msg_() {
 }
 
 CSVFile::~CSVFile() {
@@ -110,6 +114,30 @@ CSVFile::flush() const {
     fs_->flush();
 }
 
+void
+CSVFile::sync() const {
+    checkStreamStatusAndReset("sync");
+
+    // The stream doesn't expose its descriptor, so the file is opened
+    // again to synchronize its data.
+    const int fd = ::open(filename_.c_str(), O_RDONLY);
+    if (fd < 0) {
+        isc_throw(CSVFileError, "unable to open '" << filename_
+                  << "' for synchronization: " << strerror(errno));
+    }
+#ifdef __APPLE__
+    const int result = fsync(fd);
+#else
+    const int result = fdatasync(fd);
+#endif
+    const int sync_errno = errno;
+    ::close(fd);
+    if (result != 0) {
+        isc_throw(CSVFileError, "failed to synchronize '" << filename_
+                  << "': " << strerror(sync_errno));
+    }
+}
+
 void
 CSVFile::addColumn(const std::string& col_name) {
     // It is not allowed to add a new column when file is open.
@@ -153,7 +181,10 @@ CSVFile::append(const CSVRow& row) const {
     fs_->clear();
 
     std::string text = row.render();
-    *fs_ << text << std::endl;
+    *fs_ << text << '\n';
+    if (auto_flush_) {
+        fs_->flush();
+    }
     if (!fs_->good()) {
         fs_->clear();
         isc_throw(CSVFileError, "failed to write CSV row '"
@@ -240,12 +271,13 @@ CSVFile::next(CSVRow& row, const bool skip_validation) {
     std::string line;
     std::getline(*fs_, line);
     // If we got empty line because we reached the end of file
-    // return an empty row.
+    // return an empty row. The last line which isn't terminated with
+    // a new line character is parsed as any other row.
     if (line.empty() && fs_->eof()) {
         row = EMPTY_ROW();
         return (true);
 
-    } else if (!fs_->good()) {
+    } else if (!fs_->good() && !fs_->eof()) {
         // If we hit an IO error, communicate it to the caller but do NOT close
         // the stream. Caller may try again.
         setReadMsg("error reading a row from CSV file '"
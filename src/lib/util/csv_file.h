@@ -331,6 +331,22 @@ public:
     /// @brief Flushes a file.
     void flush() const;
 
+    /// @brief Enables or disables flushing the file after each row.
+    ///
+    /// The rows are flushed by default. When disabled, the rows are
+    /// buffered until @c flush is called or the buffer is full.
+    ///
+    /// @param auto_flush true if each row should be flushed.
+    void setAutoFlush(const bool auto_flush) {
+        auto_flush_ = auto_flush;
+    }
+
+    /// @brief Waits until the flushed rows are stored on the disk.
+    ///
+    /// @throw CSVFileError if the file is not open or its data couldn't
+    /// be synchronized.
+    void sync() const;
+
     /// @brief Returns the number of columns in the file.
     size_t getColumnCount() const {
         return (cols_.size());
@@ -371,6 +387,8 @@ public:
     /// This function will return the @c CSVRow object representing a
     /// parsed row if parsing is successful. If the end of file has been
     /// reached, the empty row is returned (a row containing no values).
+    /// The last row of the file is returned even if it is not terminated
+    /// with a new line character.
     ///
     /// @param [out] row Object receiving the parsed CSV file.
     /// @param skip_validation Do not perform validation.
@@ -497,6 +515,9 @@ private:
     /// @brief Holds CSV file columns.
     std::vector<std::string> cols_;
 
+    /// @brief Indicates if the file is flushed after each row.
+    bool auto_flush_;
+
     /// @brief Holds last error during row reading or validation.
     std::string read_msg_;
 };
@@ -431,6 +431,45 @@ TEST_F(CSVFileTest, recreate) {
               readFile());
 }
 
+// This test checks that the rows are buffered when the automatic flush
+// is disabled and that the file can be synchronized with the disk.
+TEST_F(CSVFileTest, autoFlush) {
+    boost::scoped_ptr<CSVFile> csv(new CSVFile(testfile_));
+    csv->addColumn("animal");
+    csv->addColumn("color");
+    ASSERT_NO_THROW(csv->recreate());
+    csv->setAutoFlush(false);
+
+    CSVRow row0(2);
+    row0.writeAt(0, "dog");
+    row0.writeAt(1, "grey");
+    ASSERT_NO_THROW(csv->append(row0));
+
+    // The row is in the buffer of the stream.
+    EXPECT_EQ("animal,color\n", readFile());
+
+    ASSERT_NO_THROW(csv->flush());
+    EXPECT_EQ("animal,color\n"
+              "dog,grey\n",
+              readFile());
+    EXPECT_NO_THROW(csv->sync());
+
+    // Enable the automatic flush back.
+    csv->setAutoFlush(true);
+    CSVRow row1(2);
+    row1.writeAt(0, "cat");
+    row1.writeAt(1, "black");
+    ASSERT_NO_THROW(csv->append(row1));
+    EXPECT_EQ("animal,color\n"
+              "dog,grey\n"
+              "cat,black\n",
+              readFile());
+
+    // The closed file can't be synchronized.
+    csv->close();
+    EXPECT_THROW(csv->sync(), CSVFileError);
+}
+
 // This test checks that the error is reported when the size of the row being
 // read doesn't match the number of columns of the CSV file.
 TEST_F(CSVFileTest, validate) {
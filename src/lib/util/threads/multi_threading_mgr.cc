@@ -0,0 +1,75 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <exceptions/exceptions.h>
+#include <util/threads/multi_threading_mgr.h>
+
+#include <unistd.h>
+
+namespace isc {
+namespace util {
+namespace thread {
+
+MultiThreadingMgr::MultiThreadingMgr()
+    : enabled_(false), thread_count_(0), critical_section_count_(0),
+      thread_pool_() {
+}
+
+MultiThreadingMgr&
+MultiThreadingMgr::instance() {
+    static MultiThreadingMgr manager;
+    return (manager);
+}
+
+void
+MultiThreadingMgr::apply(const bool enabled, const size_t thread_count,
+                         const size_t queue_size) {
+    if (isInCriticalSection()) {
+        isc_throw(InvalidOperation, "unable to apply the multi-threading"
+                  " configuration within the critical section");
+    }
+
+    thread_pool_.stop();
+
+    enabled_ = enabled;
+    thread_count_ = 0;
+    if (enabled_) {
+        thread_count_ = (thread_count > 0 ? thread_count : detectThreadCount());
+        thread_pool_.setMaxQueueSize(queue_size);
+        thread_pool_.start(thread_count_);
+    }
+}
+
+void
+MultiThreadingMgr::enterCriticalSection() {
+    if ((critical_section_count_++ == 0) && enabled_) {
+        // Wait for the packets being processed and stop the threads.
+        thread_pool_.stop();
+    }
+}
+
+void
+MultiThreadingMgr::exitCriticalSection() {
+    if (critical_section_count_ == 0) {
+        isc_throw(InvalidOperation, "invalid negative value for the"
+                  " multi-threading critical section count");
+    }
+    if ((--critical_section_count_ == 0) && enabled_ && (thread_count_ > 0)) {
+        thread_pool_.start(thread_count_);
+    }
+}
+
+size_t
+MultiThreadingMgr::detectThreadCount() {
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return (count > 0 ? static_cast<size_t>(count) : 1);
+}
+
+} // namespace thread
+} // namespace util
+} // namespace isc
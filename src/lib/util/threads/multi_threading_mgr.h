@@ -0,0 +1,194 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef MULTI_THREADING_MGR_H
+#define MULTI_THREADING_MGR_H
+
+#include <util/threads/sync.h>
+#include <util/threads/thread_pool.h>
+
+#include <boost/noncopyable.hpp>
+#include <boost/type_traits/aligned_storage.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+
+#include <stdint.h>
+
+namespace isc {
+namespace util {
+namespace thread {
+
+/// @brief Multi-threading manager.
+///
+/// This singleton holds the multi-threading mode of the process and
+/// the pool of threads used by the servers to process packets
+/// concurrently. The mode is disabled by default, in which case all
+/// processing happens on the main thread and the components which are
+/// made safe for the multi-threaded processing don't lock their mutexes
+/// (see @ref MultiThreadingLock).
+///
+/// The mode must only be changed by the main thread when the thread
+/// pool is stopped, e.g. when the server starts or within the
+/// @ref MultiThreadingCriticalSection.
+class MultiThreadingMgr : public boost::noncopyable {
+public:
+
+    /// @brief Returns the sole instance of the manager.
+    static MultiThreadingMgr& instance();
+
+    /// @brief Checks if the multi-threading mode is enabled.
+    bool getMode() const {
+        return (enabled_);
+    }
+
+    /// @brief Enables or disables the multi-threading mode.
+    ///
+    /// This method doesn't start or stop the thread pool. It is mostly
+    /// useful in the unit tests which exercise the locking paths of the
+    /// components without running the pool.
+    ///
+    /// @param enabled true if the mode should be enabled.
+    void setMode(const bool enabled) {
+        enabled_ = enabled;
+    }
+
+    /// @brief Returns the configured number of threads in the pool.
+    size_t getThreadPoolSize() const {
+        return (thread_count_);
+    }
+
+    /// @brief Returns the thread pool.
+    ThreadPool& getThreadPool() {
+        return (thread_pool_);
+    }
+
+    /// @brief Applies the multi-threading configuration.
+    ///
+    /// Stops the thread pool if it is running, sets the mode and starts
+    /// the pool with the specified number of threads when the mode is
+    /// enabled.
+    ///
+    /// @param enabled true if the mode should be enabled.
+    /// @param thread_count Number of threads in the pool. The value of 0
+    /// selects the number of online processors.
+    /// @param queue_size Maximum number of queued work items. The value of
+    /// 0 means that the queue is not limited.
+    void apply(const bool enabled, const size_t thread_count,
+               const size_t queue_size = 0);
+
+    /// @brief Enters the critical section.
+    ///
+    /// The thread pool is stopped when the first critical section is
+    /// entered, so no work items are processed until the last critical
+    /// section is exited. It must be called from the main thread.
+    void enterCriticalSection();
+
+    /// @brief Exits the critical section.
+    ///
+    /// The thread pool is restarted when the last critical section is
+    /// exited.
+    void exitCriticalSection();
+
+    /// @brief Checks if the main thread is in the critical section.
+    bool isInCriticalSection() const {
+        return (critical_section_count_ > 0);
+    }
+
+    /// @brief Returns the number of online processors.
+    ///
+    /// @return Number of processors or 1 if it can't be determined.
+    static size_t detectThreadCount();
+
+private:
+
+    /// @brief Private constructor.
+    MultiThreadingMgr();
+
+    /// @brief Multi-threading mode.
+    bool enabled_;
+
+    /// @brief Number of threads in the pool.
+    size_t thread_count_;
+
+    /// @brief Number of the nested critical sections.
+    size_t critical_section_count_;
+
+    /// @brief Pool of threads processing the packets.
+    ThreadPool thread_pool_;
+};
+
+/// @brief RAII wrapper for the multi-threading critical section.
+///
+/// The object of this class should be created on the main thread before
+/// the state shared by the threads of the pool is changed, e.g. before
+/// the server is reconfigured. The pool is stopped for the lifetime of
+/// this object. If the multi-threading mode is disabled, this object
+/// doesn't do anything.
+class MultiThreadingCriticalSection : public boost::noncopyable {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// Enters the critical section.
+    MultiThreadingCriticalSection() {
+        MultiThreadingMgr::instance().enterCriticalSection();
+    }
+
+    /// @brief Destructor.
+    ///
+    /// Exits the critical section.
+    ~MultiThreadingCriticalSection() {
+        MultiThreadingMgr::instance().exitCriticalSection();
+    }
+};
+
+/// @brief Locks a mutex when the multi-threading mode is enabled.
+///
+/// The components which can be accessed from the threads of the pool
+/// protect their state with a mutex locked by this object. When the
+/// multi-threading mode is disabled, the mutex is not locked and the
+/// single threaded processing doesn't pay for the locking.
+///
+/// The lock is not recursive: a method holding it must not call another
+/// method of the same object which locks the same mutex.
+class MultiThreadingLock : public boost::noncopyable {
+public:
+
+    /// @brief Constructor.
+    ///
+    /// Locks the mutex if the multi-threading mode is enabled.
+    ///
+    /// @param mutex Mutex to be locked.
+    explicit MultiThreadingLock(Mutex& mutex) : locked_(false) {
+        if (MultiThreadingMgr::instance().getMode()) {
+            new (storage_.address()) Mutex::Locker(mutex);
+            locked_ = true;
+        }
+    }
+
+    /// @brief Destructor.
+    ///
+    /// Unlocks the mutex if it was locked.
+    ~MultiThreadingLock() {
+        if (locked_) {
+            static_cast<Mutex::Locker*>(storage_.address())->~Locker();
+        }
+    }
+
+private:
+
+    /// @brief Storage for the locker avoiding the heap allocation.
+    boost::aligned_storage<sizeof(Mutex::Locker),
+                           boost::alignment_of<Mutex::Locker>::value> storage_;
+
+    /// @brief Indicates if the locker has been constructed.
+    bool locked_;
+};
+
+} // namespace thread
+} // namespace util
+} // namespace isc
+
+#endif // MULTI_THREADING_MGR_H
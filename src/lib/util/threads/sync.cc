@@ -16,6 +16,7 @@
 #include <cassert>
 
 #include <pthread.h>
+#include <time.h>
 
 using std::unique_ptr;
 
@@ -238,6 +239,37 @@ CondVar::wait(Mutex& mutex) {
     }
 }
 
+bool
+CondVar::timedWait(Mutex& mutex, const uint32_t timeout_ms) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += static_cast<long>(timeout_ms % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        ++deadline.tv_sec;
+        deadline.tv_nsec -= 1000000000;
+    }
+
+#ifdef ENABLE_DEBUG
+    mutex.preUnlockAction(true);    // Only in debug mode
+    const int result = pthread_cond_timedwait(&impl_->cond_,
+                                              &mutex.impl_->mutex,
+                                              &deadline);
+    mutex.postLockAction();     // Only in debug mode
+#else
+    const int result = pthread_cond_timedwait(&impl_->cond_,
+                                              &mutex.impl_->mutex,
+                                              &deadline);
+#endif
+    if (result == ETIMEDOUT) {
+        return (false);
+    } else if (result != 0) {
+        isc_throw(isc::BadValue, "pthread_cond_timedwait failed unexpectedly: "
+                  << std::strerror(result));
+    }
+    return (true);
+}
+
 void
 CondVar::signal() {
     const int result = pthread_cond_signal(&impl_->cond_);
@@ -247,6 +279,15 @@ CondVar::signal() {
     assert(result == 0);
 }
 
+void
+CondVar::broadcast() {
+    const int result = pthread_cond_broadcast(&impl_->cond_);
+
+    // pthread_cond_broadcast() can only fail when if cond_ is invalid.  It
+    // should be impossible as long as this is a valid CondVar object.
+    assert(result == 0);
+}
+
 }
 }
 }
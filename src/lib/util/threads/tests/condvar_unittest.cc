@@ -87,6 +87,24 @@ TEST_F(CondVarTest, waitAndSignal) {
     }
 }
 
+// The timed wait returns false when nobody signals the condition variable.
+TEST_F(CondVarTest, timedWaitTimeout) {
+    Mutex::Locker locker(mutex_);
+    EXPECT_FALSE(condvar_.timedWait(mutex_, 10));
+}
+
+// The timed wait returns true when the condition variable is signalled.
+TEST_F(CondVarTest, timedWaitAndSignal) {
+    if (!isc::util::unittests::runningOnValgrind()) {
+        Mutex::Locker locker(mutex_);
+        int shared_var = 0; // let the other thread increment this
+        Thread t(boost::bind(&ringSignal, &condvar_, &mutex_, &shared_var));
+        EXPECT_TRUE(condvar_.timedWait(mutex_, 5000));
+        t.wait();
+        EXPECT_EQ(1, shared_var);
+    }
+}
+
 // Thread's main code for the next test
 void
 signalAndWait(CondVar* condvar1, CondVar* condvar2, Mutex* mutex, int* arg) {
@@ -125,6 +143,33 @@ TEST_F(CondVarTest, multiWaits) {
     EXPECT_EQ(4, shared_var);
 }
 
+// Similar to the previous test, but both threads are woken up at once.
+TEST_F(CondVarTest, broadcast) {
+    boost::scoped_ptr<Mutex::Locker> locker(new Mutex::Locker(mutex_));
+    CondVar condvar2; // separate cond var for initial synchronization
+    int shared_var = 0; // let the other thread increment this
+    Thread t1(boost::bind(&signalAndWait, &condvar_, &condvar2, &mutex_,
+                          &shared_var));
+    Thread t2(boost::bind(&signalAndWait, &condvar_, &condvar2, &mutex_,
+                          &shared_var));
+
+    // Wait until both threads are waiting on condvar_.
+    while (shared_var < 2 && !do_exit) {
+        condvar2.wait(mutex_);
+    }
+    // Check we exited from the loop successfully.
+    ASSERT_FALSE(do_exit);
+    ASSERT_EQ(2, shared_var);
+
+    // release the lock, wake up both threads with a single call, wait for
+    // them to die, and confirm they successfully woke up.
+    locker.reset();
+    condvar_.broadcast();
+    t1.wait();
+    t2.wait();
+    EXPECT_EQ(4, shared_var);
+}
+
 // Similar to the previous version of the same function, but just do
 // condvar operations.  It will never wake up.
 void
@@ -167,4 +212,9 @@ TEST_F(CondVarTest, emptySignal) {
     EXPECT_NO_THROW(condvar_.signal());
 }
 
+TEST_F(CondVarTest, emptyBroadcast) {
+    // It's okay to call broadcast when no one waits.
+    EXPECT_NO_THROW(condvar_.broadcast());
+}
+
 }
@@ -0,0 +1,111 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <exceptions/exceptions.h>
+#include <util/threads/multi_threading_mgr.h>
+
+#include <gtest/gtest.h>
+
+using namespace isc;
+using namespace isc::util::thread;
+
+namespace {
+
+/// @brief Test fixture restoring the default multi-threading mode.
+class MultiThreadingMgrTest : public ::testing::Test {
+public:
+
+    /// @brief Destructor.
+    ///
+    /// Disables the multi-threading mode and stops the pool.
+    virtual ~MultiThreadingMgrTest() {
+        MultiThreadingMgr::instance().apply(false, 0);
+    }
+};
+
+// This test verifies that the multi-threading mode is disabled by default.
+TEST_F(MultiThreadingMgrTest, defaults) {
+    EXPECT_FALSE(MultiThreadingMgr::instance().getMode());
+    EXPECT_EQ(0, MultiThreadingMgr::instance().getThreadPoolSize());
+    EXPECT_FALSE(MultiThreadingMgr::instance().isInCriticalSection());
+    EXPECT_FALSE(MultiThreadingMgr::instance().getThreadPool().running());
+}
+
+// This test verifies that applying the configuration starts and stops
+// the thread pool.
+TEST_F(MultiThreadingMgrTest, apply) {
+    MultiThreadingMgr& mgr = MultiThreadingMgr::instance();
+
+    ASSERT_NO_THROW(mgr.apply(true, 4, 16));
+    EXPECT_TRUE(mgr.getMode());
+    EXPECT_EQ(4, mgr.getThreadPoolSize());
+    EXPECT_EQ(4, mgr.getThreadPool().size());
+    EXPECT_EQ(16, mgr.getThreadPool().getMaxQueueSize());
+
+    // The number of threads is detected when not specified.
+    ASSERT_NO_THROW(mgr.apply(true, 0));
+    EXPECT_EQ(MultiThreadingMgr::detectThreadCount(), mgr.getThreadPoolSize());
+    EXPECT_EQ(mgr.getThreadPoolSize(), mgr.getThreadPool().size());
+
+    ASSERT_NO_THROW(mgr.apply(false, 4));
+    EXPECT_FALSE(mgr.getMode());
+    EXPECT_EQ(0, mgr.getThreadPoolSize());
+    EXPECT_FALSE(mgr.getThreadPool().running());
+}
+
+// This test verifies that the thread pool is stopped within the critical
+// section and that the critical sections can be nested.
+TEST_F(MultiThreadingMgrTest, criticalSection) {
+    MultiThreadingMgr& mgr = MultiThreadingMgr::instance();
+    ASSERT_NO_THROW(mgr.apply(true, 2));
+    {
+        MultiThreadingCriticalSection cs;
+        EXPECT_TRUE(mgr.isInCriticalSection());
+        EXPECT_FALSE(mgr.getThreadPool().running());
+        {
+            MultiThreadingCriticalSection nested_cs;
+            EXPECT_FALSE(mgr.getThreadPool().running());
+        }
+        EXPECT_TRUE(mgr.isInCriticalSection());
+        EXPECT_FALSE(mgr.getThreadPool().running());
+
+        // The configuration can't be changed within the critical section.
+        EXPECT_THROW(mgr.apply(false, 0), InvalidOperation);
+    }
+    EXPECT_FALSE(mgr.isInCriticalSection());
+    EXPECT_TRUE(mgr.getThreadPool().running());
+    EXPECT_EQ(2, mgr.getThreadPool().size());
+
+    // Exiting the critical section which hasn't been entered is an error.
+    EXPECT_THROW(mgr.exitCriticalSection(), InvalidOperation);
+}
+
+// This test verifies that the mutex is locked by the MultiThreadingLock
+// only when the multi-threading mode is enabled.
+TEST_F(MultiThreadingMgrTest, lock) {
+    MultiThreadingMgr& mgr = MultiThreadingMgr::instance();
+    Mutex mutex;
+
+    mgr.setMode(false);
+    {
+        MultiThreadingLock lock(mutex);
+        // The mutex is not locked so it can be locked again.
+        EXPECT_NO_THROW(Mutex::Locker(mutex, false));
+    }
+
+    mgr.setMode(true);
+    {
+        MultiThreadingLock lock(mutex);
+        EXPECT_THROW(Mutex::Locker(mutex, false), Mutex::Locker::AlreadyLocked);
+    }
+    // The mutex is released when the lock goes out of scope.
+    EXPECT_NO_THROW(Mutex::Locker(mutex, false));
+    mgr.setMode(false);
+}
+
+} // end of anonymous namespace
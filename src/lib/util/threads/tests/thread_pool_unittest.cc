@@ -0,0 +1,142 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <exceptions/exceptions.h>
+#include <util/threads/sync.h>
+#include <util/threads/thread_pool.h>
+
+#include <boost/bind.hpp>
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+using namespace isc;
+using namespace isc::util::thread;
+
+namespace {
+
+/// @brief Work item incrementing a counter.
+///
+/// @param mutex Mutex protecting the counter.
+/// @param counter Pointer to the counter.
+void
+increment(Mutex* mutex, size_t* counter) {
+    Mutex::Locker lock(*mutex);
+    ++*counter;
+}
+
+/// @brief Work item which throws.
+void
+throwing() {
+    isc_throw(Unexpected, "work item failed");
+}
+
+// This test verifies that the pool can be started and stopped.
+TEST(ThreadPoolTest, startStop) {
+    ThreadPool pool;
+    EXPECT_FALSE(pool.running());
+    EXPECT_EQ(0, pool.size());
+
+    // The pool requires at least one thread.
+    EXPECT_THROW(pool.start(0), BadValue);
+
+    ASSERT_NO_THROW(pool.start(4));
+    EXPECT_TRUE(pool.running());
+    EXPECT_EQ(4, pool.size());
+
+    // The pool can't be started twice.
+    EXPECT_THROW(pool.start(2), InvalidOperation);
+
+    ASSERT_NO_THROW(pool.stop());
+    EXPECT_FALSE(pool.running());
+    EXPECT_EQ(0, pool.size());
+
+    // Stopping the stopped pool is fine.
+    EXPECT_NO_THROW(pool.stop());
+
+    // The stopped pool can be started again.
+    ASSERT_NO_THROW(pool.start(1));
+    EXPECT_EQ(1, pool.size());
+}
+
+// This test verifies that all queued items are run by the pool.
+TEST(ThreadPoolTest, add) {
+    ThreadPool pool;
+    Mutex mutex;
+    size_t counter = 0;
+
+    // Items are not accepted when the pool is not running.
+    EXPECT_FALSE(pool.add(boost::bind(&increment, &mutex, &counter)));
+
+    ASSERT_NO_THROW(pool.start(4));
+    for (size_t i = 0; i < 1000; ++i) {
+        ASSERT_TRUE(pool.add(boost::bind(&increment, &mutex, &counter)));
+    }
+    pool.wait();
+    EXPECT_EQ(0, pool.count());
+    {
+        Mutex::Locker lock(mutex);
+        EXPECT_EQ(1000, counter);
+    }
+
+    // The items queued before the pool is stopped are still processed.
+    for (size_t i = 0; i < 1000; ++i) {
+        ASSERT_TRUE(pool.add(boost::bind(&increment, &mutex, &counter)));
+    }
+    pool.stop();
+    EXPECT_EQ(0, pool.count());
+    EXPECT_EQ(2000, counter);
+}
+
+// This test verifies that the exceptions thrown by the work items don't
+// terminate the threads.
+TEST(ThreadPoolTest, throwingItem) {
+    ThreadPool pool;
+    Mutex mutex;
+    size_t counter = 0;
+
+    ASSERT_NO_THROW(pool.start(1));
+    ASSERT_TRUE(pool.add(&throwing));
+    ASSERT_TRUE(pool.add(boost::bind(&increment, &mutex, &counter)));
+    pool.wait();
+    EXPECT_EQ(1, pool.size());
+    Mutex::Locker lock(mutex);
+    EXPECT_EQ(1, counter);
+}
+
+// This test verifies that the size of the queue can be limited.
+TEST(ThreadPoolTest, maxQueueSize) {
+    ThreadPool pool(2);
+    EXPECT_EQ(2, pool.getMaxQueueSize());
+    Mutex mutex;
+    size_t counter = 0;
+
+    ASSERT_NO_THROW(pool.start(1));
+    {
+        // Keep the only thread blocked so the items remain in the queue.
+        Mutex::Locker lock(mutex);
+        ASSERT_TRUE(pool.add(boost::bind(&increment, &mutex, &counter)));
+        // Wait for the thread to take the first item.
+        while (pool.count() > 0) {
+            usleep(1000);
+        }
+        EXPECT_TRUE(pool.add(boost::bind(&increment, &mutex, &counter)));
+        EXPECT_TRUE(pool.add(boost::bind(&increment, &mutex, &counter)));
+        EXPECT_FALSE(pool.add(boost::bind(&increment, &mutex, &counter)));
+        EXPECT_EQ(2, pool.count());
+    }
+    pool.wait();
+    EXPECT_EQ(3, counter);
+
+    // Remove the limit.
+    pool.setMaxQueueSize(0);
+    EXPECT_EQ(0, pool.getMaxQueueSize());
+}
+
+} // end of anonymous namespace
@@ -0,0 +1,148 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include <config.h>
+
+#include <exceptions/exceptions.h>
+#include <util/threads/thread_pool.h>
+
+#include <boost/bind.hpp>
+
+namespace isc {
+namespace util {
+namespace thread {
+
+ThreadPool::ThreadPool(const size_t max_queue_size)
+    : mutex_(), work_cv_(), idle_cv_(), queue_(), threads_(),
+      max_queue_size_(max_queue_size), working_(0), running_(false) {
+}
+
+ThreadPool::~ThreadPool() {
+    stop();
+}
+
+void
+ThreadPool::start(const size_t thread_count) {
+    if (thread_count == 0) {
+        isc_throw(BadValue, "number of threads in the thread pool must"
+                  " be greater than 0");
+    }
+
+    Mutex::Locker lock(mutex_);
+    if (running_ || !threads_.empty()) {
+        isc_throw(InvalidOperation, "thread pool is already running");
+    }
+    running_ = true;
+    for (size_t i = 0; i < thread_count; ++i) {
+        threads_.push_back(ThreadPtr(new Thread(boost::bind(&ThreadPool::run,
+                                                            this))));
+    }
+}
+
+void
+ThreadPool::stop() {
+    std::vector<ThreadPtr> threads;
+    {
+        Mutex::Locker lock(mutex_);
+        running_ = false;
+        work_cv_.broadcast();
+        threads.swap(threads_);
+    }
+
+    // The threads terminate when the queue is empty. They must be joined
+    // without holding the lock because they need it to take the items.
+    for (std::vector<ThreadPtr>::const_iterator t = threads.begin();
+         t != threads.end(); ++t) {
+        (*t)->wait();
+    }
+}
+
+bool
+ThreadPool::add(const WorkItem& item) {
+    Mutex::Locker lock(mutex_);
+    if (!running_ ||
+        ((max_queue_size_ > 0) && (queue_.size() >= max_queue_size_))) {
+        return (false);
+    }
+    queue_.push_back(item);
+    work_cv_.signal();
+    return (true);
+}
+
+void
+ThreadPool::wait() {
+    Mutex::Locker lock(mutex_);
+    while (!threads_.empty() && (!queue_.empty() || (working_ > 0))) {
+        idle_cv_.wait(mutex_);
+    }
+}
+
+size_t
+ThreadPool::count() {
+    Mutex::Locker lock(mutex_);
+    return (queue_.size());
+}
+
+size_t
+ThreadPool::size() {
+    Mutex::Locker lock(mutex_);
+    return (threads_.size());
+}
+
+bool
+ThreadPool::running() {
+    Mutex::Locker lock(mutex_);
+    return (running_);
+}
+
+size_t
+ThreadPool::getMaxQueueSize() {
+    Mutex::Locker lock(mutex_);
+    return (max_queue_size_);
+}
+
+void
+ThreadPool::setMaxQueueSize(const size_t max_queue_size) {
+    Mutex::Locker lock(mutex_);
+    max_queue_size_ = max_queue_size;
+}
+
+void
+ThreadPool::run() {
+    for (;;) {
+        WorkItem item;
+        {
+            Mutex::Locker lock(mutex_);
+            while (running_ && queue_.empty()) {
+                work_cv_.wait(mutex_);
+            }
+            // The pool is stopping and there is nothing left to do.
+            if (queue_.empty()) {
+                idle_cv_.broadcast();
+                return;
+            }
+            item = queue_.front();
+            queue_.pop_front();
+            ++working_;
+        }
+
+        try {
+            item();
+        } catch (...) {
+            // The work items are supposed to handle their errors.
+        }
+
+        Mutex::Locker lock(mutex_);
+        --working_;
+        if (queue_.empty() && (working_ == 0)) {
+            idle_cv_.broadcast();
+        }
+    }
+}
+
+} // namespace thread
+} // namespace util
+} // namespace isc
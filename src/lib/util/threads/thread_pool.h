@@ -0,0 +1,139 @@
+// Copyright (C) 2017 Internet Systems Consortium, Inc. ("ISC")
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#ifndef KEA_THREAD_POOL_H
+#define KEA_THREAD_POOL_H
+
+#include <util/threads/sync.h>
+#include <util/threads/thread.h>
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <deque>
+#include <vector>
+
+namespace isc {
+namespace util {
+namespace thread {
+
+/// @brief Fixed size pool of threads processing queued work items.
+///
+/// The work items are functors added to a FIFO queue with @ref add. Each
+/// thread of the pool takes the item from the front of the queue and
+/// runs it. The items are run concurrently, so the pool doesn't guarantee
+/// the order in which the items complete.
+///
+/// The exceptions thrown by the work items are caught and ignored by the
+/// pool: the caller is expected to wrap the work in a functor which
+/// handles its errors.
+///
+/// The pool is not started when it is constructed. The @ref start method
+/// creates the threads and @ref stop waits for the queued items to be
+/// processed and joins the threads. The pool can be started again after
+/// it has been stopped.
+class ThreadPool : public boost::noncopyable {
+public:
+
+    /// @brief Type of the work item run by the pool.
+    typedef boost::function<void()> WorkItem;
+
+    /// @brief Constructor.
+    ///
+    /// @param max_queue_size Maximum number of items waiting in the queue.
+    /// The value of 0 means that the queue is not limited.
+    explicit ThreadPool(const size_t max_queue_size = 0);
+
+    /// @brief Destructor.
+    ///
+    /// Stops the pool if it is running.
+    ~ThreadPool();
+
+    /// @brief Starts the threads of the pool.
+    ///
+    /// @param thread_count Number of threads to start.
+    ///
+    /// @throw InvalidOperation if the pool is already running.
+    /// @throw BadValue if the number of threads is 0.
+    void start(const size_t thread_count);
+
+    /// @brief Stops the threads of the pool.
+    ///
+    /// The items which have been queued before this method is called
+    /// are processed before the threads terminate. This method does
+    /// nothing when the pool is not running.
+    void stop();
+
+    /// @brief Adds an item to the queue.
+    ///
+    /// @param item Work item to be run by one of the threads.
+    ///
+    /// @return true if the item has been queued, false if the pool is not
+    /// running or the queue is full.
+    bool add(const WorkItem& item);
+
+    /// @brief Waits until all queued items have been processed.
+    ///
+    /// It must not be called from a work item.
+    void wait();
+
+    /// @brief Returns the number of items waiting in the queue.
+    size_t count();
+
+    /// @brief Returns the number of threads of the pool.
+    size_t size();
+
+    /// @brief Checks if the pool is running.
+    bool running();
+
+    /// @brief Returns the maximum size of the queue.
+    size_t getMaxQueueSize();
+
+    /// @brief Sets the maximum size of the queue.
+    ///
+    /// @param max_queue_size New maximum size. The value of 0 means
+    /// that the queue is not limited.
+    void setMaxQueueSize(const size_t max_queue_size);
+
+private:
+
+    /// @brief Main function of the threads of the pool.
+    void run();
+
+    /// @brief Type of the pointer to a thread of the pool.
+    typedef boost::shared_ptr<Thread> ThreadPtr;
+
+    /// @brief Protects all members of the pool.
+    Mutex mutex_;
+
+    /// @brief Signalled when an item is queued or the pool is stopping.
+    CondVar work_cv_;
+
+    /// @brief Signalled when a thread finishes processing an item.
+    CondVar idle_cv_;
+
+    /// @brief Queued items.
+    std::deque<WorkItem> queue_;
+
+    /// @brief Threads of the pool.
+    std::vector<ThreadPtr> threads_;
+
+    /// @brief Maximum number of queued items (0 for unlimited).
+    size_t max_queue_size_;
+
+    /// @brief Number of items currently being processed.
+    size_t working_;
+
+    /// @brief Indicates if the pool accepts new items.
+    bool running_;
+};
+
+} // namespace thread
+} // namespace util
+} // namespace isc
+
+#endif // KEA_THREAD_POOL_H
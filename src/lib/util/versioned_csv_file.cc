@@ -128,12 +128,23 @@ VersionedCSVFile::next(CSVRow& row) {
         return(true);
     }
 
+    std::string read_msg;
+    bool row_valid = adjustRow(row, read_msg);
+    if (!read_msg.empty()) {
+        setReadMsg(read_msg);
+    }
+
+    return (row_valid);
+}
+
+bool
+VersionedCSVFile::adjustRow(CSVRow& row, std::string& read_msg) const {
     bool row_valid = true;
     switch(getInputSchemaState()) {
         case CURRENT:
             // All rows must match than the current schema
             if (row.getValuesCount() != getColumnCount()) {
-                columnCountError(row, "must match current schema");
+                read_msg = columnCountMsg(row, "must match current schema");
                 row_valid = false;
             }
             break;
@@ -144,10 +155,10 @@ VersionedCSVFile::next(CSVRow& row) {
             // Rows must not be shorter than the valid column count
             // and not longer than the current schema
             if (row.getValuesCount() < getValidColumnCount()) {
-                columnCountError(row, "too few columns to upgrade");
+                read_msg = columnCountMsg(row, "too few columns to upgrade");
                 row_valid = false;
             } else if (row.getValuesCount() > getColumnCount()) {
-                columnCountError(row, "too many columns to upgrade");
+                read_msg = columnCountMsg(row, "too many columns to upgrade");
                 row_valid = false;
             } else {
                 // Add any missing values
@@ -163,9 +174,9 @@ VersionedCSVFile::next(CSVRow& row) {
             // Rows may be as long as input header but not shorter than
             // the the current schema
             if (row.getValuesCount() < getColumnCount()) {
-                columnCountError(row, "too few columns to downgrade");
+                read_msg = columnCountMsg(row, "too few columns to downgrade");
             } else if (row.getValuesCount() > getInputHeaderCount()) {
-                columnCountError(row, "too many columns to downgrade");
+                read_msg = columnCountMsg(row, "too many columns to downgrade");
             } else {
                 // Toss any the extra columns
                 row.trim(row.getValuesCount() - getColumnCount());
@@ -179,11 +190,17 @@ VersionedCSVFile::next(CSVRow& row) {
 void
 VersionedCSVFile::columnCountError(const CSVRow& row,
                                   const std::string& reason) {
+    setReadMsg(columnCountMsg(row, reason));
+}
+
+std::string
+VersionedCSVFile::columnCountMsg(const CSVRow& row,
+                                 const std::string& reason) const {
     std::ostringstream s;
     s <<  "Invalid number of columns: "
       << row.getValuesCount()  << " in row: '" << row
       << "', file: '" << getFilename() << "' : " << reason;
-      setReadMsg(s.str());
+    return (s.str());
 }
 
 bool
@@ -229,6 +229,21 @@ public:
     /// failed.
     bool next(CSVRow& row);
 
+    /// @brief Adjusts a row read from the file to the current schema.
+    ///
+    /// This function applies the checks and conversions described for
+    /// @c next to a row which has been read from the file by other means,
+    /// e.g. when the rows are parsed in parallel. It doesn't change the
+    /// state of this object, so it may be called by multiple threads
+    /// once the file has been opened.
+    ///
+    /// @param [in,out] row Row to be adjusted.
+    /// @param [out] read_msg Description of the error found in the row;
+    /// unchanged if no error has been found.
+    ///
+    /// @return true if the row is valid; false otherwise.
+    bool adjustRow(CSVRow& row, std::string& read_msg) const;
+
     /// @brief Returns the schema version of the physical file
     ///
     /// @return text version of the schema found or string "undefined" if the
@@ -288,6 +303,14 @@ protected:
     /// @param reason An explanation as to why the row column count is wrong
     void columnCountError(const CSVRow& row, const std::string& reason);
 
+    /// @brief Constructs the error message for a wrong number of columns.
+    ///
+    /// @param row The row in error
+    /// @param reason An explanation as to why the row column count is wrong
+    /// @return The error message.
+    std::string columnCountMsg(const CSVRow& row,
+                               const std::string& reason) const;
+
 private:
     /// @brief Holds the collection of column descriptors
     std::vector<VersionedColumnPtr> columns_;